@@ -0,0 +1,218 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file antenna-3gpp-pattern-benchmark.cc
+ * \ingroup examples
+ * \brief Benchmark of the radiation pattern and of the steering vectors of
+ * AntennaArray3gppModel
+ *
+ * The program draws random ray directions and measures:
+ *
+ * - the radiation pattern of each ray computed by GetRadiationPattern, by
+ *   GetRadiationPatterns, and interpolated in a table with the step
+ *   patternStep (the largest error of the table is printed);
+ * - the sum over the rays of each pair of elements of a gNB and a UE array,
+ *   as in MmWave3gppChannel::GetNewChannel: with the pattern and the phase
+ *   terms computed for each pair, as before, and with the patterns and the
+ *   steering vectors computed once per ray. The sums are checked to be the
+ *   same.
+ *
+ * \code{.unparsed}
+$ ./waf --run "antenna-3gpp-pattern-benchmark --rays=460 --gNbAntennaNum=8 --ueAntennaNum=4 --patternStep=1"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/antenna-array-3gpp-model.h"
+#include "ns3/antenna-array-3gpp-pattern-table.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Antenna3gppPatternBenchmark");
+
+/**
+ * \return the time elapsed since start, in ms
+ * \param start the start time
+ */
+static double
+ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t rays = 460;
+  uint32_t directions = 1000000;
+  uint32_t gNbAntennaNum = 8;
+  uint32_t ueAntennaNum = 4;
+  double patternStep = 1.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("rays", "Number of rays of the channel (clusters times rays per cluster)", rays);
+  cmd.AddValue ("directions", "Number of directions of the radiation pattern benchmark", directions);
+  cmd.AddValue ("gNbAntennaNum", "Number of antenna elements in each dimension of the gNB array", gNbAntennaNum);
+  cmd.AddValue ("ueAntennaNum", "Number of antenna elements in each dimension of the UE array", ueAntennaNum);
+  cmd.AddValue ("patternStep", "Step of the radiation pattern table, in degrees", patternStep);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  std::vector<double> vAngles;
+  std::vector<double> hAngles;
+  for (uint32_t i = 0; i < directions; ++i)
+    {
+      vAngles.push_back (random->GetValue (0, M_PI));
+      hAngles.push_back (random->GetValue (0, 2 * M_PI));
+    }
+
+  Ptr<AntennaArray3gppModel> ue = CreateObject<AntennaArray3gppModel> ();
+  ue->SetIsUe (true);
+  Ptr<AntennaArray3gppModel> ueTable = CreateObject<AntennaArray3gppModel> ();
+  ueTable->SetAttribute ("RadiationPatternStep", DoubleValue (patternStep));
+  ueTable->SetIsUe (true);
+
+  std::vector<double> single (directions);
+  auto start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < directions; ++i)
+    {
+      single[i] = ue->GetRadiationPattern (vAngles[i], hAngles[i]);
+    }
+  std::cout << "Radiation pattern of " << directions << " directions, GetRadiationPattern: "
+            << ElapsedMs (start) << " ms" << std::endl;
+
+  std::vector<double> patterns (directions);
+  start = std::chrono::steady_clock::now ();
+  ue->GetRadiationPatterns (vAngles.data (), hAngles.data (), directions, patterns.data ());
+  std::cout << "Radiation pattern of " << directions << " directions, GetRadiationPatterns: "
+            << ElapsedMs (start) << " ms" << std::endl;
+  NS_ABORT_MSG_UNLESS (single == patterns, "GetRadiationPatterns and GetRadiationPattern disagree");
+
+  // The first call builds the table
+  start = std::chrono::steady_clock::now ();
+  ueTable->GetRadiationPattern (M_PI / 2, 0);
+  std::cout << "Radiation pattern table with a step of " << patternStep << " degrees, built in "
+            << ElapsedMs (start) << " ms" << std::endl;
+
+  std::vector<double> interpolated (directions);
+  start = std::chrono::steady_clock::now ();
+  ueTable->GetRadiationPatterns (vAngles.data (), hAngles.data (), directions, interpolated.data ());
+  const double tableMs = ElapsedMs (start);
+  double maxError = 0;
+  for (uint32_t i = 0; i < directions; ++i)
+    {
+      maxError = std::max (maxError, std::abs (interpolated[i] - patterns[i]));
+    }
+  std::cout << "Radiation pattern of " << directions << " directions, table: " << tableMs
+            << " ms (largest error " << maxError << ")" << std::endl;
+
+  // The channel coefficients of the pairs of elements, for the rays of a channel
+  Ptr<AntennaArray3gppModel> gNb = CreateObject<AntennaArray3gppModel> ();
+  gNb->SetIsUe (false);
+  uint8_t gNbNum[2] = {static_cast<uint8_t> (gNbAntennaNum), static_cast<uint8_t> (gNbAntennaNum)};
+  uint8_t ueNum[2] = {static_cast<uint8_t> (ueAntennaNum), static_cast<uint8_t> (ueAntennaNum)};
+  const uint32_t gNbSize = gNbAntennaNum * gNbAntennaNum;
+  const uint32_t ueSize = ueAntennaNum * ueAntennaNum;
+  std::vector<double> rayZoa (rays);
+  std::vector<double> rayAoa (rays);
+  std::vector<double> rayZod (rays);
+  std::vector<double> rayAod (rays);
+  std::vector<double> rayPhase (rays);
+  for (uint32_t i = 0; i < rays; ++i)
+    {
+      rayZoa[i] = vAngles[i % directions];
+      rayAoa[i] = hAngles[i % directions];
+      rayZod[i] = vAngles[(i + rays) % directions];
+      rayAod[i] = hAngles[(i + rays) % directions];
+      rayPhase[i] = random->GetValue (0, 2 * M_PI);
+    }
+
+  std::vector<std::complex<double> > before (ueSize * gNbSize);
+  start = std::chrono::steady_clock::now ();
+  for (uint32_t u = 0; u < ueSize; ++u)
+    {
+      Vector uLoc = ue->GetAntennaLocation (u, ueNum);
+      for (uint32_t s = 0; s < gNbSize; ++s)
+        {
+          Vector sLoc = gNb->GetAntennaLocation (s, gNbNum);
+          std::complex<double> coefficient (0, 0);
+          for (uint32_t i = 0; i < rays; ++i)
+            {
+              double rxPhaseDiff = 2 * M_PI * (sin (rayZoa[i]) * cos (rayAoa[i]) * uLoc.x
+                                               + sin (rayZoa[i]) * sin (rayAoa[i]) * uLoc.y
+                                               + cos (rayZoa[i]) * uLoc.z);
+              double txPhaseDiff = 2 * M_PI * (sin (rayZod[i]) * cos (rayAod[i]) * sLoc.x
+                                               + sin (rayZod[i]) * sin (rayAod[i]) * sLoc.y
+                                               + cos (rayZod[i]) * sLoc.z);
+              coefficient += exp (std::complex<double> (0, rayPhase[i]))
+                * (ue->GetRadiationPattern (rayZoa[i], rayAoa[i]) * gNb->GetRadiationPattern (rayZod[i], rayAod[i]))
+                * exp (std::complex<double> (0, rxPhaseDiff))
+                * exp (std::complex<double> (0, txPhaseDiff));
+            }
+          before[u * gNbSize + s] = coefficient;
+        }
+    }
+  std::cout << "Coefficients of " << ueSize << "x" << gNbSize << " elements and " << rays
+            << " rays, per pair of elements: " << ElapsedMs (start) << " ms" << std::endl;
+
+  std::vector<std::complex<double> > after (ueSize * gNbSize);
+  start = std::chrono::steady_clock::now ();
+  std::vector<double> rxPatterns (rays);
+  std::vector<double> txPatterns (rays);
+  ue->GetRadiationPatterns (rayZoa.data (), rayAoa.data (), rays, rxPatterns.data ());
+  gNb->GetRadiationPatterns (rayZod.data (), rayAod.data (), rays, txPatterns.data ());
+  AntennaArrayBasicModel::complexVector_t rxSteering;
+  AntennaArrayBasicModel::complexVector_t txSteering;
+  ue->GetSteeringVectors (rayZoa.data (), rayAoa.data (), rays, ueNum, &rxSteering);
+  gNb->GetSteeringVectors (rayZod.data (), rayAod.data (), rays, gNbNum, &txSteering);
+  std::vector<std::complex<double> > rayPhases (rays);
+  for (uint32_t i = 0; i < rays; ++i)
+    {
+      rayPhases[i] = exp (std::complex<double> (0, rayPhase[i]));
+    }
+  for (uint32_t u = 0; u < ueSize; ++u)
+    {
+      for (uint32_t s = 0; s < gNbSize; ++s)
+        {
+          std::complex<double> coefficient (0, 0);
+          for (uint32_t i = 0; i < rays; ++i)
+            {
+              coefficient += rayPhases[i]
+                * (rxPatterns[i] * txPatterns[i])
+                * rxSteering[u * rays + i]
+                * txSteering[s * rays + i];
+            }
+          after[u * gNbSize + s] = coefficient;
+        }
+    }
+  std::cout << "Coefficients of " << ueSize << "x" << gNbSize << " elements and " << rays
+            << " rays, batched per ray: " << ElapsedMs (start) << " ms" << std::endl;
+
+  double maxDifference = 0;
+  for (uint32_t k = 0; k < before.size (); ++k)
+    {
+      maxDifference = std::max (maxDifference, std::abs (before[k] - after[k]));
+    }
+  std::cout << "Largest difference of the coefficients: " << maxDifference << std::endl;
+  NS_ABORT_MSG_IF (maxDifference > 1e-9, "The batched coefficients are not the same");
+
+  return 0;
+}
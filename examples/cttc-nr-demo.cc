@@ -65,6 +65,9 @@ main (int argc, char *argv[])
   std::string outputDir = "./";
   double totalTxPower = 4;
   bool logging = false;
+  std::string saveSnapshot = "";
+  double snapshotTime = 0.5; // seconds
+  std::string loadSnapshot = "";
 
   double simTime = 1; // seconds
   double udpAppStartTime = 0.4; //seconds
@@ -140,6 +143,16 @@ main (int argc, char *argv[])
   cmd.AddValue ("logging",
                 "Enable logging",
                 logging);
+  cmd.AddValue ("saveSnapshot",
+                "If not empty, file where to save the state of the channels at snapshotTime",
+                saveSnapshot);
+  cmd.AddValue ("snapshotTime",
+                "Time at which the state of the channels is saved, in seconds",
+                snapshotTime);
+  cmd.AddValue ("loadSnapshot",
+                "If not empty, file of a run with the same parameters, whose state of the channels "
+                "is restored at the start",
+                loadSnapshot);
 
 
   cmd.Parse (argc, argv);
@@ -449,9 +462,20 @@ main (int argc, char *argv[])
   serverApps.Stop(Seconds(simTime));
   clientApps.Stop(Seconds(simTime));
 
+  // warm start from the channels of a previous run
+  if (! loadSnapshot.empty ())
+    {
+      mmWaveHelper->LoadChannelSnapshot (loadSnapshot);
+    }
+
   // attach UEs to the closest eNB
   mmWaveHelper->AttachToClosestEnb (ueNetDev, enbNetDev);
 
+  if (! saveSnapshot.empty ())
+    {
+      Simulator::Schedule (Seconds (snapshotTime), &MmWaveHelper::SaveChannelSnapshot, mmWaveHelper, saveSnapshot);
+    }
+
   // enable the traces provided by the mmWave module
   //mmWaveHelper->EnableTraces();
 
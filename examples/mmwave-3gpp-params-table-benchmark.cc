@@ -0,0 +1,256 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file mmwave-3gpp-params-table-benchmark.cc
+ * \ingroup examples
+ * \brief Benchmark of the 3GPP parameter tables of the channel
+ *
+ * The program draws random links (with repetitions, as the updates of the
+ * channel of a static link) and measures:
+ *
+ * - the computation of the ParamsTable of each link, as MmWave3gppChannel
+ *   did before, and the lookup in MmWave3gppParamsTableStore with the
+ *   heights and the distance rounded to --resolution; the tables are checked
+ *   to be the ones computed with the rounded values (with --resolution=0, the
+ *   tables that depend on them are computed for each link);
+ * - with --channel, the installation of gNBs and UEs and the generation of
+ *   their channels in MmWaveHelper::AttachToClosestEnb, with the attribute
+ *   ParamsTableCache of MmWave3gppChannel false and true (the simulation
+ *   is not run).
+ *
+ * \code{.unparsed}
+$ ./waf --run "mmwave-3gpp-params-table-benchmark --scenario=UMi-StreetCanyon --links=100000 --channel=1"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-3gpp-params-table.h"
+#include <chrono>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWave3gppParamsTableBenchmark");
+
+/**
+ * \return the time elapsed since start, in ms
+ * \param start the start time
+ */
+static double
+ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/**
+ * \param a a table
+ * \param b another table
+ * \return true if all the fields of the tables are the same
+ */
+static bool
+SameTable (const ParamsTable &a, const ParamsTable &b)
+{
+  bool same = a.m_numOfCluster == b.m_numOfCluster && a.m_raysPerCluster == b.m_raysPerCluster
+    && a.m_uLgDS == b.m_uLgDS && a.m_sigLgDS == b.m_sigLgDS && a.m_uLgASD == b.m_uLgASD
+    && a.m_sigLgASD == b.m_sigLgASD && a.m_uLgASA == b.m_uLgASA && a.m_sigLgASA == b.m_sigLgASA
+    && a.m_uLgZSA == b.m_uLgZSA && a.m_sigLgZSA == b.m_sigLgZSA && a.m_uLgZSD == b.m_uLgZSD
+    && a.m_sigLgZSD == b.m_sigLgZSD && a.m_offsetZOD == b.m_offsetZOD && a.m_cDS == b.m_cDS
+    && a.m_cASD == b.m_cASD && a.m_cASA == b.m_cASA && a.m_cZSA == b.m_cZSA && a.m_uK == b.m_uK
+    && a.m_sigK == b.m_sigK && a.m_rTau == b.m_rTau && a.m_shadowingStd == b.m_shadowingStd;
+  for (uint32_t row = 0; row < 7; ++row)
+    {
+      for (uint32_t column = 0; column < 7; ++column)
+        {
+          same = same && a.m_sqrtC[row][column] == b.m_sqrtC[row][column];
+        }
+    }
+  return same;
+}
+
+/**
+ * \brief The inputs of the table of a link
+ */
+struct LinkInputs
+{
+  bool m_los;          //!< LOS condition
+  bool m_o2i;          //!< O2I condition
+  double m_hBS;        //!< BS height
+  double m_hUT;        //!< UT height
+  double m_distance2D; //!< 2D distance
+};
+
+/**
+ * \brief Install gNBs and UEs, and attach them (which generates their channels)
+ * \param gNbNum number of gNBs
+ * \param ueNum number of UEs
+ * \param side side of the square area, in m
+ * \param cache value of the attribute ParamsTableCache of MmWave3gppChannel
+ * \param resolution value of the attribute ParamsTableResolution of MmWave3gppChannel
+ * \return the time spent in MmWaveHelper::AttachToClosestEnb, in ms
+ */
+static double
+AttachScenario (uint32_t gNbNum, uint32_t ueNum, double side, bool cache, double resolution)
+{
+  Config::SetDefault ("ns3::MmWave3gppChannel::ParamsTableCache", BooleanValue (cache));
+  Config::SetDefault ("ns3::MmWave3gppChannel::ParamsTableResolution", DoubleValue (resolution));
+  MmWave3gppParamsTableStore::Clear ();
+  RngSeedManager::SetRun (1);
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (gNbNum);
+  ueNodes.Create (ueNum);
+
+  Ptr<UniformRandomVariable> coordinate = CreateObject<UniformRandomVariable> ();
+  coordinate->SetAttribute ("Max", DoubleValue (side));
+  Ptr<ListPositionAllocator> gNbPositions = CreateObject<ListPositionAllocator> ();
+  Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < gNbNum; ++i)
+    {
+      gNbPositions->Add (Vector (coordinate->GetValue (), coordinate->GetValue (), 10.0));
+    }
+  for (uint32_t i = 0; i < ueNum; ++i)
+    {
+      uePositions->Add (Vector (coordinate->GetValue (), coordinate->GetValue (), 1.5));
+    }
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (gNbPositions);
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator (uePositions);
+  mobility.Install (ueNodes);
+
+  Ptr<MmWaveHelper> mmWaveHelper = CreateObject<MmWaveHelper> ();
+  NetDeviceContainer gNbDevs = mmWaveHelper->InstallEnbDevice (gNbNodes);
+  NetDeviceContainer ueDevs = mmWaveHelper->InstallUeDevice (ueNodes);
+
+  auto start = std::chrono::steady_clock::now ();
+  mmWaveHelper->AttachToClosestEnb (ueDevs, gNbDevs);
+  const double attachMs = ElapsedMs (start);
+
+  Simulator::Destroy ();
+  return attachMs;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string scenario = "UMi-StreetCanyon";
+  double frequency = 28e9;
+  uint32_t links = 100000;
+  double repeated = 0.9;
+  bool channel = false;
+  uint32_t ueNum = 100;
+  uint32_t gNbNum = 10;
+  double side = 500.0;
+  double resolution = 0.1;
+
+  CommandLine cmd;
+  cmd.AddValue ("scenario", "The 3GPP scenario (RMa, UMa, UMi-StreetCanyon, InH-OfficeMixed, InH-OfficeOpen, InH-ShoppingMall)", scenario);
+  cmd.AddValue ("frequency", "The central carrier frequency, in Hz", frequency);
+  cmd.AddValue ("links", "Number of tables to get", links);
+  cmd.AddValue ("repeated", "Probability that a table is the one of a link already seen", repeated);
+  cmd.AddValue ("channel", "Install the devices and generate their channels with MmWaveHelper", channel);
+  cmd.AddValue ("ueNum", "Number of UEs, with --channel", ueNum);
+  cmd.AddValue ("gNbNum", "Number of gNBs, with --channel", gNbNum);
+  cmd.AddValue ("side", "Side of the square area, in m, with --channel", side);
+  cmd.AddValue ("resolution", "Resolution of the heights and the distance of the stored tables, in m", resolution);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue (scenario));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::CenterFreq", DoubleValue (frequency));
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  const bool indoor = scenario.compare (0, 3, "InH") == 0;
+  std::vector<LinkInputs> inputs;
+  for (uint32_t i = 0; i < links; ++i)
+    {
+      if (i > 0 && random->GetValue () < repeated)
+        {
+          inputs.push_back (inputs[random->GetInteger (0, static_cast<uint32_t> (inputs.size () - 1))]);
+          continue;
+        }
+      LinkInputs in;
+      in.m_los = random->GetValue () < 0.5;
+      in.m_o2i = ! indoor && random->GetValue () < 0.3;
+      in.m_hBS = indoor ? 3.0 : random->GetValue (10.0, 35.0);
+      in.m_hUT = random->GetValue (1.5, 22.5);
+      in.m_distance2D = random->GetValue (10.0, 1000.0);
+      inputs.push_back (in);
+    }
+
+  const double fcGHz = frequency / 1e9;
+  std::vector<ParamsTable> computed;
+  computed.reserve (links);
+  auto start = std::chrono::steady_clock::now ();
+  for (const auto & in : inputs)
+    {
+      computed.push_back (MmWave3gppParamsTableStore::Compute (scenario, fcGHz, in.m_los, in.m_o2i,
+                                                               in.m_hBS, in.m_hUT, in.m_distance2D));
+    }
+  const double computeMs = ElapsedMs (start);
+
+  MmWave3gppParamsTableStore::Clear ();
+  std::vector<ParamsTable> stored;
+  stored.reserve (links);
+  start = std::chrono::steady_clock::now ();
+  for (const auto & in : inputs)
+    {
+      stored.push_back (MmWave3gppParamsTableStore::Get (scenario, fcGHz, in.m_los, in.m_o2i,
+                                                         in.m_hBS, in.m_hUT, in.m_distance2D, resolution));
+    }
+  const double storeMs = ElapsedMs (start);
+
+  if (resolution > 0.0)
+    {
+      // The reference of the stored tables uses the rounded values
+      computed.clear ();
+      for (const auto & in : inputs)
+        {
+          computed.push_back (MmWave3gppParamsTableStore::Compute (scenario, fcGHz, in.m_los, in.m_o2i,
+                                                                   MmWave3gppParamsTableStore::Quantize (in.m_hBS, resolution),
+                                                                   MmWave3gppParamsTableStore::Quantize (in.m_hUT, resolution),
+                                                                   MmWave3gppParamsTableStore::Quantize (in.m_distance2D, resolution)));
+        }
+    }
+
+  std::cout << "Tables of " << links << " links in " << scenario << ", computed: "
+            << computeMs << " ms" << std::endl;
+  std::cout << "Tables of " << links << " links in " << scenario << ", from the store: "
+            << storeMs << " ms (" << MmWave3gppParamsTableStore::GetSize () << " tables stored)" << std::endl;
+  for (uint32_t i = 0; i < links; ++i)
+    {
+      NS_ABORT_MSG_UNLESS (SameTable (computed[i], stored[i]),
+                           "The store and the computation disagree on link " << i);
+    }
+
+  if (channel)
+    {
+      std::cout << "Attach " << ueNum << " UEs to " << gNbNum << " gNBs, tables computed: "
+                << AttachScenario (gNbNum, ueNum, side, false, resolution) << " ms" << std::endl;
+      std::cout << "Attach " << ueNum << " UEs to " << gNbNum << " gNBs, tables from the store: "
+                << AttachScenario (gNbNum, ueNum, side, true, resolution) << " ms" << std::endl;
+    }
+
+  MmWave3gppParamsTableStore::Clear ();
+  return 0;
+}
@@ -0,0 +1,152 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file mmwave-attach-benchmark.cc
+ * \ingroup examples
+ * \brief Benchmark of the initial attachment of the UEs to the closest gNB
+ *
+ * The program drops gNBs and UEs uniformly in a square, and measures:
+ *
+ * - the search of the closest gNB of each UE with a linear scan of the gNBs
+ *   (as MmWaveHelper::AttachToClosestEnb did before), and with
+ *   MmWaveEnbGridIndex; the results are checked to be the same;
+ * - with --install, the installation of the devices with MmWaveHelper and
+ *   the whole MmWaveHelper::AttachToClosestEnb (the simulation is not run).
+ *
+ * \code{.unparsed}
+$ ./waf --run "mmwave-attach-benchmark --ueNum=10000 --gNbNum=300 --install=1"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-enb-grid-index.h"
+#include <chrono>
+#include <limits>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveAttachBenchmark");
+
+/**
+ * \return the time elapsed since start, in ms
+ * \param start the start time
+ */
+static double
+ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t ueNum = 10000;
+  uint32_t gNbNum = 300;
+  double side = 5000.0;
+  bool install = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("ueNum", "Number of UEs", ueNum);
+  cmd.AddValue ("gNbNum", "Number of gNBs", gNbNum);
+  cmd.AddValue ("side", "Side of the square area, in m", side);
+  cmd.AddValue ("install", "Install the devices and attach them with MmWaveHelper", install);
+  cmd.Parse (argc, argv);
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (gNbNum);
+  ueNodes.Create (ueNum);
+
+  Ptr<UniformRandomVariable> coordinate = CreateObject<UniformRandomVariable> ();
+  coordinate->SetAttribute ("Max", DoubleValue (side));
+  Ptr<ListPositionAllocator> gNbPositions = CreateObject<ListPositionAllocator> ();
+  Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator> ();
+  std::vector<Vector> gNbs;
+  std::vector<Vector> ues;
+  for (uint32_t i = 0; i < gNbNum; ++i)
+    {
+      gNbs.push_back (Vector (coordinate->GetValue (), coordinate->GetValue (), 10.0));
+      gNbPositions->Add (gNbs.back ());
+    }
+  for (uint32_t i = 0; i < ueNum; ++i)
+    {
+      ues.push_back (Vector (coordinate->GetValue (), coordinate->GetValue (), 1.5));
+      uePositions->Add (ues.back ());
+    }
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (gNbPositions);
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator (uePositions);
+  mobility.Install (ueNodes);
+
+  auto start = std::chrono::steady_clock::now ();
+  std::vector<uint32_t> linear (ueNum);
+  for (uint32_t i = 0; i < ueNum; ++i)
+    {
+      double minDistance = std::numeric_limits<double>::infinity ();
+      for (uint32_t j = 0; j < gNbNum; ++j)
+        {
+          double distance = CalculateDistance (ues[i], gNbs[j]);
+          if (distance < minDistance)
+            {
+              minDistance = distance;
+              linear[i] = j;
+            }
+        }
+    }
+  const double linearMs = ElapsedMs (start);
+
+  start = std::chrono::steady_clock::now ();
+  MmWaveEnbGridIndex index (gNbs);
+  std::vector<uint32_t> grid (ueNum);
+  for (uint32_t i = 0; i < ueNum; ++i)
+    {
+      grid[i] = index.GetClosest (ues[i]);
+    }
+  const double gridMs = ElapsedMs (start);
+
+  std::cout << "Closest gNB of " << ueNum << " UEs among " << gNbNum << " gNBs, linear scan: "
+            << linearMs << " ms" << std::endl;
+  std::cout << "Closest gNB of " << ueNum << " UEs among " << gNbNum << " gNBs, grid index: "
+            << gridMs << " ms (cells of " << index.GetCellSize () << " m)" << std::endl;
+  NS_ABORT_MSG_UNLESS (linear == grid, "The grid index and the linear scan disagree");
+
+  if (install)
+    {
+      Ptr<MmWaveHelper> mmWaveHelper = CreateObject<MmWaveHelper> ();
+      start = std::chrono::steady_clock::now ();
+      NetDeviceContainer gNbDevs = mmWaveHelper->InstallEnbDevice (gNbNodes);
+      NetDeviceContainer ueDevs = mmWaveHelper->InstallUeDevice (ueNodes);
+      std::cout << "Install " << gNbNum << " gNBs and " << ueNum << " UEs: "
+                << ElapsedMs (start) << " ms" << std::endl;
+
+      start = std::chrono::steady_clock::now ();
+      mmWaveHelper->AttachToClosestEnb (ueDevs, gNbDevs);
+      std::cout << "Attach " << ueNum << " UEs to the closest gNB: "
+                << ElapsedMs (start) << " ms" << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
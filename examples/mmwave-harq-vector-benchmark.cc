@@ -0,0 +1,273 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file mmwave-harq-vector-benchmark.cc
+ * \ingroup examples
+ * \brief Benchmark of the HARQ process bookkeeping of the scheduler
+ *
+ * The program replays, without a simulation, the operations that the
+ * scheduler does on the HARQ vectors of each UE in each slot, with a
+ * HARQ-heavy traffic (every UE transmits in every slot, and a fraction of the
+ * transmissions is NACKed):
+ *
+ * - the timers of the active processes are increased, and the expired
+ *   processes are erased (as in MmWaveMacSchedulerNs3::ResetExpiredHARQ);
+ * - the feedback of the processes transmitted some slots before is
+ *   processed: ACKs erase the process, NACKs mark it for retransmission (as in
+ *   MmWaveMacSchedulerNs3::ProcessHARQFeedbacks);
+ * - a new process is inserted (as in MmWaveMacSchedulerNs3::DoScheduleDlData).
+ *
+ * The same operations are replayed on MmWaveMacHarqVector and on an
+ * unordered_map keyed by the process ID (the previous implementation),
+ * and the time spent per slot is printed for both.
+ *
+ * \code{.unparsed}
+$ ./waf --run "mmwave-harq-vector-benchmark --ueNum=200 --slots=20000 --bler=0.3"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-mac-harq-vector.h"
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveHarqVectorBenchmark");
+
+/**
+ * \brief HARQ processes of an UE stored in an unordered_map, as before
+ * MmWaveMacHarqVector was an array
+ */
+class HarqMap
+{
+public:
+  void SetMaxSize (uint8_t size)
+  {
+    m_maxSize = size;
+    m_map.reserve (size);
+    for (auto i = 0; i < size; ++i)
+      {
+        m_map.emplace (i, HarqProcess ());
+      }
+  }
+
+  bool Insert (uint8_t *id, const HarqProcess& element)
+  {
+    if (m_usedSize >= m_maxSize)
+      {
+        return false;
+      }
+    *id = 255;
+    for (const auto & it : m_map)
+      {
+        if (!it.second.m_active)
+          {
+            *id = it.first;
+            break;
+          }
+      }
+    if (*id == 255)
+      {
+        return false;
+      }
+    m_map.at (*id) = element;
+    ++m_usedSize;
+    return true;
+  }
+
+  void Erase (uint8_t id)
+  {
+    m_map.at (id).Erase ();
+    --m_usedSize;
+  }
+
+  HarqProcess & Get (uint8_t id)
+  {
+    return m_map.find (id)->second;
+  }
+
+  void ResetExpired (uint8_t timeout)
+  {
+    for (auto & it : m_map)
+      {
+        if (it.second.m_status == HarqProcess::INACTIVE)
+          {
+            continue;
+          }
+        if (it.second.m_timer < timeout)
+          {
+            ++it.second.m_timer;
+          }
+        else
+          {
+            Erase (it.first);
+          }
+      }
+  }
+
+private:
+  std::unordered_map<uint8_t, HarqProcess> m_map;
+  uint8_t m_maxSize {0};
+  uint8_t m_usedSize {0};
+};
+
+/**
+ * \brief Reset the expired processes of a MmWaveMacHarqVector, as the scheduler does
+ * \param harq the vector
+ * \param timeout the HARQ timeout, in slot
+ */
+static void
+ResetExpired (MmWaveMacHarqVector *harq, uint8_t timeout)
+{
+  harq->ForEachActive ([harq, timeout] (uint8_t id, HarqProcess & process)
+    {
+      if (process.m_status == HarqProcess::INACTIVE)
+        {
+          return;
+        }
+      if (process.m_timer < timeout)
+        {
+          ++process.m_timer;
+        }
+      else
+        {
+          harq->Erase (id);
+        }
+    });
+}
+
+/**
+ * \brief Reset the expired processes of a HarqMap
+ * \param harq the map
+ * \param timeout the HARQ timeout, in slot
+ */
+static void
+ResetExpired (HarqMap *harq, uint8_t timeout)
+{
+  harq->ResetExpired (timeout);
+}
+
+/**
+ * \brief Replay the HARQ operations of the UEs for a number of slots
+ * \param vectors HARQ storage of each UE
+ * \param slots number of slots
+ * \param bler fraction of NACKed transmissions
+ * \param feedbackDelay slots between a transmission and its feedback
+ * \param timeout HARQ timeout, in slot
+ * \return the time spent, in ns per slot
+ */
+template <typename T>
+static double
+Run (std::vector<T> *vectors, uint32_t slots, double bler, uint32_t feedbackDelay, uint8_t timeout)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  HarqProcess element (true, HarqProcess::WAITING_FEEDBACK, 0,
+                       std::make_shared<DciInfoElementTdma> (1, DciInfoElementTdma::DL,
+                                                             0, 1, 10, 100, 1, 0));
+
+  // The feedback expected in each slot: (UE, process ID)
+  std::deque<std::vector<std::pair<uint32_t, uint8_t> > > pending (feedbackDelay);
+  uint64_t inserted = 0;
+
+  auto start = std::chrono::steady_clock::now ();
+  for (uint32_t slot = 0; slot < slots; ++slot)
+    {
+      for (auto & v : *vectors)
+        {
+          ResetExpired (&v, timeout);
+        }
+
+      for (const auto & feedback : pending.front ())
+        {
+          HarqProcess & process = (*vectors)[feedback.first].Get (feedback.second);
+          if (!process.m_active)
+            {
+              continue; // expired in the meantime
+            }
+          if (rng->GetValue () >= bler)
+            {
+              (*vectors)[feedback.first].Erase (feedback.second);
+            }
+          else
+            {
+              process.m_status = HarqProcess::RECEIVED_FEEDBACK;
+            }
+        }
+      pending.pop_front ();
+      pending.emplace_back ();
+
+      for (uint32_t ue = 0; ue < vectors->size (); ++ue)
+        {
+          uint8_t id;
+          if ((*vectors)[ue].Insert (&id, element))
+            {
+              pending.back ().emplace_back (ue, id);
+              ++inserted;
+            }
+        }
+    }
+  auto end = std::chrono::steady_clock::now ();
+
+  NS_LOG_INFO ("Inserted " << inserted << " processes");
+  return std::chrono::duration<double, std::nano> (end - start).count () / slots;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t ueNum = 200;
+  uint32_t slots = 20000;
+  uint32_t harqProcesses = 20;
+  uint32_t feedbackDelay = 4;
+  uint32_t harqTimeout = 20;
+  double bler = 0.3;
+
+  CommandLine cmd;
+  cmd.AddValue ("ueNum", "Number of UEs", ueNum);
+  cmd.AddValue ("slots", "Number of slots to replay", slots);
+  cmd.AddValue ("harqProcesses", "Number of HARQ processes per UE", harqProcesses);
+  cmd.AddValue ("feedbackDelay", "Slots between a transmission and its HARQ feedback", feedbackDelay);
+  cmd.AddValue ("harqTimeout", "HARQ timeout, in slots", harqTimeout);
+  cmd.AddValue ("bler", "Fraction of transmissions that are NACKed", bler);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (harqProcesses == 0 || harqProcesses > 255, "Invalid number of HARQ processes");
+  NS_ABORT_MSG_IF (feedbackDelay == 0, "The feedback delay should be at least one slot");
+
+  std::vector<MmWaveMacHarqVector> harqVectors (ueNum);
+  std::vector<HarqMap> harqMaps (ueNum);
+  for (uint32_t i = 0; i < ueNum; ++i)
+    {
+      harqVectors[i].SetMaxSize (static_cast<uint8_t> (harqProcesses));
+      harqMaps[i].SetMaxSize (static_cast<uint8_t> (harqProcesses));
+    }
+
+  double vectorNs = Run (&harqVectors, slots, bler, feedbackDelay, static_cast<uint8_t> (harqTimeout));
+  double mapNs = Run (&harqMaps, slots, bler, feedbackDelay, static_cast<uint8_t> (harqTimeout));
+
+  std::cout << "UEs: " << ueNum << ", HARQ processes: " << harqProcesses
+            << ", BLER: " << bler << ", slots: " << slots << std::endl;
+  std::cout << "MmWaveMacHarqVector: " << vectorNs << " ns/slot" << std::endl;
+  std::cout << "unordered_map:       " << mapNs << " ns/slot" << std::endl;
+
+  return 0;
+}
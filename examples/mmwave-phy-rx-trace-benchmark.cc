@@ -0,0 +1,272 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file mmwave-phy-rx-trace-benchmark.cc
+ * \ingroup examples
+ * \brief Benchmark of the overhead of the PHY traces
+ *
+ * The program replays, without a simulation, the trace callbacks that the
+ * UEs generate in each slot when the PHY traces are enabled: every UE reports
+ * the RxPacketTrace of a TB and its DL SINR, one value per RB. The same
+ * callbacks are replayed:
+ *
+ * - without any sink (trace off), which is the cost of creating the values;
+ * - with a sink that reopens the SINR file of the UE at each callback, and
+ *   flushes the RxPacketTrace file at each line (the previous implementation
+ *   of MmWavePhyRxTrace);
+ * - with MmWavePhyRxTrace, text output;
+ * - with MmWavePhyRxTrace, binary output;
+ * - with MmWavePhyRxTrace, binary output written by the AsyncWriter thread.
+ *
+ * and the time spent per slot is printed for each one. The trace files are
+ * written in the current directory, and the binary ones (of the last run) are
+ * converted to text to check that they have the same lines as the text output.
+ *
+ * \code{.unparsed}
+$ ./waf --run "mmwave-phy-rx-trace-benchmark --ueNum=100 --slots=2000 --rbNum=66"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/mmwave-phy-rx-trace.h"
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWavePhyRxTraceBenchmark");
+
+/**
+ * \brief The sink of the previous implementation: one fopen per SINR report,
+ * and one flush per RxPacketTrace line
+ */
+class ReopeningSink
+{
+public:
+  ReopeningSink ()
+  {
+    m_rxPacketTrace.open ("legacy-RxPacketTrace.txt");
+    m_rxPacketTrace << "\tframe\tsubF\tslot\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler\tCcId" << std::endl;
+  }
+
+  void RxPacketTrace (const RxPacketTraceParams &params)
+  {
+    m_rxPacketTrace << "DL\t" << params.m_frameNum
+                    << "\t" << (unsigned)params.m_subframeNum
+                    << "\t" << (unsigned)params.m_slotNum
+                    << "\t" << (unsigned)params.m_symStart
+                    << "\t" << (unsigned)params.m_numSym
+                    << "\t" << params.m_cellId
+                    << "\t" << params.m_rnti
+                    << "\t" << params.m_tbSize
+                    << "\t" << (unsigned)params.m_mcs
+                    << "\t" << (unsigned)params.m_rv
+                    << "\t" << 10 * log10 (params.m_sinr)
+                    << "\t" << params.m_corrupt
+                    << "\t" << params.m_tbler
+                    << "\t" << (unsigned)params.m_ccId << std::endl;
+  }
+
+  void Sinr (uint64_t imsi, const SpectrumValue &sinr)
+  {
+    uint64_t tti_count = Now ().GetMicroSeconds () / 125;
+    uint32_t rb_count = 1;
+    char fname[255];
+    sprintf (fname, "legacy-UE_%llu_SINR_dB.txt", (long long unsigned) imsi);
+    FILE *log_file = fopen (fname, "a");
+    for (auto it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); ++it, ++rb_count)
+      {
+        fprintf (log_file, "%llu\t%llu\t%d\t%f\t \n",(long long unsigned) tti_count / 8 + 1, (long long unsigned) tti_count % 8 + 1, rb_count, 10 * log10 (*it));
+      }
+    fflush (log_file);
+    fclose (log_file);
+  }
+
+private:
+  std::ofstream m_rxPacketTrace;
+};
+
+/**
+ * \brief The sinks of the benchmark
+ */
+enum Sink
+{
+  NONE,      //!< Trace off
+  REOPENING, //!< Previous implementation
+  TEXT,      //!< MmWavePhyRxTrace, text output
+  BINARY,    //!< MmWavePhyRxTrace, binary output
+  ASYNC      //!< MmWavePhyRxTrace, binary output in the writer thread
+};
+
+/**
+ * \brief Replay the callbacks of the UEs
+ * \param sink the sink
+ * \param ueNum number of UEs
+ * \param slots number of slots
+ * \param rbNum number of RBs of the SINR reports
+ * \return the time per slot, in ns
+ */
+static double
+Run (Sink sink, uint32_t ueNum, uint32_t slots, uint32_t rbNum)
+{
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < rbNum; ++i)
+    {
+      freqs.push_back (28e9 + i * 1.44e6);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+  SpectrumValue sinr (model);
+  SpectrumValue power (model);
+
+  Ptr<MmWavePhyRxTrace> phyStats;
+  if (sink == TEXT || sink == BINARY || sink == ASYNC)
+    {
+      phyStats = CreateObject<MmWavePhyRxTrace> ();
+      phyStats->SetAttribute ("BinaryOutput", BooleanValue (sink != TEXT));
+      phyStats->SetAttribute ("AsyncWriter", BooleanValue (sink == ASYNC));
+    }
+  ReopeningSink *reopening = sink == REOPENING ? new ReopeningSink () : nullptr;
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  auto start = std::chrono::steady_clock::now ();
+  for (uint32_t slot = 0; slot < slots; ++slot)
+    {
+      for (uint32_t ue = 0; ue < ueNum; ++ue)
+        {
+          RxPacketTraceParams params;
+          params.m_cellId = 1 + ue % 7;
+          params.m_rnti = static_cast<uint16_t> (ue + 1);
+          params.m_frameNum = slot / 80;
+          params.m_subframeNum = static_cast<uint8_t> ((slot / 8) % 10);
+          params.m_slotNum = static_cast<uint16_t> (slot % 8);
+          params.m_varTtiNum = 0;
+          params.m_symStart = 1;
+          params.m_numSym = 13;
+          params.m_tbSize = 1000 + ue;
+          params.m_mcs = static_cast<uint8_t> (ue % 29);
+          params.m_rv = 0;
+          params.m_sinr = rng->GetValue (1.0, 1000.0);
+          params.m_sinrMin = params.m_sinr;
+          params.m_tbler = rng->GetValue ();
+          params.m_corrupt = params.m_tbler > 0.9;
+          params.m_ccId = 0;
+          params.m_rbAssignedNum = rbNum;
+          for (auto it = sinr.ValuesBegin (); it != sinr.ValuesEnd (); ++it)
+            {
+              *it = rng->GetValue (1.0, 1000.0);
+            }
+
+          switch (sink)
+            {
+            case NONE:
+              break;
+            case REOPENING:
+              reopening->RxPacketTrace (params);
+              reopening->Sinr (ue + 1, sinr);
+              break;
+            case TEXT:
+            case BINARY:
+            case ASYNC:
+              MmWavePhyRxTrace::RxPacketTraceUeCallback (phyStats, "", params);
+              MmWavePhyRxTrace::ReportCurrentCellRsrpSinrCallback (phyStats, "", ue + 1, sinr, power);
+              break;
+            }
+        }
+    }
+  // Closing the files (and draining the writer thread) is part of the cost
+  delete reopening;
+  if (phyStats)
+    {
+      phyStats->Dispose ();
+    }
+  auto end = std::chrono::steady_clock::now ();
+
+  return std::chrono::duration<double, std::nano> (end - start).count () / slots;
+}
+
+/**
+ * \brief Compare two files
+ * \param a name of a file
+ * \param b name of the other file
+ * \return true if they have the same content
+ */
+static bool
+SameContent (const std::string &a, const std::string &b)
+{
+  std::ifstream fa (a.c_str (), std::ios::binary);
+  std::ifstream fb (b.c_str (), std::ios::binary);
+  std::string ca ((std::istreambuf_iterator<char> (fa)), std::istreambuf_iterator<char> ());
+  std::string cb ((std::istreambuf_iterator<char> (fb)), std::istreambuf_iterator<char> ());
+  return fa.is_open () && fb.is_open () && ca == cb;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t ueNum = 100;
+  uint32_t slots = 2000;
+  uint32_t rbNum = 66;
+
+  CommandLine cmd;
+  cmd.AddValue ("ueNum", "Number of UEs", ueNum);
+  cmd.AddValue ("slots", "Number of slots to replay", slots);
+  cmd.AddValue ("rbNum", "Number of RBs of the SINR reports", rbNum);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (slots == 0 || rbNum == 0, "Invalid number of slots or RBs");
+
+  // Each run appends to the text files of the previous runs
+  std::remove ("RxPacketTrace.txt");
+  for (uint32_t ue = 1; ue <= ueNum; ++ue)
+    {
+      std::remove (("UE_" + std::to_string (ue) + "_SINR_dB.txt").c_str ());
+      std::remove (("legacy-UE_" + std::to_string (ue) + "_SINR_dB.txt").c_str ());
+    }
+
+  double noneNs = Run (NONE, ueNum, slots, rbNum);
+  double reopeningNs = Run (REOPENING, ueNum, slots, rbNum);
+  double textNs = Run (TEXT, ueNum, slots, rbNum);
+  double binaryNs = Run (BINARY, ueNum, slots, rbNum);
+  double asyncNs = Run (ASYNC, ueNum, slots, rbNum);
+
+  uint64_t rows = MmWavePhyRxTrace::ConvertToText ("RxPacketTrace.bin", "converted-");
+  rows += MmWavePhyRxTrace::ConvertToText ("DlSinr.bin", "converted-");
+
+  std::cout << "UEs: " << ueNum << ", RBs: " << rbNum << ", slots: " << slots << std::endl;
+  std::cout << "Trace off:            " << noneNs << " ns/slot" << std::endl;
+  std::cout << "Reopening text files: " << reopeningNs << " ns/slot" << std::endl;
+  std::cout << "Text files kept open: " << textNs << " ns/slot" << std::endl;
+  std::cout << "Binary columnar:      " << binaryNs << " ns/slot" << std::endl;
+  std::cout << "Binary, async writer: " << asyncNs << " ns/slot" << std::endl;
+  bool same = SameContent ("RxPacketTrace.txt", "converted-RxPacketTrace.txt");
+  for (uint32_t ue = 1; ue <= ueNum; ++ue)
+    {
+      const std::string sinrFile = "UE_" + std::to_string (ue) + "_SINR_dB.txt";
+      same = same && SameContent (sinrFile, "converted-" + sinrFile);
+    }
+  std::cout << "Converted " << rows << " binary rows to converted-*.txt, "
+            << (same ? "identical to" : "DIFFERENT from") << " the text output" << std::endl;
+
+  return 0;
+}
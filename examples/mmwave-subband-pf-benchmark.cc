@@ -0,0 +1,165 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file mmwave-subband-pf-benchmark.cc
+ * \ingroup examples
+ * \brief Benchmark of the DL RBG assignment of the sub-band PF scheduler
+ *
+ * The program calls, without a simulation, the DL RBG assignment of
+ * MmWaveMacSchedulerOfdmaSubbandPF and of MmWaveMacSchedulerOfdmaPF (which
+ * sorts the UEs for each RBG) in each slot, with ueNum UEs in one beam, a
+ * band of rbNum RB (one RB per RBG) and a random MCS for each UE and RBG.
+ * The buffers are large enough that all the RBG are assigned in each slot.
+ *
+ * The time spent per slot is printed for both schedulers, and the program
+ * aborts if an RBG is not assigned or if the MCS of a UE changes.
+ *
+ * \code{.unparsed}
+$ ./waf --run "mmwave-subband-pf-benchmark --ueNum=200 --rbNum=275 --slots=1000"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-mac-scheduler-ofdma-pf.h"
+#include "ns3/mmwave-mac-scheduler-ofdma-subband-pf.h"
+#include <chrono>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSubbandPfBenchmark");
+
+/**
+ * \brief A scheduler with the DL methods exposed to the benchmark
+ */
+template <class T>
+class BenchmarkScheduler : public T
+{
+public:
+  using T::CreateUeRepresentation;
+  using T::AssignDLRBG;
+};
+
+/**
+ * \return the time elapsed since start, in ms
+ * \param start the start time
+ */
+static double
+ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/**
+ * \brief Assign the DL RBG of a number of slots
+ * \param scheduler the scheduler
+ * \param config the configuration of the scheduler
+ * \param ueNum number of UEs
+ * \param slots number of slots
+ * \param subband whether the UEs have a MCS for each RBG
+ * \return the time spent per slot, in ms
+ */
+template <class T>
+static double
+RunSlots (Ptr<BenchmarkScheduler<T> > scheduler, Ptr<MmWavePhyMacCommon> config,
+          uint32_t ueNum, uint32_t slots, bool subband)
+{
+  scheduler->ConfigureCommonParameters (config);
+  const uint32_t rbgNum = config->GetBandwidthInRbg ();
+  const uint32_t sym = 12;
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  MmWaveMacSchedulerNs3::ActiveUeMap activeDl;
+  std::vector<uint8_t> wbMcs (ueNum);
+  for (uint32_t i = 0; i < ueNum; ++i)
+    {
+      MmWaveMacCschedSapProvider::CschedUeConfigReqParameters params;
+      params.m_rnti = static_cast<uint16_t> (i + 1);
+      auto ue = scheduler->CreateUeRepresentation (params);
+      ue->m_dlMcs = static_cast<uint8_t> (random->GetInteger (5, 28));
+      wbMcs[i] = ue->m_dlMcs;
+      if (subband)
+        {
+          ue->m_dlRbgMcs.resize (rbgNum);
+          for (uint32_t rbg = 0; rbg < rbgNum; ++rbg)
+            {
+              ue->m_dlRbgMcs[rbg] = static_cast<uint8_t> (random->GetInteger (0, ue->m_dlMcs));
+            }
+        }
+      activeDl[ue->m_beamId].emplace_back (ue, 1000000);
+    }
+
+  const auto start = std::chrono::steady_clock::now ();
+  for (uint32_t slot = 0; slot < slots; ++slot)
+    {
+      for (const auto & ue : activeDl.begin ()->second)
+        {
+          ue.first->ResetDlSchedInfo ();
+        }
+      scheduler->AssignDLRBG (sym, activeDl);
+    }
+  const double ms = ElapsedMs (start);
+
+  uint32_t assigned = 0;
+  for (uint32_t i = 0; i < ueNum; ++i)
+    {
+      const auto & ue = activeDl.begin ()->second.at (i).first;
+      assigned += ue->m_dlRBG / sym;
+      NS_ABORT_MSG_IF (ue->m_dlMcs != wbMcs[i], "The MCS of UE " << ue->m_rnti << " changed");
+    }
+  NS_ABORT_MSG_IF (assigned != rbgNum, "Assigned " << assigned << " RBG out of " << rbgNum);
+
+  return ms / slots;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t ueNum = 200;
+  uint32_t rbNum = 275;
+  uint32_t slots = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("ueNum", "Number of UEs", ueNum);
+  cmd.AddValue ("rbNum", "Number of RB (and of RBG) of the band", rbNum);
+  cmd.AddValue ("slots", "Number of slots", slots);
+  cmd.Parse (argc, argv);
+
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  config->SetRbNum (rbNum);
+  config->SetNumRbPerRbg (1);
+
+  const double pfMs = RunSlots (CreateObject<BenchmarkScheduler<MmWaveMacSchedulerOfdmaPF> > (),
+                                config, ueNum, slots, false);
+  std::cout << ueNum << " UEs, " << rbNum << " RBG, MmWaveMacSchedulerOfdmaPF: "
+            << pfMs << " ms per slot" << std::endl;
+
+  const double wbMs = RunSlots (CreateObject<BenchmarkScheduler<MmWaveMacSchedulerOfdmaSubbandPF> > (),
+                                config, ueNum, slots, false);
+  std::cout << ueNum << " UEs, " << rbNum << " RBG, MmWaveMacSchedulerOfdmaSubbandPF, wideband CQI: "
+            << wbMs << " ms per slot" << std::endl;
+
+  const double sbMs = RunSlots (CreateObject<BenchmarkScheduler<MmWaveMacSchedulerOfdmaSubbandPF> > (),
+                                config, ueNum, slots, true);
+  std::cout << ueNum << " UEs, " << rbNum << " RBG, MmWaveMacSchedulerOfdmaSubbandPF, sub-band CQI: "
+            << sbMs << " ms per slot" << std::endl;
+
+  return 0;
+}
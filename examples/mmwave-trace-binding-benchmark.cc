@@ -0,0 +1,194 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file mmwave-trace-binding-benchmark.cc
+ * \ingroup examples
+ * \brief Benchmark of the connection of the trace sinks at startup
+ *
+ * The program installs a number of gNBs and UEs with MmWaveHelper, and
+ * measures the time spent to connect the trace sinks:
+ *
+ * - at enable time, with the wildcard Config paths that MmWaveHelper and
+ *   MmWaveBearerStatsConnector used before (PHY and RRC trace sources), and
+ *   with MmWaveHelper::EnableTraces, which binds the sinks directly;
+ * - per UE, as done at each RRC connection event, with the Config path of
+ *   the RLC of the SRB0 of the UE, and directly on the RLC object.
+ *
+ * The sinks connected by the benchmark do nothing, and the simulation is
+ * not run.
+ *
+ * \code{.unparsed}
+$ ./waf --run "mmwave-trace-binding-benchmark --ueNum=5000 --gNbNum=10"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/lte-radio-bearer-info.h"
+#include "ns3/lte-rlc.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTraceBindingBenchmark");
+
+static void
+PhyRxSink (std::string path, RxPacketTraceParams params)
+{
+}
+
+static void
+TbSizeSink (std::string path, uint64_t imsi, uint64_t tbSize)
+{
+}
+
+static void
+RrcSink (std::string path, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+}
+
+static void
+NewUeContextSink (std::string path, uint16_t cellId, uint16_t rnti)
+{
+}
+
+static void
+HandoverStartSink (std::string path, uint64_t imsi, uint16_t cellId, uint16_t rnti, uint16_t targetCellId)
+{
+}
+
+static void
+RlcTxPduSink (std::string path, uint16_t rnti, uint8_t lcid, uint32_t size)
+{
+}
+
+/**
+ * \return the time elapsed since start, in ms
+ * \param start the start time
+ */
+static double
+ElapsedMs (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t ueNum = 2000;
+  uint32_t gNbNum = 4;
+
+  CommandLine cmd;
+  cmd.AddValue ("ueNum", "Number of UEs", ueNum);
+  cmd.AddValue ("gNbNum", "Number of gNBs", gNbNum);
+  cmd.Parse (argc, argv);
+
+  Ptr<MmWaveHelper> mmWaveHelper = CreateObject<MmWaveHelper> ();
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (gNbNum);
+  ueNodes.Create (ueNum);
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (100.0), "DeltaY", DoubleValue (100.0),
+                                 "GridWidth", UintegerValue (10));
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (5.0), "DeltaY", DoubleValue (5.0),
+                                 "GridWidth", UintegerValue (100));
+  mobility.Install (ueNodes);
+
+  auto start = std::chrono::steady_clock::now ();
+  NetDeviceContainer gNbDevs = mmWaveHelper->InstallEnbDevice (gNbNodes);
+  NetDeviceContainer ueDevs = mmWaveHelper->InstallUeDevice (ueNodes);
+  std::cout << "Install " << gNbNum << " gNBs and " << ueNum << " UEs: "
+            << ElapsedMs (start) << " ms" << std::endl;
+
+  // The wildcard paths used before by MmWaveHelper::EnableTraces
+  start = std::chrono::steady_clock::now ();
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+                   MakeCallback (&PhyRxSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/RxPacketTraceEnb",
+                   MakeCallback (&PhyRxSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/ReportDownlinkTbSize",
+                   MakeCallback (&TbSizeSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/NewUeContext", MakeCallback (&NewUeContextSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/RandomAccessSuccessful", MakeCallback (&RrcSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionReconfiguration", MakeCallback (&RrcSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/ConnectionReconfiguration", MakeCallback (&RrcSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverStart", MakeCallback (&HandoverStartSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverStart", MakeCallback (&HandoverStartSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverEndOk", MakeCallback (&RrcSink));
+  Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverEndOk", MakeCallback (&RrcSink));
+  const double configEnableMs = ElapsedMs (start);
+
+  start = std::chrono::steady_clock::now ();
+  mmWaveHelper->EnableTraces ();
+  const double directEnableMs = ElapsedMs (start);
+
+  std::cout << "Enable the traces, Config paths: " << configEnableMs << " ms" << std::endl;
+  std::cout << "Enable the traces, direct binding: " << directEnableMs << " ms" << std::endl;
+
+  // What is done for each UE at each RRC connection event
+  start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < ueDevs.GetN (); ++i)
+    {
+      Ptr<NetDevice> dev = ueDevs.Get (i);
+      std::ostringstream path;
+      path << "/NodeList/" << dev->GetNode ()->GetId () << "/DeviceList/" << dev->GetIfIndex ()
+           << "/LteUeRrc/Srb0/LteRlc/TxPDU";
+      Config::Connect (path.str (), MakeCallback (&RlcTxPduSink));
+    }
+  const double configUeMs = ElapsedMs (start);
+
+  start = std::chrono::steady_clock::now ();
+  uint32_t bound = 0;
+  for (uint32_t i = 0; i < ueDevs.GetN (); ++i)
+    {
+      Ptr<MmWaveUeNetDevice> dev = DynamicCast<MmWaveUeNetDevice> (ueDevs.Get (i));
+      PointerValue srb0;
+      dev->GetRrc ()->GetAttribute ("Srb0", srb0);
+      Ptr<LteRadioBearerInfo> bearer = srb0.Get<LteRadioBearerInfo> ();
+      if (bearer != 0 && bearer->m_rlc != 0)
+        {
+          std::ostringstream path;
+          path << "/NodeList/" << dev->GetNode ()->GetId () << "/DeviceList/" << dev->GetIfIndex ()
+               << "/LteUeRrc/Srb0/LteRlc/TxPDU";
+          bearer->m_rlc->TraceConnect ("TxPDU", path.str (), MakeCallback (&RlcTxPduSink));
+          ++bound;
+        }
+    }
+  const double directUeMs = ElapsedMs (start);
+
+  std::cout << "Bind the SRB0 RLC of " << bound << " UEs, Config paths: " << configUeMs
+            << " ms (" << configUeMs * 1000 / std::max<uint32_t> (ueNum, 1) << " us per UE)" << std::endl;
+  std::cout << "Bind the SRB0 RLC of " << bound << " UEs, direct binding: " << directUeMs
+            << " ms (" << directUeMs * 1000 / std::max<uint32_t> (ueNum, 1) << " us per UE)" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,83 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file mmwave-trace-convert.cc
+ * \ingroup examples
+ * \brief Convert a binary PHY trace to text files
+ *
+ * The program reads a binary trace written by MmWavePhyRxTrace with the
+ * attribute BinaryOutput (e.g., RxPacketTrace.bin or DlSinr.bin), and writes
+ * the text files that MmWavePhyRxTrace writes without it (RxPacketTrace.txt,
+ * or one UE_<imsi>_SINR_dB.txt per UE), with the given prefix. With --info,
+ * it prints the kind, the columns and the number of rows of the trace instead.
+ *
+ * \code{.unparsed}
+$ ./waf --run "mmwave-trace-convert --input=RxPacketTrace.bin --prefix=out/"
+    \endcode
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-phy-rx-trace.h"
+#include "ns3/mmwave-binary-trace.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTraceConvert");
+
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  std::string prefix;
+  bool info = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "The binary trace", input);
+  cmd.AddValue ("prefix", "Prefix of the names of the text files", prefix);
+  cmd.AddValue ("info", "Print the columns of the trace instead of converting it", info);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (input.empty (), "Please give the binary trace with --input");
+
+  if (info)
+    {
+      MmWaveBinaryTraceReader reader;
+      reader.Open (input);
+      std::cout << "Kind: " << reader.GetKind () << std::endl;
+      for (const auto & column : reader.GetColumns ())
+        {
+          std::cout << "Column: " << column.m_name << " ("
+                    << MmWaveBinaryTrace::GetSize (column.m_type) << " bytes)" << std::endl;
+        }
+      uint64_t rows = 0;
+      uint64_t blocks = 0;
+      while (reader.ReadBlock ())
+        {
+          rows += reader.GetNumRows ();
+          ++blocks;
+        }
+      std::cout << "Rows: " << rows << " in " << blocks << " blocks" << std::endl;
+      return 0;
+    }
+
+  uint64_t rows = MmWavePhyRxTrace::ConvertToText (input, prefix);
+  std::cout << "Converted " << rows << " rows of " << input << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,180 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-async-trace-writer.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <chrono>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveAsyncTraceWriter");
+
+/**
+ * Number of times the writer thread yields, when the ring is empty, before it
+ * waits on the condition variable
+ */
+static const uint32_t IDLE_SPINS = 64;
+
+MmWaveAsyncTraceWriter::~MmWaveAsyncTraceWriter ()
+{
+  Stop ();
+}
+
+void
+MmWaveAsyncTraceWriter::Start (uint32_t capacity, FullPolicy policy)
+{
+  NS_LOG_FUNCTION (this << capacity << policy);
+  NS_ABORT_MSG_IF (IsRunning (), "The trace writer is already running");
+  NS_ABORT_MSG_IF (capacity == 0, "The ring of the trace writer must have at least one slot");
+
+  uint64_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_ring.clear ();
+  m_ring.resize (size);
+  m_mask = size - 1;
+  m_policy = policy;
+  m_head = 0;
+  m_tail = 0;
+  m_stop = false;
+  m_sleeping = false;
+  m_dropped = 0;
+  m_thread = std::thread (&MmWaveAsyncTraceWriter::ThreadLoop, this);
+}
+
+bool
+MmWaveAsyncTraceWriter::IsRunning () const
+{
+  return m_thread.joinable ();
+}
+
+bool
+MmWaveAsyncTraceWriter::Push (std::function<void ()> record)
+{
+  if (! IsRunning ())
+    {
+      record ();
+      return true;
+    }
+
+  const uint64_t tail = m_tail.load (std::memory_order_relaxed);
+  while (tail - m_head.load (std::memory_order_acquire) > m_mask)
+    {
+      if (m_policy == DROP)
+        {
+          ++m_dropped;
+          return false;
+        }
+      std::this_thread::yield ();
+    }
+  m_ring[tail & m_mask] = std::move (record);
+  // Sequentially consistent, with the load of m_sleeping below: either the
+  // writer thread sees the record before it waits, or we see it waiting
+  m_tail.store (tail + 1);
+  if (m_sleeping.load ())
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_cv.notify_one ();
+    }
+  return true;
+}
+
+void
+MmWaveAsyncTraceWriter::Drain ()
+{
+  if (! IsRunning ())
+    {
+      return;
+    }
+  const uint64_t tail = m_tail.load (std::memory_order_relaxed);
+  while (m_head.load (std::memory_order_acquire) != tail)
+    {
+      std::this_thread::yield ();
+    }
+}
+
+void
+MmWaveAsyncTraceWriter::Stop ()
+{
+  if (! IsRunning ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_one ();
+  m_thread.join ();
+  m_ring.clear ();
+  if (m_dropped > 0)
+    {
+      NS_LOG_WARN ("The trace writer dropped " << m_dropped << " records because its ring was full");
+    }
+}
+
+uint64_t
+MmWaveAsyncTraceWriter::GetNumDropped () const
+{
+  return m_dropped;
+}
+
+void
+MmWaveAsyncTraceWriter::ThreadLoop ()
+{
+  uint32_t idle = 0;
+  while (true)
+    {
+      // Read m_stop before m_tail: the records pushed before Stop are run
+      const bool stop = m_stop.load ();
+      const uint64_t head = m_head.load (std::memory_order_relaxed);
+      if (head != m_tail.load (std::memory_order_acquire))
+        {
+          std::function<void ()> &record = m_ring[head & m_mask];
+          record ();
+          record = nullptr;
+          m_head.store (head + 1, std::memory_order_release);
+          idle = 0;
+          continue;
+        }
+      if (stop)
+        {
+          return;
+        }
+      if (++idle < IDLE_SPINS)
+        {
+          std::this_thread::yield ();
+          continue;
+        }
+
+      std::unique_lock<std::mutex> lock (m_mutex);
+      m_sleeping = true;
+      if (m_tail.load () == head && ! m_stop.load ())
+        {
+          // The timeout only bounds the wait if a wake-up is ever missed
+          m_cv.wait_for (lock, std::chrono::milliseconds (10));
+        }
+      m_sleeping = false;
+      idle = 0;
+    }
+}
+
+} // namespace ns3
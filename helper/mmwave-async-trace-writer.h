@@ -0,0 +1,127 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief A thread that formats and writes trace records
+ *
+ * The simulator thread (the only producer) pushes records, which are
+ * functions that format a line and write it to a file, in a bounded
+ * lock-free ring. A dedicated thread (the only consumer) runs them in the
+ * order in which they were pushed, so the content of each file is the same
+ * as if they were run by the simulator thread.
+ *
+ * When the ring is full, the producer either waits for a free slot (BLOCK,
+ * no record is lost) or drops the record (DROP, the simulator never waits,
+ * and the dropped records are counted).
+ *
+ * The records run in another thread: they must capture by value what they
+ * write (including Simulator::Now ()), and they must not touch the simulator,
+ * the logging, or any Ptr. The files they write must be touched only by the
+ * records until Drain() returns. When the writer is not running, Push() runs
+ * the record in the caller.
+ */
+class MmWaveAsyncTraceWriter
+{
+public:
+  /**
+   * \brief What Push() does when the ring is full
+   */
+  enum FullPolicy
+  {
+    BLOCK = 0, //!< Wait for the writer thread to free a slot
+    DROP = 1   //!< Drop the record
+  };
+
+  /**
+   * \brief Create a writer that is not running
+   */
+  MmWaveAsyncTraceWriter () = default;
+
+  /**
+   * \brief Run the records left, and join the thread
+   */
+  ~MmWaveAsyncTraceWriter ();
+
+  MmWaveAsyncTraceWriter (const MmWaveAsyncTraceWriter &) = delete;
+  MmWaveAsyncTraceWriter & operator= (const MmWaveAsyncTraceWriter &) = delete;
+
+  /**
+   * \brief Start the writer thread
+   * \param capacity number of records of the ring, rounded up to a power of 2
+   * \param policy what to do when the ring is full
+   */
+  void Start (uint32_t capacity, FullPolicy policy);
+
+  /**
+   * \return true if the writer thread is running
+   */
+  bool IsRunning () const;
+
+  /**
+   * \brief Hand a record to the writer thread
+   * \param record the record
+   * \return false if the record was dropped
+   */
+  bool Push (std::function<void ()> record);
+
+  /**
+   * \brief Wait until the writer thread has run all the records pushed
+   */
+  void Drain ();
+
+  /**
+   * \brief Run the records left, and join the thread
+   */
+  void Stop ();
+
+  /**
+   * \return the number of records dropped since Start
+   */
+  uint64_t GetNumDropped () const;
+
+private:
+  /**
+   * \brief The body of the writer thread
+   */
+  void ThreadLoop ();
+
+  std::vector<std::function<void ()> > m_ring; //!< The records
+  uint64_t m_mask {0};                         //!< Capacity of the ring, minus one
+  FullPolicy m_policy {BLOCK};                 //!< Policy when the ring is full
+  std::atomic<uint64_t> m_head {0};            //!< Records run by the writer thread
+  std::atomic<uint64_t> m_tail {0};            //!< Records pushed by the producer
+  std::atomic<bool> m_sleeping {false};        //!< True when the writer thread may wait on m_cv
+  std::atomic<bool> m_stop {false};            //!< True when the writer thread has to exit
+  std::mutex m_mutex;                          //!< Protects the wait on m_cv
+  std::condition_variable m_cv;                //!< Wakes up the writer thread
+  std::thread m_thread;                        //!< The writer thread
+  uint64_t m_dropped {0};                      //!< Records dropped
+};
+
+} // namespace ns3
@@ -29,6 +29,10 @@
 #include "mmwave-bearer-stats-calculator.h"
 #include "ns3/string.h"
 #include "ns3/nstime.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/abort.h"
 #include <ns3/log.h>
 #include <vector>
 #include <algorithm>
@@ -58,6 +62,7 @@ MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator (std::string protocolTy
 MmWaveBearerStatsCalculator::~MmWaveBearerStatsCalculator ()
 {
   NS_LOG_FUNCTION (this);
+  StopAsyncWriter ();
 }
 
 TypeId
@@ -97,6 +102,41 @@ MmWaveBearerStatsCalculator::GetTypeId (void)
                    StringValue ("UlPdcpStats.txt"),
                    MakeStringAccessor (&MmWaveBearerStatsCalculator::SetUlPdcpOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("EpochOutput",
+                   "Write, at the end of each epoch, a row per bearer with the statistics "
+                   "(including percentiles) of its PDUs, instead of a line per PDU",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveBearerStatsCalculator::m_epochOutput),
+                   MakeBooleanChecker ())
+    .AddAttribute ("QuantileAccuracy",
+                   "Relative accuracy of the percentiles of the delay and of the PDU size",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&MmWaveBearerStatsCalculator::m_quantileAccuracy),
+                   MakeDoubleChecker<double> (1e-4, 0.5))
+    .AddAttribute ("QuantileMaxBuckets",
+                   "Maximum number of buckets kept to compute the percentiles of a bearer",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&MmWaveBearerStatsCalculator::m_quantileMaxBuckets),
+                   MakeUintegerChecker<uint32_t> (16))
+    .AddAttribute ("AsyncWriter",
+                   "Format and write the PDU lines in a separate thread, drained at "
+                   "Simulator::Destroy, instead of the simulator thread",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveBearerStatsCalculator::m_asyncOutput),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncQueueSize",
+                   "Number of PDU lines that can wait for the writer thread "
+                   "(rounded up to a power of 2)",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&MmWaveBearerStatsCalculator::m_asyncQueueSize),
+                   MakeUintegerChecker<uint32_t> (1, 1u << 24))
+    .AddAttribute ("AsyncFullPolicy",
+                   "What to do with a PDU line when the queue of the writer thread is full: "
+                   "wait for the thread (no line is lost), or drop the line",
+                   EnumValue (MmWaveAsyncTraceWriter::BLOCK),
+                   MakeEnumAccessor (&MmWaveBearerStatsCalculator::m_asyncFullPolicy),
+                   MakeEnumChecker (MmWaveAsyncTraceWriter::BLOCK, "Block",
+                                    MmWaveAsyncTraceWriter::DROP, "Drop"))
   ;
   return tid;
 }
@@ -105,12 +145,47 @@ void
 MmWaveBearerStatsCalculator::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  StopAsyncWriter ();
+  m_endEpochEvent.Cancel ();
+  m_epochDestroyEvent.Cancel ();
   if (m_pendingOutput)
     {
       ShowResults ();
     }
 }
 
+void
+MmWaveBearerStatsCalculator::WriteRecord (std::function<void ()> record)
+{
+  if (! m_asyncOutput)
+    {
+      record ();
+      return;
+    }
+  if (! m_asyncWriter.IsRunning ())
+    {
+      m_asyncWriter.Start (m_asyncQueueSize, m_asyncFullPolicy);
+      m_asyncDestroyEvent = Simulator::ScheduleDestroy (&MmWaveBearerStatsCalculator::DestroyAsyncWriter, this);
+    }
+  m_asyncWriter.Push (std::move (record));
+}
+
+void
+MmWaveBearerStatsCalculator::StopAsyncWriter ()
+{
+  m_asyncDestroyEvent.Cancel ();
+  m_asyncWriter.Stop ();
+}
+
+void
+MmWaveBearerStatsCalculator::DestroyAsyncWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  StopAsyncWriter ();
+  m_ulOutFile.flush ();
+  m_dlOutFile.flush ();
+}
+
 void
 MmWaveBearerStatsCalculator::SetStartTime (Time t)
 {
@@ -142,32 +217,38 @@ MmWaveBearerStatsCalculator::UlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "UlTxPdu" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
-  if (!m_ulOutFile.is_open ())
+  if (m_epochOutput)
     {
-      m_ulOutFile.open (GetUlOutputFilename ().c_str (), std::ios_base::app);
+      if (StartEpoch ())
+        {
+          EpochStats &stats = GetEpochStats (m_ulEpochStats, cellId, imsi, rnti, lcid);
+          stats.m_txPdus++;
+          stats.m_txBytes += packetSize;
+          m_pendingOutput = true;
+        }
+      return;
     }
 
-  if (m_protocolType == "RLC")
-    {
-      m_ulOutFile << "RLC ";
-    }
-  else
-    {
-      m_ulOutFile << "PDCP ";
-    }
+  const Time now = Simulator::Now ();
+  WriteRecord ([this, now, cellId, rnti, lcid, packetSize] ()
+  {
+    if (!m_ulOutFile.is_open ())
+      {
+        m_ulOutFile.open (GetUlOutputFilename ().c_str (), std::ios_base::app);
+      }
 
-  m_ulOutFile << "UlTxPDU " << Simulator::Now () << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
+    if (m_protocolType == "RLC")
+      {
+        m_ulOutFile << "RLC ";
+      }
+    else
+      {
+        m_ulOutFile << "PDCP ";
+      }
 
-  /*ImsiLcidPair_t p (imsi, lcid);
-  if (Simulator::Now () >= m_startTime)
-    {
-      m_ulCellId[p] = cellId;
-      m_flowId[p] = LteFlowId_t (rnti, lcid);
-      m_ulTxPackets[p]++;
-      m_ulTxData[p] += packetSize;
-    }
-  m_pendingOutput = true;*/
+    m_ulOutFile << "UlTxPDU " << now << " " << cellId << " "
+                << rnti << " " << (uint32_t) lcid << " " << packetSize << " \n";
+  });
 }
 
 void
@@ -175,33 +256,38 @@ MmWaveBearerStatsCalculator::DlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlTxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
-  if (!m_dlOutFile.is_open ())
+  if (m_epochOutput)
     {
-      m_dlOutFile.open (GetDlOutputFilename ().c_str (), std::ios_base::app);
-    }
-
-  if (m_protocolType == "RLC")
-    {
-      m_dlOutFile << "RLC ";
-    }
-  else
-    {
-      m_dlOutFile << "PDCP ";
+      if (StartEpoch ())
+        {
+          EpochStats &stats = GetEpochStats (m_dlEpochStats, cellId, imsi, rnti, lcid);
+          stats.m_txPdus++;
+          stats.m_txBytes += packetSize;
+          m_pendingOutput = true;
+        }
+      return;
     }
 
-  m_dlOutFile << "DlTxPDU " << Simulator::Now () << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
+  const Time now = Simulator::Now ();
+  WriteRecord ([this, now, cellId, rnti, lcid, packetSize] ()
+  {
+    if (!m_dlOutFile.is_open ())
+      {
+        m_dlOutFile.open (GetDlOutputFilename ().c_str (), std::ios_base::app);
+      }
 
+    if (m_protocolType == "RLC")
+      {
+        m_dlOutFile << "RLC ";
+      }
+    else
+      {
+        m_dlOutFile << "PDCP ";
+      }
 
-  /*ImsiLcidPair_t p (imsi, lcid);
-  if (Simulator::Now () >= m_startTime)
-    {
-      m_dlCellId[p] = cellId;
-      m_flowId[p] = LteFlowId_t (rnti, lcid);
-      m_dlTxPackets[p]++;
-      m_dlTxData[p] += packetSize;
-    }
-  m_pendingOutput = true;*/
+    m_dlOutFile << "DlTxPDU " << now << " " << cellId << " "
+                << rnti << " " << (uint32_t) lcid << " " << packetSize << " \n";
+  });
 }
 
 void
@@ -210,41 +296,40 @@ MmWaveBearerStatsCalculator::UlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "UlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
-  if (!m_ulOutFile.is_open ())
-    {
-      m_ulOutFile.open (GetUlOutputFilename ().c_str (), std::ios_base::app);
-    }
-
-  if (m_protocolType == "RLC")
-    {
-      m_ulOutFile << "RLC ";
-    }
-  else
+  if (m_epochOutput)
     {
-      m_ulOutFile << "PDCP ";
+      if (StartEpoch ())
+        {
+          EpochStats &stats = GetEpochStats (m_ulEpochStats, cellId, imsi, rnti, lcid);
+          stats.m_rxPdus++;
+          stats.m_rxBytes += packetSize;
+          stats.m_delay.Add (delay);
+          stats.m_pduSize.Add (packetSize);
+          m_pendingOutput = true;
+        }
+      return;
     }
 
-  m_ulOutFile << "UlRxPDU " << Simulator::Now () << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
+  const Time now = Simulator::Now ();
+  WriteRecord ([this, now, cellId, rnti, lcid, packetSize, delay] ()
+  {
+    if (!m_ulOutFile.is_open ())
+      {
+        m_ulOutFile.open (GetUlOutputFilename ().c_str (), std::ios_base::app);
+      }
 
-  /*ImsiLcidPair_t p (imsi, lcid);
-  if (Simulator::Now () >= m_startTime)
-    {
-      m_ulCellId[p] = cellId;
-      m_ulRxPackets[p]++;
-      m_ulRxData[p] += packetSize;
+    if (m_protocolType == "RLC")
+      {
+        m_ulOutFile << "RLC ";
+      }
+    else
+      {
+        m_ulOutFile << "PDCP ";
+      }
 
-      Uint64StatsMap::iterator it = m_ulDelay.find (p);
-      if (it == m_ulDelay.end ())
-        {
-          NS_LOG_DEBUG (this << " Creating UL stats calculators for IMSI " << p.m_imsi << " and LCID " << (uint32_t) p.m_lcId);
-          m_ulDelay[p] = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
-          m_ulPduSize[p] = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
-        }
-      m_ulDelay[p]->Update (delay);
-      m_ulPduSize[p]->Update (packetSize);
-    }
-  m_pendingOutput = true;*/
+    m_ulOutFile << "UlRxPDU " << now << " " << cellId << " "
+                << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
+  });
 }
 
 void
@@ -252,41 +337,40 @@ MmWaveBearerStatsCalculator::DlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
-  if (!m_dlOutFile.is_open ())
+  if (m_epochOutput)
     {
-      m_dlOutFile.open (GetDlOutputFilename ().c_str (), std::ios_base::app);
+      if (StartEpoch ())
+        {
+          EpochStats &stats = GetEpochStats (m_dlEpochStats, cellId, imsi, rnti, lcid);
+          stats.m_rxPdus++;
+          stats.m_rxBytes += packetSize;
+          stats.m_delay.Add (delay);
+          stats.m_pduSize.Add (packetSize);
+          m_pendingOutput = true;
+        }
+      return;
     }
 
-  if (m_protocolType == "RLC")
-    {
-      m_dlOutFile << "RLC ";
-    }
-  else
-    {
-      m_dlOutFile << "PDCP ";
-    }
+  const Time now = Simulator::Now ();
+  WriteRecord ([this, now, cellId, rnti, lcid, packetSize, delay] ()
+  {
+    if (!m_dlOutFile.is_open ())
+      {
+        m_dlOutFile.open (GetDlOutputFilename ().c_str (), std::ios_base::app);
+      }
+
+    if (m_protocolType == "RLC")
+      {
+        m_dlOutFile << "RLC ";
+      }
+    else
+      {
+        m_dlOutFile << "PDCP ";
+      }
 
-  m_dlOutFile << "DlRxPDU " << Simulator::Now () << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
-
-  /* ImsiLcidPair_t p (imsi, lcid);
-   if (Simulator::Now () >= m_startTime)
-     {
-       m_dlCellId[p] = cellId;
-       m_dlRxPackets[p]++;
-       m_dlRxData[p] += packetSize;
-
-       Uint64StatsMap::iterator it = m_dlDelay.find (p);
-       if (it == m_dlDelay.end ())
-         {
-           NS_LOG_DEBUG (this << " Creating DL stats calculators for IMSI " << p.m_imsi << " and LCID " << (uint32_t) p.m_lcId);
-           m_dlDelay[p] = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
-           m_dlPduSize[p] = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
-         }
-       m_dlDelay[p]->Update (delay);
-       m_dlPduSize[p]->Update (packetSize);
-     }
-   m_pendingOutput = true;*/
+    m_dlOutFile << "DlRxPDU " << now << " " << cellId << " "
+                << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
+  });
 }
 
 void
@@ -296,6 +380,11 @@ MmWaveBearerStatsCalculator::ShowResults (void)
   NS_LOG_FUNCTION (this << GetUlOutputFilename ().c_str () << GetDlOutputFilename ().c_str ());
   NS_LOG_INFO ("Write Rlc Stats in " << GetUlOutputFilename ().c_str () << " and in " << GetDlOutputFilename ().c_str ());
 
+  // The PDU lines written so far come before the results in the files
+  m_asyncWriter.Drain ();
+  m_ulOutFile.flush ();
+  m_dlOutFile.flush ();
+
   std::ofstream ulOutFile;
   std::ofstream dlOutFile;
 
@@ -315,13 +404,15 @@ MmWaveBearerStatsCalculator::ShowResults (void)
           return;
         }
       m_firstWrite = false;
+      // The percentiles are only computed in the epoch mode
+      const std::string percentiles = m_epochOutput ? "\tp50\tp95\tp99" : "";
       ulOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      ulOutFile << "delay\tstdDev\tmin\tmax\t";
-      ulOutFile << "PduSize\tstdDev\tmin\tmax";
+      ulOutFile << "delay\tstdDev\tmin\tmax" << percentiles << "\t";
+      ulOutFile << "PduSize\tstdDev\tmin\tmax" << percentiles;
       ulOutFile << std::endl;
       dlOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      dlOutFile << "delay\tstdDev\tmin\tmax\t";
-      dlOutFile << "PduSize\tstdDev\tmin\tmax";
+      dlOutFile << "delay\tstdDev\tmin\tmax" << percentiles << "\t";
+      dlOutFile << "PduSize\tstdDev\tmin\tmax" << percentiles;
       dlOutFile << std::endl;
     }
   else
@@ -351,45 +442,7 @@ void
 MmWaveBearerStatsCalculator::WriteUlResults (std::ofstream& outFile)
 {
   NS_LOG_FUNCTION (this);
-
-  // Get the unique IMSI / LCID list
-
-  std::vector < ImsiLcidPair_t > pairVector;
-  for (Uint32Map::iterator it = m_ulTxPackets.begin (); it != m_ulTxPackets.end (); ++it)
-    {
-      if (find (pairVector.begin (), pairVector.end (), (*it).first) == pairVector.end ())
-        {
-          pairVector.push_back ((*it).first);
-        }
-    }
-
-  Time endTime = m_startTime + m_epochDuration;
-  for (std::vector<ImsiLcidPair_t>::iterator it = pairVector.begin (); it != pairVector.end (); ++it)
-    {
-      ImsiLcidPair_t p = *it;
-      outFile << m_startTime.GetNanoSeconds () / 1.0e9 << "\t";
-      outFile << endTime.GetNanoSeconds () / 1.0e9 << "\t";
-      outFile << GetUlCellId (p.m_imsi, p.m_lcId) << "\t";
-      outFile << p.m_imsi << "\t";
-      outFile << m_flowId[p].m_rnti << "\t";
-      outFile << (uint32_t) m_flowId[p].m_lcId << "\t";
-      outFile << GetUlTxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlTxData (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlRxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlRxData (p.m_imsi, p.m_lcId) << "\t";
-      std::vector<double> stats = GetUlDelayStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
-        {
-          outFile << (*it) * 1e-9 << "\t";
-        }
-      stats = GetUlPduSizeStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
-        {
-          outFile << (*it) << "\t";
-        }
-      outFile << std::endl;
-    }
-
+  WriteEpochResults (outFile, m_ulEpochStats);
   outFile.close ();
 }
 
@@ -397,45 +450,43 @@ void
 MmWaveBearerStatsCalculator::WriteDlResults (std::ofstream& outFile)
 {
   NS_LOG_FUNCTION (this);
+  WriteEpochResults (outFile, m_dlEpochStats);
+  outFile.close ();
+}
 
-  // Get the unique IMSI list
-  std::vector < ImsiLcidPair_t > pairVector;
-  for (Uint32Map::iterator it = m_dlTxPackets.begin (); it != m_dlTxPackets.end (); ++it)
-    {
-      if (find (pairVector.begin (), pairVector.end (), (*it).first) == pairVector.end ())
-        {
-          pairVector.push_back ((*it).first);
-        }
-    }
-
+void
+MmWaveBearerStatsCalculator::WriteEpochResults (std::ofstream& outFile, const EpochStatsMap &stats) const
+{
   Time endTime = m_startTime + m_epochDuration;
-  for (std::vector<ImsiLcidPair_t>::iterator pair = pairVector.begin (); pair != pairVector.end (); ++pair)
+  for (const auto & bearer : stats)
     {
-      ImsiLcidPair_t p = *pair;
+      const EpochStats &epoch = bearer.second;
       outFile << m_startTime.GetNanoSeconds () / 1.0e9 << "\t";
       outFile << endTime.GetNanoSeconds () / 1.0e9 << "\t";
-      outFile << GetDlCellId (p.m_imsi, p.m_lcId) << "\t";
-      outFile << p.m_imsi << "\t";
-      outFile << m_flowId[p].m_rnti << "\t";
-      outFile << (uint32_t) m_flowId[p].m_lcId << "\t";
-      outFile << GetDlTxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlTxData (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlRxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlRxData (p.m_imsi, p.m_lcId) << "\t";
-      std::vector<double> stats = GetDlDelayStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
-        {
-          outFile << (*it) * 1e-9 << "\t";
-        }
-      stats = GetDlPduSizeStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
-        {
-          outFile << (*it) << "\t";
-        }
-      outFile << std::endl;
+      outFile << bearer.first.m_cellId << "\t";
+      outFile << bearer.first.m_imsi << "\t";
+      outFile << epoch.m_rnti << "\t";
+      outFile << (uint32_t) bearer.first.m_lcId << "\t";
+      outFile << epoch.m_txPdus << "\t";
+      outFile << epoch.m_txBytes << "\t";
+      outFile << epoch.m_rxPdus << "\t";
+      outFile << epoch.m_rxBytes << "\t";
+      // The delay is in ns, and it is written in s
+      outFile << epoch.m_delay.GetMean () * 1e-9 << "\t";
+      outFile << epoch.m_delay.GetStddev () * 1e-9 << "\t";
+      outFile << epoch.m_delay.GetMin () * 1e-9 << "\t";
+      outFile << epoch.m_delay.GetMax () * 1e-9 << "\t";
+      outFile << epoch.m_delay.GetQuantile (0.5) * 1e-9 << "\t";
+      outFile << epoch.m_delay.GetQuantile (0.95) * 1e-9 << "\t";
+      outFile << epoch.m_delay.GetQuantile (0.99) * 1e-9 << "\t";
+      outFile << epoch.m_pduSize.GetMean () << "\t";
+      outFile << epoch.m_pduSize.GetStddev () << "\t";
+      outFile << epoch.m_pduSize.GetMin () << "\t";
+      outFile << epoch.m_pduSize.GetMax () << "\t";
+      outFile << epoch.m_pduSize.GetQuantile (0.5) << "\t";
+      outFile << epoch.m_pduSize.GetQuantile (0.95) << "\t";
+      outFile << epoch.m_pduSize.GetQuantile (0.99) << "\n";
     }
-
-  outFile.close ();
 }
 
 void
@@ -456,6 +507,9 @@ MmWaveBearerStatsCalculator::ResetResults (void)
   m_dlTxData.erase (m_dlTxData.begin (), m_dlTxData.end ());
   m_dlDelay.erase (m_dlDelay.begin (), m_dlDelay.end ());
   m_dlPduSize.erase (m_dlPduSize.begin (), m_dlPduSize.end ());
+
+  m_ulEpochStats.clear ();
+  m_dlEpochStats.clear ();
 }
 
 void
@@ -471,10 +525,73 @@ void
 MmWaveBearerStatsCalculator::EndEpoch (void)
 {
   NS_LOG_FUNCTION (this);
+  const bool active = m_pendingOutput;
   ShowResults ();
   ResetResults ();
   m_startTime += m_epochDuration;
-  m_endEpochEvent = Simulator::Schedule (m_epochDuration, &MmWaveBearerStatsCalculator::EndEpoch, this);
+  // After an epoch without PDUs, the next PDU schedules the end of its epoch
+  // (StartEpoch), so that an idle simulation does not run forever
+  if (active || !m_epochOutput)
+    {
+      m_endEpochEvent = Simulator::Schedule (m_epochDuration, &MmWaveBearerStatsCalculator::EndEpoch, this);
+    }
+}
+
+bool
+MmWaveBearerStatsCalculator::StartEpoch ()
+{
+  if (m_endEpochEvent.IsRunning ())
+    {
+      return true;
+    }
+  const Time now = Simulator::Now ();
+  if (now < m_startTime)
+    {
+      return false;
+    }
+  NS_ABORT_MSG_UNLESS (m_epochDuration.IsStrictlyPositive (), "The EpochDuration must be positive");
+
+  // Move to the epoch of the PDU, skipping the epochs without PDUs
+  const int64_t skipped = (now - m_startTime).GetTimeStep () / m_epochDuration.GetTimeStep ();
+  m_startTime += TimeStep (skipped * m_epochDuration.GetTimeStep ());
+  NS_LOG_LOGIC ("Epoch from " << m_startTime << " to " << m_startTime + m_epochDuration);
+  m_endEpochEvent = Simulator::Schedule (m_startTime + m_epochDuration - now,
+                                         &MmWaveBearerStatsCalculator::EndEpoch, this);
+  if (!m_epochDestroyEvent.IsRunning ())
+    {
+      m_epochDestroyEvent = Simulator::ScheduleDestroy (&MmWaveBearerStatsCalculator::EndLastEpoch, this);
+    }
+  return true;
+}
+
+void
+MmWaveBearerStatsCalculator::EndLastEpoch ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_pendingOutput)
+    {
+      ShowResults ();
+      ResetResults ();
+    }
+}
+
+MmWaveBearerStatsCalculator::EpochStats &
+MmWaveBearerStatsCalculator::GetEpochStats (EpochStatsMap &stats, uint16_t cellId, uint64_t imsi,
+                                            uint16_t rnti, uint8_t lcid)
+{
+  EpochKey key;
+  key.m_cellId = cellId;
+  key.m_imsi = imsi;
+  key.m_lcId = lcid;
+  auto it = stats.find (key);
+  if (it == stats.end ())
+    {
+      NS_LOG_DEBUG (this << " Creating the statistics of CellId " << cellId << " IMSI " << imsi
+                         << " LCID " << (uint32_t) lcid);
+      it = stats.emplace (key, EpochStats (m_quantileAccuracy, m_quantileMaxBuckets)).first;
+    }
+  it->second.m_rnti = rnti;
+  return it->second;
 }
 
 uint32_t
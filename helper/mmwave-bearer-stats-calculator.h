@@ -35,6 +35,9 @@
 #include "ns3/object.h"
 #include "ns3/basic-data-calculators.h"
 #include "ns3/lte-common.h"
+#include "ns3/event-id.h"
+#include "mmwave-async-trace-writer.h"
+#include "mmwave-quantile-sketch.h"
 #include <string>
 #include <map>
 #include <fstream>
@@ -72,6 +75,18 @@ typedef std::map<ImsiLcidPair_t, LteFlowId_t> FlowIdMap;
  *   - Average, min, max and standard deviation of PDU delay (delay is
  *     calculated from the generation of the PDU to its reception)
  *   - Average, min, max and standard deviation of PDU size
+ *
+ * By default, the statistics are not computed, and each PDU is written as a
+ * line of the output file. With the attribute EpochOutput, the PDUs are not
+ * written: their statistics are aggregated per (CellId, IMSI, LCID) in
+ * bounded memory, and the output file has one row per bearer and epoch,
+ * which adds the 50th, 95th and 99th percentiles of the delay and of the PDU
+ * size (from a MmWaveQuantileSketch) to the statistics above.
+ *
+ * With the attribute
+ * AsyncWriter, these lines are formatted and written by a
+ * MmWaveAsyncTraceWriter thread, which is drained at Simulator::Destroy and
+ * before the results of an epoch are written.
  */
 class MmWaveBearerStatsCalculator : public LteStatsCalculator
 {
@@ -398,6 +413,106 @@ private:
    */
   void EndEpoch (void);
 
+  /**
+   * Key of the statistics of an epoch: a bearer in a cell
+   */
+  struct EpochKey
+  {
+    uint16_t m_cellId; //!< CellId
+    uint64_t m_imsi;   //!< IMSI
+    uint8_t m_lcId;    //!< LCID
+
+    /**
+     * @param o another key
+     * @return true if this key comes before the other one, by CellId, IMSI and LCID
+     */
+    bool operator< (const EpochKey &o) const
+    {
+      return m_cellId < o.m_cellId
+             || (m_cellId == o.m_cellId && (m_imsi < o.m_imsi
+                                            || (m_imsi == o.m_imsi && m_lcId < o.m_lcId)));
+    }
+  };
+
+  /**
+   * Statistics of the PDUs of a bearer in a cell during an epoch, in
+   * bounded memory
+   */
+  struct EpochStats
+  {
+    /**
+     * Creates empty statistics
+     * @param accuracy relative accuracy of the percentiles
+     * @param maxBuckets maximum number of buckets of the percentile sketches
+     */
+    EpochStats (double accuracy, uint32_t maxBuckets)
+      : m_delay (accuracy, maxBuckets),
+        m_pduSize (accuracy, maxBuckets)
+    {
+    }
+
+    uint16_t m_rnti {0};            //!< C-RNTI of the last PDU
+    uint32_t m_txPdus {0};          //!< Transmitted PDUs
+    uint64_t m_txBytes {0};         //!< Transmitted bytes
+    uint32_t m_rxPdus {0};          //!< Received PDUs
+    uint64_t m_rxBytes {0};         //!< Received bytes
+    MmWaveQuantileSketch m_delay;   //!< Delay of the received PDUs, in ns
+    MmWaveQuantileSketch m_pduSize; //!< Size of the received PDUs, in bytes
+  };
+
+  /// Container: (CellId, IMSI, LCID), statistics of the epoch
+  typedef std::map<EpochKey, EpochStats> EpochStatsMap;
+
+  /**
+   * Starts the epochs, if needed, at the first PDU or at the first PDU after
+   * an epoch without PDUs, and schedules the end of the current epoch
+   * @return false if the PDU comes before StartTime, and it must be ignored
+   */
+  bool StartEpoch ();
+
+  /**
+   * Gets the statistics of a bearer in the current epoch, creating them
+   * @param stats the UL or DL statistics
+   * @param cellId CellId of the PDU
+   * @param imsi IMSI of the PDU
+   * @param rnti C-RNTI of the PDU
+   * @param lcid LCID of the PDU
+   * @return the statistics of the bearer
+   */
+  EpochStats & GetEpochStats (EpochStatsMap &stats, uint16_t cellId, uint64_t imsi, uint16_t rnti, uint8_t lcid);
+
+  /**
+   * Writes a row per bearer with the statistics of the current epoch
+   * @param outFile the output file
+   * @param stats the UL or DL statistics
+   */
+  void WriteEpochResults (std::ofstream& outFile, const EpochStatsMap &stats) const;
+
+  /**
+   * Writes the statistics of the epoch in progress; scheduled at
+   * Simulator::Destroy when the epochs start
+   */
+  void EndLastEpoch ();
+
+  /**
+   * Writes a PDU line, in the writer thread with AsyncWriter, in the
+   * simulator thread otherwise
+   * @param record the function that writes the line, which captures by value
+   * what it writes
+   */
+  void WriteRecord (std::function<void ()> record);
+
+  /**
+   * Drains and stops the writer thread, if it is running
+   */
+  void StopAsyncWriter ();
+
+  /**
+   * Drains and stops the writer thread, and flushes the output files;
+   * scheduled at Simulator::Destroy when the thread starts
+   */
+  void DestroyAsyncWriter ();
+
   EventId m_endEpochEvent; //!< Event id for next end epoch event
 
   FlowIdMap m_flowId; //!< List of FlowIds, ie. (RNTI, LCID) by (IMSI, LCID) pair
@@ -455,6 +570,20 @@ private:
 
   std::ofstream m_dlOutFile;
   std::ofstream m_ulOutFile;
+
+  bool m_epochOutput {false};        //!< True to write the statistics of each epoch instead of the PDUs
+  double m_quantileAccuracy {0.01};  //!< Relative accuracy of the percentiles
+  uint32_t m_quantileMaxBuckets {1024}; //!< Maximum number of buckets of the percentile sketches
+  EpochStatsMap m_ulEpochStats;      //!< UL statistics of the current epoch
+  EpochStatsMap m_dlEpochStats;      //!< DL statistics of the current epoch
+  EventId m_epochDestroyEvent;       //!< Output of the last epoch at Simulator::Destroy
+
+  bool m_asyncOutput {false};        //!< True to write the PDU lines in a separate thread
+  uint32_t m_asyncQueueSize {65536}; //!< Lines of the queue of the writer thread
+  MmWaveAsyncTraceWriter::FullPolicy m_asyncFullPolicy {MmWaveAsyncTraceWriter::BLOCK}; //!< Policy when the queue is full
+  // Declared after the files, so that the thread stops before they are destroyed
+  MmWaveAsyncTraceWriter m_asyncWriter; //!< The writer thread
+  EventId m_asyncDestroyEvent;          //!< Drain of the writer thread at Simulator::Destroy
 };
 
 } // namespace ns3
@@ -30,12 +30,17 @@
 #include "mmwave-bearer-stats-connector.h"
 
 #include <ns3/log.h>
-
+#include <ns3/node-list.h>
+#include <ns3/pointer.h>
+#include <ns3/object-map.h>
 
 #include <ns3/lte-enb-rrc.h>
 #include <ns3/lte-enb-net-device.h>
 #include <ns3/lte-ue-rrc.h>
 #include <ns3/lte-ue-net-device.h>
+#include <ns3/lte-radio-bearer-info.h>
+#include <ns3/mmwave-enb-net-device.h>
+#include <ns3/mmwave-ue-net-device.h>
 
 namespace ns3 {
 
@@ -134,11 +139,93 @@ UlRxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
 
 
 
+/**
+ * Get a signaling radio bearer of an UE RRC or of an UE manager
+ * \param owner the UE RRC or the UE manager, or 0
+ * \param name the name of the bearer attribute ("Srb0" or "Srb1")
+ * \return the radio bearer, or 0 if it does not exist (yet)
+ */
+static Ptr<LteRadioBearerInfo>
+GetSignalingBearer (Ptr<Object> owner, const std::string &name)
+{
+  if (owner == 0)
+    {
+      return 0;
+    }
+  PointerValue bearer;
+  owner->GetAttribute (name, bearer);
+  return bearer.Get<LteRadioBearerInfo> ();
+}
+
+/**
+ * Connect a trace sink to a PDU trace source of the RLC or of the PDCP of a
+ * radio bearer, directly on the object
+ * \param bearer the radio bearer, or 0
+ * \param path the Config path of the radio bearer, used to build the context
+ * \param rlc true for the RLC, false for the PDCP
+ * \param source the trace source ("TxPDU" or "RxPDU")
+ * \param cb the trace sink
+ */
+static void
+ConnectBearerTrace (Ptr<LteRadioBearerInfo> bearer, const std::string &path, bool rlc,
+                    const std::string &source, const CallbackBase &cb)
+{
+  if (bearer == 0)
+    {
+      return;
+    }
+  Ptr<Object> layer;
+  if (rlc)
+    {
+      layer = bearer->m_rlc;
+    }
+  else
+    {
+      layer = bearer->m_pdcp;
+    }
+  if (layer != 0)
+    {
+      layer->TraceConnect (source, path + (rlc ? "/LteRlc/" : "/LtePdcp/") + source, cb);
+    }
+}
+
+/**
+ * Connect a trace sink to a PDU trace source of the RLC or of the PDCP of all
+ * the data radio bearers of an UE RRC or of an UE manager
+ * \param owner the UE RRC or the UE manager, or 0
+ * \param path the Config path of the owner, used to build the context
+ * \param rlc true for the RLC, false for the PDCP
+ * \param source the trace source ("TxPDU" or "RxPDU")
+ * \param cb the trace sink
+ */
+static void
+ConnectDataBearerTraces (Ptr<Object> owner, const std::string &path, bool rlc,
+                         const std::string &source, const CallbackBase &cb)
+{
+  if (owner == 0)
+    {
+      return;
+    }
+  ObjectMapValue drbs;
+  owner->GetAttribute ("DataRadioBearerMap", drbs);
+  for (ObjectMapValue::Iterator it = drbs.Begin (); it != drbs.End (); ++it)
+    {
+      std::ostringstream drbPath;
+      drbPath << path << "/DataRadioBearerMap/" << it->first;
+      ConnectBearerTrace (DynamicCast<LteRadioBearerInfo> (it->second), drbPath.str (), rlc, source, cb);
+    }
+}
+
+
 MmWaveBearerStatsConnector::MmWaveBearerStatsConnector ()
   : m_connected (false)
 {
 }
 
+MmWaveBearerStatsConnector::~MmWaveBearerStatsConnector ()
+{
+}
+
 void
 MmWaveBearerStatsConnector::EnableRlcStats (Ptr<MmWaveBearerStatsCalculator> rlcStats)
 {
@@ -159,26 +246,121 @@ MmWaveBearerStatsConnector::EnsureConnected ()
   NS_LOG_FUNCTION (this);
   if (!m_connected)
     {
-      Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/NewUeContext",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyNewUeContextEnb, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/RandomAccessSuccessful",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyRandomAccessSuccessfulUe, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionReconfiguration",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyConnectionReconfigurationEnb, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/ConnectionReconfiguration",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyConnectionReconfigurationUe, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverStart",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverStartEnb, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverStart",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverStartUe, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverEndOk",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverEndOkEnb, this));
-      Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverEndOk",
-                       MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverEndOkUe, this));
+      // Walk the devices once, instead of resolving a wildcard path for each
+      // trace source; the devices installed later are registered by the helper
+      for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+        {
+          for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+            {
+              ConnectRrcTraces ((*node)->GetDevice (i));
+            }
+        }
       m_connected = true;
     }
 }
 
+void
+MmWaveBearerStatsConnector::RegisterDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  if (m_connected)
+    {
+      ConnectRrcTraces (device);
+    }
+}
+
+void
+MmWaveBearerStatsConnector::Clear ()
+{
+  NS_LOG_FUNCTION (this);
+  m_ueRrcByPath.clear ();
+  m_enbRrcByPath.clear ();
+  m_ueManagerByCellIdRnti.clear ();
+}
+
+void
+MmWaveBearerStatsConnector::ConnectRrcTraces (Ptr<NetDevice> device)
+{
+  Ptr<LteEnbRrc> enbRrc;
+  Ptr<LteUeRrc> ueRrc;
+  if (Ptr<MmWaveEnbNetDevice> mmWaveEnb = DynamicCast<MmWaveEnbNetDevice> (device))
+    {
+      enbRrc = mmWaveEnb->GetRrc ();
+    }
+  else if (Ptr<MmWaveUeNetDevice> mmWaveUe = DynamicCast<MmWaveUeNetDevice> (device))
+    {
+      ueRrc = mmWaveUe->GetRrc ();
+    }
+  else if (Ptr<LteEnbNetDevice> lteEnb = DynamicCast<LteEnbNetDevice> (device))
+    {
+      enbRrc = lteEnb->GetRrc ();
+    }
+  else if (Ptr<LteUeNetDevice> lteUe = DynamicCast<LteUeNetDevice> (device))
+    {
+      ueRrc = lteUe->GetRrc ();
+    }
+  if (enbRrc == 0 && ueRrc == 0)
+    {
+      return;
+    }
+
+  // The contexts are the ones of the Config paths, which the sinks use to
+  // find the RRC back
+  std::ostringstream devicePath;
+  devicePath << "/NodeList/" << device->GetNode ()->GetId () << "/DeviceList/" << device->GetIfIndex ();
+  if (enbRrc != 0)
+    {
+      const std::string path = devicePath.str () + "/LteEnbRrc";
+      NS_LOG_LOGIC (this << " binding " << path);
+      m_enbRrcByPath[path] = enbRrc;
+      enbRrc->TraceConnect ("NewUeContext", path + "/NewUeContext",
+                            MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyNewUeContextEnb, this));
+      enbRrc->TraceConnect ("ConnectionReconfiguration", path + "/ConnectionReconfiguration",
+                            MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyConnectionReconfigurationEnb, this));
+      enbRrc->TraceConnect ("HandoverStart", path + "/HandoverStart",
+                            MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverStartEnb, this));
+      enbRrc->TraceConnect ("HandoverEndOk", path + "/HandoverEndOk",
+                            MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverEndOkEnb, this));
+    }
+  else
+    {
+      const std::string path = devicePath.str () + "/LteUeRrc";
+      NS_LOG_LOGIC (this << " binding " << path);
+      m_ueRrcByPath[path] = ueRrc;
+      ueRrc->TraceConnect ("RandomAccessSuccessful", path + "/RandomAccessSuccessful",
+                           MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyRandomAccessSuccessfulUe, this));
+      ueRrc->TraceConnect ("ConnectionReconfiguration", path + "/ConnectionReconfiguration",
+                           MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyConnectionReconfigurationUe, this));
+      ueRrc->TraceConnect ("HandoverStart", path + "/HandoverStart",
+                           MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverStartUe, this));
+      ueRrc->TraceConnect ("HandoverEndOk", path + "/HandoverEndOk",
+                           MakeBoundCallback (&MmWaveBearerStatsConnector::NotifyHandoverEndOkUe, this));
+    }
+}
+
+Ptr<LteUeRrc>
+MmWaveBearerStatsConnector::GetUeRrc (const std::string &path) const
+{
+  auto it = m_ueRrcByPath.find (path);
+  if (it == m_ueRrcByPath.end ())
+    {
+      NS_LOG_LOGIC (this << " no UE RRC registered at " << path);
+      return 0;
+    }
+  return it->second;
+}
+
+Ptr<LteEnbRrc>
+MmWaveBearerStatsConnector::GetEnbRrc (const std::string &path) const
+{
+  auto it = m_enbRrcByPath.find (path);
+  if (it == m_enbRrcByPath.end ())
+    {
+      NS_LOG_LOGIC (this << " no eNB RRC registered at " << path);
+      return 0;
+    }
+  return it->second;
+}
 void
 MmWaveBearerStatsConnector::NotifyRandomAccessSuccessfulUe (MmWaveBearerStatsConnector* c, std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti)
 {
@@ -212,7 +394,7 @@ MmWaveBearerStatsConnector::NotifyHandoverEndOkUe (MmWaveBearerStatsConnector* c
 void
 MmWaveBearerStatsConnector::NotifyNewUeContextEnb (MmWaveBearerStatsConnector* c, std::string context, uint16_t cellId, uint16_t rnti)
 {
-  c->StoreUeManagerPath (context, cellId, rnti);
+  c->StoreUeManager (context, cellId, rnti);
 }
 
 void
@@ -234,15 +416,23 @@ MmWaveBearerStatsConnector::NotifyHandoverEndOkEnb (MmWaveBearerStatsConnector*
 }
 
 void
-MmWaveBearerStatsConnector::StoreUeManagerPath (std::string context, uint16_t cellId, uint16_t rnti)
+MmWaveBearerStatsConnector::StoreUeManager (std::string context, uint16_t cellId, uint16_t rnti)
 {
   NS_LOG_FUNCTION (this << context << cellId << rnti);
+  const std::string enbRrcPath = context.substr (0, context.rfind ("/"));
   std::ostringstream ueManagerPath;
-  ueManagerPath <<  context.substr (0, context.rfind ("/")) << "/UeMap/" << (uint32_t) rnti;
+  ueManagerPath << enbRrcPath << "/UeMap/" << (uint32_t) rnti;
+  UeManagerEntry entry;
+  Ptr<LteEnbRrc> enbRrc = GetEnbRrc (enbRrcPath);
+  if (enbRrc != 0 && enbRrc->HasUeManager (rnti))
+    {
+      entry.ueManager = enbRrc->GetUeManager (rnti);
+    }
+  entry.path = ueManagerPath.str ();
   CellIdRnti key;
   key.cellId = cellId;
   key.rnti = rnti;
-  m_ueManagerPathByCellIdRnti[key] = ueManagerPath.str ();
+  m_ueManagerByCellIdRnti[key] = entry;
 }
 
 void
@@ -253,11 +443,16 @@ MmWaveBearerStatsConnector::ConnectSrb0Traces (std::string context, uint64_t ims
   CellIdRnti key;
   key.cellId = cellId;
   key.rnti = rnti;
-  std::map<CellIdRnti, std::string>::iterator it = m_ueManagerPathByCellIdRnti.find (key);
-  NS_ASSERT (it != m_ueManagerPathByCellIdRnti.end ());
-  std::string ueManagerPath = it->second;
-  NS_LOG_LOGIC (this << " ueManagerPath: " << ueManagerPath);
-  m_ueManagerPathByCellIdRnti.erase (it);
+  std::map<CellIdRnti, UeManagerEntry>::iterator it = m_ueManagerByCellIdRnti.find (key);
+  NS_ASSERT (it != m_ueManagerByCellIdRnti.end ());
+  const UeManagerEntry ueManager = it->second;
+  NS_LOG_LOGIC (this << " ueManagerPath: " << ueManager.path);
+  m_ueManagerByCellIdRnti.erase (it);
+
+  Ptr<LteUeRrc> ueRrc = GetUeRrc (ueRrcPath);
+  Ptr<LteRadioBearerInfo> ueSrb0 = GetSignalingBearer (ueRrc, "Srb0");
+  Ptr<LteRadioBearerInfo> enbSrb0 = GetSignalingBearer (ueManager.ueManager, "Srb0");
+  Ptr<LteRadioBearerInfo> enbSrb1 = GetSignalingBearer (ueManager.ueManager, "Srb1");
 
   if (m_rlcStats)
     {
@@ -266,31 +461,21 @@ MmWaveBearerStatsConnector::ConnectSrb0Traces (std::string context, uint64_t ims
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
 
-      // diconnect eventually previously connected SRB0 both at UE and eNB
-      Config::Disconnect (ueRrcPath + "/Srb0/LteRlc/TxPDU",
+      // connect SRB0 both at UE and eNB
+      ConnectBearerTrace (ueSrb0, ueRrcPath + "/Srb0", true, "TxPDU",
                           MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Disconnect (ueRrcPath + "/Srb0/LteRlc/RxPDU",
+      ConnectBearerTrace (ueSrb0, ueRrcPath + "/Srb0", true, "RxPDU",
                           MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Disconnect (ueManagerPath + "/Srb0/LteRlc/TxPDU",
+      ConnectBearerTrace (enbSrb0, ueManager.path + "/Srb0", true, "TxPDU",
                           MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Disconnect (ueManagerPath + "/Srb0/LteRlc/RxPDU",
+      ConnectBearerTrace (enbSrb0, ueManager.path + "/Srb0", true, "RxPDU",
                           MakeBoundCallback (&UlRxPduCallback, arg));
 
-      // connect SRB0 both at UE and eNB
-      Config::Connect (ueRrcPath + "/Srb0/LteRlc/TxPDU",
-                       MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (ueRrcPath + "/Srb0/LteRlc/RxPDU",
-                       MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb0/LteRlc/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb0/LteRlc/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
-
       // connect SRB1 at eNB only (at UE SRB1 will be setup later)
-      Config::Connect (ueManagerPath + "/Srb1/LteRlc/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb1/LteRlc/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
+      ConnectBearerTrace (enbSrb1, ueManager.path + "/Srb1", true, "TxPDU",
+                          MakeBoundCallback (&DlTxPduCallback, arg));
+      ConnectBearerTrace (enbSrb1, ueManager.path + "/Srb1", true, "RxPDU",
+                          MakeBoundCallback (&UlRxPduCallback, arg));
     }
   if (m_pdcpStats)
     {
@@ -300,10 +485,10 @@ MmWaveBearerStatsConnector::ConnectSrb0Traces (std::string context, uint64_t ims
       arg->stats = m_pdcpStats;
 
       // connect SRB1 at eNB only (at UE SRB1 will be setup later)
-      Config::Connect (ueManagerPath + "/Srb1/LtePdcp/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (ueManagerPath + "/Srb1/LtePdcp/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
+      ConnectBearerTrace (enbSrb1, ueManager.path + "/Srb1", false, "RxPDU",
+                          MakeBoundCallback (&UlRxPduCallback, arg));
+      ConnectBearerTrace (enbSrb1, ueManager.path + "/Srb1", false, "TxPDU",
+                          MakeBoundCallback (&DlTxPduCallback, arg));
     }
 }
 
@@ -311,16 +496,17 @@ void
 MmWaveBearerStatsConnector::ConnectSrb1TracesUe (std::string ueRrcPath, uint64_t imsi, uint16_t cellId, uint16_t rnti)
 {
   NS_LOG_FUNCTION (this << imsi << cellId << rnti);
+  Ptr<LteRadioBearerInfo> srb1 = GetSignalingBearer (GetUeRrc (ueRrcPath), "Srb1");
   if (m_rlcStats)
     {
       Ptr<MmWaveBoundCallbackArgument> arg = Create<MmWaveBoundCallbackArgument> ();
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
-      Config::Connect (ueRrcPath + "/Srb1/LteRlc/TxPDU",
-                       MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (ueRrcPath + "/Srb1/LteRlc/RxPDU",
-                       MakeBoundCallback (&DlRxPduCallback, arg));
+      ConnectBearerTrace (srb1, ueRrcPath + "/Srb1", true, "TxPDU",
+                          MakeBoundCallback (&UlTxPduCallback, arg));
+      ConnectBearerTrace (srb1, ueRrcPath + "/Srb1", true, "RxPDU",
+                          MakeBoundCallback (&DlRxPduCallback, arg));
     }
   if (m_pdcpStats)
     {
@@ -328,10 +514,10 @@ MmWaveBearerStatsConnector::ConnectSrb1TracesUe (std::string ueRrcPath, uint64_t
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_pdcpStats;
-      Config::Connect (ueRrcPath + "/Srb1/LtePdcp/RxPDU",
-                       MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Connect (ueRrcPath + "/Srb1/LtePdcp/TxPDU",
-                       MakeBoundCallback (&UlTxPduCallback, arg));
+      ConnectBearerTrace (srb1, ueRrcPath + "/Srb1", false, "RxPDU",
+                          MakeBoundCallback (&DlRxPduCallback, arg));
+      ConnectBearerTrace (srb1, ueRrcPath + "/Srb1", false, "TxPDU",
+                          MakeBoundCallback (&UlTxPduCallback, arg));
     }
 }
 
@@ -363,20 +549,22 @@ MmWaveBearerStatsConnector::ConnectTracesUe (std::string context, uint64_t imsi,
   NS_LOG_FUNCTION (this << context);
   NS_LOG_LOGIC (this << "expected context should match /NodeList/*/DeviceList/*/LteUeRrc/");
   std::string basePath = context.substr (0, context.rfind ("/"));
+  Ptr<LteUeRrc> ueRrc = GetUeRrc (basePath);
+  Ptr<LteRadioBearerInfo> srb1 = GetSignalingBearer (ueRrc, "Srb1");
   if (m_rlcStats)
     {
       Ptr<MmWaveBoundCallbackArgument> arg = Create<MmWaveBoundCallbackArgument> ();
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LteRlc/TxPDU",
-                       MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LteRlc/RxPDU",
-                       MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Connect (basePath + "/Srb1/LteRlc/TxPDU",
-                       MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (basePath + "/Srb1/LteRlc/RxPDU",
-                       MakeBoundCallback (&DlRxPduCallback, arg));
+      ConnectDataBearerTraces (ueRrc, basePath, true, "TxPDU",
+                               MakeBoundCallback (&UlTxPduCallback, arg));
+      ConnectDataBearerTraces (ueRrc, basePath, true, "RxPDU",
+                               MakeBoundCallback (&DlRxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath + "/Srb1", true, "TxPDU",
+                          MakeBoundCallback (&UlTxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath + "/Srb1", true, "RxPDU",
+                          MakeBoundCallback (&DlRxPduCallback, arg));
 
     }
   if (m_pdcpStats)
@@ -385,14 +573,14 @@ MmWaveBearerStatsConnector::ConnectTracesUe (std::string context, uint64_t imsi,
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_pdcpStats;
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LtePdcp/RxPDU",
-                       MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Connect (basePath + "/DataRadioBearerMap/*/LtePdcp/TxPDU",
-                       MakeBoundCallback (&UlTxPduCallback, arg));
-      Config::Connect (basePath + "/Srb1/LtePdcp/RxPDU",
-                       MakeBoundCallback (&DlRxPduCallback, arg));
-      Config::Connect (basePath + "/Srb1/LtePdcp/TxPDU",
-                       MakeBoundCallback (&UlTxPduCallback, arg));
+      ConnectDataBearerTraces (ueRrc, basePath, false, "RxPDU",
+                               MakeBoundCallback (&DlRxPduCallback, arg));
+      ConnectDataBearerTraces (ueRrc, basePath, false, "TxPDU",
+                               MakeBoundCallback (&UlTxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath + "/Srb1", false, "RxPDU",
+                          MakeBoundCallback (&DlRxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath + "/Srb1", false, "TxPDU",
+                          MakeBoundCallback (&UlTxPduCallback, arg));
     }
 }
 
@@ -401,26 +589,35 @@ MmWaveBearerStatsConnector::ConnectTracesEnb (std::string context, uint64_t imsi
 {
   NS_LOG_FUNCTION (this << context);
   NS_LOG_LOGIC (this << "expected context  should match /NodeList/*/DeviceList/*/LteEnbRrc/");
+  const std::string enbRrcPath = context.substr (0, context.rfind ("/"));
   std::ostringstream basePath;
-  basePath <<  context.substr (0, context.rfind ("/")) << "/UeMap/" << (uint32_t) rnti;
+  basePath << enbRrcPath << "/UeMap/" << (uint32_t) rnti;
+  Ptr<UeManager> ueManager;
+  Ptr<LteEnbRrc> enbRrc = GetEnbRrc (enbRrcPath);
+  if (enbRrc != 0 && enbRrc->HasUeManager (rnti))
+    {
+      ueManager = enbRrc->GetUeManager (rnti);
+    }
+  Ptr<LteRadioBearerInfo> srb0 = GetSignalingBearer (ueManager, "Srb0");
+  Ptr<LteRadioBearerInfo> srb1 = GetSignalingBearer (ueManager, "Srb1");
   if (m_rlcStats)
     {
       Ptr<MmWaveBoundCallbackArgument> arg = Create<MmWaveBoundCallbackArgument> ();
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_rlcStats;
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LteRlc/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LteRlc/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb0/LteRlc/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb0/LteRlc/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb1/LteRlc/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb1/LteRlc/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
+      ConnectDataBearerTraces (ueManager, basePath.str (), true, "RxPDU",
+                               MakeBoundCallback (&UlRxPduCallback, arg));
+      ConnectDataBearerTraces (ueManager, basePath.str (), true, "TxPDU",
+                               MakeBoundCallback (&DlTxPduCallback, arg));
+      ConnectBearerTrace (srb0, basePath.str () + "/Srb0", true, "RxPDU",
+                          MakeBoundCallback (&UlRxPduCallback, arg));
+      ConnectBearerTrace (srb0, basePath.str () + "/Srb0", true, "TxPDU",
+                          MakeBoundCallback (&DlTxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath.str () + "/Srb1", true, "RxPDU",
+                          MakeBoundCallback (&UlRxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath.str () + "/Srb1", true, "TxPDU",
+                          MakeBoundCallback (&DlTxPduCallback, arg));
     }
   if (m_pdcpStats)
     {
@@ -428,14 +625,14 @@ MmWaveBearerStatsConnector::ConnectTracesEnb (std::string context, uint64_t imsi
       arg->imsi = imsi;
       arg->cellId = cellId;
       arg->stats = m_pdcpStats;
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LtePdcp/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (basePath.str () + "/DataRadioBearerMap/*/LtePdcp/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb1/LtePdcp/TxPDU",
-                       MakeBoundCallback (&DlTxPduCallback, arg));
-      Config::Connect (basePath.str () + "/Srb1/LtePdcp/RxPDU",
-                       MakeBoundCallback (&UlRxPduCallback, arg));
+      ConnectDataBearerTraces (ueManager, basePath.str (), false, "TxPDU",
+                               MakeBoundCallback (&DlTxPduCallback, arg));
+      ConnectDataBearerTraces (ueManager, basePath.str (), false, "RxPDU",
+                               MakeBoundCallback (&UlRxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath.str () + "/Srb1", false, "TxPDU",
+                          MakeBoundCallback (&DlTxPduCallback, arg));
+      ConnectBearerTrace (srb1, basePath.str () + "/Srb1", false, "RxPDU",
+                          MakeBoundCallback (&UlRxPduCallback, arg));
     }
 }
 
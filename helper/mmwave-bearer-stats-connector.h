@@ -37,10 +37,16 @@
 
 #include <set>
 #include <map>
+#include <string>
+#include <unordered_map>
 
 namespace ns3 {
 
 class MmWaveBearerStatsCalculator;
+class NetDevice;
+class LteEnbRrc;
+class LteUeRrc;
+class UeManager;
 
 /**
  * \ingroup lte
@@ -51,6 +57,11 @@ class MmWaveBearerStatsCalculator;
  * Usually user do not use this class. All he/she needs to
  * to do is to call: LteHelper::EnablePdcpTraces() and/or
  * LteHelper::EnableRlcTraces().
+ *
+ * The trace sinks are bound directly to the RRC objects of the devices, and
+ * then to the RLC and PDCP objects of the radio bearers when the UEs connect,
+ * without resolving any Config path: the cost of each RRC event does not
+ * depend on the number of nodes.
  */
 
 class MmWaveBearerStatsConnector
@@ -59,6 +70,9 @@ public:
   /// Constructor
   MmWaveBearerStatsConnector ();
 
+  /// Destructor
+  ~MmWaveBearerStatsConnector ();
+
   /**
    * Enables trace sinks for RLC layer. Usually, this function
    * is called by LteHelper::EnableRlcTraces().
@@ -74,10 +88,26 @@ public:
   void EnablePdcpStats (Ptr<MmWaveBearerStatsCalculator> pdcpStats);
 
   /**
-   * Connects trace sinks to appropriate trace sources
+   * Connects trace sinks to appropriate trace sources of the RRC of all
+   * the devices installed
    */
   void EnsureConnected ();
 
+  /**
+   * Connects trace sinks to the trace sources of the RRC of a device
+   * installed after EnsureConnected. Usually, this function is called
+   * by MmWaveHelper when it installs a device.
+   * \param device the device
+   */
+  void RegisterDevice (Ptr<NetDevice> device);
+
+  /**
+   * Releases the RRCs and the UE Managers recorded by their Config path.
+   * Usually, this function is called by MmWaveHelper when it is disposed.
+   * The RRC events that come later do not connect the RLC and PDCP traces.
+   */
+  void Clear ();
+
   // trace sinks, to be used with MakeBoundCallback
 
   /**
@@ -181,12 +211,31 @@ public:
 
 private:
   /**
-   * Creates UE Manager path and stores it in m_ueManagerPathByCellIdRnti
-   * \param ueManagerPath
+   * Connects trace sinks to the trace sources of the RRC of a device, if it
+   * has one, and registers the RRC with its Config path
+   * \param device the device
+   */
+  void ConnectRrcTraces (Ptr<NetDevice> device);
+
+  /**
+   * \param path the Config path of an UE RRC
+   * \return the UE RRC registered with the path, or 0
+   */
+  Ptr<LteUeRrc> GetUeRrc (const std::string &path) const;
+
+  /**
+   * \param path the Config path of an eNB RRC
+   * \return the eNB RRC registered with the path, or 0
+   */
+  Ptr<LteEnbRrc> GetEnbRrc (const std::string &path) const;
+
+  /**
+   * Finds the UE Manager, creates its path and stores both in m_ueManagerByCellIdRnti
+   * \param context
    * \param cellId
    * \param rnti
    */
-  void StoreUeManagerPath (std::string ueManagerPath, uint16_t cellId, uint16_t rnti);
+  void StoreUeManager (std::string context, uint16_t cellId, uint16_t rnti);
 
   /**
    * Connects Srb0 trace sources at UE and eNB to RLC and PDCP calculators,
@@ -273,8 +322,11 @@ private:
   std::set<uint64_t> m_imsiSeenUe; //!< stores all UEs for which RLC and PDCP traces were connected
   std::set<uint64_t> m_imsiSeenEnb; //!< stores all eNBs for which RLC and PDCP traces were connected
 
+  std::unordered_map<std::string, Ptr<LteUeRrc> > m_ueRrcByPath; //!< UE RRCs by Config path
+  std::unordered_map<std::string, Ptr<LteEnbRrc> > m_enbRrcByPath; //!< eNB RRCs by Config path
+
   /**
-   * Struct used as key in m_ueManagerPathByCellIdRnti map
+   * Struct used as key in m_ueManagerByCellIdRnti map
    */
   struct CellIdRnti
   {
@@ -288,9 +340,19 @@ private:
   friend bool operator < (const CellIdRnti &a, const CellIdRnti &b);
 
   /**
-   * List UE Manager Paths by CellIdRnti
+   * UE Manager and its path, from the creation of the UE context to the
+   * end of the random access
+   */
+  struct UeManagerEntry
+  {
+    Ptr<UeManager> ueManager; //!< UE Manager, or 0 if not found
+    std::string path; //!< Config path of the UE Manager
+  };
+
+  /**
+   * List UE Managers by CellIdRnti
    */
-  std::map<CellIdRnti, std::string> m_ueManagerPathByCellIdRnti;
+  std::map<CellIdRnti, UeManagerEntry> m_ueManagerByCellIdRnti;
 
 };
 
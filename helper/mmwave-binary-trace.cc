@@ -0,0 +1,361 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-binary-trace.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <cstdint>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBinaryTrace");
+
+const char MmWaveBinaryTrace::MAGIC[8] = {'N', 'R', 'B', 'T', 'R', 'C', '0', '1'};
+const uint32_t MmWaveBinaryTrace::ENDIANNESS_MARK = 0x01020304;
+
+uint32_t
+MmWaveBinaryTrace::GetSize (Type type)
+{
+  switch (type)
+    {
+    case UINT8:
+      return 1;
+    case UINT16:
+      return 2;
+    case UINT32:
+      return 4;
+    case UINT64:
+      return 8;
+    case DOUBLE:
+      return sizeof (double);
+    }
+  NS_FATAL_ERROR ("Unknown column type " << static_cast<uint32_t> (type));
+  return 0;
+}
+
+MmWaveBinaryTraceWriter::~MmWaveBinaryTraceWriter ()
+{
+  Close ();
+}
+
+void
+MmWaveBinaryTraceWriter::Open (const std::string &fileName, const std::string &kind,
+                               const std::vector<MmWaveBinaryTrace::Column> &columns,
+                               uint32_t rowsPerBlock)
+{
+  // No logging in the writer: it may run in the thread of a MmWaveAsyncTraceWriter
+  NS_ASSERT_MSG (! IsOpen (), "The binary trace is already open");
+  NS_ASSERT (rowsPerBlock > 0);
+
+  m_file.open (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "Could not open the binary trace " << fileName);
+
+  m_columns = columns;
+  m_rowsPerBlock = rowsPerBlock;
+  m_rows = 0;
+  m_totalRows = 0;
+  m_data.assign (columns.size (), std::vector<char> ());
+  for (uint32_t i = 0; i < columns.size (); ++i)
+    {
+      m_data[i].reserve (static_cast<size_t> (rowsPerBlock) * MmWaveBinaryTrace::GetSize (columns[i].m_type));
+    }
+
+  const uint32_t kindLength = static_cast<uint32_t> (kind.size ());
+  const uint32_t numColumns = static_cast<uint32_t> (columns.size ());
+  m_file.write (MmWaveBinaryTrace::MAGIC, sizeof (MmWaveBinaryTrace::MAGIC));
+  m_file.write (reinterpret_cast<const char *> (&MmWaveBinaryTrace::ENDIANNESS_MARK), 4);
+  m_file.write (reinterpret_cast<const char *> (&kindLength), 4);
+  m_file.write (kind.data (), kindLength);
+  m_file.write (reinterpret_cast<const char *> (&numColumns), 4);
+  for (const auto & column : columns)
+    {
+      const uint32_t nameLength = static_cast<uint32_t> (column.m_name.size ());
+      m_file.write (reinterpret_cast<const char *> (&column.m_type), 1);
+      m_file.write (reinterpret_cast<const char *> (&nameLength), 4);
+      m_file.write (column.m_name.data (), nameLength);
+    }
+}
+
+bool
+MmWaveBinaryTraceWriter::IsOpen () const
+{
+  return m_file.is_open ();
+}
+
+void
+MmWaveBinaryTraceWriter::Put (uint32_t column, const void *value)
+{
+  NS_ASSERT (column < m_columns.size ());
+  const uint32_t size = MmWaveBinaryTrace::GetSize (m_columns[column].m_type);
+  std::vector<char> &data = m_data[column];
+  NS_ASSERT_MSG (data.size () == static_cast<size_t> (m_rows) * size,
+                 "Column " << m_columns[column].m_name << " already set in this row");
+  const char *bytes = static_cast<const char *> (value);
+  data.insert (data.end (), bytes, bytes + size);
+}
+
+void
+MmWaveBinaryTraceWriter::SetUint (uint32_t column, uint64_t value)
+{
+  NS_ASSERT (column < m_columns.size ());
+  switch (m_columns[column].m_type)
+    {
+    case MmWaveBinaryTrace::UINT8:
+      {
+        NS_ASSERT (value <= UINT8_MAX);
+        const uint8_t v = static_cast<uint8_t> (value);
+        Put (column, &v);
+        break;
+      }
+    case MmWaveBinaryTrace::UINT16:
+      {
+        NS_ASSERT (value <= UINT16_MAX);
+        const uint16_t v = static_cast<uint16_t> (value);
+        Put (column, &v);
+        break;
+      }
+    case MmWaveBinaryTrace::UINT32:
+      {
+        NS_ASSERT (value <= UINT32_MAX);
+        const uint32_t v = static_cast<uint32_t> (value);
+        Put (column, &v);
+        break;
+      }
+    case MmWaveBinaryTrace::UINT64:
+      Put (column, &value);
+      break;
+    case MmWaveBinaryTrace::DOUBLE:
+      NS_FATAL_ERROR ("Integer value for the double column " << m_columns[column].m_name);
+    }
+}
+
+void
+MmWaveBinaryTraceWriter::SetDouble (uint32_t column, double value)
+{
+  NS_ASSERT (column < m_columns.size ());
+  NS_ASSERT_MSG (m_columns[column].m_type == MmWaveBinaryTrace::DOUBLE,
+                 "Double value for the integer column " << m_columns[column].m_name);
+  Put (column, &value);
+}
+
+void
+MmWaveBinaryTraceWriter::EndRow ()
+{
+  NS_ASSERT_MSG (IsOpen (), "The binary trace is not open");
+  ++m_rows;
+  ++m_totalRows;
+  for (uint32_t i = 0; i < m_columns.size (); ++i)
+    {
+      NS_ASSERT_MSG (m_data[i].size () == static_cast<size_t> (m_rows) * MmWaveBinaryTrace::GetSize (m_columns[i].m_type),
+                     "Column " << m_columns[i].m_name << " not set in this row");
+    }
+  if (m_rows == m_rowsPerBlock)
+    {
+      WriteBlock ();
+    }
+}
+
+void
+MmWaveBinaryTraceWriter::WriteBlock ()
+{
+  if (m_rows == 0)
+    {
+      return;
+    }
+  m_file.write (reinterpret_cast<const char *> (&m_rows), 4);
+  for (auto & data : m_data)
+    {
+      m_file.write (data.data (), static_cast<std::streamsize> (data.size ()));
+      data.clear ();
+    }
+  m_rows = 0;
+}
+
+void
+MmWaveBinaryTraceWriter::Flush ()
+{
+  if (IsOpen ())
+    {
+      WriteBlock ();
+      m_file.flush ();
+    }
+}
+
+void
+MmWaveBinaryTraceWriter::Close ()
+{
+  if (IsOpen ())
+    {
+      WriteBlock ();
+      m_file.close ();
+    }
+}
+
+uint64_t
+MmWaveBinaryTraceWriter::GetNumRows () const
+{
+  return m_totalRows;
+}
+
+void
+MmWaveBinaryTraceReader::Open (const std::string &fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  m_fileName = fileName;
+  m_file.open (fileName.c_str (), std::ios::in | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "Could not open the binary trace " << fileName);
+
+  char magic[sizeof (MmWaveBinaryTrace::MAGIC)];
+  uint32_t byteOrder = 0;
+  m_file.read (magic, sizeof (magic));
+  m_file.read (reinterpret_cast<char *> (&byteOrder), 4);
+  NS_ABORT_MSG_UNLESS (m_file && std::memcmp (magic, MmWaveBinaryTrace::MAGIC, sizeof (magic)) == 0,
+                       fileName << " is not a binary trace");
+  NS_ABORT_MSG_UNLESS (byteOrder == MmWaveBinaryTrace::ENDIANNESS_MARK,
+                       fileName << " was written with a different byte order");
+
+  m_kind = ReadString ();
+  uint32_t numColumns = 0;
+  m_file.read (reinterpret_cast<char *> (&numColumns), 4);
+  m_columns.clear ();
+  for (uint32_t i = 0; i < numColumns && m_file; ++i)
+    {
+      MmWaveBinaryTrace::Column column;
+      uint8_t type = 0;
+      m_file.read (reinterpret_cast<char *> (&type), 1);
+      NS_ABORT_MSG_UNLESS (type <= MmWaveBinaryTrace::DOUBLE, "Unknown column type in " << fileName);
+      column.m_type = static_cast<MmWaveBinaryTrace::Type> (type);
+      column.m_name = ReadString ();
+      m_columns.push_back (column);
+    }
+  NS_ABORT_MSG_UNLESS (m_file, "Truncated header in " << fileName);
+  m_data.assign (m_columns.size (), std::vector<char> ());
+  m_rows = 0;
+}
+
+std::string
+MmWaveBinaryTraceReader::ReadString ()
+{
+  uint32_t length = 0;
+  m_file.read (reinterpret_cast<char *> (&length), 4);
+  std::string s (m_file ? length : 0, '\0');
+  m_file.read (&s[0], static_cast<std::streamsize> (s.size ()));
+  return s;
+}
+
+const std::string &
+MmWaveBinaryTraceReader::GetKind () const
+{
+  return m_kind;
+}
+
+const std::vector<MmWaveBinaryTrace::Column> &
+MmWaveBinaryTraceReader::GetColumns () const
+{
+  return m_columns;
+}
+
+uint32_t
+MmWaveBinaryTraceReader::GetColumnIndex (const std::string &name) const
+{
+  for (uint32_t i = 0; i < m_columns.size (); ++i)
+    {
+      if (m_columns[i].m_name == name)
+        {
+          return i;
+        }
+    }
+  NS_FATAL_ERROR ("No column " << name << " in " << m_fileName);
+  return 0;
+}
+
+bool
+MmWaveBinaryTraceReader::ReadBlock ()
+{
+  m_rows = 0;
+  uint32_t rows = 0;
+  if (! m_file.read (reinterpret_cast<char *> (&rows), 4))
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < m_columns.size (); ++i)
+    {
+      m_data[i].resize (static_cast<size_t> (rows) * MmWaveBinaryTrace::GetSize (m_columns[i].m_type));
+      m_file.read (m_data[i].data (), static_cast<std::streamsize> (m_data[i].size ()));
+    }
+  NS_ABORT_MSG_UNLESS (m_file, "Truncated block in " << m_fileName);
+  m_rows = rows;
+  return true;
+}
+
+uint32_t
+MmWaveBinaryTraceReader::GetNumRows () const
+{
+  return m_rows;
+}
+
+uint64_t
+MmWaveBinaryTraceReader::GetUint (uint32_t column, uint32_t row) const
+{
+  NS_ASSERT (column < m_columns.size () && row < m_rows);
+  const char *p = m_data[column].data ();
+  switch (m_columns[column].m_type)
+    {
+    case MmWaveBinaryTrace::UINT8:
+      {
+        uint8_t v;
+        std::memcpy (&v, p + row, 1);
+        return v;
+      }
+    case MmWaveBinaryTrace::UINT16:
+      {
+        uint16_t v;
+        std::memcpy (&v, p + 2 * static_cast<size_t> (row), 2);
+        return v;
+      }
+    case MmWaveBinaryTrace::UINT32:
+      {
+        uint32_t v;
+        std::memcpy (&v, p + 4 * static_cast<size_t> (row), 4);
+        return v;
+      }
+    case MmWaveBinaryTrace::UINT64:
+      {
+        uint64_t v;
+        std::memcpy (&v, p + 8 * static_cast<size_t> (row), 8);
+        return v;
+      }
+    case MmWaveBinaryTrace::DOUBLE:
+      break;
+    }
+  NS_FATAL_ERROR ("The column " << m_columns[column].m_name << " is not an integer one");
+  return 0;
+}
+
+double
+MmWaveBinaryTraceReader::GetDouble (uint32_t column, uint32_t row) const
+{
+  NS_ASSERT (column < m_columns.size () && row < m_rows);
+  NS_ASSERT_MSG (m_columns[column].m_type == MmWaveBinaryTrace::DOUBLE,
+                 "The column " << m_columns[column].m_name << " is not a double one");
+  double v;
+  std::memcpy (&v, m_data[column].data () + sizeof (double) * static_cast<size_t> (row), sizeof (double));
+  return v;
+}
+
+} // namespace ns3
@@ -0,0 +1,244 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief The columns of a binary trace
+ *
+ * A binary trace file starts with a header:
+ *
+ * - the magic string "NRBTRC01" (8 bytes);
+ * - the 32 bit value 0x01020304, to check the byte order;
+ * - the kind of the trace (a 32 bit length and the characters);
+ * - the number of columns (32 bit) and, for each column, its type (8 bit)
+ *   and its name (a 32 bit length and the characters).
+ *
+ * It continues with blocks of rows. A block has the number of its rows
+ * (32 bit), followed by the values of each column, one column after the
+ * other. The values are stored with the size of their type, in the byte
+ * order of the machine that wrote the file.
+ */
+class MmWaveBinaryTrace
+{
+public:
+  /**
+   * \brief The type of a column
+   */
+  enum Type : uint8_t
+  {
+    UINT8 = 0,  //!< 8 bit unsigned integer
+    UINT16 = 1, //!< 16 bit unsigned integer
+    UINT32 = 2, //!< 32 bit unsigned integer
+    UINT64 = 3, //!< 64 bit unsigned integer
+    DOUBLE = 4  //!< double
+  };
+
+  /**
+   * \brief A column of a binary trace
+   */
+  struct Column
+  {
+    std::string m_name; //!< Name of the column
+    Type m_type;        //!< Type of the values
+  };
+
+  /**
+   * \param type a type
+   * \return the size of a value of the type, in bytes
+   */
+  static uint32_t GetSize (Type type);
+
+  static const char MAGIC[8];            //!< First bytes of a binary trace
+  static const uint32_t ENDIANNESS_MARK; //!< Value that checks the byte order
+};
+
+/**
+ * \brief Write a binary trace, a block of rows at a time
+ *
+ * The values of a row are set one column at a time, with SetUint or
+ * SetDouble, and EndRow closes the row. The rows are kept in memory, one
+ * buffer per column, and written with one write per column when a block is
+ * full, by Flush, or by Close. The destructor closes the file.
+ *
+ * \see MmWaveBinaryTrace for the format
+ */
+class MmWaveBinaryTraceWriter
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  MmWaveBinaryTraceWriter () = default;
+
+  /**
+   * \brief Destructor: close the file
+   */
+  ~MmWaveBinaryTraceWriter ();
+
+  /**
+   * \brief Create the file, and write the header
+   * \param fileName name of the file
+   * \param kind the kind of the trace, stored in the header
+   * \param columns the columns
+   * \param rowsPerBlock number of rows kept in memory before a write
+   */
+  void Open (const std::string &fileName, const std::string &kind,
+             const std::vector<MmWaveBinaryTrace::Column> &columns,
+             uint32_t rowsPerBlock);
+
+  /**
+   * \return true if the file is open
+   */
+  bool IsOpen () const;
+
+  /**
+   * \brief Set an integer value of the current row
+   * \param column index of the column, which must be an integer one
+   * \param value the value, which must fit in the column type
+   */
+  void SetUint (uint32_t column, uint64_t value);
+
+  /**
+   * \brief Set a double value of the current row
+   * \param column index of the column, which must be a DOUBLE one
+   * \param value the value
+   */
+  void SetDouble (uint32_t column, double value);
+
+  /**
+   * \brief Close the current row, in which all the columns must be set
+   */
+  void EndRow ();
+
+  /**
+   * \brief Write the rows kept in memory, and flush the file
+   */
+  void Flush ();
+
+  /**
+   * \brief Write the rows kept in memory, and close the file
+   */
+  void Close ();
+
+  /**
+   * \return the number of rows written, or kept in memory, since Open
+   */
+  uint64_t GetNumRows () const;
+
+private:
+  /**
+   * \brief Write the rows kept in memory as a block
+   */
+  void WriteBlock ();
+
+  /**
+   * \brief Store a value in the buffer of a column
+   * \param column index of the column
+   * \param value pointer to the value
+   */
+  void Put (uint32_t column, const void *value);
+
+  std::ofstream m_file;                            //!< The file
+  std::vector<MmWaveBinaryTrace::Column> m_columns; //!< The columns
+  std::vector<std::vector<char> > m_data;          //!< Values of the rows in memory, one buffer per column
+  uint32_t m_rowsPerBlock {0};                     //!< Rows per block
+  uint32_t m_rows {0};                             //!< Rows in memory
+  uint64_t m_totalRows {0};                        //!< Rows since Open
+};
+
+/**
+ * \brief Read a binary trace, a block of rows at a time
+ *
+ * \see MmWaveBinaryTrace for the format
+ */
+class MmWaveBinaryTraceReader
+{
+public:
+  /**
+   * \brief Open a file, and read its header; abort if it is not a binary trace
+   * \param fileName name of the file
+   */
+  void Open (const std::string &fileName);
+
+  /**
+   * \return the kind of the trace
+   */
+  const std::string & GetKind () const;
+
+  /**
+   * \return the columns of the trace
+   */
+  const std::vector<MmWaveBinaryTrace::Column> & GetColumns () const;
+
+  /**
+   * \brief Find a column
+   * \param name name of the column
+   * \return the index of the column; abort if there is none with the name
+   */
+  uint32_t GetColumnIndex (const std::string &name) const;
+
+  /**
+   * \brief Read the next block
+   * \return false at the end of the file
+   */
+  bool ReadBlock ();
+
+  /**
+   * \return the number of rows of the last block read
+   */
+  uint32_t GetNumRows () const;
+
+  /**
+   * \brief Get an integer value of the last block read
+   * \param column index of an integer column
+   * \param row index of the row in the block
+   * \return the value
+   */
+  uint64_t GetUint (uint32_t column, uint32_t row) const;
+
+  /**
+   * \brief Get a double value of the last block read
+   * \param column index of a DOUBLE column
+   * \param row index of the row in the block
+   * \return the value
+   */
+  double GetDouble (uint32_t column, uint32_t row) const;
+
+private:
+  /**
+   * \brief Read a string stored as length and characters
+   * \return the string
+   */
+  std::string ReadString ();
+
+  std::ifstream m_file;                             //!< The file
+  std::string m_fileName;                           //!< Name of the file
+  std::string m_kind;                               //!< Kind of the trace
+  std::vector<MmWaveBinaryTrace::Column> m_columns; //!< The columns
+  std::vector<std::vector<char> > m_data;           //!< Values of the last block, one buffer per column
+  uint32_t m_rows {0};                              //!< Rows of the last block
+};
+
+} // namespace ns3
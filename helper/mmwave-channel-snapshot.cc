@@ -0,0 +1,731 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-channel-snapshot.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/simulator.h>
+#include <ns3/node.h>
+#include <ns3/node-list.h>
+#include <ns3/mobility-model.h>
+#include <ns3/mmwave-ue-net-device.h>
+#include <ns3/mmwave-enb-net-device.h>
+#include <ns3/mmwave-ue-phy.h>
+#include <ns3/mmwave-enb-phy.h>
+#include <ns3/mmwave-spectrum-phy.h>
+#include <ns3/antenna-array-model.h>
+#include <ns3/mmwave-3gpp-propagation-loss-model.h>
+#include <ns3/mmwave-3gpp-buildings-propagation-loss-model.h>
+#include <complex>
+#include <cstring>
+#include <fstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveChannelSnapshot");
+
+const char MmWaveChannelSnapshot::MAGIC[8] = {'N', 'R', 'C', 'H', 'S', 'N', '0', '1'};
+const uint32_t MmWaveChannelSnapshot::ENDIANNESS_MARK = 0x01020304;
+const uint32_t MmWaveChannelSnapshot::VERSION = 1;
+
+/**
+ * \brief Write the values of a snapshot file
+ */
+class MmWaveChannelSnapshotOutput
+{
+public:
+  /**
+   * \brief Create the file
+   * \param fileName name of the file
+   */
+  MmWaveChannelSnapshotOutput (const std::string &fileName)
+    : m_fileName (fileName)
+  {
+    m_file.open (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_UNLESS (m_file.is_open (), "Could not open the channel snapshot " << fileName);
+  }
+
+  /**
+   * \brief Check that everything was written
+   */
+  void Close ()
+  {
+    m_file.close ();
+    NS_ABORT_MSG_UNLESS (m_file, "Could not write the channel snapshot " << m_fileName);
+  }
+
+  /**
+   * \brief Write raw bytes
+   * \param data the bytes
+   * \param size the number of bytes
+   */
+  void PutBytes (const char *data, size_t size)
+  {
+    m_file.write (data, static_cast<std::streamsize> (size));
+  }
+
+  /**
+   * \brief Write a value with the size of its type
+   * \param v the value
+   */
+  template <typename T>
+  void PutValue (T v)
+  {
+    m_file.write (reinterpret_cast<const char *> (&v), sizeof (T));
+  }
+
+  void Put (uint8_t v) { PutValue (v); }              //!< Write a value \param v the value
+  void Put (uint32_t v) { PutValue (v); }             //!< Write a value \param v the value
+  void Put (double v) { PutValue (v); }               //!< Write a value \param v the value
+  void Put (bool v) { PutValue<uint8_t> (v ? 1 : 0); } //!< Write a value \param v the value
+  void Put (Time v) { PutValue<int64_t> (v.GetNanoSeconds ()); } //!< Write a value \param v the value
+
+  /**
+   * \brief Write a vector
+   * \param v the vector
+   */
+  void Put (const Vector &v)
+  {
+    Put (v.x);
+    Put (v.y);
+    Put (v.z);
+  }
+
+  /**
+   * \brief Write a complex value
+   * \param v the value
+   */
+  void Put (const std::complex<double> &v)
+  {
+    Put (v.real ());
+    Put (v.imag ());
+  }
+
+  /**
+   * \brief Write a beam id
+   * \param v the beam id
+   */
+  void Put (const AntennaArrayBasicModel::BeamId &v)
+  {
+    Put (v.first);
+    Put (v.second);
+  }
+
+  /**
+   * \brief Write a device id
+   * \param v the device id
+   */
+  void Put (const MmWaveChannelSnapshot::DeviceId &v)
+  {
+    Put (v.m_node);
+    Put (v.m_device);
+  }
+
+  /**
+   * \brief Write a list, as its size and its elements
+   * \param v the list
+   */
+  template <typename T>
+  void Put (const std::vector<T> &v)
+  {
+    Put (static_cast<uint32_t> (v.size ()));
+    for (const auto & e : v)
+      {
+        Put (e);
+      }
+  }
+
+private:
+  std::string m_fileName; //!< Name of the file
+  std::ofstream m_file;   //!< The file
+};
+
+/**
+ * \brief Read the values of a snapshot file
+ *
+ * The size of each list is checked against the rest of the file, so that a
+ * damaged file is reported instead of exhausting the memory.
+ */
+class MmWaveChannelSnapshotInput
+{
+public:
+  /**
+   * \brief Open the file
+   * \param fileName name of the file
+   */
+  MmWaveChannelSnapshotInput (const std::string &fileName)
+    : m_fileName (fileName)
+  {
+    m_file.open (fileName.c_str (), std::ios::in | std::ios::binary | std::ios::ate);
+    NS_ABORT_MSG_UNLESS (m_file.is_open (), "Could not open the channel snapshot " << fileName);
+    m_size = static_cast<uint64_t> (m_file.tellg ());
+    m_file.seekg (0);
+  }
+
+  /**
+   * \brief Abort if a read failed
+   */
+  void Check ()
+  {
+    NS_ABORT_MSG_UNLESS (m_file, "Truncated channel snapshot " << m_fileName);
+  }
+
+  /**
+   * \return true if the whole file was read
+   */
+  bool AtEnd ()
+  {
+    return m_file.peek () == std::char_traits<char>::eof ();
+  }
+
+  /**
+   * \brief Read raw bytes
+   * \param data where to store the bytes
+   * \param size the number of bytes
+   */
+  void GetBytes (char *data, size_t size)
+  {
+    m_file.read (data, static_cast<std::streamsize> (size));
+  }
+
+  /**
+   * \return a value stored with the size of its type
+   */
+  template <typename T>
+  T GetValue ()
+  {
+    T v {};
+    m_file.read (reinterpret_cast<char *> (&v), sizeof (T));
+    return v;
+  }
+
+  void Get (uint8_t &v) { v = GetValue<uint8_t> (); }   //!< Read a value \param v the value
+  void Get (uint32_t &v) { v = GetValue<uint32_t> (); } //!< Read a value \param v the value
+  void Get (double &v) { v = GetValue<double> (); }     //!< Read a value \param v the value
+  void Get (bool &v) { v = GetValue<uint8_t> () != 0; } //!< Read a value \param v the value
+  void Get (Time &v) { v = NanoSeconds (GetValue<int64_t> ()); } //!< Read a value \param v the value
+
+  /**
+   * \brief Read a vector
+   * \param v the vector
+   */
+  void Get (Vector &v)
+  {
+    Get (v.x);
+    Get (v.y);
+    Get (v.z);
+  }
+
+  /**
+   * \brief Read a complex value
+   * \param v the value
+   */
+  void Get (std::complex<double> &v)
+  {
+    double re = 0.0;
+    double im = 0.0;
+    Get (re);
+    Get (im);
+    v = std::complex<double> (re, im);
+  }
+
+  /**
+   * \brief Read a beam id
+   * \param v the beam id
+   */
+  void Get (AntennaArrayBasicModel::BeamId &v)
+  {
+    Get (v.first);
+    Get (v.second);
+  }
+
+  /**
+   * \brief Read a device id
+   * \param v the device id
+   */
+  void Get (MmWaveChannelSnapshot::DeviceId &v)
+  {
+    Get (v.m_node);
+    Get (v.m_device);
+  }
+
+  /**
+   * \return the size of a list, checked against the rest of the file
+   */
+  uint32_t GetSize ()
+  {
+    const uint32_t size = GetValue<uint32_t> ();
+    Check ();
+    NS_ABORT_MSG_IF (size > m_size - static_cast<uint64_t> (m_file.tellg ()),
+                     "Damaged channel snapshot " << m_fileName << ": list of " << size << " elements");
+    return size;
+  }
+
+  /**
+   * \brief Read a list
+   * \param v the list
+   */
+  template <typename T>
+  void Get (std::vector<T> &v)
+  {
+    v.resize (GetSize ());
+    for (auto & e : v)
+      {
+        Get (e);
+      }
+  }
+
+private:
+  std::string m_fileName; //!< Name of the file
+  std::ifstream m_file;   //!< The file
+  uint64_t m_size {0};    //!< Size of the file
+};
+
+/**
+ * \param pathloss a propagation loss model
+ * \return the link tables of the model, none if it is not a 3GPP one
+ */
+static std::vector<MmWave3gppLinkTable *>
+GetLinkTables (const Ptr<PropagationLossModel> &pathloss)
+{
+  Ptr<MmWave3gppBuildingsPropagationLossModel> buildings = DynamicCast<MmWave3gppBuildingsPropagationLossModel> (pathloss);
+  if (buildings != nullptr)
+    {
+      return buildings->GetLinkTables ();
+    }
+  Ptr<MmWave3gppPropagationLossModel> model = DynamicCast<MmWave3gppPropagationLossModel> (pathloss);
+  if (model != nullptr)
+    {
+      return {&model->GetLinkTable ()};
+    }
+  return {};
+}
+
+/**
+ * \param device a device
+ * \return the id of the device
+ */
+static MmWaveChannelSnapshot::DeviceId
+GetDeviceId (const Ptr<NetDevice> &device)
+{
+  MmWaveChannelSnapshot::DeviceId id;
+  id.m_node = device->GetNode ()->GetId ();
+  id.m_device = device->GetIfIndex ();
+  return id;
+}
+
+/**
+ * \param id the id of a device
+ * \return the device, which must exist
+ */
+static Ptr<NetDevice>
+GetDevice (const MmWaveChannelSnapshot::DeviceId &id)
+{
+  NS_ABORT_MSG_IF (id.m_node >= NodeList::GetNNodes (), "The snapshot refers to the node " << id.m_node
+                   << ", which does not exist");
+  Ptr<Node> node = NodeList::GetNode (id.m_node);
+  NS_ABORT_MSG_IF (id.m_device >= node->GetNDevices (), "The snapshot refers to the device " << id.m_device
+                   << " of the node " << id.m_node << ", which does not exist");
+  return node->GetDevice (id.m_device);
+}
+
+/**
+ * \param nodeId the id of a node
+ * \return the mobility model of the node, which must exist
+ */
+static Ptr<MobilityModel>
+GetMobility (uint32_t nodeId)
+{
+  NS_ABORT_MSG_IF (nodeId >= NodeList::GetNNodes (), "The snapshot refers to the node " << nodeId
+                   << ", which does not exist");
+  Ptr<MobilityModel> mobility = NodeList::GetNode (nodeId)->GetObject<MobilityModel> ();
+  NS_ABORT_MSG_IF (mobility == nullptr, "The node " << nodeId << " of the snapshot has no mobility model");
+  return mobility;
+}
+
+/**
+ * \param device a device
+ * \param ccId the component carrier of the antenna
+ * \return the antenna of the device for the component carrier, or nullptr
+ * if the device is not a mmWave one
+ */
+static Ptr<AntennaArrayModel>
+GetAntenna (const Ptr<NetDevice> &device, uint8_t ccId)
+{
+  Ptr<MmWaveSpectrumPhy> phy;
+  Ptr<MmWaveUeNetDevice> ue = DynamicCast<MmWaveUeNetDevice> (device);
+  Ptr<MmWaveEnbNetDevice> enb = DynamicCast<MmWaveEnbNetDevice> (device);
+  if (ue != nullptr && ccId < ue->GetCcMapSize ())
+    {
+      phy = ue->GetPhy (ccId)->GetDlSpectrumPhy ();
+    }
+  else if (enb != nullptr && ccId < enb->GetCcMapSize ())
+    {
+      phy = enb->GetPhy (ccId)->GetDlSpectrumPhy ();
+    }
+  return phy != nullptr ? DynamicCast<AntennaArrayModel> (phy->GetRxAntenna ()) : nullptr;
+}
+
+void
+MmWaveChannelSnapshot::Capture (const std::vector<Ptr<MmWave3gppChannel> > &channels,
+                                const std::vector<Ptr<PropagationLossModel> > &pathloss)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (channels.size () == pathloss.size (), "One propagation loss model per channel is needed");
+
+  m_time = Simulator::Now ();
+  m_bwps.assign (channels.size (), BwpState ());
+  for (uint32_t bwp = 0; bwp < channels.size (); ++bwp)
+    {
+      BwpState &state = m_bwps[bwp];
+
+      for (MmWave3gppLinkTable *table : GetLinkTables (pathloss[bwp]))
+        {
+          std::vector<LinkRecord> links;
+          table->ForEachLink ([&links] (const Ptr<MobilityModel> &ue, const Ptr<MobilityModel> &gnb,
+                                        const MmWave3gppLinkTable::LinkState &link)
+            {
+              LinkRecord record;
+              record.m_ueNode = ue->GetObject<Node> ()->GetId ();
+              record.m_gnbNode = gnb->GetObject<Node> ()->GetId ();
+              record.m_state = link;
+              links.push_back (record);
+            });
+          state.m_linkTables.push_back (links);
+        }
+
+      const Time now = m_time;
+      channels[bwp]->ForEachChannel ([&state, now] (const Ptr<NetDevice> &tx, const Ptr<NetDevice> &rx,
+                                                   const Ptr<const Params3gpp> &params)
+        {
+          ChannelRecord record;
+          record.m_tx = GetDeviceId (tx);
+          record.m_rx = GetDeviceId (rx);
+          record.m_params = Create<Params3gpp> (*params);
+          record.m_params->m_generatedTime = now - params->m_generatedTime;
+          state.m_channels.push_back (record);
+        });
+
+      const uint8_t ccId = channels[bwp]->GetConfigurationParameters ()->GetCcId ();
+      for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+        {
+          for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+            {
+              Ptr<AntennaArrayModel> antenna = GetAntenna ((*node)->GetDevice (i), ccId);
+              if (antenna == nullptr)
+                {
+                  continue;
+                }
+              BeamformingRecord record;
+              record.m_device = GetDeviceId ((*node)->GetDevice (i));
+              record.m_omniTx = antenna->IsOmniTx ();
+              if (! record.m_omniTx)
+                {
+                  record.m_current = antenna->GetCurrentBeamformingVector ();
+                }
+              for (const auto & entry : antenna->GetBeamformingStorage ())
+                {
+                  PeerBeam peer;
+                  peer.m_peer = GetDeviceId (entry.first);
+                  peer.m_beam = entry.second;
+                  record.m_peers.push_back (peer);
+                }
+              state.m_beamforming.push_back (record);
+            }
+        }
+      NS_LOG_INFO ("Captured BWP " << bwp << ": " << state.m_channels.size () << " channels, "
+                   << state.m_beamforming.size () << " antennas");
+    }
+}
+
+void
+MmWaveChannelSnapshot::RestoreChannels (const std::vector<Ptr<MmWave3gppChannel> > &channels,
+                                        const std::vector<Ptr<PropagationLossModel> > &pathloss) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (channels.size () == m_bwps.size () && pathloss.size () == m_bwps.size (),
+                       "The snapshot has " << m_bwps.size () << " bandwidth parts, the scenario "
+                       << channels.size ());
+
+  for (uint32_t bwp = 0; bwp < m_bwps.size (); ++bwp)
+    {
+      const BwpState &state = m_bwps[bwp];
+
+      std::vector<MmWave3gppLinkTable *> tables = GetLinkTables (pathloss[bwp]);
+      NS_ABORT_MSG_UNLESS (tables.size () == state.m_linkTables.size (),
+                           "The propagation loss model of the BWP " << bwp << " is not the one of the snapshot");
+      for (uint32_t t = 0; t < tables.size (); ++t)
+        {
+          for (const auto & link : state.m_linkTables[t])
+            {
+              tables[t]->RestoreLink (GetMobility (link.m_ueNode), GetMobility (link.m_gnbNode), link.m_state);
+            }
+        }
+
+      channels[bwp]->ClearChannels ();
+      for (const auto & channel : state.m_channels)
+        {
+          Ptr<Params3gpp> params = Create<Params3gpp> (*channel.m_params);
+          params->m_generatedTime = Simulator::Now () - channel.m_params->m_generatedTime;
+          channels[bwp]->RestoreChannel (GetDevice (channel.m_tx), GetDevice (channel.m_rx), params);
+        }
+      NS_LOG_INFO ("Restored BWP " << bwp << ": " << state.m_channels.size () << " channels");
+    }
+}
+
+void
+MmWaveChannelSnapshot::RestoreBeamforming (const std::vector<Ptr<MmWave3gppChannel> > &channels) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_UNLESS (channels.size () == m_bwps.size (),
+                       "The snapshot has " << m_bwps.size () << " bandwidth parts, the scenario "
+                       << channels.size ());
+
+  for (uint32_t bwp = 0; bwp < m_bwps.size (); ++bwp)
+    {
+      const uint8_t ccId = channels[bwp]->GetConfigurationParameters ()->GetCcId ();
+      for (const auto & record : m_bwps[bwp].m_beamforming)
+        {
+          Ptr<AntennaArrayModel> antenna = GetAntenna (GetDevice (record.m_device), ccId);
+          NS_ABORT_MSG_IF (antenna == nullptr, "The device " << record.m_device.m_device << " of the node "
+                           << record.m_device.m_node << " has no antenna array for the BWP " << bwp);
+          for (const auto & peer : record.m_peers)
+            {
+              antenna->SetBeamformingVector (peer.m_beam.first, peer.m_beam.second, GetDevice (peer.m_peer));
+            }
+          // SetBeamformingVector leaves the omnidirectional mode
+          antenna->SetBeamformingVector (record.m_current.first, record.m_current.second);
+          if (record.m_omniTx)
+            {
+              antenna->ChangeToOmniTx ();
+            }
+        }
+    }
+}
+
+/**
+ * \brief Write a channel realization
+ * \param out the file
+ * \param p the realization
+ */
+static void
+PutParams (MmWaveChannelSnapshotOutput &out, const Params3gpp &p)
+{
+  out.Put (p.m_txBeamId);
+  out.Put (p.m_rxBeamId);
+  out.Put (p.m_txW);
+  out.Put (p.m_rxW);
+  out.Put (p.m_channel);
+  out.Put (p.m_delay);
+  out.Put (p.m_angle);
+  out.Put (p.m_longTerm);
+  out.Put (p.m_nonSelfBlocking);
+  out.Put (p.m_preLocUT);
+  out.Put (p.m_locUT);
+  out.Put (p.m_norRvAngles);
+  out.Put (p.m_generatedTime);
+  out.Put (p.m_DS);
+  out.Put (p.m_K);
+  out.Put (p.m_numCluster);
+  out.Put (p.m_clusterPhase);
+  out.Put (p.m_losPhase);
+  out.Put (p.m_los);
+  out.Put (p.m_o2i);
+  out.Put (p.m_speed);
+  out.Put (p.m_dis2D);
+  out.Put (p.m_dis3D);
+}
+
+/**
+ * \brief Read a channel realization
+ * \param in the file
+ * \param p the realization
+ */
+static void
+GetParams (MmWaveChannelSnapshotInput &in, Params3gpp &p)
+{
+  in.Get (p.m_txBeamId);
+  in.Get (p.m_rxBeamId);
+  in.Get (p.m_txW);
+  in.Get (p.m_rxW);
+  in.Get (p.m_channel);
+  in.Get (p.m_delay);
+  in.Get (p.m_angle);
+  in.Get (p.m_longTerm);
+  in.Get (p.m_nonSelfBlocking);
+  in.Get (p.m_preLocUT);
+  in.Get (p.m_locUT);
+  in.Get (p.m_norRvAngles);
+  in.Get (p.m_generatedTime);
+  in.Get (p.m_DS);
+  in.Get (p.m_K);
+  in.Get (p.m_numCluster);
+  in.Get (p.m_clusterPhase);
+  in.Get (p.m_losPhase);
+  in.Get (p.m_los);
+  in.Get (p.m_o2i);
+  in.Get (p.m_speed);
+  in.Get (p.m_dis2D);
+  in.Get (p.m_dis3D);
+}
+
+void
+MmWaveChannelSnapshot::Save (const std::string &fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  MmWaveChannelSnapshotOutput out (fileName);
+  out.PutBytes (MAGIC, sizeof (MAGIC));
+  out.Put (ENDIANNESS_MARK);
+  out.Put (VERSION);
+  out.Put (m_time);
+  out.Put (static_cast<uint32_t> (m_bwps.size ()));
+
+  for (const auto & state : m_bwps)
+    {
+      out.Put (static_cast<uint32_t> (state.m_linkTables.size ()));
+      for (const auto & links : state.m_linkTables)
+        {
+          out.Put (static_cast<uint32_t> (links.size ()));
+          for (const auto & link : links)
+            {
+              out.Put (link.m_ueNode);
+              out.Put (link.m_gnbNode);
+              out.Put (static_cast<uint8_t> (link.m_state.m_condition));
+              out.Put (link.m_state.m_shadowing);
+              out.Put (link.m_state.m_shadowingPosition);
+              out.Put (link.m_state.m_hE);
+              out.Put (link.m_state.m_carPenetrationLoss);
+              out.Put (link.m_state.m_shadowingStd);
+              out.Put (link.m_state.m_shadowingCorDistance);
+            }
+        }
+
+      out.Put (static_cast<uint32_t> (state.m_channels.size ()));
+      channels[bwp]->ClearChannels ();
+      for (const auto & channel : state.m_channels)
+        {
+          out.Put (channel.m_tx);
+          out.Put (channel.m_rx);
+          PutParams (out, *channel.m_params);
+        }
+
+      out.Put (static_cast<uint32_t> (state.m_beamforming.size ()));
+      for (const auto & record : state.m_beamforming)
+        {
+          out.Put (record.m_device);
+          out.Put (record.m_omniTx);
+          out.Put (record.m_current.first);
+          out.Put (record.m_current.second);
+          out.Put (static_cast<uint32_t> (record.m_peers.size ()));
+          for (const auto & peer : record.m_peers)
+            {
+              out.Put (peer.m_peer);
+              out.Put (peer.m_beam.first);
+              out.Put (peer.m_beam.second);
+            }
+        }
+    }
+  out.Close ();
+}
+
+void
+MmWaveChannelSnapshot::Load (const std::string &fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  MmWaveChannelSnapshotInput in (fileName);
+
+  char magic[sizeof (MAGIC)];
+  in.GetBytes (magic, sizeof (magic));
+  const uint32_t byteOrder = in.GetValue<uint32_t> ();
+  const uint32_t version = in.GetValue<uint32_t> ();
+  NS_ABORT_MSG_UNLESS (std::memcmp (magic, MAGIC, sizeof (magic)) == 0, fileName << " is not a channel snapshot");
+  NS_ABORT_MSG_UNLESS (byteOrder == ENDIANNESS_MARK, fileName << " was written with a different byte order");
+  NS_ABORT_MSG_UNLESS (version == VERSION, fileName << " has the version " << version
+                       << " of the format, instead of " << VERSION);
+  in.Get (m_time);
+  m_bwps.assign (in.GetSize (), BwpState ());
+
+  for (auto & state : m_bwps)
+    {
+      state.m_linkTables.resize (in.GetSize ());
+      for (auto & links : state.m_linkTables)
+        {
+          links.resize (in.GetSize ());
+          for (auto & link : links)
+            {
+              in.Get (link.m_ueNode);
+              in.Get (link.m_gnbNode);
+              link.m_state.m_condition = static_cast<char> (in.GetValue<uint8_t> ());
+              in.Get (link.m_state.m_shadowing);
+              in.Get (link.m_state.m_shadowingPosition);
+              in.Get (link.m_state.m_hE);
+              in.Get (link.m_state.m_carPenetrationLoss);
+              in.Get (link.m_state.m_shadowingStd);
+              in.Get (link.m_state.m_shadowingCorDistance);
+              link.m_state.m_used = true;
+              link.m_state.m_valid = true;
+            }
+        }
+
+      state.m_channels.resize (in.GetSize ());
+      for (auto & channel : state.m_channels)
+        {
+          in.Get (channel.m_tx);
+          in.Get (channel.m_rx);
+          channel.m_params = Create<Params3gpp> ();
+          GetParams (in, *channel.m_params);
+        }
+
+      state.m_beamforming.resize (in.GetSize ());
+      for (auto & record : state.m_beamforming)
+        {
+          in.Get (record.m_device);
+          in.Get (record.m_omniTx);
+          in.Get (record.m_current.first);
+          in.Get (record.m_current.second);
+          record.m_peers.resize (in.GetSize ());
+          for (auto & peer : record.m_peers)
+            {
+              in.Get (peer.m_peer);
+              in.Get (peer.m_beam.first);
+              in.Get (peer.m_beam.second);
+            }
+        }
+    }
+  in.Check ();
+  NS_ABORT_MSG_UNLESS (in.AtEnd (), "Unexpected data at the end of the channel snapshot " << fileName);
+}
+
+Time
+MmWaveChannelSnapshot::GetTime () const
+{
+  return m_time;
+}
+
+const std::vector<MmWaveChannelSnapshot::BwpState> &
+MmWaveChannelSnapshot::GetBwps () const
+{
+  return m_bwps;
+}
+
+std::vector<MmWaveChannelSnapshot::BwpState> &
+MmWaveChannelSnapshot::GetBwps ()
+{
+  return m_bwps;
+}
+
+} // namespace ns3
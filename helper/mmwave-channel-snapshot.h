@@ -0,0 +1,189 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <ns3/mmwave-3gpp-channel.h>
+#include <ns3/mmwave-3gpp-link-table.h>
+#include <ns3/antenna-array-basic-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/nstime.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief A snapshot of the state of the 3GPP channels of a scenario, to
+ * start other runs from it instead of from a cold channel
+ *
+ * For each bandwidth part, the snapshot holds:
+ *
+ * - the links of the tables of the 3GPP propagation loss model: channel
+ *   condition, shadowing, and the other fields owned by the model (the path
+ *   loss is computed again);
+ * - the channel realizations of MmWave3gppChannel, with their age instead
+ *   of the time they were generated;
+ * - the beamforming vectors of the antennas of the devices: the current one,
+ *   and the ones stored for each peer device.
+ *
+ * Nodes and devices are identified by their id and their index in the node,
+ * so a snapshot can only be restored in a scenario built in the same way
+ * (same nodes, devices and bandwidth parts, created in the same order).
+ *
+ * A snapshot file starts with:
+ *
+ * - the magic string "NRCHSN01" (8 bytes);
+ * - the 32 bit value 0x01020304, to check the byte order;
+ * - the version of the format (32 bit), the time of the snapshot (64 bit,
+ *   in ns), and the number of bandwidth parts (32 bit).
+ *
+ * It continues with the records of each bandwidth part. The values are
+ * stored with the size of their type, in the byte order of the machine that
+ * wrote the file; a list is stored as its size (32 bit) and its elements.
+ */
+class MmWaveChannelSnapshot
+{
+public:
+  /**
+   * \brief A device, as the id of its node and its index in the node
+   */
+  struct DeviceId
+  {
+    uint32_t m_node {0};   //!< Id of the node
+    uint32_t m_device {0}; //!< Index of the device in the node
+  };
+
+  /**
+   * \brief A link of a table of a propagation loss model
+   */
+  struct LinkRecord
+  {
+    uint32_t m_ueNode {0};                 //!< Id of the node of the UE
+    uint32_t m_gnbNode {0};                //!< Id of the node of the gNB
+    MmWave3gppLinkTable::LinkState m_state; //!< State of the link (only the fields owned by the model are saved)
+  };
+
+  /**
+   * \brief A channel realization
+   */
+  struct ChannelRecord
+  {
+    DeviceId m_tx;            //!< Transmitter device
+    DeviceId m_rx;            //!< Receiver device
+    Ptr<Params3gpp> m_params; //!< The realization, with the age of the channel in m_generatedTime
+  };
+
+  /**
+   * \brief A beamforming vector stored for a peer device
+   */
+  struct PeerBeam
+  {
+    DeviceId m_peer;                                  //!< Peer device
+    AntennaArrayBasicModel::BeamformingVector m_beam; //!< Beamforming vector towards the peer
+  };
+
+  /**
+   * \brief The beamforming state of the antenna of a device
+   */
+  struct BeamformingRecord
+  {
+    DeviceId m_device;                                   //!< Device of the antenna
+    bool m_omniTx {false};                               //!< True if the antenna is omnidirectional
+    AntennaArrayBasicModel::BeamformingVector m_current; //!< Current beamforming vector, if not omnidirectional
+    std::vector<PeerBeam> m_peers;                       //!< Beamforming vectors stored per peer
+  };
+
+  /**
+   * \brief The state of a bandwidth part
+   */
+  struct BwpState
+  {
+    std::vector<std::vector<LinkRecord> > m_linkTables; //!< Links of each table of the propagation loss model
+    std::vector<ChannelRecord> m_channels;              //!< Channel realizations
+    std::vector<BeamformingRecord> m_beamforming;       //!< Beamforming state of the antennas
+  };
+
+  /**
+   * \brief Capture the state of the channels now
+   * \param channels the channel of each bandwidth part
+   * \param pathloss the propagation loss model of each bandwidth part
+   */
+  void Capture (const std::vector<Ptr<MmWave3gppChannel> > &channels,
+                const std::vector<Ptr<PropagationLossModel> > &pathloss);
+
+  /**
+   * \brief Restore the links of the propagation loss models, and the channel
+   * realizations (aged as they were at the time of the snapshot)
+   * \param channels the channel of each bandwidth part
+   * \param pathloss the propagation loss model of each bandwidth part
+   *
+   * The channel realizations of the channels are replaced by the ones of the
+   * snapshot. It has to be called after MmWave3gppChannel::Initial, which
+   * generates the channels of the attached devices, and before
+   * RestoreBeamforming.
+   */
+  void RestoreChannels (const std::vector<Ptr<MmWave3gppChannel> > &channels,
+                        const std::vector<Ptr<PropagationLossModel> > &pathloss) const;
+
+  /**
+   * \brief Restore the beamforming vectors of the antennas
+   * \param channels the channel of each bandwidth part
+   *
+   * It has to be called after MmWave3gppChannel::Initial, which resets the
+   * beamforming vectors of the attached devices.
+   */
+  void RestoreBeamforming (const std::vector<Ptr<MmWave3gppChannel> > &channels) const;
+
+  /**
+   * \brief Write the snapshot to a file
+   * \param fileName name of the file
+   */
+  void Save (const std::string &fileName) const;
+
+  /**
+   * \brief Read the snapshot from a file, replacing the current one
+   * \param fileName name of the file
+   */
+  void Load (const std::string &fileName);
+
+  /**
+   * \return the simulation time of the capture
+   */
+  Time GetTime () const;
+
+  /**
+   * \return the state of each bandwidth part
+   */
+  const std::vector<BwpState> & GetBwps () const;
+
+  /**
+   * \return the state of each bandwidth part, to modify it
+   */
+  std::vector<BwpState> & GetBwps ();
+
+  static const char MAGIC[8];            //!< First bytes of a snapshot file
+  static const uint32_t ENDIANNESS_MARK; //!< Value that checks the byte order
+  static const uint32_t VERSION;         //!< Version of the format
+
+private:
+  Time m_time;                  //!< Time of the capture
+  std::vector<BwpState> m_bwps; //!< State of each bandwidth part
+};
+
+} // namespace ns3
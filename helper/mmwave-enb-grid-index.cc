@@ -0,0 +1,179 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-enb-grid-index.h"
+#include <ns3/abort.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+MmWaveEnbGridIndex::MmWaveEnbGridIndex (const std::vector<Vector> &positions, double cellSize)
+  : m_positions (positions),
+    m_cellSize (cellSize)
+{
+  NS_ABORT_MSG_IF (positions.empty (), "No position to index");
+  NS_ABORT_MSG_IF (cellSize < 0, "Negative cell size " << cellSize);
+
+  m_minX = positions.front ().x;
+  m_minY = positions.front ().y;
+  double maxX = m_minX;
+  double maxY = m_minY;
+  for (const auto & p : positions)
+    {
+      m_minX = std::min (m_minX, p.x);
+      m_minY = std::min (m_minY, p.y);
+      maxX = std::max (maxX, p.x);
+      maxY = std::max (maxY, p.y);
+    }
+  const double width = maxX - m_minX;
+  const double height = maxY - m_minY;
+  const double n = static_cast<double> (positions.size ());
+
+  if (m_cellSize == 0.0)
+    {
+      if (width * height > 0)
+        {
+          m_cellSize = std::sqrt (width * height / n);
+        }
+      else if (std::max (width, height) > 0)
+        {
+          // Aligned positions: one row of cells
+          m_cellSize = std::max (width, height) / n;
+        }
+      else
+        {
+          m_cellSize = 1.0;
+        }
+    }
+  // A cell size too small for the area would need a huge grid: it is
+  // enlarged until there are at most a few cells per position
+  while ((std::floor (width / m_cellSize) + 1) * (std::floor (height / m_cellSize) + 1) > 4 * n + 64)
+    {
+      m_cellSize *= 2;
+    }
+  m_numCellsX = static_cast<int32_t> (std::floor (width / m_cellSize)) + 1;
+  m_numCellsY = static_cast<int32_t> (std::floor (height / m_cellSize)) + 1;
+
+  // Counting sort of the positions by cell: within a cell, they stay in
+  // increasing index order
+  std::vector<uint32_t> cellOf (positions.size ());
+  m_cellStart.assign (static_cast<size_t> (m_numCellsX) * m_numCellsY + 1, 0);
+  for (uint32_t i = 0; i < positions.size (); ++i)
+    {
+      cellOf[i] = GetCell (positions[i].y, m_minY, m_numCellsY) * m_numCellsX
+        + GetCell (positions[i].x, m_minX, m_numCellsX);
+      ++m_cellStart[cellOf[i] + 1];
+    }
+  for (size_t c = 1; c < m_cellStart.size (); ++c)
+    {
+      m_cellStart[c] += m_cellStart[c - 1];
+    }
+  m_cellItems.resize (positions.size ());
+  std::vector<uint32_t> next (m_cellStart.begin (), m_cellStart.end () - 1);
+  for (uint32_t i = 0; i < positions.size (); ++i)
+    {
+      m_cellItems[next[cellOf[i]]++] = i;
+    }
+}
+
+int32_t
+MmWaveEnbGridIndex::GetCell (double value, double min, int32_t numCells) const
+{
+  const double cell = std::floor ((value - min) / m_cellSize);
+  if (! (cell > 0))
+    {
+      return 0;
+    }
+  if (cell >= numCells - 1)
+    {
+      return numCells - 1;
+    }
+  return static_cast<int32_t> (cell);
+}
+
+uint32_t
+MmWaveEnbGridIndex::GetClosest (const Vector &point) const
+{
+  const int32_t cx = GetCell (point.x, m_minX, m_numCellsX);
+  const int32_t cy = GetCell (point.y, m_minY, m_numCellsY);
+  const int32_t maxRing = std::max (m_numCellsX, m_numCellsY);
+  // Margin on the bound of a ring, for the rounding of the cell of the point
+  const double margin = m_cellSize * 1e-6;
+
+  double minDistance = std::numeric_limits<double>::infinity ();
+  uint32_t closest = std::numeric_limits<uint32_t>::max ();
+
+  auto visit = [this, &point, &minDistance, &closest] (int32_t x, int32_t y)
+    {
+      if (x < 0 || y < 0 || x >= m_numCellsX || y >= m_numCellsY)
+        {
+          return;
+        }
+      const uint32_t cell = static_cast<uint32_t> (y) * m_numCellsX + x;
+      for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k)
+        {
+          const uint32_t i = m_cellItems[k];
+          const double distance = CalculateDistance (point, m_positions[i]);
+          if (distance < minDistance || (distance == minDistance && i < closest))
+            {
+              minDistance = distance;
+              closest = i;
+            }
+        }
+    };
+
+  for (int32_t r = 0; r < maxRing; ++r)
+    {
+      // The cells of the ring r are at least r - 1 cells away from the point
+      if (r > 0 && (r - 1) * m_cellSize - margin > minDistance)
+        {
+          break;
+        }
+      if (r == 0)
+        {
+          visit (cx, cy);
+          continue;
+        }
+      for (int32_t x = cx - r; x <= cx + r; ++x)
+        {
+          visit (x, cy - r);
+          visit (x, cy + r);
+        }
+      for (int32_t y = cy - r + 1; y <= cy + r - 1; ++y)
+        {
+          visit (cx - r, y);
+          visit (cx + r, y);
+        }
+    }
+  return closest;
+}
+
+uint32_t
+MmWaveEnbGridIndex::GetN () const
+{
+  return static_cast<uint32_t> (m_positions.size ());
+}
+
+double
+MmWaveEnbGridIndex::GetCellSize () const
+{
+  return m_cellSize;
+}
+
+} // namespace ns3
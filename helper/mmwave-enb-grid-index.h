@@ -0,0 +1,87 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <ns3/vector.h>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Nearest-neighbour search over a fixed set of positions (e.g., the
+ * gNBs of a deployment), with a uniform grid on the horizontal plane
+ *
+ * The positions are bucketed in square cells of the (x, y) plane; a query
+ * visits the rings of cells around the one of the point, from the closest,
+ * and stops when the next ring is farther than the best position found.
+ * The distance is the 3D one of CalculateDistance, and the horizontal
+ * distance to a ring is a lower bound of it, so the result is exact.
+ *
+ * The result is the same as the one of a linear scan that keeps the first
+ * of the closest positions: among positions at the same distance, the one
+ * with the lowest index is returned.
+ */
+class MmWaveEnbGridIndex
+{
+public:
+  /**
+   * \brief Build the index
+   * \param positions the positions, which must not be empty
+   * \param cellSize the side of a cell, in m, or 0 to choose it so that a
+   * cell holds about one position
+   */
+  MmWaveEnbGridIndex (const std::vector<Vector> &positions, double cellSize = 0.0);
+
+  /**
+   * \brief Find the closest position to a point
+   * \param point the point
+   * \return the index of the closest position (the lowest one on ties)
+   */
+  uint32_t GetClosest (const Vector &point) const;
+
+  /**
+   * \return the number of positions indexed
+   */
+  uint32_t GetN () const;
+
+  /**
+   * \return the side of a cell, in m
+   */
+  double GetCellSize () const;
+
+private:
+  /**
+   * \param value a coordinate
+   * \param min the smallest coordinate of the grid
+   * \param numCells the number of cells along the axis
+   * \return the cell of the coordinate along the axis, clamped to the grid
+   */
+  int32_t GetCell (double value, double min, int32_t numCells) const;
+
+  std::vector<Vector> m_positions;     //!< Positions indexed
+  double m_cellSize {0.0};             //!< Side of a cell
+  double m_minX {0.0};                 //!< Smallest x of the positions
+  double m_minY {0.0};                 //!< Smallest y of the positions
+  int32_t m_numCellsX {0};             //!< Cells along x
+  int32_t m_numCellsY {0};             //!< Cells along y
+  std::vector<uint32_t> m_cellStart;   //!< Start of the positions of each cell in m_cellItems, plus the end
+  std::vector<uint32_t> m_cellItems;   //!< Indices of the positions, grouped by cell in increasing order
+};
+
+} // namespace ns3
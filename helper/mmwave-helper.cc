@@ -38,7 +38,7 @@
 #include "mmwave-helper.h"
 #include <ns3/abort.h>
 #include <ns3/buildings-propagation-loss-model.h>
-#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/mmwave-spectrum-channel.h>
 #include <ns3/uinteger.h>
 #include <ns3/double.h>
 #include <ns3/ipv4.h>
@@ -49,6 +49,9 @@
 #include <ns3/buildings-obstacle-propagation-loss-model.h>
 #include <ns3/lte-enb-component-carrier-manager.h>
 #include <ns3/lte-ue-component-carrier-manager.h>
+#include <ns3/node-list.h>
+#include "mmwave-enb-grid-index.h"
+#include <chrono>
 
 
 namespace ns3 {
@@ -68,7 +71,7 @@ MmWaveHelper::MmWaveHelper (void)
   m_snrTest (false)
 {
   NS_LOG_FUNCTION (this);
-  m_channelFactory.SetTypeId (MultiModelSpectrumChannel::GetTypeId ());
+  m_channelFactory.SetTypeId (MmWaveSpectrumChannel::GetTypeId ());
   m_enbNetDeviceFactory.SetTypeId (MmWaveEnbNetDevice::GetTypeId ());
   m_ueNetDeviceFactory.SetTypeId (MmWaveUeNetDevice::GetTypeId ());
 
@@ -188,6 +191,9 @@ MmWaveHelper::DoDispose (void)
     }
   m_3gppChannel.clear ();
   m_phyStats = 0;
+  m_ueTraceBinders.clear ();
+  m_enbTraceBinders.clear ();
+  m_radioBearerStatsConnector.Clear ();
   Object::DoDispose ();
 }
 
@@ -247,7 +253,16 @@ MmWaveHelper::DoInitialize ()
       for (auto i:m_bandwidthPartsConf->GetBandwidhtPartsConf ())
         {
           Ptr<MmWave3gppChannel> channel = CreateObject<MmWave3gppChannel> ();
-          m_channel.at (k)->AddSpectrumPropagationLossModel (channel);
+          // Through MmWaveSpectrumChannel, its workers compute the BF gain
+          Ptr<MmWaveSpectrumChannel> mmWaveChannel = DynamicCast<MmWaveSpectrumChannel> (m_channel.at (k));
+          if (mmWaveChannel)
+            {
+              mmWaveChannel->AddSpectrumPropagationLossModel (channel);
+            }
+          else
+            {
+              m_channel.at (k)->AddSpectrumPropagationLossModel (channel);
+            }
           channel->SetConfigurationParameters (i);
            if (m_pathlossModelType == "ns3::MmWave3gppBuildingsPropagationLossModel" || m_pathlossModelType == "ns3::MmWave3gppPropagationLossModel" )
             {
@@ -403,14 +418,19 @@ MmWaveHelper::InstallUeDevice (NodeContainer c)
 {
   NS_LOG_FUNCTION (this);
   Initialize ();    // Run DoInitialize (), if necessary
+  auto start = std::chrono::steady_clock::now ();
+  const InstallContext ctx = CreateInstallContext (false);
   NetDeviceContainer devices;
   for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
       Ptr<Node> node = *i;
-      Ptr<NetDevice> device = InstallSingleUeDevice (node);
+      Ptr<NetDevice> device = InstallSingleUeDevice (node, ctx);
       device->SetAddress (Mac48Address::Allocate ());
       devices.Add (device);
     }
+  NS_LOG_INFO ("Installed " << devices.GetN () << " UE devices in "
+               << std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ()
+               << " ms");
   return devices;
 
 }
@@ -420,19 +440,56 @@ MmWaveHelper::InstallEnbDevice (NodeContainer c)
 {
   NS_LOG_FUNCTION (this);
   Initialize ();    // Run DoInitialize (), if necessary
+  auto start = std::chrono::steady_clock::now ();
+  const InstallContext ctx = CreateInstallContext (true);
+  if (c.GetN () > 0)
+    {
+      // The frequency of the propagation loss model of each BWP is the same
+      // for all the eNBs
+      for (uint32_t ccId = 0; ccId < ctx.m_bwps.size (); ++ccId)
+        {
+          double freq = ctx.m_bwps.at (ccId)->GetCenterFrequency ();
+          NS_LOG_LOGIC ("Channel frequency: " << freq);
+          bool freqOk = m_pathlossModel.at (ccId)->SetAttributeFailSafe ("Frequency", DoubleValue (freq));
+          if (!freqOk)
+            {
+              NS_LOG_WARN ("Propagation model does not have a Frequency attribute");
+            }
+        }
+    }
   NetDeviceContainer devices;
   for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
       Ptr<Node> node = *i;
-      Ptr<NetDevice> device = InstallSingleEnbDevice (node);
+      Ptr<NetDevice> device = InstallSingleEnbDevice (node, ctx);
       device->SetAddress (Mac48Address::Allocate ());
       devices.Add (device);
     }
+  NS_LOG_INFO ("Installed " << devices.GetN () << " eNB devices in "
+               << std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ()
+               << " ms");
   return devices;
 }
 
+MmWaveHelper::InstallContext
+MmWaveHelper::CreateInstallContext (bool enb) const
+{
+  InstallContext ctx;
+  ctx.m_bwps = m_bandwidthPartsConf->GetBandwidhtPartsConf ();
+  if (enb)
+    {
+      for (const auto & bwp : ctx.m_bwps)
+        {
+          ObjectFactory schedFactory;
+          schedFactory.SetTypeId (bwp->GetMacSchedType ());
+          ctx.m_schedFactories.push_back (schedFactory);
+        }
+    }
+  return ctx;
+}
+
 Ptr<NetDevice>
-MmWaveHelper::InstallSingleUeDevice (Ptr<Node> n)
+MmWaveHelper::InstallSingleUeDevice (Ptr<Node> n, const InstallContext &ctx)
 {
   NS_LOG_FUNCTION (this);
 
@@ -443,7 +500,7 @@ MmWaveHelper::InstallSingleUeDevice (Ptr<Node> n)
 
   uint8_t earfcn = 1;
 
-  for (auto i:m_bandwidthPartsConf->GetBandwidhtPartsConf ())
+  for (auto i:ctx.m_bwps)
     {
       Ptr <ComponentCarrierMmWaveUe> cc =  CreateObject<ComponentCarrierMmWaveUe> ();
       cc->SetUlBandwidth ( i->GetBandwidth ());
@@ -469,18 +526,21 @@ MmWaveHelper::InstallSingleUeDevice (Ptr<Node> n)
 
 
 
+  Ptr<MobilityModel> mm = n->GetObject<MobilityModel> ();
+  NS_ASSERT_MSG (mm, "MobilityModel needs to be set on node before calling MmWaveHelper::InstallUeDevice ()");
+
   for (std::map<uint8_t, Ptr<ComponentCarrierMmWaveUe> >::iterator it = ueCcMap.begin (); it != ueCcMap.end (); ++it)
     {
 
       Ptr<MmWaveSpectrumPhy> ulPhy = CreateObject<MmWaveSpectrumPhy> ();
       Ptr<MmWaveSpectrumPhy> dlPhy = CreateObject<MmWaveSpectrumPhy> ();
       Ptr<MmWaveUePhy> phy = CreateObject<MmWaveUePhy> (dlPhy, ulPhy, n);
-      Ptr<MmWaveHarqPhy> harq = Create<MmWaveHarqPhy> (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first)->GetNumHarqProcess ());
+      Ptr<MmWaveHarqPhy> harq = Create<MmWaveHarqPhy> (ctx.m_bwps.at (it->first)->GetNumHarqProcess ());
       dlPhy->SetHarqPhyModule (harq);
       //ulPhy->SetHarqPhyModule (harq);
       phy->SetHarqPhyModule (harq);
 
-      phy->SetPhyMacConfig (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first));
+      phy->SetPhyMacConfig (ctx.m_bwps.at (it->first));
 
       /* Do not do this here. Do it during registration with the BS
       * phy->SetConfigurationParameters(m_phyMacCommon);*/
@@ -496,13 +556,12 @@ MmWaveHelper::InstallSingleUeDevice (Ptr<Node> n)
       ulPhy->SetChannel (m_channel.at (it->first));
       dlPhy->SetChannel (m_channel.at (it->first));
 
-      Ptr<MobilityModel> mm = n->GetObject<MobilityModel> ();
-      NS_ASSERT_MSG (mm, "MobilityModel needs to be set on node before calling MmWaveHelper::InstallUeDevice ()");
       ulPhy->SetMobility (mm);
       dlPhy->SetMobility (mm);
 
       dlPhy->SetPhyRxDataEndOkCallback (MakeCallback (&MmWaveUePhy::PhyDataPacketReceived, phy));
       dlPhy->SetPhyRxCtrlEndOkCallback (MakeCallback (&MmWaveUePhy::ReceiveControlMessageList, phy));
+      dlPhy->SetPhyRxDciEndOkCallback (MakeCallback (&MmWaveUePhy::ReceiveDciPerRnti, phy));
 
       /* Antenna model */
       Ptr<AntennaModel> antenna = (m_ueAntennaModelFactory.Create ())->GetObject<AntennaModel> ();
@@ -571,8 +630,8 @@ MmWaveHelper::InstallSingleUeDevice (Ptr<Node> n)
       rrc->SetLteUeCphySapProvider (it->second->GetPhy ()->GetUeCphySapProvider (), it->first);
       it->second->GetPhy ()->SetComponentCarrierId (it->first);
 
-      it->second->GetPhy ()->SetConfigurationParameters (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first));
-      it->second->GetMac ()->SetConfigurationParameters (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first));
+      it->second->GetPhy ()->SetConfigurationParameters (ctx.m_bwps.at (it->first));
+      it->second->GetMac ()->SetConfigurationParameters (ctx.m_bwps.at (it->first));
 
       it->second->GetPhy ()->SetPhySapUser (it->second->GetMac ()->GetPhySapUser ());
       it->second->GetMac ()->SetPhySapProvider (it->second->GetPhy ()->GetPhySapProvider ());
@@ -620,11 +679,17 @@ MmWaveHelper::InstallSingleUeDevice (Ptr<Node> n)
 
   dev->Initialize ();
 
+  for (const auto & binder : m_ueTraceBinders)
+    {
+      binder (dev);
+    }
+  m_radioBearerStatsConnector.RegisterDevice (dev);
+
   return dev;
 }
 
 Ptr<NetDevice>
-MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
+MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n, const InstallContext &ctx)
 {
   NS_ABORT_MSG_IF (m_cellIdCounter == 65535, "max num eNBs exceeded");
 
@@ -638,7 +703,7 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
   uint8_t ccId = 0;
 
   uint8_t earfcn = 1;
-  for (auto it:m_bandwidthPartsConf->GetBandwidhtPartsConf ())
+  for (auto it:ctx.m_bwps)
     {
       Ptr<MmWavePhyMacCommon> phyCommonConf = it;
       Ptr <ComponentCarrierGnb> cc =  CreateObject<ComponentCarrierGnb> ();
@@ -668,8 +733,9 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
   NS_ABORT_MSG_IF (m_useCa && ccMap.size () < 2, "You have to either specify carriers or disable carrier aggregation");
 
   NS_ASSERT (ccMap.size () == m_noOfCcs);
-  ObjectFactory schedFactory;
-  schedFactory.SetTypeId (m_defaultSchedulerType);
+
+  Ptr<MobilityModel> mm = n->GetObject<MobilityModel> ();
+  NS_ASSERT_MSG (mm, "MobilityModel needs to be set on node before calling MmWaveHelper::InstallEnbDevice ()");
 
   for (std::map<uint8_t,Ptr<ComponentCarrierGnb> >::iterator it = ccMap.begin (); it != ccMap.end (); ++it)
     {
@@ -678,7 +744,7 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
       Ptr<MmWaveSpectrumPhy> dlPhy = CreateObject<MmWaveSpectrumPhy> ();
       Ptr<MmWaveEnbPhy> phy = CreateObject<MmWaveEnbPhy> (dlPhy, ulPhy, n);
 
-      Ptr<MmWaveHarqPhy> harq = Create<MmWaveHarqPhy> (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first)->GetNumHarqProcess ());
+      Ptr<MmWaveHarqPhy> harq = Create<MmWaveHarqPhy> (ctx.m_bwps.at (it->first)->GetNumHarqProcess ());
       dlPhy->SetHarqPhyModule (harq);
       // ulPhy->SetHarqPhyModule (harq);
       phy->SetHarqPhyModule (harq);
@@ -691,15 +757,13 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
         }
       dlPhy->AddDataSinrChunkProcessor (pData);
 
-      phy->SetConfigurationParameters (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first));
+      phy->SetConfigurationParameters (ctx.m_bwps.at (it->first));
 
-      NS_ABORT_IF(m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first)->GetCcId() != it->first);
+      NS_ABORT_IF(ctx.m_bwps.at (it->first)->GetCcId() != it->first);
 
       ulPhy->SetChannel (m_channel.at (it->first));
       dlPhy->SetChannel (m_channel.at (it->first));
 
-      Ptr<MobilityModel> mm = n->GetObject<MobilityModel> ();
-      NS_ASSERT_MSG (mm, "MobilityModel needs to be set on node before calling MmWaveHelper::InstallEnbDevice ()");
       dlPhy->SetMobility (mm);
       ulPhy->SetMobility (mm);
 
@@ -715,11 +779,10 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
       ulPhy->SetAntenna (antenna);
 
       Ptr<MmWaveEnbMac> mac = CreateObject<MmWaveEnbMac> ();
-      mac->SetConfigurationParameters (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first));
-      schedFactory.SetTypeId (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first)->GetMacSchedType ());
-      Ptr<MmWaveMacScheduler> sched = DynamicCast<MmWaveMacScheduler> (schedFactory.Create ());
+      mac->SetConfigurationParameters (ctx.m_bwps.at (it->first));
+      Ptr<MmWaveMacScheduler> sched = DynamicCast<MmWaveMacScheduler> (ctx.m_schedFactories.at (it->first).Create ());
 
-      sched->ConfigureCommonParameters (m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first));
+      sched->ConfigureCommonParameters (ctx.m_bwps.at (it->first));
       it->second->SetMac (mac);
       it->second->SetMmWaveMacScheduler (sched);
       it->second->SetPhy (phy);
@@ -865,16 +928,6 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
       ccPhy->GetDlSpectrumPhy ()->SetPhyRxDataEndOkCallback (MakeCallback (&MmWaveEnbPhy::PhyDataPacketReceived, ccPhy));
       ccPhy->GetDlSpectrumPhy ()->SetPhyRxCtrlEndOkCallback (MakeCallback (&MmWaveEnbPhy::PhyCtrlMessagesReceived, ccPhy));
       ccPhy->GetDlSpectrumPhy ()->SetPhyUlHarqFeedbackCallback (MakeCallback (&MmWaveEnbPhy::ReceiveUlHarqFeedback, ccPhy));
-      NS_LOG_LOGIC ("set the propagation model frequencies");
-
-      double freq = m_bandwidthPartsConf->GetBandwidhtPartsConf ().at (it->first)->GetCenterFrequency ();   // TODO: Add CC map to phyMacCommon
-      NS_LOG_LOGIC ("Channel frequency: " << freq);
-      bool freqOk = m_pathlossModel.at(it->first)->SetAttributeFailSafe ("Frequency", DoubleValue (freq));
-      if (!freqOk)
-        {
-          NS_LOG_WARN ("Propagation model does not have a Frequency attribute");
-        }
-
     }  //end for
   rrc->SetForwardUpCallback (MakeCallback (&MmWaveEnbNetDevice::Receive, dev));
   dev->Initialize ();
@@ -902,19 +955,71 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
       rrc->SetEpcX2SapProvider (x2->GetEpcX2SapProvider ());
     }
 
+  for (const auto & binder : m_enbTraceBinders)
+    {
+      binder (dev);
+    }
+  m_radioBearerStatsConnector.RegisterDevice (dev);
+
   return dev;
 }
 
+/**
+ * \param pathlossModel the propagation loss model of each bandwidth part
+ * \param n the number of bandwidth parts
+ * \return the propagation loss models, in the order of the bandwidth parts
+ */
+static std::vector<Ptr<PropagationLossModel> >
+GetPathlossModels (const std::map<uint8_t, Ptr<Object> > &pathlossModel, size_t n)
+{
+  std::vector<Ptr<PropagationLossModel> > models;
+  for (uint8_t k = 0; k < n; ++k)
+    {
+      models.push_back (pathlossModel.at (k)->GetObject<PropagationLossModel> ());
+    }
+  return models;
+}
+
 void
 MmWaveHelper::AttachToClosestEnb (NetDeviceContainer ueDevices, NetDeviceContainer enbDevices)
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (enbDevices.GetN () > 0, "empty enb device container");
+
+  auto start = std::chrono::steady_clock::now ();
+
+  std::vector<EnbAttachInfo> enbs;
+  std::vector<Vector> enbPositions;
+  enbs.reserve (enbDevices.GetN ());
+  enbPositions.reserve (enbDevices.GetN ());
+  for (NetDeviceContainer::Iterator i = enbDevices.Begin (); i != enbDevices.End (); ++i)
+    {
+      EnbAttachInfo enb;
+      enb.m_device = DynamicCast<MmWaveEnbNetDevice> (*i);
+      NS_ABORT_IF (enb.m_device == nullptr);
+      enb.m_cellId = enb.m_device->GetCellId ();
+      enb.m_earfcn = enb.m_device->GetEarfcn ();
+      for (uint32_t cc = 0; cc < enb.m_device->GetCcMapSize (); ++cc)
+        {
+          enb.m_phys.push_back (enb.m_device->GetPhy (cc));
+          enb.m_macs.push_back (enb.m_device->GetMac (cc));
+          enb.m_configs.push_back (enb.m_phys.back ()->GetConfigurationParameters ());
+        }
+      enbs.push_back (enb);
+      enbPositions.push_back ((*i)->GetNode ()->GetObject<MobilityModel> ()->GetPosition ());
+    }
+  MmWaveEnbGridIndex index (enbPositions);
 
-  for (NetDeviceContainer::Iterator i = ueDevices.Begin (); i != ueDevices.End (); i++)
+  for (NetDeviceContainer::Iterator i = ueDevices.Begin (); i != ueDevices.End (); ++i)
     {
-      AttachToClosestEnb (*i, enbDevices);
+      Vector uepos = (*i)->GetNode ()->GetObject<MobilityModel> ()->GetPosition ();
+      AttachToEnb (*i, enbs[index.GetClosest (uepos)]);
     }
 
+  NS_LOG_INFO ("Attached " << ueDevices.GetN () << " UEs to " << enbDevices.GetN () << " eNBs in "
+               << std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ()
+               << " ms");
+
   if (m_channelModelType == "ns3::MmWaveChannelRaytracing")
     {
       for (auto i:m_raytracing)
@@ -928,59 +1033,78 @@ MmWaveHelper::AttachToClosestEnb (NetDeviceContainer ueDevices, NetDeviceContain
         {
           i->Initial (ueDevices,enbDevices);
         }
+      // Initial generates the channels and the beamforming vectors of the
+      // attached devices, which are replaced by the ones of the snapshot
+      if (m_pendingSnapshot != nullptr)
+        {
+          m_pendingSnapshot->RestoreChannels (m_3gppChannel,
+                                              GetPathlossModels (m_pathlossModel, m_3gppChannel.size ()));
+          m_pendingSnapshot->RestoreBeamforming (m_3gppChannel);
+          m_pendingSnapshot.reset ();
+        }
     }
 }
 
 void
-MmWaveHelper::AttachToClosestEnb (Ptr<NetDevice> ueDevice, NetDeviceContainer enbDevices)
+MmWaveHelper::SaveChannelSnapshot (std::string fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  NS_ABORT_MSG_IF (m_3gppChannel.empty (), "A channel snapshot needs the ns3::MmWave3gppChannel channel model");
+  MmWaveChannelSnapshot snapshot;
+  snapshot.Capture (m_3gppChannel, GetPathlossModels (m_pathlossModel, m_3gppChannel.size ()));
+  snapshot.Save (fileName);
+  NS_LOG_INFO ("Saved the channel snapshot " << fileName << " at " << Simulator::Now ().GetSeconds () << " s");
+}
+
+void
+MmWaveHelper::LoadChannelSnapshot (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  NS_ABORT_MSG_IF (m_3gppChannel.empty (), "A channel snapshot needs the ns3::MmWave3gppChannel channel model, "
+                   "and the devices to be installed");
+  m_pendingSnapshot = std::unique_ptr<MmWaveChannelSnapshot> (new MmWaveChannelSnapshot ());
+  m_pendingSnapshot->Load (fileName);
+  NS_LOG_INFO ("Loaded the channel snapshot " << fileName << ", taken at "
+               << m_pendingSnapshot->GetTime ().GetSeconds () << " s");
+}
+
+Ptr<MmWave3gppChannel>
+MmWaveHelper::Get3gppChannel (uint8_t bwpIndex) const
+{
+  return bwpIndex < m_3gppChannel.size () ? m_3gppChannel.at (bwpIndex) : nullptr;
+}
+
+void
+MmWaveHelper::AttachToEnb (Ptr<NetDevice> ueDevice, const EnbAttachInfo &enb)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT_MSG (enbDevices.GetN () > 0, "empty enb device container");
-  Vector uepos = ueDevice->GetNode ()->GetObject<MobilityModel> ()->GetPosition ();
-  double minDistance = std::numeric_limits<double>::infinity ();
-  Ptr<NetDevice> closestEnbDevice;
-  for (NetDeviceContainer::Iterator i = enbDevices.Begin (); i != enbDevices.End (); ++i)
-    {
-      Vector enbpos = (*i)->GetNode ()->GetObject<MobilityModel> ()->GetPosition ();
-      double distance = CalculateDistance (uepos, enbpos);
-      if (distance < minDistance)
-        {
-          minDistance = distance;
-          closestEnbDevice = *i;
-        }
-    }
-  NS_ASSERT (closestEnbDevice != 0);
 
-  auto enbNetDev = closestEnbDevice->GetObject<MmWaveEnbNetDevice> ();
-  auto ueNetDev = ueDevice->GetObject<MmWaveUeNetDevice> ();
+  auto ueNetDev = DynamicCast<MmWaveUeNetDevice> (ueDevice);
 
-  NS_ABORT_IF (enbNetDev == nullptr || ueNetDev == nullptr);
+  NS_ABORT_IF (ueNetDev == nullptr);
 
-  uint16_t cellId = enbNetDev->GetCellId ();
+  uint64_t imsi = ueNetDev->GetImsi ();
 
-  for (uint32_t i = 0; i < enbNetDev->GetCcMapSize (); ++i)
+  for (uint32_t i = 0; i < enb.m_phys.size (); ++i)
     {
-
-      Ptr<MmWavePhyMacCommon> configParams = enbNetDev->GetPhy (i)->GetConfigurationParameters ();
-      enbNetDev->GetPhy (i)->AddUePhy (ueDevice->GetObject<MmWaveUeNetDevice> ()->GetImsi (), ueDevice);
-      ueNetDev->GetPhy (i)->RegisterToEnb (cellId, configParams);
-      enbNetDev->GetMac(i)->AssociateUeMAC (ueDevice->GetObject<MmWaveUeNetDevice> ()->GetImsi ());
+      enb.m_phys[i]->AddUePhy (imsi, ueDevice);
+      ueNetDev->GetPhy (i)->RegisterToEnb (enb.m_cellId, enb.m_configs[i]);
+      enb.m_macs[i]->AssociateUeMAC (imsi);
     }
 
-  Ptr<EpcUeNas> ueNas = ueDevice->GetObject<MmWaveUeNetDevice> ()->GetNas ();
-  ueNas->Connect (closestEnbDevice->GetObject<MmWaveEnbNetDevice> ()->GetCellId (),
-                  closestEnbDevice->GetObject<MmWaveEnbNetDevice> ()->GetEarfcn ());
+  Ptr<EpcUeNas> ueNas = ueNetDev->GetNas ();
+  ueNas->Connect (enb.m_cellId, enb.m_earfcn);
 
   if (m_epcHelper != 0)
     {
       // activate default EPS bearer
-      m_epcHelper->ActivateEpsBearer (ueDevice, ueDevice->GetObject<MmWaveUeNetDevice> ()->GetImsi (), EpcTft::Default (), EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT));
+      m_epcHelper->ActivateEpsBearer (ueDevice, imsi, EpcTft::Default (), EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT));
     }
 
   // tricks needed for the simplified LTE-only simulations
   //if (m_epcHelper == 0)
   //{
-  ueDevice->GetObject<MmWaveUeNetDevice> ()->SetTargetEnb (closestEnbDevice->GetObject<MmWaveEnbNetDevice> ());
+  ueNetDev->SetTargetEnb (enb.m_device);
   //}
 
 }
@@ -1124,7 +1248,8 @@ MmWaveHelper::ActivateDataRadioBearer (Ptr<NetDevice> ueDevice, EpsBearer bearer
        << "/DeviceList/" << enbmmWaveDevice->GetIfIndex ()
        << "/LteEnbRrc/ConnectionEstablished";
   Ptr<MmWaveDrbActivator> arg = Create<MmWaveDrbActivator> (ueDevice, bearer);
-  Config::Connect (path.str (), MakeBoundCallback (&MmWaveDrbActivator::ActivateCallback, arg));
+  enbmmWaveDevice->GetRrc ()->TraceConnect ("ConnectionEstablished", path.str (),
+                                            MakeBoundCallback (&MmWaveDrbActivator::ActivateCallback, arg));
 }
 
 
@@ -1140,6 +1265,99 @@ MmWaveHelper::EnableTraces (void)
   EnablePdcpTraces ();
 }
 
+/**
+ * \brief Build the Config path of a trace source of a component carrier
+ * \param dev the device
+ * \param ccMap the name of the component carrier map attribute of the device
+ * \param ccId the component carrier
+ * \param source the path of the trace source, from the component carrier
+ * \return the path
+ */
+static std::string
+GetCcTracePath (const Ptr<NetDevice> &dev, const std::string &ccMap, uint32_t ccId, const std::string &source)
+{
+  std::ostringstream path;
+  path << "/NodeList/" << dev->GetNode ()->GetId () << "/DeviceList/" << dev->GetIfIndex ()
+       << "/" << ccMap << "/" << ccId << "/" << source;
+  return path.str ();
+}
+
+void
+MmWaveHelper::AddUeTraceBinder (const UeTraceBinder &binder)
+{
+  NS_LOG_FUNCTION (this);
+  m_ueTraceBinders.push_back (binder);
+  // Devices installed by other helpers are bound too, as with a Config path
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<MmWaveUeNetDevice> dev = DynamicCast<MmWaveUeNetDevice> ((*node)->GetDevice (i));
+          if (dev != 0)
+            {
+              binder (dev);
+            }
+        }
+    }
+}
+
+void
+MmWaveHelper::AddEnbTraceBinder (const EnbTraceBinder &binder)
+{
+  NS_LOG_FUNCTION (this);
+  m_enbTraceBinders.push_back (binder);
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<MmWaveEnbNetDevice> dev = DynamicCast<MmWaveEnbNetDevice> ((*node)->GetDevice (i));
+          if (dev != 0)
+            {
+              binder (dev);
+            }
+        }
+    }
+}
+
+void
+MmWaveHelper::ConnectUePhyTrace (const std::string &source, bool spectrumPhy, const CallbackBase &cb)
+{
+  // As with Config::Connect, a missing trace source connects nothing
+  AddUeTraceBinder ([source, spectrumPhy, cb] (const Ptr<MmWaveUeNetDevice> &dev)
+    {
+      for (uint32_t ccId = 0; ccId < dev->GetCcMapSize (); ++ccId)
+        {
+          Ptr<MmWaveUePhy> phy = dev->GetPhy (static_cast<uint8_t> (ccId));
+          if (spectrumPhy)
+            {
+              phy->GetDlSpectrumPhy ()->TraceConnect (source,
+                                                      GetCcTracePath (dev, "ComponentCarrierMapUe", ccId,
+                                                                      "MmWaveUePhy/DlSpectrumPhy/" + source), cb);
+            }
+          else
+            {
+              phy->TraceConnect (source, GetCcTracePath (dev, "ComponentCarrierMapUe", ccId,
+                                                         "MmWaveUePhy/" + source), cb);
+            }
+        }
+    });
+}
+
+void
+MmWaveHelper::ConnectEnbPhyTrace (const std::string &source, const CallbackBase &cb)
+{
+  AddEnbTraceBinder ([source, cb] (const Ptr<MmWaveEnbNetDevice> &dev)
+    {
+      for (uint32_t ccId = 0; ccId < dev->GetCcMapSize (); ++ccId)
+        {
+          Ptr<MmWaveEnbPhy> phy = dev->GetPhy (static_cast<uint8_t> (ccId));
+          phy->GetDlSpectrumPhy ()->TraceConnect (source,
+                                                  GetCcTracePath (dev, "ComponentCarrierMap", ccId,
+                                                                  "MmWaveEnbPhy/DlSpectrumPhy/" + source), cb);
+        }
+    });
+}
+
 void
 MmWaveHelper::EnableDlPhyTrace (void)
 {
@@ -1147,24 +1365,24 @@ MmWaveHelper::EnableDlPhyTrace (void)
   //Config::Connect ("/NodeList/*/DeviceList/*/MmWaveUePhy/ReportCurrentCellRsrpSinr",
   //  MakeBoundCallback (&MmWavePhyRxTrace::ReportCurrentCellRsrpSinrCallback, m_phyStats));
 
-  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
-                   MakeBoundCallback (&MmWavePhyRxTrace::RxPacketTraceUeCallback, m_phyStats));
+  ConnectUePhyTrace ("RxPacketTraceUe", true,
+                     MakeBoundCallback (&MmWavePhyRxTrace::RxPacketTraceUeCallback, m_phyStats));
 }
 
 void
 MmWaveHelper::EnableUlPhyTrace (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/RxPacketTraceEnb",
-                   MakeBoundCallback (&MmWavePhyRxTrace::RxPacketTraceEnbCallback, m_phyStats));
+  ConnectEnbPhyTrace ("RxPacketTraceEnb",
+                      MakeBoundCallback (&MmWavePhyRxTrace::RxPacketTraceEnbCallback, m_phyStats));
 }
 
 void
 MmWaveHelper::EnableEnbPacketCountTrace ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/ReportEnbTxRxPacketCount",
-                   MakeBoundCallback (&MmWavePhyRxTrace::ReportPacketCountEnbCallback, m_phyStats));
+  ConnectEnbPhyTrace ("ReportEnbTxRxPacketCount",
+                      MakeBoundCallback (&MmWavePhyRxTrace::ReportPacketCountEnbCallback, m_phyStats));
 
 }
 
@@ -1172,8 +1390,8 @@ void
 MmWaveHelper::EnableUePacketCountTrace ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/ReportUeTxRxPacketCount",
-                   MakeBoundCallback (&MmWavePhyRxTrace::ReportPacketCountUeCallback, m_phyStats));
+  ConnectUePhyTrace ("ReportUeTxRxPacketCount", true,
+                     MakeBoundCallback (&MmWavePhyRxTrace::ReportPacketCountUeCallback, m_phyStats));
 
 }
 
@@ -1181,8 +1399,8 @@ void
 MmWaveHelper::EnableTransportBlockTrace ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/ReportDownlinkTbSize",
-                   MakeBoundCallback (&MmWavePhyRxTrace::ReportDownLinkTBSize, m_phyStats));
+  ConnectUePhyTrace ("ReportDownlinkTbSize", false,
+                     MakeBoundCallback (&MmWavePhyRxTrace::ReportDownLinkTBSize, m_phyStats));
 }
 
 
@@ -49,6 +49,7 @@
 #include <ns3/antenna-array-3gpp-model.h>
 #include <ns3/mmwave-rrc-protocol-ideal.h>
 #include "mmwave-phy-rx-trace.h"
+#include "mmwave-channel-snapshot.h"
 #include <ns3/epc-helper.h>
 #include <ns3/epc-ue-nas.h>
 #include <ns3/lte-enb-rrc.h>
@@ -64,6 +65,8 @@
 #include <ns3/component-carrier-gnb.h>
 #include <ns3/component-carrier-mmwave-ue.h>
 #include <ns3/cc-helper.h>
+#include <functional>
+#include <memory>
 
 namespace ns3 {
 
@@ -80,7 +83,7 @@ class BandwidthPartsPhyMacConf : public Object
 {
 
 public:
-  std::vector <Ptr<MmWavePhyMacCommon> > GetBandwidhtPartsConf ()
+  const std::vector <Ptr<MmWavePhyMacCommon> > & GetBandwidhtPartsConf () const
   {
     return m_bandwidthPartsConf;
   }
@@ -218,9 +221,54 @@ public:
   void SetUeComponentCarrierManagerAttribute (std::string n, const AttributeValue &v);
 
 
+  /**
+   * \brief Attach each UE to the closest eNB
+   *
+   * The eNB positions are indexed once with a MmWaveEnbGridIndex, so that
+   * the search of the closest eNB does not scan all of them for each UE; on
+   * ties, the first eNB of the container is chosen. The objects of each eNB
+   * used by the attachment (PHY, MAC and configuration of each component
+   * carrier) are looked up once, and the UEs are registered in the order of
+   * the container.
+   *
+   * \param ueDevices the UE devices
+   * \param enbDevices the eNB devices, which must not be empty
+   */
   void AttachToClosestEnb (NetDeviceContainer ueDevices, NetDeviceContainer enbDevices);
   void EnableTraces ();
 
+  /**
+   * \brief Save the state of the 3GPP channels (link conditions, shadowing,
+   * channel realizations and beamforming vectors) to a file
+   * \param fileName name of the file
+   *
+   * It can be scheduled at any time of a simulation that uses the 3GPP
+   * channel model, to start other runs of the same scenario from this state.
+   *
+   * \see MmWaveChannelSnapshot
+   */
+  void SaveChannelSnapshot (std::string fileName) const;
+
+  /**
+   * \brief Start from the state of the 3GPP channels saved by
+   * SaveChannelSnapshot in a run of the same scenario
+   * \param fileName name of the file
+   *
+   * It has to be called after the installation of the devices, and before
+   * AttachToClosestEnb: the links, the channels and the beamforming vectors
+   * are restored at the end of AttachToClosestEnb, replacing the ones that
+   * it generates.
+   */
+  void LoadChannelSnapshot (std::string fileName);
+
+  /**
+   * \brief Get the 3GPP channel of a bandwidth part
+   * \param bwpIndex index of the bandwidth part
+   * \return the channel, or nullptr if the channel model is not
+   * ns3::MmWave3gppChannel or the devices are not installed yet
+   */
+  Ptr<MmWave3gppChannel> Get3gppChannel (uint8_t bwpIndex) const;
+
   void SetSchedulerType (std::string type);
 
   void ActivateDataRadioBearer (NetDeviceContainer ueDevices, EpsBearer bearer);
@@ -266,6 +314,23 @@ public:
 
   void DeActivateDedicatedEpsBearer (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice, uint8_t bearerId);
 
+  /**
+   * \brief Connect a trace sink to a trace source of the PHY of every
+   * component carrier of the UE devices, directly on the objects
+   * \param source the name of the trace source
+   * \param spectrumPhy true if the source belongs to the DL spectrum PHY,
+   * false if it belongs to the PHY
+   * \param cb the trace sink, which gets the Config path of the source as context
+   */
+  void ConnectUePhyTrace (const std::string &source, bool spectrumPhy, const CallbackBase &cb);
+  /**
+   * \brief Connect a trace sink to a trace source of the DL spectrum PHY of
+   * every component carrier of the eNB devices, directly on the objects
+   * \param source the name of the trace source
+   * \param cb the trace sink, which gets the Config path of the source as context
+   */
+  void ConnectEnbPhyTrace (const std::string &source, const CallbackBase &cb);
+
 protected:
   virtual void
   DoInitialize ();
@@ -282,9 +347,45 @@ private:
    */
   void DoDeActivateDedicatedEpsBearer (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice, uint8_t bearerId);
 
-  Ptr<NetDevice> InstallSingleUeDevice (Ptr<Node> n);
-  Ptr<NetDevice> InstallSingleEnbDevice (Ptr<Node> n);
-  void AttachToClosestEnb (Ptr<NetDevice> ueDevice, NetDeviceContainer enbDevices);
+  /**
+   * \brief The configuration shared by the devices installed by a call of
+   * InstallUeDevice or InstallEnbDevice, computed once per call
+   */
+  struct InstallContext
+  {
+    std::vector<Ptr<MmWavePhyMacCommon> > m_bwps;   //!< Configuration of each BWP
+    std::vector<ObjectFactory> m_schedFactories;    //!< Scheduler factory of each BWP (eNB only)
+  };
+
+  /**
+   * \brief Compute the configuration shared by the devices to install
+   * \param enb true for eNB devices, false for UE devices
+   * \return the configuration
+   */
+  InstallContext CreateInstallContext (bool enb) const;
+
+  Ptr<NetDevice> InstallSingleUeDevice (Ptr<Node> n, const InstallContext &ctx);
+  Ptr<NetDevice> InstallSingleEnbDevice (Ptr<Node> n, const InstallContext &ctx);
+
+  /**
+   * \brief The objects of an eNB used to attach UEs to it
+   */
+  struct EnbAttachInfo
+  {
+    Ptr<MmWaveEnbNetDevice> m_device;                 //!< The eNB device
+    uint16_t m_cellId;                                //!< Cell ID of the eNB
+    uint16_t m_earfcn;                                //!< EARFCN of the eNB
+    std::vector<Ptr<MmWaveEnbPhy> > m_phys;           //!< PHY of each component carrier
+    std::vector<Ptr<MmWaveEnbMac> > m_macs;           //!< MAC of each component carrier
+    std::vector<Ptr<MmWavePhyMacCommon> > m_configs;  //!< Configuration of each component carrier
+  };
+
+  /**
+   * \brief Attach a UE to an eNB
+   * \param ueDevice the UE device
+   * \param enb the objects of the eNB
+   */
+  void AttachToEnb (Ptr<NetDevice> ueDevice, const EnbAttachInfo &enb);
   void EnableDlPhyTrace ();
   void EnableUlPhyTrace ();
   void EnableEnbPacketCountTrace ();
@@ -295,11 +396,32 @@ private:
   void EnablePdcpTraces (void);
   Ptr<MmWaveBearerStatsCalculator> GetPdcpStats (void);
 
+  /**
+   * \brief A function that connects trace sinks to the trace sources of an UE device
+   */
+  typedef std::function<void (const Ptr<MmWaveUeNetDevice> &)> UeTraceBinder;
+  /**
+   * \brief A function that connects trace sinks to the trace sources of an eNB device
+   */
+  typedef std::function<void (const Ptr<MmWaveEnbNetDevice> &)> EnbTraceBinder;
+
+  /**
+   * \brief Register a binder, and run it on the UE devices already installed
+   * \param binder the binder, which is then run on every UE device installed
+   */
+  void AddUeTraceBinder (const UeTraceBinder &binder);
+  /**
+   * \brief Register a binder, and run it on the eNB devices already installed
+   * \param binder the binder, which is then run on every eNB device installed
+   */
+  void AddEnbTraceBinder (const EnbTraceBinder &binder);
+
   std::map<uint8_t, ComponentCarrier> GetBandwidthPartMap ();
 
   std::vector<Ptr<SpectrumChannel> >m_channel;
   std::vector<Ptr<MmWaveChannelRaytracing> >m_raytracing;   //raytracing per bandwidth part
   std::vector<Ptr<MmWave3gppChannel> > m_3gppChannel;   //3gpp channel per bandwidth part
+  std::unique_ptr<MmWaveChannelSnapshot> m_pendingSnapshot; //!< Snapshot whose beamforming is restored by AttachToClosestEnb
   
   std::map< uint8_t, Ptr<Object> > m_pathlossModel;
   std::string m_pathlossModelType;
@@ -339,6 +461,8 @@ private:
   Ptr<MmWaveBearerStatsCalculator> m_rlcStats;
   Ptr<MmWaveBearerStatsCalculator> m_pdcpStats;
   MmWaveBearerStatsConnector m_radioBearerStatsConnector;
+  std::vector<UeTraceBinder> m_ueTraceBinders;   //!< Binders run on the UE devices installed
+  std::vector<EnbTraceBinder> m_enbTraceBinders; //!< Binders run on the eNB devices installed
 
   /**
    * The `UseCa` attribute. If true, Carrier Aggregation is enabled.
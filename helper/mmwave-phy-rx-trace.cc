@@ -30,6 +30,9 @@
 #include <ns3/log.h>
 #include "mmwave-phy-rx-trace.h"
 #include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/enum.h>
 #include <stdio.h>
 
 namespace ns3 {
@@ -40,6 +43,44 @@ NS_OBJECT_ENSURE_REGISTERED (MmWavePhyRxTrace);
 
 std::ofstream MmWavePhyRxTrace::m_rxPacketTraceFile;
 std::string MmWavePhyRxTrace::m_rxPacketTraceFilename;
+MmWavePhyRxTrace *MmWavePhyRxTrace::m_rxPacketTraceOwner = nullptr;
+
+/**
+ * \brief Name of the text file of a per-UE or per-cell trace
+ * \param kind the kind of the trace
+ * \param id the IMSI of the UE, or the cell ID
+ * \return the name of the file
+ */
+static std::string
+GetTextFileName (const std::string &kind, uint64_t id)
+{
+  char fname[255];
+  if (kind == "DlSinr")
+    {
+      sprintf (fname, "UE_%llu_SINR_dB.txt", (long long unsigned) id);
+    }
+  else if (kind == "UlSinr")
+    {
+      sprintf (fname, "UE_%llu_UL_SINR_dB.txt", (long long unsigned) id);
+    }
+  else if (kind == "UePacketCount")
+    {
+      sprintf (fname, "UE_%llu_Packet_Trace.txt", (long long unsigned) id);
+    }
+  else if (kind == "EnbPacketCount")
+    {
+      sprintf (fname, "BS_%llu_Packet_Trace.txt", (long long unsigned) id);
+    }
+  else if (kind == "DlTbSize")
+    {
+      sprintf (fname, "UE_%llu_Tb_Size.txt", (long long unsigned) id);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown trace " << kind);
+    }
+  return fname;
+}
 
 MmWavePhyRxTrace::MmWavePhyRxTrace ()
 {
@@ -47,10 +88,7 @@ MmWavePhyRxTrace::MmWavePhyRxTrace ()
 
 MmWavePhyRxTrace::~MmWavePhyRxTrace ()
 {
-  if (m_rxPacketTraceFile.is_open ())
-    {
-      m_rxPacketTraceFile.close ();
-    }
+  CloseFiles ();
 }
 
 TypeId
@@ -59,10 +97,266 @@ MmWavePhyRxTrace::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::MmWavePhyRxTrace")
     .SetParent<Object> ()
     .AddConstructor<MmWavePhyRxTrace> ()
+    .AddAttribute ("BinaryOutput",
+                   "Write each trace in a binary columnar file (e.g., RxPacketTrace.bin) "
+                   "instead of the text files. MmWavePhyRxTrace::ConvertToText converts "
+                   "them to the text layout.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWavePhyRxTrace::m_binaryOutput),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BinaryBlockRows",
+                   "Number of rows of a binary trace kept in memory before they are written",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&MmWavePhyRxTrace::m_binaryBlockRows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxOpenTextFiles",
+                   "Maximum number of text files (one per trace and UE or cell) kept open; "
+                   "the one used least recently is closed, and opened again in append mode",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&MmWavePhyRxTrace::m_maxOpenTextFiles),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("AsyncWriter",
+                   "Format and write the traces in a separate thread, drained at "
+                   "Simulator::Destroy, instead of the simulator thread",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWavePhyRxTrace::m_asyncOutput),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncQueueSize",
+                   "Number of reports that can wait for the writer thread "
+                   "(rounded up to a power of 2)",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&MmWavePhyRxTrace::m_asyncQueueSize),
+                   MakeUintegerChecker<uint32_t> (1, 1u << 24))
+    .AddAttribute ("AsyncFullPolicy",
+                   "What to do with a report when the queue of the writer thread is full: "
+                   "wait for the thread (no report is lost), or drop the report",
+                   EnumValue (MmWaveAsyncTraceWriter::BLOCK),
+                   MakeEnumAccessor (&MmWavePhyRxTrace::m_asyncFullPolicy),
+                   MakeEnumChecker (MmWaveAsyncTraceWriter::BLOCK, "Block",
+                                    MmWaveAsyncTraceWriter::DROP, "Drop"))
   ;
   return tid;
 }
 
+void
+MmWavePhyRxTrace::DoDispose ()
+{
+  CloseFiles ();
+  Object::DoDispose ();
+}
+
+void
+MmWavePhyRxTrace::PushRecord (std::function<void ()> record)
+{
+  if (! m_asyncWriter.IsRunning ())
+    {
+      m_asyncWriter.Start (m_asyncQueueSize, m_asyncFullPolicy);
+      m_asyncDestroyEvent = Simulator::ScheduleDestroy (&MmWavePhyRxTrace::DestroyAsyncWriter, this);
+    }
+  m_asyncWriter.Push (std::move (record));
+}
+
+void
+MmWavePhyRxTrace::StopAsyncWriter ()
+{
+  m_asyncDestroyEvent.Cancel ();
+  m_asyncWriter.Stop ();
+}
+
+void
+MmWavePhyRxTrace::DestroyAsyncWriter ()
+{
+  StopAsyncWriter ();
+  Flush ();
+}
+
+void
+MmWavePhyRxTrace::CloseFiles ()
+{
+  StopAsyncWriter ();
+  m_textFlushEvent.Cancel ();
+  for (auto & file : m_textFiles)
+    {
+      fclose (file.second.m_file);
+    }
+  m_textFiles.clear ();
+  m_textFilesLru.clear ();
+  m_rxPacketBin.Close ();
+  m_dlSinrBin.Close ();
+  m_ulSinrBin.Close ();
+  m_uePacketBin.Close ();
+  m_enbPacketBin.Close ();
+  m_tbSizeBin.Close ();
+  // The shared file is closed only by the instance that writes it, which may
+  // be writing it in its writer thread
+  if (m_rxPacketTraceOwner == this || m_rxPacketTraceOwner == nullptr)
+    {
+      m_rxPacketTraceOwner = nullptr;
+      if (m_rxPacketTraceFile.is_open ())
+        {
+          m_rxPacketTraceFile.close ();
+        }
+    }
+}
+
+void
+MmWavePhyRxTrace::Flush ()
+{
+  m_asyncWriter.Drain ();
+  for (auto & file : m_textFiles)
+    {
+      fflush (file.second.m_file);
+    }
+  m_rxPacketBin.Flush ();
+  m_dlSinrBin.Flush ();
+  m_ulSinrBin.Flush ();
+  m_uePacketBin.Flush ();
+  m_enbPacketBin.Flush ();
+  m_tbSizeBin.Flush ();
+  if (m_rxPacketTraceOwner == this && m_rxPacketTraceFile.is_open ())
+    {
+      m_rxPacketTraceFile.flush ();
+    }
+}
+
+FILE *
+MmWavePhyRxTrace::GetTextFile (const std::string &fileName)
+{
+  auto it = m_textFiles.find (fileName);
+  if (it != m_textFiles.end ())
+    {
+      m_textFilesLru.splice (m_textFilesLru.begin (), m_textFilesLru, it->second.m_lru);
+      return it->second.m_file;
+    }
+
+  if (m_textFiles.size () >= m_maxOpenTextFiles)
+    {
+      auto lru = m_textFiles.find (m_textFilesLru.back ());
+      fclose (lru->second.m_file);
+      m_textFiles.erase (lru);
+      m_textFilesLru.pop_back ();
+    }
+  // With the writer thread, the files are flushed by DestroyAsyncWriter
+  if (! m_asyncOutput && ! m_textFlushEvent.IsRunning ())
+    {
+      m_textFlushEvent = Simulator::ScheduleDestroy (&MmWavePhyRxTrace::Flush, this);
+    }
+
+  TextFile file;
+  file.m_file = fopen (fileName.c_str (), "a");
+  NS_ABORT_MSG_IF (file.m_file == nullptr, "Could not open tracefile " << fileName);
+  m_textFilesLru.push_front (fileName);
+  file.m_lru = m_textFilesLru.begin ();
+  m_textFiles.emplace (fileName, file);
+  return file.m_file;
+}
+
+std::vector<MmWaveBinaryTrace::Column>
+MmWavePhyRxTrace::GetBinaryColumns (const std::string &kind)
+{
+  if (kind == "RxPacketTrace")
+    {
+      return {{"dl", MmWaveBinaryTrace::UINT8}, {"frame", MmWaveBinaryTrace::UINT32},
+              {"subframe", MmWaveBinaryTrace::UINT8}, {"slot", MmWaveBinaryTrace::UINT16},
+              {"symStart", MmWaveBinaryTrace::UINT8}, {"numSym", MmWaveBinaryTrace::UINT8},
+              {"cellId", MmWaveBinaryTrace::UINT64}, {"rnti", MmWaveBinaryTrace::UINT16},
+              {"tbSize", MmWaveBinaryTrace::UINT32}, {"mcs", MmWaveBinaryTrace::UINT8},
+              {"rv", MmWaveBinaryTrace::UINT8}, {"sinr", MmWaveBinaryTrace::DOUBLE},
+              {"corrupt", MmWaveBinaryTrace::UINT8}, {"tbler", MmWaveBinaryTrace::DOUBLE},
+              {"ccId", MmWaveBinaryTrace::UINT8}};
+    }
+  else if (kind == "DlSinr" || kind == "UlSinr")
+    {
+      return {{"imsi", MmWaveBinaryTrace::UINT64}, {"tti", MmWaveBinaryTrace::UINT64},
+              {"rb", MmWaveBinaryTrace::UINT32}, {"sinr", MmWaveBinaryTrace::DOUBLE}};
+    }
+  else if (kind == "UePacketCount" || kind == "EnbPacketCount")
+    {
+      return {{"id", MmWaveBinaryTrace::UINT64}, {"subframe", MmWaveBinaryTrace::UINT32},
+              {"isTx", MmWaveBinaryTrace::UINT8}, {"bytes", MmWaveBinaryTrace::UINT32}};
+    }
+  else if (kind == "DlTbSize")
+    {
+      return {{"timeUs", MmWaveBinaryTrace::UINT64}, {"imsi", MmWaveBinaryTrace::UINT64},
+              {"tbSize", MmWaveBinaryTrace::UINT64}};
+    }
+  NS_FATAL_ERROR ("Unknown trace " << kind);
+  return {};
+}
+
+MmWaveBinaryTraceWriter &
+MmWavePhyRxTrace::GetBinaryTrace (MmWaveBinaryTraceWriter &writer, const std::string &kind)
+{
+  if (! writer.IsOpen ())
+    {
+      writer.Open (kind + ".bin", kind, GetBinaryColumns (kind), m_binaryBlockRows);
+    }
+  return writer;
+}
+
+void
+MmWavePhyRxTrace::PrintRxPacketTraceHeader (std::ostream &os)
+{
+  os << "\tframe\tsubF\tslot\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler\tCcId" << "\n";
+}
+
+void
+MmWavePhyRxTrace::PrintRxPacketTrace (std::ostream &os, bool isDl, const RxPacketTraceParams &params)
+{
+  if (isDl)
+    {
+      os << "DL\t" << params.m_frameNum
+         << "\t" << (unsigned)params.m_subframeNum
+         << "\t" << (unsigned)params.m_slotNum
+         << "\t" << (unsigned)params.m_symStart
+         << "\t" << (unsigned)params.m_numSym
+         << "\t" << params.m_cellId
+         << "\t" << params.m_rnti
+         << "\t" << params.m_tbSize
+         << "\t" << (unsigned)params.m_mcs
+         << "\t" << (unsigned)params.m_rv
+         << "\t" << 10 * log10 (params.m_sinr)
+         << "\t" << params.m_corrupt
+         << "\t" << params.m_tbler
+         << "\t" << (unsigned)params.m_ccId << "\n";
+    }
+  else
+    {
+      os << "UL\t" << params.m_frameNum << "\t" << (unsigned)params.m_subframeNum
+         << "\t" << (unsigned)params.m_slotNum
+         << "\t" << (unsigned)params.m_symStart
+         << "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
+         << "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
+         << 10 * log10 (params.m_sinr) << "\t\t" << params.m_corrupt << " \t" << params.m_tbler << " \t" << params.m_ccId << "\n";
+    }
+}
+
+void
+MmWavePhyRxTrace::PrintSinr (FILE *file, uint64_t ttiCount, uint32_t rbCount, double sinr)
+{
+  fprintf (file, "%llu\t%llu\t%d\t%f\t \n",(long long unsigned) ttiCount / 8 + 1, (long long unsigned) ttiCount % 8 + 1, rbCount, 10 * log10 (sinr));
+}
+
+void
+MmWavePhyRxTrace::PrintPacketCount (FILE *file, bool isTx, uint32_t subframe, uint32_t bytes)
+{
+  if (isTx)
+    {
+      fprintf (file, "%d\t%d\t%d\n", subframe, bytes, 0);
+    }
+  else
+    {
+      fprintf (file, "%d\t%d\t%d\n", subframe, 0, bytes);
+    }
+}
+
+void
+MmWavePhyRxTrace::PrintTbSize (FILE *file, int64_t timeUs, uint64_t tbSize)
+{
+  fprintf (file, "%llu \t %llu\n", (long long unsigned) timeUs, (long long unsigned) tbSize);
+  fprintf (file, "%lld \t %llu \n", (long long int) timeUs, (long long unsigned) tbSize);
+}
+
 void
 MmWavePhyRxTrace::ReportCurrentCellRsrpSinrCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path,
                                                      uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power)
@@ -77,45 +371,65 @@ MmWavePhyRxTrace::UlSinrTraceCallback (Ptr<MmWavePhyRxTrace> phyStats, std::stri
                                        uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power)
 {
   NS_LOG_INFO ("UE" << imsi << "->Generate UlSinrTrace");
+  phyStats->ReportUlSinrTrace (imsi, sinr);
+  //phyStats->ReportInterferenceTrace (imsi, sinr);
+  //phyStats->ReportPowerTrace (imsi, power);
+}
+
+void
+MmWavePhyRxTrace::ReportUlSinrTrace (uint64_t imsi, SpectrumValue& sinr)
+{
   uint64_t tti_count = Now ().GetMicroSeconds () / 125;
-  uint32_t rb_count = 1;
-  FILE* log_file;
-  char fname[255];
-  sprintf (fname, "UE_%llu_UL_SINR_dB.txt", (long long unsigned ) imsi);
-  log_file = fopen (fname, "a");
-  Values::iterator it = sinr.ValuesBegin ();
-  while (it != sinr.ValuesEnd ())
+  if (m_asyncOutput)
     {
-      //fprintf(log_file, "%d\t%d\t%f\t \n", tti_count/2, rb_count, 10*log10(*it));
-      fprintf (log_file, "%llu\t%llu\t%d\t%f\t \n",(long long unsigned )tti_count / 8 + 1, (long long unsigned )tti_count % 8 + 1, rb_count, 10 * log10 (*it));
-      rb_count++;
-      it++;
+      std::vector<double> values (sinr.ConstValuesBegin (), sinr.ConstValuesEnd ());
+      PushRecord ([this, imsi, tti_count, values] ()
+                  {
+                    WriteSinr (false, imsi, tti_count, values.data (), values.size ());
+                  });
+      return;
     }
-  fflush (log_file);
-  fclose (log_file);
-  //phyStats->ReportInterferenceTrace (imsi, sinr);
-  //phyStats->ReportPowerTrace (imsi, power);
+  WriteSinr (false, imsi, tti_count, &*sinr.ConstValuesBegin (), sinr.GetValuesN ());
 }
 
 void
 MmWavePhyRxTrace::ReportInterferenceTrace (uint64_t imsi, SpectrumValue& sinr)
 {
   uint64_t tti_count = Now ().GetMicroSeconds () / 125;
-  uint32_t rb_count = 1;
-  FILE* log_file;
-  char fname[255];
-  sprintf (fname, "UE_%llu_SINR_dB.txt", (long long unsigned ) imsi);
-  log_file = fopen (fname, "a");
-  Values::iterator it = sinr.ValuesBegin ();
-  while (it != sinr.ValuesEnd ())
+  if (m_asyncOutput)
     {
-      //fprintf(log_file, "%d\t%d\t%f\t \n", tti_count/2, rb_count, 10*log10(*it));
-      fprintf (log_file, "%llu\t%llu\t%d\t%f\t \n",(long long unsigned) tti_count / 8 + 1, (long long unsigned) tti_count % 8 + 1, rb_count, 10 * log10 (*it));
-      rb_count++;
-      it++;
+      std::vector<double> values (sinr.ConstValuesBegin (), sinr.ConstValuesEnd ());
+      PushRecord ([this, imsi, tti_count, values] ()
+                  {
+                    WriteSinr (true, imsi, tti_count, values.data (), values.size ());
+                  });
+      return;
+    }
+  WriteSinr (true, imsi, tti_count, &*sinr.ConstValuesBegin (), sinr.GetValuesN ());
+}
+
+void
+MmWavePhyRxTrace::WriteSinr (bool isDl, uint64_t imsi, uint64_t ttiCount, const double *sinr, size_t rbNum)
+{
+  if (m_binaryOutput)
+    {
+      MmWaveBinaryTraceWriter &trace = isDl ? GetBinaryTrace (m_dlSinrBin, "DlSinr")
+                                            : GetBinaryTrace (m_ulSinrBin, "UlSinr");
+      for (size_t rb = 0; rb < rbNum; ++rb)
+        {
+          trace.SetUint (0, imsi);
+          trace.SetUint (1, ttiCount);
+          trace.SetUint (2, rb + 1);
+          trace.SetDouble (3, sinr[rb]);
+          trace.EndRow ();
+        }
+      return;
+    }
+  FILE* log_file = GetTextFile (GetTextFileName (isDl ? "DlSinr" : "UlSinr", imsi));
+  for (size_t rb = 0; rb < rbNum; ++rb)
+    {
+      PrintSinr (log_file, ttiCount, static_cast<uint32_t> (rb + 1), sinr[rb]);
     }
-  fflush (log_file);
-  fclose (log_file);
 }
 
 void
@@ -164,86 +478,83 @@ MmWavePhyRxTrace::ReportDownLinkTBSize (Ptr<MmWavePhyRxTrace> phyStats, std::str
 void
 MmWavePhyRxTrace::ReportPacketCountUe (UePhyPacketCountParameter param)
 {
-  FILE* log_file;
-  char fname[255];
-  sprintf (fname,"UE_%llu_Packet_Trace.txt", (long long unsigned) param.m_imsi);
-  log_file = fopen (fname, "a");
-  if (param.m_isTx)
-    {
-      fprintf (log_file, "%d\t%d\t%d\n", param.m_subframeno, param.m_noBytes, 0);
-    }
-  else
+  if (m_asyncOutput)
     {
-      fprintf (log_file, "%d\t%d\t%d\n", param.m_subframeno, 0, param.m_noBytes);
+      PushRecord ([this, param] ()
+                  {
+                    WritePacketCount (true, param.m_imsi, param.m_isTx, param.m_subframeno, param.m_noBytes);
+                  });
+      return;
     }
-
-  fflush (log_file);
-  fclose (log_file);
-
+  WritePacketCount (true, param.m_imsi, param.m_isTx, param.m_subframeno, param.m_noBytes);
 }
 
 void
 MmWavePhyRxTrace::ReportPacketCountEnb (EnbPhyPacketCountParameter param)
 {
-  FILE* log_file;
-  char fname[255];
-  sprintf (fname,"BS_%llu_Packet_Trace.txt",(long long unsigned) param.m_cellId);
-  log_file = fopen (fname, "a");
-  if (param.m_isTx)
+  if (m_asyncOutput)
     {
-      fprintf (log_file, "%d\t%d\t%d\n", param.m_subframeno, param.m_noBytes, 0);
+      PushRecord ([this, param] ()
+                  {
+                    WritePacketCount (false, param.m_cellId, param.m_isTx, param.m_subframeno, param.m_noBytes);
+                  });
+      return;
     }
-  else
+  WritePacketCount (false, param.m_cellId, param.m_isTx, param.m_subframeno, param.m_noBytes);
+}
+
+void
+MmWavePhyRxTrace::WritePacketCount (bool isUe, uint64_t id, bool isTx, uint32_t subframe, uint32_t bytes)
+{
+  if (m_binaryOutput)
     {
-      fprintf (log_file, "%d\t%d\t%d\n", param.m_subframeno, 0, param.m_noBytes);
+      MmWaveBinaryTraceWriter &trace = isUe ? GetBinaryTrace (m_uePacketBin, "UePacketCount")
+                                            : GetBinaryTrace (m_enbPacketBin, "EnbPacketCount");
+      trace.SetUint (0, id);
+      trace.SetUint (1, subframe);
+      trace.SetUint (2, isTx);
+      trace.SetUint (3, bytes);
+      trace.EndRow ();
+      return;
     }
-
-  fflush (log_file);
-  fclose (log_file);
+  PrintPacketCount (GetTextFile (GetTextFileName (isUe ? "UePacketCount" : "EnbPacketCount", id)),
+                    isTx, subframe, bytes);
 }
 
 void
 MmWavePhyRxTrace::ReportDLTbSize (uint64_t imsi, uint64_t tbSize)
 {
-  FILE* log_file;
-  char fname[255];
-  sprintf (fname,"UE_%llu_Tb_Size.txt", (long long unsigned) imsi);
-  log_file = fopen (fname, "a");
-
-  fprintf (log_file, "%llu \t %llu\n", (long long unsigned )Now ().GetMicroSeconds (), (long long unsigned )tbSize);
-  fprintf (log_file, "%lld \t %llu \n",(long long int) Now ().GetMicroSeconds (), (long long unsigned) tbSize);
-  fflush (log_file);
-  fclose (log_file);
+  const int64_t timeUs = Now ().GetMicroSeconds ();
+  if (m_asyncOutput)
+    {
+      PushRecord ([this, timeUs, imsi, tbSize] ()
+                  {
+                    WriteDlTbSize (timeUs, imsi, tbSize);
+                  });
+      return;
+    }
+  WriteDlTbSize (timeUs, imsi, tbSize);
 }
 
 void
-MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
+MmWavePhyRxTrace::WriteDlTbSize (int64_t timeUs, uint64_t imsi, uint64_t tbSize)
 {
-  if (!m_rxPacketTraceFile.is_open ())
+  if (m_binaryOutput)
     {
-      m_rxPacketTraceFilename = "RxPacketTrace.txt";
-      m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
-      m_rxPacketTraceFile << "\tframe\tsubF\tslot\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler\tCcId" << std::endl;
-      if (!m_rxPacketTraceFile.is_open ())
-        {
-          NS_FATAL_ERROR ("Could not open tracefile");
-        }
+      MmWaveBinaryTraceWriter &trace = GetBinaryTrace (m_tbSizeBin, "DlTbSize");
+      trace.SetUint (0, static_cast<uint64_t> (timeUs));
+      trace.SetUint (1, imsi);
+      trace.SetUint (2, tbSize);
+      trace.EndRow ();
+      return;
     }
+  PrintTbSize (GetTextFile (GetTextFileName ("DlTbSize", imsi)), timeUs, tbSize);
+}
 
-  m_rxPacketTraceFile << "DL\t" << params.m_frameNum
-                      << "\t" << (unsigned)params.m_subframeNum
-                      << "\t" << (unsigned)params.m_slotNum
-                      << "\t" << (unsigned)params.m_symStart
-                      << "\t" << (unsigned)params.m_numSym
-                      << "\t" << params.m_cellId
-                      << "\t" << params.m_rnti
-                      << "\t" << params.m_tbSize
-                      << "\t" << (unsigned)params.m_mcs
-                      << "\t" << (unsigned)params.m_rv
-                      << "\t" << 10 * log10 (params.m_sinr)
-                      << "\t" << params.m_corrupt
-                      << "\t" << params.m_tbler
-                      << "\t" << (unsigned)params.m_ccId << std::endl;
+void
+MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
+{
+  phyStats->ReportRxPacketTrace (true, params);
 
   if (params.m_corrupt)
     {
@@ -265,33 +576,175 @@ MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::
 void
 MmWavePhyRxTrace::RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
 {
+  phyStats->ReportRxPacketTrace (false, params);
+
+  if (params.m_corrupt)
+    {
+      NS_LOG_DEBUG ("UL TB error\t" << params.m_frameNum << "\t" << (unsigned)params.m_subframeNum
+                                    << "\t" << (unsigned)params.m_slotNum
+                                    << "\t" << (unsigned)params.m_symStart
+                                    << "\t" << (unsigned)params.m_numSym
+                                    << "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
+                                    << params.m_sinr << "\t" << params.m_tbler << "\t" << params.m_corrupt << "\t" << params.m_sinrMin << " \t" << params.m_ccId);
+    }
+}
+
+void
+MmWavePhyRxTrace::SetRxPacketTraceOwner ()
+{
+  if (m_rxPacketTraceOwner != this)
+    {
+      NS_ABORT_MSG_IF (m_rxPacketTraceOwner != nullptr
+                       && (m_asyncOutput || m_rxPacketTraceOwner->m_asyncOutput),
+                       "RxPacketTrace.txt is written by two MmWavePhyRxTrace, and one "
+                       "of them uses the AsyncWriter; use BinaryOutput, or a single instance");
+      m_rxPacketTraceOwner = this;
+    }
+}
+
+void
+MmWavePhyRxTrace::ReportRxPacketTrace (bool isDl, const RxPacketTraceParams &params)
+{
+  // In the simulator thread, before the writer thread may use the shared file
+  if (! m_binaryOutput)
+    {
+      SetRxPacketTraceOwner ();
+    }
+  if (m_asyncOutput)
+    {
+      PushRecord ([this, isDl, params] ()
+                  {
+                    WriteRxPacketTrace (isDl, params);
+                  });
+      return;
+    }
+  WriteRxPacketTrace (isDl, params);
+}
+
+void
+MmWavePhyRxTrace::WriteRxPacketTrace (bool isDl, const RxPacketTraceParams &params)
+{
+  if (m_binaryOutput)
+    {
+      MmWaveBinaryTraceWriter &trace = GetBinaryTrace (m_rxPacketBin, "RxPacketTrace");
+      trace.SetUint (0, isDl);
+      trace.SetUint (1, params.m_frameNum);
+      trace.SetUint (2, params.m_subframeNum);
+      trace.SetUint (3, params.m_slotNum);
+      trace.SetUint (4, params.m_symStart);
+      trace.SetUint (5, params.m_numSym);
+      trace.SetUint (6, params.m_cellId);
+      trace.SetUint (7, params.m_rnti);
+      trace.SetUint (8, params.m_tbSize);
+      trace.SetUint (9, params.m_mcs);
+      trace.SetUint (10, params.m_rv);
+      trace.SetDouble (11, params.m_sinr);
+      trace.SetUint (12, params.m_corrupt);
+      trace.SetDouble (13, params.m_tbler);
+      trace.SetUint (14, params.m_ccId);
+      trace.EndRow ();
+      return;
+    }
+
   if (!m_rxPacketTraceFile.is_open ())
     {
       m_rxPacketTraceFilename = "RxPacketTrace.txt";
       m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
-      m_rxPacketTraceFile << "\tframe\tsubF\tslot\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler\tCcId" << std::endl;
-
       if (!m_rxPacketTraceFile.is_open ())
         {
           NS_FATAL_ERROR ("Could not open tracefile");
         }
+      PrintRxPacketTraceHeader (m_rxPacketTraceFile);
     }
-  m_rxPacketTraceFile << "UL\t" << params.m_frameNum << "\t" << (unsigned)params.m_subframeNum
-                      << "\t" << (unsigned)params.m_slotNum
-                      << "\t" << (unsigned)params.m_symStart
-                      << "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
-                      << "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-                      << 10 * log10 (params.m_sinr) << "\t\t" << params.m_corrupt << " \t" << params.m_tbler << " \t" << params.m_ccId << std::endl;
+  PrintRxPacketTrace (m_rxPacketTraceFile, isDl, params);
+}
 
-  if (params.m_corrupt)
+uint64_t
+MmWavePhyRxTrace::ConvertToText (const std::string &binFileName, const std::string &prefix)
+{
+  MmWaveBinaryTraceReader reader;
+  reader.Open (binFileName);
+  const std::string kind = reader.GetKind ();
+  // Check that the columns are the expected ones, in the expected order
+  const std::vector<MmWaveBinaryTrace::Column> expected = GetBinaryColumns (kind);
+  NS_ABORT_MSG_UNLESS (reader.GetColumns ().size () == expected.size (), "Unexpected columns in " << binFileName);
+  for (uint32_t i = 0; i < expected.size (); ++i)
     {
-      NS_LOG_DEBUG ("UL TB error\t" << params.m_frameNum << "\t" << (unsigned)params.m_subframeNum
-                                    << "\t" << (unsigned)params.m_slotNum
-                                    << "\t" << (unsigned)params.m_symStart
-                                    << "\t" << (unsigned)params.m_numSym
-                                    << "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-                                    << params.m_sinr << "\t" << params.m_tbler << "\t" << params.m_corrupt << "\t" << params.m_sinrMin << " \t" << params.m_ccId);
+      NS_ABORT_MSG_UNLESS (reader.GetColumns ()[i].m_name == expected[i].m_name
+                           && reader.GetColumns ()[i].m_type == expected[i].m_type,
+                           "Unexpected column " << reader.GetColumns ()[i].m_name << " in " << binFileName);
+    }
+
+  uint64_t rows = 0;
+  if (kind == "RxPacketTrace")
+    {
+      std::ofstream out ((prefix + "RxPacketTrace.txt").c_str ());
+      NS_ABORT_MSG_UNLESS (out.is_open (), "Could not open " << prefix << "RxPacketTrace.txt");
+      PrintRxPacketTraceHeader (out);
+      while (reader.ReadBlock ())
+        {
+          for (uint32_t row = 0; row < reader.GetNumRows (); ++row, ++rows)
+            {
+              RxPacketTraceParams params;
+              params.m_frameNum = static_cast<uint32_t> (reader.GetUint (1, row));
+              params.m_subframeNum = static_cast<uint8_t> (reader.GetUint (2, row));
+              params.m_slotNum = static_cast<uint16_t> (reader.GetUint (3, row));
+              params.m_symStart = static_cast<uint8_t> (reader.GetUint (4, row));
+              params.m_numSym = static_cast<uint8_t> (reader.GetUint (5, row));
+              params.m_cellId = reader.GetUint (6, row);
+              params.m_rnti = static_cast<uint16_t> (reader.GetUint (7, row));
+              params.m_tbSize = static_cast<uint32_t> (reader.GetUint (8, row));
+              params.m_mcs = static_cast<uint8_t> (reader.GetUint (9, row));
+              params.m_rv = static_cast<uint8_t> (reader.GetUint (10, row));
+              params.m_sinr = reader.GetDouble (11, row);
+              params.m_corrupt = reader.GetUint (12, row) != 0;
+              params.m_tbler = reader.GetDouble (13, row);
+              params.m_ccId = static_cast<uint8_t> (reader.GetUint (14, row));
+              PrintRxPacketTrace (out, reader.GetUint (0, row) != 0, params);
+            }
+        }
+      return rows;
+    }
+
+  // The other traces have one text file per UE or cell, in the first column
+  // (the second one for the TB size)
+  const uint32_t idColumn = kind == "DlTbSize" ? 1 : 0;
+  std::unordered_map<uint64_t, FILE *> files;
+  while (reader.ReadBlock ())
+    {
+      for (uint32_t row = 0; row < reader.GetNumRows (); ++row, ++rows)
+        {
+          const uint64_t id = reader.GetUint (idColumn, row);
+          auto it = files.find (id);
+          if (it == files.end ())
+            {
+              const std::string fileName = prefix + GetTextFileName (kind, id);
+              FILE *file = fopen (fileName.c_str (), "w");
+              NS_ABORT_MSG_IF (file == nullptr, "Could not open " << fileName);
+              it = files.emplace (id, file).first;
+            }
+          if (kind == "DlSinr" || kind == "UlSinr")
+            {
+              PrintSinr (it->second, reader.GetUint (1, row), static_cast<uint32_t> (reader.GetUint (2, row)),
+                         reader.GetDouble (3, row));
+            }
+          else if (kind == "DlTbSize")
+            {
+              PrintTbSize (it->second, static_cast<int64_t> (reader.GetUint (0, row)), reader.GetUint (2, row));
+            }
+          else
+            {
+              PrintPacketCount (it->second, reader.GetUint (2, row) != 0,
+                                static_cast<uint32_t> (reader.GetUint (1, row)),
+                                static_cast<uint32_t> (reader.GetUint (3, row)));
+            }
+        }
+    }
+  for (auto & file : files)
+    {
+      fclose (file.second);
     }
+  return rows;
 }
 
 } /* namespace ns3 */
@@ -31,11 +31,37 @@
 #include <ns3/object.h>
 #include <ns3/spectrum-value.h>
 #include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/event-id.h>
+#include "mmwave-binary-trace.h"
+#include "mmwave-async-trace-writer.h"
 #include <fstream>
 #include <iostream>
+#include <list>
+#include <unordered_map>
 
 namespace ns3 {
 
+/**
+ * \brief Sink of the PHY traces of the devices
+ *
+ * By default, it writes the text files of each trace (RxPacketTrace.txt, and
+ * the per-UE or per-cell files as UE_1_UL_SINR_dB.txt). The files are opened
+ * the first time they are needed, and kept open until the object is disposed.
+ *
+ * With the attribute BinaryOutput, each trace is instead written in a single
+ * binary columnar file (e.g., RxPacketTrace.bin, UlSinr.bin), through a
+ * MmWaveBinaryTraceWriter, with one column for the UE or the cell. ConvertToText
+ * writes the text files of a binary trace, in the same layout as the text output.
+ *
+ * With the attribute AsyncWriter, the lines and the binary rows are formatted
+ * and written by a MmWaveAsyncTraceWriter thread, and the simulator thread only
+ * copies the values of each report. The files have the same content as
+ * without it (unless AsyncFullPolicy is Drop and the queue fills up). The
+ * thread is drained, and the files flushed, at Simulator::Destroy. Since the
+ * RxPacketTrace text file is shared by all the instances, the simulation is
+ * aborted if an instance writes it with the AsyncWriter while another instance
+ * writes it too (the binary output is per instance).
+ */
 class MmWavePhyRxTrace : public Object
 {
 public:
@@ -55,15 +81,157 @@ public:
   static void RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
   static void RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
 
+  /**
+   * \brief Write the text files of a binary trace
+   * \param binFileName name of the binary trace
+   * \param prefix prefix of the names of the text files (e.g., a directory)
+   * \return the number of rows converted
+   *
+   * The text files are created (not appended to) in the same layout as the
+   * ones written without BinaryOutput.
+   */
+  static uint64_t ConvertToText (const std::string &binFileName, const std::string &prefix);
+
+  /**
+   * \brief Wait for the records queued for the writer thread, write the binary
+   * rows kept in memory, and flush the open files
+   */
+  void Flush ();
+
+protected:
+  virtual void DoDispose () override;
+
 private:
   void ReportInterferenceTrace (uint64_t imsi, SpectrumValue& sinr);
+  void ReportUlSinrTrace (uint64_t imsi, SpectrumValue& sinr);
   void ReportPowerTrace (uint64_t imsi, SpectrumValue& power);
   void ReportPacketCountUe (UePhyPacketCountParameter param);
   void ReportPacketCountEnb (EnbPhyPacketCountParameter param);
   void ReportDLTbSize (uint64_t imsi, uint64_t tbSize);
+  void ReportRxPacketTrace (bool isDl, const RxPacketTraceParams &params);
+
+  /**
+   * \brief Write the SINR of the RBs of a report
+   * \param isDl true for the DL SINR, false for the UL one
+   * \param imsi the IMSI of the UE
+   * \param ttiCount the TTI of the report
+   * \param sinr the SINR of each RB, in linear units
+   * \param rbNum the number of RBs
+   */
+  void WriteSinr (bool isDl, uint64_t imsi, uint64_t ttiCount, const double *sinr, size_t rbNum);
+  /**
+   * \brief Write a packet count report
+   * \param isUe true for a UE report, false for a gNB one
+   * \param id the IMSI of the UE, or the cell ID
+   * \param isTx true for a TX report
+   * \param subframe the subframe number
+   * \param bytes the number of bytes
+   */
+  void WritePacketCount (bool isUe, uint64_t id, bool isTx, uint32_t subframe, uint32_t bytes);
+  /**
+   * \brief Write a DL TB size report
+   * \param timeUs the time of the report, in microseconds
+   * \param imsi the IMSI of the UE
+   * \param tbSize the TB size
+   */
+  void WriteDlTbSize (int64_t timeUs, uint64_t imsi, uint64_t tbSize);
+  /**
+   * \brief Write a RxPacketTrace report
+   * \param isDl true for a DL report, false for an UL one
+   * \param params the report
+   */
+  void WriteRxPacketTrace (bool isDl, const RxPacketTraceParams &params);
+
+  /**
+   * \brief Hand a record to the writer thread, starting it the first time
+   * \param record the record, which captures by value what it writes
+   */
+  void PushRecord (std::function<void ()> record);
+
+  /**
+   * \brief Drain and stop the writer thread, if it is running
+   */
+  void StopAsyncWriter ();
+
+  /**
+   * \brief Drain and stop the writer thread, and flush the files; scheduled
+   * at Simulator::Destroy when the thread starts
+   */
+  void DestroyAsyncWriter ();
+
+  /**
+   * \brief Get a text file, opening it in append mode if it is not open
+   * \param fileName the name of the file
+   * \return the file
+   *
+   * At most MaxOpenTextFiles files are open: the one used least recently
+   * is closed to open another one, and it is opened again in append mode
+   * when it is used again.
+   */
+  FILE * GetTextFile (const std::string &fileName);
+
+  /**
+   * \brief Get the writer of a binary trace, opening it the first time
+   * \param writer the writer
+   * \param kind the kind of the trace, which gives the file name and the columns
+   * \return the writer
+   */
+  MmWaveBinaryTraceWriter & GetBinaryTrace (MmWaveBinaryTraceWriter &writer, const std::string &kind);
+
+  /**
+   * \brief Close the text files and the binary traces
+   */
+  void CloseFiles ();
+
+  static void PrintRxPacketTraceHeader (std::ostream &os);
+  static void PrintRxPacketTrace (std::ostream &os, bool isDl, const RxPacketTraceParams &params);
+  static void PrintSinr (FILE *file, uint64_t ttiCount, uint32_t rbCount, double sinr);
+  static void PrintPacketCount (FILE *file, bool isTx, uint32_t subframe, uint32_t bytes);
+  static void PrintTbSize (FILE *file, int64_t timeUs, uint64_t tbSize);
+
+  /**
+   * \param kind the kind of a binary trace
+   * \return its columns
+   */
+  static std::vector<MmWaveBinaryTrace::Column> GetBinaryColumns (const std::string &kind);
+
+  /**
+   * \brief Record the instance that writes the RxPacketTrace text file,
+   * aborting if another instance writes it and one of them uses the AsyncWriter
+   */
+  void SetRxPacketTraceOwner ();
 
   static std::ofstream m_rxPacketTraceFile;
   static std::string m_rxPacketTraceFilename;
+  static MmWavePhyRxTrace *m_rxPacketTraceOwner; //!< Last instance that wrote m_rxPacketTraceFile
+
+  bool m_binaryOutput {false};       //!< True to write the binary traces
+  uint32_t m_binaryBlockRows {4096}; //!< Rows of a block of the binary traces
+  bool m_asyncOutput {false};        //!< True to write the traces in a separate thread
+  uint32_t m_asyncQueueSize {65536}; //!< Records of the queue of the writer thread
+  MmWaveAsyncTraceWriter::FullPolicy m_asyncFullPolicy {MmWaveAsyncTraceWriter::BLOCK}; //!< Policy when the queue is full
+  /**
+   * \brief An open text file
+   */
+  struct TextFile
+  {
+    FILE *m_file {nullptr};                //!< The file
+    std::list<std::string>::iterator m_lru; //!< Position of the file in m_textFilesLru
+  };
+
+  uint32_t m_maxOpenTextFiles {64};                    //!< Maximum number of open text files
+  std::unordered_map<std::string, TextFile> m_textFiles; //!< The open text files, by name
+  std::list<std::string> m_textFilesLru;               //!< Names of the open text files, the most recently used first
+  EventId m_textFlushEvent;                            //!< Flush of the text files at Simulator::Destroy
+  MmWaveBinaryTraceWriter m_rxPacketBin;  //!< Binary RxPacketTrace
+  MmWaveBinaryTraceWriter m_dlSinrBin;    //!< Binary DL SINR trace
+  MmWaveBinaryTraceWriter m_ulSinrBin;    //!< Binary UL SINR trace
+  MmWaveBinaryTraceWriter m_uePacketBin;  //!< Binary UE packet count trace
+  MmWaveBinaryTraceWriter m_enbPacketBin; //!< Binary gNB packet count trace
+  MmWaveBinaryTraceWriter m_tbSizeBin;    //!< Binary DL TB size trace
+  // Declared after the files, so that the thread stops before they are destroyed
+  MmWaveAsyncTraceWriter m_asyncWriter; //!< The writer thread
+  EventId m_asyncDestroyEvent;          //!< Drain of the writer thread at Simulator::Destroy
 };
 
 } /* namespace ns3 */
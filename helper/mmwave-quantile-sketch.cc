@@ -0,0 +1,188 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-quantile-sketch.h"
+#include <ns3/abort.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+const double MmWaveQuantileSketch::MIN_VALUE = 1e-9;
+
+MmWaveQuantileSketch::MmWaveQuantileSketch (double accuracy, uint32_t maxBuckets)
+  : m_gamma ((1 + accuracy) / (1 - accuracy)),
+    m_logGamma (std::log (m_gamma)),
+    m_maxBuckets (maxBuckets)
+{
+  NS_ABORT_MSG_UNLESS (accuracy > 0 && accuracy < 1, "The accuracy must be in (0, 1)");
+  NS_ABORT_MSG_IF (maxBuckets == 0, "The sketch needs at least one bucket");
+}
+
+int32_t
+MmWaveQuantileSketch::GetIndex (double value) const
+{
+  return static_cast<int32_t> (std::ceil (std::log (value) / m_logGamma));
+}
+
+double
+MmWaveQuantileSketch::GetValue (int32_t index) const
+{
+  // The value with the same relative error from both bounds of the bucket
+  return 2 * std::pow (m_gamma, index) / (m_gamma + 1);
+}
+
+void
+MmWaveQuantileSketch::Add (double value)
+{
+  NS_ABORT_MSG_IF (value < 0, "Negative value " << value);
+
+  if (m_count == 0)
+    {
+      m_min = value;
+      m_max = value;
+    }
+  else
+    {
+      m_min = std::min (m_min, value);
+      m_max = std::max (m_max, value);
+    }
+  ++m_count;
+  const double delta = value - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (value - m_mean);
+
+  if (value < MIN_VALUE)
+    {
+      ++m_zeroCount;
+      return;
+    }
+
+  int32_t index = GetIndex (value);
+  if (m_buckets.empty ())
+    {
+      m_offset = index;
+      m_buckets.push_back (1);
+      return;
+    }
+
+  const int32_t last = m_offset + static_cast<int32_t> (m_buckets.size ()) - 1;
+  if (index > last)
+    {
+      // Keep at most m_maxBuckets buckets, ending with the new one: the ones
+      // below are merged in the lowest bucket kept
+      const int32_t newOffset = std::max (m_offset, index - static_cast<int32_t> (m_maxBuckets) + 1);
+      uint64_t merged = 0;
+      if (newOffset > m_offset)
+        {
+          const size_t drop = std::min (static_cast<size_t> (newOffset - m_offset), m_buckets.size ());
+          for (size_t i = 0; i < drop; ++i)
+            {
+              merged += m_buckets[i];
+            }
+          m_buckets.erase (m_buckets.begin (), m_buckets.begin () + drop);
+          m_offset = newOffset;
+        }
+      m_buckets.resize (index - m_offset + 1, 0);
+      m_buckets.front () += merged;
+    }
+  else if (index < m_offset)
+    {
+      // Below the lowest bucket allowed, the value is counted in it
+      index = std::max (index, last - static_cast<int32_t> (m_maxBuckets) + 1);
+      m_buckets.insert (m_buckets.begin (), m_offset - index, 0);
+      m_offset = index;
+    }
+  ++m_buckets[index - m_offset];
+}
+
+void
+MmWaveQuantileSketch::Clear ()
+{
+  m_buckets.clear ();
+  m_offset = 0;
+  m_zeroCount = 0;
+  m_count = 0;
+  m_mean = 0.0;
+  m_m2 = 0.0;
+  m_min = 0.0;
+  m_max = 0.0;
+}
+
+uint64_t
+MmWaveQuantileSketch::GetCount () const
+{
+  return m_count;
+}
+
+double
+MmWaveQuantileSketch::GetMean () const
+{
+  return m_mean;
+}
+
+double
+MmWaveQuantileSketch::GetStddev () const
+{
+  return m_count < 2 ? 0.0 : std::sqrt (m_m2 / (m_count - 1));
+}
+
+double
+MmWaveQuantileSketch::GetMin () const
+{
+  return m_min;
+}
+
+double
+MmWaveQuantileSketch::GetMax () const
+{
+  return m_max;
+}
+
+double
+MmWaveQuantileSketch::GetQuantile (double q) const
+{
+  if (m_count == 0)
+    {
+      return 0.0;
+    }
+  const double rank = std::min (std::max (q, 0.0), 1.0) * (m_count - 1);
+  uint64_t cumulative = m_zeroCount;
+  if (cumulative > rank)
+    {
+      return m_min;
+    }
+  for (size_t i = 0; i < m_buckets.size (); ++i)
+    {
+      cumulative += m_buckets[i];
+      if (cumulative > rank)
+        {
+          // The exact bounds are better than the bucket for the extreme ones
+          const double value = GetValue (m_offset + static_cast<int32_t> (i));
+          return std::min (std::max (value, m_min), m_max);
+        }
+    }
+  return m_max;
+}
+
+uint32_t
+MmWaveQuantileSketch::GetNumBuckets () const
+{
+  return static_cast<uint32_t> (m_buckets.size ());
+}
+
+} // namespace ns3
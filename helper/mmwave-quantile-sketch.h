@@ -0,0 +1,127 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Streaming statistics and quantiles of non-negative values, in
+ * bounded memory
+ *
+ * The values are counted in a histogram with logarithmic buckets: the bucket
+ * i holds the values in (gamma^(i-1), gamma^i], with
+ * gamma = (1 + accuracy) / (1 - accuracy), so that any quantile is returned
+ * with a relative error of at most the accuracy. The values smaller than
+ * MIN_VALUE (e.g., 0) are counted apart.
+ *
+ * Only the buckets between the lowest and the highest value are stored, up
+ * to a maximum number: beyond it, the lowest buckets are merged, and the
+ * error bound holds only for the quantiles that fall in the highest buckets
+ * (which are the p95 and p99 of interest). The count, mean, standard
+ * deviation, minimum and maximum are exact.
+ */
+class MmWaveQuantileSketch
+{
+public:
+  /**
+   * \brief Create an empty sketch
+   * \param accuracy the relative accuracy of the quantiles, in (0, 1)
+   * \param maxBuckets the maximum number of buckets stored
+   */
+  MmWaveQuantileSketch (double accuracy = 0.01, uint32_t maxBuckets = 1024);
+
+  /**
+   * \brief Add a value
+   * \param value the value, which must not be negative
+   */
+  void Add (double value);
+
+  /**
+   * \brief Remove all the values
+   */
+  void Clear ();
+
+  /**
+   * \return the number of values added
+   */
+  uint64_t GetCount () const;
+
+  /**
+   * \return the mean of the values, or 0 if there is none
+   */
+  double GetMean () const;
+
+  /**
+   * \return the standard deviation of the values, or 0 if there are less than two
+   */
+  double GetStddev () const;
+
+  /**
+   * \return the smallest value, or 0 if there is none
+   */
+  double GetMin () const;
+
+  /**
+   * \return the largest value, or 0 if there is none
+   */
+  double GetMax () const;
+
+  /**
+   * \brief Get a quantile
+   * \param q the quantile, in [0, 1] (e.g., 0.95 for the 95th percentile)
+   * \return the value of the quantile, or 0 if there is no value
+   */
+  double GetQuantile (double q) const;
+
+  /**
+   * \return the number of buckets stored
+   */
+  uint32_t GetNumBuckets () const;
+
+  static const double MIN_VALUE; //!< Smallest value counted in a bucket
+
+private:
+  /**
+   * \param value a value not smaller than MIN_VALUE
+   * \return the index of its bucket
+   */
+  int32_t GetIndex (double value) const;
+
+  /**
+   * \param index the index of a bucket
+   * \return the value that represents the bucket
+   */
+  double GetValue (int32_t index) const;
+
+  double m_gamma {0.0};              //!< Ratio of the bounds of a bucket
+  double m_logGamma {0.0};           //!< Logarithm of m_gamma
+  uint32_t m_maxBuckets {0};         //!< Maximum number of buckets stored
+  std::vector<uint64_t> m_buckets;   //!< Counts of the buckets, from the lowest index
+  int32_t m_offset {0};              //!< Index of the first bucket stored
+  uint64_t m_zeroCount {0};          //!< Values smaller than MIN_VALUE
+  uint64_t m_count {0};              //!< Number of values
+  double m_mean {0.0};               //!< Mean of the values
+  double m_m2 {0.0};                 //!< Sum of the squared differences from the mean
+  double m_min {0.0};                //!< Smallest value
+  double m_max {0.0};                //!< Largest value
+};
+
+} // namespace ns3
@@ -23,6 +23,9 @@
 #include "antenna-array-3gpp-model.h"
 #include "ns3/double.h"
 #include "ns3/enum.h"
+#include <map>
+#include <mutex>
+#include <tuple>
 
 
 NS_LOG_COMPONENT_DEFINE ("AntennaArray3gppModel");
@@ -53,7 +56,19 @@ AntennaArray3gppModel::GetTypeId ()
                   EnumValue(AntennaArray3gppModel::GnbWallMount),
                   MakeEnumAccessor(&AntennaArray3gppModel::m_antennaMount),
                   MakeEnumChecker(AntennaArray3gppModel::GnbWallMount, "GnbWallMount",
-                                  AntennaArray3gppModel::GnbSingleSector, "GnbSingleSector"));
+                                  AntennaArray3gppModel::GnbSingleSector, "GnbSingleSector"))
+    .AddAttribute ("RadiationPatternStep",
+                   "Step, in degrees, of the grid of the table in which the radiation pattern "
+                   "is interpolated; 0 computes the pattern at each call",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&AntennaArray3gppModel::m_patternStep),
+                   MakeDoubleChecker<double> (0.0, 90.0))
+    .AddAttribute ("RadiationPatternMaxError",
+                   "If positive, the step of the radiation pattern table is halved until "
+                   "the error of the interpolation is at most this value",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&AntennaArray3gppModel::m_patternMaxError),
+                   MakeDoubleChecker<double> (0.0));
   return tid;
 }
 
@@ -96,9 +111,47 @@ AntennaArray3gppModel::GetRadiationPattern (double vAngleRadian, double hAngleRa
   NS_ASSERT_MSG (vAngle >= 0 && vAngle <= 180, "The vertical angle should be in the range of [0,180]");
   NS_ASSERT_MSG (hAngle >= -180 && hAngle <= 180, "The horizontal angle should be in the range of [-180,180]");
 
+  if (m_patternStep > 0)
+    {
+      return GetPatternTable ()->GetValue (vAngle, hAngle);
+    }
+  return ComputeRadiationPattern (m_isUe, m_antennaMount, vAngle, hAngle);
+}
+
+void
+AntennaArray3gppModel::GetRadiationPatterns (const double *vAngles, const double *hAngles, uint32_t num,
+                                             double *patterns)
+{
+  const AntennaArray3gppPatternTable *table = m_patternStep > 0 ? GetPatternTable () : nullptr;
+  for (uint32_t i = 0; i < num; ++i)
+    {
+      double hAngleRadian = hAngles[i];
+      while (hAngleRadian >= M_PI)
+        {
+          hAngleRadian -= 2 * M_PI;
+        }
+      while (hAngleRadian < -M_PI)
+        {
+          hAngleRadian += 2 * M_PI;
+        }
+
+      double vAngle = vAngles[i] * 180 / M_PI;
+      double hAngle = hAngleRadian * 180 / M_PI;
+
+      NS_ASSERT_MSG (vAngle >= 0 && vAngle <= 180, "The vertical angle should be in the range of [0,180]");
+
+      patterns[i] = table != nullptr ? table->GetValue (vAngle, hAngle)
+                                     : ComputeRadiationPattern (m_isUe, m_antennaMount, vAngle, hAngle);
+    }
+}
+
+double
+AntennaArray3gppModel::ComputeRadiationPattern (bool isUe, GnbAntennaMount antennaMount,
+                                                double vAngle, double hAngle)
+{
   double A = 0 ;
 
-  if (m_isUe)
+  if (isUe)
     {
       double gMax = 5;  // maximum directional gain of an antenna element in dBi according to UE antenna radiation pattern in 38.802 table A.2.1-8
       double hpbw = 90; //HPBW value of each antenna element
@@ -111,7 +164,7 @@ AntennaArray3gppModel::GetRadiationPattern (double vAngleRadian, double hAngleRa
     }
   else
     {
-      if (m_antennaMount == GnbAntennaMount::GnbWallMount)
+      if (antennaMount == GnbAntennaMount::GnbWallMount)
         {
           double gMax = 5;  // maximum directional gain of an antenna element of Wall Mount radiation pattern (38.802 table A.2.1.7)
           double hpbw = 90; //HPBW value of each antenna element
@@ -122,7 +175,7 @@ AntennaArray3gppModel::GetRadiationPattern (double vAngleRadian, double hAngleRa
 
           A = gMax - 1 * std::min (A_M, -1 * A_v - 1 * A_h);
         }
-      else if (m_antennaMount == GnbAntennaMount::GnbSingleSector)
+      else if (antennaMount == GnbAntennaMount::GnbSingleSector)
         {
           double gMax = 5;  // maximum directional gain of an antenna element of Single Sector Mount radiation pattern (38.802 table A.2.1.7)
           double hpbw = 65; //HPBW value of each antenna element
@@ -140,6 +193,48 @@ AntennaArray3gppModel::GetRadiationPattern (double vAngleRadian, double hAngleRa
   return sqrt (pow (10, A / 10)); //field factor term converted to linear;
 }
 
+bool
+AntennaArray3gppModel::PatternKey::operator< (const PatternKey &other) const
+{
+  return std::tie (m_isUe, m_antennaMount, m_step, m_maxError)
+    < std::tie (other.m_isUe, other.m_antennaMount, other.m_step, other.m_maxError);
+}
+
+const AntennaArray3gppPatternTable *
+AntennaArray3gppModel::GetPatternTable ()
+{
+  PatternKey key;
+  key.m_isUe = m_isUe;
+  // The gNB mount does not change the pattern of a UE
+  key.m_antennaMount = m_isUe ? GnbWallMount : m_antennaMount;
+  key.m_step = m_patternStep;
+  key.m_maxError = m_patternMaxError;
+  if (m_patternTable != nullptr && ! (key < m_patternKey) && ! (m_patternKey < key))
+    {
+      return m_patternTable.get ();
+    }
+
+  static std::map<PatternKey, std::shared_ptr<const AntennaArray3gppPatternTable> > tables;
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock (mutex);
+  auto it = tables.find (key);
+  if (it == tables.end ())
+    {
+      const bool isUe = key.m_isUe;
+      const GnbAntennaMount antennaMount = key.m_antennaMount;
+      auto pattern = [isUe, antennaMount] (double vAngle, double hAngle)
+        {
+          return ComputeRadiationPattern (isUe, antennaMount, vAngle, hAngle);
+        };
+      std::shared_ptr<const AntennaArray3gppPatternTable> table =
+        std::make_shared<AntennaArray3gppPatternTable> (pattern, key.m_step, key.m_maxError);
+      it = tables.insert (std::make_pair (key, table)).first;
+    }
+  m_patternKey = key;
+  m_patternTable = it->second;
+  return m_patternTable.get ();
+}
+
 Vector
 AntennaArray3gppModel::GetAntennaLocation (uint8_t index, uint8_t* antennaNum)
 {
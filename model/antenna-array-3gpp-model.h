@@ -21,7 +21,9 @@
 #include <complex>
 #include <ns3/net-device.h>
 #include "antenna-array-model.h"
+#include "antenna-array-3gpp-pattern-table.h"
 #include <map>
+#include <memory>
 
 namespace ns3 {
 
@@ -63,14 +65,74 @@ public:
    */
   bool GetIsUe ();
 
+  /**
+   * \brief Function returns the radiation pattern (field factor, linear) of
+   * an antenna element. If the attribute RadiationPatternStep is positive,
+   * the pattern is interpolated in an AntennaArray3gppPatternTable, shared
+   * by the antennas with the same pattern and table configuration.
+   * @param vAngle vertical angle, in radians in [0, pi]
+   * @param hAngle horizontal angle, in radians
+   * @return the radiation pattern
+   */
   virtual double GetRadiationPattern (double vAngle, double hAngle = 0) override;
 
+  /**
+   * \brief Function returns the radiation pattern of a set of directions,
+   * without a virtual call and a table lookup per direction
+   * @param vAngles vertical angle of each direction, in radians in [0, pi]
+   * @param hAngles horizontal angle of each direction, in radians
+   * @param num number of directions
+   * @param patterns the radiation pattern of each direction
+   */
+  virtual void GetRadiationPatterns (const double *vAngles, const double *hAngles, uint32_t num,
+                                     double *patterns) override;
+
+  /**
+   * \brief Function computes the radiation pattern (field factor, linear)
+   * of an antenna element, as in 38.802 table A.2.1-7 and A.2.1-8
+   * @param isUe whether the antenna is of UE or gNB
+   * @param antennaMount the type of gNB antenna mount
+   * @param vAngle vertical angle, in degrees in [0, 180]
+   * @param hAngle horizontal angle, in degrees in [-180, 180]
+   * @return the radiation pattern
+   */
+  static double ComputeRadiationPattern (bool isUe, GnbAntennaMount antennaMount,
+                                         double vAngle, double hAngle);
+
   Vector GetAntennaLocation (uint8_t index, uint8_t* antennaNum) override;
 
 private:
+  /**
+   * \brief The configuration of a radiation pattern table
+   */
+  struct PatternKey
+  {
+    bool m_isUe;                     //!< Whether the antenna is of UE or gNB
+    GnbAntennaMount m_antennaMount;  //!< Type of gNB antenna mount
+    double m_step;                   //!< Step of the table, in degrees
+    double m_maxError;               //!< Maximum error of the table
+
+    /**
+     * \brief Order the configurations
+     * \param other another configuration
+     * \return true if this configuration comes before the other
+     */
+    bool operator< (const PatternKey &other) const;
+  };
+
+  /**
+   * \brief Get the table of the radiation pattern of the antenna, from the
+   * tables shared by all the antennas (it is created the first time)
+   * \return the table
+   */
+  const AntennaArray3gppPatternTable * GetPatternTable ();
 
   bool m_isUe; ///<! the attribute that is saying if the antenna is of UE or gNB
   GnbAntennaMount m_antennaMount; ///<! the type of gNb antenna mount
+  double m_patternStep {0.0};     ///<! the step of the radiation pattern table, 0 to compute the pattern
+  double m_patternMaxError {0.0}; ///<! the maximum error of the radiation pattern table, 0 for no bound
+  PatternKey m_patternKey;        ///<! the configuration of m_patternTable
+  std::shared_ptr<const AntennaArray3gppPatternTable> m_patternTable; ///<! the radiation pattern table, if any
 
 };
 
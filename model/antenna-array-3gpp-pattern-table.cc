@@ -0,0 +1,97 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "antenna-array-3gpp-pattern-table.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AntennaArray3gppPatternTable");
+
+const double AntennaArray3gppPatternTable::MIN_STEP = 0.125;
+
+AntennaArray3gppPatternTable::AntennaArray3gppPatternTable (const Pattern &pattern, double step,
+                                                            double maxError)
+{
+  NS_ABORT_MSG_UNLESS (step > 0, "The step of the table should be positive");
+  Build (pattern, std::max (step, MIN_STEP));
+  while (maxError > 0 && m_error > maxError)
+    {
+      NS_ABORT_MSG_IF (m_step / 2 < MIN_STEP, "The error of the radiation pattern table is " << m_error
+                       << " with a step of " << m_step << " degrees, it cannot be brought to " << maxError);
+      Build (pattern, m_step / 2);
+    }
+  NS_LOG_INFO ("Radiation pattern table with a step of " << m_step << " degrees, "
+               << m_values.size () << " values, error " << m_error);
+}
+
+void
+AntennaArray3gppPatternTable::Build (const Pattern &pattern, double step)
+{
+  m_numV = std::max (1l, std::lround (180.0 / step));
+  m_numH = 2 * m_numV;
+  m_step = 180.0 / m_numV;
+
+  m_values.resize ((m_numV + 1) * (m_numH + 1));
+  for (uint32_t i = 0; i <= m_numV; ++i)
+    {
+      for (uint32_t j = 0; j <= m_numH; ++j)
+        {
+          m_values[i * (m_numH + 1) + j] = pattern (i * m_step, j * m_step - 180.0);
+        }
+    }
+
+  // The error of a bilinear interpolation is largest away from the points
+  // of the grid, and where the pattern has a corner (as the side-lobe
+  // limit): measure it on a sub-grid of a quarter of the step
+  m_error = 0.0;
+  for (uint32_t i = 0; i < 4 * m_numV + 1; ++i)
+    {
+      for (uint32_t j = 0; j < 4 * m_numH + 1; ++j)
+        {
+          if (i % 4 != 0 || j % 4 != 0)
+            {
+              const double vAngle = i * m_step / 4;
+              const double hAngle = j * m_step / 4 - 180.0;
+              m_error = std::max (m_error, std::abs (GetValue (vAngle, hAngle) - pattern (vAngle, hAngle)));
+            }
+        }
+    }
+}
+
+double
+AntennaArray3gppPatternTable::GetStep () const
+{
+  return m_step;
+}
+
+double
+AntennaArray3gppPatternTable::GetError () const
+{
+  return m_error;
+}
+
+uint32_t
+AntennaArray3gppPatternTable::GetSize () const
+{
+  return static_cast<uint32_t> (m_values.size ());
+}
+
+} // namespace ns3
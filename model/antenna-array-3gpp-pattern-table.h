@@ -0,0 +1,108 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief The values of a radiation pattern over a grid of angles, to
+ * interpolate them instead of computing the pattern
+ *
+ * The grid covers the vertical angles in [0, 180] and the horizontal angles
+ * in [-180, 180] degrees, with the same step (rounded so that it divides
+ * 180) in both dimensions. GetValue interpolates bilinearly the four values
+ * around the direction, so it returns the exact value on the grid points.
+ *
+ * The error of the interpolation is measured on a grid of a quarter of the
+ * step. When a maximum error is given, the step is halved until that error
+ * is at most the maximum, down to MIN_STEP.
+ */
+class AntennaArray3gppPatternTable
+{
+public:
+  /**
+   * \brief A radiation pattern, as a function of the vertical and the
+   * horizontal angle in degrees
+   */
+  typedef std::function<double (double vAngle, double hAngle)> Pattern;
+
+  /**
+   * \brief Create the table of a radiation pattern
+   * \param pattern the radiation pattern
+   * \param step the step of the grid, in degrees
+   * \param maxError if positive, the maximum error of the interpolation
+   */
+  AntennaArray3gppPatternTable (const Pattern &pattern, double step, double maxError);
+
+  /**
+   * \brief Interpolate the radiation pattern
+   * \param vAngle the vertical angle, in degrees in [0, 180]
+   * \param hAngle the horizontal angle, in degrees in [-180, 180]
+   * \return the interpolated value of the pattern
+   */
+  double GetValue (double vAngle, double hAngle) const
+  {
+    const double x = vAngle / m_step;
+    const double y = (hAngle + 180.0) / m_step;
+    const uint32_t i = x < m_numV ? static_cast<uint32_t> (x) : m_numV - 1;
+    const uint32_t j = y < m_numH ? static_cast<uint32_t> (y) : m_numH - 1;
+    const double fx = x - i;
+    const double fy = y - j;
+    const double *low = &m_values[i * (m_numH + 1) + j];
+    const double *high = low + m_numH + 1;
+    return (1 - fx) * ((1 - fy) * low[0] + fy * low[1]) + fx * ((1 - fy) * high[0] + fy * high[1]);
+  }
+
+  /**
+   * \return the step of the grid, in degrees
+   */
+  double GetStep () const;
+
+  /**
+   * \return the largest error of the interpolation, measured on a grid of
+   * a quarter of the step
+   */
+  double GetError () const;
+
+  /**
+   * \return the number of values in the table
+   */
+  uint32_t GetSize () const;
+
+  static const double MIN_STEP; //!< Smallest step of the grid, in degrees
+
+private:
+  /**
+   * \brief Fill the table with a step, and measure the error of the interpolation
+   * \param pattern the radiation pattern
+   * \param step the step of the grid, in degrees
+   */
+  void Build (const Pattern &pattern, double step);
+
+  double m_step {0.0};           //!< Step of the grid, in degrees
+  uint32_t m_numV {0};           //!< Number of cells of the grid along the vertical angle
+  uint32_t m_numH {0};           //!< Number of cells of the grid along the horizontal angle
+  double m_error {0.0};          //!< Largest error of the interpolation
+  std::vector<double> m_values;  //!< Values of the pattern, for each vertical angle and each horizontal angle
+};
+
+} // namespace ns3
@@ -59,5 +59,45 @@ AntennaArrayBasicModel::GetGainDb (Angles a)
   return 0;
 }
 
+void
+AntennaArrayBasicModel::GetRadiationPatterns (const double *vangles, const double *hangles, uint32_t num,
+                                              double *patterns)
+{
+  for (uint32_t i = 0; i < num; ++i)
+    {
+      patterns[i] = GetRadiationPattern (vangles[i], hangles[i]);
+    }
+}
+
+void
+AntennaArrayBasicModel::GetSteeringVectors (const double *vangles, const double *hangles, uint32_t num,
+                                            uint8_t* antennaNum, complexVector_t *steering)
+{
+  // The components of the unit vector of each direction, computed once
+  // for all the elements
+  std::vector<double> dx (num);
+  std::vector<double> dy (num);
+  std::vector<double> dz (num);
+  for (uint32_t i = 0; i < num; ++i)
+    {
+      dx[i] = sin (vangles[i]) * cos (hangles[i]);
+      dy[i] = sin (vangles[i]) * sin (hangles[i]);
+      dz[i] = cos (vangles[i]);
+    }
+
+  const uint32_t size = antennaNum[0] * antennaNum[1];
+  steering->resize (size * num);
+  for (uint32_t u = 0; u < size; ++u)
+    {
+      Vector loc = GetAntennaLocation (u, antennaNum);
+      std::complex<double> *row = &(*steering)[u * num];
+      for (uint32_t i = 0; i < num; ++i)
+        {
+          double phase = 2 * M_PI * (dx[i] * loc.x + dy[i] * loc.y + dz[i] * loc.z);
+          row[i] = exp (std::complex<double> (0, phase));
+        }
+    }
+}
+
 
 } /* namespace ns3 */
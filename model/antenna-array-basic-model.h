@@ -216,6 +216,33 @@ public:
    */
   virtual double GetRadiationPattern (double vangle, double hangle) = 0;
 
+  /**
+   * Function returns the radiation pattern for a set of directions, as
+   * GetRadiationPattern for each of them. The default implementation calls
+   * GetRadiationPattern; a model can compute them in a single pass.
+   * \param vangles vertical angle of each direction
+   * \param hangles horizontal angle of each direction
+   * \param num number of directions
+   * \param patterns the radiation pattern of each direction (num values)
+   */
+  virtual void GetRadiationPatterns (const double *vangles, const double *hangles, uint32_t num,
+                                     double *patterns);
+
+  /**
+   * Function returns the steering vectors of the antenna array for a set
+   * of directions: the phase term exp (j 2 pi d . loc) of each antenna
+   * element, where d is the unit vector of the direction and loc the
+   * location of the element (GetAntennaLocation, in wavelengths).
+   * \param vangles vertical angle (zenith) of each direction, in radians
+   * \param hangles horizontal angle (azimuth) of each direction, in radians
+   * \param num number of directions
+   * \param antennaNum number of antenna elements in each dimension of the panel
+   * \param steering the steering vectors: the term of element u and
+   * direction i is at the index u * num + i
+   */
+  void GetSteeringVectors (const double *vangles, const double *hangles, uint32_t num,
+                           uint8_t* antennaNum, complexVector_t *steering);
+
   /**
    * Function returns the location of the antenna element inside of the
    * sector assuming the left bottom corner is (0,0,0).
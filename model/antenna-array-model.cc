@@ -178,6 +178,12 @@ AntennaArrayModel::GetCurrentBeamformingVector ()
   return m_currentBeamformingVector;
 }
 
+const AntennaArrayModel::BeamformingStorage &
+AntennaArrayModel::GetBeamformingStorage () const
+{
+  return m_beamformingVectorMap;
+}
+
 void
 AntennaArrayModel::ChangeToOmniTx ()
 {
@@ -81,10 +81,18 @@ public:
 
   enum AntennaArrayModel::AntennaOrientation GetAntennaOrientation () const;
 
+  /**
+   * \brief The beamforming vectors stored for each peer device
+   */
+  typedef std::map<Ptr<NetDevice>, BeamformingVector> BeamformingStorage;
+
+  /**
+   * \return the beamforming vectors stored for each peer device, to save them
+   */
+  const BeamformingStorage & GetBeamformingStorage () const;
 
 private:
 
-  typedef std::map<Ptr<NetDevice>, BeamformingVector> BeamformingStorage;
   bool m_omniTx;
   double m_minAngle;
   double m_maxAngle;
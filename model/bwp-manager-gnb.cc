@@ -65,9 +65,105 @@ BwpManagerGnb::GetTypeId ()
 bool
 BwpManagerGnb::IsGbr (LteMacSapProvider::ReportBufferStatusParameters params)
 {
-  NS_ASSERT_MSG (m_rlcLcInstantiated.find (params.rnti) != m_rlcLcInstantiated.end (), "Trying to check the QoS of unknown UE");
-  NS_ASSERT_MSG (m_rlcLcInstantiated.find (params.rnti)->second.find (params.lcid) != m_rlcLcInstantiated.find (params.rnti)->second.end (), "Trying to check the QoS of unknown logical channel");
-  return m_rlcLcInstantiated.find (params.rnti)->second.find (params.lcid)->second.isGbr;
+  NS_ASSERT_MSG (m_lcTable.HasUe (params.rnti), "Trying to check the QoS of unknown UE");
+  const MmWaveLcDispatchTable::Entry *lc = m_lcTable.Find (params.rnti, params.lcid);
+  NS_ASSERT_MSG (lc != nullptr && lc->m_hasQos, "Trying to check the QoS of unknown logical channel");
+  return lc->m_isGbr;
+}
+
+void
+BwpManagerGnb::RebuildLcTable (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  auto attachedIt = m_ueAttached.find (rnti);
+  auto instantiatedIt = m_rlcLcInstantiated.find (rnti);
+  if (attachedIt == m_ueAttached.end () && instantiatedIt == m_rlcLcInstantiated.end ())
+    {
+      m_lcTable.RemoveUe (rnti);
+      return;
+    }
+
+  m_lcTable.AddUe (rnti);
+  m_lcTable.ReleaseAllLc (rnti);
+  if (attachedIt != m_ueAttached.end ())
+    {
+      for (const auto & lc : attachedIt->second)
+        {
+          m_lcTable.AddLc (rnti, lc.first).m_macSapUser = lc.second;
+        }
+    }
+  if (instantiatedIt != m_rlcLcInstantiated.end ())
+    {
+      for (const auto & lc : instantiatedIt->second)
+        {
+          MmWaveLcDispatchTable::Entry &entry = m_lcTable.AddLc (rnti, lc.first);
+          entry.m_hasQos = true;
+          entry.m_qci = lc.second.qci;
+          entry.m_isGbr = lc.second.isGbr;
+          // Force a conversion between the uint8_t type that comes from the LcInfo
+          // struct (yeah, using the EpsBearer::Qci type was too hard ...)
+          entry.m_bwpIndex = m_algorithm->GetBwpForEpsBearer (static_cast<EpsBearer::Qci> (lc.second.qci));
+        }
+    }
+}
+
+uint8_t
+BwpManagerGnb::GetUlBwpIndex (uint16_t rnti) const
+{
+  // we do not consider first 3 lcids: signaling and default
+  const MmWaveLcDispatchTable::Entry *lc = m_lcTable.FindFirst (rnti, 4);
+  while (lc != nullptr && ! lc->m_hasQos)
+    {
+      lc = m_lcTable.FindFirst (rnti, lc->m_lcid + 1);
+    }
+
+  if (lc != nullptr)
+    {
+      return lc->m_bwpIndex;
+    }
+  return m_algorithm->GetBwpForEpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT);
+}
+
+void
+BwpManagerGnb::DoAddUe (uint16_t rnti, uint8_t state)
+{
+  NS_LOG_FUNCTION (this);
+  RrComponentCarrierManager::DoAddUe (rnti, state);
+  RebuildLcTable (rnti);
+}
+
+void
+BwpManagerGnb::DoAddLc (LteEnbCmacSapProvider::LcInfo lcInfo, LteMacSapUser* msu)
+{
+  NS_LOG_FUNCTION (this);
+  RrComponentCarrierManager::DoAddLc (lcInfo, msu);
+  RebuildLcTable (lcInfo.rnti);
+}
+
+void
+BwpManagerGnb::DoRemoveUe (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this);
+  RrComponentCarrierManager::DoRemoveUe (rnti);
+  RebuildLcTable (rnti);
+}
+
+std::vector<uint8_t>
+BwpManagerGnb::DoReleaseDataRadioBearer (uint16_t rnti, uint8_t lcid)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<uint8_t> res = RrComponentCarrierManager::DoReleaseDataRadioBearer (rnti, lcid);
+  RebuildLcTable (rnti);
+  return res;
+}
+
+LteMacSapUser*
+BwpManagerGnb::DoConfigureSignalBearer (LteEnbCmacSapProvider::LcInfo lcinfo, LteMacSapUser* msu)
+{
+  NS_LOG_FUNCTION (this);
+  LteMacSapUser *ret = RrComponentCarrierManager::DoConfigureSignalBearer (lcinfo, msu);
+  RebuildLcTable (lcinfo.rnti);
+  return ret;
 }
 
 std::vector<LteCcmRrcSapProvider::LcsConfig>
@@ -76,6 +172,7 @@ BwpManagerGnb::DoSetupDataRadioBearer (EpsBearer bearer, uint8_t bearerId, uint1
   NS_LOG_FUNCTION (this);
 
   std::vector<LteCcmRrcSapProvider::LcsConfig> lcsConfig = RrComponentCarrierManager::DoSetupDataRadioBearer (bearer, bearerId, rnti, lcid, lcGroup, msu);
+  RebuildLcTable (rnti);
   return lcsConfig;
 }
 
@@ -84,14 +181,11 @@ void
 BwpManagerGnb::DoReportBufferStatus (LteMacSapProvider::ReportBufferStatusParameters params)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT_MSG (m_rlcLcInstantiated.find (params.rnti) != m_rlcLcInstantiated.end (), "Unknown UE");
-  NS_ASSERT_MSG (m_rlcLcInstantiated.find (params.rnti)->second.find (params.lcid) != m_rlcLcInstantiated.find (params.rnti)->second.end (), "Unknown logical channel of UE");
-
-  uint8_t qci = m_rlcLcInstantiated.find (params.rnti)->second.find (params.lcid)->second.qci;
+  NS_ASSERT_MSG (m_lcTable.HasUe (params.rnti), "Unknown UE");
+  const MmWaveLcDispatchTable::Entry *lc = m_lcTable.Find (params.rnti, params.lcid);
+  NS_ASSERT_MSG (lc != nullptr && lc->m_hasQos, "Unknown logical channel of UE");
 
-  // Force a conversion between the uint8_t type that comes from the LcInfo
-  // struct (yeah, using the EpsBearer::Qci type was too hard ...)
-  uint8_t bwpIndex = m_algorithm->GetBwpForEpsBearer (static_cast<EpsBearer::Qci> (qci));
+  uint8_t bwpIndex = lc->m_bwpIndex;
 
   if (m_macSapProvidersMap.find (bwpIndex) != m_macSapProvidersMap.end ())
     {
@@ -108,13 +202,12 @@ void
 BwpManagerGnb::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpParams)
 {
   NS_LOG_FUNCTION (this);
-  std::map <uint16_t, std::map<uint8_t, LteMacSapUser*> >::iterator rntiIt = m_ueAttached.find (txOpParams.rnti);
-  NS_ASSERT_MSG (rntiIt != m_ueAttached.end (), "could not find RNTI" << txOpParams.rnti);
+  NS_ASSERT_MSG (m_lcTable.HasUe (txOpParams.rnti), "could not find RNTI" << txOpParams.rnti);
 
-  std::map<uint8_t, LteMacSapUser*>::iterator lcidIt = rntiIt->second.find (txOpParams.lcid);
-  NS_ASSERT_MSG (lcidIt != rntiIt->second.end (), "could not find LCID " << (uint16_t) txOpParams.lcid);
+  const MmWaveLcDispatchTable::Entry *lc = m_lcTable.Find (txOpParams.rnti, txOpParams.lcid);
+  NS_ASSERT_MSG (lc != nullptr && lc->m_macSapUser != nullptr, "could not find LCID " << (uint16_t) txOpParams.lcid);
 
-  (*lcidIt).second->NotifyTxOpportunity (txOpParams);
+  lc->m_macSapUser->NotifyTxOpportunity (txOpParams);
 }
 
 
@@ -126,22 +219,7 @@ BwpManagerGnb::DoUlReceiveMacCe (MacCeListElement_s bsr, uint8_t componentCarrie
 
   NS_ASSERT_MSG (m_ccmMacSapProviderMap.find (componentCarrierId) != m_ccmMacSapProviderMap.end (), "Mac sap provider does not exist.");
 
-  uint8_t qci = 9;
-
-  if (m_rlcLcInstantiated.find (bsr.m_rnti) != m_rlcLcInstantiated.end ())
-    {
-      for (auto i: m_rlcLcInstantiated.find (bsr.m_rnti)->second)
-        {
-          // we do not consider first 3 lcids: signaling and default
-          if (i.first > 3)
-            {
-              qci = i.second.qci;
-              break;
-            }
-        }
-    }
-
-  uint8_t bwpIndex = m_algorithm->GetBwpForEpsBearer (static_cast<EpsBearer::Qci> (qci));
+  uint8_t bwpIndex = GetUlBwpIndex (bsr.m_rnti);
 
   NS_LOG_DEBUG ("Routing BSR for UE " << bsr.m_rnti << " to CC id " <<
                 static_cast<uint32_t> (bwpIndex));
@@ -161,22 +239,7 @@ BwpManagerGnb::DoUlReceiveSr(uint16_t rnti, uint8_t componentCarrierId)
 {
   NS_LOG_FUNCTION (this);
   NS_UNUSED (componentCarrierId);
-  uint8_t qci = 9;
-
-  if (m_rlcLcInstantiated.find (rnti) != m_rlcLcInstantiated.end ())
-    {
-      for (auto i: m_rlcLcInstantiated.find (rnti)->second)
-        {
-          // we do not consider first 3 lcids: signaling and default
-          if (i.first > 3)
-            {
-              qci = i.second.qci;
-              break;
-            }
-        }
-    }
-
-  uint8_t bwpIndex = m_algorithm->GetBwpForEpsBearer (static_cast<EpsBearer::Qci> (qci));
+  uint8_t bwpIndex = GetUlBwpIndex (rnti);
 
   NS_LOG_DEBUG ("Routing SR for UE " << rnti << " to CC id " <<
                 static_cast<uint32_t> (bwpIndex));
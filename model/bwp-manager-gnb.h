@@ -27,6 +27,7 @@
 #include <ns3/lte-rrc-sap.h>
 #include <ns3/lte-rlc.h>
 #include <ns3/eps-bearer.h>
+#include "mmwave-lc-dispatch-table.h"
 #include <unordered_map>
 
 namespace ns3 {
@@ -80,13 +81,37 @@ protected:
    */
   virtual std::vector<LteCcmRrcSapProvider::LcsConfig> DoSetupDataRadioBearer (EpsBearer bearer, uint8_t bearerId, uint16_t rnti, uint8_t lcid, uint8_t lcGroup, LteMacSapUser* msu) override;
 
+  // The following methods update the dispatch table after the parent class
+  // has updated its maps
+  virtual void DoAddUe (uint16_t rnti, uint8_t state) override;
+  virtual void DoAddLc (LteEnbCmacSapProvider::LcInfo lcInfo, LteMacSapUser* msu) override;
+  virtual void DoRemoveUe (uint16_t rnti) override;
+  virtual std::vector<uint8_t> DoReleaseDataRadioBearer (uint16_t rnti, uint8_t lcid) override;
+  virtual LteMacSapUser* DoConfigureSignalBearer (LteEnbCmacSapProvider::LcInfo lcinfo, LteMacSapUser* msu) override;
+
 private:
   /*
    * \brief Checks if the flow is is GBR.
    */
   bool IsGbr (LteMacSapProvider::ReportBufferStatusParameters params);
 
+  /**
+   * \brief Rebuild the row of a UE in the dispatch table from the maps of the
+   * parent class (m_ueAttached and m_rlcLcInstantiated)
+   * \param rnti RNTI of the UE
+   */
+  void RebuildLcTable (uint16_t rnti);
+
+  /**
+   * \brief Get the BWP for the uplink of a UE: the one of the first LC that is
+   * not signaling or default (LCID > 3), or the one of QCI 9 if there is none
+   * \param rnti RNTI of the UE
+   * \return the BWP index
+   */
+  uint8_t GetUlBwpIndex (uint16_t rnti) const;
+
   BwpManagerAlgorithm *m_algorithm; //!< The BWP selection algorithm.
+  MmWaveLcDispatchTable m_lcTable;  //!< SAP user, QCI and BWP of the LCs of each UE
 };
 
 } // end of namespace ns3
@@ -31,10 +31,8 @@
 #include <ns3/building-list.h>
 #include <ns3/angles.h>
 #include "ns3/config-store.h"
-#include <ns3/mmwave-ue-net-device.h>
-#include <ns3/mmwave-enb-net-device.h>
-#include <ns3/node.h>
 #include "ns3/boolean.h"
+#include "ns3/nstime.h"
 
 NS_LOG_COMPONENT_DEFINE ("MmWave3gppBuildingsPropagationLossModel");
 
@@ -90,6 +88,15 @@ MmWave3gppBuildingsPropagationLossModel::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&MmWave3gppBuildingsPropagationLossModel::m_updateCondition),
                    MakeBooleanChecker ())
+    .AddAttribute ("LinkIdleHorizon",
+                   "The channel condition and the indoor loss of a link not used for longer "
+                   "than this time are removed, and drawn again if the link is used later. "
+                   "0 means that they are never removed. The same horizon is used by the "
+                   "LOS and NLOS 3GPP models.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MmWave3gppBuildingsPropagationLossModel::SetLinkIdleHorizon,
+                                     &MmWave3gppBuildingsPropagationLossModel::GetLinkIdleHorizon),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -104,6 +111,20 @@ MmWave3gppBuildingsPropagationLossModel::SetFrequency (double freq)
   m_lambda = C / freq;
 }
 
+void
+MmWave3gppBuildingsPropagationLossModel::SetLinkIdleHorizon (Time horizon)
+{
+  m_linkTable.SetIdleHorizon (horizon);
+  m_3gppLos->SetLinkIdleHorizon (horizon);
+  m_3gppNlos->SetLinkIdleHorizon (horizon);
+}
+
+Time
+MmWave3gppBuildingsPropagationLossModel::GetLinkIdleHorizon () const
+{
+  return m_linkTable.GetIdleHorizon ();
+}
+
 double
 MmWave3gppBuildingsPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
 {
@@ -121,14 +142,23 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
   Ptr<MobilityBuildingInfo> b1 = b->GetObject<MobilityBuildingInfo> ();
   NS_ASSERT_MSG ((a1 != 0) && (b1 != 0), "MmWave3gppBuildingsPropagationLossModel only works with MobilityBuildingInfo");
 
+  MmWave3gppLinkTable::Link link = m_linkTable.GetLink (a, b);
+  if (link.m_state == nullptr)
+    {
+      NS_LOG_INFO ((link.m_ue->m_role == MmWave3gppLinkTable::UE ? "UE->UE" : "ENB->ENB")
+                   << " Link, skip Pathloss computation");
+      return 0;
+    }
+  MmWave3gppLinkTable::LinkState &state = *link.m_state;
+
   double loss = 0.0;
-  channelConditionMap_t::const_iterator it;
-  it = m_conditionMap.find (std::make_pair (a,b));
-  //it == m_conditionMap.end () check whether it is the first transmission, if yes determine the channel condition
-  //m_updateCondition refresh conditionMap very transmission.
-  if (it == m_conditionMap.end () || m_updateCondition)
+  //!state.m_valid check whether it is the first transmission, if yes determine the channel condition
+  //m_updateCondition refresh the condition every time one of the nodes moves.
+  if (! state.m_valid
+      || (m_updateCondition && (state.m_conditionUeEpoch != link.m_ue->m_epoch
+                                || state.m_conditionGnbEpoch != link.m_gnb->m_epoch)))
     {
-      channelCondition condition;
+      MmWave3gppLinkTable::LinkState condition;
       /* The IsOutdoor and IsIndoor function is only based on the initial node position,
        * it is not updated when the node is entering the building from outside or vise versa.*/
       if (a1->IsOutdoor () && b1->IsOutdoor ())
@@ -139,12 +169,12 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
           bool intersect = IsLineIntersectBuildings (a->GetPosition (), b->GetPosition ());
           if (!intersect)
             {
-              condition.m_channelCondition = 'l';
+              condition.m_condition = 'l';
               condition.m_shadowing = 0;
             }
           else
             {
-              condition.m_channelCondition = 'n';
+              condition.m_condition = 'n';
               condition.m_shadowing = 0;
             }
 
@@ -157,9 +187,9 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
         {
           //PL = PL_b + PL_tw + PL_in + N(0,sig^2); (7.4-2)
           //Here we assume the indoor nodes are all NLOS O2I.
-          condition.m_channelCondition = 'i';
+          condition.m_condition = 'i';
           //Compute the addition indoor pathloss term when this is the first transmission, or the node moves from outdoor to indoor.
-          if (it == m_conditionMap.end () || (*it).second.m_channelCondition != 'i')
+          if (! state.m_valid || state.m_condition != 'i')
             {
               double lossIndoor = 0;
               double PL_tw;
@@ -233,47 +263,39 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
             }
           else
             {
-              condition.m_shadowing = (*it).second.m_shadowing;
+              condition.m_shadowing = state.m_shadowing;
             }
         }
 
 
-      if (it == m_conditionMap.end ())
+      if (! state.m_valid || state.m_condition != condition.m_condition)
         {
-          //First transmission. Generate the channel condition and insert to the map
-          m_conditionMap.insert (std::make_pair (std::make_pair (a,b), condition));
-          m_conditionMap.insert (std::make_pair (std::make_pair (b,a), condition));
-          it = m_conditionMap.find (std::make_pair (a,b));
+          //First transmission, or m_updateCondition enabled and the channel condition changed.
+          state.m_condition = condition.m_condition;
+          state.m_shadowing = condition.m_shadowing;
+          state.m_valid = true;
         }
-      else if ((*it).second.m_channelCondition != condition.m_channelCondition)
-        {
-          //m_updateCondition enabled and the channel condition changed. Update the conditionMap.
-          m_conditionMap.erase (std::make_pair (a,b));
-          m_conditionMap.erase (std::make_pair (b,a));
-          m_conditionMap.insert (std::make_pair (std::make_pair (a,b), condition));
-          m_conditionMap.insert (std::make_pair (std::make_pair (b,a), condition));
-          it = m_conditionMap.find (std::make_pair (a,b));
-        }
-
+      state.m_conditionUeEpoch = link.m_ue->m_epoch;
+      state.m_conditionGnbEpoch = link.m_gnb->m_epoch;
     }
 
-  if ((*it).second.m_channelCondition == 'l')
+  if (state.m_condition == 'l')
     {
       //LoS channel condition
       loss = m_3gppLos->GetLoss (a,b);
 
     }
-  else if ((*it).second.m_channelCondition == 'n')
+  else if (state.m_condition == 'n')
     {
       //NLoS channel condition
       loss = m_3gppNlos->GetLoss (a,b);
 
     }
-  else if ((*it).second.m_channelCondition == 'i')
+  else if (state.m_condition == 'i')
     {
       //for simplicity, the pathloss formulat still use d_2D instead of d_2D_out.
       //All the indoor pathloss terms are stored in the m_shadowing.
-      loss =  m_3gppNlos->GetLoss (a,b) + (*it).second.m_shadowing;
+      loss =  m_3gppNlos->GetLoss (a,b) + state.m_shadowing;
     }
   else
     {
@@ -287,27 +309,10 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
 
   if (Now ().GetSeconds () - m_prevTime.GetSeconds () < 0.00009)
     {
-      Vector ueLoc, enbLoc;
-      if (DynamicCast<MmWaveUeNetDevice> (a->GetObject<Node> ()->GetDevice (0)) != 0)
-        {
-          /*if(DynamicCast<MmWaveEnbNetDevice> (b->GetObject<Node> ()->GetDevice (0)) !=0)
-          {
-                  NS_LOG_INFO("UE->ENB Link");
-                  ueLoc = a->GetPosition();
-                  enbLoc = b->GetPosition();
-                  LocationTrace(enbLoc, ueLoc, (*it).second.m_channelCondition == 'l');
-
-          }*/
-        }
-      else
+      if (link.m_gnb->m_mobility == a)
         {
-          if (DynamicCast<MmWaveUeNetDevice> (b->GetObject<Node> ()->GetDevice (0)) != 0)
-            {
-              NS_LOG_INFO ("ENB->UE Link");
-              enbLoc = a->GetPosition ();
-              ueLoc = b->GetPosition ();
-              LocationTrace (enbLoc, ueLoc, (*it).second.m_channelCondition == 'l');
-            }
+          NS_LOG_INFO ("ENB->UE Link");
+          LocationTrace (link.m_gnb->m_position, link.m_ue->m_position, state.m_condition == 'l');
         }
 
     }
@@ -418,15 +423,20 @@ MmWave3gppBuildingsPropagationLossModel::GetScenario ()
 char
 MmWave3gppBuildingsPropagationLossModel::GetChannelCondition (Ptr<MobilityModel> a, Ptr<MobilityModel> b)
 {
-  channelConditionMap_t::const_iterator it;
-  it = m_conditionMap.find (std::make_pair (a,b));
-  if (it == m_conditionMap.end ())
+  const MmWave3gppLinkTable::LinkState *state = m_linkTable.FindLink (a, b);
+  if (state == nullptr)
     {
       NS_FATAL_ERROR ("Cannot find the link in the map");
     }
-  return (*it).second.m_channelCondition;
+  return state->m_condition;
 
 }
 
+std::vector<MmWave3gppLinkTable *>
+MmWave3gppBuildingsPropagationLossModel::GetLinkTables ()
+{
+  return {&m_linkTable, &m_3gppLos->GetLinkTable (), &m_3gppNlos->GetLinkTable ()};
+}
+
 
 } // namespace ns3
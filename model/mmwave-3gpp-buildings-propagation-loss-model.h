@@ -44,8 +44,23 @@ public:
   // inherited from PropagationLossModel
   virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
   void SetFrequency (double freq);
+  /**
+   * \param horizon the channel condition and the indoor loss of a link not
+   * used for longer are removed (0 to never remove them)
+   */
+  void SetLinkIdleHorizon (Time horizon);
+  /**
+   * \returns the idle horizon of the links
+   */
+  Time GetLinkIdleHorizon () const;
   std::string GetScenario ();
   char GetChannelCondition (Ptr<MobilityModel> a, Ptr<MobilityModel> b);
+  /**
+   * \return the tables of the links, to save and restore their state: the
+   * one of this model (condition and indoor loss), and the ones of the LOS
+   * and NLOS models (shadowing)
+   */
+  std::vector<MmWave3gppLinkTable *> GetLinkTables ();
 
 private:
   //The IsLineIntersectBuildings method is based on
@@ -61,7 +76,7 @@ private:
   static std::ofstream m_enbUeLocTrace;
   Ptr<MmWave3gppPropagationLossModel> m_3gppLos;
   Ptr<MmWave3gppPropagationLossModel> m_3gppNlos;
-  mutable channelConditionMap_t m_conditionMap;
+  mutable MmWave3gppLinkTable m_linkTable; //!< Role, distances, condition and indoor loss of the links
   bool m_updateCondition;
   mutable Time m_prevTime;
 };
@@ -36,9 +36,12 @@
 #include <ns3/mmwave-enb-phy.h>
 #include <ns3/double.h>
 #include <algorithm>
+#include <tuple>
 #include <random>       // std::default_random_engine
 #include <ns3/boolean.h>
 #include <ns3/integer.h>
+#include <ns3/uinteger.h>
+#include <ns3/trace-source-accessor.h>
 #include "antenna-array-3gpp-model.h"
 #include "mmwave-spectrum-value-helper.h"
 
@@ -54,110 +57,6 @@ static const double offSetAlpha[20] = {
   0.0447,-0.0447,0.1413,-0.1413,0.2492,-0.2492,0.3715,-0.3715,0.5129,-0.5129,0.6797,-0.6797,0.8844,-0.8844,1.1481,-1.1481,1.5195,-1.5195,2.1551,-2.1551
 };
 
-/*
- * The cross correlation matrix is constructed according to table 7.5-6.
- * All the square root matrix is being generated using the Cholesky decomposition
- * and following the order of [SF,K,DS,ASD,ASA,ZSD,ZSA].
- * The parameter K is ignored in NLOS.
- *
- * The Matlab file to generate the matrices can be found in the mmwave/model/BeamFormingMatrix/SqrtMatrix.m
- * */
-static const double sqrtC_RMa_LOS[7][7] = {
-  {1, 0, 0, 0, 0, 0, 0},
-  {0, 1, 0, 0, 0, 0, 0},
-  {-0.5, 0, 0.866025, 0, 0, 0, 0},
-  {0, 0, 0, 1, 0, 0, 0},
-  {0, 0, 0, 0, 1, 0, 0},
-  {0, 0, 0, 0.5, -0, 0.866025, 0},
-  {-0.8, 0, -0.46188, 0, 0, 0, 0.382971},
-};
-
-static const double sqrtC_RMa_NLOS[6][6] = {
-  {1, 0, 0, 0, 0, 0},
-  {-0.5, 0.866025, 0, 0, 0, 0},
-  {0.6, -0.11547, 0.791623, 0, 0, 0},
-  {0, 0, 0, 1, 0, 0},
-  {0, -0.57735, 0.547399, 0, 0.605823, 0},
-  {-0.4, -0.23094, 0.143166, 0, -0.349446, 0.802532},
-};
-
-static const double sqrtC_UMa_LOS[7][7] = {
-  {1, 0, 0, 0, 0, 0, 0},
-  {0, 1, 0, 0, 0, 0, 0},
-  {-0.4, -0.4, 0.824621, 0, 0, 0, 0},
-  {-0.5, 0, 0.242536, 0.83137, 0, 0, 0},
-  {-0.5, -0.2, 0.630593, -0.484671, 0.278293, 0, 0},
-  {0, 0, -0.242536, 0.672172, 0.642214, 0.27735, 0},
-  {-0.8, 0, -0.388057, -0.367926, 0.238537, -3.58949e-15, 0.130931},
-};
-
-
-static const double sqrtC_UMa_NLOS[6][6] = {
-  {1, 0, 0, 0, 0, 0},
-  {-0.4, 0.916515, 0, 0, 0, 0},
-  {-0.6, 0.174574, 0.78072, 0, 0, 0},
-  {0, 0.654654, 0.365963, 0.661438, 0, 0},
-  {0, -0.545545, 0.762422, 0.118114, 0.327327, 0},
-  {-0.4, -0.174574, -0.396459, 0.392138, 0.49099, 0.507445},
-};
-
-static const double sqrtC_UMa_O2I[6][6] = {
-  {1, 0, 0, 0, 0, 0},
-  {-0.5, 0.866025, 0, 0, 0, 0},
-  {0, 0.46188, 0.886942, 0, 0, 0},
-  {0.53, 0.305996, -0.159349, 0.774645, 0, 0},
-  {0, 0, 0, 0, 1, 0},
-  {0.4, -0.381051, 0.671972, 0.0150753, -0, 0.492978},
-
-};
-
-static const double sqrtC_UMi_LOS[7][7] = {
-  {1, 0, 0, 0, 0, 0, 0},
-  {0.5, 0.866025, 0, 0, 0, 0, 0},
-  {-0.4, -0.57735, 0.711805, 0, 0, 0, 0},
-  {-0.5, 0.057735, 0.468293, 0.726201, 0, 0, 0},
-  {-0.4, -0.11547, 0.805464, -0.23482, 0.350363, 0, 0},
-  {0, 0, 0, 0.688514, 0.461454, 0.559471, 0},
-  {0, 0, 0.280976, 0.231921, -0.490509, 0.11916, 0.782603},
-};
-
-static const double sqrtC_UMi_NLOS[6][6] = {
-  {1, 0, 0, 0, 0, 0},
-  {-0.7, 0.714143, 0, 0, 0, 0},
-  {0, 0, 1, 0, 0, 0},
-  {-0.4, 0.168034, 0, 0.90098, 0, 0},
-  {0, -0.70014, 0.5, 0.130577, 0.4927, 0},
-  {0, 0, 0.5, 0.221981, -0.566238, 0.616522},
-};
-
-static const double sqrtC_UMi_O2I[6][6] = {
-  {1, 0, 0, 0, 0, 0},
-  {-0.5, 0.866025, 0, 0, 0, 0},
-  {0, 0.46188, 0.886942, 0, 0, 0},
-  {0.53, 0.305996, -0.159349, 0.774645, 0, 0},
-  {0, 0, 0, 0, 1, 0},
-  {0.4, -0.381051, 0.671972, 0.0150753, -0, 0.492978},
-};
-
-static const double sqrtC_office_LOS[7][7] = {
-  {1, 0, 0, 0, 0, 0, 0},
-  {0.5, 0.866025, 0, 0, 0, 0, 0},
-  {-0.8, -0.11547, 0.588784, 0, 0, 0, 0},
-  {-0.4, 0.23094, 0.520847, 0.717903, 0, 0, 0},
-  {-0.5, 0.288675, 0.73598, -0.348236, 0.0610847, 0, 0},
-  {0.2, -0.11547, 0.418943, 0.123222, -0.525329, 0.69282, 0},
-  {-0.1, 0.173205, 0.237778, -0.00535748, 0.378725, 0.490748, 0.720532},
-};
-
-static const double sqrtC_office_NLOS[6][6] = {
-  {1, 0, 0, 0, 0, 0},
-  {-0.5, 0.866025, 0, 0, 0, 0},
-  {0, 0.46188, 0.886942, 0, 0, 0},
-  {-0.4, -0.23094, 0.120263, 0.878751, 0, 0},
-  {0, -0.11547, 0.398372, 0.0289317, 0.909466, 0},
-  {-0.1, -0.173205, 0.315691, -0.134243, 0.283816, 0.872792},
-};
-
 /**
  * \brief This function is used to randomly select antenna orientation from
  * a set of predefined antenna orientations: X0, Z0 and Y0
@@ -245,6 +144,44 @@ MmWave3gppChannel::GetTypeId (void)
                     DoubleValue (0),
                     MakeDoubleAccessor (&MmWave3gppChannel::m_ueSpeed),
                     MakeDoubleChecker<double> ())
+    .AddAttribute ("BulkUpdate",
+                   "If true, and UpdatePeriod is greater than 0, a single event every UpdatePeriod "
+                   "updates the channel of all the links generated at least UpdatePeriod before. "
+                   "If false, each link schedules the deletion of its channel, which is updated "
+                   "at the next transmission on the link.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWave3gppChannel::m_bulkUpdate),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ParamsTableCache",
+                   "If true, the parameters of TR 38.900 Table 7.5-6 of a link are taken from a "
+                   "store shared by all the channels, where they are computed once for each "
+                   "scenario, frequency, condition and, when they depend on them, heights and "
+                   "distance of the nodes (see ParamsTableResolution). If false, they are computed "
+                   "for each channel generation.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MmWave3gppChannel::m_paramsTableCache),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ParamsTableResolution",
+                   "Resolution, in m, of the heights and distance of the parameters of TR 38.900 "
+                   "Table 7.5-6 that depend on them (UMa, UMi-StreetCanyon and RMa NLOS), taken "
+                   "from the store: they are computed with the heights and distance rounded to "
+                   "the nearest multiple. If 0, they are computed for each channel generation, "
+                   "with the exact values, and not stored.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MmWave3gppChannel::m_paramsTableResolution),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("NumWorkers",
+                   "Number of threads, including the simulator one, that compute the long "
+                   "term components of the channels in the bulk update. 1 means that "
+                   "everything runs in the simulator thread.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MmWave3gppChannel::SetNumWorkers,
+                                         &MmWave3gppChannel::GetNumWorkers),
+                   MakeUintegerChecker<uint32_t> (1, 256))
+    .AddTraceSource ("LinksUpdated",
+                     "Number of links whose channel was updated by a bulk update.",
+                     MakeTraceSourceAccessor (&MmWave3gppChannel::m_linksUpdatedTrace),
+                     "ns3::MmWave3gppChannel::LinksUpdatedTracedCallback")
   ;
   return tid;
 }
@@ -262,6 +199,10 @@ MmWave3gppChannel::DoDispose ()
   m_expRv = 0;
   m_normalRv = 0;
   m_normalRvBlockage = 0;
+  m_bulkUpdateEvent.Cancel ();
+  ClearChannels ();
+  m_pendingLongTerm.clear ();
+  m_workers.SetNumWorkers (1);
   SpectrumPropagationLossModel::DoDispose ();
   NS_LOG_FUNCTION (this);
 }
@@ -278,6 +219,74 @@ MmWave3gppChannel::GetConfigurationParameters (void) const
   return m_phyMacConfig;
 }
 
+void
+MmWave3gppChannel::SetNumWorkers (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_workers.SetNumWorkers (n);
+}
+
+uint32_t
+MmWave3gppChannel::GetNumWorkers () const
+{
+  return m_workers.GetNumWorkers ();
+}
+
+
+void
+MmWave3gppChannel::ForEachChannel (const std::function<void (const Ptr<NetDevice> &tx, const Ptr<NetDevice> &rx,
+                                                             const Ptr<const Params3gpp> &params)> &f) const
+{
+  for (const auto & entry : m_channelMap)
+    {
+      f (entry.first.first, entry.first.second, entry.second);
+    }
+}
+
+void
+MmWave3gppChannel::RestoreChannel (Ptr<NetDevice> tx, Ptr<NetDevice> rx, Ptr<Params3gpp> params)
+{
+  NS_LOG_FUNCTION (this << tx << rx);
+  key_t key = std::make_pair (tx, rx);
+  m_channelMap[key] = params;
+
+  // The update of the channel replaced, if any, is the one of the restored channel now
+  auto event = m_deleteChannelEvents.find (key);
+  if (event != m_deleteChannelEvents.end ())
+    {
+      event->second.Cancel ();
+      m_deleteChannelEvents.erase (event);
+    }
+
+  // A channel without matrix is updated at its next use
+  if (params->m_channel.size () == 0 || m_updatePeriod.GetMilliSeconds () <= 0)
+    {
+      return;
+    }
+  if (m_bulkUpdate)
+    {
+      ScheduleBulkUpdate ();
+    }
+  else
+    {
+      Time delay = Max (params->m_generatedTime + m_updatePeriod - Simulator::Now (), Seconds (0));
+      Ptr<const MobilityModel> a = tx->GetNode ()->GetObject<MobilityModel> ();
+      Ptr<const MobilityModel> b = rx->GetNode ()->GetObject<MobilityModel> ();
+      ScheduleDeleteChannel (key, delay, a, b);
+    }
+}
+
+void
+MmWave3gppChannel::ClearChannels ()
+{
+  NS_LOG_FUNCTION (this);
+  for (auto & event : m_deleteChannelEvents)
+    {
+      event.second.Cancel ();
+    }
+  m_deleteChannelEvents.clear ();
+  m_channelMap.clear ();
+}
 
 void
 MmWave3gppChannel::ConnectDevices (Ptr<NetDevice> dev1, Ptr<NetDevice> dev2)
@@ -353,11 +362,7 @@ MmWave3gppChannel::Initial (NetDeviceContainer ueDevices, NetDeviceContainer enb
             }
 
 
-          std::vector<int> listOfSubchannels;
-          for (unsigned i = 0; i < m_phyMacConfig->GetBandwidthInRbs (); i++)
-            {
-              listOfSubchannels.push_back (i);
-            }
+          RbgBitmask listOfSubchannels (m_phyMacConfig->GetBandwidthInRbs (), true);
           Ptr<const SpectrumValue> fakePsd =
             MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, 0, listOfSubchannels);
           DoCalcRxPowerSpectralDensity (fakePsd, a, b);
@@ -375,6 +380,36 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
   NS_LOG_FUNCTION (this);
   Ptr<SpectrumValue> rxPsd = Copy (txPsd);
 
+  BeamformingGainJob job = PrepareBeamformingGain (rxPsd, a, b);
+  if (job.m_params == nullptr)
+    {
+      return rxPsd;
+    }
+
+  Ptr<SpectrumValue> bfPsd = Copy (rxPsd);
+  ApplyBeamformingGain (job, PeekPointer (bfPsd));
+
+  SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
+  uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
+  if (job.m_reverseLink == false)
+    {
+      NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain) / nbands << " RX PSD " << Sum (*rxPsd) / nbands); // print avg bf gain
+    }
+  else
+    {
+      NS_LOG_DEBUG ("****** UL BF gain == " << Sum (bfGain) / nbands << " RX PSD " << Sum (*rxPsd) / nbands);
+    }
+  return bfPsd;
+}
+
+MmWave3gppChannel::BeamformingGainJob
+MmWave3gppChannel::PrepareBeamformingGain (Ptr<const SpectrumValue> psd,
+                                           Ptr<const MobilityModel> a,
+                                           Ptr<const MobilityModel> b) const
+{
+  NS_LOG_FUNCTION (this);
+  BeamformingGainJob job;
+
   uint8_t ccId = m_phyMacConfig->GetCcId ();
 
   Ptr<NetDevice> txDevice = a->GetObject<Node> ()->GetDevice (0);
@@ -430,13 +465,13 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
   else
     {
       NS_LOG_INFO ("enb to enb or ue to ue transmission, skip beamforming a tx " << a->GetPosition () << " b rx " << b->GetPosition ());
-      return rxPsd;
+      return job;
     }
 
   if (txAntennaArray->IsOmniTx () || rxAntennaArray->IsOmniTx () )
     {
       //omi transmission, do nothing.
-      return rxPsd;
+      return job;
     }
 
   /*txAntennaNum[0] = 1;
@@ -544,7 +579,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
           hBS = b->GetPosition ().z;
         }
       //Draw parameters from table 7.5-6 and 7.5-7 to 7.5-10.
-      Ptr<ParamsTable> table3gpp = Get3gppTable (los, o2i, hBS, hUT, distance2D);
+      ParamsTable table3gpp = Get3gppTable (los, o2i, hBS, hUT, distance2D);
 
       // Step 4-11 are performed in function GetNewChannel()
       if ((it == m_channelMap.end () && itReverse == m_channelMap.end ())
@@ -552,10 +587,14 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
         {
           //delete the channel parameter to cause the channel to be updated again.
           //The m_updatePeriod can be configured to be relatively large in order to disable updates.
-          if (m_updatePeriod.GetMilliSeconds () > 0)
+          if (m_updatePeriod.GetMilliSeconds () > 0 && m_bulkUpdate)
+            {
+              ScheduleBulkUpdate ();
+            }
+          else if (m_updatePeriod.GetMilliSeconds () > 0)
             {
               NS_LOG_INFO ("Time " << Simulator::Now ().GetSeconds () << " schedule delete for a " << a->GetPosition () << " b " << b->GetPosition ());
-              Simulator::Schedule (m_updatePeriod, &MmWave3gppChannel::DeleteChannel,this,a,b);
+              ScheduleDeleteChannel (key, m_updatePeriod, a, b);
             }
         }
 
@@ -590,7 +629,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
           if (m_cellScan)
             {
               NS_LOG_ERROR ("beam search method ...");
-              BeamSearchBeamforming (rxPsd, channelParams,txAntennaArray,rxAntennaArray, txAntennaNum, rxAntennaNum);
+              BeamSearchBeamforming (psd, channelParams,txAntennaArray,rxAntennaArray, txAntennaNum, rxAntennaNum);
             }
           else
             {
@@ -617,11 +656,18 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
               NS_LOG_INFO ("channelParams->m_txW.size() == 0 " << (channelParams->m_txW.size () == 0));
               NS_LOG_INFO ("channelParams->m_rxW.size() == 0 " << (channelParams->m_rxW.size () == 0));
               m_channelMap[key] = channelParams;
-              return rxPsd;
+              return job;
             }
         }
 
-      CalLongTerm (channelParams);
+      if (m_deferLongTerm)
+        {
+          m_pendingLongTerm.push_back (PeekPointer (channelParams));
+        }
+      else
+        {
+          CalLongTerm (PeekPointer (channelParams));
+        }
       m_channelMap[key] = channelParams;
     }
   else if (itReverse == m_channelMap.end ()) //Find channel matrix in the forward link
@@ -634,19 +680,11 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
       channelParams = (*itReverse).second;
     }
 
-  Ptr<SpectrumValue> bfPsd = CalBeamformingGain (rxPsd, channelParams, relativeSpeed);
-
-  SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
-  uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-  if (reverseLink == false)
-    {
-      NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain) / nbands << " RX PSD " << Sum (*rxPsd) / nbands); // print avg bf gain
-    }
-  else
-    {
-      NS_LOG_DEBUG ("****** UL BF gain == " << Sum (bfGain) / nbands << " RX PSD " << Sum (*rxPsd) / nbands);
-    }
-  return bfPsd;
+  job.m_params = channelParams;
+  job.m_speed = relativeSpeed;
+  job.m_time = Simulator::Now ().GetSeconds ();
+  job.m_reverseLink = reverseLink;
+  return job;
 }
 
 void
@@ -809,6 +847,22 @@ MmWave3gppChannel::CalBeamformingGain (Ptr<const SpectrumValue> txPsd, Ptr<Param
 
   Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue> (txPsd);
 
+  BeamformingGainJob job;
+  job.m_params = params;
+  job.m_speed = speed;
+  job.m_time = Simulator::Now ().GetSeconds ();
+  ApplyBeamformingGain (job, PeekPointer (tempPsd));
+  return tempPsd;
+}
+
+void
+MmWave3gppChannel::ApplyBeamformingGain (const BeamformingGainJob &job, SpectrumValue *psd) const
+{
+  // No logging and no Ptr copies here: this function may run in a worker
+  // thread, and the reference counts are not thread-safe
+  const Params3gpp &params = *job.m_params;
+  const Vector &speed = job.m_speed;
+
   //NS_ASSERT_MSG (params->m_delay.size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and delay spread should be the same");
   //NS_ASSERT_MSG (params->m_txW.size()==params->m_channel.at(0).size(), "the tx antenna size of channel and antenna weights should be the same");
   //NS_ASSERT_MSG (params->m_rxW.size()==params->m_channel.size(), "the rx antenna size of channel and antenna weights should be the same");
@@ -816,25 +870,23 @@ MmWave3gppChannel::CalBeamformingGain (Ptr<const SpectrumValue> txPsd, Ptr<Param
   //NS_ASSERT_MSG (params->m_angle.at(1).size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and ZOA should be the same");
 
   //channel[rx][tx][cluster]
-  uint8_t numCluster = params->m_delay.size ();
-  //uint8_t txAntenna = params->m_txW.size();
-  //uint8_t rxAntenna = params->m_rxW.size();
+  uint8_t numCluster = params.m_delay.size ();
   //the update of Doppler is simplified by only taking the center angle of each cluster in to consideration.
-  Values::iterator vit = tempPsd->ValuesBegin ();
+  Values::iterator vit = psd->ValuesBegin ();
   uint16_t iSubband = 0;
-  double varTtiTime = Simulator::Now ().GetSeconds ();
+  double varTtiTime = job.m_time;
   complexVector_t doppler;
   for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
       //cluster angle angle[direction][n],where, direction = 0(aoa), 1(zoa).
-      double temp_doppler = 2 * M_PI * (sin (params->m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * cos (params->m_angle.at (AOA_INDEX).at (cIndex) * M_PI / 180) * speed.x
-                                        + sin (params->m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * sin (params->m_angle.at (AOA_INDEX).at (cIndex) * M_PI / 180) * speed.y
-                                        + cos (params->m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * speed.z) * varTtiTime * m_phyMacConfig->GetCenterFrequency () / 3e8;
+      double temp_doppler = 2 * M_PI * (sin (params.m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * cos (params.m_angle.at (AOA_INDEX).at (cIndex) * M_PI / 180) * speed.x
+                                        + sin (params.m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * sin (params.m_angle.at (AOA_INDEX).at (cIndex) * M_PI / 180) * speed.y
+                                        + cos (params.m_angle.at (ZOA_INDEX).at (cIndex) * M_PI / 180) * speed.z) * varTtiTime * m_phyMacConfig->GetCenterFrequency () / 3e8;
       doppler.push_back (exp (std::complex<double> (0, temp_doppler)));
 
     }
 
-  while (vit != tempPsd->ValuesEnd ())
+  while (vit != psd->ValuesEnd ())
     {
       std::complex<double> subsbandGain (0.0,0.0);
       if ((*vit) != 0.00)
@@ -842,16 +894,14 @@ MmWave3gppChannel::CalBeamformingGain (Ptr<const SpectrumValue> txPsd, Ptr<Param
           double fsb = m_phyMacConfig->GetCenterFrequency () - m_phyMacConfig->GetBandwidth () / 2 + m_phyMacConfig->GetSubcarrierSpacing () * m_phyMacConfig->GetNumScsPerRb () * iSubband;
           for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
             {
-              double delay = -2 * M_PI * fsb * (params->m_delay.at (cIndex));
-              std::complex<double> txSum (0,0);
-              subsbandGain = subsbandGain + params->m_longTerm.at (cIndex) * doppler.at (cIndex) * exp (std::complex<double> (0, delay));
+              double delay = -2 * M_PI * fsb * (params.m_delay.at (cIndex));
+              subsbandGain = subsbandGain + params.m_longTerm.at (cIndex) * doppler.at (cIndex) * exp (std::complex<double> (0, delay));
             }
           *vit = (*vit) * (norm (subsbandGain));
         }
       vit++;
       iSubband++;
     }
-  return tempPsd;
 }
 
 void
@@ -874,7 +924,7 @@ MmWave3gppChannel::SetPathlossModel (Ptr<PropagationLossModel> pathloss)
 
 
 void
-MmWave3gppChannel::CalLongTerm (Ptr<Params3gpp> params) const
+MmWave3gppChannel::CalLongTerm (Params3gpp *params) const
 {
   uint8_t txAntenna = params->m_txW.size ();
   uint8_t rxAntenna = params->m_rxW.size ();
@@ -902,216 +952,192 @@ MmWave3gppChannel::CalLongTerm (Ptr<Params3gpp> params) const
 
 }
 
-Ptr<ParamsTable>
+ParamsTable
 MmWave3gppChannel::Get3gppTable (bool los, bool o2i, double hBS, double hUT, double distance2D) const
 {
   double fcGHz = m_phyMacConfig->GetCenterFrequency () / 1e9;
-  Ptr<ParamsTable> table3gpp = CreateObject<ParamsTable> ();
-  // table3gpp includes the following parameters:
-  // numOfCluster, raysPerCluster, uLgDS, sigLgDS, uLgASD, sigLgASD,
-  // uLgASA, sigLgASA, uLgZSA, sigLgZSA, uLgZSD, sigLgZSD, offsetZOD,
-  // cDS, cASD, cASA, cZSA, uK, sigK, rTau, shadowingStd
-
-  //In NLOS case, parameter uK and sigK are not used and 0 is passed into the SetParams() function.
-  if (m_scenario == "RMa")
+  if (m_paramsTableCache)
     {
-      //For RMa, the outdoor LOS/NLOS and o2i LOS/NLOS is the same.
-      if (los)
-        {
-          //3GPP mentioned that 3.91 ns should be used when the Cluster DS (cDS) entry is N/A.
-          table3gpp->SetParams (11, 20, -7.49, 0.55, 0.90, 0.38, 1.52, 0.24, 0.60, 0.16,
-                                0.3, 0.4, 0, 3.91e-9, 2, 3, 3, 7, 4, 3.8, 3);
-          for (uint8_t row = 0; row < 7; row++)
-            {
-              for (uint8_t column = 0; column < 7; column++)
-                {
-                  table3gpp->m_sqrtC[row][column] = sqrtC_RMa_LOS[row][column];
-                }
-            }
-        }
-      else
-        {
-          double offsetZod = atan ((35 - 5) / distance2D) - atan ((35 - 1.5) / distance2D);
-          table3gpp->SetParams (10, 20, -7.43, 0.48, 0.95, 0.45, 1.52, 0.13, 0.88, 0.16,
-                                0.3, 0.49, offsetZod, 3.91e-9, 2, 3, 3, 0, 0, 1.7,3);
-          for (uint8_t row = 0; row < 6; row++)
-            {
-              for (uint8_t column = 0; column < 6; column++)
-                {
-                  table3gpp->m_sqrtC[row][column] = sqrtC_RMa_NLOS[row][column];
-                }
-            }
-        }
+      return MmWave3gppParamsTableStore::Get (m_scenario, fcGHz, los, o2i, hBS, hUT, distance2D,
+                                              m_paramsTableResolution);
     }
-  else if (m_scenario == "UMa")
-    {
-      if (los && !o2i)
-        {
-          double uLgZSD = std::max (-0.5, -2.1 * distance2D / 1000 - 0.01 * (hUT - 1.5) + 0.75);
-          double cDs = std::max (0.25, -3.4084 * log10 (fcGHz) + 6.5622) * 1e-9;
-          table3gpp->SetParams (12, 20, -6.955 - 0.0963 * log10 (fcGHz), 0.66, 1.06 + 0.1114 * log10 (fcGHz),
-                                0.28, 1.81, 0.20, 0.95, 0.16, uLgZSD, 0.40, 0, cDs, 5, 11, 7, 9, 3.5, 2.5, 3);
-          for (uint8_t row = 0; row < 7; row++)
-            {
-              for (uint8_t column = 0; column < 7; column++)
-                {
-                  table3gpp->m_sqrtC[row][column] = sqrtC_UMa_LOS[row][column];
-                }
-            }
-        }
-      else
-        {
-          double uLgZSD = std::max (-0.5, -2.1 * distance2D / 1000 - 0.01 * (hUT - 1.5) + 0.9);
-
-          double afc = 0.208 * log10 (fcGHz) - 0.782;
-          double bfc = 25;
-          double cfc = -0.13 * log10 (fcGHz) + 2.03;
-          double efc = 7.66 * log10 (fcGHz) - 5.96;
+  return MmWave3gppParamsTableStore::Compute (m_scenario, fcGHz, los, o2i, hBS, hUT, distance2D);
+}
 
-          double offsetZOD = efc - std::pow (10, afc * log10 (std::max (bfc,distance2D)) + cfc);
-          double cDS = std::max (0.25, -3.4084 * log10 (fcGHz) + 6.5622) * 1e-9;
+void
+MmWave3gppChannel::DeleteChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
+{
+  Ptr<NetDevice> dev1 = a->GetObject<Node> ()->GetDevice (0);
+  Ptr<NetDevice> dev2 = b->GetObject<Node> ()->GetDevice (0);
+  NS_LOG_INFO ("a position " << a->GetPosition () << " b " << b->GetPosition ());
+  Ptr<Params3gpp> params = m_channelMap.find (std::make_pair (dev1,dev2))->second;
+  NS_LOG_INFO ("params " << params);
+  NS_LOG_INFO ("params m_channel size" << params->m_channel.size ());
+  NS_ASSERT_MSG (m_channelMap.find (std::make_pair (dev1,dev2)) != m_channelMap.end (), "Channel not found");
+  params->m_channel.clear ();
+  m_channelMap[std::make_pair (dev1,dev2)] = params;
+}
 
-          if (!los && !o2i)
-            {
-              table3gpp->SetParams (20, 20, -6.28 - 0.204 * log10 (fcGHz), 0.39, 1.5 - 0.1144 * log10 (fcGHz),
-                                    0.28, 2.08 - 0.27 * log10 (fcGHz), 0.11, -0.3236 * log10 (fcGHz) + 1.512, 0.16, uLgZSD,
-                                    0.49, offsetZOD, cDS, 2, 15, 7, 0, 0, 2.3, 3);
-              for (uint8_t row = 0; row < 6; row++)
-                {
-                  for (uint8_t column = 0; column < 6; column++)
-                    {
-                      table3gpp->m_sqrtC[row][column] = sqrtC_UMa_NLOS[row][column];
-                    }
-                }
-            }
-          else//(o2i)
-            {
-              table3gpp->SetParams (12, 20, -6.62, 0.32, 1.25, 0.42, 1.76, 0.16, 1.01, 0.43,
-                                    uLgZSD, 0.49, offsetZOD, 11e-9, 5, 20, 6, 0, 0, 2.2, 4);
-              for (uint8_t row = 0; row < 6; row++)
-                {
-                  for (uint8_t column = 0; column < 6; column++)
-                    {
-                      table3gpp->m_sqrtC[row][column] = sqrtC_UMa_O2I[row][column];
-                    }
-                }
+void
+MmWave3gppChannel::ScheduleDeleteChannel (const key_t &key, Time delay, Ptr<const MobilityModel> a,
+                                          Ptr<const MobilityModel> b) const
+{
+  m_deleteChannelEvents[key] = Simulator::Schedule (delay, &MmWave3gppChannel::DeleteChannel, this, a, b);
+}
 
-            }
+void
+MmWave3gppChannel::ScheduleBulkUpdate () const
+{
+  if (! m_bulkUpdateEvent.IsRunning ())
+    {
+      NS_LOG_INFO ("Time " << Simulator::Now ().GetSeconds () << " schedule the bulk update");
+      m_bulkUpdateEvent = Simulator::Schedule (m_updatePeriod, &MmWave3gppChannel::BulkUpdate, this);
+    }
+}
 
-        }
+/**
+ * \param device a gNB or UE device
+ * \param ccId the component carrier
+ * \return the antenna array of the device, or nullptr for other devices
+ */
+static Ptr<AntennaArrayBasicModel>
+GetAntennaArray (const Ptr<NetDevice> &device, uint8_t ccId)
+{
+  Ptr<MmWaveEnbNetDevice> enb = DynamicCast<MmWaveEnbNetDevice> (device);
+  if (enb != nullptr)
+    {
+      return DynamicCast<AntennaArrayBasicModel> (enb->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
+    }
+  Ptr<MmWaveUeNetDevice> ue = DynamicCast<MmWaveUeNetDevice> (device);
+  if (ue != nullptr)
+    {
+      return DynamicCast<AntennaArrayBasicModel> (ue->GetPhy (ccId)->GetDlSpectrumPhy ()->GetRxAntenna ());
+    }
+  return nullptr;
+}
 
+const MmWave3gppLinkTable &
+MmWave3gppChannel::GetConditionLinkTable () const
+{
+  if (DynamicCast<MmWave3gppPropagationLossModel> (m_3gppPathloss) != 0)
+    {
+      return m_3gppPathloss->GetObject<MmWave3gppPropagationLossModel> ()->GetLinkTable ();
+    }
+  else if (DynamicCast<MmWave3gppBuildingsPropagationLossModel> (m_3gppPathloss) != 0)
+    {
+      return *m_3gppPathloss->GetObject<MmWave3gppBuildingsPropagationLossModel> ()->GetLinkTables ().front ();
     }
-  else if (m_scenario == "UMi-StreetCanyon")
+  NS_FATAL_ERROR ("unkonw pathloss model");
+}
+
+void
+MmWave3gppChannel::BulkUpdate () const
+{
+  NS_LOG_FUNCTION (this);
+
+  // Mark the stale links, as DeleteChannel does, in the order of the map.
+  // The links whose condition is not current are left to their next
+  // transmission, and the links removed from the link table are dropped.
+  const MmWave3gppLinkTable &links = GetConditionLinkTable ();
+  std::vector<key_t> stale;
+  uint32_t moved = 0;
+  uint32_t removed = 0;
+  for (auto it = m_channelMap.begin (); it != m_channelMap.end (); )
     {
-      if (los && !o2i)
+      if (it->second->m_channel.size () == 0
+          || Now () - it->second->m_generatedTime < m_updatePeriod)
         {
-          double uLgZSD = std::max (-0.21, -14.8 * distance2D / 1000 + 0.01 * std::abs (hUT - hBS) + 0.83);
-          table3gpp->SetParams (12, 20, -0.24 * log10 (1 + fcGHz) - 7.14, 0.38, -0.05 * log10 (1 + fcGHz) + 1.21, 0.41,
-                                -0.08 * log10 (1 + fcGHz) + 1.73, 0.014 * log10 (1 + fcGHz) + 0.28, -0.1 * log10 (1 + fcGHz) + 0.73, -0.04 * log10 (1 + fcGHz) + 0.34,
-                                uLgZSD, 0.35, 0, 5e-9, 3, 17, 7, 9, 5, 3, 3);
-          for (uint8_t row = 0; row < 7; row++)
-            {
-              for (uint8_t column = 0; column < 7; column++)
-                {
-                  table3gpp->m_sqrtC[row][column] = sqrtC_UMi_LOS[row][column];
-                }
-            }
+          ++it;
+          continue;
+        }
+      Ptr<MobilityModel> a = it->first.first->GetNode ()->GetObject<MobilityModel> ();
+      Ptr<MobilityModel> b = it->first.second->GetNode ()->GetObject<MobilityModel> ();
+      if (links.FindLink (a, b) == nullptr)
+        {
+          it = m_channelMap.erase (it);
+          ++removed;
+          continue;
+        }
+      it->second->m_channel.clear ();
+      if (links.IsLinkCurrent (a, b))
+        {
+          stale.push_back (it->first);
         }
       else
         {
-          double uLgZSD = std::max (-0.5, -3.1 * distance2D / 1000 + 0.01 * std::max (hUT - hBS,0.0) + 0.2);
-          double offsetZOD = -1 * std::pow (10, -1.5 * log10 (std::max (10.0, distance2D)) + 3.3);
-          if (!los && !o2i)
-            {
-              table3gpp->SetParams (19, 20, -0.24 * log10 (1 + fcGHz) - 6.83, 0.16 * log10 (1 + fcGHz) + 0.28, -0.23 * log10 (1 + fcGHz) + 1.53,
-                                    0.11 * log10 (1 + fcGHz) + 0.33, -0.08 * log10 (1 + fcGHz) + 1.81, 0.05 * log10 (1 + fcGHz) + 0.3,
-                                    -0.04 * log10 (1 + fcGHz) + 0.92, -0.07 * log10 (1 + fcGHz) + 0.41, uLgZSD, 0.35, offsetZOD,
-                                    11e-9, 10, 22, 7, 0, 0, 2.1, 3);
-              for (uint8_t row = 0; row < 6; row++)
-                {
-                  for (uint8_t column = 0; column < 6; column++)
-                    {
-                      table3gpp->m_sqrtC[row][column] = sqrtC_UMi_NLOS[row][column];
-                    }
-                }
-            }
-          else//(o2i)
-            {
-              table3gpp->SetParams (12, 20, -6.62, 0.32, 1.25, 0.42, 1.76, 0.16, 1.01, 0.43,
-                                    uLgZSD, 0.35, offsetZOD, 11e-9, 5, 20, 6, 0, 0, 2.2, 4);
-              for (uint8_t row = 0; row < 6; row++)
-                {
-                  for (uint8_t column = 0; column < 6; column++)
-                    {
-                      table3gpp->m_sqrtC[row][column] = sqrtC_UMi_O2I[row][column];
-                    }
-                }
-            }
+          ++moved;
         }
+      ++it;
     }
-  else if (m_scenario == "InH-OfficeMixed"||m_scenario == "InH-OfficeOpen" || m_scenario == "InH-ShoppingMall")
+
+  // Update them: this part draws random numbers and sets the BF vectors,
+  // so it runs in the simulator thread; only the long term components are
+  // deferred. The map is ordered by pointer, so the links are updated in the
+  // order of the nodes, which does not change from a run to the other.
+  auto nodeOrder = [] (const key_t &key)
+    {
+      return std::make_tuple (key.first->GetNode ()->GetId (), key.first->GetIfIndex (),
+                              key.second->GetNode ()->GetId (), key.second->GetIfIndex ());
+    };
+  std::sort (stale.begin (), stale.end (), [&nodeOrder] (const key_t &x, const key_t &y)
     {
-      NS_ASSERT_MSG (!o2i, "The indoor scenario does out support outdoor to indoor");
-      if (los)
+      return nodeOrder (x) < nodeOrder (y);
+    });
+  RbgBitmask listOfSubchannels (m_phyMacConfig->GetBandwidthInRbs (), true);
+  Ptr<const SpectrumValue> fakePsd =
+    MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, 0, listOfSubchannels);
+  const uint8_t ccId = m_phyMacConfig->GetCcId ();
+  m_deferLongTerm = true;
+  for (const auto & key : stale)
+    {
+      // The BF vectors set for a connected pair stay in the per-device
+      // storage of the antennas, but their current vector is restored
+      std::vector<std::pair<Ptr<AntennaArrayBasicModel>, AntennaArrayBasicModel::BeamformingVector> > current;
+      for (const Ptr<NetDevice> &device : {key.first, key.second})
         {
-          table3gpp->SetParams (8, 20, -0.01 * log10 (1 + fcGHz) - 7.79, -0.16 * log10 (1 + fcGHz) + 0.50, 1.60, 0.18,
-                                -0.19 * log10 (1 + fcGHz) + 1.86, 0.12 * log10 (1 + fcGHz), -0.26 * log10 (1 + fcGHz) + 1.21, -0.04 * log10 (1 + fcGHz) + 0.17,
-                                -1.43 * log10 (1 + fcGHz) + 2.25, 0.13 * log10 (1 + fcGHz) + 0.15, 0, 3.91e-9, 7, -6.2 * log10 (1 + fcGHz) + 16.72,
-                                -3.85 * log10 (1 + fcGHz) + 10.28, 0.84 * log10 (1 + fcGHz) + 2.12, -0.58 * log10 (1 + fcGHz) + 6.19, 2.15, 6);
-          for (uint8_t row = 0; row < 7; row++)
+          Ptr<AntennaArrayBasicModel> antenna = GetAntennaArray (device, ccId);
+          if (antenna != nullptr && ! antenna->IsOmniTx ())
             {
-              for (uint8_t column = 0; column < 7; column++)
-                {
-                  table3gpp->m_sqrtC[row][column] = sqrtC_office_LOS[row][column];
-                }
+              current.push_back (std::make_pair (antenna, antenna->GetCurrentBeamformingVector ()));
             }
         }
-      else
+
+      Ptr<const MobilityModel> a = key.first->GetNode ()->GetObject<MobilityModel> ();
+      Ptr<const MobilityModel> b = key.second->GetNode ()->GetObject<MobilityModel> ();
+      PrepareBeamformingGain (fakePsd, a, b);
+
+      for (const auto & saved : current)
         {
-          table3gpp->SetParams (10, 20, -0.28 * log10 (1 + fcGHz) - 7.29, 0.1 * log10 (1 + fcGHz) + 0.11, 1.49, 0.17,
-                                -0.11 * log10 (1 + fcGHz) + 1.8, 0.12 * log10 (1 + fcGHz), -0.15 * log10 (1 + fcGHz) + 1.04, -0.09 * log10 (1 + fcGHz) + 0.24,
-                                1.37, 0.38, 0, 3.91e-9, 3, -13.0 * log10 (1 + fcGHz) + 30.53, -3.72 * log10 (1 + fcGHz) + 10.25, 0, 0, 1.84, 3);
-          for (uint8_t row = 0; row < 6; row++)
-            {
-              for (uint8_t column = 0; column < 6; column++)
-                {
-                  table3gpp->m_sqrtC[row][column] = sqrtC_office_NLOS[row][column];
-                }
-            }
+          saved.first->SetBeamformingVector (saved.second.first, saved.second.second);
         }
     }
-  else
-    {
-      //Note that the InH-ShoppingMall scenario is not given in the table 7.5-6
-      NS_FATAL_ERROR ("unkonw scenarios");
-    }
+  m_deferLongTerm = false;
 
-  return table3gpp;
+  const std::vector<Params3gpp *> &pending = m_pendingLongTerm;
+  m_workers.ParallelFor (pending.size (), [this, &pending] (size_t i)
+    {
+      CalLongTerm (pending[i]);
+    });
+  m_pendingLongTerm.clear ();
 
-}
+  NS_LOG_INFO ("Time " << Simulator::Now ().GetSeconds () << " bulk update of " << stale.size () << " links, "
+               << moved << " left to their next transmission, " << removed << " removed");
+  m_linksUpdatedTrace (static_cast<uint32_t> (stale.size ()));
 
-void
-MmWave3gppChannel::DeleteChannel (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
-{
-  Ptr<NetDevice> dev1 = a->GetObject<Node> ()->GetDevice (0);
-  Ptr<NetDevice> dev2 = b->GetObject<Node> ()->GetDevice (0);
-  NS_LOG_INFO ("a position " << a->GetPosition () << " b " << b->GetPosition ());
-  Ptr<Params3gpp> params = m_channelMap.find (std::make_pair (dev1,dev2))->second;
-  NS_LOG_INFO ("params " << params);
-  NS_LOG_INFO ("params m_channel size" << params->m_channel.size ());
-  NS_ASSERT_MSG (m_channelMap.find (std::make_pair (dev1,dev2)) != m_channelMap.end (), "Channel not found");
-  params->m_channel.clear ();
-  m_channelMap[std::make_pair (dev1,dev2)] = params;
+  if (! m_channelMap.empty ())
+    {
+      m_bulkUpdateEvent = Simulator::Schedule (m_updatePeriod, &MmWave3gppChannel::BulkUpdate, this);
+    }
 }
 
 Ptr<Params3gpp>
-MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, bool los, bool o2i,
+MmWave3gppChannel::GetNewChannel (const ParamsTable &table3gpp, Vector locUT, bool los, bool o2i,
                                   Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
                                   uint8_t *txAntennaNum, uint8_t *rxAntennaNum,  Angles &rxAngle, Angles &txAngle,
                                   Vector speed, double dis2D, double dis3D) const
 {
-  uint8_t numOfCluster = table3gpp->m_numOfCluster;
-  uint8_t raysPerCluster = table3gpp->m_raysPerCluster;
+  uint8_t numOfCluster = table3gpp.m_numOfCluster;
+  uint8_t raysPerCluster = table3gpp.m_raysPerCluster;
   Ptr<Params3gpp> channelParams = Create<Params3gpp> ();
   //for new channel, the previous and current location is the same.
   channelParams->m_preLocUT = locUT;
@@ -1143,7 +1169,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
       double temp = 0;
       for (uint8_t column = 0; column < paramNum; column++)
         {
-          temp += table3gpp->m_sqrtC[row][column] * LSPsIndep.at (column);
+          temp += table3gpp.m_sqrtC[row][column] * LSPsIndep.at (column);
         }
       LSPs.push_back (temp);
     }
@@ -1154,20 +1180,20 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
   double DS,ASD,ASA,ZSA,ZSD,K_factor = 0;
   if (los)
     {
-      K_factor = LSPs.at (1) * table3gpp->m_sigK + table3gpp->m_uK;
-      DS = pow (10, LSPs.at (2) * table3gpp->m_sigLgDS + table3gpp->m_uLgDS);
-      ASD = pow (10, LSPs.at (3) * table3gpp->m_sigLgASD + table3gpp->m_uLgASD);
-      ASA = pow (10, LSPs.at (4) * table3gpp->m_sigLgASA + table3gpp->m_uLgASA);
-      ZSD = pow (10, LSPs.at (5) * table3gpp->m_sigLgZSD + table3gpp->m_uLgZSD);
-      ZSA = pow (10, LSPs.at (6) * table3gpp->m_sigLgZSA + table3gpp->m_uLgZSA);
+      K_factor = LSPs.at (1) * table3gpp.m_sigK + table3gpp.m_uK;
+      DS = pow (10, LSPs.at (2) * table3gpp.m_sigLgDS + table3gpp.m_uLgDS);
+      ASD = pow (10, LSPs.at (3) * table3gpp.m_sigLgASD + table3gpp.m_uLgASD);
+      ASA = pow (10, LSPs.at (4) * table3gpp.m_sigLgASA + table3gpp.m_uLgASA);
+      ZSD = pow (10, LSPs.at (5) * table3gpp.m_sigLgZSD + table3gpp.m_uLgZSD);
+      ZSA = pow (10, LSPs.at (6) * table3gpp.m_sigLgZSA + table3gpp.m_uLgZSA);
     }
   else
     {
-      DS = pow (10, LSPs.at (1) * table3gpp->m_sigLgDS + table3gpp->m_uLgDS);
-      ASD = pow (10, LSPs.at (2) * table3gpp->m_sigLgASD + table3gpp->m_uLgASD);
-      ASA = pow (10, LSPs.at (3) * table3gpp->m_sigLgASA + table3gpp->m_uLgASA);
-      ZSD = pow (10, LSPs.at (4) * table3gpp->m_sigLgZSD + table3gpp->m_uLgZSD);
-      ZSA = pow (10, LSPs.at (5) * table3gpp->m_sigLgZSA + table3gpp->m_uLgZSA);
+      DS = pow (10, LSPs.at (1) * table3gpp.m_sigLgDS + table3gpp.m_uLgDS);
+      ASD = pow (10, LSPs.at (2) * table3gpp.m_sigLgASD + table3gpp.m_uLgASD);
+      ASA = pow (10, LSPs.at (3) * table3gpp.m_sigLgASA + table3gpp.m_uLgASA);
+      ZSD = pow (10, LSPs.at (4) * table3gpp.m_sigLgZSD + table3gpp.m_uLgZSD);
+      ZSA = pow (10, LSPs.at (5) * table3gpp.m_sigLgZSA + table3gpp.m_uLgZSA);
 
     }
   ASD = std::min (ASD, 104.0);
@@ -1185,7 +1211,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
   double minTau = 100.0;
   for (uint8_t cIndex = 0; cIndex < numOfCluster; cIndex++)
     {
-      double tau = -1 * table3gpp->m_rTau * DS * log (m_uniformRv->GetValue (0,1)); //(7.5-1)
+      double tau = -1 * table3gpp.m_rTau * DS * log (m_uniformRv->GetValue (0,1)); //(7.5-1)
       if (minTau > tau)
         {
           minTau = tau;
@@ -1207,8 +1233,8 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
   double powerSum = 0;
   for (uint8_t cIndex = 0; cIndex < numOfCluster; cIndex++)
     {
-      double power = exp (-1 * clusterDelay.at (cIndex) * (table3gpp->m_rTau - 1) / table3gpp->m_rTau / DS) *
-        pow (10,-1 * m_normalRv->GetValue () * table3gpp->m_shadowingStd / 10); //(7.5-5)
+      double power = exp (-1 * clusterDelay.at (cIndex) * (table3gpp.m_rTau - 1) / table3gpp.m_rTau / DS) *
+        pow (10,-1 * m_normalRv->GetValue () * table3gpp.m_shadowingStd / 10); //(7.5-5)
       powerSum += power;
       clusterPower.push_back (power);
     }
@@ -1397,7 +1423,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
         {
           clusterZoa.at (cIndex) = clusterZoa.at (cIndex) * Xn + (m_normalRv->GetValue () * ZSA / 7) + rxAngle.theta * 180 / M_PI; //(7.5-16)
         }
-      clusterZod.at (cIndex) = clusterZod.at (cIndex) * Xn + (m_normalRv->GetValue () * ZSD / 7) + txAngle.theta * 180 / M_PI + table3gpp->m_offsetZOD; //(7.5-19)
+      clusterZod.at (cIndex) = clusterZod.at (cIndex) * Xn + (m_normalRv->GetValue () * ZSD / 7) + txAngle.theta * 180 / M_PI + table3gpp.m_offsetZOD; //(7.5-19)
 
     }
 
@@ -1429,7 +1455,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
     {
       for (uint8_t mInd = 0; mInd < raysPerCluster; mInd++)
         {
-          double tempAoa = clusterAoa.at (nInd) + table3gpp->m_cASA * offSetAlpha[mInd]; //(7.5-13)
+          double tempAoa = clusterAoa.at (nInd) + table3gpp.m_cASA * offSetAlpha[mInd]; //(7.5-13)
           while (tempAoa > 360)
             {
               tempAoa -= 360;
@@ -1443,7 +1469,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
           NS_ASSERT_MSG (tempAoa >= 0 && tempAoa <= 360, "the AOA should be the range of [0,360]");
           rayAoa_radian[nInd][mInd] = tempAoa * M_PI / 180;
 
-          double tempAod = clusterAod.at (nInd) + table3gpp->m_cASD * offSetAlpha[mInd];
+          double tempAod = clusterAod.at (nInd) + table3gpp.m_cASD * offSetAlpha[mInd];
           while (tempAod > 360)
             {
               tempAod -= 360;
@@ -1456,7 +1482,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
           NS_ASSERT_MSG (tempAod >= 0 && tempAod <= 360, "the AOD should be the range of [0,360]");
           rayAod_radian[nInd][mInd] = tempAod * M_PI / 180;
 
-          double tempZoa = clusterZoa.at (nInd) + table3gpp->m_cZSA * offSetAlpha[mInd]; //(7.5-18)
+          double tempZoa = clusterZoa.at (nInd) + table3gpp.m_cZSA * offSetAlpha[mInd]; //(7.5-18)
 
           while (tempZoa > 360)
             {
@@ -1476,7 +1502,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
           NS_ASSERT_MSG (tempZoa >= 0&&tempZoa <= 180, "the ZOA should be the range of [0,180]");
           rayZoa_radian[nInd][mInd] = tempZoa * M_PI / 180;
 
-          double tempZod = clusterZod.at (nInd) + 0.375 * pow (10,table3gpp->m_uLgZSD) * offSetAlpha[mInd]; //(7.5-20)
+          double tempZod = clusterZod.at (nInd) + 0.375 * pow (10,table3gpp.m_uLgZSD) * offSetAlpha[mInd]; //(7.5-20)
 
           while (tempZod > 360)
             {
@@ -1662,6 +1688,33 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
         }
     }
 
+  // The radiation patterns of the antennas, the steering vectors of the
+  // arrays and the initial phase of each ray do not depend on the pair of
+  // antenna elements: compute them once for all the pairs
+  const uint32_t numRays = numReducedCluster * raysPerCluster;
+  std::vector<double> rxPatterns (numRays);
+  std::vector<double> txPatterns (numRays);
+  rxAntenna->GetRadiationPatterns (&rayZoa_radian[0][0], &rayAoa_radian[0][0], numRays, rxPatterns.data ());
+  txAntenna->GetRadiationPatterns (&rayZod_radian[0][0], &rayAod_radian[0][0], numRays, txPatterns.data ());
+  AntennaArrayBasicModel::complexVector_t rxSteering;
+  AntennaArrayBasicModel::complexVector_t txSteering;
+  rxAntenna->GetSteeringVectors (&rayZoa_radian[0][0], &rayAoa_radian[0][0], numRays, rxAntennaNum, &rxSteering);
+  txAntenna->GetSteeringVectors (&rayZod_radian[0][0], &rayAod_radian[0][0], numRays, txAntennaNum, &txSteering);
+  std::vector<std::complex<double> > rayPhases (numRays);
+  for (uint8_t nIndex = 0; nIndex < numReducedCluster; nIndex++)
+    {
+      for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
+        {
+          rayPhases[nIndex * raysPerCluster + mIndex] = exp (std::complex<double> (0, clusterPhase.at (nIndex).at (mIndex)));
+        }
+    }
+  double losPattern = 0;
+  if (los)
+    {
+      losPattern = rxAntenna->GetRadiationPattern (rxAngle.theta, rxAngle.phi) *
+        txAntenna->GetRadiationPattern (txAngle.theta, txAngle.phi);
+    }
+
   // The following for loops computes the channel coefficients
   for (uint16_t uIndex = 0; uIndex < uSize; uIndex++)
     {
@@ -1680,24 +1733,16 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
                   std::complex<double> rays (0,0);
                   for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
                     {
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
+                      const uint32_t ray = nIndex * raysPerCluster + mIndex;
+                      //lambda_0 is accounted in the antenna spacing of the steering vectors.
                       //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
                       //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
                       //              + sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
                       //              + cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*varTtiTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-                      rays += exp (std::complex<double> (0, initialPhase))
-                        * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian [nIndex][mIndex]) *
-                            txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian [nIndex][mIndex]))
-                        * exp (std::complex<double> (0, rxPhaseDiff))
-                        * exp (std::complex<double> (0, txPhaseDiff));
+                      rays += rayPhases[ray]
+                        * (rxPatterns[ray] * txPatterns[ray])
+                        * rxSteering[uIndex * numRays + ray]
+                        * txSteering[sIndex * numRays + ray];
                       //*exp(std::complex<double>(0, doppler));
                       //rays += 1;
                     }
@@ -1716,13 +1761,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
 
                       //ZML:Just remind me that the angle offsets for the 3 subclusters were not generated correctly.
 
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
+                      const uint32_t ray = nIndex * raysPerCluster + mIndex;
                       //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
                       //              + sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
                       //              + cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*varTtiTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
@@ -1736,11 +1775,10 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
                         case 17:
                         case 18:
                           //delaySpread= -2*M_PI*(clusterDelay.at(nIndex)+1.28*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub2 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian [nIndex][mIndex]) *
-                                txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex],rayAod_radian [nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
+                          raysSub2 += rayPhases[ray]
+                            * (rxPatterns[ray] * txPatterns[ray])
+                            * rxSteering[uIndex * numRays + ray]
+                            * txSteering[sIndex * numRays + ray];
                           //*exp(std::complex<double>(0, doppler));
                           //raysSub2 +=1;
                           break;
@@ -1749,21 +1787,19 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
                         case 15:
                         case 16:
                           //delaySpread = -2*M_PI*(clusterDelay.at(nIndex)+2.56*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub3 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian[nIndex][mIndex]) *
-                                txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
+                          raysSub3 += rayPhases[ray]
+                            * (rxPatterns[ray] * txPatterns[ray])
+                            * rxSteering[uIndex * numRays + ray]
+                            * txSteering[sIndex * numRays + ray];
                           //*exp(std::complex<double>(0, doppler));
                           //raysSub3 +=1;
                           break;
                         default://case 1,2,3,4,5,6,7,8,19,20
                           //delaySpread = -2*M_PI*clusterDelay.at(nIndex)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub1 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian[nIndex][mIndex]) *
-                                txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
+                          raysSub1 += rayPhases[ray]
+                            * (rxPatterns[ray] * txPatterns[ray])
+                            * rxSteering[uIndex * numRays + ray]
+                            * txSteering[sIndex * numRays + ray];
                           //*exp(std::complex<double>(0, doppler));
                           //raysSub1 +=1;
                           break;
@@ -1795,8 +1831,7 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
               //              + cos(rxAngle.theta)*relativeSpeed.z)*varTtiTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
 
               ray = exp (std::complex<double> (0, losPhase))
-                * (rxAntenna->GetRadiationPattern (rxAngle.theta, rxAngle.phi) *
-                    txAntenna->GetRadiationPattern (txAngle.theta, txAngle.phi))
+                * losPattern
                 * exp (std::complex<double> (0, rxPhaseDiff))
                 * exp (std::complex<double> (0, txPhaseDiff));
               //*exp(std::complex<double>(0, doppler));
@@ -1816,8 +1851,8 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
 
   if (cluster1st == cluster2nd)
     {
-      clusterDelay.push_back (clusterDelay.at (cluster1st) + 1.28 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (cluster1st) + 2.56 * table3gpp->m_cDS);
+      clusterDelay.push_back (clusterDelay.at (cluster1st) + 1.28 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (cluster1st) + 2.56 * table3gpp.m_cDS);
 
       clusterAoa.push_back (clusterAoa.at (cluster1st));
       clusterAoa.push_back (clusterAoa.at (cluster1st));
@@ -1844,10 +1879,10 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
           min = cluster2nd;
           max = cluster1st;
         }
-      clusterDelay.push_back (clusterDelay.at (min) + 1.28 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (min) + 2.56 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (max) + 1.28 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (max) + 2.56 * table3gpp->m_cDS);
+      clusterDelay.push_back (clusterDelay.at (min) + 1.28 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (min) + 2.56 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (max) + 1.28 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (max) + 2.56 * table3gpp.m_cDS);
 
       clusterAoa.push_back (clusterAoa.at (min));
       clusterAoa.push_back (clusterAoa.at (min));
@@ -1888,12 +1923,12 @@ MmWave3gppChannel::GetNewChannel (Ptr<ParamsTable>  table3gpp, Vector locUT, boo
 }
 
 Ptr<Params3gpp>
-MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  table3gpp,
+MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, const ParamsTable &table3gpp,
                                   Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
                                   uint8_t *txAntennaNum, uint8_t *rxAntennaNum, Angles &rxAngle, Angles &txAngle) const
 {
   Ptr<Params3gpp> params = params3gpp;
-  uint8_t raysPerCluster = table3gpp->m_raysPerCluster;
+  uint8_t raysPerCluster = table3gpp.m_raysPerCluster;
   //We first update the current location, the previous location will be updated in the end.
 
 
@@ -1932,8 +1967,8 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
   double powerSum = 0;
   for (uint8_t cIndex = 0; cIndex < params->m_numCluster; cIndex++)
     {
-      double power = exp (-1 * clusterDelay.at (cIndex) * (table3gpp->m_rTau - 1) / table3gpp->m_rTau / DS) *
-        pow (10,-1 * m_normalRv->GetValue () * table3gpp->m_shadowingStd / 10); //(7.5-5)
+      double power = exp (-1 * clusterDelay.at (cIndex) * (table3gpp.m_rTau - 1) / table3gpp.m_rTau / DS) *
+        pow (10,-1 * m_normalRv->GetValue () * table3gpp.m_shadowingStd / 10); //(7.5-5)
       powerSum += power;
       clusterPower.push_back (power);
     }
@@ -2050,7 +2085,7 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
     {
       for (uint8_t mInd = 0; mInd < raysPerCluster; mInd++)
         {
-          double tempAoa = clusterAoa.at (nInd) + table3gpp->m_cASA * offSetAlpha[mInd]; //(7.5-13)
+          double tempAoa = clusterAoa.at (nInd) + table3gpp.m_cASA * offSetAlpha[mInd]; //(7.5-13)
           while (tempAoa > 360)
             {
               tempAoa -= 360;
@@ -2064,7 +2099,7 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
           NS_ASSERT_MSG (tempAoa >= 0 && tempAoa <= 360, "the AOA should be the range of [0,360]");
           rayAoa_radian[nInd][mInd] = tempAoa * M_PI / 180;
 
-          double tempAod = clusterAod.at (nInd) + table3gpp->m_cASD * offSetAlpha[mInd];
+          double tempAod = clusterAod.at (nInd) + table3gpp.m_cASD * offSetAlpha[mInd];
           while (tempAod > 360)
             {
               tempAod -= 360;
@@ -2077,7 +2112,7 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
           NS_ASSERT_MSG (tempAod >= 0 && tempAod <= 360, "the AOD should be the range of [0,360]");
           rayAod_radian[nInd][mInd] = tempAod * M_PI / 180;
 
-          double tempZoa = clusterZoa.at (nInd) + table3gpp->m_cZSA * offSetAlpha[mInd]; //(7.5-18)
+          double tempZoa = clusterZoa.at (nInd) + table3gpp.m_cZSA * offSetAlpha[mInd]; //(7.5-18)
 
           while (tempZoa > 360)
             {
@@ -2097,7 +2132,7 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
           NS_ASSERT_MSG (tempZoa >= 0&&tempZoa <= 180, "the ZOA should be the range of [0,180]");
           rayZoa_radian[nInd][mInd] = tempZoa * M_PI / 180;
 
-          double tempZod = clusterZod.at (nInd) + 0.375 * pow (10,table3gpp->m_uLgZSD) * offSetAlpha[mInd]; //(7.5-20)
+          double tempZod = clusterZod.at (nInd) + 0.375 * pow (10,table3gpp.m_uLgZSD) * offSetAlpha[mInd]; //(7.5-20)
 
           while (tempZod > 360)
             {
@@ -2279,6 +2314,33 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
      }
 
   //double varTtiTime = Simulator::Now ().GetSeconds ();
+  // The radiation patterns of the antennas, the steering vectors of the
+  // arrays and the initial phase of each ray do not depend on the pair of
+  // antenna elements: compute them once for all the pairs
+  const uint32_t numRays = params->m_numCluster * raysPerCluster;
+  std::vector<double> rxPatterns (numRays);
+  std::vector<double> txPatterns (numRays);
+  rxAntenna->GetRadiationPatterns (&rayZoa_radian[0][0], &rayAoa_radian[0][0], numRays, rxPatterns.data ());
+  txAntenna->GetRadiationPatterns (&rayZod_radian[0][0], &rayAod_radian[0][0], numRays, txPatterns.data ());
+  AntennaArrayBasicModel::complexVector_t rxSteering;
+  AntennaArrayBasicModel::complexVector_t txSteering;
+  rxAntenna->GetSteeringVectors (&rayZoa_radian[0][0], &rayAoa_radian[0][0], numRays, rxAntennaNum, &rxSteering);
+  txAntenna->GetSteeringVectors (&rayZod_radian[0][0], &rayAod_radian[0][0], numRays, txAntennaNum, &txSteering);
+  std::vector<std::complex<double> > rayPhases (numRays);
+  for (uint8_t nIndex = 0; nIndex < params->m_numCluster; nIndex++)
+    {
+      for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
+        {
+          rayPhases[nIndex * raysPerCluster + mIndex] = exp (std::complex<double> (0, clusterPhase.at (nIndex).at (mIndex)));
+        }
+    }
+  double losPattern = 0;
+  if (params->m_los)
+    {
+      losPattern = rxAntenna->GetRadiationPattern (rxAngle.theta, rxAngle.phi) *
+        txAntenna->GetRadiationPattern (txAngle.theta, txAngle.phi);
+    }
+
   // The following for loops computes the channel coefficients
   for (uint16_t uIndex = 0; uIndex < uSize; uIndex++)
     {
@@ -2297,24 +2359,16 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
                   std::complex<double> rays (0,0);
                   for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
                     {
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
+                      const uint32_t ray = nIndex * raysPerCluster + mIndex;
+                      //lambda_0 is accounted in the antenna spacing of the steering vectors.
                       //Doppler is computed in the CalBeamformingGain function and is simplified to only account for the center anngle of each cluster.
                       //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
                       //              + sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
                       //              + cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*varTtiTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-                      rays += exp (std::complex<double> (0, initialPhase))
-                        * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex],rayAoa_radian[nIndex][mIndex] ) *
-                            txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex]))
-                        * exp (std::complex<double> (0, rxPhaseDiff))
-                        * exp (std::complex<double> (0, txPhaseDiff));
+                      rays += rayPhases[ray]
+                        * (rxPatterns[ray] * txPatterns[ray])
+                        * rxSteering[uIndex * numRays + ray]
+                        * txSteering[sIndex * numRays + ray];
                       //*exp(std::complex<double>(0, doppler));
                       //rays += 1;
                     }
@@ -2330,13 +2384,7 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
 
                   for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
                     {
-                      double initialPhase = clusterPhase.at (nIndex).at (mIndex);
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
+                      const uint32_t ray = nIndex * raysPerCluster + mIndex;
                       //double doppler = 2*M_PI*(sin(rayZoa_radian[nIndex][mIndex])*cos(rayAoa_radian[nIndex][mIndex])*relativeSpeed.x
                       //              + sin(rayZoa_radian[nIndex][mIndex])*sin(rayAoa_radian[nIndex][mIndex])*relativeSpeed.y
                       //              + cos(rayZoa_radian[nIndex][mIndex])*relativeSpeed.z)*varTtiTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
@@ -2350,11 +2398,10 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
                         case 17:
                         case 18:
                           //delaySpread= -2*M_PI*(clusterDelay.at(nIndex)+1.28*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub2 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian[nIndex][mIndex]) *
-                                txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
+                          raysSub2 += rayPhases[ray]
+                            * (rxPatterns[ray] * txPatterns[ray])
+                            * rxSteering[uIndex * numRays + ray]
+                            * txSteering[sIndex * numRays + ray];
                           //*exp(std::complex<double>(0, doppler));
                           //raysSub2 +=1;
                           break;
@@ -2363,21 +2410,19 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
                         case 15:
                         case 16:
                           //delaySpread = -2*M_PI*(clusterDelay.at(nIndex)+2.56*c_DS)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub3 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian[nIndex][mIndex])
-                                * txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
+                          raysSub3 += rayPhases[ray]
+                            * (rxPatterns[ray] * txPatterns[ray])
+                            * rxSteering[uIndex * numRays + ray]
+                            * txSteering[sIndex * numRays + ray];
                           //*exp(std::complex<double>(0, doppler));
                           //raysSub3 +=1;
                           break;
                         default://case 1,2,3,4,5,6,7,8,19,20
                           //delaySpread = -2*M_PI*clusterDelay.at(nIndex)*m_phyMacConfig->GetCenterFrequency ();
-                          raysSub1 += exp (std::complex<double> (0, initialPhase))
-                            * (rxAntenna->GetRadiationPattern (rayZoa_radian[nIndex][mIndex], rayAoa_radian[nIndex][mIndex]) *
-                                txAntenna->GetRadiationPattern (rayZod_radian[nIndex][mIndex], rayAod_radian[nIndex][mIndex]))
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
+                          raysSub1 += rayPhases[ray]
+                            * (rxPatterns[ray] * txPatterns[ray])
+                            * rxSteering[uIndex * numRays + ray]
+                            * txSteering[sIndex * numRays + ray];
                           //*exp(std::complex<double>(0, doppler));
                           //raysSub1 +=1;
                           break;
@@ -2409,8 +2454,7 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
               //              + cos(rxAngle.theta)*relativeSpeed.z)*varTtiTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
 
               ray = exp (std::complex<double> (0, losPhase))
-                * (rxAntenna->GetRadiationPattern (rxAngle.theta, rxAngle.phi) *
-                    txAntenna->GetRadiationPattern (txAngle.theta, txAngle.phi))
+                * losPattern
                 * exp (std::complex<double> (0, rxPhaseDiff))
                 * exp (std::complex<double> (0, txPhaseDiff));
               //*exp(std::complex<double>(0, doppler));
@@ -2430,8 +2474,8 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
 
   if (cluster1st == cluster2nd)
     {
-      clusterDelay.push_back (clusterDelay.at (cluster2nd) + 1.28 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (cluster2nd) + 2.56 * table3gpp->m_cDS);
+      clusterDelay.push_back (clusterDelay.at (cluster2nd) + 1.28 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (cluster2nd) + 2.56 * table3gpp.m_cDS);
 
       clusterAoa.push_back (clusterAoa.at (cluster2nd));
       clusterAoa.push_back (clusterAoa.at (cluster2nd));
@@ -2451,10 +2495,10 @@ MmWave3gppChannel::UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>
           min = cluster2nd;
           max = cluster1st;
         }
-      clusterDelay.push_back (clusterDelay.at (min) + 1.28 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (min) + 2.56 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (max) + 1.28 * table3gpp->m_cDS);
-      clusterDelay.push_back (clusterDelay.at (max) + 2.56 * table3gpp->m_cDS);
+      clusterDelay.push_back (clusterDelay.at (min) + 1.28 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (min) + 2.56 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (max) + 1.28 * table3gpp.m_cDS);
+      clusterDelay.push_back (clusterDelay.at (max) + 2.56 * table3gpp.m_cDS);
 
       clusterAoa.push_back (clusterAoa.at (min));
       clusterAoa.push_back (clusterAoa.at (min));
@@ -2511,7 +2555,7 @@ MmWave3gppChannel::BeamSearchBeamforming (Ptr<const SpectrumValue> txPsd, Ptr<Pa
                   params->m_rxW = AntennaArrayBasicModel::GetVector (rxAntenna->GetCurrentBeamformingVector ());
                   params->m_rxBeamId = AntennaArrayBasicModel::GetBeamId (rxAntenna->GetCurrentBeamformingVector ());
 
-                  CalLongTerm (params);
+                  CalLongTerm (PeekPointer (params));
                   Ptr<SpectrumValue> bfPsd = CalBeamformingGain (txPsd, params, Vector (0,0,0));
 
                   SpectrumValue bfGain = (*bfPsd) / (*txPsd);
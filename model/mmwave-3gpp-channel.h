@@ -42,6 +42,11 @@
 #include "mmwave-3gpp-buildings-propagation-loss-model.h"
 #include <ns3/antenna-array-model.h>
 #include "antenna-array-basic-model.h"
+#include "mmwave-worker-pool.h"
+#include "mmwave-3gpp-params-table.h"
+#include <ns3/traced-callback.h>
+#include <ns3/event-id.h>
+#include <functional>
 
 #define AOA_INDEX 0
 #define ZOA_INDEX 1
@@ -96,69 +101,6 @@ struct Params3gpp : public SimpleRefCount<Params3gpp>
   double m_dis3D;
 };
 
-/**
- * Data structure that stores the parameters of 3GPP TR 38.900, Table 7.5-6, for a certain scenario
- */
-struct ParamsTable : public Object
-{
-  uint8_t m_numOfCluster = 0;
-  uint8_t m_raysPerCluster = 0;
-  double m_uLgDS = 0;
-  double m_sigLgDS = 0;
-  double m_uLgASD = 0;
-  double m_sigLgASD = 0;
-  double m_uLgASA = 0;
-  double m_sigLgASA = 0;
-  double m_uLgZSA = 0;
-  double m_sigLgZSA = 0;
-  double m_uLgZSD = 0;
-  double m_sigLgZSD = 0;
-  double m_offsetZOD = 0;
-  double m_cDS = 0;
-  double m_cASD = 0;
-  double m_cASA = 0;
-  double m_cZSA = 0;
-  double m_uK = 0;
-  double m_sigK = 0;
-  double m_rTau = 0;
-  double m_shadowingStd = 0;
-
-  double m_sqrtC[7][7];
-
-  ParamsTable ()
-  {
-  }
-  void SetParams (uint8_t numOfCluster, uint8_t raysPerCluster, double uLgDS, double sigLgDS,
-                  double uLgASD, double sigLgASD, double uLgASA, double sigLgASA,
-                  double uLgZSA, double sigLgZSA, double uLgZSD, double sigLgZSD, double offsetZOD,
-                  double cDS, double cASD, double cASA, double cZSA,
-                  double uK, double sigK, double rTau, double shadowingStd)
-  {
-    m_numOfCluster = numOfCluster;
-    m_raysPerCluster = raysPerCluster;
-    m_uLgDS = uLgDS;
-    m_sigLgDS = sigLgDS;
-    m_uLgASD = uLgASD;
-    m_sigLgASD = sigLgASD;
-    m_uLgASA = uLgASA;
-    m_sigLgASA = sigLgASA;
-    m_uLgZSA = uLgZSA;
-    m_sigLgZSA = sigLgZSA;
-    m_uLgZSD = uLgZSD;
-    m_sigLgZSD = sigLgZSD;
-    m_offsetZOD = offsetZOD;
-    m_cDS = cDS;
-    m_cASD = cASD;
-    m_cASA = cASA;
-    m_cZSA = cZSA;
-    m_uK = uK;
-    m_sigK = sigK;
-    m_rTau = rTau;
-    m_shadowingStd = shadowingStd;
-  }
-
-};
-
 /**
  * \brief This class implements the fading computation of the 3GPP TR 38.900 channel model and performs the
  * beamforming gain computation. It implements the SpectrumPropagationLossModel interface
@@ -219,6 +161,93 @@ public:
    */
   void SetPathlossModel (Ptr<PropagationLossModel> pathloss);
 
+  /**
+   * \brief What is needed to apply the BF gain of a link to a PSD, as
+   * prepared by PrepareBeamformingGain
+   */
+  struct BeamformingGainJob
+  {
+    Ptr<Params3gpp> m_params;   //!< Channel of the link, nullptr if the PSD does not change
+    Vector m_speed;             //!< Relative speed between UE and eNB
+    double m_time {0.0};        //!< Time of the Doppler phase, in s
+    bool m_reverseLink {false}; //!< True if the channel is the one of the reverse link
+  };
+
+  /**
+   * \brief The first part of DoCalcRxPowerSpectralDensity: create or update
+   * the channel of the link, and the BF vectors, if needed
+   * \param psd the PSD that will be received (used only by the beam search)
+   * \param a the mobility model of the transmitter
+   * \param b the mobility model of the receiver
+   * \return the job to pass to ApplyBeamformingGain
+   *
+   * It modifies the channel map, and it draws random numbers, so it has to
+   * be called from the simulator thread, in the order of the receivers.
+   */
+  BeamformingGainJob PrepareBeamformingGain (Ptr<const SpectrumValue> psd,
+                                             Ptr<const MobilityModel> a,
+                                             Ptr<const MobilityModel> b) const;
+
+  /**
+   * \brief The second part of DoCalcRxPowerSpectralDensity: multiply a PSD
+   * by the BF gain of a link
+   * \param job the job returned by PrepareBeamformingGain, with a channel
+   * \param psd the PSD, modified in place
+   *
+   * It only reads the channel of the job, and it does not log nor copy any
+   * Ptr, so the jobs of different receivers can run in parallel, as long as
+   * the simulator thread waits for them.
+   */
+  void ApplyBeamformingGain (const BeamformingGainJob &job, SpectrumValue *psd) const;
+
+  /**
+   * \brief Set the number of threads used by the bulk update
+   * \param n number of threads, including the simulator one
+   */
+  void SetNumWorkers (uint32_t n);
+
+  /**
+   * \return the number of threads used by the bulk update
+   */
+  uint32_t GetNumWorkers () const;
+
+  /**
+   * \brief Call a function on each channel realization, in the order of the
+   * map
+   * \param f the function, called with the transmitter and the receiver
+   * devices, and the realization (which must not be modified)
+   */
+  void ForEachChannel (const std::function<void (const Ptr<NetDevice> &tx, const Ptr<NetDevice> &rx,
+                                                 const Ptr<const Params3gpp> &params)> &f) const;
+
+  /**
+   * \brief Restore a channel realization, as seen by ForEachChannel in a
+   * previous run, replacing the one of the link if any
+   * \param tx the transmitter device
+   * \param rx the receiver device
+   * \param params the realization, with m_generatedTime already moved to
+   * the current time base
+   *
+   * The update of the channel is scheduled UpdatePeriod after its
+   * m_generatedTime (or at once, if it is older), as if it was generated
+   * in this run; the update of the channel replaced, if any, is cancelled.
+   */
+  void RestoreChannel (Ptr<NetDevice> tx, Ptr<NetDevice> rx, Ptr<Params3gpp> params);
+
+  /**
+   * \brief Remove all the channel realizations, and cancel their updates
+   *
+   * The connected pairs are kept.
+   */
+  void ClearChannels ();
+
+  /**
+   * TracedCallback signature for the links updated by a bulk update.
+   *
+   * \param [in] numLinks The number of links whose channel was updated.
+   */
+  typedef void (* LinksUpdatedTracedCallback)(uint32_t numLinks);
+
 private:
   /**
    * Inherited from SpectrumPropagationLossModel, it returns the PSD at the receiver
@@ -248,7 +277,7 @@ private:
    * @params the 3D distance between tx and rx
    * @returns the channel realization in a Params3gpp object
    */
-  Ptr<Params3gpp> GetNewChannel (Ptr<ParamsTable> table3gpp, Vector locUT, bool los, bool o2i,
+  Ptr<Params3gpp> GetNewChannel (const ParamsTable &table3gpp, Vector locUT, bool los, bool o2i,
                                  Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
                                  uint8_t *txAntennaNum, uint8_t *rxAntennaNum, Angles &rxAngle, Angles &txAngle,
                                  Vector speed, double dis2D, double dis3D) const;
@@ -266,7 +295,7 @@ private:
    * @params the txAngle
    * @returns the channel realization in a Params3gpp object
    */
-  Ptr<Params3gpp> UpdateChannel (Ptr<Params3gpp> params3gpp, Ptr<ParamsTable> table3gpp,
+  Ptr<Params3gpp> UpdateChannel (Ptr<Params3gpp> params3gpp, const ParamsTable &table3gpp,
                                  Ptr<AntennaArrayBasicModel> txAntenna, Ptr<AntennaArrayBasicModel> rxAntenna,
                                  uint8_t *txAntennaNum, uint8_t *rxAntennaNum, Angles &rxAngle, Angles &txAngle) const;
 
@@ -289,8 +318,10 @@ private:
   /**
    * Compute and store the long term fading params in order to decrease the computational load
    * @params the channel realizationin as a Params3gpp object
+   *
+   * It neither logs nor copies a Ptr, so the bulk update runs it in the workers.
    */
-  void CalLongTerm (Ptr<Params3gpp> params) const;
+  void CalLongTerm (Params3gpp *params) const;
 
   /**
    * Compute the BF gain, apply frequency selectivity by phase-shifting with the cluster delays
@@ -310,10 +341,11 @@ private:
    * @params the BS height (i.e., eNB)
    * @params the UT height (i.e., UE)
    * @params the 2D distance
-   * @return the ParamsTable structure
+   * @return the ParamsTable structure, from the MmWave3gppParamsTableStore
+   * if ParamsTableCache is true
    */
-  Ptr<ParamsTable> Get3gppTable (bool los, bool o2i,
-                                 double hBS, double hUT, double distance2D) const;
+  ParamsTable Get3gppTable (bool los, bool o2i,
+                            double hBS, double hUT, double distance2D) const;
 
   /**
    * Delete the m_channel entry associated to the Params3gpp object of pair (a,b)
@@ -323,6 +355,34 @@ private:
    */
   void DeleteChannel (Ptr<const MobilityModel> a,
                       Ptr<const MobilityModel> b) const;
+
+  /**
+   * Make sure that the periodic event of the bulk update is scheduled
+   */
+  void ScheduleBulkUpdate () const;
+
+  /**
+   * The periodic event of the bulk update: update, with the spatial consistency
+   * procedure, the channel of all the links generated at least UpdatePeriod
+   * ago, and compute their long term components in parallel
+   *
+   * Only the links that are current in the link table of the propagation
+   * loss model (see MmWave3gppLinkTable::IsLinkCurrent) are updated here,
+   * since their condition holds at the current position of the nodes. The
+   * channel of a link whose node moved is only marked, and it is updated at
+   * the next transmission, as without the bulk update; the channel of a
+   * link removed from the table (see LinkIdleHorizon) is removed as well.
+   * The links are updated in the order of their node IDs, and the current
+   * beamforming vector of the antennas is restored after each link, so that
+   * the update does not depend on the addresses of the devices.
+   */
+  void BulkUpdate () const;
+
+  /**
+   * \return the link table of the propagation loss model, which holds the
+   * channel condition of the links
+   */
+  const MmWave3gppLinkTable & GetConditionLinkTable () const;
   /*
    * Returns the attenuation of each cluster in dB after applying blockage model
    * @params the channel realizationin as a Params3gpp object
@@ -336,6 +396,17 @@ private:
 
   mutable std::map< key_t, int > m_connectedPair;
   mutable std::map< key_t, Ptr<Params3gpp> > m_channelMap;
+  mutable std::map<key_t, EventId> m_deleteChannelEvents; //!< The DeleteChannel scheduled for each channel
+
+  /**
+   * \brief Schedule the DeleteChannel of a channel, and keep its event
+   * \param key the channel
+   * \param delay the delay of DeleteChannel
+   * \param a the mobility model of the transmitter
+   * \param b the mobility model of the receiver
+   */
+  void ScheduleDeleteChannel (const key_t &key, Time delay, Ptr<const MobilityModel> a,
+                              Ptr<const MobilityModel> b) const;
 
   Ptr<UniformRandomVariable> m_uniformRv;
   Ptr<UniformRandomVariable> m_uniformRvBlockage;
@@ -347,8 +418,15 @@ private:
   Ptr<ExponentialRandomVariable> m_expRv;
   Ptr<MmWavePhyMacCommon> m_phyMacConfig;
   Ptr<PropagationLossModel> m_3gppPathloss;
-  Ptr<ParamsTable> m_table3gpp;
   Time m_updatePeriod;
+  bool m_bulkUpdate {false}; //!< True to update all the channels in a single periodic event
+  bool m_paramsTableCache {true}; //!< True to take the ParamsTable from the MmWave3gppParamsTableStore
+  double m_paramsTableResolution {0.0}; //!< Resolution of the heights and distance of the stored ParamsTable, in m
+  mutable EventId m_bulkUpdateEvent; //!< The next bulk update
+  mutable bool m_deferLongTerm {false}; //!< True while the bulk update collects the long term components
+  mutable std::vector<Params3gpp *> m_pendingLongTerm; //!< Channels whose long term component is deferred
+  mutable MmWaveWorkerPool m_workers; //!< Threads of the bulk update
+  TracedCallback<uint32_t> m_linksUpdatedTrace; //!< Number of links updated by each bulk update
   bool m_cellScan;
   bool m_blockage;
   uint16_t m_numNonSelfBloking; //number of non-self-blocking regions.
@@ -0,0 +1,278 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-3gpp-link-table.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/simulator.h>
+#include <ns3/node.h>
+#include <ns3/mmwave-ue-net-device.h>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWave3gppLinkTable");
+
+void
+MmWave3gppLinkTable::SetIdleHorizon (Time horizon)
+{
+  m_idleHorizon = horizon;
+}
+
+Time
+MmWave3gppLinkTable::GetIdleHorizon () const
+{
+  return m_idleHorizon;
+}
+
+size_t
+MmWave3gppLinkTable::GetNumNodes () const
+{
+  return m_nodes.size ();
+}
+
+size_t
+MmWave3gppLinkTable::GetNumLinks () const
+{
+  return m_numLinks;
+}
+
+uint32_t
+MmWave3gppLinkTable::TakeIndex (Role role)
+{
+  if (m_freeIndexes[role].empty ())
+    {
+      return m_numIndexes[role]++;
+    }
+  uint32_t index = m_freeIndexes[role].back ();
+  m_freeIndexes[role].pop_back ();
+  return index;
+}
+
+MmWave3gppLinkTable::NodeState &
+MmWave3gppLinkTable::Touch (const Ptr<MobilityModel> &mob)
+{
+  const Vector pos = mob->GetPosition ();
+  auto it = m_nodes.find (PeekPointer (mob));
+  if (it == m_nodes.end ())
+    {
+      NodeState node;
+      node.m_mobility = mob;
+      node.m_role = DynamicCast<MmWaveUeNetDevice> (mob->GetObject<Node> ()->GetDevice (0)) != 0 ? UE : GNB;
+      node.m_index = TakeIndex (node.m_role);
+      node.m_position = pos;
+      node.m_epoch = 1;
+      it = m_nodes.emplace (PeekPointer (mob), node).first;
+      if (node.m_role == UE && node.m_index >= m_rows.size ())
+        {
+          m_rows.resize (node.m_index + 1);
+        }
+      NS_LOG_LOGIC ("New node " << mob << " role " << node.m_role << " index " << node.m_index);
+    }
+  else if (pos.x != it->second.m_position.x || pos.y != it->second.m_position.y
+           || pos.z != it->second.m_position.z)
+    {
+      it->second.m_position = pos;
+      ++it->second.m_epoch;
+    }
+  it->second.m_lastUse = Simulator::Now ();
+  return it->second;
+}
+
+MmWave3gppLinkTable::Link
+MmWave3gppLinkTable::GetLink (const Ptr<MobilityModel> &a, const Ptr<MobilityModel> &b)
+{
+  if (m_idleHorizon > Seconds (0) && Simulator::Now () - m_lastEviction >= m_idleHorizon)
+    {
+      Evict ();
+    }
+
+  const NodeState &nodeA = Touch (a);
+  const NodeState &nodeB = Touch (b);
+
+  Link link;
+  if (nodeA.m_role == nodeB.m_role)
+    {
+      link.m_ue = &nodeA;
+      link.m_gnb = &nodeB;
+      return link;
+    }
+  link.m_ue = nodeA.m_role == UE ? &nodeA : &nodeB;
+  link.m_gnb = nodeA.m_role == UE ? &nodeB : &nodeA;
+
+  Row &row = m_rows[link.m_ue->m_index];
+  if (link.m_gnb->m_index >= row.size ())
+    {
+      row.resize (link.m_gnb->m_index + 1);
+    }
+  LinkState &state = row[link.m_gnb->m_index];
+  if (! state.m_used)
+    {
+      state = LinkState ();
+      state.m_used = true;
+      ++m_numLinks;
+    }
+  if (state.m_ueEpoch != link.m_ue->m_epoch || state.m_gnbEpoch != link.m_gnb->m_epoch)
+    {
+      const Vector &uePos = link.m_ue->m_position;
+      const Vector &gnbPos = link.m_gnb->m_position;
+      const double x = uePos.x - gnbPos.x;
+      const double y = uePos.y - gnbPos.y;
+      state.m_distance2D = std::sqrt (x * x + y * y);
+      state.m_distance3D = CalculateDistance (nodeA.m_position, nodeB.m_position);
+      state.m_ueEpoch = link.m_ue->m_epoch;
+      state.m_gnbEpoch = link.m_gnb->m_epoch;
+    }
+  state.m_lastUse = Simulator::Now ();
+  link.m_state = &state;
+  return link;
+}
+
+const MmWave3gppLinkTable::LinkState *
+MmWave3gppLinkTable::FindLink (const Ptr<MobilityModel> &a, const Ptr<MobilityModel> &b) const
+{
+  auto itA = m_nodes.find (PeekPointer (a));
+  auto itB = m_nodes.find (PeekPointer (b));
+  if (itA == m_nodes.end () || itB == m_nodes.end () || itA->second.m_role == itB->second.m_role)
+    {
+      return nullptr;
+    }
+  const NodeState &ue = itA->second.m_role == UE ? itA->second : itB->second;
+  const NodeState &gnb = itA->second.m_role == UE ? itB->second : itA->second;
+  const Row &row = m_rows[ue.m_index];
+  if (gnb.m_index >= row.size () || ! row[gnb.m_index].m_used || ! row[gnb.m_index].m_valid)
+    {
+      return nullptr;
+    }
+  return &row[gnb.m_index];
+}
+
+bool
+MmWave3gppLinkTable::IsLinkCurrent (const Ptr<MobilityModel> &a, const Ptr<MobilityModel> &b) const
+{
+  if (FindLink (a, b) == nullptr)
+    {
+      return false;
+    }
+  for (const Ptr<MobilityModel> &mob : {a, b})
+    {
+      const Vector pos = mob->GetPosition ();
+      const Vector &seen = m_nodes.at (PeekPointer (mob)).m_position;
+      if (pos.x != seen.x || pos.y != seen.y || pos.z != seen.z)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MmWave3gppLinkTable::ForEachLink (const std::function<void (const Ptr<MobilityModel> &ue, const Ptr<MobilityModel> &gnb,
+                                                            const LinkState &state)> &f) const
+{
+  std::vector<const NodeState *> byIndex[2];
+  for (const auto & node : m_nodes)
+    {
+      std::vector<const NodeState *> &nodes = byIndex[node.second.m_role];
+      if (node.second.m_index >= nodes.size ())
+        {
+          nodes.resize (node.second.m_index + 1, nullptr);
+        }
+      nodes[node.second.m_index] = &node.second;
+    }
+
+  for (uint32_t ue = 0; ue < m_rows.size () && ue < byIndex[UE].size (); ++ue)
+    {
+      if (byIndex[UE][ue] == nullptr)
+        {
+          continue;
+        }
+      for (uint32_t gnb = 0; gnb < m_rows[ue].size () && gnb < byIndex[GNB].size (); ++gnb)
+        {
+          const LinkState &state = m_rows[ue][gnb];
+          if (state.m_used && state.m_valid && byIndex[GNB][gnb] != nullptr)
+            {
+              f (byIndex[UE][ue]->m_mobility, byIndex[GNB][gnb]->m_mobility, state);
+            }
+        }
+    }
+}
+
+void
+MmWave3gppLinkTable::RestoreLink (const Ptr<MobilityModel> &ue, const Ptr<MobilityModel> &gnb, const LinkState &saved)
+{
+  Link link = GetLink (ue, gnb);
+  NS_ABORT_MSG_IF (link.m_state == nullptr, "Cannot restore a link between two nodes of the same role");
+  LinkState &state = *link.m_state;
+  state.m_valid = true;
+  state.m_condition = saved.m_condition;
+  state.m_conditionUeEpoch = link.m_ue->m_epoch;
+  state.m_conditionGnbEpoch = link.m_gnb->m_epoch;
+  state.m_shadowing = saved.m_shadowing;
+  state.m_shadowingPosition = saved.m_shadowingPosition;
+  // The epochs start from 1, so 0 makes the next use correlate the shadowing
+  // with the distance from the saved position
+  const Vector &uePos = link.m_ue->m_position;
+  const bool samePosition = uePos.x == saved.m_shadowingPosition.x && uePos.y == saved.m_shadowingPosition.y
+    && uePos.z == saved.m_shadowingPosition.z;
+  state.m_shadowingEpoch = samePosition ? link.m_ue->m_epoch : 0;
+  state.m_hE = saved.m_hE;
+  state.m_carPenetrationLoss = saved.m_carPenetrationLoss;
+  state.m_shadowingStd = saved.m_shadowingStd;
+  state.m_shadowingCorDistance = saved.m_shadowingCorDistance;
+  state.m_lossGeneration = 0;
+}
+
+void
+MmWave3gppLinkTable::Evict ()
+{
+  const Time now = Simulator::Now ();
+  m_lastEviction = now;
+
+  for (auto & row : m_rows)
+    {
+      for (auto & state : row)
+        {
+          if (state.m_used && now - state.m_lastUse > m_idleHorizon)
+            {
+              state = LinkState ();
+              --m_numLinks;
+            }
+        }
+    }
+
+  // The links of an idle node are idle too, so they are already removed
+  for (auto it = m_nodes.begin (); it != m_nodes.end (); )
+    {
+      if (now - it->second.m_lastUse > m_idleHorizon)
+        {
+          NS_LOG_LOGIC ("Removing idle node " << it->first << " index " << it->second.m_index);
+          if (it->second.m_role == UE)
+            {
+              Row ().swap (m_rows[it->second.m_index]);
+            }
+          m_freeIndexes[it->second.m_role].push_back (it->second.m_index);
+          it = m_nodes.erase (it);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,220 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <ns3/mobility-model.h>
+#include <ns3/nstime.h>
+#include <ns3/vector.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief State of the UE-gNB links seen by a 3GPP propagation loss model
+ *
+ * Each node gets a record the first time it is seen, with its role (UE or
+ * gNB, found once from the type of its first device) and a dense index among
+ * the nodes of the same role. The links are stored in one row per UE, indexed
+ * by the index of the gNB, so that a lookup is a hash of the mobility model of
+ * each node and two vector accesses. The state of a link is the same in both
+ * directions.
+ *
+ * Each record keeps the last position of its node, and a position epoch that
+ * is incremented every time the node is seen at a different position. The
+ * 2D and 3D distances of a link are recomputed only when the epoch of one of
+ * its nodes changes, and the owner can use the epochs to know whether the
+ * rest of the state of a link is still valid.
+ *
+ * With an idle horizon greater than zero, the links and the nodes that were not
+ * used for longer than the horizon are removed, and their rows and indexes are
+ * reused: the memory is proportional to the nodes and links used recently.
+ * A link used again after being removed is seen as new.
+ */
+class MmWave3gppLinkTable
+{
+public:
+  /**
+   * \brief The role of a node
+   */
+  enum Role
+  {
+    UE,  //!< A node whose first device is a MmWaveUeNetDevice
+    GNB  //!< Any other node
+  };
+
+  /**
+   * \brief The record of a node
+   */
+  struct NodeState
+  {
+    Ptr<MobilityModel> m_mobility; //!< Mobility model of the node
+    Role m_role {GNB};             //!< Role of the node
+    uint32_t m_index {0};          //!< Index among the nodes of the same role
+    Vector m_position;             //!< Last position seen
+    uint64_t m_epoch {0};          //!< Incremented when the position changes
+    Time m_lastUse;                //!< Last time the node was seen
+  };
+
+  /**
+   * \brief The state of a link
+   *
+   * m_valid and the fields after m_distance3D are not used by the table:
+   * they are owned by the propagation loss model, and reset when the link is new.
+   */
+  struct LinkState
+  {
+    bool m_used {false};           //!< True if the entry holds a link
+    bool m_valid {false};          //!< False if the link is new: the owner has to fill it
+    uint64_t m_ueEpoch {0};        //!< Epoch of the UE when the distances were computed
+    uint64_t m_gnbEpoch {0};       //!< Epoch of the gNB when the distances were computed
+    Time m_lastUse;                //!< Last time the link was used
+    double m_distance2D {0.0};     //!< Horizontal distance between UE and gNB
+    double m_distance3D {0.0};     //!< Distance between UE and gNB
+    char m_condition {0};          //!< Channel condition ('l', 'n', or 'i')
+    uint64_t m_conditionUeEpoch {0};  //!< Epoch of the UE at the last condition update
+    uint64_t m_conditionGnbEpoch {0}; //!< Epoch of the gNB at the last condition update
+    double m_shadowing {0.0};      //!< Shadowing, or indoor loss, in dB
+    Vector m_shadowingPosition;    //!< Position of the UE at the last shadowing update
+    uint64_t m_shadowingEpoch {0}; //!< Epoch of the UE at the last shadowing update
+    double m_hE {0.0};             //!< Effective environment height (Table 7.4.1-1 Note 1)
+    double m_carPenetrationLoss {0.0}; //!< Car penetration loss, in dB
+    uint64_t m_lossGeneration {0}; //!< Generation of the model when m_lossDb was computed, 0 if never
+    uint64_t m_lossUeEpoch {0};    //!< Epoch of the UE when m_lossDb was computed
+    uint64_t m_lossGnbEpoch {0};   //!< Epoch of the gNB when m_lossDb was computed
+    double m_lossDb {0.0};         //!< Path loss without shadowing, in dB
+    double m_shadowingStd {0.0};   //!< Standard deviation of the shadowing, in dB
+    double m_shadowingCorDistance {0.0}; //!< Correlation distance of the shadowing, in m
+  };
+
+  /**
+   * \brief The result of GetLink
+   */
+  struct Link
+  {
+    LinkState *m_state {nullptr};    //!< State of the link, nullptr if the nodes have the same role
+    const NodeState *m_ue {nullptr}; //!< Record of the UE (of the first node if same role)
+    const NodeState *m_gnb {nullptr}; //!< Record of the gNB (of the second node if same role)
+  };
+
+  /**
+   * \brief Set the idle horizon
+   * \param horizon links and nodes not used for longer are removed; zero
+   * (the default) means that nothing is removed
+   */
+  void SetIdleHorizon (Time horizon);
+
+  /**
+   * \return the idle horizon
+   */
+  Time GetIdleHorizon () const;
+
+  /**
+   * \brief Get the link between two nodes, creating it if needed, and refresh
+   * the position of the nodes and the distances
+   * \param a mobility model of a node
+   * \param b mobility model of the other node
+   * \return the link; the pointers are valid until the next call
+   */
+  Link GetLink (const Ptr<MobilityModel> &a, const Ptr<MobilityModel> &b);
+
+  /**
+   * \brief Find the link between two nodes, without refreshing anything
+   * \param a mobility model of a node
+   * \param b mobility model of the other node
+   * \return the state of the link, or nullptr if it does not exist or it
+   * has not been filled by the owner
+   */
+  const LinkState * FindLink (const Ptr<MobilityModel> &a, const Ptr<MobilityModel> &b) const;
+
+  /**
+   * \brief Check whether the link between two nodes is up to date, without
+   * refreshing anything
+   * \param a mobility model of a node
+   * \param b mobility model of the other node
+   * \return true if FindLink finds the link, and the nodes are still where
+   * the table saw them last, so that its distances and condition hold
+   */
+  bool IsLinkCurrent (const Ptr<MobilityModel> &a, const Ptr<MobilityModel> &b) const;
+
+  /**
+   * \brief Call a function on each link filled by the owner, in the order
+   * of the UE indexes and then of the gNB indexes
+   * \param f the function, called with the mobility models of the UE and of
+   * the gNB, and the state of the link
+   */
+  void ForEachLink (const std::function<void (const Ptr<MobilityModel> &ue, const Ptr<MobilityModel> &gnb,
+                                              const LinkState &state)> &f) const;
+
+  /**
+   * \brief Restore a link, as seen by ForEachLink in a previous run
+   * \param ue mobility model of the UE
+   * \param gnb mobility model of the gNB
+   * \param saved the state of the link; only the fields owned by the
+   * propagation loss model are used, except the path loss, which is
+   * computed again
+   *
+   * The condition and the shadowing are taken as updated at the current
+   * position of the nodes; if the UE is not where the shadowing was
+   * updated, it is correlated again at the next use.
+   */
+  void RestoreLink (const Ptr<MobilityModel> &ue, const Ptr<MobilityModel> &gnb, const LinkState &saved);
+
+  /**
+   * \return the number of nodes in the table
+   */
+  size_t GetNumNodes () const;
+
+  /**
+   * \return the number of links in the table
+   */
+  size_t GetNumLinks () const;
+
+private:
+  /**
+   * \brief Find or create the record of a node, and refresh its position
+   * \param mob mobility model of the node
+   * \return the record
+   */
+  NodeState & Touch (const Ptr<MobilityModel> &mob);
+
+  /**
+   * \brief Remove the links and the nodes not used for longer than the horizon
+   */
+  void Evict ();
+
+  /**
+   * \brief Take a free index of a role
+   * \param role the role
+   * \return the index
+   */
+  uint32_t TakeIndex (Role role);
+
+  typedef std::vector<LinkState> Row; //!< The links of a UE, indexed by gNB
+
+  std::unordered_map<const MobilityModel *, NodeState> m_nodes; //!< The records, by mobility model
+  std::vector<Row> m_rows;                   //!< The links, indexed by UE
+  std::vector<uint32_t> m_freeIndexes[2];    //!< Free indexes of each role
+  uint32_t m_numIndexes[2] {0, 0};           //!< Indexes ever used of each role
+  size_t m_numLinks {0};                     //!< Number of entries in use
+  Time m_idleHorizon {Seconds (0)};          //!< Idle horizon, zero if disabled
+  Time m_lastEviction {Seconds (0)};         //!< Last time Evict() ran
+};
+
+} // namespace ns3
@@ -0,0 +1,460 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*
+*   Author: Marco Mezzavilla < mezzavilla@nyu.edu>
+*           Sourjya Dutta <sdutta@nyu.edu>
+*           Russell Ford <russell.ford@nyu.edu>
+*           Menglei Zhang <menglei@nyu.edu>
+*/
+
+#include "mmwave-3gpp-params-table.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWave3gppParamsTable");
+
+/*
+ * The cross correlation matrix is constructed according to table 7.5-6.
+ * All the square root matrix is being generated using the Cholesky decomposition
+ * and following the order of [SF,K,DS,ASD,ASA,ZSD,ZSA].
+ * The parameter K is ignored in NLOS.
+ *
+ * The Matlab file to generate the matrices can be found in the mmwave/model/BeamFormingMatrix/SqrtMatrix.m
+ * */
+static const double sqrtC_RMa_LOS[7][7] = {
+  {1, 0, 0, 0, 0, 0, 0},
+  {0, 1, 0, 0, 0, 0, 0},
+  {-0.5, 0, 0.866025, 0, 0, 0, 0},
+  {0, 0, 0, 1, 0, 0, 0},
+  {0, 0, 0, 0, 1, 0, 0},
+  {0, 0, 0, 0.5, -0, 0.866025, 0},
+  {-0.8, 0, -0.46188, 0, 0, 0, 0.382971},
+};
+
+static const double sqrtC_RMa_NLOS[6][6] = {
+  {1, 0, 0, 0, 0, 0},
+  {-0.5, 0.866025, 0, 0, 0, 0},
+  {0.6, -0.11547, 0.791623, 0, 0, 0},
+  {0, 0, 0, 1, 0, 0},
+  {0, -0.57735, 0.547399, 0, 0.605823, 0},
+  {-0.4, -0.23094, 0.143166, 0, -0.349446, 0.802532},
+};
+
+static const double sqrtC_UMa_LOS[7][7] = {
+  {1, 0, 0, 0, 0, 0, 0},
+  {0, 1, 0, 0, 0, 0, 0},
+  {-0.4, -0.4, 0.824621, 0, 0, 0, 0},
+  {-0.5, 0, 0.242536, 0.83137, 0, 0, 0},
+  {-0.5, -0.2, 0.630593, -0.484671, 0.278293, 0, 0},
+  {0, 0, -0.242536, 0.672172, 0.642214, 0.27735, 0},
+  {-0.8, 0, -0.388057, -0.367926, 0.238537, -3.58949e-15, 0.130931},
+};
+
+
+static const double sqrtC_UMa_NLOS[6][6] = {
+  {1, 0, 0, 0, 0, 0},
+  {-0.4, 0.916515, 0, 0, 0, 0},
+  {-0.6, 0.174574, 0.78072, 0, 0, 0},
+  {0, 0.654654, 0.365963, 0.661438, 0, 0},
+  {0, -0.545545, 0.762422, 0.118114, 0.327327, 0},
+  {-0.4, -0.174574, -0.396459, 0.392138, 0.49099, 0.507445},
+};
+
+static const double sqrtC_UMa_O2I[6][6] = {
+  {1, 0, 0, 0, 0, 0},
+  {-0.5, 0.866025, 0, 0, 0, 0},
+  {0, 0.46188, 0.886942, 0, 0, 0},
+  {0.53, 0.305996, -0.159349, 0.774645, 0, 0},
+  {0, 0, 0, 0, 1, 0},
+  {0.4, -0.381051, 0.671972, 0.0150753, -0, 0.492978},
+
+};
+
+static const double sqrtC_UMi_LOS[7][7] = {
+  {1, 0, 0, 0, 0, 0, 0},
+  {0.5, 0.866025, 0, 0, 0, 0, 0},
+  {-0.4, -0.57735, 0.711805, 0, 0, 0, 0},
+  {-0.5, 0.057735, 0.468293, 0.726201, 0, 0, 0},
+  {-0.4, -0.11547, 0.805464, -0.23482, 0.350363, 0, 0},
+  {0, 0, 0, 0.688514, 0.461454, 0.559471, 0},
+  {0, 0, 0.280976, 0.231921, -0.490509, 0.11916, 0.782603},
+};
+
+static const double sqrtC_UMi_NLOS[6][6] = {
+  {1, 0, 0, 0, 0, 0},
+  {-0.7, 0.714143, 0, 0, 0, 0},
+  {0, 0, 1, 0, 0, 0},
+  {-0.4, 0.168034, 0, 0.90098, 0, 0},
+  {0, -0.70014, 0.5, 0.130577, 0.4927, 0},
+  {0, 0, 0.5, 0.221981, -0.566238, 0.616522},
+};
+
+static const double sqrtC_UMi_O2I[6][6] = {
+  {1, 0, 0, 0, 0, 0},
+  {-0.5, 0.866025, 0, 0, 0, 0},
+  {0, 0.46188, 0.886942, 0, 0, 0},
+  {0.53, 0.305996, -0.159349, 0.774645, 0, 0},
+  {0, 0, 0, 0, 1, 0},
+  {0.4, -0.381051, 0.671972, 0.0150753, -0, 0.492978},
+};
+
+static const double sqrtC_office_LOS[7][7] = {
+  {1, 0, 0, 0, 0, 0, 0},
+  {0.5, 0.866025, 0, 0, 0, 0, 0},
+  {-0.8, -0.11547, 0.588784, 0, 0, 0, 0},
+  {-0.4, 0.23094, 0.520847, 0.717903, 0, 0, 0},
+  {-0.5, 0.288675, 0.73598, -0.348236, 0.0610847, 0, 0},
+  {0.2, -0.11547, 0.418943, 0.123222, -0.525329, 0.69282, 0},
+  {-0.1, 0.173205, 0.237778, -0.00535748, 0.378725, 0.490748, 0.720532},
+};
+
+static const double sqrtC_office_NLOS[6][6] = {
+  {1, 0, 0, 0, 0, 0},
+  {-0.5, 0.866025, 0, 0, 0, 0},
+  {0, 0.46188, 0.886942, 0, 0, 0},
+  {-0.4, -0.23094, 0.120263, 0.878751, 0, 0},
+  {0, -0.11547, 0.398372, 0.0289317, 0.909466, 0},
+  {-0.1, -0.173205, 0.315691, -0.134243, 0.283816, 0.872792},
+};
+
+const uint32_t MmWave3gppParamsTableStore::MAX_SIZE = 16384;
+
+bool
+MmWave3gppParamsTableStore::Key::operator< (const Key &o) const
+{
+  return std::tie (m_fcGHz, m_los, m_o2i, m_hBS, m_hUT, m_distance2D, m_scenario)
+         < std::tie (o.m_fcGHz, o.m_los, o.m_o2i, o.m_hBS, o.m_hUT, o.m_distance2D, o.m_scenario);
+}
+
+std::map<MmWave3gppParamsTableStore::Key, MmWave3gppParamsTableStore::Entry> &
+MmWave3gppParamsTableStore::GetTables ()
+{
+  static std::map<Key, Entry> tables;
+  return tables;
+}
+
+std::list<MmWave3gppParamsTableStore::Key> &
+MmWave3gppParamsTableStore::GetLru ()
+{
+  static std::list<Key> lru;
+  return lru;
+}
+
+std::mutex &
+MmWave3gppParamsTableStore::GetMutex ()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+double
+MmWave3gppParamsTableStore::Quantize (double value, double resolution)
+{
+  NS_ASSERT (resolution > 0.0);
+  return std::max (resolution, std::round (value / resolution) * resolution);
+}
+
+ParamsTable
+MmWave3gppParamsTableStore::Get (const std::string &scenario, double fcGHz, bool los, bool o2i,
+                                 double hBS, double hUT, double distance2D, double resolution)
+{
+  NS_ASSERT (resolution >= 0.0);
+  const bool dependsOnLink = scenario == "UMa" || scenario == "UMi-StreetCanyon" || (scenario == "RMa" && ! los);
+  if (dependsOnLink)
+    {
+      if (resolution == 0.0)
+        {
+          return Compute (scenario, fcGHz, los, o2i, hBS, hUT, distance2D);
+        }
+      hBS = Quantize (hBS, resolution);
+      hUT = Quantize (hUT, resolution);
+      distance2D = Quantize (distance2D, resolution);
+    }
+
+  // Leave out of the key the inputs that the table of Compute does not use
+  Key key;
+  key.m_scenario = scenario;
+  key.m_fcGHz = fcGHz;
+  key.m_los = los;
+  key.m_o2i = o2i;
+  key.m_hBS = 0.0;
+  key.m_hUT = 0.0;
+  key.m_distance2D = 0.0;
+  if (scenario == "RMa")
+    {
+      key.m_o2i = false;
+      key.m_distance2D = los ? 0.0 : distance2D;
+    }
+  else if (scenario == "UMa")
+    {
+      key.m_hUT = hUT;
+      key.m_distance2D = distance2D;
+    }
+  else if (scenario == "UMi-StreetCanyon")
+    {
+      key.m_hBS = hBS;
+      key.m_hUT = hUT;
+      key.m_distance2D = distance2D;
+    }
+  else if (scenario != "InH-OfficeMixed" && scenario != "InH-OfficeOpen" && scenario != "InH-ShoppingMall")
+    {
+      return Compute (scenario, fcGHz, los, o2i, hBS, hUT, distance2D);
+    }
+
+  {
+    std::lock_guard<std::mutex> lock (GetMutex ());
+    auto it = GetTables ().find (key);
+    if (it != GetTables ().end ())
+      {
+        GetLru ().splice (GetLru ().begin (), GetLru (), it->second.m_lru);
+        return it->second.m_table;
+      }
+  }
+
+  // Computed without the lock, so that the other threads are not blocked;
+  // with the rounded heights and distance, so that it does not depend on
+  // the link that added it
+  ParamsTable table = Compute (scenario, fcGHz, los, o2i, hBS, hUT, distance2D);
+  std::lock_guard<std::mutex> lock (GetMutex ());
+  if (GetTables ().count (key) > 0)
+    {
+      // Added by another thread in the meantime
+      return table;
+    }
+  if (GetTables ().size () >= MAX_SIZE)
+    {
+      GetTables ().erase (GetLru ().back ());
+      GetLru ().pop_back ();
+    }
+  GetLru ().push_front (key);
+  Entry entry;
+  entry.m_table = table;
+  entry.m_lru = GetLru ().begin ();
+  GetTables ().insert (std::make_pair (key, entry));
+  return table;
+}
+
+void
+MmWave3gppParamsTableStore::Clear ()
+{
+  std::lock_guard<std::mutex> lock (GetMutex ());
+  GetTables ().clear ();
+  GetLru ().clear ();
+}
+
+uint32_t
+MmWave3gppParamsTableStore::GetSize ()
+{
+  std::lock_guard<std::mutex> lock (GetMutex ());
+  return static_cast<uint32_t> (GetTables ().size ());
+}
+
+ParamsTable
+MmWave3gppParamsTableStore::Compute (const std::string &scenario, double fcGHz, bool los, bool o2i,
+                                     double hBS, double hUT, double distance2D)
+{
+  ParamsTable table3gpp;
+  // table3gpp includes the following parameters:
+  // numOfCluster, raysPerCluster, uLgDS, sigLgDS, uLgASD, sigLgASD,
+  // uLgASA, sigLgASA, uLgZSA, sigLgZSA, uLgZSD, sigLgZSD, offsetZOD,
+  // cDS, cASD, cASA, cZSA, uK, sigK, rTau, shadowingStd
+
+  //In NLOS case, parameter uK and sigK are not used and 0 is passed into the SetParams() function.
+  if (scenario == "RMa")
+    {
+      //For RMa, the outdoor LOS/NLOS and o2i LOS/NLOS is the same.
+      if (los)
+        {
+          //3GPP mentioned that 3.91 ns should be used when the Cluster DS (cDS) entry is N/A.
+          table3gpp.SetParams (11, 20, -7.49, 0.55, 0.90, 0.38, 1.52, 0.24, 0.60, 0.16,
+                               0.3, 0.4, 0, 3.91e-9, 2, 3, 3, 7, 4, 3.8, 3);
+          for (uint8_t row = 0; row < 7; row++)
+            {
+              for (uint8_t column = 0; column < 7; column++)
+                {
+                  table3gpp.m_sqrtC[row][column] = sqrtC_RMa_LOS[row][column];
+                }
+            }
+        }
+      else
+        {
+          double offsetZod = atan ((35 - 5) / distance2D) - atan ((35 - 1.5) / distance2D);
+          table3gpp.SetParams (10, 20, -7.43, 0.48, 0.95, 0.45, 1.52, 0.13, 0.88, 0.16,
+                               0.3, 0.49, offsetZod, 3.91e-9, 2, 3, 3, 0, 0, 1.7,3);
+          for (uint8_t row = 0; row < 6; row++)
+            {
+              for (uint8_t column = 0; column < 6; column++)
+                {
+                  table3gpp.m_sqrtC[row][column] = sqrtC_RMa_NLOS[row][column];
+                }
+            }
+        }
+    }
+  else if (scenario == "UMa")
+    {
+      if (los && !o2i)
+        {
+          double uLgZSD = std::max (-0.5, -2.1 * distance2D / 1000 - 0.01 * (hUT - 1.5) + 0.75);
+          double cDs = std::max (0.25, -3.4084 * log10 (fcGHz) + 6.5622) * 1e-9;
+          table3gpp.SetParams (12, 20, -6.955 - 0.0963 * log10 (fcGHz), 0.66, 1.06 + 0.1114 * log10 (fcGHz),
+                               0.28, 1.81, 0.20, 0.95, 0.16, uLgZSD, 0.40, 0, cDs, 5, 11, 7, 9, 3.5, 2.5, 3);
+          for (uint8_t row = 0; row < 7; row++)
+            {
+              for (uint8_t column = 0; column < 7; column++)
+                {
+                  table3gpp.m_sqrtC[row][column] = sqrtC_UMa_LOS[row][column];
+                }
+            }
+        }
+      else
+        {
+          double uLgZSD = std::max (-0.5, -2.1 * distance2D / 1000 - 0.01 * (hUT - 1.5) + 0.9);
+
+          double afc = 0.208 * log10 (fcGHz) - 0.782;
+          double bfc = 25;
+          double cfc = -0.13 * log10 (fcGHz) + 2.03;
+          double efc = 7.66 * log10 (fcGHz) - 5.96;
+
+          double offsetZOD = efc - std::pow (10, afc * log10 (std::max (bfc,distance2D)) + cfc);
+          double cDS = std::max (0.25, -3.4084 * log10 (fcGHz) + 6.5622) * 1e-9;
+
+          if (!los && !o2i)
+            {
+              table3gpp.SetParams (20, 20, -6.28 - 0.204 * log10 (fcGHz), 0.39, 1.5 - 0.1144 * log10 (fcGHz),
+                                   0.28, 2.08 - 0.27 * log10 (fcGHz), 0.11, -0.3236 * log10 (fcGHz) + 1.512, 0.16, uLgZSD,
+                                   0.49, offsetZOD, cDS, 2, 15, 7, 0, 0, 2.3, 3);
+              for (uint8_t row = 0; row < 6; row++)
+                {
+                  for (uint8_t column = 0; column < 6; column++)
+                    {
+                      table3gpp.m_sqrtC[row][column] = sqrtC_UMa_NLOS[row][column];
+                    }
+                }
+            }
+          else//(o2i)
+            {
+              table3gpp.SetParams (12, 20, -6.62, 0.32, 1.25, 0.42, 1.76, 0.16, 1.01, 0.43,
+                                   uLgZSD, 0.49, offsetZOD, 11e-9, 5, 20, 6, 0, 0, 2.2, 4);
+              for (uint8_t row = 0; row < 6; row++)
+                {
+                  for (uint8_t column = 0; column < 6; column++)
+                    {
+                      table3gpp.m_sqrtC[row][column] = sqrtC_UMa_O2I[row][column];
+                    }
+                }
+
+            }
+
+        }
+
+    }
+  else if (scenario == "UMi-StreetCanyon")
+    {
+      if (los && !o2i)
+        {
+          double uLgZSD = std::max (-0.21, -14.8 * distance2D / 1000 + 0.01 * std::abs (hUT - hBS) + 0.83);
+          table3gpp.SetParams (12, 20, -0.24 * log10 (1 + fcGHz) - 7.14, 0.38, -0.05 * log10 (1 + fcGHz) + 1.21, 0.41,
+                               -0.08 * log10 (1 + fcGHz) + 1.73, 0.014 * log10 (1 + fcGHz) + 0.28, -0.1 * log10 (1 + fcGHz) + 0.73, -0.04 * log10 (1 + fcGHz) + 0.34,
+                               uLgZSD, 0.35, 0, 5e-9, 3, 17, 7, 9, 5, 3, 3);
+          for (uint8_t row = 0; row < 7; row++)
+            {
+              for (uint8_t column = 0; column < 7; column++)
+                {
+                  table3gpp.m_sqrtC[row][column] = sqrtC_UMi_LOS[row][column];
+                }
+            }
+        }
+      else
+        {
+          double uLgZSD = std::max (-0.5, -3.1 * distance2D / 1000 + 0.01 * std::max (hUT - hBS,0.0) + 0.2);
+          double offsetZOD = -1 * std::pow (10, -1.5 * log10 (std::max (10.0, distance2D)) + 3.3);
+          if (!los && !o2i)
+            {
+              table3gpp.SetParams (19, 20, -0.24 * log10 (1 + fcGHz) - 6.83, 0.16 * log10 (1 + fcGHz) + 0.28, -0.23 * log10 (1 + fcGHz) + 1.53,
+                                   0.11 * log10 (1 + fcGHz) + 0.33, -0.08 * log10 (1 + fcGHz) + 1.81, 0.05 * log10 (1 + fcGHz) + 0.3,
+                                   -0.04 * log10 (1 + fcGHz) + 0.92, -0.07 * log10 (1 + fcGHz) + 0.41, uLgZSD, 0.35, offsetZOD,
+                                   11e-9, 10, 22, 7, 0, 0, 2.1, 3);
+              for (uint8_t row = 0; row < 6; row++)
+                {
+                  for (uint8_t column = 0; column < 6; column++)
+                    {
+                      table3gpp.m_sqrtC[row][column] = sqrtC_UMi_NLOS[row][column];
+                    }
+                }
+            }
+          else//(o2i)
+            {
+              table3gpp.SetParams (12, 20, -6.62, 0.32, 1.25, 0.42, 1.76, 0.16, 1.01, 0.43,
+                                   uLgZSD, 0.35, offsetZOD, 11e-9, 5, 20, 6, 0, 0, 2.2, 4);
+              for (uint8_t row = 0; row < 6; row++)
+                {
+                  for (uint8_t column = 0; column < 6; column++)
+                    {
+                      table3gpp.m_sqrtC[row][column] = sqrtC_UMi_O2I[row][column];
+                    }
+                }
+            }
+        }
+    }
+  else if (scenario == "InH-OfficeMixed"||scenario == "InH-OfficeOpen" || scenario == "InH-ShoppingMall")
+    {
+      NS_ASSERT_MSG (!o2i, "The indoor scenario does out support outdoor to indoor");
+      if (los)
+        {
+          table3gpp.SetParams (8, 20, -0.01 * log10 (1 + fcGHz) - 7.79, -0.16 * log10 (1 + fcGHz) + 0.50, 1.60, 0.18,
+                               -0.19 * log10 (1 + fcGHz) + 1.86, 0.12 * log10 (1 + fcGHz), -0.26 * log10 (1 + fcGHz) + 1.21, -0.04 * log10 (1 + fcGHz) + 0.17,
+                               -1.43 * log10 (1 + fcGHz) + 2.25, 0.13 * log10 (1 + fcGHz) + 0.15, 0, 3.91e-9, 7, -6.2 * log10 (1 + fcGHz) + 16.72,
+                               -3.85 * log10 (1 + fcGHz) + 10.28, 0.84 * log10 (1 + fcGHz) + 2.12, -0.58 * log10 (1 + fcGHz) + 6.19, 2.15, 6);
+          for (uint8_t row = 0; row < 7; row++)
+            {
+              for (uint8_t column = 0; column < 7; column++)
+                {
+                  table3gpp.m_sqrtC[row][column] = sqrtC_office_LOS[row][column];
+                }
+            }
+        }
+      else
+        {
+          table3gpp.SetParams (10, 20, -0.28 * log10 (1 + fcGHz) - 7.29, 0.1 * log10 (1 + fcGHz) + 0.11, 1.49, 0.17,
+                               -0.11 * log10 (1 + fcGHz) + 1.8, 0.12 * log10 (1 + fcGHz), -0.15 * log10 (1 + fcGHz) + 1.04, -0.09 * log10 (1 + fcGHz) + 0.24,
+                               1.37, 0.38, 0, 3.91e-9, 3, -13.0 * log10 (1 + fcGHz) + 30.53, -3.72 * log10 (1 + fcGHz) + 10.25, 0, 0, 1.84, 3);
+          for (uint8_t row = 0; row < 6; row++)
+            {
+              for (uint8_t column = 0; column < 6; column++)
+                {
+                  table3gpp.m_sqrtC[row][column] = sqrtC_office_NLOS[row][column];
+                }
+            }
+        }
+    }
+  else
+    {
+      //Note that the InH-ShoppingMall scenario is not given in the table 7.5-6
+      NS_FATAL_ERROR ("unkonw scenarios");
+    }
+
+  return table3gpp;
+
+}
+
+}  //namespace ns3
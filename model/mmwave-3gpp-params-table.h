@@ -0,0 +1,223 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*
+*   Author: Marco Mezzavilla < mezzavilla@nyu.edu>
+*           Sourjya Dutta <sdutta@nyu.edu>
+*           Russell Ford <russell.ford@nyu.edu>
+*           Menglei Zhang <menglei@nyu.edu>
+*/
+#ifndef MMWAVE_3GPP_PARAMS_TABLE_H_
+#define MMWAVE_3GPP_PARAMS_TABLE_H_
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * Data structure that stores the parameters of 3GPP TR 38.900, Table 7.5-6, for a certain scenario
+ */
+struct ParamsTable
+{
+  uint8_t m_numOfCluster = 0;
+  uint8_t m_raysPerCluster = 0;
+  double m_uLgDS = 0;
+  double m_sigLgDS = 0;
+  double m_uLgASD = 0;
+  double m_sigLgASD = 0;
+  double m_uLgASA = 0;
+  double m_sigLgASA = 0;
+  double m_uLgZSA = 0;
+  double m_sigLgZSA = 0;
+  double m_uLgZSD = 0;
+  double m_sigLgZSD = 0;
+  double m_offsetZOD = 0;
+  double m_cDS = 0;
+  double m_cASD = 0;
+  double m_cASA = 0;
+  double m_cZSA = 0;
+  double m_uK = 0;
+  double m_sigK = 0;
+  double m_rTau = 0;
+  double m_shadowingStd = 0;
+
+  double m_sqrtC[7][7] {}; // square root of the cross correlation matrix (6x6 in NLOS)
+
+  ParamsTable ()
+  {
+  }
+  void SetParams (uint8_t numOfCluster, uint8_t raysPerCluster, double uLgDS, double sigLgDS,
+                  double uLgASD, double sigLgASD, double uLgASA, double sigLgASA,
+                  double uLgZSA, double sigLgZSA, double uLgZSD, double sigLgZSD, double offsetZOD,
+                  double cDS, double cASD, double cASA, double cZSA,
+                  double uK, double sigK, double rTau, double shadowingStd)
+  {
+    m_numOfCluster = numOfCluster;
+    m_raysPerCluster = raysPerCluster;
+    m_uLgDS = uLgDS;
+    m_sigLgDS = sigLgDS;
+    m_uLgASD = uLgASD;
+    m_sigLgASD = sigLgASD;
+    m_uLgASA = uLgASA;
+    m_sigLgASA = sigLgASA;
+    m_uLgZSA = uLgZSA;
+    m_sigLgZSA = sigLgZSA;
+    m_uLgZSD = uLgZSD;
+    m_sigLgZSD = sigLgZSD;
+    m_offsetZOD = offsetZOD;
+    m_cDS = cDS;
+    m_cASD = cASD;
+    m_cASA = cASA;
+    m_cZSA = cZSA;
+    m_uK = uK;
+    m_sigK = sigK;
+    m_rTau = rTau;
+    m_shadowingStd = shadowingStd;
+  }
+
+};
+
+/**
+ * \brief Process-wide store of the ParamsTable of the links
+ *
+ * A table depends only on the scenario, the carrier frequency, the LOS and
+ * O2I state and, for some scenarios and states, on the heights of the
+ * nodes and on their 2D distance. The store keeps the tables already
+ * computed, indexed by these inputs: the ones that the table does not
+ * depend on are left out of the index, so that, e.g., all the LOS links of
+ * a RMa scenario share the same table.
+ *
+ * The tables that depend on the heights and the distance (UMa,
+ * UMi-StreetCanyon and RMa NLOS) are stored only with a resolution greater
+ * than 0: the heights and the distance are rounded to the nearest multiple of
+ * the resolution (at least one resolution), and the table is the one computed
+ * with the rounded values. Each value then differs from the one of the link by
+ * at most half the resolution (one resolution below it). With a resolution of
+ * 0, these tables are computed for each link and not stored, since with
+ * moving nodes each update would have a new key.
+ *
+ * The store is shared by all the MmWave3gppChannel instances, and it can
+ * be used from several threads. When it holds MAX_SIZE tables, the one used
+ * least recently is removed before the next one is added.
+ */
+class MmWave3gppParamsTableStore
+{
+public:
+  /**
+   * \brief Get the table of a link, from the store or computed and stored
+   * \param scenario the scenario (RMa, UMa, UMi-StreetCanyon, InH-OfficeMixed,
+   * InH-OfficeOpen or InH-ShoppingMall)
+   * \param fcGHz the carrier frequency, in GHz
+   * \param los the los condition
+   * \param o2i the o2i condition
+   * \param hBS the BS height (i.e., eNB)
+   * \param hUT the UT height (i.e., UE)
+   * \param distance2D the 2D distance
+   * \param resolution the resolution of the heights and the distance, in m,
+   * or 0 to compute the tables that depend on them for each link
+   * \return the table
+   */
+  static ParamsTable Get (const std::string &scenario, double fcGHz, bool los, bool o2i,
+                          double hBS, double hUT, double distance2D, double resolution = 0.0);
+
+  /**
+   * \brief Round a height or a distance as Get does
+   * \param value the height or the distance, in m
+   * \param resolution the resolution, in m, greater than 0
+   * \return the nearest multiple of the resolution, at least the resolution
+   */
+  static double Quantize (double value, double resolution);
+
+  /**
+   * \brief Compute the table of a link, without the store
+   * \param scenario the scenario
+   * \param fcGHz the carrier frequency, in GHz
+   * \param los the los condition
+   * \param o2i the o2i condition
+   * \param hBS the BS height (i.e., eNB)
+   * \param hUT the UT height (i.e., UE)
+   * \param distance2D the 2D distance
+   * \return the table
+   */
+  static ParamsTable Compute (const std::string &scenario, double fcGHz, bool los, bool o2i,
+                              double hBS, double hUT, double distance2D);
+
+  /**
+   * \brief Remove all the tables
+   */
+  static void Clear ();
+
+  /**
+   * \return the number of tables in the store
+   */
+  static uint32_t GetSize ();
+
+  static const uint32_t MAX_SIZE; //!< Maximum number of tables in the store
+
+private:
+  /**
+   * \brief The inputs of a table
+   */
+  struct Key
+  {
+    std::string m_scenario; //!< Scenario
+    double m_fcGHz;         //!< Carrier frequency, in GHz
+    bool m_los;             //!< LOS condition
+    bool m_o2i;             //!< O2I condition
+    double m_hBS;           //!< BS height, 0 if the table does not depend on it
+    double m_hUT;           //!< UT height, 0 if the table does not depend on it
+    double m_distance2D;    //!< 2D distance, 0 if the table does not depend on it
+
+    /**
+     * \param o another key
+     * \return true if this key comes before o
+     */
+    bool operator< (const Key &o) const;
+  };
+
+  /**
+   * \brief A table of the store
+   */
+  struct Entry
+  {
+    ParamsTable m_table;               //!< The table
+    std::list<Key>::iterator m_lru;    //!< Position of the key in GetLru
+  };
+
+  /**
+   * \return the tables of the store
+   */
+  static std::map<Key, Entry> & GetTables ();
+
+  /**
+   * \return the keys of the tables of the store, the most recently used first
+   */
+  static std::list<Key> & GetLru ();
+
+  /**
+   * \return the mutex that protects the tables of the store
+   */
+  static std::mutex & GetMutex ();
+};
+
+}  //namespace ns3
+
+#endif /* MMWAVE_3GPP_PARAMS_TABLE_H_ */
@@ -30,9 +30,9 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
 #include <ns3/simulator.h>
-#include <ns3/mmwave-ue-net-device.h>
-#include <ns3/node.h>
+#include <ns3/nstime.h>
 using namespace ns3;
 
 
@@ -67,12 +67,14 @@ MmWave3gppPropagationLossModel::GetTypeId (void)
     .AddAttribute ("Scenario",
                    "The available channel scenarios are 'RMa', 'UMa', 'UMi-StreetCanyon', 'InH-OfficeMixed', 'InH-OfficeOpen', 'InH-ShoppingMall'",
                    StringValue ("RMa"),
-                   MakeStringAccessor (&MmWave3gppPropagationLossModel::m_scenario),
+                   MakeStringAccessor (&MmWave3gppPropagationLossModel::SetScenario,
+                                       &MmWave3gppPropagationLossModel::GetScenario),
                    MakeStringChecker ())
     .AddAttribute ("OptionalNlos",
                    "Use the optional NLoS propagation loss model",
                    BooleanValue (false),
-                   MakeBooleanAccessor (&MmWave3gppPropagationLossModel::m_optionNlosEnabled),
+                   MakeBooleanAccessor (&MmWave3gppPropagationLossModel::SetOptionalNlos,
+                                        &MmWave3gppPropagationLossModel::GetOptionalNlos),
                    MakeBooleanChecker ())
     .AddAttribute ("Shadowing",
                    "Enable shadowing effect",
@@ -84,13 +86,38 @@ MmWave3gppPropagationLossModel::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&MmWave3gppPropagationLossModel::m_inCar),
                    MakeBooleanChecker ())
+    .AddAttribute ("LinkIdleHorizon",
+                   "The channel condition and the shadowing of a link not used for longer "
+                   "than this time are removed, and drawn again if the link is used later. "
+                   "0 means that they are never removed.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MmWave3gppPropagationLossModel::SetLinkIdleHorizon,
+                                     &MmWave3gppPropagationLossModel::GetLinkIdleHorizon),
+                   MakeTimeChecker ())
+    .AddAttribute ("PathLossMemo",
+                   "Reuse the path loss (without shadowing) of a link when none of its "
+                   "nodes moved since the last evaluation",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MmWave3gppPropagationLossModel::m_pathLossMemo),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PathLossMemoHits",
+                   "Number of path loss evaluations that reused the previous one (read only)",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MmWave3gppPropagationLossModel::m_pathLossMemoHits),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("PathLossMemoMisses",
+                   "Number of path loss evaluations that were computed (read only)",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MmWave3gppPropagationLossModel::m_pathLossMemoMisses),
+                   MakeUintegerChecker<uint64_t> ())
   ;
   return tid;
 }
 
 MmWave3gppPropagationLossModel::MmWave3gppPropagationLossModel ()
 {
-  m_channelConditionMap.clear ();
   m_norVar = CreateObject<NormalRandomVariable> ();
   m_norVar->SetAttribute ("Mean", DoubleValue (0));
   m_norVar->SetAttribute ("Variance", DoubleValue (1));
@@ -117,6 +144,7 @@ MmWave3gppPropagationLossModel::SetFrequency (double frequency)
   m_frequency = frequency;
   static const double C = 299792458.0; // speed of light in vacuum
   m_lambda = C / frequency;
+  ++m_lossGeneration; // the path loss of the links has to be computed again
 }
 
 double
@@ -125,6 +153,38 @@ MmWave3gppPropagationLossModel::GetFrequency (void) const
   return m_frequency;
 }
 
+void
+MmWave3gppPropagationLossModel::SetScenario (const std::string &scenario)
+{
+  m_scenario = scenario;
+  ++m_lossGeneration; // the path loss of the links has to be computed again
+}
+
+void
+MmWave3gppPropagationLossModel::SetOptionalNlos (bool enabled)
+{
+  m_optionNlosEnabled = enabled;
+  ++m_lossGeneration; // the path loss of the links has to be computed again
+}
+
+bool
+MmWave3gppPropagationLossModel::GetOptionalNlos (void) const
+{
+  return m_optionNlosEnabled;
+}
+
+void
+MmWave3gppPropagationLossModel::SetLinkIdleHorizon (Time horizon)
+{
+  m_linkTable.SetIdleHorizon (horizon);
+}
+
+Time
+MmWave3gppPropagationLossModel::GetLinkIdleHorizon (void) const
+{
+  return m_linkTable.GetIdleHorizon ();
+}
+
 
 double
 MmWave3gppPropagationLossModel::DoCalcRxPower (double txPowerDbm,
@@ -137,44 +197,22 @@ MmWave3gppPropagationLossModel::DoCalcRxPower (double txPowerDbm,
 double
 MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
 {
-  Ptr<MobilityModel> ueMob, enbMob;
-  if (DynamicCast<MmWaveUeNetDevice> (a->GetObject<Node> ()->GetDevice (0)) != 0)
-    {
-      if (DynamicCast<MmWaveUeNetDevice> (b->GetObject<Node> ()->GetDevice (0)) != 0)
-        {
-          NS_LOG_INFO ("UE->UE Link, skip Pathloss computation");
-          return 0;
-        }
-      else
-        {
-          ueMob = a;
-          enbMob = b;
-        }
-    }
-  else
+  MmWave3gppLinkTable::Link link = m_linkTable.GetLink (a, b);
+  if (link.m_state == nullptr)
     {
-      if (DynamicCast<MmWaveUeNetDevice> (b->GetObject<Node> ()->GetDevice (0)) != 0)
-        {
-          ueMob = b;
-          enbMob = a;
-        }
-      else
-        {
-          NS_LOG_INFO ("ENB->ENB Link, skip Pathloss computation");
-          return 0;
-        }
+      NS_LOG_INFO ((link.m_ue->m_role == MmWave3gppLinkTable::UE ? "UE->UE" : "ENB->ENB")
+                   << " Link, skip Pathloss computation");
+      return 0;
     }
+  MmWave3gppLinkTable::LinkState &state = *link.m_state;
 
-
-  Vector uePos = ueMob->GetPosition ();
-  Vector enbPos = enbMob->GetPosition ();
-  double x = uePos.x - enbPos.x;
-  double y = uePos.y - enbPos.y;
-  double distance2D = sqrt (x * x + y * y);
+  const Vector &uePos = link.m_ue->m_position;
+  const Vector &enbPos = link.m_gnb->m_position;
+  double distance2D = state.m_distance2D;
   double hBs = enbPos.z;
   double hUt = uePos.z;
 
-  double distance3D = a->GetDistanceFrom (b);
+  double distance3D = state.m_distance3D;
 
   /*if (distance3D < 3*m_lambda)
   {
@@ -186,21 +224,17 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
     }
 
 
-  channelConditionMap_t::const_iterator it;
-  it = m_channelConditionMap.find (std::make_pair (a,b));
-  if (it == m_channelConditionMap.end ())
+  if (! state.m_valid)
     {
-      channelCondition condition;
-
       if (m_channelConditions.compare ("l") == 0 )
         {
-          condition.m_channelCondition = 'l';
-          //NS_LOG_ERROR (m_scenario << " scenario, channel condition is fixed to be " << condition.m_channelCondition<<", h_BS="<<hBs<<",h_UT="<<hUt);
+          state.m_condition = 'l';
+          //NS_LOG_ERROR (m_scenario << " scenario, channel condition is fixed to be " << state.m_condition<<", h_BS="<<hBs<<",h_UT="<<hUt);
         }
       else if (m_channelConditions.compare ("n") == 0)
         {
-          condition.m_channelCondition = 'n';
-          //NS_LOG_ERROR (m_scenario << " scenario, channel condition is fixed to be " << condition.m_channelCondition<<", h_BS="<<hBs<<",h_UT="<<hUt);
+          state.m_condition = 'n';
+          //NS_LOG_ERROR (m_scenario << " scenario, channel condition is fixed to be " << state.m_condition<<", h_BS="<<hBs<<",h_UT="<<hUt);
         }
       else if (m_channelConditions.compare ("a") == 0)
         {
@@ -295,14 +329,14 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
 
           if (PRef <= probLos)
             {
-              condition.m_channelCondition = 'l';
+              state.m_condition = 'l';
             }
           else
             {
-              condition.m_channelCondition = 'n';
+              state.m_condition = 'n';
             }
           //NS_LOG_ERROR (m_scenario << " scenario, 2D distance = " << distance2D <<"m, Prob_LOS = " << probLos
-          //             << ", Prob_REF = " << PRef << ", the channel condition is " << condition.m_channelCondition<<", h_BS="<<hBs<<",h_UT="<<hUt);
+          //             << ", Prob_REF = " << PRef << ", the channel condition is " << state.m_condition<<", h_BS="<<hBs<<",h_UT="<<hUt);
 
         }
       else
@@ -310,21 +344,110 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
           NS_FATAL_ERROR ("Wrong channel condition configuration");
         }
       // assign a large negative value to identify initial transmission.
-      condition.m_shadowing = -1e6;
-      condition.m_hE = 0;
-      condition.m_carPenetrationLoss = 9 + m_norVar->GetValue () * 5;
-      std::pair<channelConditionMap_t::const_iterator, bool> ret;
-      ret = m_channelConditionMap.insert (std::make_pair (std::make_pair (a,b), condition));
-      m_channelConditionMap.insert (std::make_pair (std::make_pair (b,a), condition));
-      it = ret.first;
+      state.m_shadowing = -1e6;
+      state.m_hE = 0;
+      state.m_carPenetrationLoss = 9 + m_norVar->GetValue () * 5;
+      state.m_valid = true;
     }
 
   /* Reminder.
    * The The LOS NLOS state transition will be implemented in the future as mentioned in secction 7.6.3.3
    * */
 
+  double lossDb = 0;
+  double shadowingStd = 0;
+  double shadowingCorDistance = 0;
+  if (m_pathLossMemo && state.m_lossGeneration == m_lossGeneration
+      && state.m_lossUeEpoch == link.m_ue->m_epoch && state.m_lossGnbEpoch == link.m_gnb->m_epoch)
+    {
+      // None of the nodes moved since the last evaluation
+      ++m_pathLossMemoHits;
+      lossDb = state.m_lossDb;
+      shadowingStd = state.m_shadowingStd;
+      shadowingCorDistance = state.m_shadowingCorDistance;
+    }
+  else
+    {
+      ++m_pathLossMemoMisses;
+      lossDb = GetDeterministicLoss (state, hBs, hUt, &shadowingStd, &shadowingCorDistance);
+      state.m_lossGeneration = m_lossGeneration;
+      state.m_lossUeEpoch = link.m_ue->m_epoch;
+      state.m_lossGnbEpoch = link.m_gnb->m_epoch;
+      state.m_lossDb = lossDb;
+      state.m_shadowingStd = shadowingStd;
+      state.m_shadowingCorDistance = shadowingCorDistance;
+    }
+
+  if (m_shadowingEnabled)
+    {
+      //The first transmission the shadowing is initialed as -1e6,
+      //we perform this if check the identify first  transmission.
+      if (state.m_shadowing < -1e5)
+        {
+          state.m_shadowing = m_norVar->GetValue () * shadowingStd;
+        }
+      else if (state.m_shadowingEpoch != link.m_ue->m_epoch)
+        {
+          // If the UE did not move, the correlation is 1 and the shadowing does not change
+          double deltaX = uePos.x - state.m_shadowingPosition.x;
+          double deltaY = uePos.y - state.m_shadowingPosition.y;
+          double disDiff = sqrt (deltaX * deltaX + deltaY * deltaY);
+          //NS_LOG_ERROR (shadowingStd <<"  "<<disDiff <<"  "<<shadowingCorDistance);
+          double R = exp (-1 * disDiff / shadowingCorDistance); // from equation 7.4-5.
+          state.m_shadowing = R * state.m_shadowing + sqrt (1 - R * R) * m_norVar->GetValue () * shadowingStd;
+        }
+
+      lossDb += state.m_shadowing;
+      state.m_shadowingPosition = uePos;
+      state.m_shadowingEpoch = link.m_ue->m_epoch;
+    }
+
+  if (m_inCar)
+    {
+      lossDb += state.m_carPenetrationLoss;
+    }
+
+  /*FILE* log_file;
+
+    char* fname = (char*)malloc(sizeof(char) * 255);
+
+    memset(fname, 0, sizeof(char) * 255);
+    std::string temp;
+    if(m_optionNlosEnabled)
+    {
+      temp = m_scenario+"-"+state.m_condition+"-opt.txt";
+    }
+    else
+    {
+      temp = m_scenario+"-"+state.m_condition+".txt";
+    }
+
+    log_file = fopen(temp.c_str(), "a");
+
+    fprintf(log_file, "%f \t  %f\n", distance3D, lossDb);
+
+    fflush(log_file);
+
+    fclose(log_file);
+
+    if(fname)
+
+    free(fname);
+
+    fname = 0;*/
+  return std::max (lossDb, m_minLoss);
+}
+
+double
+MmWave3gppPropagationLossModel::GetDeterministicLoss (MmWave3gppLinkTable::LinkState &state,
+                                                      double hBs, double hUt,
+                                                      double *shadowingStdOut,
+                                                      double *shadowingCorDistanceOut) const
+{
   double lossDb = 0;
   double freqGHz = m_frequency / 1e9;
+  double distance2D = state.m_distance2D;
+  double distance3D = state.m_distance3D;
 
   double shadowingStd = 0;
   double shadowingCorDistance = 0;
@@ -367,7 +490,7 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
           shadowingStd = 6;
         }
 
-      switch ((*it).second.m_channelCondition)
+      switch (state.m_condition)
         {
         case 'l':
           {
@@ -402,13 +525,11 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
           NS_FATAL_ERROR ("According to table 7.4.1-1, the UMa scenario need to satisfy the following condition, 1.5 m <= hUT <= 22.5 m");
         }
       //For UMa, the effective environment height should be computed follow Table7.4.1-1.
-      if ((*it).second.m_hE == 0)
+      if (state.m_hE == 0)
         {
-          channelCondition condition;
-          condition = (*it).second;
           if (hUt <= 18)
             {
-              condition.m_hE = 1;
+              state.m_hE = 1;
             }
           else
             {
@@ -418,17 +539,16 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
 
               if (m_uniformVar->GetValue () < prob)
                 {
-                  condition.m_hE = 1;
+                  state.m_hE = 1;
                 }
               else
                 {
                   int random = m_uniformVar->GetInteger (12, (int)(hUt - 1.5));
-                  condition.m_hE = (double)floor (random / 3) * 3;
+                  state.m_hE = (double)floor (random / 3) * 3;
                 }
             }
-          UpdateConditionMap (a,b,condition);
         }
-      double dBP = 4 * (hBs - (*it).second.m_hE) * (hUt - (*it).second.m_hE) * m_frequency / 3e8;
+      double dBP = 4 * (hBs - state.m_hE) * (hUt - state.m_hE) * m_frequency / 3e8;
       if (distance2D <= dBP)
         {
           //PL1
@@ -441,7 +561,7 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
         }
 
 
-      switch ((*it).second.m_channelCondition)
+      switch (state.m_condition)
         {
         case 'l':
           {
@@ -500,7 +620,7 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
         }
 
 
-      switch ((*it).second.m_channelCondition)
+      switch (state.m_condition)
         {
         case 'l':
           {
@@ -540,7 +660,7 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
       lossDb = 32.4 + 17.3 * log10 (distance3D) + 20 * log10 (freqGHz);
 
 
-      switch ((*it).second.m_channelCondition)
+      switch (state.m_condition)
         {
         case 'l':
           {
@@ -593,65 +713,9 @@ MmWave3gppPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel
       NS_FATAL_ERROR ("Unknown channel condition");
     }
 
-  if (m_shadowingEnabled)
-    {
-      channelCondition cond;
-      cond = (*it).second;
-      //The first transmission the shadowing is initialed as -1e6,
-      //we perform this if check the identify first  transmission.
-      if ((*it).second.m_shadowing < -1e5)
-        {
-          cond.m_shadowing = m_norVar->GetValue () * shadowingStd;
-        }
-      else
-        {
-          double deltaX = uePos.x - (*it).second.m_position.x;
-          double deltaY = uePos.y - (*it).second.m_position.y;
-          double disDiff = sqrt (deltaX * deltaX + deltaY * deltaY);
-          //NS_LOG_ERROR (shadowingStd <<"  "<<disDiff <<"  "<<shadowingCorDistance);
-          double R = exp (-1 * disDiff / shadowingCorDistance); // from equation 7.4-5.
-          cond.m_shadowing = R * (*it).second.m_shadowing + sqrt (1 - R * R) * m_norVar->GetValue () * shadowingStd;
-        }
-
-      lossDb += cond.m_shadowing;
-      cond.m_position = ueMob->GetPosition ();
-      UpdateConditionMap (a,b,cond);
-    }
-
-  if (m_inCar)
-    {
-      lossDb += (*it).second.m_carPenetrationLoss;
-    }
-
-  /*FILE* log_file;
-
-    char* fname = (char*)malloc(sizeof(char) * 255);
-
-    memset(fname, 0, sizeof(char) * 255);
-    std::string temp;
-    if(m_optionNlosEnabled)
-    {
-      temp = m_scenario+"-"+(*it).second.m_channelCondition+"-opt.txt";
-    }
-    else
-    {
-      temp = m_scenario+"-"+(*it).second.m_channelCondition+".txt";
-    }
-
-    log_file = fopen(temp.c_str(), "a");
-
-    fprintf(log_file, "%f \t  %f\n", distance3D, lossDb);
-
-    fflush(log_file);
-
-    fclose(log_file);
-
-    if(fname)
-
-    free(fname);
-
-    fname = 0;*/
-  return std::max (lossDb, m_minLoss);
+  *shadowingStdOut = shadowingStd;
+  *shadowingCorDistanceOut = shadowingCorDistance;
+  return lossDb;
 }
 
 int64_t
@@ -660,29 +724,26 @@ MmWave3gppPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
-void
-MmWave3gppPropagationLossModel::UpdateConditionMap (Ptr<MobilityModel> a, Ptr<MobilityModel> b, channelCondition cond) const
-{
-  m_channelConditionMap[std::make_pair (a,b)] = cond;
-  m_channelConditionMap[std::make_pair (b,a)] = cond;
-
-}
-
 char
 MmWave3gppPropagationLossModel::GetChannelCondition (Ptr<MobilityModel> a, Ptr<MobilityModel> b)
 {
-  channelConditionMap_t::const_iterator it;
-  it = m_channelConditionMap.find (std::make_pair (a,b));
-  if (it == m_channelConditionMap.end ())
+  const MmWave3gppLinkTable::LinkState *state = m_linkTable.FindLink (a, b);
+  if (state == nullptr)
     {
       NS_FATAL_ERROR ("Cannot find the link in the map");
     }
-  return (*it).second.m_channelCondition;
+  return state->m_condition;
+
+}
 
+MmWave3gppLinkTable &
+MmWave3gppPropagationLossModel::GetLinkTable ()
+{
+  return m_linkTable;
 }
 
 std::string
-MmWave3gppPropagationLossModel::GetScenario ()
+MmWave3gppPropagationLossModel::GetScenario () const
 {
   return m_scenario;
 }
@@ -34,7 +34,8 @@
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
 #include <ns3/vector.h>
-#include <map>
+#include <ns3/nstime.h>
+#include "mmwave-3gpp-link-table.h"
 
 /*
  * This 3GPP channel model is implemented base on the 3GPP TR 38.900 v14.1.0 (2016-09).
@@ -49,18 +50,6 @@
 
 using namespace ns3;
 
-struct channelCondition
-{
-  char m_channelCondition;
-  double m_shadowing;
-  Vector m_position;
-  double m_hE;         //the effective environment height mentioned in Table 7.4.1-1 Note 1.
-  double m_carPenetrationLoss;         //car penetration loss in dB.
-};
-
-// map store the path loss scenario(LOS,NLOS,OUTAGE) of each propapgation channel
-typedef std::map< std::pair< Ptr<MobilityModel>, Ptr<MobilityModel> >, channelCondition> channelConditionMap_t;
-
 class MmWave3gppPropagationLossModel : public PropagationLossModel
 {
 public:
@@ -92,9 +81,44 @@ public:
    */
   double GetFrequency (void) const;
 
+  /**
+   * \param scenario the 3GPP scenario
+   *
+   * The path loss of the links is computed again at their next use.
+   */
+  void SetScenario (const std::string &scenario);
+
+  /**
+   * \param enabled true to use the optional NLoS propagation loss model
+   *
+   * The path loss of the links is computed again at their next use.
+   */
+  void SetOptionalNlos (bool enabled);
+
+  /**
+   * \returns true if the optional NLoS propagation loss model is used
+   */
+  bool GetOptionalNlos (void) const;
+
+  /**
+   * \param horizon the channel condition and the shadowing of a link not
+   * used for longer are removed (0 to never remove them)
+   */
+  void SetLinkIdleHorizon (Time horizon);
+
+  /**
+   * \returns the idle horizon of the links
+   */
+  Time GetLinkIdleHorizon (void) const;
+
   char GetChannelCondition (Ptr<MobilityModel> a, Ptr<MobilityModel> b);
 
-  std::string GetScenario ();
+  /**
+   * \return the table of the links, to save and restore their state
+   */
+  MmWave3gppLinkTable & GetLinkTable ();
+
+  std::string GetScenario () const;
 
   double GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
@@ -105,12 +129,22 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
-  void UpdateConditionMap (Ptr<MobilityModel> a, Ptr<MobilityModel> b, channelCondition cond) const;
+  /**
+   * \brief Compute the path loss of a link, without shadowing and car penetration loss
+   * \param state the state of the link, with the condition set; m_hE is set if needed
+   * \param hBs height of the gNB
+   * \param hUt height of the UE
+   * \param shadowingStdOut set to the standard deviation of the shadowing
+   * \param shadowingCorDistanceOut set to the correlation distance of the shadowing
+   * \return the path loss in dB
+   */
+  double GetDeterministicLoss (MmWave3gppLinkTable::LinkState &state, double hBs, double hUt,
+                               double *shadowingStdOut, double *shadowingCorDistanceOut) const;
 
   double m_lambda;
   double m_frequency;
   double m_minLoss;
-  mutable channelConditionMap_t m_channelConditionMap;
+  mutable MmWave3gppLinkTable m_linkTable; //!< Role, distances, condition and shadowing of the links
   std::string m_channelConditions; //limit the channel condition to be LoS/NLoS only.
   std::string m_scenario;
   bool m_optionNlosEnabled;
@@ -118,6 +152,10 @@ private:
   Ptr<UniformRandomVariable> m_uniformVar;
   bool m_shadowingEnabled;
   bool m_inCar;
+  bool m_pathLossMemo;                       //!< True if the path loss of a link is reused while its nodes do not move
+  mutable uint64_t m_pathLossMemoHits {0};   //!< Path loss evaluations that reused the previous one
+  mutable uint64_t m_pathLossMemoMisses {0}; //!< Path loss evaluations that were computed
+  uint64_t m_lossGeneration {1};             //!< Incremented when the stored path losses become invalid
 
 };
 
@@ -242,8 +242,8 @@ MmWaveAmc::CreateCqiFeedbacksTdma (const SpectrumValue& sinr, uint8_t numSym, un
         {
           uint8_t mcs = 0;
           TbStats_t tbStats;
-          std::vector <int> rbMap;
-          rbMap.push_back (rbId++);
+          RbgBitmask rbMap (sinr.GetSpectrumModel ()->GetNumBands ());
+          rbMap.Set (rbId++);
           while (mcs <= 28)
             {
               MmWaveHarqProcessInfoList_t harqInfoList;
@@ -346,14 +346,14 @@ MmWaveAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t numSym, u
     }
   else if (m_amcModel == MiErrorModel)
     {
-      std::vector <int> rbMap;
+      RbgBitmask rbMap (sinr.GetSpectrumModel ()->GetNumBands ());
       int rbId = 0;
       double sinrAvg = 0;
       for (it = sinr.ConstValuesBegin (); it != sinr.ConstValuesEnd (); it++)
         {
           if (*it != 0.0)
             {
-              rbMap.push_back (rbId);
+              rbMap.Set (rbId);
               sinrAvg += *it;
             }
           rbId += 1;
@@ -0,0 +1,111 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include "mmwave-control-messages.h"
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Queue of the control messages that the PHY has to transmit, with
+ * one list of messages for each of the next slots
+ *
+ * The lists are stored in a ring whose depth is the L1-L2 control latency.
+ * The messages coming from the MAC are appended to the last list, and each
+ * slot the PHY takes the first list with Pop(): the list is moved out (the
+ * messages are not copied) and its cell becomes the last one of the ring.
+ *
+ * A queue with depth 0 gets a depth of 1 at the first message, so that the
+ * message is returned by the next Pop().
+ */
+class MmWaveCtrlMsgQueue
+{
+public:
+  typedef std::list<Ptr<MmWaveControlMessage> > MsgList; //!< The messages of a slot
+
+  /**
+   * \brief Set the depth of the queue, removing all the messages
+   * \param depth number of slots between PushBack() and the Pop() that
+   * returns the message
+   */
+  void SetDepth (uint32_t depth)
+  {
+    m_lists.clear ();
+    m_lists.resize (depth);
+    m_head = 0;
+  }
+
+  /**
+   * \return the depth of the queue
+   */
+  uint32_t GetDepth () const
+  {
+    return static_cast<uint32_t> (m_lists.size ());
+  }
+
+  /**
+   * \brief Enqueue a message in the last slot of the queue
+   * \param msg the message
+   */
+  void PushBack (Ptr<MmWaveControlMessage> msg)
+  {
+    if (m_lists.empty ())
+      {
+        SetDepth (1);
+      }
+    m_lists[(m_head + m_lists.size () - 1) % m_lists.size ()].push_back (std::move (msg));
+  }
+
+  /**
+   * \brief Enqueue a message in the first slot of the queue, that is, the
+   * message will be returned by the next Pop()
+   * \param msg the message
+   */
+  void PushFront (Ptr<MmWaveControlMessage> msg)
+  {
+    if (m_lists.empty ())
+      {
+        SetDepth (1);
+      }
+    m_lists[m_head].push_back (std::move (msg));
+  }
+
+  /**
+   * \brief Take the messages of the first slot, and advance the queue by one slot
+   * \return the messages of the first slot (empty if the depth is 0)
+   */
+  MsgList Pop ()
+  {
+    if (m_lists.empty ())
+      {
+        return MsgList ();
+      }
+    MsgList ret = std::move (m_lists[m_head]);
+    m_lists[m_head].clear ();
+    m_head = (m_head + 1) % m_lists.size ();
+    return ret;
+  }
+
+private:
+  std::vector<MsgList> m_lists; //!< Messages of each slot
+  size_t m_head {0};            //!< Index of the first slot
+};
+
+} // namespace ns3
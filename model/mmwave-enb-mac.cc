@@ -518,11 +518,11 @@ MmWaveEnbMac::DoSlotIndication (SfnSf sfnSf)
         }
 
       {
-        for (const auto & ue : m_rlcAttached)
+        for (const auto & rnti : m_rlcAttached.GetUes ())
           {
             MmWaveMacCschedSapProvider::CschedUeConfigReqParameters params;
-            params.m_rnti = ue.first;
-            params.m_beamId = m_phySapProvider->GetBeamId (ue.first);
+            params.m_rnti = rnti;
+            params.m_beamId = m_phySapProvider->GetBeamId (rnti);
             params.m_transmissionMode = 0;   // set to default value (SISO) for avoiding random initialization (valgrind error)
             m_macCschedSapProvider->CschedUeConfigReq (params);
           }
@@ -641,8 +641,7 @@ MmWaveEnbMac::DoReceivePhyPdu (Ptr<Packet> p)
   uint16_t rnti = tag.GetRnti ();
   MmWaveMacPduHeader macHeader;
   p->RemoveHeader (macHeader);
-  std::map <uint16_t, std::map<uint8_t, LteMacSapUser*> >::iterator rntiIt = m_rlcAttached.find (rnti);
-  NS_ASSERT_MSG (rntiIt != m_rlcAttached.end (), "could not find RNTI" << rnti);
+  NS_ASSERT_MSG (m_rlcAttached.HasUe (rnti), "could not find RNTI" << rnti);
   std::vector<MacSubheader> macSubheaders = macHeader.GetSubheaders ();
   uint32_t currPos = 0;
   for (unsigned ipdu = 0; ipdu < macSubheaders.size (); ipdu++)
@@ -651,8 +650,8 @@ MmWaveEnbMac::DoReceivePhyPdu (Ptr<Packet> p)
         {
           continue;
         }
-      std::map<uint8_t, LteMacSapUser*>::iterator lcidIt = rntiIt->second.find (macSubheaders[ipdu].m_lcid);
-      NS_ASSERT_MSG (lcidIt != rntiIt->second.end (), "could not find LCID" << macSubheaders[ipdu].m_lcid);
+      const MmWaveLcDispatchTable::Entry *lc = m_rlcAttached.Find (rnti, macSubheaders[ipdu].m_lcid);
+      NS_ASSERT_MSG (lc != nullptr, "could not find LCID" << macSubheaders[ipdu].m_lcid);
       Ptr<Packet> rlcPdu;
       if ((p->GetSize () - currPos) < (uint32_t)macSubheaders[ipdu].m_size)
         {
@@ -665,13 +664,13 @@ MmWaveEnbMac::DoReceivePhyPdu (Ptr<Packet> p)
                         << p->GetSize () << " header= " << (uint32_t)macSubheaders[ipdu].m_size << ")" );
           rlcPdu = p->CreateFragment (currPos, macSubheaders[ipdu].m_size);
           currPos += macSubheaders[ipdu].m_size;
-          (*lcidIt).second->ReceivePdu (LteMacSapUser::ReceivePduParameters (rlcPdu, rnti, macSubheaders[ipdu].m_lcid));
+          lc->m_macSapUser->ReceivePdu (LteMacSapUser::ReceivePduParameters (rlcPdu, rnti, macSubheaders[ipdu].m_lcid));
         }
       else
         {
           rlcPdu = p->CreateFragment (currPos, p->GetSize () - currPos);
           currPos = p->GetSize ();
-          (*lcidIt).second->ReceivePdu (LteMacSapUser::ReceivePduParameters (rlcPdu, rnti, macSubheaders[ipdu].m_lcid));
+          lc->m_macSapUser->ReceivePdu (LteMacSapUser::ReceivePduParameters (rlcPdu, rnti, macSubheaders[ipdu].m_lcid));
         }
       NS_LOG_DEBUG ("Enb Mac Rx Packet, Rnti:" << rnti << " lcid:" << macSubheaders[ipdu].m_lcid << " size:" << macSubheaders[ipdu].m_size);
     }
@@ -876,10 +875,9 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
       if (varTtiAllocInfo.m_varTtiType != VarTtiAllocInfo::CTRL && varTtiAllocInfo.m_tddMode == VarTtiAllocInfo::DL)
         {
           uint16_t rnti = varTtiAllocInfo.m_dci->m_rnti;
-          std::map <uint16_t, std::map<uint8_t, LteMacSapUser*> >::iterator rntiIt = m_rlcAttached.find (rnti);
-          if (rntiIt == m_rlcAttached.end ())
+          if (! m_rlcAttached.HasUe (rnti))
             {
-              NS_FATAL_ERROR ("Scheduled UE " << rntiIt->first << " not attached");
+              NS_FATAL_ERROR ("Scheduled UE " << rnti << " not attached");
             }
           else
             {
@@ -917,9 +915,8 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
                   pduMapIt->second.m_numRlcPdu = 0;
                   for (unsigned int ipdu = 0; ipdu < rlcPduInfo.size (); ipdu++)
                     {
-                      NS_ASSERT_MSG (rntiIt != m_rlcAttached.end (), "could not find RNTI" << rnti);
-                      std::map<uint8_t, LteMacSapUser*>::iterator lcidIt = rntiIt->second.find (rlcPduInfo[ipdu].m_lcid);
-                      NS_ASSERT_MSG (lcidIt != rntiIt->second.end (), "could not find LCID" << rlcPduInfo[ipdu].m_lcid);
+                      const MmWaveLcDispatchTable::Entry *lc = m_rlcAttached.Find (rnti, rlcPduInfo[ipdu].m_lcid);
+                      NS_ASSERT_MSG (lc != nullptr, "could not find LCID" << rlcPduInfo[ipdu].m_lcid);
                       NS_LOG_DEBUG ("Notifying RLC of TX opportunity for TB " << (unsigned int)tbUid << " PDU num " << ipdu << " size " << (unsigned int) rlcPduInfo[ipdu].m_size);
                       MacSubheader subheader (rlcPduInfo[ipdu].m_lcid, rlcPduInfo[ipdu].m_size);
 
@@ -928,7 +925,7 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
                       // portions.
                       //(*lcidIt).second->NotifyTxOpportunity ((rlcPduInfo[ipdu].m_size)-subheader.GetSize (), 0, tbUid, m_componentCarrierId, rnti, rlcPduInfo[ipdu].m_lcid);
 
-                      (*lcidIt).second->NotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters ((rlcPduInfo[ipdu].m_size), 0, tbUid, m_componentCarrierId, rnti, rlcPduInfo[ipdu].m_lcid));
+                      lc->m_macSapUser->NotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters ((rlcPduInfo[ipdu].m_size), 0, tbUid, m_componentCarrierId, rnti, rlcPduInfo[ipdu].m_lcid));
                       harqIt->second.at (tbUid).m_lcidList.push_back (rlcPduInfo[ipdu].m_lcid);
                     }
 
@@ -1031,11 +1028,9 @@ void
 MmWaveEnbMac::DoAddUe (uint16_t rnti)
 {
   NS_LOG_FUNCTION (this << " rnti=" << rnti);
-  std::map<uint8_t, LteMacSapUser*> empty;
-  std::pair <std::map <uint16_t, std::map<uint8_t, LteMacSapUser*> >::iterator, bool>
-  ret = m_rlcAttached.insert (std::pair <uint16_t,  std::map<uint8_t, LteMacSapUser*> >
-                                (rnti, empty));
-  NS_ASSERT_MSG (ret.second, "element already present, RNTI already existed");
+  bool ret = m_rlcAttached.AddUe (rnti);
+  NS_ASSERT_MSG (ret, "element already present, RNTI already existed");
+  NS_UNUSED (ret);
   //m_associatedUe.push_back (rnti);
 
   MmWaveMacCschedSapProvider::CschedUeConfigReqParameters params;
@@ -1065,7 +1060,7 @@ MmWaveEnbMac::DoRemoveUe (uint16_t rnti)
   params.m_rnti = rnti;
   m_macCschedSapProvider->CschedUeReleaseReq (params);
   m_miDlHarqProcessesPackets.erase (rnti);
-  m_rlcAttached.erase (rnti);
+  m_rlcAttached.RemoveUe (rnti);
 }
 
 void
@@ -1078,12 +1073,15 @@ MmWaveEnbMac::DoAddLc (LteEnbCmacSapProvider::LcInfo lcinfo, LteMacSapUser* msu)
 
   LteFlowId_t flow (lcinfo.rnti, lcinfo.lcId);
 
-  std::map <uint16_t, std::map<uint8_t, LteMacSapUser*> >::iterator rntiIt = m_rlcAttached.find (lcinfo.rnti);
-  NS_ASSERT_MSG (rntiIt != m_rlcAttached.end (), "RNTI not found");
-  std::map<uint8_t, LteMacSapUser*>::iterator lcidIt = rntiIt->second.find (lcinfo.lcId);
-  if (lcidIt == rntiIt->second.end ())
+  NS_ASSERT_MSG (m_rlcAttached.HasUe (lcinfo.rnti), "RNTI not found");
+  bool created = false;
+  MmWaveLcDispatchTable::Entry &lc = m_rlcAttached.AddLc (lcinfo.rnti, lcinfo.lcId, &created);
+  if (created)
     {
-      rntiIt->second.insert (std::pair<uint8_t, LteMacSapUser*> (lcinfo.lcId, msu));
+      lc.m_macSapUser = msu;
+      lc.m_hasQos = true;
+      lc.m_qci = lcinfo.qci;
+      lc.m_isGbr = lcinfo.isGbr;
     }
   else
     {
@@ -1126,8 +1124,7 @@ void
 MmWaveEnbMac::DoReleaseLc (uint16_t rnti, uint8_t lcid)
 {
   //Find user based on rnti and then erase lcid stored against the same
-  std::map <uint16_t, std::map<uint8_t, LteMacSapUser*> >::iterator rntiIt = m_rlcAttached.find (rnti);
-  rntiIt->second.erase (lcid);
+  m_rlcAttached.ReleaseLc (rnti, lcid);
 
   struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters params;
   params.m_rnti = rnti;
@@ -32,6 +32,7 @@
 #include <ns3/lte-enb-cmac-sap.h>
 #include <ns3/lte-mac-sap.h>
 #include "mmwave-phy-mac-common.h"
+#include "mmwave-lc-dispatch-table.h"
 #include <ns3/lte-ccm-mac-sap.h>
 #include <list>
 
@@ -257,7 +258,7 @@ private:
 
   std::map<uint8_t, uint32_t> m_receivedRachPreambleCount;
 
-  std::map <uint16_t, std::map<uint8_t, LteMacSapUser*> > m_rlcAttached;
+  MmWaveLcDispatchTable m_rlcAttached; //!< SAP user of the LCs of each UE
 
   std::vector <DlHarqInfo> m_dlHarqInfoReceived;   // DL HARQ feedback received
   std::vector <UlHarqInfo> m_ulHarqInfoReceived;   // UL HARQ feedback received
@@ -145,14 +145,12 @@ MmWaveEnbPhy::DoInitialize (void)
   Ptr<SpectrumValue> noisePsd = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_phyMacConfig, m_noiseFigure);
   m_downlinkSpectrumPhy->SetNoisePowerSpectralDensity (noisePsd);
 
-  for (unsigned i = 0; i < m_phyMacConfig->GetL1L2CtrlLatency (); i++)
-    {   // push elements onto queue for initial scheduling delay
-      m_controlMessageQueue.push_back (std::list<Ptr<MmWaveControlMessage> > ());
-    }
+  // one list of messages for each slot of the initial scheduling delay
+  m_controlMessageQueue.SetDepth (m_phyMacConfig->GetL1L2CtrlLatency ());
   //m_slotAllocInfoUpdated = true;
 
   SfnSf sfnSf = SfnSf (m_frameNum, m_subframeNum, 0, 0);
-  std::vector<uint8_t> rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), 1);
+  RbgBitmask rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), true);
 
   for (unsigned i = 0; i < m_phyMacConfig->GetL1L2DataLatency (); i++)
     {
@@ -195,20 +193,43 @@ MmWaveEnbPhy::GetmmWaveEnbCphySapProvider ()
   return m_enbCphySapProvider;
 }
 
-AntennaArrayModel::BeamId MmWaveEnbPhy::GetBeamId (uint8_t rnti) const
+AntennaArrayModel::BeamId MmWaveEnbPhy::GetBeamId (uint16_t rnti) const
 {
-  for (uint8_t i = 0; i < m_deviceMap.size (); i++)
+  Ptr<NetDevice> ueDev = GetUeDevice (rnti);
+  if (ueDev)
     {
-      Ptr<MmWaveUeNetDevice> ueDev = DynamicCast < MmWaveUeNetDevice > (m_deviceMap.at (i));
-      uint64_t ueRnti = ueDev->GetPhy (0)->GetRnti ();
+      Ptr<AntennaArrayModel> antennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
+      return AntennaArrayModel::GetBeamId (antennaArray->GetBeamformingVector (ueDev));
+    }
+  return AntennaArrayModel::BeamId (std::make_pair (0,0));
+}
 
-      if (ueRnti == rnti)
+Ptr<NetDevice>
+MmWaveEnbPhy::GetUeDevice (uint16_t rnti) const
+{
+  auto it = m_ueDeviceTable.find (rnti);
+  if (it != m_ueDeviceTable.end ())
+    {
+      NS_ASSERT (DynamicCast<MmWaveUeNetDevice> (it->second)->GetPhy (0)->GetRnti () == rnti);
+      return it->second;
+    }
+
+  // The UE PHY learns its RNTI after the gNB added the UE, so the device
+  // is looked up the first time it is needed. Only the attached UEs are
+  // stored, as DoRemoveUe is what removes them from the table.
+  for (const auto & dev : m_deviceMap)
+    {
+      Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice> (dev);
+      if (ueDev->GetPhy (0)->GetRnti () == rnti)
         {
-          Ptr<AntennaArrayModel> antennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
-          return AntennaArrayModel::GetBeamId (antennaArray->GetBeamformingVector (m_deviceMap.at (i)));
+          if (m_ueAttachedRnti.find (rnti) != m_ueAttachedRnti.end ())
+            {
+              m_ueDeviceTable.emplace (rnti, dev);
+            }
+          return dev;
         }
     }
-  return AntennaArrayModel::BeamId (std::make_pair (0,0));
+  return nullptr;
 }
 
 void
@@ -240,15 +261,15 @@ MmWaveEnbPhy::CalcChannelQualityForUe (std::vector <double> sinr, Ptr<MmWaveSpec
 }
 
 Ptr<SpectrumValue>
-MmWaveEnbPhy::CreateTxPowerSpectralDensity (const std::vector<int> &rbIndexVector) const
+MmWaveEnbPhy::CreateTxPowerSpectralDensity (const RbgBitmask &rbBitmask) const
 {
-  return MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, m_txPower, rbIndexVector);
+  return m_txPsdFactory.Create (m_phyMacConfig, m_txPower, rbBitmask);
 }
 
 void
-MmWaveEnbPhy::SetSubChannels (const std::vector<int> &rbIndexVector)
+MmWaveEnbPhy::SetSubChannels (const RbgBitmask &rbBitmask)
 {
-  Ptr<SpectrumValue> txPsd = CreateTxPowerSpectralDensity (rbIndexVector);
+  Ptr<SpectrumValue> txPsd = CreateTxPowerSpectralDensity (rbBitmask);
   NS_ASSERT (txPsd);
   m_downlinkSpectrumPhy->SetTxPowerSpectralDensity (txPsd);
 }
@@ -317,18 +338,13 @@ MmWaveEnbPhy::StartSlot (void)
           mib.systemFrameNumber = 1;
           Ptr<MmWaveMibMessage> mibMsg = Create<MmWaveMibMessage> ();
           mibMsg->SetMib (mib);
-          if (m_controlMessageQueue.empty ())
-            {
-              std::list<Ptr<MmWaveControlMessage> > l;
-              m_controlMessageQueue.push_back (l);
-            }
-          m_controlMessageQueue.at (0).push_back (mibMsg);
+          m_controlMessageQueue.PushFront (mibMsg);
         }
       else if (m_subframeNum == 5)   // send SIB at beginning of second half-frame
         {
           Ptr<MmWaveSib1Message> msg = Create<MmWaveSib1Message> ();
           msg->SetSib1 (m_sib1);
-          m_controlMessageQueue.at (0).push_back (msg);
+          m_controlMessageQueue.PushFront (msg);
         }
     }
 
@@ -349,19 +365,16 @@ MmWaveEnbPhy::StoreRBGAllocation (const std::shared_ptr<DciInfoElementTdma> &dci
   else
     {
       auto & existingRBGBitmask = itAlloc->second;
-      NS_ASSERT (existingRBGBitmask.size () == m_phyMacConfig->GetBandwidthInRbg ());
-      NS_ASSERT (dci->m_rbgBitmask.size () == m_phyMacConfig->GetBandwidthInRbg ());
-      for (uint32_t i = 0; i < m_phyMacConfig->GetBandwidthInRbg (); ++i)
-        {
-          existingRBGBitmask.at (i) = existingRBGBitmask.at (i) | dci->m_rbgBitmask.at (i);
-        }
+      NS_ASSERT (existingRBGBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg ());
+      NS_ASSERT (dci->m_rbgBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg ());
+      existingRBGBitmask |= dci->m_rbgBitmask;
     }
 }
 
-std::list <Ptr<MmWaveControlMessage> >
+std::shared_ptr<MmWaveDciPerRntiMap>
 MmWaveEnbPhy::RetrieveMsgsFromDCIs (const SfnSf &sfn)
 {
-  std::list <Ptr<MmWaveControlMessage> > ctrlMsgs;
+  auto dciPerRnti = std::make_shared<MmWaveDciPerRntiMap> ();
 
   // find all DL DCI elements in the current slot and create the DL RBG bitmask
   uint8_t lastSymbolDl = 0, lastSymbolUl = 0;
@@ -389,7 +402,7 @@ MmWaveEnbPhy::RetrieveMsgsFromDCIs (const SfnSf &sfn)
           Ptr<MmWaveTdmaDciMessage> dciMsg = Create<MmWaveTdmaDciMessage> (dciElem);
           dciMsg->SetSfnSf (sfn);
 
-          ctrlMsgs.push_back (dciMsg);
+          (*dciPerRnti)[dciElem->m_rnti].push_back (dciMsg);
           NS_LOG_INFO ("To send, DL DCI for UE " << dciElem->m_rnti);
         }
     }
@@ -426,7 +439,7 @@ MmWaveEnbPhy::RetrieveMsgsFromDCIs (const SfnSf &sfn)
 
                   Ptr<MmWaveTdmaDciMessage> dciMsg = Create<MmWaveTdmaDciMessage> (dciElem);
                   dciMsg->SetSfnSf (sfn);
-                  ctrlMsgs.push_back (dciMsg);
+                  (*dciPerRnti)[dciElem->m_rnti].push_back (dciMsg);
 
                   NS_LOG_INFO ("To send, UL DCI for UE " << dciElem->m_rnti);
                 }
@@ -453,14 +466,14 @@ MmWaveEnbPhy::RetrieveMsgsFromDCIs (const SfnSf &sfn)
 
               Ptr<MmWaveTdmaDciMessage> dciMsg = Create<MmWaveTdmaDciMessage> (dciElem);
               dciMsg->SetSfnSf (sfn);
-              ctrlMsgs.push_back (dciMsg);
+              (*dciPerRnti)[dciElem->m_rnti].push_back (dciMsg);
 
               NS_LOG_INFO ("To send, UL DCI for UE " << dciElem->m_rnti);
             }
         }
     }
 
-  return ctrlMsgs;
+  return dciPerRnti;
 }
 
 void
@@ -484,9 +497,10 @@ MmWaveEnbPhy::StartVarTti (void)
       // Start with a clean RBG allocation bitmask
       m_rbgAllocationPerSym.clear ();
 
-      // create control messages to be transmitted in DL-Control period
+      // create control messages to be transmitted in DL-Control period: the
+      // DCIs are indexed by RNTI, so that each UE receives only its own
       std::list <Ptr<MmWaveControlMessage> > ctrlMsgs = GetControlMessages ();
-      ctrlMsgs.merge (RetrieveMsgsFromDCIs (sfn));
+      std::shared_ptr<MmWaveDciPerRntiMap> dciPerRnti = RetrieveMsgsFromDCIs (sfn);
 
       // TX control period
       varTtiPeriod = m_phyMacConfig->GetSymbolPeriod () * m_phyMacConfig->GetDlCtrlSymbols ();
@@ -499,7 +513,7 @@ MmWaveEnbPhy::StartVarTti (void)
                     " start " << Simulator::Now () <<
                     " end " << Simulator::Now () + varTtiPeriod - NanoSeconds (1.0));
 
-      SendCtrlChannels (ctrlMsgs, varTtiPeriod - NanoSeconds (1.0)); // -1 ns ensures control ends before data period
+      SendCtrlChannels (std::move (ctrlMsgs), dciPerRnti, varTtiPeriod - NanoSeconds (1.0)); // -1 ns ensures control ends before data period
     }
   else if (m_varTtiNum == m_currSfNumVarTtis - 1)   // UL control var tti
     {
@@ -530,17 +544,8 @@ MmWaveEnbPhy::StartVarTti (void)
         {
           // sometimes the UE will be scheduled when no data is queued
           // in this case, send an empty PDU
-          MmWaveMacPduTag tag (SfnSf (m_frameNum, m_subframeNum, m_slotNum, currVarTti.m_dci->m_symStart));
-          Ptr<Packet> emptyPdu = Create <Packet> ();
-          MmWaveMacPduHeader header;
-          MacSubheader subheader (3, 0);    // lcid = 3, size = 0
-          header.AddSubheader (subheader);
-          emptyPdu->AddHeader (header);
-          emptyPdu->AddPacketTag (tag);
-          LteRadioBearerTag bearerTag (currVarTti.m_dci->m_rnti, 3, 0);
-          emptyPdu->AddPacketTag (bearerTag);
-          pktBurst = CreateObject<PacketBurst> ();
-          pktBurst->AddPacket (emptyPdu);
+          pktBurst = CreateEmptyPduBurst (SfnSf (m_frameNum, m_subframeNum, m_slotNum, currVarTti.m_dci->m_symStart),
+                                          currVarTti.m_dci->m_rnti);
         }
 
       NS_LOG_DEBUG ("ENB TXing DL DATA frame " << m_frameNum <<
@@ -556,34 +561,22 @@ MmWaveEnbPhy::StartVarTti (void)
   else if (currVarTti.m_tddMode == VarTtiAllocInfo::UL)    // receive UL var tti
     {
       // Assert: we expect TDMA in UL
-      NS_ASSERT (currVarTti.m_dci->m_rbgBitmask.size () == m_phyMacConfig->GetBandwidthInRbg ());
-      NS_ASSERT (static_cast<uint32_t> (std::count (currVarTti.m_dci->m_rbgBitmask.begin (),
-                                                    currVarTti.m_dci->m_rbgBitmask.end (), 1U)) ==
-                 currVarTti.m_dci->m_rbgBitmask.size ());
+      NS_ASSERT (currVarTti.m_dci->m_rbgBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg ());
+      NS_ASSERT (currVarTti.m_dci->m_rbgBitmask.All ());
 
       varTtiPeriod = m_phyMacConfig->GetSymbolPeriod () * currVarTti.m_dci->m_numSym;
 
       //NS_LOG_DEBUG ("Var tti " << (uint8_t)m_varTtiNum << " scheduled for Uplink");
       m_downlinkSpectrumPhy->AddExpectedTb (currVarTti.m_dci->m_rnti, currVarTti.m_dci->m_ndi,
                                             currVarTti.m_dci->m_tbSize, currVarTti.m_dci->m_mcs,
-                                            FromRBGBitmaskToRBAssignment (currVarTti.m_dci->m_rbgBitmask),
+                                            FromRBGBitmaskToRBBitmask (currVarTti.m_dci->m_rbgBitmask),
                                             currVarTti.m_dci->m_harqProcess, currVarTti.m_dci->m_rv, false,
                                             currVarTti.m_dci->m_symStart, currVarTti.m_dci->m_numSym);
 
-      bool found = false;
-      for (uint8_t i = 0; i < m_deviceMap.size (); i++)
-        {
-          Ptr<MmWaveUeNetDevice> ueDev = DynamicCast < MmWaveUeNetDevice > (m_deviceMap.at (i));
-          uint64_t ueRnti = ueDev->GetPhy (0)->GetRnti ();
-          if (currVarTti.m_dci->m_rnti == ueRnti)
-            {
-              Ptr<AntennaArrayModel> antennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
-              antennaArray->ChangeBeamformingVector (m_deviceMap.at (i));
-              found = true;
-              break;
-            }
-        }
-      NS_ASSERT (found);
+      Ptr<NetDevice> ueDev = GetUeDevice (currVarTti.m_dci->m_rnti);
+      NS_ASSERT (ueDev);
+      Ptr<AntennaArrayModel> antennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
+      antennaArray->ChangeBeamformingVector (ueDev);
 
       NS_LOG_DEBUG ("ENB RXing UL DATA frame " << m_frameNum <<
                     " subframe " << static_cast<uint32_t> (m_subframeNum) <<
@@ -690,49 +683,37 @@ MmWaveEnbPhy::SendDataChannels (Ptr<PacketBurst> pb, Time varTtiPeriod, VarTtiAl
     {   // update beamforming vectors (currently supports 1 user only)
         //std::map<uint16_t, std::vector<unsigned> >::iterator ueRbIt = varTtiInfo.m_ueRbMap.begin();
         //uint16_t rnti = ueRbIt->first;
-      bool found = false;
-      for (uint8_t i = 0; i < m_deviceMap.size (); i++)
-        {
-          Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice> (m_deviceMap.at (i));
-          uint64_t ueRnti = ueDev->GetPhy (0)->GetRnti ();
-          //NS_LOG_UNCOND ("Scheduled rnti:"<<rnti <<" ue rnti:"<< ueRnti);
-          if (varTtiInfo.m_dci->m_rnti == ueRnti)
-            {
-              //NS_LOG_UNCOND ("Change Beamforming Vector");
-              Ptr<AntennaArrayModel> antennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
-              antennaArray->ChangeBeamformingVector (m_deviceMap.at (i));
-              found = true;
-              break;
-            }
-        }
-      NS_ABORT_IF (!found);
+      Ptr<NetDevice> ueDev = GetUeDevice (varTtiInfo.m_dci->m_rnti);
+      NS_ABORT_IF (ueDev == nullptr);
+      Ptr<AntennaArrayModel> antennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna ());
+      antennaArray->ChangeBeamformingVector (ueDev);
     }
 
   // in the map we stored the RBG allocated by the MAC for this symbol.
-  // If the transmission last n symbol (n > 1 && n < 12) the SetSubChannels
-  // doesn't need to be called again. In fact, SendDataChannels will be
+  // If the transmission last n symbol (n > 1 && n < 12) the TX PSD
+  // doesn't need to be set again. In fact, SendDataChannels will be
   // invoked only when the symStart changes.
-  SetSubChannels (FromRBGBitmaskToRBAssignment (m_rbgAllocationPerSym.at (varTtiInfo.m_dci->m_symStart)));
+  m_downlinkSpectrumPhy->SetTxPowerSpectralDensity (CreateTxPowerSpectralDensityFromRbg (m_rbgAllocationPerSym.at (varTtiInfo.m_dci->m_symStart)));
 
   std::list<Ptr<MmWaveControlMessage> > ctrlMsgs;
-  m_downlinkSpectrumPhy->StartTxDataFrames (pb, ctrlMsgs, varTtiPeriod, varTtiInfo.m_dci->m_symStart);
+  m_downlinkSpectrumPhy->StartTxDataFrames (pb, std::move (ctrlMsgs), varTtiPeriod, varTtiInfo.m_dci->m_symStart);
 }
 
 void
-MmWaveEnbPhy::SendCtrlChannels (std::list<Ptr<MmWaveControlMessage> > ctrlMsgs, Time varTtiPeriod)
+MmWaveEnbPhy::SendCtrlChannels (std::list<Ptr<MmWaveControlMessage> > ctrlMsgs,
+                                const std::shared_ptr<MmWaveDciPerRntiMap> &dciPerRnti,
+                                Time varTtiPeriod)
 {
   NS_LOG_FUNCTION (this << "Send Ctrl");
 
-  std::vector <int> fullBwRb (m_phyMacConfig->GetBandwidthInRbs ());
-  // The first time set the right values for the phy
-  for (uint32_t i = 0; i < m_phyMacConfig->GetBandwidthInRbs (); ++i)
-    {
-      fullBwRb.at (i) = static_cast<int> (i);
-    }
+  // The control is transmitted over the entire bandwidth
+  RbgBitmask fullBwRb (m_phyMacConfig->GetBandwidthInRbs (), true);
 
   SetSubChannels (fullBwRb);
 
-  m_downlinkSpectrumPhy->StartTxDlControlFrames (ctrlMsgs, varTtiPeriod);
+  // The frame is transmitted even without messages, as it still counts
+  // as interference for the other cells
+  m_downlinkSpectrumPhy->StartTxDlControlFrames (std::move (ctrlMsgs), varTtiPeriod, dciPerRnti);
 }
 
 bool
@@ -795,11 +776,11 @@ MmWaveEnbPhy::GenerateDataCqiReport (const SpectrumValue& sinr)
 
 
 void
-MmWaveEnbPhy::PhyCtrlMessagesReceived (std::list<Ptr<MmWaveControlMessage> > msgList)
+MmWaveEnbPhy::PhyCtrlMessagesReceived (const std::list<Ptr<MmWaveControlMessage> > &msgList)
 {
   NS_LOG_FUNCTION (this);
 
-  std::list<Ptr<MmWaveControlMessage> >::iterator ctrlIt = msgList.begin ();
+  std::list<Ptr<MmWaveControlMessage> >::const_iterator ctrlIt = msgList.begin ();
 
   while (ctrlIt != msgList.end ())
     {
@@ -902,6 +883,7 @@ MmWaveEnbPhy::DoRemoveUe (uint16_t rnti)
   if (it != m_ueAttachedRnti.end ())
     {
       m_ueAttachedRnti.erase (it);
+      m_ueDeviceTable.erase (rnti);
     }
   else
     {
@@ -60,7 +60,7 @@ public:
   void SetmmWaveEnbCphySapUser (LteEnbCphySapUser* s);
   LteEnbCphySapProvider* GetmmWaveEnbCphySapProvider ();
 
-  AntennaArrayModel::BeamId GetBeamId (uint8_t rnti) const override;
+  AntennaArrayModel::BeamId GetBeamId (uint16_t rnti) const override;
 
   void SetTxPower (double pow);
   double GetTxPower () const;
@@ -72,21 +72,21 @@ public:
 
   /**
    * \brief Create Tx Power Spectral Density
-   * \param rbIndexVector vector of the index of the RB (in SpectrumValue array)
+   * \param rbBitmask bitmask of the RB (in SpectrumValue array)
    * in which there is a transmission
    * \return A SpectrumValue array with fixed size, in which each value
-   * is updated to a particular value if the correspond RB index was inside the rbIndexVector,
+   * is updated to a particular value if the correspond RB bit was set in rbBitmask,
    * or is left untouched otherwise.
    * \see MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity
    */
-  virtual Ptr<SpectrumValue> CreateTxPowerSpectralDensity (const std::vector<int> &rbIndexVector) const override;
+  virtual Ptr<SpectrumValue> CreateTxPowerSpectralDensity (const RbgBitmask &rbBitmask) const override;
 
   /**
-   * \brief Set the Tx power spectral density based on the RB index vector
-   * \param rbIndexVector vector of the index of the RB (in SpectrumValue array)
+   * \brief Set the Tx power spectral density based on the RB bitmask
+   * \param rbBitmask bitmask of the RB (in SpectrumValue array)
    * in which there is a transmission
    */
-  void SetSubChannels (const std::vector<int> &rbIndexVector);
+  void SetSubChannels (const RbgBitmask &rbBitmask);
 
   void StartSlot (void);
   void EndSlot (void);
@@ -97,7 +97,15 @@ public:
 
   void SendDataChannels (Ptr<PacketBurst> pb, Time varTtiPeriod, VarTtiAllocInfo& varTtiInfo);
 
-  void SendCtrlChannels (std::list<Ptr<MmWaveControlMessage> > ctrlMsg, Time varTtiPeriod);
+  /**
+   * \brief Transmit the DL control frame
+   * \param ctrlMsg control messages for all the UEs of the cell
+   * \param dciPerRnti DCI of the slot, indexed by RNTI (can be nullptr)
+   * \param varTtiPeriod duration of the transmission
+   */
+  void SendCtrlChannels (std::list<Ptr<MmWaveControlMessage> > ctrlMsg,
+                         const std::shared_ptr<MmWaveDciPerRntiMap> &dciPerRnti,
+                         Time varTtiPeriod);
 
   Ptr<MmWaveSpectrumPhy> GetDlSpectrumPhy () const;
   Ptr<MmWaveSpectrumPhy> GetUlSpectrumPhy () const;
@@ -113,7 +121,7 @@ virtual void ReceiveIdealControlMessage(Ptr<IdealControlMessage> msg)**/
 
   void GenerateDataCqiReport (const SpectrumValue& sinr);
 
-  void PhyCtrlMessagesReceived (std::list<Ptr<MmWaveControlMessage> > msgList);
+  void PhyCtrlMessagesReceived (const std::list<Ptr<MmWaveControlMessage> > &msgList);
 
   int8_t DoGetReferenceSignalPower () const;
 
@@ -125,7 +133,23 @@ virtual void ReceiveIdealControlMessage(Ptr<IdealControlMessage> msg)**/
 
 
 private:
-  std::list <Ptr<MmWaveControlMessage> > RetrieveMsgsFromDCIs (const SfnSf &sfn);
+  /**
+   * \brief Create the DCI messages of the DL allocations of this slot, and
+   * of the UL allocations of the slot indicated by UlSchedDelay
+   * \param sfn the current slot
+   * \return the DCI messages, indexed by the RNTI of their UE
+   */
+  std::shared_ptr<MmWaveDciPerRntiMap> RetrieveMsgsFromDCIs (const SfnSf &sfn);
+
+  /**
+   * \brief Get the device of an UE
+   * \param rnti RNTI of the UE
+   * \return the device of the UE, or nullptr if no UE has that RNTI
+   *
+   * The lookup goes through m_ueDeviceTable; the devices in m_deviceMap are
+   * scanned only the first time an attached RNTI is requested.
+   */
+  Ptr<NetDevice> GetUeDevice (uint16_t rnti) const;
 
   bool AddUePhy (uint16_t rnti);
   // LteEnbCphySapProvider forwarded methods
@@ -173,6 +197,14 @@ private:
 
   std::set <uint16_t> m_ueAttachedRnti;
 
+  /**
+   * \brief Device of each attached UE, by RNTI
+   *
+   * The beamforming vectors are not copied here: they stay in the antenna
+   * (which can update them at any moment) and they are found from the device.
+   */
+  mutable std::unordered_map<uint16_t, Ptr<NetDevice> > m_ueDeviceTable;
+
   Ptr<MmWaveHarqPhy> m_harqPhyModule;
 
   Time m_lastSlotStart;
@@ -181,7 +213,7 @@ private:
 
   TracedCallback< uint64_t, SpectrumValue&, SpectrumValue& > m_ulSinrTrace;
 
-  std::unordered_map<uint8_t, std::vector<uint8_t> > m_rbgAllocationPerSym;  //!< RBG allocation in each sym
+  std::unordered_map<uint8_t, RbgBitmask> m_rbgAllocationPerSym;  //!< RBG allocation in each sym
 };
 
 }
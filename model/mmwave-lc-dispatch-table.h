@@ -0,0 +1,224 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <ns3/assert.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace ns3 {
+
+class LteMacSapUser;
+
+/**
+ * \brief Table of the logical channels of the UEs of a cell, indexed directly
+ * by RNTI and LCID
+ *
+ * The RNTI indexes a vector of row numbers (4 bytes per RNTI), and each row
+ * is an array with one entry per LCID, plus a bitmask of the existing LCs.
+ * The rows of the removed UEs are reused, so the memory is proportional to the
+ * number of UEs attached at the same time. A lookup is two vector accesses.
+ *
+ * The table is filled by the owner when a UE or a LC is added or released;
+ * it is used by the MAC (to find the SAP user of a LC) and by the BWP manager
+ * (to find also the QCI of a LC and the BWP that serves it).
+ */
+class MmWaveLcDispatchTable
+{
+public:
+  static const uint8_t MAX_LCID = 32; //!< LCIDs are in [0, MAX_LCID)
+
+  /**
+   * \brief The information stored for each LC
+   */
+  struct Entry
+  {
+    LteMacSapUser *m_macSapUser {nullptr}; //!< SAP user of the LC
+    uint8_t m_lcid {0};                    //!< LCID of the LC
+    bool m_hasQos {false};                 //!< True if m_qci, m_isGbr and m_bwpIndex are set
+    uint8_t m_qci {0};                     //!< QCI of the bearer
+    bool m_isGbr {false};                  //!< True if the bearer is GBR
+    uint8_t m_bwpIndex {0};                //!< BWP that serves the LC
+  };
+
+  /**
+   * \brief Add a UE, without LCs
+   * \param rnti RNTI of the UE
+   * \return false if the UE was already in the table
+   */
+  bool AddUe (uint16_t rnti)
+  {
+    if (HasUe (rnti))
+      {
+        return false;
+      }
+    if (rnti >= m_rowOfRnti.size ())
+      {
+        m_rowOfRnti.resize (static_cast<size_t> (rnti) + 1, 0);
+      }
+    if (m_freeRows.empty ())
+      {
+        m_rows.emplace_back ();
+        m_rowOfRnti[rnti] = static_cast<uint32_t> (m_rows.size ());
+      }
+    else
+      {
+        m_rowOfRnti[rnti] = m_freeRows.back () + 1;
+        m_freeRows.pop_back ();
+      }
+    m_ues.insert (std::lower_bound (m_ues.begin (), m_ues.end (), rnti), rnti);
+    return true;
+  }
+
+  /**
+   * \brief Remove a UE and all its LCs. Nothing happens if the UE is not in the table.
+   * \param rnti RNTI of the UE
+   */
+  void RemoveUe (uint16_t rnti)
+  {
+    if (! HasUe (rnti))
+      {
+        return;
+      }
+    const uint32_t row = m_rowOfRnti[rnti] - 1;
+    m_rows[row] = Row ();
+    m_freeRows.push_back (row);
+    m_rowOfRnti[rnti] = 0;
+    m_ues.erase (std::lower_bound (m_ues.begin (), m_ues.end (), rnti));
+  }
+
+  /**
+   * \param rnti RNTI of the UE
+   * \return true if the UE is in the table
+   */
+  bool HasUe (uint16_t rnti) const
+  {
+    return rnti < m_rowOfRnti.size () && m_rowOfRnti[rnti] != 0;
+  }
+
+  /**
+   * \brief Add a LC to a UE of the table, or get it if it already exists
+   * \param rnti RNTI of the UE
+   * \param lcid LCID of the LC
+   * \param created if not null, set to true if the LC did not exist
+   * \return the entry of the LC; a new one has only the LCID set. The
+   * reference is valid until the next AddUe().
+   */
+  Entry & AddLc (uint16_t rnti, uint8_t lcid, bool *created = nullptr)
+  {
+    NS_ASSERT_MSG (HasUe (rnti), "UE " << rnti << " not in the table");
+    NS_ASSERT_MSG (lcid < MAX_LCID, "LCID " << +lcid << " out of range");
+    Row &row = m_rows[m_rowOfRnti[rnti] - 1];
+    const bool isNew = ((row.m_lcMask >> lcid) & 1) == 0;
+    if (isNew)
+      {
+        row.m_lcMask |= 1u << lcid;
+        row.m_lc[lcid] = Entry ();
+        row.m_lc[lcid].m_lcid = lcid;
+      }
+    if (created != nullptr)
+      {
+        *created = isNew;
+      }
+    return row.m_lc[lcid];
+  }
+
+  /**
+   * \brief Release a LC. Nothing happens if the LC does not exist.
+   * \param rnti RNTI of the UE
+   * \param lcid LCID of the LC
+   */
+  void ReleaseLc (uint16_t rnti, uint8_t lcid)
+  {
+    if (HasUe (rnti) && lcid < MAX_LCID)
+      {
+        m_rows[m_rowOfRnti[rnti] - 1].m_lcMask &= ~(1u << lcid);
+      }
+  }
+
+  /**
+   * \brief Release all the LCs of a UE, leaving the UE in the table
+   * \param rnti RNTI of the UE
+   */
+  void ReleaseAllLc (uint16_t rnti)
+  {
+    if (HasUe (rnti))
+      {
+        m_rows[m_rowOfRnti[rnti] - 1].m_lcMask = 0;
+      }
+  }
+
+  /**
+   * \brief Find a LC
+   * \param rnti RNTI of the UE
+   * \param lcid LCID of the LC
+   * \return the entry of the LC, or nullptr if the UE or the LC do not exist
+   */
+  const Entry * Find (uint16_t rnti, uint8_t lcid) const
+  {
+    if (! HasUe (rnti) || lcid >= MAX_LCID)
+      {
+        return nullptr;
+      }
+    const Row &row = m_rows[m_rowOfRnti[rnti] - 1];
+    return ((row.m_lcMask >> lcid) & 1) ? &row.m_lc[lcid] : nullptr;
+  }
+
+  /**
+   * \brief Find the LC of a UE with the lowest LCID that is not lower than minLcid
+   * \param rnti RNTI of the UE
+   * \param minLcid the lowest LCID to consider
+   * \return the entry of the LC, or nullptr if there is no such LC
+   */
+  const Entry * FindFirst (uint16_t rnti, uint8_t minLcid) const
+  {
+    if (! HasUe (rnti) || minLcid >= MAX_LCID)
+      {
+        return nullptr;
+      }
+    const Row &row = m_rows[m_rowOfRnti[rnti] - 1];
+    const uint32_t mask = row.m_lcMask & ~((1u << minLcid) - 1);
+    return mask == 0 ? nullptr : &row.m_lc[__builtin_ctz (mask)];
+  }
+
+  /**
+   * \return the RNTI of the UEs in the table, in increasing order
+   */
+  const std::vector<uint16_t> & GetUes () const
+  {
+    return m_ues;
+  }
+
+private:
+  /**
+   * \brief The LCs of a UE
+   */
+  struct Row
+  {
+    uint32_t m_lcMask {0};                //!< Bit i set if the LC i exists
+    std::array<Entry, MAX_LCID> m_lc {};  //!< Entries, indexed by LCID
+  };
+
+  std::vector<uint32_t> m_rowOfRnti; //!< Row of each RNTI plus one, 0 if the UE is not in the table
+  std::vector<Row> m_rows;           //!< Rows, of the present and of the removed UEs
+  std::vector<uint32_t> m_freeRows;  //!< Rows of the removed UEs
+  std::vector<uint16_t> m_ues;       //!< RNTI of the UEs in the table, sorted
+};
+
+} // namespace ns3
@@ -34,7 +34,7 @@ namespace ns3 {
  * as well as the RLC PDU.
  *
  * The HarqProcess will be stored inside the class MmWaveMacHarqVector, which
- * is a unordered map that maps the HARQ ID with the HARQ content (this struct).
+ * is an array, indexed by the HARQ ID, of pairs between the ID and the HARQ content (this struct).
  */
 struct HarqProcess
 {
@@ -71,6 +71,13 @@ struct HarqProcess
   {
   }
 
+  /**
+   * \brief HarqProcess copy assignment
+   * \param other other instance
+   * \return a reference to this process
+   */
+  HarqProcess & operator= (const HarqProcess &other) = default;
+
   /**
    * \brief HarqProcess value-by-value constructor
    * \param active Is the process active?
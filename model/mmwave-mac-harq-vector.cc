@@ -22,18 +22,19 @@ namespace ns3 {
 bool
 MmWaveMacHarqVector::Erase (uint8_t id)
 {
-  at (id).Erase ();
-  --m_usedSize;
+  NS_ASSERT (Exist (id));
+  NS_ASSERT (IsMarkedActive (id) == m_processes[id].second.m_active);
 
-  uint32_t count = 0;
-  for (const auto & v : *this)
+  if (IsMarkedActive (id))
     {
-      if (v.second.m_active)
-        {
-          ++count;
-        }
+      m_active[id / 64] &= ~(1ULL << (id % 64));
+      --m_usedSize;
     }
-  NS_ASSERT (count == m_usedSize);
+  m_processes[id].second.Erase ();
+
+  NS_ASSERT (static_cast<uint32_t> (__builtin_popcountll (m_active[0]) + __builtin_popcountll (m_active[1]) +
+                                    __builtin_popcountll (m_active[2]) + __builtin_popcountll (m_active[3]))
+             == m_usedSize);
   return true;
 }
 
@@ -53,10 +54,12 @@ MmWaveMacHarqVector::Insert (uint8_t *id, const HarqProcess& element)
       return false;
     }
 
-  NS_ABORT_IF (at (*id).m_active == true);
-  at (*id) = element;
+  HarqProcess & process = m_processes[*id].second;
+  NS_ABORT_IF (process.m_active == true);
+  process = element;
+  m_active[*id / 64] |= 1ULL << (*id % 64);
 
-  NS_ABORT_IF (at (*id).m_active == false);
+  NS_ABORT_IF (process.m_active == false);
   NS_ABORT_IF (this->FirstAvailableId () == *id);
 
   ++m_usedSize;
@@ -66,7 +69,7 @@ MmWaveMacHarqVector::Insert (uint8_t *id, const HarqProcess& element)
 std::ostream &
 operator<< (std::ostream & os, MmWaveMacHarqVector const & item)
 {
-  for (const auto & p : item)
+  for (const auto & p : item.m_processes)
     {
       os << "Process ID " << static_cast<uint32_t> (p.first)
          << ": " << p.second << std::endl;
@@ -17,37 +17,51 @@
  */
 #pragma once
 
-#include <unordered_map>
 #include "mmwave-mac-harq-process.h"
+#include <array>
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
 /**
  * \brief Data structure to save all the HARQ process of an UE
  *
- * The data is stored as an unordered_map between the process ID and the
- * real data, saved in the structure HarqProcess. The vector (yes, it is an
- * improper name) is always full (i.e., it always contains almost 20 HARQ processes)
- * but they can be inactive (i.e., no data is stored there). The duty of finding
- * an empty spot is split between Insert and FirstAvailableId.
+ * The process IDs are dense (from 0 to the maximum size minus one), so the
+ * processes are stored in an array, indexed by their ID, of pairs between the
+ * process ID and the real data, saved in the structure HarqProcess. The
+ * vector is always full (i.e., it always contains almost 20 HARQ processes)
+ * but they can be inactive (i.e., no data is stored there). The active
+ * processes are marked in a bitmask, so finding an empty spot (Insert and
+ * FirstAvailableId) is a search of the first zero bit, and not a scan
+ * of the processes.
+ *
+ * The array is allocated once, by SetMaxSize, and it is never resized after;
+ * the iterators to the processes remain valid across Insert and Erase, so
+ * they can be stored (as the scheduler does between the HARQ feedback
+ * processing and the retransmission) for the entire life of the vector.
  *
  * The class does not support going "out of space", or in other words, if all
  * the spots are filled with active processes, the next insert will fail.
  *
  * \see HarqProcess
  */
-class MmWaveMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
+class MmWaveMacHarqVector
 {
 public:
   friend std::ostream &  operator<< (std::ostream & os, MmWaveMacHarqVector const & item);
   /**
-   * \brief iterator of the map
+   * \brief Element of the vector: the process ID and the process
+   */
+  typedef std::pair<uint8_t, HarqProcess> value_type;
+  /**
+   * \brief iterator of the vector
    */
-  typedef typename std::unordered_map<uint8_t, HarqProcess>::iterator iterator;
+  typedef typename std::vector<value_type>::iterator iterator;
   /**
-   * \brief const_iterator of the map
+   * \brief const_iterator of the vector
    */
-  typedef typename std::unordered_map<uint8_t, HarqProcess>::const_iterator const_iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
 
   /**
     * \brief Default constructor
@@ -58,15 +72,17 @@ public:
    * \brief Set and reserve the size of the vector
    * \param size the vector size
    *
-   * The method will reserve and create the necessary processes.
+   * The method will reserve and create the necessary processes. It should
+   * be called only once, before using the vector.
    */
   void SetMaxSize (uint8_t size)
   {
+    NS_ASSERT (m_processes.empty ());
     m_maxSize = size;
-    reserve (size);
+    m_processes.reserve (size);
     for (auto i = 0; i < size; ++i)
       {
-        emplace (i, HarqProcess ());
+        m_processes.emplace_back (static_cast<uint8_t> (i), HarqProcess ());
       }
   }
 
@@ -88,12 +104,12 @@ public:
   /**
    * \brief Find a process
    * \param key ID of the process to find
-   * \return an iterator to the process
+   * \return an iterator to the process, or End() if the ID does not exist
    */
   const iterator
   Find (uint8_t key)
   {
-    return this->find (key);
+    return Exist (key) ? m_processes.begin () + key : m_processes.end ();
   }
   /**
    * \brief Begin of the vector
@@ -102,7 +118,7 @@ public:
   const iterator
   Begin ()
   {
-    return this->begin ();
+    return m_processes.begin ();
   }
   /**
    * \brief End of the vector
@@ -111,7 +127,7 @@ public:
   const iterator
   End ()
   {
-    return this->end ();
+    return m_processes.end ();
   }
   /**
    * \brief Const begin of the vector
@@ -120,7 +136,7 @@ public:
   const_iterator
   CBegin ()
   {
-    return this->cbegin ();
+    return m_processes.cbegin ();
   }
   /**
    * \brief Const end of the vector
@@ -129,7 +145,7 @@ public:
   const_iterator
   CEnd ()
   {
-    return this->cend ();
+    return m_processes.cend ();
   }
   /**
    * \brief Check if the ID exists in the map
@@ -139,8 +155,7 @@ public:
    */
   bool Exist (uint8_t id) const
   {
-    // could be id > max_size?
-    return find (id) != end ();
+    return id < m_processes.size ();
   }
   /**
    * \brief Get a reference to a process
@@ -150,7 +165,7 @@ public:
   HarqProcess & Get (uint8_t id)
   {
     NS_ASSERT (Exist (id));
-    return find (id)->second;
+    return m_processes[id].second;
   }
   /**
    * \brief Get a const reference to a process
@@ -160,7 +175,7 @@ public:
   const HarqProcess & Get (uint8_t id) const
   {
     NS_ASSERT (Exist (id));
-    return find (id)->second;
+    return m_processes[id].second;
   }
   /**
    * \brief Find the first (INACTIVE) ID
@@ -168,15 +183,37 @@ public:
    */
   uint8_t FirstAvailableId () const
   {
-    for (const auto & it : *this)
+    for (uint32_t w = 0; w < m_active.size (); ++w)
       {
-        if (!it.second.m_active)
+        const uint64_t free = ~m_active[w];
+        if (free != 0)
           {
-            return it.first;
+            const uint32_t id = w * 64 + static_cast<uint32_t> (__builtin_ctzll (free));
+            return id < m_maxSize ? static_cast<uint8_t> (id) : 255;
           }
       }
     return 255;
   }
+  /**
+   * \brief Call a function for each ACTIVE process, in order of ID
+   * \param f function called with the process ID and a reference to the process
+   *
+   * The function can erase the process it receives.
+   */
+  template<typename F>
+  void ForEachActive (F &&f)
+  {
+    for (uint32_t w = 0; w < m_active.size (); ++w)
+      {
+        uint64_t word = m_active[w];
+        while (word != 0)
+          {
+            const uint32_t id = w * 64 + static_cast<uint32_t> (__builtin_ctzll (word));
+            word &= word - 1;
+            f (static_cast<uint8_t> (id), m_processes[id].second);
+          }
+      }
+  }
   /**
    * \brief Can an ID be inserted?
    * \return true if there is space to insert a new process, false otherwise
@@ -195,6 +232,18 @@ public:
   }
 
 private:
+  /**
+   * \brief Is the process active, according to the bitmask?
+   * \param id ID of the process
+   * \return true if the bit of the process is set
+   */
+  bool IsMarkedActive (uint8_t id) const
+  {
+    return (m_active[id / 64] >> (id % 64)) & 1;
+  }
+
+  std::vector<value_type> m_processes;   //!< Processes, indexed by their ID
+  std::array<uint64_t, 4> m_active {{}}; //!< Bitmask of the ACTIVE processes
   uint8_t m_maxSize  {0}; //!< Maximum size (or the number of processes stored)
   uint8_t m_usedSize {0}; //!< Number of ACTIVE processes
 };
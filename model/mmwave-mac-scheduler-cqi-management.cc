@@ -33,6 +33,7 @@
 #include "mmwave-amc.h"
 
 #include <ns3/log.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -40,13 +41,60 @@ NS_LOG_COMPONENT_DEFINE ("MmWaveMacSchedulerCQIManagement");
 
 void
 MmWaveMacSchedulerCQIManagement::DlSBCQIReported (const DlCqiInfo &info,
-                                                  const std::shared_ptr<MmWaveMacSchedulerUeInfo>&ueInfo) const
+                                                  const std::shared_ptr<MmWaveMacSchedulerUeInfo>&ueInfo,
+                                                  uint32_t expirationTime)
 {
   NS_LOG_INFO (this);
-  NS_UNUSED (info);
-  NS_UNUSED (ueInfo);
 
-  // TODO
+  const uint32_t rbPerRbg = m_phyMacConfig->GetNumRbPerRbg ();
+  const uint32_t rbgNum = m_phyMacConfig->GetBandwidthInRbg ();
+  NS_ASSERT_MSG (info.m_rbCqi.size () >= rbgNum * rbPerRbg,
+                 "SB CQI with " << info.m_rbCqi.size () << " RB, expected " <<
+                 rbgNum * rbPerRbg);
+
+  ueInfo->m_dlCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::SB;
+  ueInfo->m_dlCqi.m_cqi = info.m_wbCqi;
+  ueInfo->m_dlCqi.m_expiration = m_dlExpiry.Schedule (ueInfo->m_rnti, expirationTime);
+  m_dlNoCqi.erase (ueInfo->m_rnti);
+  ueInfo->m_dlMcs = static_cast<uint8_t> (m_amc->GetMcsFromCqi (ueInfo->m_dlCqi.m_cqi));
+
+  ueInfo->m_dlCqi.m_rbCqi.resize (info.m_rbCqi.size ());
+  for (uint32_t rb = 0; rb < info.m_rbCqi.size (); ++rb)
+    {
+      ueInfo->m_dlCqi.m_rbCqi[rb] = info.m_rbCqi[rb] == DlCqiInfo::RB_CQI_NOT_MEASURED ? -1 : info.m_rbCqi[rb];
+    }
+
+  ueInfo->m_dlRbgMcs.resize (rbgNum);
+  for (uint32_t rbg = 0; rbg < rbgNum; ++rbg)
+    {
+      int16_t minCqi = INT16_MAX;
+      for (uint32_t rb = rbg * rbPerRbg; rb < (rbg + 1) * rbPerRbg; ++rb)
+        {
+          minCqi = std::min (minCqi, ueInfo->m_dlCqi.m_rbCqi[rb]);
+        }
+
+      if (minCqi < 0)
+        {
+          ueInfo->m_dlRbgMcs[rbg] = ueInfo->m_dlMcs;
+        }
+      else
+        {
+          ueInfo->m_dlRbgMcs[rbg] = static_cast<uint8_t> (m_amc->GetMcsFromCqi (minCqi));
+        }
+    }
+
+  NS_LOG_INFO ("Updated SB CQI of UE " << info.m_rnti << " (WB CQI " <<
+               static_cast<uint32_t> (info.m_wbCqi) << ", WB MCS " <<
+               static_cast<uint32_t> (ueInfo->m_dlMcs) << "). It will expire in " <<
+               expirationTime << " slots.");
+}
+
+void
+MmWaveMacSchedulerCQIManagement::AddUe (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  m_dlNoCqi.insert (rnti);
+  m_ulNoCqi.insert (rnti);
 }
 
 void
@@ -54,7 +102,7 @@ MmWaveMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime,
                                                   uint8_t numSym,
                                                   uint32_t tbs,
                                                   const MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params,
-                                                  const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo) const
+                                                  const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo)
 {
   NS_LOG_INFO (this);
 
@@ -65,7 +113,8 @@ MmWaveMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime,
 
   ueInfo->m_ulCqi.m_sinr = params.m_ulCqi.m_sinr;
   ueInfo->m_ulCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::SB;
-  ueInfo->m_ulCqi.m_timer = expirationTime;
+  ueInfo->m_ulCqi.m_expiration = m_ulExpiry.Schedule (ueInfo->m_rnti, expirationTime);
+  m_ulNoCqi.erase (ueInfo->m_rnti);
 
   uint32_t i = 0;
   for (double value : params.m_ulCqi.m_sinr)
@@ -97,64 +146,105 @@ MmWaveMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime,
 void
 MmWaveMacSchedulerCQIManagement::DlWBCQIReported (const DlCqiInfo &info,
                                                   const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
-                                                  uint32_t expirationTime) const
+                                                  uint32_t expirationTime)
 {
   NS_LOG_INFO (this);
 
   ueInfo->m_dlCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::WB;
   ueInfo->m_dlCqi.m_cqi = info.m_wbCqi;
-  ueInfo->m_dlCqi.m_timer = expirationTime;
+  ueInfo->m_dlCqi.m_expiration = m_dlExpiry.Schedule (ueInfo->m_rnti, expirationTime);
+  m_dlNoCqi.erase (ueInfo->m_rnti);
   ueInfo->m_dlMcs = static_cast<uint8_t> (m_amc->GetMcsFromCqi (ueInfo->m_dlCqi.m_cqi));
   NS_LOG_INFO ("Calculated MCS for UE " << static_cast<uint16_t> (ueInfo->m_rnti) <<
                " is " << static_cast<uint32_t> (ueInfo->m_dlMcs));
 
   NS_LOG_INFO ("Updated WB CQI of UE " << info.m_rnti << " to " <<
                static_cast<uint32_t> (info.m_wbCqi) << ". It will expire in " <<
-               ueInfo->m_dlCqi.m_timer << " slots.");
+               expirationTime << " slots.");
 }
 
-void
-MmWaveMacSchedulerCQIManagement::RefreshDlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &ueMap) const
+MmWaveMacSchedulerCQIManagement::RefreshCost
+MmWaveMacSchedulerCQIManagement::RefreshDlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &ueMap)
 {
   NS_LOG_FUNCTION (this);
 
-  for (const auto &itUe : ueMap)
+  RefreshCost cost;
+  for (auto it = m_dlNoCqi.begin (); it != m_dlNoCqi.end (); )
     {
-      const std::shared_ptr<MmWaveMacSchedulerUeInfo>&ue = itUe.second;
-
-      if (ue->m_dlCqi.m_timer == 0)
+      auto itUe = ueMap.find (*it);
+      if (itUe == ueMap.end ())
         {
-          ue->m_dlCqi.m_cqi = 1; // lowest value for trying a transmission
-          ue->m_dlCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::WB;
-          ue->m_dlMcs = m_startMcsDl;
+          it = m_dlNoCqi.erase (it); // UE removed
+          continue;
         }
-      else
+      itUe->second->m_dlCqi.m_cqi = 1; // lowest value for trying a transmission
+      itUe->second->m_dlCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::WB;
+      itUe->second->m_dlMcs = m_startMcsDl;
+      ++cost.m_noCqi;
+      ++it;
+    }
+
+  cost.m_visited = m_dlExpiry.Advance ([&] (uint16_t rnti, uint64_t slot)
+    {
+      auto itUe = ueMap.find (rnti);
+      if (itUe == ueMap.end () || itUe->second->m_dlCqi.m_expiration != slot)
         {
-          ue->m_dlCqi.m_timer -= 1;
+          return; // UE removed, or CQI updated after this entry
         }
-    }
+
+      const std::shared_ptr<MmWaveMacSchedulerUeInfo>&ue = itUe->second;
+      NS_LOG_INFO ("DL CQI of UE " << rnti << " expired");
+      ue->m_dlCqi.m_cqi = 1; // lowest value for trying a transmission
+      ue->m_dlCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::WB;
+      ue->m_dlCqi.m_rbCqi.clear ();
+      ue->m_dlRbgMcs.clear ();
+      ue->m_dlMcs = m_startMcsDl;
+      m_dlNoCqi.insert (rnti);
+      ++cost.m_expired;
+    });
+
+  return cost;
 }
 
-void
-MmWaveMacSchedulerCQIManagement::RefreshUlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &ueMap) const
+MmWaveMacSchedulerCQIManagement::RefreshCost
+MmWaveMacSchedulerCQIManagement::RefreshUlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &ueMap)
 {
   NS_LOG_FUNCTION (this);
 
-  for (const auto &itUe : ueMap)
+  RefreshCost cost;
+  for (auto it = m_ulNoCqi.begin (); it != m_ulNoCqi.end (); )
     {
-      const std::shared_ptr<MmWaveMacSchedulerUeInfo>&ue = itUe.second;
-
-      if (ue->m_ulCqi.m_timer == 0)
+      auto itUe = ueMap.find (*it);
+      if (itUe == ueMap.end ())
         {
-          ue->m_ulCqi.m_cqi = 1; // lowest value for trying a transmission
-          ue->m_ulCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::WB;
-          ue->m_ulMcs = m_startMcsUl;
+          it = m_ulNoCqi.erase (it); // UE removed
+          continue;
         }
-      else
+      itUe->second->m_ulCqi.m_cqi = 1; // lowest value for trying a transmission
+      itUe->second->m_ulCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::WB;
+      itUe->second->m_ulMcs = m_startMcsUl;
+      ++cost.m_noCqi;
+      ++it;
+    }
+
+  cost.m_visited = m_ulExpiry.Advance ([&] (uint16_t rnti, uint64_t slot)
+    {
+      auto itUe = ueMap.find (rnti);
+      if (itUe == ueMap.end () || itUe->second->m_ulCqi.m_expiration != slot)
         {
-          ue->m_ulCqi.m_timer -= 1;
+          return; // UE removed, or CQI updated after this entry
         }
-    }
+
+      const std::shared_ptr<MmWaveMacSchedulerUeInfo>&ue = itUe->second;
+      NS_LOG_INFO ("UL CQI of UE " << rnti << " expired");
+      ue->m_ulCqi.m_cqi = 1; // lowest value for trying a transmission
+      ue->m_ulCqi.m_cqiType = MmWaveMacSchedulerUeInfo::CqiInfo::WB;
+      ue->m_ulMcs = m_startMcsUl;
+      m_ulNoCqi.insert (rnti);
+      ++cost.m_expired;
+    });
+
+  return cost;
 }
 
 } // namespace ns3
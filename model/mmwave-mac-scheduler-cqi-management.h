@@ -20,12 +20,141 @@
 
 #include "mmwave-phy-mac-common.h"
 #include "mmwave-mac-scheduler-ue-info.h"
+#include <ns3/assert.h>
 #include <memory>
+#include <unordered_set>
+#include <vector>
 
 namespace ns3 {
 
 class MmWaveAmc;
 
+/**
+ * \ingroup mac-schedulers
+ * \brief Timing wheel of CQI expirations, keyed by slot
+ *
+ * The wheel counts the slots by itself: each call to Advance() processes the
+ * current slot, and then moves to the next one. An expiration is stored in
+ * the bucket of its slot, so that Advance() only visits the UEs that have
+ * something expiring in that slot, and not all the attached UEs.
+ *
+ * The entries are never removed before their slot: when a UE reports a new
+ * CQI, the previous entry stays in the wheel, and it is recognized as stale
+ * (and ignored) by the user, because the expiration slot stored in the UE
+ * has changed in the meantime. The number of buckets is a power of two, and
+ * it grows when an expiration is scheduled further than the wheel length.
+ */
+class MmWaveCqiExpiryWheel
+{
+public:
+  /**
+   * \brief Get the current slot
+   * \return the number of times that Advance() has been called
+   */
+  uint64_t GetNow () const
+  {
+    return m_now;
+  }
+
+  /**
+   * \brief Schedule an expiration
+   * \param rnti RNTI of the UE
+   * \param delay slots from now (0 means that the expiration is processed by
+   * the next call to Advance())
+   * \return the slot in which the expiration will be processed
+   */
+  uint64_t Schedule (uint16_t rnti, uint32_t delay)
+  {
+    if (delay >= m_buckets.size ())
+      {
+        Grow (delay + 1);
+      }
+    const uint64_t slot = m_now + delay;
+    m_buckets[slot & (m_buckets.size () - 1)].push_back (Entry (rnti, slot));
+    return slot;
+  }
+
+  /**
+   * \brief Process the expirations of the current slot, and move to the next
+   * \param expire function called with the RNTI and the slot of each entry
+   * \return the number of entries visited
+   */
+  template<typename F>
+  uint32_t Advance (F &&expire)
+  {
+    uint32_t visited = 0;
+    if (! m_buckets.empty ())
+      {
+        std::vector<Entry> &bucket = m_buckets[m_now & (m_buckets.size () - 1)];
+        visited = static_cast<uint32_t> (bucket.size ());
+        for (const Entry &e : bucket)
+          {
+            NS_ASSERT (e.m_slot == m_now);
+            expire (e.m_rnti, e.m_slot);
+          }
+        bucket.clear ();
+      }
+    ++m_now;
+    return visited;
+  }
+
+  /**
+   * \return the number of scheduled entries (stale entries included)
+   */
+  size_t Size () const
+  {
+    size_t size = 0;
+    for (const auto &bucket : m_buckets)
+      {
+        size += bucket.size ();
+      }
+    return size;
+  }
+
+private:
+  /**
+   * \brief An expiration
+   */
+  struct Entry
+  {
+    /**
+     * \brief Entry constructor
+     * \param rnti RNTI
+     * \param slot expiration slot
+     */
+    Entry (uint16_t rnti, uint64_t slot) : m_rnti (rnti), m_slot (slot)
+    {
+    }
+    uint16_t m_rnti {0}; //!< RNTI of the UE
+    uint64_t m_slot {0}; //!< Slot of the expiration
+  };
+
+  /**
+   * \brief Increase the number of buckets, and move the entries to their new bucket
+   * \param minSize minimum number of buckets
+   */
+  void Grow (size_t minSize)
+  {
+    size_t size = 1;
+    while (size < minSize)
+      {
+        size <<= 1;
+      }
+    std::vector<std::vector<Entry> > buckets (size);
+    for (const auto &bucket : m_buckets)
+      {
+        for (const Entry &e : bucket)
+          {
+            buckets[e.m_slot & (size - 1)].push_back (e);
+          }
+      }
+    m_buckets.swap (buckets);
+  }
+
+  std::vector<std::vector<Entry> > m_buckets; //!< Buckets, one for each slot modulo their number
+  uint64_t m_now {0};                         //!< Current slot
+};
+
 /**
  * \ingroup mac-schedulers
  * \brief CQI management for schedulers.
@@ -37,10 +166,21 @@ class MmWaveAmc;
  *
  * \see UlSBCQIReported
  * \see DlWBCQIReported
+ * \see DlSBCQIReported
  */
 class MmWaveMacSchedulerCQIManagement
 {
 public:
+  /**
+   * \brief Cost of a CQI refresh
+   */
+  struct RefreshCost
+  {
+    uint32_t m_visited {0}; //!< Entries of the timing wheel visited
+    uint32_t m_expired {0}; //!< CQI expired and reset to the default value
+    uint32_t m_noCqi {0};   //!< UE without a valid CQI, reset again to the default value
+  };
+
   /**
    * \brief MmWaveMacSchedulerCQIManagement default constructor
    */
@@ -74,6 +214,15 @@ public:
     m_startMcsUl = startMcsUl;
   }
 
+  /**
+   * \brief A new UE has been attached
+   * \param rnti RNTI of the UE
+   *
+   * The UE has not reported any CQI yet, so its DL and UL CQI are reset to
+   * the default by every refresh, until it reports one.
+   */
+  void AddUe (uint16_t rnti);
+
   /**
    * \brief A wideband CQI has been reported for the specified UE
    * \param info WB CQI
@@ -83,18 +232,26 @@ public:
    * Store the CQI information inside the m_dlCqi value of the UE, and then
    * calculate the corresponding MCS through MmWaveAmc. The information is
    * contained in the structure DlCqiInfo, so no need to make calculation
-   * here.
+   * here. The expiration of the CQI is scheduled in the DL timing wheel.
    */
   void DlWBCQIReported (const DlCqiInfo &info, const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
-                        uint32_t expirationTime) const;
+                        uint32_t expirationTime);
   /**
-   * \brief SB CQI reported
+   * \brief A sub-band CQI has been reported for the specified UE
    * \param info SB CQI
    * \param ueInfo UE
+   * \param expirationTime expiration time of the CQI in number of slot
    *
-   * NOT IMPLEMENTED
+   * The wideband part is stored as in DlWBCQIReported, and it gives the
+   * m_dlMcs of the UE. The CQI of each RB is stored inside m_dlCqi.m_rbCqi;
+   * then, for each RBG, the MCS is calculated from the lowest CQI of the
+   * RBs that are part of the RBG, and stored in the m_dlRbgMcs vector of
+   * the UE. If the UE did not report a CQI for some RB of a RBG (the value
+   * is DlCqiInfo::RB_CQI_NOT_MEASURED, because the UE was not receiving
+   * there), the RBG takes the wideband MCS. A CQI of 0 is a measured value.
    */
-  void DlSBCQIReported (const DlCqiInfo &info, const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo) const;
+  void DlSBCQIReported (const DlCqiInfo &info, const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
+                        uint32_t expirationTime);
 
   /**
    * \brief An UL SB CQI has been reported for the specified UE
@@ -116,35 +273,48 @@ public:
    */
   void UlSBCQIReported (uint32_t expirationTime, uint8_t numSym, uint32_t tbs,
                         const MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params,
-                        const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo) const;
+                        const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo);
 
   /**
-   * \brief Refresh the DL CQI for all the UE
+   * \brief Refresh the DL CQI of the UEs
    *
    * This method should be called every slot.
-   * Decrement the validity counter DL CQI, and if a CQI expires, reset its
-   * value to the default (MCS 0)
+   * Reset to the default (CQI 1 and the starting MCS) the CQI of the UEs
+   * that have no valid CQI, because they never reported one or because it
+   * expired; as before the timing wheel, this is done in every slot, so it
+   * overrides any other MCS given to these UEs. Then, advance the DL timing
+   * wheel by one slot, and reset in the same way the CQI of the UEs that
+   * expire in the slot, discarding also the per-RBG MCS of a SB CQI. The UEs
+   * with a valid CQI are not touched.
    *
-   * \param m_ueMap UE map
+   * \param ueMap UE map
+   * \return the cost of the refresh
    */
-  void RefreshDlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &m_ueMap) const;
+  RefreshCost RefreshDlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &ueMap);
 
   /**
-   * \brief Refresh the UL CQI for all the UE
+   * \brief Refresh the UL CQI of the UEs
    *
    * This method should be called every slot.
-   * Decrement the validity counter UL CQI, and if a CQI expires, reset its
-   * value to the default (MCS 0)
+   * Reset to the default (CQI 1 and the starting MCS) the CQI of the UEs
+   * that have no valid CQI, as RefreshDlCqiMaps does. Then, advance the UL
+   * timing wheel by one slot, and reset in the same way the CQI of the UEs
+   * that expire in the slot. The UEs with a valid CQI are not touched.
    *
-   * \param m_ueMap UE map
+   * \param ueMap UE map
+   * \return the cost of the refresh
    */
-  void RefreshUlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &m_ueMap) const;
+  RefreshCost RefreshUlCqiMaps (const std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > &ueMap);
 
 private:
   Ptr<MmWavePhyMacCommon> m_phyMacConfig; //!< PhyMac config
   Ptr<MmWaveAmc> m_amc;                   //!< MmWaveAmc model pointer
   uint8_t m_startMcsDl {0};
   uint8_t m_startMcsUl {0};
+  MmWaveCqiExpiryWheel m_dlExpiry;        //!< Expirations of the DL CQI
+  MmWaveCqiExpiryWheel m_ulExpiry;        //!< Expirations of the UL CQI
+  std::unordered_set<uint16_t> m_dlNoCqi; //!< UEs without a valid DL CQI
+  std::unordered_set<uint16_t> m_ulNoCqi; //!< UEs without a valid UL CQI
 };
 
 } // namespace ns3
@@ -85,8 +85,7 @@ uint8_t MmWaveMacSchedulerHarqRr::ScheduleDlHarq (MmWaveMacSchedulerNs3::PointIn
 
           auto & dciInfoReTx = harqProcess.m_dciElement;
 
-          long rbgAssigned = std::count (dciInfoReTx->m_rbgBitmask.begin (),
-                                         dciInfoReTx->m_rbgBitmask.end (), 1) * dciInfoReTx->m_numSym;
+          long rbgAssigned = dciInfoReTx->m_rbgBitmask.Count () * dciInfoReTx->m_numSym;
           uint32_t rbgAvail = (m_phyMacConfig->GetBandwidthInRbg () - startingPoint->m_rbg) * symPerBeam;
 
           NS_LOG_INFO ("Evaluating space to retransmit HARQ PID=" <<
@@ -136,19 +135,15 @@ uint8_t MmWaveMacSchedulerHarqRr::ScheduleDlHarq (MmWaveMacSchedulerNs3::PointIn
               ++rbgAssigned;
             }
 
-          NS_ABORT_IF (static_cast<unsigned long> (rbgAssigned) > dciInfoReTx->m_rbgBitmask.size ());
+          NS_ABORT_IF (static_cast<unsigned long> (rbgAssigned) > dciInfoReTx->m_rbgBitmask.Size ());
 
-          for (unsigned int i = 0; i < dciInfoReTx->m_rbgBitmask.size (); ++i)
-            {
-              if (startingPoint->m_rbg <= i && i < startingPoint->m_rbg + rbgAssigned)
-                {
-                  dciInfoReTx->m_rbgBitmask.at (i) = 1;
-                }
-              else
-                {
-                  dciInfoReTx->m_rbgBitmask.at (i) = 0;
-                }
-            }
+          // rbgAvail >= rbgAssigned, before the division, keeps the range in the bandwidth
+          NS_ASSERT_MSG (static_cast<unsigned long> (startingPoint->m_rbg + rbgAssigned) <= dciInfoReTx->m_rbgBitmask.Size (),
+                         "RBG " << static_cast<uint32_t> (startingPoint->m_rbg) << "+" << rbgAssigned <<
+                         " beyond the bandwidth of " << dciInfoReTx->m_rbgBitmask.Size () << " RBG");
+          dciInfoReTx->m_rbgBitmask.Reset ();
+          dciInfoReTx->m_rbgBitmask.SetRange (startingPoint->m_rbg,
+                                              static_cast<uint32_t> (startingPoint->m_rbg + rbgAssigned));
 
           startingPoint->m_rbg += rbgAssigned;
 
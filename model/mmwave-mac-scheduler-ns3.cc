@@ -92,6 +92,14 @@ MmWaveMacSchedulerNs3::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&MmWaveMacSchedulerNs3::m_startMcsUl),
                    MakeUintegerChecker<uint8_t> ())
+    .AddTraceSource ("DlCqiRefresh",
+                     "Cost of the DL CQI refresh of each slot",
+                     MakeTraceSourceAccessor (&MmWaveMacSchedulerNs3::m_dlCqiRefreshTrace),
+                     "ns3::MmWaveMacSchedulerNs3::CqiRefreshTracedCallback")
+    .AddTraceSource ("UlCqiRefresh",
+                     "Cost of the UL CQI refresh of each slot",
+                     MakeTraceSourceAccessor (&MmWaveMacSchedulerNs3::m_ulCqiRefreshTrace),
+                     "ns3::MmWaveMacSchedulerNs3::CqiRefreshTracedCallback")
   ;
 
   return tid;
@@ -111,7 +119,16 @@ MmWaveMacSchedulerNs3::ConfigureCommonParameters (Ptr<MmWavePhyMacCommon> config
   m_cqiManagement.ConfigureCommonParameters (m_phyMacConfig, m_amc,
                                              m_startMcsDl, m_startMcsUl);
 
-  NS_ABORT_IF (m_ulAllocationMap.size () > 0);
+  NS_ABORT_IF (m_ulAllocationMap.Size () > 0);
+
+  // UL allocations are stored from the moment they are scheduled
+  // (L1L2CtrlLatency + UlSchedDelay slots in advance) until their UL CQI
+  // is received. The ring is sized with enough margin to cover it.
+  m_ulAllocationMap.Configure (2 * (m_phyMacConfig->GetSlotsPerSubframe () +
+                                    m_phyMacConfig->GetL1L2CtrlLatency () +
+                                    m_phyMacConfig->GetUlSchedDelay ()),
+                               m_phyMacConfig->GetSlotsPerSubframe (),
+                               m_phyMacConfig->GetSubframesPerFrame ());
   SfnSf first (0, 0, 0, 0);
 
   for (uint16_t i = 0; i < m_phyMacConfig->GetL1L2CtrlLatency (); ++i)
@@ -123,7 +140,7 @@ MmWaveMacSchedulerNs3::ConfigureCommonParameters (Ptr<MmWavePhyMacCommon> config
   for (uint16_t i = 0; i < m_phyMacConfig->GetUlSchedDelay (); ++i)
     {
       NS_LOG_INFO ("Creating dummy UL allocation for slot " << first);
-      m_ulAllocationMap.emplace (first.Encode (), SlotElem (0));
+      m_ulAllocationMap.Insert (first, SlotElem (0));
       first = first.IncreaseNoOfSlots (m_phyMacConfig->GetSlotsPerSubframe (),
                                        m_phyMacConfig->GetSubframesPerFrame ());
     }
@@ -204,6 +221,7 @@ MmWaveMacSchedulerNs3::DoCschedUeConfigReq (const MmWaveMacCschedSapProvider::Cs
       UeInfoOf (*itUe)->m_ulHarq.SetMaxSize (static_cast<uint8_t> (m_phyMacConfig->GetNumHarqProcess ()));
       UeInfoOf (*itUe)->m_dlMcs = m_startMcsDl;
       UeInfoOf (*itUe)->m_ulMcs = m_startMcsUl;
+      m_cqiManagement.AddUe (params.m_rnti);
       if (m_fixedMcsDl)
         {
           UeInfoOf (*itUe)->m_dlMcs = m_mcsDefaultDl;
@@ -500,7 +518,7 @@ MmWaveMacSchedulerNs3::DoSchedDlCqiInfoReq (const MmWaveMacSchedSapProvider::Sch
         }
       else
         {
-          m_cqiManagement.DlSBCQIReported (cqi, ue);
+          m_cqiManagement.DlSBCQIReported (cqi, ue, expirationTime);
         }
     }
 }
@@ -547,10 +565,10 @@ MmWaveMacSchedulerNs3::DoSchedUlCqiInfoReq (const MmWaveMacSchedSapProvider::Sch
                      " modified allocation " << ulSfnSf <<
                      " sym Start " << static_cast<uint32_t> (symStart));
 
-        auto itAlloc = m_ulAllocationMap.find (ulSfnSf.Encode ());
-        NS_ASSERT_MSG (itAlloc != m_ulAllocationMap.end (),
+        SlotElem *slotElem = m_ulAllocationMap.Find (ulSfnSf);
+        NS_ASSERT_MSG (slotElem != nullptr,
                        "Can't find allocation for " << ulSfnSf);
-        std::vector<AllocElem> & ulAllocations = itAlloc->second.m_ulAllocations;
+        std::vector<AllocElem> & ulAllocations = slotElem->m_ulAllocations;
 
         for (auto it = ulAllocations.cbegin (); it != ulAllocations.cend (); ++it)
           {
@@ -577,7 +595,7 @@ MmWaveMacSchedulerNs3::DoSchedUlCqiInfoReq (const MmWaveMacSchedSapProvider::Sch
           {
             // remove obsolete info on allocation; we already processed all the CQI
             NS_LOG_INFO ("Removing allocation for " << ulSfnSf);
-            m_ulAllocationMap.erase (itAlloc);
+            m_ulAllocationMap.Erase (ulSfnSf);
           }
       }
       break;
@@ -690,8 +708,8 @@ MmWaveMacSchedulerNs3::ProcessHARQFeedbacks (std::vector<T> *harqInfo,
  * \param rnti RNTI of the user
  * \param harq HARQ process list
  *
- * For each process, check its timer. If it is expired, reset the
- * process.
+ * For each active process, check its timer. If it is expired, reset the
+ * process. The inactive processes are not visited.
  *
  * \see MmWaveMacHarqVector
  * \see HarqProcess
@@ -701,14 +719,11 @@ MmWaveMacSchedulerNs3::ResetExpiredHARQ (uint16_t rnti, MmWaveMacHarqVector *har
 {
   NS_LOG_FUNCTION (this << harq);
 
-  for (auto harqIt = harq->Begin (); harqIt != harq->End (); ++harqIt)
+  harq->ForEachActive ([this, rnti, harq] (uint8_t processId, HarqProcess & process)
     {
-      HarqProcess & process = harqIt->second;
-      uint8_t processId = harqIt->first;
-
       if (process.m_status == HarqProcess::INACTIVE)
         {
-          continue;
+          return;
         }
 
       if (process.m_timer < m_phyMacConfig->GetHarqTimeout ())
@@ -724,7 +739,7 @@ MmWaveMacSchedulerNs3::ResetExpiredHARQ (uint16_t rnti, MmWaveMacHarqVector *har
           NS_LOG_INFO ("Erased process for UE " << rnti << " number " <<
                        static_cast<uint32_t> (processId) << " for time limits");
         }
-    }
+    });
 }
 
 /**
@@ -740,10 +755,10 @@ MmWaveMacSchedulerNs3::PrependCtrlSym (uint8_t symStart, uint8_t numSymToAllocat
                                        VarTtiAllocInfo::TddMode mode,
                                        std::deque<VarTtiAllocInfo> *allocations) const
 {
-  std::vector<uint8_t> rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), 1);
+  RbgBitmask rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), true);
 
-  NS_ASSERT_MSG (rbgBitmask.size () == m_phyMacConfig->GetBandwidthInRbg (),
-                 "bitmask size " << rbgBitmask.size () << " conf " <<
+  NS_ASSERT_MSG (rbgBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg (),
+                 "bitmask size " << rbgBitmask.Size () << " conf " <<
                  m_phyMacConfig->GetBandwidthInRbg ());
   if (mode == VarTtiAllocInfo::DL)
     {
@@ -776,9 +791,9 @@ MmWaveMacSchedulerNs3::AppendCtrlSym (uint8_t symStart, uint8_t numSymToAllocate
                                       VarTtiAllocInfo::TddMode mode,
                                       std::deque<VarTtiAllocInfo> *allocations) const
 {
-  std::vector<uint8_t> rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), 1);
+  RbgBitmask rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), true);
 
-  NS_ASSERT (rbgBitmask.size () == m_phyMacConfig->GetBandwidthInRbg ());
+  NS_ASSERT (rbgBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg ());
   if (mode == VarTtiAllocInfo::DL)
     {
       NS_ASSERT (allocations->size () == 0); // no previous allocations
@@ -1459,9 +1474,8 @@ MmWaveMacSchedulerNs3::ScheduleDl (const MmWaveMacSchedSapProvider::SchedDlTrigg
 
   MmWaveMacSchedSapUser::SchedConfigIndParameters dlSlot (params.m_snfSf);
   dlSlot.m_slotAllocInfo.m_sfnSf = params.m_snfSf;
-  NS_ASSERT (m_ulAllocationMap.find (params.m_snfSf.Encode ()) != m_ulAllocationMap.end ());
-  auto ulAllocationIt = m_ulAllocationMap.find (params.m_snfSf.Encode ()); // UL allocations for this slot
-  auto & ulAllocations = ulAllocationIt->second;
+  NS_ASSERT (m_ulAllocationMap.Contains (params.m_snfSf));
+  auto & ulAllocations = m_ulAllocationMap.At (params.m_snfSf); // UL allocations for this slot
 
   // add slot for DL control, at symbol 0
   PrependCtrlSym (0, m_phyMacConfig->GetDlCtrlSymbols (), VarTtiAllocInfo::DL,
@@ -1475,8 +1489,8 @@ MmWaveMacSchedulerNs3::ScheduleDl (const MmWaveMacSchedSapProvider::SchedDlTrigg
   if (ulAllocations.m_totUlSym == 0)
     {
       NS_LOG_INFO ("Removing UL allocation for slot " << params.m_snfSf <<
-                   " size " << m_ulAllocationMap.size ());
-      m_ulAllocationMap.erase (ulAllocationIt);
+                   " size " << m_ulAllocationMap.Size ());
+      m_ulAllocationMap.Erase (params.m_snfSf);
     }
 
   NS_LOG_INFO ("Total DCI for DL : " << dlSlot.m_slotAllocInfo.m_varTtiAllocInfo.size () <<
@@ -1604,7 +1618,10 @@ MmWaveMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedb
   uint8_t ulSymAvail = dataSymPerSlot;
 
   // Create the UL allocation map entry
-  m_ulAllocationMap.emplace (ulSfn.Encode (), SlotElem (0));
+  if (! m_ulAllocationMap.Contains (ulSfn))
+    {
+      m_ulAllocationMap.Insert (ulSfn, SlotElem (0));
+    }
 
   NS_LOG_DEBUG ("Scheduling UL frame " << static_cast<uint32_t> (ulSfn.m_frameNum) <<
                 " subframe " << static_cast<uint32_t> (ulSfn.m_subframeNum) <<
@@ -1651,8 +1668,8 @@ MmWaveMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedb
 
   if (allocInfo->m_varTtiAllocInfo.size () > 0)
     {
-      auto & totUlSym = m_ulAllocationMap.at (ulSfn.Encode ()).m_totUlSym;
-      auto & allocations = m_ulAllocationMap.at (ulSfn.Encode ()).m_ulAllocations;
+      auto & totUlSym = m_ulAllocationMap.At (ulSfn).m_totUlSym;
+      auto & allocations = m_ulAllocationMap.At (ulSfn).m_ulAllocations;
       for (const auto &alloc : allocInfo->m_varTtiAllocInfo)
         {
           if (alloc.m_varTtiType == VarTtiAllocInfo::DATA && alloc.m_tddMode == VarTtiAllocInfo::UL)
@@ -1771,7 +1788,8 @@ MmWaveMacSchedulerNs3::DoSchedDlTriggerReq (const MmWaveMacSchedSapProvider::Sch
   NS_LOG_FUNCTION (this);
 
   // process received CQIs
-  m_cqiManagement.RefreshDlCqiMaps (m_ueMap);
+  auto cqiRefresh = m_cqiManagement.RefreshDlCqiMaps (m_ueMap);
+  m_dlCqiRefreshTrace (cqiRefresh.m_visited + cqiRefresh.m_noCqi, cqiRefresh.m_expired);
 
   // reset expired HARQ
   for (const auto & itUe : m_ueMap)
@@ -1865,7 +1883,8 @@ MmWaveMacSchedulerNs3::DoSchedUlTriggerReq (const MmWaveMacSchedSapProvider::Sch
   NS_LOG_FUNCTION (this);
 
   // process received CQIs
-  m_cqiManagement.RefreshUlCqiMaps (m_ueMap);
+  auto cqiRefresh = m_cqiManagement.RefreshUlCqiMaps (m_ueMap);
+  m_ulCqiRefreshTrace (cqiRefresh.m_visited + cqiRefresh.m_noCqi, cqiRefresh.m_expired);
 
   // reset expired HARQ
   for (const auto & itUe : m_ueMap)
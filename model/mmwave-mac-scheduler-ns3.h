@@ -25,6 +25,8 @@
 #include "mmwave-mac-scheduler-lcg.h"
 #include "mmwave-mac-scheduler-cqi-management.h"
 #include "mmwave-amc.h"
+#include "mmwave-slot-ring.h"
+#include <ns3/traced-callback.h>
 #include <memory>
 #include <functional>
 #include <list>
@@ -127,12 +129,17 @@ class MmWaveSchedGeneralTestCase;
  *
  * \section Refreshing CQI
  *
- * The refreshing of CQI consists in evaluating the validity timer of the value.
- * If the timer is equal to 0, the valued is expired, and the value is reset
- * to the default (MCS 0). The operation is managed inside the class
+ * The refreshing of CQI consists in resetting to the default (MCS 0) the
+ * values that expire in the slot. The operation is managed inside the class
  * MmWaveMacSchedulerCQIManagement, with the two functions
- * MmWaveMacSchedulerCQIManagement::RefreshDlCQIMaps and
- * MmWaveMacSchedulerCQIManagement::RefreshUlCQIMaps.
+ * MmWaveMacSchedulerCQIManagement::RefreshDlCqiMaps and
+ * MmWaveMacSchedulerCQIManagement::RefreshUlCqiMaps. The expirations are
+ * stored in a timing wheel (MmWaveCqiExpiryWheel), so the refresh only touches
+ * the UEs whose CQI expires in the slot, and the UEs that have no valid CQI
+ * (they never reported one, or it expired), which are reset in every slot
+ * until they report a CQI. The
+ * cost of each refresh is exported through the trace sources DlCqiRefresh
+ * and UlCqiRefresh.
  *
  * \section Process HARQ feedbacks
  *
@@ -329,6 +336,15 @@ public:
    */
   typedef std::unordered_map<BeamId, HarqVectorIteratorList, BeamIdHash> ActiveHarqMap;
 
+  /**
+   * TracedCallback signature for the cost of the CQI refresh of a slot
+   *
+   * \param [in] visited number of entries of the CQI timing wheel, and of UEs
+   * without a valid CQI, visited
+   * \param [in] expired number of CQI expired in the slot
+   */
+  typedef void (* CqiRefreshTracedCallback)(uint32_t visited, uint32_t expired);
+
 protected:
   /**
    * \brief Create an UE representation for the scheduler.
@@ -565,9 +581,9 @@ private:
   struct SlotElem
   {
     /**
-     * \brief SlotElem default constructor (deleted)
+     * \brief SlotElem default constructor (needed by MmWaveSlotRing)
      */
-    SlotElem () = delete;
+    SlotElem () = default;
     /**
       * \brief SlotElem default copy constructor
       */
@@ -582,7 +598,7 @@ private:
 
     }
 
-    uint8_t m_totUlSym;  //!< Total symbols used for UL
+    uint8_t m_totUlSym {0};  //!< Total symbols used for UL
     std::vector<AllocElem> m_ulAllocations; //!< List of UL allocations
   };
 
@@ -643,10 +659,10 @@ private:
   std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > m_ueMap; //!< The map of between RNTI and their data
 
   /**
-   * Map of previous allocated UE per RBG
+   * Ring of previous allocated UE per slot
    * (used to retrieve info from UL-CQI)
    */
-  std::map <uint64_t, SlotElem> m_ulAllocationMap;
+  MmWaveSlotRing<SlotElem> m_ulAllocationMap;
 
   bool    m_fixedMcsDl {false}; //!< Fixed MCS for *all* UE in DL
   bool    m_fixedMcsUl {false}; //!< Fixed MCS for *all* UE in UL
@@ -658,6 +674,9 @@ private:
 
   MmWaveMacSchedulerCQIManagement m_cqiManagement; //!< CQI Management
 
+  TracedCallback<uint32_t, uint32_t> m_dlCqiRefreshTrace; //!< Cost of the DL CQI refresh of each slot
+  TracedCallback<uint32_t, uint32_t> m_ulCqiRefreshTrace; //!< Cost of the UL CQI refresh of each slot
+
   std::vector <DlHarqInfo> m_dlHarqToRetransmit; //!< List of DL HARQ that could not have been retransmitted
   std::vector <UlHarqInfo> m_ulHarqToRetransmit; //!< List of UL HARQ that could not have been retransmitted
 
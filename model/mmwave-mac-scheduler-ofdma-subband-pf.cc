@@ -0,0 +1,272 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#define NS_LOG_APPEND_CONTEXT                                            \
+  do                                                                     \
+    {                                                                    \
+      if (m_phyMacConfig)                                                \
+        {                                                                \
+          std::clog << " [ccId "                                         \
+                    << static_cast<uint32_t> (m_phyMacConfig->GetCcId ())\
+                    << "] ";                                             \
+        }                                                                \
+    }                                                                    \
+  while (false);
+#include "mmwave-mac-scheduler-ofdma-subband-pf.h"
+#include "mmwave-mac-scheduler-ue-info-pf.h"
+#include <ns3/double.h>
+#include <ns3/log.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveMacSchedulerOfdmaSubbandPF");
+NS_OBJECT_ENSURE_REGISTERED (MmWaveMacSchedulerOfdmaSubbandPF);
+
+TypeId
+MmWaveMacSchedulerOfdmaSubbandPF::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MmWaveMacSchedulerOfdmaSubbandPF")
+    .SetParent<MmWaveMacSchedulerOfdmaRR> ()
+    .AddConstructor<MmWaveMacSchedulerOfdmaSubbandPF> ()
+    .AddAttribute ("FairnessIndex",
+                   "Value (between 0 and 1) that defines the PF metric (1 is the traditional 3GPP PF, 0 is RR in throughput",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&MmWaveMacSchedulerOfdmaSubbandPF::m_alpha),
+                   MakeDoubleChecker<float> (0, 1))
+    .AddAttribute ("LastAvgTPutWeight",
+                   "Weight of the last average throughput in the average throughput calculation",
+                   DoubleValue (99),
+                   MakeDoubleAccessor (&MmWaveMacSchedulerOfdmaSubbandPF::m_timeWindow),
+                   MakeDoubleChecker<float> (0))
+  ;
+  return tid;
+}
+
+MmWaveMacSchedulerOfdmaSubbandPF::MmWaveMacSchedulerOfdmaSubbandPF () : MmWaveMacSchedulerOfdmaRR ()
+{
+}
+
+std::shared_ptr<MmWaveMacSchedulerUeInfo>
+MmWaveMacSchedulerOfdmaSubbandPF::CreateUeRepresentation (const MmWaveMacCschedSapProvider::CschedUeConfigReqParameters &params) const
+{
+  NS_LOG_FUNCTION (this);
+  // The weights are the inverse of the average throughput, which must be finite
+  return std::make_shared <MmWaveMacSchedulerUeInfoPF> (m_alpha, params.m_rnti, params.m_beamId, true);
+}
+
+std::function<bool(const MmWaveMacSchedulerNs3::UePtrAndBufferReq &lhs,
+                   const MmWaveMacSchedulerNs3::UePtrAndBufferReq &rhs )>
+MmWaveMacSchedulerOfdmaSubbandPF::GetUeCompareDlFn () const
+{
+  return MmWaveMacSchedulerUeInfoPF::CompareUeWeightsDl;
+}
+
+void
+MmWaveMacSchedulerOfdmaSubbandPF::AssignedDlResources (const UePtrAndBufferReq &ue,
+                                                       const FTResources &assigned,
+                                                       const FTResources &totAssigned) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_UNUSED (assigned);
+  auto uePtr = std::dynamic_pointer_cast<MmWaveMacSchedulerUeInfoPF> (ue.first);
+  uePtr->UpdateDlPFMetric (totAssigned, m_timeWindow, m_phyMacConfig, m_amc);
+}
+
+void
+MmWaveMacSchedulerOfdmaSubbandPF::NotAssignedDlResources (const UePtrAndBufferReq &ue,
+                                                          const FTResources &notAssigned,
+                                                          const FTResources &totAssigned) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_UNUSED (notAssigned);
+  auto uePtr = std::dynamic_pointer_cast<MmWaveMacSchedulerUeInfoPF> (ue.first);
+  uePtr->UpdateDlPFMetric (totAssigned, m_timeWindow, m_phyMacConfig, m_amc);
+}
+
+/**
+ * \brief Assign the available DL RBG to the UEs, one RBG at a time
+ * \param symAvail Available symbols
+ * \param activeDl Map of active UE and their beams
+ * \return a map between beams and the symbol they need
+ *
+ * For each beam, the numerator of the PF metric of each UE in each RBG is
+ * stored in m_metric, and the weight (the inverse of the average throughput)
+ * of each UE in a vector. Then, for each RBG:
+ * <pre>
+ * winner = m_metric.ArgMax (rbg, weights);
+ * winner.m_dlRbgBitmask.Set (rbg);
+ * winner.m_dlRBG += sym_of_beam;
+ * mcs[winner] = min (mcs[winner], mcs of winner in rbg);
+ * UpdateDlPFMetric (winner, mcs[winner]);
+ * weights[winner] = bufferCovered (winner) ? 0 : 1 / avgTput (winner);
+ * </pre>
+ *
+ * The UEs that did not get any RBG have their metric updated only once, at
+ * the end of the beam, since their state does not change between two RBG.
+ * The lowest MCS of the RBG of each UE is local to the slot: m_dlMcs keeps
+ * the wideband MCS, and CreateDlDci() computes the MCS of the DCI again
+ * from the RBG assigned.
+ */
+MmWaveMacSchedulerNs3::BeamSymbolMap
+MmWaveMacSchedulerOfdmaSubbandPF::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_LOG_DEBUG ("# beams active flows: " << activeDl.size () << ", # sym: " << symAvail);
+
+  GetFirst GetBeamId;
+  GetSecond GetUeVector;
+  GetFirst GetUe;
+  BeamSymbolMap symPerBeam = GetSymPerBeam (symAvail, activeDl);
+
+  const uint32_t rbgNum = m_phyMacConfig->GetBandwidthInRbg ();
+
+  // Numerator of the PF metric for each MCS, for one RBG
+  std::array<double, 29> mcsMetric;
+  for (uint32_t mcs = 0; mcs < mcsMetric.size (); ++mcs)
+    {
+      mcsMetric[mcs] = std::pow (m_amc->GetSpectralEfficiency (mcs, m_phyMacConfig->GetNumRbPerRbg ()),
+                                 m_alpha);
+    }
+
+  for (const auto &el : activeDl)
+    {
+      const uint32_t beamSym = symPerBeam.at (GetBeamId (el));
+      const std::vector<UePtrAndBufferReq> & ueVector = GetUeVector (el);
+      const uint32_t ueNum = static_cast<uint32_t> (ueVector.size ());
+      FTResources assigned (0,0);
+
+      if (beamSym == 0 || ueNum == 0)
+        {
+          continue;
+        }
+
+      std::vector<double> weights (ueNum);
+      std::vector<uint8_t> worstMcs (ueNum);
+      m_metric.Resize (rbgNum, ueNum);
+
+      for (uint32_t i = 0; i < ueNum; ++i)
+        {
+          const auto & ue = GetUe (ueVector[i]);
+          ue->m_dlRbgBitmask = RbgBitmask (rbgNum);
+          // The average throughput of the slot is not updated yet: start from
+          // the value that the UE would have without any resource in this slot
+          auto uePf = std::dynamic_pointer_cast<MmWaveMacSchedulerUeInfoPF> (ue);
+          weights[i] = 1.0 / std::max (1E-9, (1.0 - (1.0 / m_timeWindow)) * uePf->m_lastAvgTputDl);
+
+          const bool subband = ue->m_dlRbgMcs.size () == rbgNum;
+          worstMcs[i] = subband ? UINT8_MAX : ue->m_dlMcs;
+          for (uint32_t rbg = 0; rbg < rbgNum; ++rbg)
+            {
+              const uint8_t mcs = subband ? ue->m_dlRbgMcs[rbg] : ue->m_dlMcs;
+              NS_ASSERT (mcs < mcsMetric.size ());
+              m_metric.At (rbg, i) = mcsMetric[mcs];
+            }
+        }
+
+      for (uint32_t rbg = 0; rbg < rbgNum; ++rbg)
+        {
+          const uint32_t winner = m_metric.ArgMax (rbg, weights);
+          if (winner == ueNum)
+            {
+              // All the UE already have their requirements fullfilled
+              break;
+            }
+
+          const UePtrAndBufferReq & ue = ueVector[winner];
+          const auto & uePtr = GetUe (ue);
+          if (uePtr->m_dlRbgMcs.size () == rbgNum)
+            {
+              worstMcs[winner] = std::min (worstMcs[winner], uePtr->m_dlRbgMcs[rbg]);
+            }
+
+          uePtr->m_dlRbgBitmask.Set (rbg);
+          uePtr->m_dlRBG += beamSym;
+          uePtr->m_dlSym = beamSym;
+          assigned.m_rbg += beamSym;
+          assigned.m_sym = beamSym;
+
+          NS_LOG_DEBUG ("Assigned RBG " << rbg << ", spanned over " << beamSym <<
+                        " SYM, to UE " << uePtr->m_rnti);
+          auto uePf = std::dynamic_pointer_cast<MmWaveMacSchedulerUeInfoPF> (uePtr);
+          uePf->UpdateDlPFMetric (assigned, m_timeWindow, m_phyMacConfig, m_amc, worstMcs[winner]);
+
+          if (uePtr->m_dlTbSize >= ue.second)
+            {
+              weights[winner] = 0.0;
+            }
+          else
+            {
+              weights[winner] = 1.0 / std::max (1E-9, uePf->m_avgTputDl);
+            }
+        }
+
+      for (const auto & ue : ueVector)
+        {
+          if (GetUe (ue)->m_dlRBG == 0)
+            {
+              GetUe (ue)->m_dlRbgBitmask = RbgBitmask ();
+              if (assigned.m_sym > 0)
+                {
+                  NotAssignedDlResources (ue, FTResources (rbgNum, 1), assigned);
+                }
+            }
+        }
+    }
+
+  return symPerBeam;
+}
+
+/**
+ * \brief Create the DL DCI with the lowest MCS of the RBG assigned to the UE
+ * \param spoint Starting point
+ * \param ueInfo UE representation
+ * \param maxSym Maximum symbols to use
+ * \return a pointer to the newly created instance
+ *
+ * The MCS is the same that AssignDLRBG() used for the metric of the UE. With
+ * a wideband CQI, it is the MCS of the UE.
+ */
+std::shared_ptr<DciInfoElementTdma>
+MmWaveMacSchedulerOfdmaSubbandPF::CreateDlDci (PointInFTPlane *spoint,
+                                               const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
+                                               uint32_t maxSym) const
+{
+  NS_LOG_FUNCTION (this);
+
+  const uint32_t rbgNum = m_phyMacConfig->GetBandwidthInRbg ();
+  if (ueInfo->m_dlRbgMcs.size () != rbgNum || ueInfo->m_dlRbgBitmask.Size () != rbgNum)
+    {
+      return MmWaveMacSchedulerOfdma::CreateDlDci (spoint, ueInfo, maxSym, ueInfo->m_dlMcs);
+    }
+
+  uint8_t mcs = UINT8_MAX;
+  ueInfo->m_dlRbgBitmask.ForEachSetBit ([&mcs, &ueInfo] (uint32_t rbg)
+    {
+      mcs = std::min (mcs, ueInfo->m_dlRbgMcs[rbg]);
+    });
+  NS_ASSERT (mcs != UINT8_MAX);
+
+  return MmWaveMacSchedulerOfdma::CreateDlDci (spoint, ueInfo, maxSym, mcs);
+}
+
+} // namespace ns3
@@ -0,0 +1,226 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#pragma once
+
+#include "mmwave-mac-scheduler-ofdma-rr.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mac-schedulers
+ * \brief Matrix of per-RBG metrics, with one row for each RBG and one column
+ * for each UE
+ *
+ * The values of a RBG are contiguous in memory, so that finding the UE
+ * with the highest weighted metric in a RBG is a single linear pass over a
+ * contiguous array. The storage is reused between slots.
+ */
+class MmWavePfRbgMetricMatrix
+{
+public:
+  /**
+   * \brief Resize the matrix (the values are not initialized)
+   * \param numRbg number of RBG (rows)
+   * \param numUe number of UE (columns)
+   */
+  void Resize (uint32_t numRbg, uint32_t numUe)
+  {
+    m_numRbg = numRbg;
+    m_numUe = numUe;
+    m_values.resize (static_cast<size_t> (numRbg) * numUe);
+  }
+
+  /**
+   * \return the number of RBG
+   */
+  uint32_t GetNumRbg () const
+  {
+    return m_numRbg;
+  }
+
+  /**
+   * \return the number of UE
+   */
+  uint32_t GetNumUe () const
+  {
+    return m_numUe;
+  }
+
+  /**
+   * \brief Access a value
+   * \param rbg the RBG
+   * \param ue the UE index
+   * \return a reference to the value
+   */
+  double & At (uint32_t rbg, uint32_t ue)
+  {
+    NS_ASSERT (rbg < m_numRbg && ue < m_numUe);
+    return m_values[static_cast<size_t> (rbg) * m_numUe + ue];
+  }
+
+  /**
+   * \brief Find the UE with the highest metric in a RBG
+   * \param rbg the RBG
+   * \param weights weight of each UE (a weight of 0 excludes the UE)
+   * \return the index of the UE that maximizes value * weight (the first one
+   * in case of ties), or GetNumUe() if no UE has a positive weighted metric
+   */
+  uint32_t ArgMax (uint32_t rbg, const std::vector<double> &weights) const
+  {
+    NS_ASSERT (rbg < m_numRbg && weights.size () >= m_numUe);
+    const double *row = m_values.data () + static_cast<size_t> (rbg) * m_numUe;
+    const double *w = weights.data ();
+    double best = 0.0;
+    uint32_t bestUe = m_numUe;
+    for (uint32_t ue = 0; ue < m_numUe; ++ue)
+      {
+        const double v = row[ue] * w[ue];
+        if (v > best)
+          {
+            best = v;
+            bestUe = ue;
+          }
+      }
+    return bestUe;
+  }
+
+private:
+  std::vector<double> m_values; //!< Values, RBG-major
+  uint32_t m_numRbg {0};        //!< Number of RBG
+  uint32_t m_numUe {0};         //!< Number of UE
+};
+
+/**
+ * \ingroup mac-schedulers
+ * \brief Frequency-selective (sub-band) proportional fair OFDMA scheduler
+ *
+ * The symbols of each beam are calculated as in MmWaveMacSchedulerOfdma, but
+ * the RBG are not distributed in a contiguous way. Each RBG is assigned to the
+ * UE with the highest PF metric in that RBG:
+ *
+ * \f$ pfMetric_{i,r} = std::pow(se_{i,r}, alpha) / std::max (1E-9, m_avgTput_{i}) \f$
+ *
+ * where \f$ se_{i,r} \f$ is the spectral efficiency of the MCS of the UE i
+ * in the RBG r. The MCS of each RBG comes from the sub-band CQI
+ * (MmWaveMacSchedulerCQIManagement::DlSBCQIReported, enabled by the
+ * attribute MmWaveUePhy::SubbandCqi); with a wideband CQI, all the RBG have
+ * the wideband MCS and the scheduler behaves as a PF scheduler.
+ *
+ * At the beginning of each beam the numerators are stored in a RBG x UE
+ * MmWavePfRbgMetricMatrix; the RBG are then visited in order, and the winner
+ * of each one is found with a linear pass over the row of the RBG. Only the
+ * weight (the inverse of the average throughput) of the winner changes after
+ * an assignment, so the cost for each beam is O(RBG x UE), without sorting.
+ * The UEs whose buffer is already covered by the assigned resources are
+ * excluded, as in MmWaveMacSchedulerOfdma::AssignDLRBG().
+ *
+ * The MCS of the transmission is the lowest MCS among the RBG assigned to
+ * the UE; it is kept for the slot only, so MmWaveMacSchedulerUeInfo::m_dlMcs
+ * remains the wideband MCS. The RBG are stored in
+ * MmWaveMacSchedulerUeInfo::m_dlRbgBitmask and they are then copied as they
+ * are in the DCI.
+ *
+ * UL is scheduled as in MmWaveMacSchedulerOfdmaRR.
+ */
+class MmWaveMacSchedulerOfdmaSubbandPF : public MmWaveMacSchedulerOfdmaRR
+{
+public:
+  /**
+   * \brief GetTypeId
+   * \return The TypeId of the class
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief MmWaveMacSchedulerOfdmaSubbandPF constructor
+   */
+  MmWaveMacSchedulerOfdmaSubbandPF ();
+
+  /**
+   * \brief ~MmWaveMacSchedulerOfdmaSubbandPF deconstructor
+   */
+  virtual ~MmWaveMacSchedulerOfdmaSubbandPF () override
+  {
+  }
+
+protected:
+  /**
+   * \brief Create an UE representation of the type MmWaveMacSchedulerUeInfoPF
+   * \param params parameters
+   * \return MmWaveMacSchedulerUeInfoPF instance
+   */
+  virtual std::shared_ptr<MmWaveMacSchedulerUeInfo>
+  CreateUeRepresentation (const MmWaveMacCschedSapProvider::CschedUeConfigReqParameters& params) const override;
+
+  /**
+   * \brief Assign the DL RBG, one by one, to the UE with the best metric in each RBG
+   * \param symAvail Available symbols
+   * \param activeDl Map of active UE and their beams
+   * \return a map between beams and the symbol they need
+   */
+  virtual BeamSymbolMap
+  AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const override;
+
+  /**
+   * \brief Create the DL DCI, with the lowest MCS of the RBG assigned to the UE
+   * \param spoint Starting point
+   * \param ueInfo UE representation
+   * \param maxSym Maximum symbols to use
+   * \return a pointer to the newly created instance
+   */
+  virtual std::shared_ptr<DciInfoElementTdma>
+  CreateDlDci (PointInFTPlane *spoint, const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
+               uint32_t maxSym) const override;
+
+  /**
+   * \brief Return the comparison function to sort DL UE according to the scheduler policy
+   * \return a pointer to MmWaveMacSchedulerUeInfoPF::CompareUeWeightsDl
+   */
+  virtual std::function<bool(const MmWaveMacSchedulerNs3::UePtrAndBufferReq &lhs,
+                             const MmWaveMacSchedulerNs3::UePtrAndBufferReq &rhs )>
+  GetUeCompareDlFn () const override;
+
+  /**
+   * \brief Update the PF metric of the UE after a RBG has been assigned to it
+   * \param ue UE to which a RBG has been assigned
+   * \param assigned the amount of resources assigned
+   * \param totAssigned the total amount of resources assigned in the slot
+   */
+  virtual void AssignedDlResources (const UePtrAndBufferReq &ue,
+                                    const FTResources &assigned,
+                                    const FTResources &totAssigned) const override;
+
+  /**
+   * \brief Update the PF metric of an UE that did not get any RBG
+   * \param ue UE
+   * \param notAssigned the amount of resources not assigned
+   * \param totalAssigned the total amount of resources assigned in the slot
+   */
+  virtual void NotAssignedDlResources (const UePtrAndBufferReq &ue,
+                                       const FTResources &notAssigned,
+                                       const FTResources &totalAssigned) const override;
+
+private:
+  double m_timeWindow {99.0}; //!< Time window to calculate the throughput
+  float m_alpha {1.0};        //!< PF Fairness index
+
+  mutable MmWavePfRbgMetricMatrix m_metric; //!< Metric numerators, reused across slots
+};
+
+} // namespace ns3
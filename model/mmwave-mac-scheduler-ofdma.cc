@@ -253,8 +253,27 @@ MmWaveMacSchedulerOfdma::CreateDlDci (MmWaveMacSchedulerNs3::PointInFTPlane *spo
                                       uint32_t maxSym) const
 {
   NS_LOG_FUNCTION (this);
+  return CreateDlDci (spoint, ueInfo, maxSym, ueInfo->m_dlMcs);
+}
+
+/**
+ * \brief Create the DL DCI in OFDMA mode, with a MCS
+ * \param spoint Starting point
+ * \param ueInfo UE representation
+ * \param maxSym Maximum symbols to use
+ * \param mcs MCS of the DCI
+ * \return a pointer to the newly created instance
+ *
+ * The function calculates the TBS with the MCS and then call CreateDci().
+ */
+std::shared_ptr<DciInfoElementTdma>
+MmWaveMacSchedulerOfdma::CreateDlDci (MmWaveMacSchedulerNs3::PointInFTPlane *spoint,
+                                      const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
+                                      uint32_t maxSym, uint8_t mcs) const
+{
+  NS_LOG_FUNCTION (this);
 
-  uint32_t tbs = m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_dlMcs,
+  uint32_t tbs = m_amc->GetTbSizeFromMcsSymbols (mcs,
                                                  ueInfo->m_dlRBG * m_phyMacConfig->GetNumRbPerRbg ()) / 8;
   NS_ASSERT_MSG (ueInfo->m_dlRBG % maxSym == 0, " MaxSym " << maxSym << " RBG: " << ueInfo->m_dlRBG);
   NS_ASSERT (ueInfo->m_dlRBG <= maxSym * m_phyMacConfig->GetBandwidthInRbg ());
@@ -268,7 +287,7 @@ MmWaveMacSchedulerOfdma::CreateDlDci (MmWaveMacSchedulerNs3::PointInFTPlane *spo
       return nullptr;
     }
 
-  return CreateDci (spoint, ueInfo, tbs, DciInfoElementTdma::DL, ueInfo->m_dlMcs,
+  return CreateDci (spoint, ueInfo, tbs, DciInfoElementTdma::DL, mcs,
                     static_cast<uint8_t> (maxSym));
 }
 
@@ -290,6 +309,10 @@ MmWaveMacSchedulerOfdma::CreateDlDci (MmWaveMacSchedulerNs3::PointInFTPlane *spo
  *
  * So, the available RB will be from spoint->m_rb to spoint->m_rb + RB calculated
  * by the above formula.
+ *
+ * If a frequency-selective scheduler already decided which RBG the UE will use
+ * (MmWaveMacSchedulerUeInfo::m_dlRbgBitmask is not empty) these RBG are
+ * used as they are, and the starting point is not advanced.
  */
 std::shared_ptr<DciInfoElementTdma>
 MmWaveMacSchedulerOfdma::CreateDci (MmWaveMacSchedulerNs3::PointInFTPlane *spoint,
@@ -303,29 +326,35 @@ MmWaveMacSchedulerOfdma::CreateDci (MmWaveMacSchedulerNs3::PointInFTPlane *spoin
   NS_ASSERT (ueInfo->m_dlRBG % numSym == 0);
 
   uint32_t RBGNum = ueInfo->m_dlRBG / numSym;
-  std::vector<uint8_t> rbgBitmask;
 
-  for (uint32_t i = 0; i < m_phyMacConfig->GetBandwidthInRbg (); ++i)
+  std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
+      (ueInfo->m_rnti, fmt, spoint->m_sym, numSym, mcs, tbs, 1, 0);
+
+  if (fmt == DciInfoElementTdma::DL && ueInfo->m_dlRbgBitmask.Size () > 0)
     {
-      if (i >= spoint->m_rbg && i < spoint->m_rbg + RBGNum)
-        {
-          rbgBitmask.push_back (1);
-        }
-      else
-        {
-          rbgBitmask.push_back (0);
-        }
+      NS_ASSERT (ueInfo->m_dlRbgBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg ());
+      NS_ASSERT (ueInfo->m_dlRbgBitmask.Count () == RBGNum);
+
+      NS_LOG_INFO ("UE " << ueInfo->m_rnti << " assigned RBG " <<
+                   ueInfo->m_dlRbgBitmask << " for " <<
+                   static_cast<uint32_t> (numSym) << " SYM.");
+
+      dci->m_rbgBitmask = ueInfo->m_dlRbgBitmask;
+      return dci;
     }
 
+  RbgBitmask rbgBitmask (m_phyMacConfig->GetBandwidthInRbg ());
+  NS_ASSERT_MSG (spoint->m_rbg + RBGNum <= rbgBitmask.Size (),
+                 "RBG " << static_cast<uint32_t> (spoint->m_rbg) << "+" << RBGNum <<
+                 " beyond the bandwidth of " << rbgBitmask.Size () << " RBG");
+  rbgBitmask.SetRange (spoint->m_rbg, spoint->m_rbg + RBGNum);
+
   NS_LOG_INFO ("UE " << ueInfo->m_rnti << " assigned RBG from " <<
                static_cast<uint32_t> (spoint->m_rbg) << " to " <<
                static_cast<uint32_t> (spoint->m_rbg + RBGNum) << " for " <<
                static_cast<uint32_t> (numSym) << " SYM.");
 
-  std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
-      (ueInfo->m_rnti, fmt, spoint->m_sym, numSym, mcs, tbs, 1, 0);
-
-  dci->m_rbgBitmask = std::move (rbgBitmask);
+  dci->m_rbgBitmask = rbgBitmask;
 
   spoint->m_rbg += RBGNum;
 
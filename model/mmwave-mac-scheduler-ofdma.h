@@ -103,6 +103,10 @@ protected:
   MmWaveMacSchedulerOfdma::BeamSymbolMap
   GetSymPerBeam (uint32_t symAvail, const ActiveUeMap &activeDl) const;
 
+  std::shared_ptr<DciInfoElementTdma>
+  CreateDlDci (PointInFTPlane *spoint, const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
+               uint32_t maxSym, uint8_t mcs) const;
+
 private:
   std::shared_ptr<DciInfoElementTdma> CreateDci (PointInFTPlane *spoint, const std::shared_ptr<MmWaveMacSchedulerUeInfo> &ueInfo,
                                                  uint32_t tbs, DciInfoElementTdma::DciFormat fmt,
@@ -371,7 +371,7 @@ MmWaveMacSchedulerTdma::CreateDci (MmWaveMacSchedulerNs3::PointInFTPlane *spoint
   NS_LOG_FUNCTION (this);
   NS_ASSERT (tbs > 0);
   NS_ASSERT (numSym > 0);
-  std::vector<uint8_t> rbgAssigned (m_phyMacConfig->GetBandwidthInRbg (), 1);
+  RbgBitmask rbgAssigned (m_phyMacConfig->GetBandwidthInRbg (), true);
 
   NS_LOG_INFO ("UE " << ueInfo->m_rnti << " assigned RBG from " <<
                static_cast<uint32_t> (spoint->m_rbg) << " to " <<
@@ -381,7 +381,7 @@ MmWaveMacSchedulerTdma::CreateDci (MmWaveMacSchedulerNs3::PointInFTPlane *spoint
   std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
       (ueInfo->m_rnti, fmt, spoint->m_sym, numSym, mcs, tbs, 1, 0);
 
-  dci->m_rbgBitmask = std::move (rbgAssigned);
+  dci->m_rbgBitmask = rbgAssigned;
 
   return dci;
 }
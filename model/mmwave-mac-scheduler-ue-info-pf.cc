@@ -40,19 +40,48 @@ MmWaveMacSchedulerUeInfoPF::UpdateDlPFMetric (const MmWaveMacSchedulerNs3::FTRes
                                               const Ptr<MmWaveAmc> &amc)
 {
   NS_LOG_FUNCTION (this);
-  MmWaveMacSchedulerUeInfo::UpdateDlMetric (config, amc);
+  UpdateDlPFMetric (totAssigned, timeWindow, config, amc, m_dlMcs);
+}
+
+/**
+ * \brief Update PF metrics, with the MCS of the transmission of this slot
+ * \param timeWindow Time window to consider
+ * \param config Config
+ * \param amc AMC
+ * \param mcs MCS of the transmission
+ */
+void
+MmWaveMacSchedulerUeInfoPF::UpdateDlPFMetric (const MmWaveMacSchedulerNs3::FTResources &totAssigned,
+                                              double timeWindow,
+                                              const Ptr<MmWavePhyMacCommon> &config,
+                                              const Ptr<MmWaveAmc> &amc,
+                                              uint8_t mcs)
+{
+  NS_LOG_FUNCTION (this);
+  MmWaveMacSchedulerUeInfo::UpdateDlMetric (config, amc, mcs);
 
-  m_currTputDl = static_cast<double> (m_dlTbSize) / (totAssigned.m_sym * config->GetSymbolPeriod ().GetMilliSeconds ());
+  m_currTputDl = static_cast<double> (m_dlTbSize) / (totAssigned.m_sym * GetSymbolPeriodMs (config));
   m_avgTputDl = ((1.0 - (1.0 / static_cast<double> (timeWindow))) * m_lastAvgTputDl) +
     ((1.0 / timeWindow) * m_currTputDl);
   NS_LOG_DEBUG ("Update PF Metric for UE " << static_cast<uint32_t> (m_rnti) <<
                 "TBS: " << m_dlTbSize << " Updated currTput " <<
                 m_currTputDl << " avgTput " << m_avgTputDl << " time: " <<
-                (totAssigned.m_sym * config->GetSymbolPeriod ().GetMilliSeconds ()) <<  " ms, last Avg TH " <<
+                (totAssigned.m_sym * GetSymbolPeriodMs (config)) <<  " ms, last Avg TH " <<
                 m_lastAvgTputDl << " total sym assigned " << static_cast<uint32_t> (totAssigned.m_sym) <<
                 " updated metric: " << m_potentialTput / std::max (1E-9, m_avgTputDl));
 }
 
+double
+MmWaveMacSchedulerUeInfoPF::GetSymbolPeriodMs (const Ptr<MmWavePhyMacCommon> &config) const
+{
+  if (m_fractionalSymbolPeriod)
+    {
+      return config->GetSymbolPeriod ().ToDouble (Time::MS);
+    }
+  // Whole ms, 0 for all the numerologies: kept for the wideband PF schedulers
+  return config->GetSymbolPeriod ().GetMilliSeconds ();
+}
+
 void
 MmWaveMacSchedulerUeInfoPF::CalculatePotentialTPut (const MmWaveMacSchedulerNs3::FTResources &assignableInIteration,
                                                     const Ptr<MmWavePhyMacCommon> &config,
@@ -62,7 +91,7 @@ MmWaveMacSchedulerUeInfoPF::CalculatePotentialTPut (const MmWaveMacSchedulerNs3:
   uint32_t rbsAssignable = assignableInIteration.m_rbg * config->GetNumRbPerRbg ();
   m_potentialTput =  amc->GetSpectralEfficiency (m_dlMcs, rbsAssignable);
   m_potentialTput /= 8.0;
-  m_potentialTput /= assignableInIteration.m_sym * config->GetSymbolPeriod ().GetMilliSeconds ();
+  m_potentialTput /= assignableInIteration.m_sym * GetSymbolPeriodMs (config);
   NS_LOG_INFO ("UE " << m_rnti << " potentialTput " << m_potentialTput <<
                " lastAvgTh " << m_lastAvgTputDl << " metric: " << m_potentialTput / std::max (1E-9, m_avgTputDl));
 }
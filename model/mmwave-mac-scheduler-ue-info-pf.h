@@ -39,10 +39,14 @@ public:
    * \brief MmWaveMacSchedulerUeInfoPF constructor
    * \param rnti RNTI of the UE
    * \param beamId Beam ID of the UE
+   * \param fractionalSymbolPeriod true to divide the throughput by the symbol
+   * period in fractional ms, instead of the whole ms of GetMilliSeconds
    */
-  MmWaveMacSchedulerUeInfoPF (float alpha, uint16_t rnti, AntennaArrayModel::BeamId beamId)
+  MmWaveMacSchedulerUeInfoPF (float alpha, uint16_t rnti, AntennaArrayModel::BeamId beamId,
+                              bool fractionalSymbolPeriod = false)
     : MmWaveMacSchedulerUeInfo (rnti, beamId),
-    m_alpha (alpha)
+    m_alpha (alpha),
+    m_fractionalSymbolPeriod (fractionalSymbolPeriod)
   {
   }
 
@@ -76,6 +80,11 @@ public:
                          double timeWindow,
                          const Ptr<MmWavePhyMacCommon> &config,
                          const Ptr<MmWaveAmc> &amc);
+  void UpdateDlPFMetric (const MmWaveMacSchedulerNs3::FTResources &totAssigned,
+                         double timeWindow,
+                         const Ptr<MmWavePhyMacCommon> &config,
+                         const Ptr<MmWaveAmc> &amc,
+                         uint8_t mcs);
   void CalculatePotentialTPut (const MmWaveMacSchedulerNs3::FTResources &assignableInIteration,
                                const Ptr<MmWavePhyMacCommon> &config,
                                const Ptr<MmWaveAmc> &amc);
@@ -111,6 +120,14 @@ public:
   double m_lastAvgTputDl {0.0}; //!< Last average throughput
   double m_potentialTput {0.0}; //!< Potential throughput in one assignable resource (can be a symbol or a RBG)
   float  m_alpha {0.0};         //!< PF fairness metric
+  bool   m_fractionalSymbolPeriod {false}; //!< Symbol period in fractional ms, instead of whole ms
+
+private:
+  /**
+   * \param config Config
+   * \return the symbol period in ms, truncated unless m_fractionalSymbolPeriod
+   */
+  double GetSymbolPeriodMs (const Ptr<MmWavePhyMacCommon> &config) const;
 };
 
 } // namespace ns3
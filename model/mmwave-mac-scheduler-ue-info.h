@@ -148,6 +148,7 @@ public:
     m_dlRBG = 0;
     m_dlTbSize = 0;
     m_dlSym = 0;
+    m_dlRbgBitmask = RbgBitmask ();
   }
 
   /**
@@ -171,7 +172,20 @@ public:
    */
   virtual void UpdateDlMetric (const Ptr<MmWavePhyMacCommon> &config, const Ptr<MmWaveAmc> &amc)
   {
-    m_dlTbSize = static_cast<uint32_t> (amc->GetSpectralEfficiency (m_dlMcs,
+    UpdateDlMetric (config, amc, m_dlMcs);
+  }
+
+  /**
+   * \brief Update DL metrics after resources have been assigned, with the MCS
+   * that the transmission of this slot will use
+   * \param config Config
+   * \param amc AMC
+   * \param mcs MCS of the transmission (it can be lower than m_dlMcs, e.g.
+   * with a frequency-selective scheduler)
+   */
+  void UpdateDlMetric (const Ptr<MmWavePhyMacCommon> &config, const Ptr<MmWaveAmc> &amc, uint8_t mcs)
+  {
+    m_dlTbSize = static_cast<uint32_t> (amc->GetSpectralEfficiency (mcs,
                                                                     m_dlRBG * config->GetNumRbPerRbg ()) / 8);
   }
 
@@ -227,7 +241,7 @@ public:
     std::vector<double> m_sinr;   //!< Vector of SINR for the entire band
     std::vector<int16_t> m_rbCqi; //!< CQI for each Rsc Block, set to -1 if SINR < Threshold
     uint8_t m_cqi    {0};  //!< CQI reported value
-    uint32_t m_timer {0};  //!< Timer (in slot number). When the timer is 0, the value is discarded
+    uint64_t m_expiration {0}; //!< Slot (as counted by the CQI refresh) in which the value is discarded
   };
 
   uint16_t m_rnti            {0};             //!< RNTI of the UE
@@ -246,6 +260,9 @@ public:
   uint8_t         m_dlMcs     {0};  //!< DL MCS
   uint8_t         m_ulMcs     {0};  //!< UL MCS
 
+  std::vector<uint8_t> m_dlRbgMcs;  //!< DL MCS for each RBG, from the last SB CQI (empty if the CQI is WB)
+  RbgBitmask m_dlRbgBitmask;        //!< DL RBG assigned in this slot by a frequency-selective scheduler (empty otherwise)
+
   uint32_t m_dlTbSize         {0};  //!< DL Transport Block Size, depends on MCS and RBG, updated in UpdateDlMetric()
   uint32_t m_ulTbSize         {0};  //!< UL Transport Block Size, depends on MCS and RBG, updated in UpdateDlMetric()
 
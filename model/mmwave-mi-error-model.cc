@@ -47,7 +47,7 @@ namespace ns3 {
 
 
 double
-MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const RbgBitmask& map, uint8_t mcs)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
 
@@ -55,9 +55,12 @@ MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map,
   double MIsum = 0.0;
   SpectrumValue sinrCopy = sinr;
 
-  for (uint32_t i = 0; i < map.size (); i++)
+  NS_ASSERT (map.Size () <= sinr.GetSpectrumModel ()->GetNumBands ());
+  const uint32_t rbNum = map.Count ();
+
+  for (uint32_t rb = map.FindFirst (); rb < map.Size (); rb = map.FindNext (rb))
     {
-      double sinrLin = sinrCopy[map.at (i)];
+      double sinrLin = sinrCopy[rb];
       if (mcs <= MI_QPSK_MAX_ID) // QPSK
         {
 
@@ -122,16 +125,16 @@ MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map,
                 }
             }
         }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+      NS_LOG_LOGIC (" RB " << rb << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
       MIsum += MI;
     }
-  if (map.size () == 0)
+  if (rbNum == 0)
     {
       MI = 0;
     }
   else
     {
-      MI = MIsum / map.size ();
+      MI = MIsum / rbNum;
     }
 
   NS_LOG_LOGIC (" MI = " << MI);
@@ -184,7 +187,7 @@ MmWaveMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize)
 }
 
 TbStats_t
-MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory)
+MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const RbgBitmask& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
 
@@ -36,6 +36,7 @@
 #include <stdint.h>
 #include <ns3/spectrum-value.h>
 #include "mmwave-harq-phy.h"
+#include "mmwave-rbg-bitmask.h"
 
 
 
@@ -323,11 +324,11 @@ public:
   /**
    * \brief find the mmib (mean mutual information per bit) for different modulations of the specified TB
    * \param sinr the perceived sinrs in the whole bandwidth
-   * \param map the actives RBs for the TB
+   * \param map the actives RBs for the TB (one bit per RB)
    * \param mcs the MCS of the TB
    * \return the mmib
    */
-  static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs);
+  static double Mib (const SpectrumValue& sinr, const RbgBitmask& map, uint8_t mcs);
   /**
    * \brief map the mmib (mean mutual information per bit) for different MCS
    * \param mib mean mutual information per bit of a code-block
@@ -345,7 +346,7 @@ public:
    * \param mcs the MCS of the TB
    * \return the TB error rate and MI
    */
-  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory);
+  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const RbgBitmask& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory);
 
 
 //private:
@@ -42,6 +42,7 @@
 #include <ns3/component-carrier.h>
 #include <ns3/enum.h>
 #include <memory>
+#include "mmwave-rbg-bitmask.h"
 
 
 namespace ns3 {
@@ -327,7 +328,7 @@ struct DciInfoElementTdma
    * \param rbgBitmask Bitmask of RBG
    */
   DciInfoElementTdma (uint8_t symStart, uint8_t numSym,
-                      const std::vector<uint8_t> &rbgBitmask)
+                      const RbgBitmask &rbgBitmask)
     : m_symStart (symStart),
     m_numSym (numSym),
     m_rbgBitmask (rbgBitmask)
@@ -388,7 +389,7 @@ struct DciInfoElementTdma
   const uint8_t m_ndi         {0};   // By default is retransmission
   const uint8_t m_rv          {0};   // not used for UL DCI
   uint8_t m_harqProcess {0};
-  std::vector<uint8_t> m_rbgBitmask  {};   //!< RBG mask: 0 if the RBG is not used, 1 otherwise
+  RbgBitmask m_rbgBitmask  {};   //!< RBG mask: 0 if the RBG is not used, 1 otherwise
 };
 
 struct TbAllocInfo
@@ -497,13 +498,15 @@ typedef std::vector<VarTtiAllocInfo::VarTtiType> TddVarTtiTypeList;
 
 struct DlCqiInfo
 {
+  static const uint8_t RB_CQI_NOT_MEASURED = UINT8_MAX; // Value of m_rbCqi for a RB without signal (0 is a valid CQI)
+
   uint16_t m_rnti {0};
   uint8_t m_ri    {0};
   enum DlCqiType
   {
     WB, SB
   } m_cqiType {WB};
-  std::vector<uint8_t> m_rbCqi;   // CQI for each Rsc Block, set to -1 if SINR < Threshold
+  std::vector<uint8_t> m_rbCqi;   // CQI for each Rsc Block, set to RB_CQI_NOT_MEASURED if SINR < Threshold
   uint8_t m_wbCqi {0};   // Wide band CQI
   uint8_t m_wbPmi {0};
 };
@@ -55,7 +55,7 @@ public:
    * \param rnti RNTI of the user
    * \return Beam ID of the user
    */
-  virtual AntennaArrayModel::BeamId GetBeamId (uint8_t rnti) const = 0;
+  virtual AntennaArrayModel::BeamId GetBeamId (uint16_t rnti) const = 0;
 
 };
 
@@ -47,6 +47,7 @@
 #include "mmwave-mac-pdu-tag.h"
 #include "mmwave-mac-pdu-header.h"
 #include "mmwave-net-device.h"
+#include <ns3/lte-radio-bearer-tag.h>
 #include <map>
 #include <sstream>
 #include <vector>
@@ -72,7 +73,7 @@ public:
 
   virtual void SetSlotAllocInfo (SlotAllocInfo slotAllocInfo) override;
 
-  virtual AntennaArrayModel::BeamId GetBeamId (uint8_t rnti) const override;
+  virtual AntennaArrayModel::BeamId GetBeamId (uint16_t rnti) const override;
 
 private:
   MmWavePhy* m_phy;
@@ -109,7 +110,7 @@ MmWaveMemberPhySapProvider::SetSlotAllocInfo (SlotAllocInfo slotAllocInfo)
 }
 
 AntennaArrayModel::BeamId
-MmWaveMemberPhySapProvider::GetBeamId (uint8_t rnti) const
+MmWaveMemberPhySapProvider::GetBeamId (uint16_t rnti) const
 {
   return m_phy->GetBeamId (rnti);
 }
@@ -128,28 +129,25 @@ MmWavePhy::GetTypeId ()
   return tid;
 }
 
-std::vector<int>
-MmWavePhy::FromRBGBitmaskToRBAssignment (const std::vector<uint8_t> rbgBitmask) const
+RbgBitmask
+MmWavePhy::FromRBGBitmaskToRBBitmask (const RbgBitmask &rbgBitmask) const
 {
-  NS_ASSERT (rbgBitmask.size () == m_phyMacConfig->GetBandwidthInRbg ());
-  std::vector<int> ret;
+  NS_ASSERT (rbgBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg ());
 
-  for (uint32_t i = 0; i < rbgBitmask.size (); ++i)
-    {
-      if (rbgBitmask.at (i) == 1)
-        {
-          for (uint32_t k = 0; k < m_phyMacConfig->GetNumRbPerRbg (); ++k)
-            {
-              ret.push_back ((i * m_phyMacConfig->GetNumRbPerRbg ()) + k);
-            }
-        }
-    }
+  RbgBitmask ret = rbgBitmask.ExpandToRb (m_phyMacConfig->GetNumRbPerRbg (),
+                                          m_phyMacConfig->GetBandwidthInRbs ());
 
-  NS_ASSERT (static_cast<uint32_t> (std::count (rbgBitmask.begin (), rbgBitmask.end (), 1) * m_phyMacConfig->GetNumRbPerRbg ())
-             == ret.size ());
+  NS_ASSERT (rbgBitmask.Count () * m_phyMacConfig->GetNumRbPerRbg () == ret.Count ());
   return ret;
 }
 
+Ptr<SpectrumValue>
+MmWavePhy::CreateTxPowerSpectralDensityFromRbg (const RbgBitmask &rbgBitmask) const
+{
+  NS_ASSERT (rbgBitmask.Size () == m_phyMacConfig->GetBandwidthInRbg ());
+  return m_txPsdFactory.Create (m_phyMacConfig, m_txPower, rbgBitmask, m_phyMacConfig->GetNumRbPerRbg ());
+}
+
 MmWavePhy::MmWavePhy ()
 {
   NS_LOG_FUNCTION (this);
@@ -168,12 +166,20 @@ MmWavePhy::MmWavePhy (Ptr<MmWaveSpectrumPhy> dlChannelPhy, Ptr<MmWaveSpectrumPhy
 {
   NS_LOG_FUNCTION (this);
   m_phySapProvider = new MmWaveMemberPhySapProvider (this);
+
+  Ptr<Packet> emptyPdu = Create <Packet> ();
+  MmWaveMacPduHeader header;
+  MacSubheader subheader (3, 0);    // lcid = 3, size = 0
+  header.AddSubheader (subheader);
+  emptyPdu->AddHeader (header);
+  m_emptyPdu = emptyPdu;
 }
 
 MmWavePhy::~MmWavePhy ()
 {
   NS_LOG_FUNCTION (this);
-  m_slotAllocInfo.clear ();
+  m_slotAllocInfo.Clear ();
+  m_packetBursts.Clear ();
 }
 
 void
@@ -186,7 +192,8 @@ void
 MmWavePhy::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
-  m_controlMessageQueue.clear ();
+  m_controlMessageQueue.SetDepth (0);
+  m_emptyPduBursts.clear ();
   delete m_phySapProvider;
   Object::DoDispose ();
 }
@@ -252,15 +259,28 @@ MmWavePhy::SetMacPdu (Ptr<Packet> p)
   MmWaveMacPduTag tag;
   if (p->PeekPacketTag (tag))
     {
-      NS_ASSERT ((tag.GetSfn ().m_slotNum >= 0) && (tag.GetSfn ().m_varTtiNum < m_phyMacConfig->GetSymbolsPerSlot ()));
+      const SfnSf sfn = tag.GetSfn ();
+      NS_ASSERT ((sfn.m_slotNum >= 0) && (sfn.m_varTtiNum < m_phyMacConfig->GetSymbolsPerSlot ()));
+
+      if (! m_packetBursts.IsConfigured ())
+        {
+          ConfigureSlotAllocInfo ();
+        }
 
-      std::map<uint64_t, Ptr<PacketBurst> >::iterator it = m_packetBurstMap.find (tag.GetSfn ().Encode ());
+      bool claimed;
+      std::vector<Ptr<PacketBurst> > &bursts = m_packetBursts.FindOrClaim (sfn, &claimed);
+      if (claimed)
+        {
+          // drop what is left from the previous slot of the cell
+          bursts.assign (m_phyMacConfig->GetSymbolsPerSlot (), nullptr);
+        }
 
-      if (it == m_packetBurstMap.end ())
+      Ptr<PacketBurst> &burst = bursts[sfn.m_varTtiNum];
+      if (burst == nullptr)
         {
-          it = m_packetBurstMap.insert (std::pair<uint64_t, Ptr<PacketBurst> > (tag.GetSfn ().Encode (), CreateObject<PacketBurst> ())).first;
+          burst = CreateObject<PacketBurst> ();
         }
-      it->second->AddPacket (p);
+      burst->AddPacket (p);
     }
   else
     {
@@ -273,21 +293,49 @@ MmWavePhy::GetPacketBurst (SfnSf sfn)
 {
   NS_LOG_FUNCTION (this);
   Ptr<PacketBurst> pburst;
-  std::map<uint64_t, Ptr<PacketBurst> >::iterator it = m_packetBurstMap.find (sfn.Encode ());
+  std::vector<Ptr<PacketBurst> > *bursts = m_packetBursts.IsConfigured () ? m_packetBursts.Find (sfn) : nullptr;
 
-  if (it == m_packetBurstMap.end ())
+  if (bursts != nullptr && sfn.m_varTtiNum < bursts->size ())
     {
-      NS_LOG_ERROR ("GetPacketBurst(): Packet burst not found for subframe " << (unsigned)sfn.m_subframeNum << " slot" << (unsigned) sfn.m_slotNum << " tti start "  << (unsigned)sfn.m_varTtiNum);
-      return pburst;
+      std::swap (pburst, bursts->at (sfn.m_varTtiNum));
     }
-  else
+
+  if (pburst == nullptr)
     {
-      pburst = it->second;
-      m_packetBurstMap.erase (it);
+      NS_LOG_ERROR ("GetPacketBurst(): Packet burst not found for subframe " << (unsigned)sfn.m_subframeNum << " slot" << (unsigned) sfn.m_slotNum << " tti start "  << (unsigned)sfn.m_varTtiNum);
     }
   return pburst;
 }
 
+Ptr<PacketBurst>
+MmWavePhy::CreateEmptyPduBurst (const SfnSf &sfn, uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this);
+  // A burst of the pool is free when only the pool holds it and its PDU:
+  // the channel gives copies of the burst to the receivers
+  for (const auto & burst : m_emptyPduBursts)
+    {
+      if (burst->GetReferenceCount () == 1 && (*burst->Begin ())->GetReferenceCount () == 1)
+        {
+          Ptr<Packet> pdu = *burst->Begin ();
+          *pdu = *m_emptyPdu;
+          pdu->AddPacketTag (MmWaveMacPduTag (sfn));
+          pdu->AddPacketTag (LteRadioBearerTag (rnti, 3, 0));
+          return burst;
+        }
+    }
+
+  // All the bursts are in use: the pool grows up to the number of empty
+  // PDUs in flight at the same time
+  Ptr<Packet> pdu = m_emptyPdu->Copy ();
+  pdu->AddPacketTag (MmWaveMacPduTag (sfn));
+  pdu->AddPacketTag (LteRadioBearerTag (rnti, 3, 0));
+  Ptr<PacketBurst> pktBurst = CreateObject<PacketBurst> ();
+  pktBurst->AddPacket (pdu);
+  m_emptyPduBursts.push_back (pktBurst);
+  return pktBurst;
+}
+
 uint32_t
 MmWavePhy::GetCcId() const
 {
@@ -302,44 +350,14 @@ void
 MmWavePhy::SetControlMessage (Ptr<MmWaveControlMessage> m)
 {
   NS_LOG_FUNCTION (this);
-  if (m_controlMessageQueue.empty ())
-    {
-      std::list<Ptr<MmWaveControlMessage> > l;
-      l.push_back (m);
-      m_controlMessageQueue.push_back (l);
-    }
-  else
-    {
-      m_controlMessageQueue.at (m_controlMessageQueue.size () - 1).push_back (m);
-    }
+  m_controlMessageQueue.PushBack (m);
 }
 
 std::list<Ptr<MmWaveControlMessage> >
 MmWavePhy::GetControlMessages (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_controlMessageQueue.empty ())
-    {
-      std::list<Ptr<MmWaveControlMessage> > emptylist;
-      return (emptylist);
-    }
-
-  if (m_controlMessageQueue.at (0).size () > 0)
-    {
-      std::list<Ptr<MmWaveControlMessage> > ret = m_controlMessageQueue.front ();
-      m_controlMessageQueue.erase (m_controlMessageQueue.begin ());
-      std::list<Ptr<MmWaveControlMessage> > newlist;
-      m_controlMessageQueue.push_back (newlist);
-      return (ret);
-    }
-  else
-    {
-      m_controlMessageQueue.erase (m_controlMessageQueue.begin ());
-      std::list<Ptr<MmWaveControlMessage> > newlist;
-      m_controlMessageQueue.push_back (newlist);
-      std::list<Ptr<MmWaveControlMessage> > emptylist;
-      return (emptylist);
-    }
+  return m_controlMessageQueue.Pop ();
 }
 
 void
@@ -347,6 +365,26 @@ MmWavePhy::SetConfigurationParameters (Ptr<MmWavePhyMacCommon> ptrConfig)
 {
   NS_LOG_FUNCTION (this);
   m_phyMacConfig = ptrConfig;
+  ConfigureSlotAllocInfo ();
+}
+
+void
+MmWavePhy::ConfigureSlotAllocInfo ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_IF (m_phyMacConfig == nullptr);
+
+  // The UE pushes a full subframe of empty slots at the beginning, while the
+  // gNB receives allocations up to L1L2CtrlLatency + UlSchedDelay slots in
+  // advance. Double it to be safe with the slots not yet consumed.
+  uint32_t lookahead = m_phyMacConfig->GetSlotsPerSubframe () +
+    m_phyMacConfig->GetL1L2CtrlLatency () + m_phyMacConfig->GetL1L2DataLatency () +
+    m_phyMacConfig->GetUlSchedDelay ();
+
+  m_slotAllocInfo.Configure (2 * lookahead, m_phyMacConfig->GetSlotsPerSubframe (),
+                             m_phyMacConfig->GetSubframesPerFrame ());
+  m_packetBursts.Configure (2 * lookahead, m_phyMacConfig->GetSlotsPerSubframe (),
+                            m_phyMacConfig->GetSubframesPerFrame ());
 }
 
 Ptr<MmWavePhyMacCommon>
@@ -374,15 +412,20 @@ MmWavePhy::SetSlotAllocInfo (const SlotAllocInfo &slotAllocInfo)
                " subframe:" << static_cast<uint32_t> (slotAllocInfo.m_sfnSf.m_subframeNum) <<
                " slot:" << static_cast<uint32_t> (slotAllocInfo.m_sfnSf.m_slotNum));
 
-  SfnSf sf = slotAllocInfo.m_sfnSf;
+  if (! m_slotAllocInfo.IsConfigured ())
+    {
+      ConfigureSlotAllocInfo ();
+    }
+
+  SlotAllocInfo *existing = m_slotAllocInfo.Find (slotAllocInfo.m_sfnSf);
 
-  if (m_slotAllocInfo.find (sf) == m_slotAllocInfo.end ())
+  if (existing == nullptr)
     {
-      m_slotAllocInfo [sf] = slotAllocInfo;
+      m_slotAllocInfo.Insert (slotAllocInfo.m_sfnSf, slotAllocInfo);
     }
   else
     {
-      m_slotAllocInfo [sf].Merge (slotAllocInfo);
+      existing->Merge (slotAllocInfo);
     }
 }
 
@@ -391,7 +434,7 @@ bool
 MmWavePhy::SlotExists (const SfnSf &retVal) const
 {
   NS_LOG_FUNCTION (this);
-  return m_slotAllocInfo.find (retVal) != m_slotAllocInfo.end ();
+  return m_slotAllocInfo.IsConfigured () && m_slotAllocInfo.Contains (retVal);
 }
 
 
@@ -401,19 +444,17 @@ MmWavePhy::GetSlotAllocInfo (const SfnSf &sfnsf)
   NS_LOG_FUNCTION (this << " at:" << Simulator::Now ().GetSeconds () << "ccId:" << (unsigned)m_componentCarrierId << "frameNum:" << sfnsf.m_frameNum <<
                    "subframe:" << (unsigned)sfnsf.m_subframeNum << "slot:" << (unsigned)sfnsf.m_slotNum);
 
-  NS_ASSERT_MSG (m_slotAllocInfo.find (sfnsf) != m_slotAllocInfo.end (), "Trying to fetch a non existing slot allocation info.");
-  SlotAllocInfo slot = m_slotAllocInfo[sfnsf];
-  m_slotAllocInfo.erase (m_slotAllocInfo.find (sfnsf));
-  return slot;
+  NS_ASSERT_MSG (SlotExists (sfnsf), "Trying to fetch a non existing slot allocation info.");
+  return m_slotAllocInfo.Extract (sfnsf);
 }
 
 SlotAllocInfo &
 MmWavePhy::PeekSlotAllocInfo (const SfnSf &sfnsf)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT_MSG (m_slotAllocInfo.find (sfnsf) != m_slotAllocInfo.end (),
+  NS_ASSERT_MSG (SlotExists (sfnsf),
                  "Trying to fetch a non existing slot allocation info.");
-  return m_slotAllocInfo[sfnsf];
+  return m_slotAllocInfo.At (sfnsf);
 }
 
 void
@@ -43,6 +43,9 @@
 #include "mmwave-phy-mac-common.h"
 #include "mmwave-spectrum-phy.h"
 #include "mmwave-phy-sap.h"
+#include "mmwave-slot-ring.h"
+#include "mmwave-ctrl-msg-queue.h"
+#include "mmwave-spectrum-value-helper.h"
 #include <string>
 #include <map>
 
@@ -63,20 +66,28 @@ public:
   static TypeId GetTypeId (void);
 
   /**
-   * \brief Transform a MAC-made vector of RBG to a PHY-ready vector of SINR indices
+   * \brief Transform a MAC-made bitmask of RBG to a PHY-ready bitmask of RB
    * \param rbgBitmask Bitmask which indicates with 1 the RBG in which there is a transmission,
    * with 0 a RBG in which there is not a transmission
-   * \return a vector of indices.
+   * \return a bitmask with one bit for each RB of the bandwidth
    *
    * Example (4 RB per RBG, 4 total RBG assignable):
    * rbgBitmask = <0,1,1,0>
-   * output = <4,5,6,7,8,9,10,11>
+   * output = <0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0>
    *
-   * (the rbgBitmask expressed as rbBitmask would be:
-   * <0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0> , and therefore the places in which there
-   * is a 1 are from the 4th to the 11th, and that is reflected in the output)
+   * (the places in which there is a 1 are from the 4th to the 11th, and they
+   * are the indices of the SpectrumValue in which there is a transmission)
    */
-  std::vector<int> FromRBGBitmaskToRBAssignment (const std::vector<uint8_t> rbgBitmask) const;
+  RbgBitmask FromRBGBitmaskToRBBitmask (const RbgBitmask &rbgBitmask) const;
+
+  /**
+   * \brief Create the TX PSD of a transmission over the RBG of a MAC-made
+   * bitmask, without expanding it to a bitmask of RB
+   * \param rbgBitmask Bitmask which indicates with 1 the RBG in which there is a transmission
+   * \return the TX PSD, in W/Hz, as CreateTxPowerSpectralDensity would return
+   * for FromRBGBitmaskToRBBitmask (rbgBitmask)
+   */
+  Ptr<SpectrumValue> CreateTxPowerSpectralDensityFromRbg (const RbgBitmask &rbgBitmask) const;
 
   void SetDevice (Ptr<MmWaveNetDevice> d);
 
@@ -86,15 +97,15 @@ public:
 
   /**
    * \brief Create Tx Power Spectral Density
-   * \param rbIndexVector vector of the index of the RB (in SpectrumValue array)
+   * \param rbBitmask bitmask of the RB (in SpectrumValue array)
    * in which there is a transmission
    * \return A SpectrumValue array representing the TX Power Spectral Density
    * in W/Hz for each Resource Block, in which each array value
-   * is updated to a particular value if the correspond RB index was inside the rbIndexVector,
+   * is updated to a particular value if the correspond RB bit was set in rbBitmask,
    * or is left untouched otherwise.
    * \see MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity
    */
-  virtual Ptr<SpectrumValue> CreateTxPowerSpectralDensity (const std::vector<int> &rbIndexVector) const = 0;
+  virtual Ptr<SpectrumValue> CreateTxPowerSpectralDensity (const RbgBitmask &rbBitmask) const = 0;
 
   void DoDispose ();
 
@@ -112,6 +123,10 @@ public:
   double GetNoiseFigure (void) const;
 
   void SetControlMessage (Ptr<MmWaveControlMessage> m);
+  /**
+   * \brief Take the control messages to transmit in this slot
+   * \return the messages, moved out of the queue
+   */
   std::list<Ptr<MmWaveControlMessage> > GetControlMessages (void);
 
   virtual void SetMacPdu (Ptr<Packet> pb);
@@ -120,8 +135,31 @@ public:
 
 
   //	virtual Ptr<PacketBurst> GetPacketBurst (void);
+  /**
+   * \brief Take the PDUs that the MAC delivered for a var TTI
+   * \param sfn slot and starting symbol (m_varTtiNum) of the var TTI
+   * \return the burst of PDUs, or nullptr if the MAC did not deliver any PDU
+   */
   virtual Ptr<PacketBurst> GetPacketBurst (SfnSf);
 
+  /**
+   * \brief Create a burst with an empty PDU, to transmit when an UE is
+   * scheduled but there is no data for it
+   * \param sfn slot and starting symbol of the var TTI
+   * \param rnti RNTI of the UE
+   * \return a burst with a copy of the empty PDU, tagged for the UE and the var TTI
+   *
+   * The empty PDU, with its MAC header, is built only once. The bursts are
+   * kept in a pool, and a burst is reused when no one else holds it or its
+   * PDU (the receivers get copies of the bursts): its PDU is assigned again
+   * from the empty PDU, which shares its buffer, and only the tags are added.
+   *
+   * All the empty PDUs have the UID of the template. That is safe, since
+   * the MAC of the receiver skips the subheaders of size 0, so they never
+   * reach the RLC, and no PHY or MAC structure is keyed by the packet UID.
+   */
+  Ptr<PacketBurst> CreateEmptyPduBurst (const SfnSf &sfn, uint16_t rnti);
+
 
   /**
    * \brief Get the component carrier ID
@@ -152,7 +190,7 @@ public:
    */
   SlotAllocInfo & PeekSlotAllocInfo (const SfnSf & sfnsf);
 
-  virtual AntennaArrayModel::BeamId GetBeamId (uint8_t rnti) const = 0;
+  virtual AntennaArrayModel::BeamId GetBeamId (uint16_t rnti) const = 0;
 
   /**
   * Set the component carrier ID
@@ -181,8 +219,9 @@ protected:
 
   Ptr<MmWavePhyMacCommon> m_phyMacConfig;
 
-  std::map<uint64_t, Ptr<PacketBurst> > m_packetBurstMap;
-  std::vector<std::list<Ptr<MmWaveControlMessage> > > m_controlMessageQueue;
+  mutable MmWaveTxPsdFactory m_txPsdFactory; //!< Factory of the TX PSD, for m_phyMacConfig and m_txPower
+
+  MmWaveCtrlMsgQueue m_controlMessageQueue; //!< Control messages to transmit in the next slots
 
   TddVarTtiTypeList m_currTddMap;
   //	std::list<SlotAllocInfo> m_slotAllocInfoList;
@@ -207,7 +246,26 @@ protected:
   bool m_slotAllocInfoUpdated;
 
 private:
-  std::map <SfnSf,SlotAllocInfo> m_slotAllocInfo;   // maps subframe num to allocation info
+  /**
+   * \brief Allocate the slot allocation and PDU rings, with a capacity that
+   * covers the lookahead of the scheduler (L1L2CtrlLatency + UlSchedDelay)
+   * and the initial slots pushed at the beginning of the simulation
+   */
+  void ConfigureSlotAllocInfo ();
+
+  MmWaveSlotRing<SlotAllocInfo> m_slotAllocInfo;   // maps slot to allocation info
+
+  /**
+   * \brief PDUs received from the MAC, for each slot and symbol
+   *
+   * The vector of a slot has one entry for each symbol, with the burst of the
+   * var TTI starting in that symbol (or nullptr). The ring has the same
+   * capacity of m_slotAllocInfo; the vectors are reused by the next slots.
+   */
+  MmWaveSlotRing<std::vector<Ptr<PacketBurst> > > m_packetBursts;
+
+  Ptr<const Packet> m_emptyPdu;                       //!< Empty PDU, without tags, copied by CreateEmptyPduBurst
+  std::vector<Ptr<PacketBurst> > m_emptyPduBursts;     //!< Pool of the bursts of CreateEmptyPduBurst
 
   /// component carrier Id used to address sap
   uint8_t m_componentCarrierId;
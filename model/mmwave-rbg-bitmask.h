@@ -0,0 +1,506 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <ns3/assert.h>
+
+namespace ns3 {
+
+/**
+ * \brief Fixed-width bitmask of RBG (or RB) allocations
+ *
+ * The bitmask stores up to INLINE_BITS elements (the maximum number of RB in
+ * a NR carrier) in a few 64-bit words, without any heap allocation. A bit set
+ * to 1 means that the RBG is used, 0 that it is not. Wider (non-standard)
+ * configurations, such as 400 MHz with numerology 0, are still supported:
+ * in that case the words are allocated on the heap.
+ *
+ * The MAC and the schedulers use it with one bit per RBG (see
+ * DciInfoElementTdma::m_rbgBitmask). The PHY expands it, with ExpandToRb(), to
+ * one bit per RB before building the TX PSD or evaluating the error model.
+ *
+ * The operations (count, OR, AND, iteration over the set bits or over the runs
+ * of consecutive set bits) work on entire words.
+ */
+class RbgBitmask
+{
+public:
+  static const uint32_t INLINE_BITS = 275; //!< Maximum number of bits stored without allocations
+
+  /**
+   * \brief Build an empty bitmask (of size 0)
+   */
+  RbgBitmask () = default;
+
+  /**
+   * \brief Build a bitmask
+   * \param size number of bits (RBG)
+   * \param value initial value of all the bits
+   */
+  explicit RbgBitmask (uint32_t size, bool value = false)
+    : m_size (size),
+      m_numWords ((size + WORD_BITS - 1) / WORD_BITS)
+  {
+    if (m_numWords > INLINE_WORDS)
+      {
+        m_heapWords.resize (m_numWords, 0);
+      }
+    if (value)
+      {
+        SetRange (0, size);
+      }
+  }
+
+  /**
+   * \brief Build a bitmask from a vector with one byte per RBG
+   * \param bytes vector in which a value different from 0 means that the RBG is used
+   */
+  explicit RbgBitmask (const std::vector<uint8_t> &bytes)
+    : RbgBitmask (static_cast<uint32_t> (bytes.size ()))
+  {
+    for (uint32_t i = 0; i < bytes.size (); ++i)
+      {
+        if (bytes[i] != 0)
+          {
+            Set (i);
+          }
+      }
+  }
+
+  /**
+   * \return the number of bits of the bitmask
+   */
+  uint32_t Size () const
+  {
+    return m_size;
+  }
+
+  /**
+   * \brief Set a bit
+   * \param i the bit index
+   * \param value the value (default: true)
+   */
+  void Set (uint32_t i, bool value = true)
+  {
+    NS_ASSERT (i < m_size);
+    if (value)
+      {
+        Words ()[i / WORD_BITS] |= Bit (i);
+      }
+    else
+      {
+        Words ()[i / WORD_BITS] &= ~Bit (i);
+      }
+  }
+
+  /**
+   * \brief Reset a bit to 0
+   * \param i the bit index
+   */
+  void Reset (uint32_t i)
+  {
+    Set (i, false);
+  }
+
+  /**
+   * \brief Reset all the bits to 0 (the size is not changed)
+   */
+  void Reset ()
+  {
+    std::fill (Words (), Words () + m_numWords, 0);
+  }
+
+  /**
+   * \brief Set to 1 all the bits in [start, end)
+   * \param start first bit
+   * \param end bit after the last one
+   */
+  void SetRange (uint32_t start, uint32_t end)
+  {
+    NS_ASSERT (start <= end && end <= m_size);
+    uint64_t *words = Words ();
+    while (start < end)
+      {
+        const uint32_t word = start / WORD_BITS;
+        const uint32_t offset = start % WORD_BITS;
+        const uint32_t len = std::min (end - start, WORD_BITS - offset);
+        const uint64_t mask = (len == WORD_BITS) ? ~0ULL : (((1ULL << len) - 1) << offset);
+        words[word] |= mask;
+        start += len;
+      }
+  }
+
+  /**
+   * \brief Get a bit
+   * \param i the bit index
+   * \return true if the bit is set
+   */
+  bool Test (uint32_t i) const
+  {
+    NS_ASSERT (i < m_size);
+    return (Words ()[i / WORD_BITS] & Bit (i)) != 0;
+  }
+
+  /**
+   * \return the number of bits set to 1
+   */
+  uint32_t Count () const
+  {
+    const uint64_t *words = Words ();
+    uint32_t count = 0;
+    for (uint32_t w = 0; w < m_numWords; ++w)
+      {
+        count += static_cast<uint32_t> (__builtin_popcountll (words[w]));
+      }
+    return count;
+  }
+
+  /**
+   * \return true if at least one bit is set
+   */
+  bool Any () const
+  {
+    const uint64_t *words = Words ();
+    for (uint32_t w = 0; w < m_numWords; ++w)
+      {
+        if (words[w] != 0)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+
+  /**
+   * \return true if no bit is set
+   */
+  bool None () const
+  {
+    return ! Any ();
+  }
+
+  /**
+   * \return true if all the Size() bits are set
+   */
+  bool All () const
+  {
+    return Count () == m_size;
+  }
+
+  /**
+   * \brief Check if two bitmasks have at least one bit set in the same position
+   * \param o the other bitmask
+   * \return true if the bitmasks intersect (e.g., a collision between allocations)
+   */
+  bool Intersects (const RbgBitmask &o) const
+  {
+    const uint64_t *words = Words ();
+    const uint64_t *other = o.Words ();
+    for (uint32_t w = 0; w < std::min (m_numWords, o.m_numWords); ++w)
+      {
+        if ((words[w] & other[w]) != 0)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+
+  /**
+   * \brief Bitwise OR
+   * \param o the other bitmask (of the same size)
+   * \return a reference to this bitmask
+   */
+  RbgBitmask & operator|= (const RbgBitmask &o)
+  {
+    NS_ASSERT (m_size == o.m_size);
+    uint64_t *words = Words ();
+    const uint64_t *other = o.Words ();
+    for (uint32_t w = 0; w < m_numWords; ++w)
+      {
+        words[w] |= other[w];
+      }
+    return *this;
+  }
+
+  /**
+   * \brief Bitwise AND
+   * \param o the other bitmask (of the same size)
+   * \return a reference to this bitmask
+   */
+  RbgBitmask & operator&= (const RbgBitmask &o)
+  {
+    NS_ASSERT (m_size == o.m_size);
+    uint64_t *words = Words ();
+    const uint64_t *other = o.Words ();
+    for (uint32_t w = 0; w < m_numWords; ++w)
+      {
+        words[w] &= other[w];
+      }
+    return *this;
+  }
+
+  /**
+   * \brief Index of the first bit set
+   * \return the index of the first bit set, or Size() if no bit is set
+   */
+  uint32_t FindFirst () const
+  {
+    return FindFrom (0);
+  }
+
+  /**
+   * \brief Index of the first bit set after the bit i
+   * \param i a bit index
+   * \return the index of the first bit set after i, or Size() if there are none
+   */
+  uint32_t FindNext (uint32_t i) const
+  {
+    return FindFrom (i + 1);
+  }
+
+  /**
+   * \brief Call a function for each bit set
+   * \param f function that accepts the index (uint32_t) of the bit
+   */
+  template <typename F>
+  void ForEachSetBit (F f) const
+  {
+    const uint64_t *words = Words ();
+    for (uint32_t w = 0; w < m_numWords; ++w)
+      {
+        uint64_t word = words[w];
+        while (word != 0)
+          {
+            f (w * WORD_BITS + static_cast<uint32_t> (__builtin_ctzll (word)));
+            word &= word - 1;
+          }
+      }
+  }
+
+  /**
+   * \brief Call a function for each run of consecutive bits set
+   * \param f function that accepts the first bit of the run and the bit after
+   * the last (both uint32_t)
+   */
+  template <typename F>
+  void ForEachRun (F f) const
+  {
+    uint32_t start = FindFirst ();
+    while (start < m_size)
+      {
+        uint32_t end = FindFromZero (start);
+        f (start, end);
+        start = (end < m_size) ? FindFrom (end) : m_size;
+      }
+  }
+
+  /**
+   * \brief Expand a RBG bitmask into a RB bitmask
+   * \param rbPerRbg number of RB in each RBG
+   * \param numRb number of RB of the returned bitmask (it may be greater than
+   * Size() * rbPerRbg, the RB that are not part of any RBG remain unset)
+   * \return a bitmask with one bit per RB
+   */
+  RbgBitmask ExpandToRb (uint32_t rbPerRbg, uint32_t numRb) const
+  {
+    NS_ASSERT (m_size * rbPerRbg <= numRb);
+    if (rbPerRbg == 1 && numRb == m_size)
+      {
+        return *this;
+      }
+    RbgBitmask ret (numRb);
+    ForEachRun ([&ret, rbPerRbg] (uint32_t start, uint32_t end)
+                {
+                  ret.SetRange (start * rbPerRbg, end * rbPerRbg);
+                });
+    return ret;
+  }
+
+  /**
+   * \return a vector with one byte (0 or 1) for each bit
+   */
+  std::vector<uint8_t> ToVector () const
+  {
+    std::vector<uint8_t> ret (m_size, 0);
+    ForEachSetBit ([&ret] (uint32_t i)
+                   {
+                     ret[i] = 1;
+                   });
+    return ret;
+  }
+
+  /**
+   * \brief Equality operator
+   * \param o the other bitmask
+   * \return true if size and bits are the same
+   */
+  bool operator== (const RbgBitmask &o) const
+  {
+    return m_size == o.m_size && std::equal (Words (), Words () + m_numWords, o.Words ());
+  }
+
+  /**
+   * \brief Inequality operator
+   * \param o the other bitmask
+   * \return true if size or bits are different
+   */
+  bool operator!= (const RbgBitmask &o) const
+  {
+    return ! (*this == o);
+  }
+
+private:
+  static const uint32_t WORD_BITS = 64;                                       //!< Bits per word
+  static const uint32_t INLINE_WORDS = (INLINE_BITS + WORD_BITS - 1) / WORD_BITS; //!< Words stored inline
+
+  /**
+   * \return a pointer to the words (inline or on the heap)
+   */
+  uint64_t * Words ()
+  {
+    return m_numWords > INLINE_WORDS ? m_heapWords.data () : m_inlineWords.data ();
+  }
+
+  /**
+   * \return a pointer to the words (inline or on the heap)
+   */
+  const uint64_t * Words () const
+  {
+    return m_numWords > INLINE_WORDS ? m_heapWords.data () : m_inlineWords.data ();
+  }
+
+  /**
+   * \param i bit index
+   * \return the mask of the bit inside its word
+   */
+  static uint64_t Bit (uint32_t i)
+  {
+    return 1ULL << (i % WORD_BITS);
+  }
+
+  /**
+   * \param i first bit to consider
+   * \return the index of the first bit set starting from i, or Size()
+   */
+  uint32_t FindFrom (uint32_t i) const
+  {
+    if (i >= m_size)
+      {
+        return m_size;
+      }
+    const uint64_t *words = Words ();
+    uint32_t w = i / WORD_BITS;
+    uint64_t word = words[w] & (~0ULL << (i % WORD_BITS));
+    while (true)
+      {
+        if (word != 0)
+          {
+            uint32_t ret = w * WORD_BITS + static_cast<uint32_t> (__builtin_ctzll (word));
+            return ret < m_size ? ret : m_size;
+          }
+        if (++w == m_numWords)
+          {
+            return m_size;
+          }
+        word = words[w];
+      }
+  }
+
+  /**
+   * \param i first bit to consider
+   * \return the index of the first bit NOT set starting from i, or Size()
+   */
+  uint32_t FindFromZero (uint32_t i) const
+  {
+    if (i >= m_size)
+      {
+        return m_size;
+      }
+    const uint64_t *words = Words ();
+    uint32_t w = i / WORD_BITS;
+    uint64_t word = ~words[w] & (~0ULL << (i % WORD_BITS));
+    while (true)
+      {
+        if (word != 0)
+          {
+            uint32_t ret = w * WORD_BITS + static_cast<uint32_t> (__builtin_ctzll (word));
+            return ret < m_size ? ret : m_size;
+          }
+        if (++w == m_numWords)
+          {
+            return m_size;
+          }
+        word = ~words[w];
+      }
+  }
+
+  std::array<uint64_t, INLINE_WORDS> m_inlineWords {{}}; //!< The bits, when they fit inline
+  std::vector<uint64_t> m_heapWords;                     //!< The bits, for wider bitmasks
+  uint32_t m_size {0};                                   //!< Number of valid bits
+  uint32_t m_numWords {0};                               //!< Number of used words
+};
+
+/**
+ * \brief Bitwise OR between two bitmasks
+ * \param a first bitmask
+ * \param b second bitmask
+ * \return a | b
+ */
+inline RbgBitmask
+operator| (RbgBitmask a, const RbgBitmask &b)
+{
+  a |= b;
+  return a;
+}
+
+/**
+ * \brief Bitwise AND between two bitmasks
+ * \param a first bitmask
+ * \param b second bitmask
+ * \return a & b
+ */
+inline RbgBitmask
+operator& (RbgBitmask a, const RbgBitmask &b)
+{
+  a &= b;
+  return a;
+}
+
+/**
+ * \brief Print the bitmask as a sequence of 0 and 1
+ * \param os output stream
+ * \param item the bitmask
+ * \return the output stream
+ */
+inline std::ostream &
+operator<< (std::ostream &os, const RbgBitmask &item)
+{
+  for (uint32_t i = 0; i < item.Size (); ++i)
+    {
+      os << (item.Test (i) ? '1' : '0');
+    }
+  return os;
+}
+
+} // namespace ns3
@@ -31,7 +31,6 @@
 #include <ns3/fatal-error.h>
 #include <ns3/log.h>
 #include <ns3/nstime.h>
-#include <ns3/node-list.h>
 #include <ns3/node.h>
 #include <ns3/simulator.h>
 
@@ -40,6 +39,10 @@
 #include "mmwave-ue-net-device.h"
 #include "mmwave-enb-net-device.h"
 
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 NS_LOG_COMPONENT_DEFINE ("mmWaveRrcProtocolIdeal");
 
 
@@ -48,23 +51,67 @@ namespace ns3 {
 
 static const Time RRC_IDEAL_MSG_DELAY = MilliSeconds (0);
 
+/*
+ * Directory of the ideal RRC protocols by cell ID, which replaces the walks
+ * of the NodeList to find the eNB of a cell and the UEs in a cell: the eNB
+ * protocol of each cell, and the UE protocols of the UEs last seen in each
+ * cell, ordered by IMSI. The protocols remove themselves when disposed, and
+ * the directory is cleared at Simulator::Destroy.
+ *
+ */
+static std::unordered_map<uint16_t, MmWaveEnbRrcProtocolIdeal*> g_enbProtocolByCellId;
+static std::unordered_map<uint16_t, std::set<std::pair<uint64_t, mmWaveUeRrcProtocolIdeal*> > > g_ueProtocolsByCellId;
+static bool g_directoryClearScheduled = false; //!< Whether ClearDirectory is scheduled at Simulator::Destroy
+
+/*
+ * Clear the directory at Simulator::Destroy: the protocols that are not
+ * disposed by then (e.g., kept alive by the user) must not be found by the
+ * protocols of the next simulation.
+ */
+static void
+ClearDirectory ()
+{
+  NS_LOG_LOGIC ("Clearing the directory, " << g_enbProtocolByCellId.size () << " eNB and "
+                << g_ueProtocolsByCellId.size () << " UE cells left");
+  g_enbProtocolByCellId.clear ();
+  g_ueProtocolsByCellId.clear ();
+  g_directoryClearScheduled = false;
+}
+
+/*
+ * Schedule ClearDirectory at Simulator::Destroy, if not already done
+ */
+static void
+ScheduleClearDirectory ()
+{
+  if (!g_directoryClearScheduled)
+    {
+      Simulator::ScheduleDestroy (&ClearDirectory);
+      g_directoryClearScheduled = true;
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED (mmWaveUeRrcProtocolIdeal);
 
 mmWaveUeRrcProtocolIdeal::mmWaveUeRrcProtocolIdeal ()
   :  m_ueRrcSapProvider (0),
-  m_enbRrcSapProvider (0)
+  m_enbRrcSapProvider (0),
+  m_directoryCellId (0),
+  m_directoryImsi (0)
 {
   m_ueRrcSapUser = new MemberLteUeRrcSapUser<mmWaveUeRrcProtocolIdeal> (this);
 }
 
 mmWaveUeRrcProtocolIdeal::~mmWaveUeRrcProtocolIdeal ()
 {
+  RemoveFromDirectory ();
 }
 
 void
 mmWaveUeRrcProtocolIdeal::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  RemoveFromDirectory ();
   delete m_ueRrcSapUser;
   m_rrc = 0;
 }
@@ -95,6 +142,68 @@ void
 mmWaveUeRrcProtocolIdeal::SetUeRrc (Ptr<LteUeRrc> rrc)
 {
   m_rrc = rrc;
+  m_rrc->TraceConnectWithoutContext ("StateTransition",
+                                     MakeCallback (&mmWaveUeRrcProtocolIdeal::NotifyStateTransition, this));
+  m_rrc->TraceConnectWithoutContext ("HandoverStart",
+                                     MakeCallback (&mmWaveUeRrcProtocolIdeal::NotifyHandoverStart, this));
+  UpdateDirectory (m_rrc->GetImsi (), m_rrc->GetCellId ());
+}
+
+Ptr<LteUeRrc>
+mmWaveUeRrcProtocolIdeal::GetUeRrc () const
+{
+  return m_rrc;
+}
+
+void
+mmWaveUeRrcProtocolIdeal::UpdateDirectory (uint64_t imsi, uint16_t cellId)
+{
+  if (cellId == m_directoryCellId && imsi == m_directoryImsi)
+    {
+      return;
+    }
+  NS_LOG_LOGIC (this << " IMSI " << imsi << " moves from cell " << m_directoryCellId << " to " << cellId);
+  RemoveFromDirectory ();
+  if (cellId != 0)
+    {
+      ScheduleClearDirectory ();
+      g_ueProtocolsByCellId[cellId].insert (std::make_pair (imsi, this));
+      m_directoryCellId = cellId;
+      m_directoryImsi = imsi;
+    }
+}
+
+void
+mmWaveUeRrcProtocolIdeal::RemoveFromDirectory ()
+{
+  if (m_directoryCellId == 0)
+    {
+      return;
+    }
+  auto cell = g_ueProtocolsByCellId.find (m_directoryCellId);
+  if (cell != g_ueProtocolsByCellId.end ())
+    {
+      cell->second.erase (std::make_pair (m_directoryImsi, this));
+      if (cell->second.empty ())
+        {
+          g_ueProtocolsByCellId.erase (cell);
+        }
+    }
+  m_directoryCellId = 0;
+}
+
+void
+mmWaveUeRrcProtocolIdeal::NotifyStateTransition (uint64_t imsi, uint16_t cellId, uint16_t rnti,
+                                                 LteUeRrc::State oldState, LteUeRrc::State newState)
+{
+  UpdateDirectory (imsi, cellId);
+}
+
+void
+mmWaveUeRrcProtocolIdeal::NotifyHandoverStart (uint64_t imsi, uint16_t cellId, uint16_t rnti, uint16_t targetCellId)
+{
+  // The UE RRC switches to the target cell right after this trace
+  UpdateDirectory (imsi, targetCellId);
 }
 
 void
@@ -179,38 +288,14 @@ mmWaveUeRrcProtocolIdeal::SetEnbRrcSapProvider ()
 {
   uint16_t cellId = m_rrc->GetCellId ();
 
-  // walk list of all nodes to get the peer eNB
-  Ptr<MmWaveEnbNetDevice> enbDev;
-  NodeList::Iterator listEnd = NodeList::End ();
-  bool found = false;
-  for (NodeList::Iterator i = NodeList::Begin ();
-       (i != listEnd) && (!found);
-       ++i)
-    {
-      Ptr<Node> node = *i;
-      int nDevs = node->GetNDevices ();
-      for (int j = 0;
-           (j < nDevs) && (!found);
-           j++)
-        {
-          enbDev = node->GetDevice (j)->GetObject <MmWaveEnbNetDevice> ();
-          if (enbDev == 0)
-            {
-              continue;
-            }
-          else
-            {
-              if (enbDev->GetCellId () == cellId)
-                {
-                  found = true;
-                  break;
-                }
-            }
-        }
-    }
-  NS_ASSERT_MSG (found, " Unable to find eNB with CellId =" << cellId);
-  m_enbRrcSapProvider = enbDev->GetRrc ()->GetLteEnbRrcSapProvider ();
-  Ptr<MmWaveEnbRrcProtocolIdeal> enbRrcProtocolIdeal = enbDev->GetRrc ()->GetObject<MmWaveEnbRrcProtocolIdeal> ();
+  // get the peer eNB from the directory
+  auto it = g_enbProtocolByCellId.find (cellId);
+  NS_ASSERT_MSG (it != g_enbProtocolByCellId.end (), " Unable to find eNB with CellId =" << cellId);
+  MmWaveEnbRrcProtocolIdeal *enbRrcProtocolIdeal = it->second;
+  NS_ASSERT_MSG (enbRrcProtocolIdeal->GetCellId () == cellId,
+                 "Stale eNB of CellId " << cellId << " in the directory, now in cell "
+                 << enbRrcProtocolIdeal->GetCellId ());
+  m_enbRrcSapProvider = enbRrcProtocolIdeal->GetLteEnbRrcSapProvider ();
   enbRrcProtocolIdeal->SetUeRrcSapProvider (m_rnti, m_ueRrcSapProvider);
 }
 
@@ -218,7 +303,8 @@ mmWaveUeRrcProtocolIdeal::SetEnbRrcSapProvider ()
 NS_OBJECT_ENSURE_REGISTERED (MmWaveEnbRrcProtocolIdeal);
 
 MmWaveEnbRrcProtocolIdeal::MmWaveEnbRrcProtocolIdeal ()
-  :  m_enbRrcSapProvider (0)
+  :  m_cellId (0),
+  m_enbRrcSapProvider (0)
 {
   NS_LOG_FUNCTION (this);
   m_enbRrcSapUser = new MemberLteEnbRrcSapUser<MmWaveEnbRrcProtocolIdeal> (this);
@@ -227,12 +313,14 @@ MmWaveEnbRrcProtocolIdeal::MmWaveEnbRrcProtocolIdeal ()
 MmWaveEnbRrcProtocolIdeal::~MmWaveEnbRrcProtocolIdeal ()
 {
   NS_LOG_FUNCTION (this);
+  RemoveFromDirectory ();
 }
 
 void
 MmWaveEnbRrcProtocolIdeal::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  RemoveFromDirectory ();
   delete m_enbRrcSapUser;
 }
 
@@ -252,6 +340,12 @@ MmWaveEnbRrcProtocolIdeal::SetLteEnbRrcSapProvider (LteEnbRrcSapProvider* p)
   m_enbRrcSapProvider = p;
 }
 
+LteEnbRrcSapProvider*
+MmWaveEnbRrcProtocolIdeal::GetLteEnbRrcSapProvider () const
+{
+  return m_enbRrcSapProvider;
+}
+
 LteEnbRrcSapUser*
 MmWaveEnbRrcProtocolIdeal::GetLteEnbRrcSapUser ()
 {
@@ -261,7 +355,55 @@ MmWaveEnbRrcProtocolIdeal::GetLteEnbRrcSapUser ()
 void
 MmWaveEnbRrcProtocolIdeal::SetCellId (uint16_t cellId)
 {
+  RemoveFromDirectory ();
   m_cellId = cellId;
+  ScheduleClearDirectory ();
+  // As the walk of the NodeList did, the first eNB of a cell is kept
+  auto it = g_enbProtocolByCellId.insert (std::make_pair (cellId, this)).first;
+  NS_ASSERT_MSG (it->second->m_cellId == cellId,
+                 "Stale eNB of CellId " << cellId << " in the directory, now in cell " << it->second->m_cellId);
+}
+
+uint16_t
+MmWaveEnbRrcProtocolIdeal::GetCellId () const
+{
+  return m_cellId;
+}
+
+Ptr<MmWaveEnbRrcProtocolIdeal>
+MmWaveEnbRrcProtocolIdeal::GetDirectoryEnb (uint16_t cellId)
+{
+  auto it = g_enbProtocolByCellId.find (cellId);
+  if (it == g_enbProtocolByCellId.end ())
+    {
+      return nullptr;
+    }
+  return it->second;
+}
+
+std::vector<uint64_t>
+MmWaveEnbRrcProtocolIdeal::GetDirectoryUes (uint16_t cellId)
+{
+  std::vector<uint64_t> imsis;
+  auto cell = g_ueProtocolsByCellId.find (cellId);
+  if (cell != g_ueProtocolsByCellId.end ())
+    {
+      for (const auto & ue : cell->second)
+        {
+          imsis.push_back (ue.first);
+        }
+    }
+  return imsis;
+}
+
+void
+MmWaveEnbRrcProtocolIdeal::RemoveFromDirectory ()
+{
+  auto it = g_enbProtocolByCellId.find (m_cellId);
+  if (it != g_enbProtocolByCellId.end () && it->second == this)
+    {
+      g_enbProtocolByCellId.erase (it);
+    }
 }
 
 LteUeRrcSapProvider*
@@ -301,29 +443,34 @@ void
 MmWaveEnbRrcProtocolIdeal::DoSendSystemInformation (uint16_t cellId, LteRrcSap::SystemInformation msg)
 {
   NS_LOG_FUNCTION (this << m_cellId);
-  // walk list of all nodes to get UEs with this cellId
-  Ptr<LteUeRrc> ueRrc;
-  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+  // get the UEs with this cellId from the directory; copy them, since the
+  // reception of the message may move an UE to another cell
+  auto cell = g_ueProtocolsByCellId.find (m_cellId);
+  if (cell == g_ueProtocolsByCellId.end ())
+    {
+      return;
+    }
+  const std::vector<std::pair<uint64_t, mmWaveUeRrcProtocolIdeal*> > ues (cell->second.begin (), cell->second.end ());
+  for (const auto & ue : ues)
     {
-      Ptr<Node> node = *i;
-      int nDevs = node->GetNDevices ();
-      for (int j = 0; j < nDevs; ++j)
+      Ptr<LteUeRrc> ueRrc = ue.second->GetUeRrc ();
+      // The disposed protocols are removed from the directory
+      NS_ASSERT_MSG (ueRrc != 0, "Stale UE of IMSI " << ue.first << " in the directory of cell " << m_cellId);
+      if (ueRrc == 0)
+        {
+          continue;
+        }
+      NS_ASSERT_MSG (ueRrc->GetImsi () == ue.first, "Stale UE of IMSI " << ue.first
+                     << " in the directory of cell " << m_cellId << ", now IMSI " << ueRrc->GetImsi ());
+      NS_LOG_LOGIC ("considering UE IMSI " << ueRrc->GetImsi () << " that has cellId " << ueRrc->GetCellId ());
+      if (ueRrc->GetCellId () == m_cellId)
         {
-          Ptr<MmWaveUeNetDevice> mmWaveUeDev = node->GetDevice (j)->GetObject <MmWaveUeNetDevice> ();
-          if (mmWaveUeDev != 0)
-            {
-              Ptr<LteUeRrc> ueRrc = mmWaveUeDev->GetRrc ();
-              NS_LOG_LOGIC ("considering UE IMSI " << mmWaveUeDev->GetImsi () << " that has cellId " << ueRrc->GetCellId ());
-              if (ueRrc->GetCellId () == m_cellId)
-                {
-                  NS_LOG_LOGIC ("sending SI to IMSI " << mmWaveUeDev->GetImsi ());
-                  ueRrc->GetLteUeRrcSapProvider ()->RecvSystemInformation (msg);
-                  Simulator::Schedule (RRC_IDEAL_MSG_DELAY,
-                                       &LteUeRrcSapProvider::RecvSystemInformation,
-                                       ueRrc->GetLteUeRrcSapProvider (),
-                                       msg);
-                }
-            }
+          NS_LOG_LOGIC ("sending SI to IMSI " << ueRrc->GetImsi ());
+          ueRrc->GetLteUeRrcSapProvider ()->RecvSystemInformation (msg);
+          Simulator::Schedule (RRC_IDEAL_MSG_DELAY,
+                               &LteUeRrcSapProvider::RecvSystemInformation,
+                               ueRrc->GetLteUeRrcSapProvider (),
+                               msg);
         }
     }
 }
@@ -32,10 +32,12 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
 
 #include <ns3/ptr.h>
 #include <ns3/object.h>
 #include <ns3/lte-rrc-sap.h>
+#include <ns3/lte-ue-rrc.h>
 
 namespace ns3 {
 
@@ -50,6 +52,10 @@ class LteUeRrc;
  * an ideal fashion, without errors and without consuming any radio
  * resources.
  *
+ * The protocol follows the cell of its UE RRC (at each state transition
+ * and at the start of a handover) in a directory by cell ID, which the eNB
+ * protocol of the cell uses to send the system information.
+ *
  */
 class mmWaveUeRrcProtocolIdeal : public Object
 {
@@ -67,6 +73,7 @@ public:
   LteUeRrcSapUser* GetLteUeRrcSapUser ();
 
   void SetUeRrc (Ptr<LteUeRrc> rrc);
+  Ptr<LteUeRrc> GetUeRrc () const;
 
 
 private:
@@ -81,11 +88,28 @@ private:
 
   void SetEnbRrcSapProvider ();
 
+  /**
+   * \brief Move the protocol to the cell of its UE in the directory
+   * \param imsi the IMSI of the UE
+   * \param cellId the cell ID of the UE, or 0 if none
+   */
+  void UpdateDirectory (uint64_t imsi, uint16_t cellId);
+  /**
+   * \brief Remove the protocol from the directory
+   */
+  void RemoveFromDirectory ();
+  // trace sinks of the UE RRC, which update the directory
+  void NotifyStateTransition (uint64_t imsi, uint16_t cellId, uint16_t rnti,
+                              LteUeRrc::State oldState, LteUeRrc::State newState);
+  void NotifyHandoverStart (uint64_t imsi, uint16_t cellId, uint16_t rnti, uint16_t targetCellId);
+
   Ptr<LteUeRrc> m_rrc;
   uint16_t m_rnti;
   LteUeRrcSapProvider* m_ueRrcSapProvider;
   LteUeRrcSapUser* m_ueRrcSapUser;
   LteEnbRrcSapProvider* m_enbRrcSapProvider;
+  uint16_t m_directoryCellId; //!< Cell of the protocol in the directory, 0 if none
+  uint64_t m_directoryImsi; //!< IMSI of the protocol in the directory
 
 };
 
@@ -95,6 +119,9 @@ private:
  * an ideal fashion, without errors and without consuming any radio
  * resources.
  *
+ * The protocol is registered in a directory by cell ID, which the UE
+ * protocols use to find the eNB of their cell.
+ *
  */
 class MmWaveEnbRrcProtocolIdeal : public Object
 {
@@ -109,9 +136,27 @@ public:
   static TypeId GetTypeId (void);
 
   void SetLteEnbRrcSapProvider (LteEnbRrcSapProvider* p);
+  LteEnbRrcSapProvider* GetLteEnbRrcSapProvider () const;
   LteEnbRrcSapUser* GetLteEnbRrcSapUser ();
 
   void SetCellId (uint16_t cellId);
+  /**
+   * \return the cell ID of the protocol
+   */
+  uint16_t GetCellId () const;
+
+  /**
+   * \brief Get the eNB protocol of a cell from the directory
+   * \param cellId the cell ID
+   * \return the eNB protocol, or nullptr if the cell is not in the directory
+   */
+  static Ptr<MmWaveEnbRrcProtocolIdeal> GetDirectoryEnb (uint16_t cellId);
+  /**
+   * \brief Get the UEs of a cell from the directory
+   * \param cellId the cell ID
+   * \return the IMSIs of the UEs last seen in the cell, in increasing order
+   */
+  static std::vector<uint64_t> GetDirectoryUes (uint16_t cellId);
 
   LteUeRrcSapProvider* GetUeRrcSapProvider (uint16_t rnti);
   void SetUeRrcSapProvider (uint16_t rnti, LteUeRrcSapProvider* p);
@@ -133,6 +178,10 @@ private:
   Ptr<Packet> DoEncodeHandoverCommand (LteRrcSap::RrcConnectionReconfiguration msg);
   LteRrcSap::RrcConnectionReconfiguration DoDecodeHandoverCommand (Ptr<Packet> p);
 
+  /**
+   * \brief Remove the protocol from the directory
+   */
+  void RemoveFromDirectory ();
 
   uint16_t m_rnti;
   uint16_t m_cellId;
@@ -0,0 +1,293 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <ns3/abort.h>
+#include <ns3/mmwave-phy-mac-common.h>
+
+namespace ns3 {
+
+/**
+ * \brief Fixed-size circular table of per-slot elements, indexed by SfnSf
+ *
+ * PHY and scheduler keep information about a limited window of future slots
+ * (bounded by L1L2CtrlLatency + UlSchedDelay, plus the slots still waiting
+ * for a feedback such as the UL CQI). Instead of storing these elements in a
+ * tree or in a hash table, the ring converts the SfnSf into an absolute slot
+ * number and uses it, modulo the capacity, as index into a vector that is
+ * allocated once in Configure().
+ *
+ * Insertion, lookup and removal are O(1) and do not allocate memory: the
+ * cells are reused, and an erased element is only marked as invalid (its
+ * value is kept, so that containers inside it can reuse their storage).
+ *
+ * If an insertion finds the cell occupied by an older slot, the old element
+ * is considered expired and it is overwritten. The capacity should then be
+ * chosen large enough to cover the maximum lifetime of an element: in debug
+ * builds, overwriting an element that is not older than the lookahead (e.g.,
+ * the element of a later slot) is an error.
+ *
+ * Only frame, subframe and slot of the SfnSf are considered; the varTti
+ * is ignored, as in SfnSf::operator==.
+ */
+template <typename T>
+class MmWaveSlotRing
+{
+public:
+  /**
+   * \brief Default constructor. Please call Configure() before using the ring.
+   */
+  MmWaveSlotRing () = default;
+
+  /**
+   * \brief Allocate the ring
+   * \param lookahead maximum distance, in slots, between the first and the
+   * last element stored at the same time
+   * \param slotsPerSubframe number of slots in a subframe
+   * \param subframesPerFrame number of subframes in a frame
+   *
+   * The capacity is the first power of two greater than lookahead; all
+   * stored elements are removed.
+   */
+  void Configure (uint32_t lookahead, uint32_t slotsPerSubframe, uint32_t subframesPerFrame)
+  {
+    NS_ASSERT (slotsPerSubframe > 0 && subframesPerFrame > 0);
+    uint32_t capacity = 1;
+    while (capacity <= lookahead)
+      {
+        capacity <<= 1;
+      }
+    m_slotsPerSubframe = slotsPerSubframe;
+    m_subframesPerFrame = subframesPerFrame;
+    m_lookahead = lookahead;
+    m_period = (static_cast<uint64_t> (std::numeric_limits<decltype (SfnSf::m_frameNum)>::max ()) + 1)
+      * subframesPerFrame * slotsPerSubframe;
+    m_mask = capacity - 1;
+    m_size = 0;
+    m_cells.clear ();
+    m_cells.resize (capacity);
+  }
+
+  /**
+   * \return true if Configure() has been called
+   */
+  bool IsConfigured () const
+  {
+    return ! m_cells.empty ();
+  }
+
+  /**
+   * \return the number of cells of the ring
+   */
+  uint32_t GetCapacity () const
+  {
+    return static_cast<uint32_t> (m_cells.size ());
+  }
+
+  /**
+   * \return the number of valid elements stored
+   */
+  uint32_t Size () const
+  {
+    return m_size;
+  }
+
+  /**
+   * \brief Convert a SfnSf into an absolute slot number
+   * \param sfn the SfnSf
+   * \return the number of slots from (0, 0, 0)
+   */
+  uint64_t ToAbsoluteSlot (const SfnSf &sfn) const
+  {
+    return (static_cast<uint64_t> (sfn.m_frameNum) * m_subframesPerFrame + sfn.m_subframeNum)
+           * m_slotsPerSubframe + sfn.m_slotNum;
+  }
+
+  /**
+   * \brief Check if an element for the slot is stored
+   * \param sfn the slot
+   * \return true if there is a valid element for the slot
+   */
+  bool Contains (const SfnSf &sfn) const
+  {
+    NS_ASSERT_MSG (IsConfigured (), "MmWaveSlotRing used before Configure()");
+    const uint64_t slot = ToAbsoluteSlot (sfn);
+    const Cell &cell = m_cells[slot & m_mask];
+    return cell.m_valid && cell.m_slot == slot;
+  }
+
+  /**
+   * \brief Find the element of a slot
+   * \param sfn the slot
+   * \return a pointer to the element, or nullptr if it does not exist
+   */
+  T * Find (const SfnSf &sfn)
+  {
+    NS_ASSERT_MSG (IsConfigured (), "MmWaveSlotRing used before Configure()");
+    const uint64_t slot = ToAbsoluteSlot (sfn);
+    Cell &cell = m_cells[slot & m_mask];
+    return (cell.m_valid && cell.m_slot == slot) ? &cell.m_value : nullptr;
+  }
+
+  /**
+   * \brief Get the element of a slot (that must exist)
+   * \param sfn the slot
+   * \return a reference to the element
+   */
+  T & At (const SfnSf &sfn)
+  {
+    T * value = Find (sfn);
+    NS_ABORT_MSG_IF (value == nullptr, "No element stored for slot " << sfn);
+    return *value;
+  }
+
+  /**
+   * \brief Store an element for a slot
+   * \param sfn the slot
+   * \param value the element
+   * \return a reference to the stored element
+   *
+   * An existing element for the same slot is overwritten, as well as an
+   * expired element of an older slot that maps to the same cell.
+   */
+  T & Insert (const SfnSf &sfn, T value)
+  {
+    NS_ASSERT_MSG (IsConfigured (), "MmWaveSlotRing used before Configure()");
+    const uint64_t slot = ToAbsoluteSlot (sfn);
+    Cell &cell = m_cells[slot & m_mask];
+    NS_ASSERT_MSG (! cell.m_valid || cell.m_slot == slot || IsExpired (cell, slot),
+                   "Slot " << sfn << " (" << slot << ") overwrites the element of slot " << cell.m_slot
+                   << ", which is not older than the lookahead of " << m_lookahead << " slots");
+    if (! cell.m_valid)
+      {
+        ++m_size;
+      }
+    cell.m_slot = slot;
+    cell.m_valid = true;
+    cell.m_value = std::move (value);
+    return cell.m_value;
+  }
+
+  /**
+   * \brief Get the element of a slot, claiming its cell if the element does
+   * not exist
+   * \param sfn the slot
+   * \param claimed set to true if the cell has been claimed for the slot
+   * \return a reference to the element
+   *
+   * When the cell is claimed, the element still holds the value left by the
+   * previous slot of the cell (or a default-constructed value): the caller
+   * should reset it, reusing its storage if possible.
+   */
+  T & FindOrClaim (const SfnSf &sfn, bool *claimed)
+  {
+    NS_ASSERT_MSG (IsConfigured (), "MmWaveSlotRing used before Configure()");
+    const uint64_t slot = ToAbsoluteSlot (sfn);
+    Cell &cell = m_cells[slot & m_mask];
+    NS_ASSERT_MSG (! cell.m_valid || cell.m_slot == slot || IsExpired (cell, slot),
+                   "Slot " << sfn << " (" << slot << ") claims the element of slot " << cell.m_slot
+                   << ", which is not older than the lookahead of " << m_lookahead << " slots");
+    *claimed = ! (cell.m_valid && cell.m_slot == slot);
+    if (! cell.m_valid)
+      {
+        ++m_size;
+      }
+    cell.m_slot = slot;
+    cell.m_valid = true;
+    return cell.m_value;
+  }
+
+  /**
+   * \brief Remove the element of a slot, if it exists
+   * \param sfn the slot
+   * \return true if an element was removed
+   */
+  bool Erase (const SfnSf &sfn)
+  {
+    NS_ASSERT_MSG (IsConfigured (), "MmWaveSlotRing used before Configure()");
+    const uint64_t slot = ToAbsoluteSlot (sfn);
+    Cell &cell = m_cells[slot & m_mask];
+    if (cell.m_valid && cell.m_slot == slot)
+      {
+        cell.m_valid = false;
+        --m_size;
+        return true;
+      }
+    return false;
+  }
+
+  /**
+   * \brief Remove the element of a slot, and move it out of the ring
+   * \param sfn the slot (the element must exist)
+   * \return the element
+   */
+  T Extract (const SfnSf &sfn)
+  {
+    T value = std::move (At (sfn));
+    Erase (sfn);
+    return value;
+  }
+
+  /**
+   * \brief Remove all the elements
+   */
+  void Clear ()
+  {
+    for (auto & cell : m_cells)
+      {
+        cell.m_valid = false;
+      }
+    m_size = 0;
+  }
+
+private:
+  /**
+   * \brief A cell of the ring
+   */
+  struct Cell
+  {
+    uint64_t m_slot {0};    //!< Absolute slot number of the stored element
+    bool m_valid    {false}; //!< True if m_value contains a valid element
+    T m_value       {};     //!< The element
+  };
+
+  /**
+   * \brief Check if the element of a cell can be overwritten by a slot
+   * \param cell the cell
+   * \param slot the absolute slot number that maps to the cell
+   * \return true if the element of the cell is older than the slot by more
+   * than the lookahead (the frame number can wrap in between)
+   */
+  bool IsExpired (const Cell &cell, uint64_t slot) const
+  {
+    const uint64_t age = (slot + m_period - cell.m_slot) % m_period;
+    return age > m_lookahead && age < m_period / 2;
+  }
+
+  std::vector<Cell> m_cells;          //!< The cells
+  uint64_t m_mask             {0};    //!< capacity - 1
+  uint64_t m_lookahead        {0};    //!< Lookahead of Configure(), in slots
+  uint64_t m_period           {1};    //!< Slots before the frame number wraps
+  uint32_t m_size             {0};    //!< Number of valid elements
+  uint32_t m_slotsPerSubframe {1};    //!< Slots per subframe
+  uint32_t m_subframesPerFrame {1};   //!< Subframes per frame
+};
+
+} // namespace ns3
@@ -0,0 +1,282 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-spectrum-channel.h"
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/node.h>
+#include <ns3/net-device.h>
+#include <ns3/antenna-model.h>
+#include <ns3/angles.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/propagation-delay-model.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (MmWaveSpectrumChannel);
+
+TypeId
+MmWaveSpectrumChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MmWaveSpectrumChannel")
+    .SetParent<MultiModelSpectrumChannel> ()
+    .SetGroupName ("nr")
+    .AddConstructor<MmWaveSpectrumChannel> ()
+    .AddAttribute ("NumWorkers",
+                   "Number of threads, including the simulator one, that compute the "
+                   "beamforming gain of the receivers of a transmission. 1 means that "
+                   "everything runs in the simulator thread.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MmWaveSpectrumChannel::SetNumWorkers,
+                                         &MmWaveSpectrumChannel::GetNumWorkers),
+                   MakeUintegerChecker<uint32_t> (1, 256))
+    .AddTraceSource ("RxSigParams",
+                     "The parameters of the signals delivered to the receivers, "
+                     "in the order they are delivered",
+                     MakeTraceSourceAccessor (&MmWaveSpectrumChannel::m_rxSigParamsTrace),
+                     "ns3::MmWaveSpectrumChannel::RxSigParamsTracedCallback")
+    ;
+  return tid;
+}
+
+MmWaveSpectrumChannel::MmWaveSpectrumChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MmWaveSpectrumChannel::~MmWaveSpectrumChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MmWaveSpectrumChannel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_workers.SetNumWorkers (1);
+  m_rxPhys.clear ();
+  m_pending.clear ();
+  m_conversions.clear ();
+  m_singleSpectrumLoss = nullptr;
+  MultiModelSpectrumChannel::DoDispose ();
+}
+
+void
+MmWaveSpectrumChannel::SetNumWorkers (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_workers.SetNumWorkers (n);
+}
+
+uint32_t
+MmWaveSpectrumChannel::GetNumWorkers () const
+{
+  return m_workers.GetNumWorkers ();
+}
+
+void
+MmWaveSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  // The parent keeps the count of the devices
+  MultiModelSpectrumChannel::AddRx (phy);
+  if (std::find (m_rxPhys.begin (), m_rxPhys.end (), phy) == m_rxPhys.end ())
+    {
+      m_rxPhys.push_back (phy);
+    }
+}
+
+void
+MmWaveSpectrumChannel::RemoveRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  auto it = std::find (m_rxPhys.begin (), m_rxPhys.end (), phy);
+  if (it != m_rxPhys.end ())
+    {
+      m_rxPhys.erase (it);
+    }
+}
+
+void
+MmWaveSpectrumChannel::AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss)
+{
+  NS_LOG_FUNCTION (this << loss);
+  // A model already there becomes the next of the new one in the chain
+  m_singleSpectrumLoss = m_spectrumPropagationLoss ? nullptr : loss;
+  MultiModelSpectrumChannel::AddSpectrumPropagationLossModel (loss);
+}
+
+const MmWaveSpectrumChannel::Conversion &
+MmWaveSpectrumChannel::GetConversion (Ptr<const SpectrumModel> txModel,
+                                      Ptr<const SpectrumModel> rxModel)
+{
+  const auto key = std::make_pair (txModel->GetUid (), rxModel->GetUid ());
+  auto it = m_conversions.find (key);
+  if (it == m_conversions.end ())
+    {
+      Conversion conversion;
+      if (key.first == key.second)
+        {
+          conversion.m_sameModel = true;
+        }
+      else if (txModel->IsOrthogonal (*rxModel))
+        {
+          conversion.m_orthogonal = true;
+        }
+      else
+        {
+          conversion.m_converter = SpectrumConverter (txModel, rxModel);
+        }
+      it = m_conversions.emplace (key, conversion).first;
+    }
+  return it->second;
+}
+
+void
+MmWaveSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
+{
+  NS_LOG_FUNCTION (this << txParams);
+  NS_ASSERT (txParams->txPhy);
+  NS_ASSERT (txParams->psd);
+
+  // copy it since traced value cannot be const (because of potential underlying DynamicCasts)
+  Ptr<SpectrumSignalParameters> txParamsTrace = txParams->Copy ();
+  m_txSigParamsTrace (txParamsTrace);
+
+  Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+  // The BF gain is split from the rest of the chain only for a MmWave3gppChannel
+  // alone; a chain, or a model added without this class, is called as a whole
+  Ptr<MmWave3gppChannel> channel3gpp;
+  if (m_spectrumPropagationLoss == m_singleSpectrumLoss)
+    {
+      channel3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLoss);
+    }
+
+  // First phase: everything that touches the models, in the order of the receivers
+  m_pending.clear ();
+  for (const auto & receiver : m_rxPhys)
+    {
+      if (receiver == txParams->txPhy)
+        {
+          continue;
+        }
+
+      const Conversion &conversion = GetConversion (txParams->psd->GetSpectrumModel (),
+                                                    receiver->GetRxSpectrumModel ());
+      if (conversion.m_orthogonal)
+        {
+          NS_LOG_LOGIC ("the receiver " << receiver << " can not see the signal");
+          continue;
+        }
+
+      PendingRx rx;
+      rx.m_receiver = receiver;
+      rx.m_params = txParams->Copy ();
+      rx.m_params->psd = conversion.m_sameModel ? Copy<SpectrumValue> (txParams->psd)
+                                                : conversion.m_converter.Convert (txParams->psd);
+      rx.m_delay = MicroSeconds (0);
+
+      Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+      if (txMobility && receiverMobility)
+        {
+          double pathLossDb = 0;
+          if (rx.m_params->txAntenna != 0)
+            {
+              Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+              pathLossDb -= rx.m_params->txAntenna->GetGainDb (txAngles);
+            }
+          Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+          if (rxAntenna != 0)
+            {
+              Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+              pathLossDb -= rxAntenna->GetGainDb (rxAngles);
+            }
+          if (m_propagationLoss)
+            {
+              pathLossDb -= m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+            }
+          NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+          m_pathLossTrace (txParams->txPhy, receiver, pathLossDb);
+          if (pathLossDb > m_maxLossDb)
+            {
+              // beyond range
+              continue;
+            }
+          *(rx.m_params->psd) *= std::pow (10.0, (-pathLossDb) / 10.0);
+
+          if (channel3gpp)
+            {
+              rx.m_job = channel3gpp->PrepareBeamformingGain (rx.m_params->psd, txMobility, receiverMobility);
+            }
+          else if (m_spectrumPropagationLoss)
+            {
+              rx.m_params->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rx.m_params->psd,
+                                                                                         txMobility,
+                                                                                         receiverMobility);
+            }
+
+          if (m_propagationDelay)
+            {
+              rx.m_delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+            }
+        }
+      m_pending.push_back (std::move (rx));
+    }
+
+  // Second phase: the BF gains, on raw pointers only
+  if (channel3gpp)
+    {
+      std::vector<std::pair<const MmWave3gppChannel::BeamformingGainJob *, SpectrumValue *> > jobs;
+      for (const auto & rx : m_pending)
+        {
+          if (rx.m_job.m_params != nullptr)
+            {
+              jobs.emplace_back (&rx.m_job, PeekPointer (rx.m_params->psd));
+            }
+        }
+      const MmWave3gppChannel *channel = PeekPointer (channel3gpp);
+      m_workers.ParallelFor (jobs.size (), [&jobs, channel] (size_t i)
+        {
+          channel->ApplyBeamformingGain (*jobs[i].first, jobs[i].second);
+        });
+    }
+
+  // Third phase: the deliveries, in the order of the receivers
+  for (const auto & rx : m_pending)
+    {
+      Ptr<NetDevice> netDev = rx.m_receiver->GetDevice ();
+      uint32_t dstNode = netDev ? netDev->GetNode ()->GetId () : 0xffffffff;
+      Simulator::ScheduleWithContext (dstNode, rx.m_delay, &MmWaveSpectrumChannel::DeliverRx,
+                                      this, rx.m_params, rx.m_receiver);
+    }
+  m_pending.clear ();
+}
+
+void
+MmWaveSpectrumChannel::DeliverRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_FUNCTION (this << params);
+  m_rxSigParamsTrace (params, receiver);
+  receiver->StartRx (params);
+}
+
+} // namespace ns3
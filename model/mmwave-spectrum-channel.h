@@ -0,0 +1,166 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/spectrum-converter.h>
+#include <ns3/traced-callback.h>
+#include "mmwave-3gpp-channel.h"
+#include "mmwave-worker-pool.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ * \brief A MultiModelSpectrumChannel that computes the PSD of the receivers
+ * of a transmission with a pool of worker threads
+ *
+ * StartTx() works in three phases:
+ * - in the simulator thread, for each receiver in the order they were added:
+ *   the PSD conversion, the antenna gains and the propagation loss, and the
+ *   part of the 3GPP channel that creates or updates the channel of the link
+ *   (MmWave3gppChannel::PrepareBeamformingGain), which draws random numbers;
+ * - in the worker pool: the BF gain of each receiver
+ *   (MmWave3gppChannel::ApplyBeamformingGain), that is the sum over clusters
+ *   and bands that takes most of the time of a transmission;
+ * - in the simulator thread: the StartRx event of each receiver is scheduled,
+ *   again in the order the receivers were added.
+ *
+ * The random numbers are drawn and the events are scheduled in the same order
+ * whatever the number of workers, so the results do not depend on it. With
+ * one worker (the default) everything runs in the simulator thread.
+ *
+ * With a spectrum propagation loss model other than MmWave3gppChannel, or
+ * with a chain of models (i.e., when more than one model is added), the
+ * whole chain is called in the first phase, and only the scheduling is
+ * changed with respect to MultiModelSpectrumChannel.
+ */
+class MmWaveSpectrumChannel : public MultiModelSpectrumChannel
+{
+public:
+  /**
+   * \brief Get the type id
+   * \return the type id of the class
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief MmWaveSpectrumChannel constructor
+   */
+  MmWaveSpectrumChannel ();
+
+  /**
+   * \brief ~MmWaveSpectrumChannel
+   */
+  virtual ~MmWaveSpectrumChannel () override;
+
+  // Inherited from SpectrumChannel
+  virtual void AddRx (Ptr<SpectrumPhy> phy) override;
+  virtual void StartTx (Ptr<SpectrumSignalParameters> params) override;
+
+  /**
+   * \brief Remove a receiver from the channel
+   * \param phy the receiver
+   *
+   * The receiver no longer gets the signals of the channel. The
+   * MultiModelSpectrumChannel of this ns-3 version has no method to remove a
+   * receiver, so GetNDevices and GetDevice still count it.
+   */
+  virtual void RemoveRx (Ptr<SpectrumPhy> phy);
+
+  /**
+   * \brief Add a spectrum propagation loss model to the chain of the channel
+   * \param loss the model
+   *
+   * The BF gain of a MmWave3gppChannel is computed by the workers only if it
+   * is the only model of the channel, and it was added with this method.
+   */
+  void AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss);
+
+  /**
+   * \brief Set the number of workers that compute the BF gain
+   * \param n number of workers, including the simulator thread
+   */
+  void SetNumWorkers (uint32_t n);
+
+  /**
+   * \return the number of workers that compute the BF gain
+   */
+  uint32_t GetNumWorkers () const;
+
+  /**
+   * TracedCallback signature for the signals delivered to the receivers.
+   *
+   * \param [in] params The parameters of the received signal.
+   * \param [in] receiver The receiver.
+   */
+  typedef void (* RxSigParamsTracedCallback)(Ptr<SpectrumSignalParameters> params,
+                                             Ptr<SpectrumPhy> receiver);
+
+protected:
+  virtual void DoDispose () override;
+
+private:
+  /**
+   * \brief The conversion of the PSD between two spectrum models
+   */
+  struct Conversion
+  {
+    bool m_orthogonal {false};     //!< True if the receiver can not see the signal
+    bool m_sameModel {false};      //!< True if no conversion is needed
+    SpectrumConverter m_converter; //!< The converter, if the models are different
+  };
+
+  /**
+   * \brief A signal that will be delivered to a receiver
+   */
+  struct PendingRx
+  {
+    Ptr<SpectrumPhy> m_receiver;                  //!< The receiver
+    Ptr<SpectrumSignalParameters> m_params;       //!< The parameters of the received signal
+    MmWave3gppChannel::BeamformingGainJob m_job;  //!< The BF gain to apply, if any
+    Time m_delay;                                 //!< The propagation delay
+  };
+
+  /**
+   * \brief Get, or create, the conversion between two spectrum models
+   * \param txModel the model of the transmitted PSD
+   * \param rxModel the model of the receiver
+   * \return the conversion
+   */
+  const Conversion & GetConversion (Ptr<const SpectrumModel> txModel,
+                                    Ptr<const SpectrumModel> rxModel);
+
+  /**
+   * \brief Deliver a signal to a receiver
+   * \param params the parameters of the received signal
+   * \param receiver the receiver
+   */
+  void DeliverRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+  std::vector<Ptr<SpectrumPhy> > m_rxPhys; //!< The receivers, in the order they were added, until removed
+  std::map<std::pair<SpectrumModelUid_t, SpectrumModelUid_t>, Conversion> m_conversions; //!< Conversions, by (TX, RX) model
+  std::vector<PendingRx> m_pending;        //!< The signals of the current transmission
+  MmWaveWorkerPool m_workers;              //!< The workers that compute the BF gain
+  Ptr<SpectrumPropagationLossModel> m_singleSpectrumLoss; //!< The spectrum propagation loss model, if it is the only one
+  TracedCallback<Ptr<SpectrumSignalParameters>, Ptr<SpectrumPhy> > m_rxSigParamsTrace; //!< Signals delivered to the receivers
+};
+
+} // namespace ns3
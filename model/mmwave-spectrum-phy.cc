@@ -238,9 +238,15 @@ MmWaveSpectrumPhy::SetPhyRxCtrlEndOkCallback (MmWavePhyRxCtrlEndOkCallback c)
   m_phyRxCtrlEndOkCallback = c;
 }
 
+void
+MmWaveSpectrumPhy::SetPhyRxDciEndOkCallback (MmWavePhyRxDciEndOkCallback c)
+{
+  m_phyRxDciEndOkCallback = c;
+}
+
 void
 MmWaveSpectrumPhy::AddExpectedTb (uint16_t rnti, uint8_t ndi, uint32_t size, uint8_t mcs,
-                                  std::vector<int> rbMap, uint8_t harqId, uint8_t rv, bool downlink,
+                                  const RbgBitmask &rbMap, uint8_t harqId, uint8_t rv, bool downlink,
                                   uint8_t symStart, uint8_t numSym)
 {
   //layer = layer;
@@ -471,10 +477,11 @@ MmWaveSpectrumPhy::StartRxCtrl (Ptr<SpectrumSignalParameters> params)
               {
                 // first transmission, i.e., we're IDLE and we start RX
                 NS_ASSERT (m_rxControlMessageList.empty ());
+                NS_ASSERT (m_rxDciPerRntiList.empty ());
                 m_firstRxStart = Simulator::Now ();
                 m_firstRxDuration = params->duration;
                 NS_LOG_LOGIC (this << " scheduling EndRx with delay " << params->duration);
-                // store the DCIs
+                // store the control messages
                 m_rxControlMessageList = dlCtrlRxParams->ctrlMsgList;
                 Simulator::Schedule (params->duration, &MmWaveSpectrumPhy::EndRxCtrl, this);
                 ChangeState (RX_CTRL);
@@ -483,6 +490,12 @@ MmWaveSpectrumPhy::StartRxCtrl (Ptr<SpectrumSignalParameters> params)
               {
                 m_rxControlMessageList.insert (m_rxControlMessageList.end (), dlCtrlRxParams->ctrlMsgList.begin (), dlCtrlRxParams->ctrlMsgList.end ());
               }
+            // store the DCIs: only the index is kept, the lookup of the
+            // UE DCI is done at the end of the reception
+            if (dlCtrlRxParams->dciPerRnti)
+              {
+                m_rxDciPerRntiList.push_back (dlCtrlRxParams->dciPerRnti);
+              }
 
           }
         break;
@@ -545,7 +558,7 @@ MmWaveSpectrumPhy::EndRxData ()
           itTb->second.corrupt = m_random->GetValue () > tbStats.tbler ? false : true;
           if (itTb->second.corrupt)
             {
-              NS_LOG_INFO (this << " RNTI " << itTb->first << " size " << itTb->second.size << " mcs " << (uint32_t)itTb->second.mcs << " bitmap " << itTb->second.rbBitmap.size () << " rv " << rv << " TBLER " << tbStats.tbler << " corrupted " << itTb->second.corrupt);
+              NS_LOG_INFO (this << " RNTI " << itTb->first << " size " << itTb->second.size << " mcs " << (uint32_t)itTb->second.mcs << " bitmap " << itTb->second.rbBitmap.Count () << " rv " << rv << " TBLER " << tbStats.tbler << " corrupted " << itTb->second.corrupt);
             }
         }
       itTb++;
@@ -602,7 +615,7 @@ MmWaveSpectrumPhy::EndRxData ()
               traceParams.m_symStart = itTb->second.symStart;
               traceParams.m_numSym = itTb->second.numSym;
               traceParams.m_ccId = m_componentCarrierId;
-              traceParams.m_rbAssignedNum = static_cast<uint32_t> (itTb->second.rbBitmap.size ());
+              traceParams.m_rbAssignedNum = itTb->second.rbBitmap.Count ();
 
               if (enbRx)
                 {
@@ -744,8 +757,17 @@ MmWaveSpectrumPhy::EndRxCtrl ()
         }
     }
 
+  if (!m_phyRxDciEndOkCallback.IsNull ())
+    {
+      for (const auto & dciPerRnti : m_rxDciPerRntiList)
+        {
+          m_phyRxDciEndOkCallback (*dciPerRnti);
+        }
+    }
+
   m_state = IDLE;
   m_rxControlMessageList.clear ();
+  m_rxDciPerRntiList.clear ();
 }
 
 bool
@@ -771,7 +793,7 @@ MmWaveSpectrumPhy::StartTxDataFrames (Ptr<PacketBurst> pb, std::list<Ptr<MmWaveC
         txParams->psd = m_txPsd;
         txParams->packetBurst = pb;
         txParams->cellId = m_cellId;
-        txParams->ctrlMsgList = ctrlMsgList;
+        txParams->ctrlMsgList = std::move (ctrlMsgList);
         txParams->slotInd = slotInd;
         txParams->txAntenna = m_antenna;
 
@@ -827,7 +849,8 @@ MmWaveSpectrumPhy::StartTxDataFrames (Ptr<PacketBurst> pb, std::list<Ptr<MmWaveC
 }
 
 bool
-MmWaveSpectrumPhy::StartTxDlControlFrames (std::list<Ptr<MmWaveControlMessage> > ctrlMsgList, Time duration)
+MmWaveSpectrumPhy::StartTxDlControlFrames (std::list<Ptr<MmWaveControlMessage> > ctrlMsgList, Time duration,
+                                           const std::shared_ptr<const MmWaveDciPerRntiMap> &dciPerRnti)
 {
   NS_LOG_LOGIC (this << " state: " << m_state);
 
@@ -852,7 +875,8 @@ MmWaveSpectrumPhy::StartTxDlControlFrames (std::list<Ptr<MmWaveControlMessage> >
         txParams->psd = m_txPsd;
         txParams->cellId = m_cellId;
         txParams->pss = true;
-        txParams->ctrlMsgList = ctrlMsgList;
+        txParams->ctrlMsgList = std::move (ctrlMsgList);
+        txParams->dciPerRnti = dciPerRnti;
         txParams->txAntenna = m_antenna;
         m_channel->StartTx (txParams);
         Simulator::Schedule (duration, &MmWaveSpectrumPhy::EndTx, this);
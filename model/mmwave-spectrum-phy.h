@@ -57,7 +57,7 @@ struct ExpectedTbInfo_t
   uint8_t ndi;
   uint32_t size;
   uint8_t mcs;
-  std::vector<int> rbBitmap;
+  RbgBitmask rbBitmap;
   uint8_t harqProcessId;
   uint8_t rv;
   double mi;
@@ -72,7 +72,13 @@ struct ExpectedTbInfo_t
 typedef std::map<uint16_t, ExpectedTbInfo_t> ExpectedTbMap_t;
 
 typedef Callback< void, Ptr<Packet> > MmWavePhyRxDataEndOkCallback;
-typedef Callback< void, std::list<Ptr<MmWaveControlMessage> > > MmWavePhyRxCtrlEndOkCallback;
+typedef Callback< void, const std::list<Ptr<MmWaveControlMessage> > & > MmWavePhyRxCtrlEndOkCallback;
+
+/**
+ * This method is used by the MmWaveSpectrumPhy to notify the PHY about
+ * the DCI received in a DL control frame, indexed by RNTI
+ */
+typedef Callback< void, const MmWaveDciPerRntiMap & > MmWavePhyRxDciEndOkCallback;
 
 /**
  * This method is used by the LteSpectrumPhy to notify the PHY about
@@ -131,11 +137,19 @@ public:
 
   bool StartTxDataFrames (Ptr<PacketBurst> pb, std::list<Ptr<MmWaveControlMessage> > ctrlMsgList, Time duration, uint8_t slotInd);
 
-  bool StartTxDlControlFrames (std::list<Ptr<MmWaveControlMessage> > ctrlMsgList, Time duration);   // control frames from enb to ue
+  bool StartTxDlControlFrames (std::list<Ptr<MmWaveControlMessage> > ctrlMsgList, Time duration,
+                               const std::shared_ptr<const MmWaveDciPerRntiMap> &dciPerRnti = nullptr);   // control frames from enb to ue
   bool StartTxUlControlFrames (void);   // control frames from ue to enb
 
   void SetPhyRxDataEndOkCallback (MmWavePhyRxDataEndOkCallback c);
   void SetPhyRxCtrlEndOkCallback (MmWavePhyRxCtrlEndOkCallback c);
+  /**
+   * \brief Set the callback for the DCI received in a DL control frame
+   * \param c the callback
+   *
+   * If the callback is not set, the DCI indexed by RNTI are not delivered.
+   */
+  void SetPhyRxDciEndOkCallback (MmWavePhyRxDciEndOkCallback c);
   void SetPhyDlHarqFeedbackCallback (MmWavePhyDlHarqFeedbackCallback c);
   void SetPhyUlHarqFeedbackCallback (MmWavePhyUlHarqFeedbackCallback c);
 
@@ -144,7 +158,7 @@ public:
 
   void UpdateSinrPerceived (const SpectrumValue& sinr);
 
-  void AddExpectedTb (uint16_t rnti, uint8_t ndi, uint32_t size, uint8_t mcs, std::vector<int> map, uint8_t harqId,
+  void AddExpectedTb (uint16_t rnti, uint8_t ndi, uint32_t size, uint8_t mcs, const RbgBitmask &map, uint8_t harqId,
                       uint8_t rv, bool downlink, uint8_t symStart, uint8_t numSym);
   //	void AddExpectedTb (uint16_t rnti, uint16_t size, uint8_t m_mcs, std::vector<int> chunkMap, bool downlink);
 
@@ -168,6 +182,7 @@ private:
   //Ptr<PacketBurst> m_txPacketBurst;
   std::list<Ptr<PacketBurst> > m_rxPacketBurstList;
   std::list<Ptr<MmWaveControlMessage> > m_rxControlMessageList;
+  std::vector<std::shared_ptr<const MmWaveDciPerRntiMap> > m_rxDciPerRntiList; //!< DCI indexes of the control frames being received
 
   Time m_firstRxStart;
   Time m_firstRxDuration;
@@ -181,6 +196,7 @@ private:
   State m_state;
 
   MmWavePhyRxCtrlEndOkCallback    m_phyRxCtrlEndOkCallback;
+  MmWavePhyRxDciEndOkCallback     m_phyRxDciEndOkCallback; //!< Callback for the DCI indexed by RNTI
   MmWavePhyRxDataEndOkCallback                m_phyRxDataEndOkCallback;
 
   MmWavePhyDlHarqFeedbackCallback m_phyDlHarqFeedbackCallback;
@@ -111,6 +111,7 @@ MmWaveSpectrumSignalParametersDlCtrlFrame::MmWaveSpectrumSignalParametersDlCtrlF
   cellId = p.cellId;
   pss = p.pss;
   ctrlMsgList = p.ctrlMsgList;
+  dciPerRnti = p.dciPerRnti;
 }
 
 Ptr<SpectrumSignalParameters>
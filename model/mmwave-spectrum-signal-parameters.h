@@ -31,12 +31,26 @@
 
 
 #include <ns3/spectrum-signal-parameters.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
 
 namespace ns3 {
 
 class PacketBurst;
 class MmWaveControlMessage;
 
+/**
+ * \ingroup mmwave
+ * \brief The DCI of a slot, indexed by the RNTI of the UE they are addressed to
+ *
+ * The index is built once by the gNB PHY, and it is shared (read-only) by all
+ * the copies of the signal parameters that the channel creates for each
+ * receiver. In this way, each UE finds its DCI with a single lookup, without
+ * going through the DCI of all the other UEs of the cell.
+ */
+typedef std::unordered_map<uint16_t, std::list<Ptr<MmWaveControlMessage> > > MmWaveDciPerRntiMap;
+
 /**
  * \ingroup mmwave
  *
@@ -108,6 +122,7 @@ struct MmWaveSpectrumSignalParametersDlCtrlFrame : public SpectrumSignalParamete
 
 
   std::list<Ptr<MmWaveControlMessage> > ctrlMsgList;
+  std::shared_ptr<const MmWaveDciPerRntiMap> dciPerRnti; //!< DCI indexed by RNTI (can be nullptr)
 
   bool pss;
   uint16_t cellId;
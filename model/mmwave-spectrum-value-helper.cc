@@ -28,6 +28,7 @@
 
 
 #include <map>
+#include <algorithm>
 #include <cmath>
 #include <ns3/log.h>
 #include <ns3/fatal-error.h>
@@ -139,21 +140,23 @@ MmWaveSpectrumValueHelper::GetSpectrumModel (Ptr<MmWavePhyMacCommon> ptrConfig)
 }
 
 Ptr<SpectrumValue>
-MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (Ptr<MmWavePhyMacCommon> ptrConfig, double powerTx, std::vector <int> activeRbs)
+MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (Ptr<MmWavePhyMacCommon> ptrConfig, double powerTx, const RbgBitmask &activeRbs)
 {
   Ptr<SpectrumModel> model = GetSpectrumModel (ptrConfig);
   Ptr<SpectrumValue> txPsd = Create <SpectrumValue> (model);
 
+  NS_ASSERT (activeRbs.Size () <= model->GetNumBands ());
+
   double powerTxW = std::pow (10., (powerTx - 30) / 10);
 
   double txPowerDensity = 0;
   txPowerDensity = (powerTxW / (ptrConfig->GetBandwidth ()));
 
-  for (std::vector <int>::iterator it = activeRbs.begin (); it != activeRbs.end (); it++)
-    {
-      int rbId = (*it);
-      (*txPsd)[rbId] = txPowerDensity;
-    }
+  Values::iterator values = txPsd->ValuesBegin ();
+  activeRbs.ForEachRun ([values, txPowerDensity] (uint32_t start, uint32_t end)
+                        {
+                          std::fill (values + start, values + end, txPowerDensity);
+                        });
 
   NS_LOG_LOGIC (*txPsd);
 
@@ -170,6 +173,71 @@ MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (Ptr<MmWavePhyMacCommon>
 
 
 
+void
+MmWaveTxPsdFactory::Update (const Ptr<MmWavePhyMacCommon> &ptrConfig, double powerTx)
+{
+  NS_LOG_FUNCTION (this << powerTx);
+  m_model = MmWaveSpectrumValueHelper::GetSpectrumModel (ptrConfig);
+  m_centerFrequency = ptrConfig->GetCenterFrequency ();
+  m_numRb = ptrConfig->GetBandwidthInRbs ();
+  m_bandwidth = ptrConfig->GetBandwidth ();
+  m_powerTx = powerTx;
+  m_txPowerDensity = std::pow (10., (powerTx - 30) / 10) / m_bandwidth;
+  m_pool.clear ();
+}
+
+Ptr<SpectrumValue>
+MmWaveTxPsdFactory::GetFreeValue ()
+{
+  for (const auto & value : m_pool)
+    {
+      if (value->GetReferenceCount () == 1)
+        {
+          return value;
+        }
+    }
+
+  Ptr<SpectrumValue> value = ns3::Create<SpectrumValue> (m_model);
+  if (m_pool.size () < POOL_SIZE)
+    {
+      m_pool.push_back (value);
+    }
+  return value;
+}
+
+Ptr<SpectrumValue>
+MmWaveTxPsdFactory::Create (const Ptr<MmWavePhyMacCommon> &ptrConfig, double powerTx,
+                            const RbgBitmask &activeBits, uint32_t rbPerBit)
+{
+  if (m_model == nullptr || powerTx != m_powerTx
+      || ptrConfig->GetCenterFrequency () != m_centerFrequency
+      || ptrConfig->GetBandwidthInRbs () != m_numRb
+      || ptrConfig->GetBandwidth () != m_bandwidth)
+    {
+      Update (ptrConfig, powerTx);
+    }
+
+  NS_ASSERT (activeBits.Size () * rbPerBit <= m_numRb);
+
+  Ptr<SpectrumValue> txPsd = GetFreeValue ();
+
+  // Fill the inactive RB before each run with zeros, and the run with the density
+  Values::iterator values = txPsd->ValuesBegin ();
+  const double txPowerDensity = m_txPowerDensity;
+  uint32_t filled = 0;
+  activeBits.ForEachRun ([values, txPowerDensity, rbPerBit, &filled] (uint32_t start, uint32_t end)
+                         {
+                           std::fill (values + filled, values + start * rbPerBit, 0.0);
+                           std::fill (values + start * rbPerBit, values + end * rbPerBit, txPowerDensity);
+                           filled = end * rbPerBit;
+                         });
+  std::fill (values + filled, txPsd->ValuesEnd (), 0.0);
+
+  NS_LOG_LOGIC (*txPsd);
+
+  return txPsd;
+}
+
 Ptr<SpectrumValue>
 MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (Ptr<MmWavePhyMacCommon> ptrConfig, double noiseFigure)
 {
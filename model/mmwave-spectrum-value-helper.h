@@ -47,9 +47,16 @@ class MmWaveSpectrumValueHelper
 public:
   static Ptr<SpectrumModel> GetSpectrumModel (Ptr<MmWavePhyMacCommon> ptrConfig);
 
+  /**
+   * \brief Create the TX PSD
+   * \param ptrConfig configuration of the carrier
+   * \param powerTx total TX power, in dBm
+   * \param activeRbs bitmask (one bit per RB) of the RB in which there is a transmission
+   * \return the TX PSD, in W/Hz, with the power spread over the entire bandwidth
+   */
   static Ptr<SpectrumValue> CreateTxPowerSpectralDensity (Ptr<MmWavePhyMacCommon> ptrConfig,
                                                           double powerTx,
-                                                          std::vector <int> activeRbs);
+                                                          const RbgBitmask &activeRbs);
 
 
   static Ptr<SpectrumValue> CreateTxPowerSpectralDensity (Ptr<MmWavePhyMacCommon> ptrConfig,
@@ -66,6 +73,61 @@ private:
   //static Ptr<SpectrumModel> m_model;
 };
 
+/**
+ * \ingroup mmwave
+ *
+ * \brief Factory of the TX PSD of a carrier, for a given TX power
+ *
+ * The factory keeps the spectrum model and the power density (W/Hz) of the
+ * last carrier configuration and TX power, so that they are recomputed only
+ * when one of them changes. The PSD is filled one run of consecutive active
+ * RB (or RBG) at a time.
+ *
+ * The returned SpectrumValue are taken from a small pool: a value is reused
+ * only when the factory holds the last reference to it, i.e., when the
+ * spectrum PHY and the channel have released it. When all the values of the
+ * pool are in use, a new value is allocated outside the pool.
+ */
+class MmWaveTxPsdFactory
+{
+public:
+  static const uint32_t POOL_SIZE = 4; //!< Maximum number of values in the pool
+
+  /**
+   * \brief Create the TX PSD
+   * \param ptrConfig configuration of the carrier
+   * \param powerTx total TX power, in dBm
+   * \param activeBits bitmask of the RB (or RBG) in which there is a transmission
+   * \param rbPerBit number of RB of each bit of activeBits (1 for a RB bitmask,
+   * the number of RB per RBG for a RBG bitmask)
+   * \return the TX PSD, in W/Hz, with the power spread over the entire bandwidth
+   * \see MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity
+   */
+  Ptr<SpectrumValue> Create (const Ptr<MmWavePhyMacCommon> &ptrConfig, double powerTx,
+                             const RbgBitmask &activeBits, uint32_t rbPerBit = 1);
+
+private:
+  /**
+   * \brief Update the spectrum model and the power density, and empty the pool
+   * \param ptrConfig configuration of the carrier
+   * \param powerTx total TX power, in dBm
+   */
+  void Update (const Ptr<MmWavePhyMacCommon> &ptrConfig, double powerTx);
+
+  /**
+   * \return a value of the pool that is not referenced anymore, or a new one
+   */
+  Ptr<SpectrumValue> GetFreeValue ();
+
+  Ptr<SpectrumModel> m_model;           //!< Spectrum model of the carrier
+  double m_centerFrequency {0.0};       //!< Center frequency of m_model
+  uint32_t m_numRb {0};                 //!< Number of RB of m_model
+  double m_bandwidth {0.0};             //!< Bandwidth used to compute m_txPowerDensity
+  double m_powerTx {0.0};               //!< TX power (dBm) used to compute m_txPowerDensity
+  double m_txPowerDensity {0.0};        //!< Power density of the active RB, in W/Hz
+  std::vector<Ptr<SpectrumValue> > m_pool; //!< Values that can be reused
+};
+
 
 } // namespace ns3
 
@@ -45,6 +45,7 @@
 #include <algorithm>
 #include <ns3/simulator.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include "mmwave-ue-phy.h"
 #include "mmwave-ue-net-device.h"
 #include "mmwave-spectrum-value-helper.h"
@@ -104,6 +105,12 @@ MmWaveUePhy::GetTypeId (void)
                    MakeDoubleAccessor (&MmWavePhy::SetNoiseFigure,
                    &MmWavePhy::GetNoiseFigure),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("SubbandCqi",
+                   "If true, the DL CQI report contains the CQI of each RB "
+                   "(sub-band CQI) as well as the wideband CQI",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveUePhy::m_subbandCqi),
+                   MakeBooleanChecker ())
     .AddAttribute ("DlSpectrumPhy",
                    "The downlink MmWaveSpectrumPhy associated to this MmWavePhy",
                    TypeId::ATTR_GET,
@@ -139,7 +146,7 @@ MmWaveUePhy::DoInitialize (void)
   NS_LOG_FUNCTION (this);
 
   SfnSf sfnf = SfnSf (0, 0, 0, 0);
-  std::vector<uint8_t> rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), 1);
+  RbgBitmask rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), true);
 
 
   for (unsigned i = 0; i < m_phyMacConfig->GetSlotsPerSubframe (); i++)
@@ -211,11 +218,9 @@ MmWaveUePhy::GetNoiseFigure () const
 }
 
 Ptr<SpectrumValue>
-MmWaveUePhy::CreateTxPowerSpectralDensity (const std::vector<int> &rbIndexVector) const
+MmWaveUePhy::CreateTxPowerSpectralDensity (const RbgBitmask &rbBitmask) const
 {
-  Ptr<SpectrumValue> psd =
-    MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, m_txPower, rbIndexVector);
-  return psd;
+  return m_txPsdFactory.Create (m_phyMacConfig, m_txPower, rbBitmask);
 }
 
 void
@@ -239,9 +244,9 @@ MmWaveUePhy::GetSubChannelsForReception (void)
 }
 
 void
-MmWaveUePhy::SetSubChannelsForTransmission (std::vector <int> mask)
+MmWaveUePhy::SetSubChannelsForTransmission (const RbgBitmask &rbBitmask)
 {
-  Ptr<SpectrumValue> txPsd = CreateTxPowerSpectralDensity (mask);
+  Ptr<SpectrumValue> txPsd = CreateTxPowerSpectralDensity (rbBitmask);
   NS_ASSERT (txPsd);
   m_downlinkSpectrumPhy->SetTxPowerSpectralDensity (txPsd);
 }
@@ -289,7 +294,18 @@ MmWaveUePhy::GetUlSpectrumPhy () const
 }
 
 void
-MmWaveUePhy::ReceiveControlMessageList (std::list<Ptr<MmWaveControlMessage> > msgList)
+MmWaveUePhy::ReceiveDciPerRnti (const MmWaveDciPerRntiMap &dciPerRnti)
+{
+  NS_LOG_FUNCTION (this);
+  auto it = dciPerRnti.find (m_rnti);
+  if (it != dciPerRnti.end ())
+    {
+      ReceiveControlMessageList (it->second);
+    }
+}
+
+void
+MmWaveUePhy::ReceiveControlMessageList (const std::list<Ptr<MmWaveControlMessage> > &msgList)
 {
   NS_LOG_FUNCTION (this);
   bool dlUpdated = false;
@@ -359,7 +375,7 @@ MmWaveUePhy::ReceiveControlMessageList (std::list<Ptr<MmWaveControlMessage> > ms
                     }
                   else
                     {
-                      std::vector<uint8_t> rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), 1);
+                      RbgBitmask rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), true);
                       SlotAllocInfo slotAllocInfo = SlotAllocInfo (ulSfnSf);
                       DciInfoElementTdma dciDl (0, 1, rbgBitmask);
                       DciInfoElementTdma dciUl (m_phyMacConfig->GetSymbolsPerSlot () - 1, 1, rbgBitmask);
@@ -554,11 +570,7 @@ MmWaveUePhy::StartVarTti ()
     }
   else if (m_varTtiNum == m_currSlotAllocInfo.m_varTtiAllocInfo.size () - 1) // reserved UL control
     {
-      std::vector<int> channelRbs;
-      for (uint32_t i = 0; i < m_phyMacConfig->GetBandwidthInRbs (); i++)
-        {
-          channelRbs.push_back (static_cast<int> (i));
-        }
+      RbgBitmask channelRbs (m_phyMacConfig->GetBandwidthInRbs (), true);
 
       SetSubChannelsForTransmission (channelRbs);
       varTtiPeriod = m_phyMacConfig->GetSymbolPeriod () * m_phyMacConfig->GetUlCtrlSymbols ();
@@ -568,7 +580,7 @@ MmWaveUePhy::StartVarTti ()
                     (unsigned)currSlot.m_dci->m_symStart << "-" <<
                     (unsigned)(currSlot.m_dci->m_symStart + currSlot.m_dci->m_numSym - 1) <<
                     "\t start " << Simulator::Now () << " end " << (Simulator::Now () + varTtiPeriod - NanoSeconds (1.0)));
-      SendCtrlChannels (ctrlMsg, varTtiPeriod - NanoSeconds (1.0));
+      SendCtrlChannels (std::move (ctrlMsg), varTtiPeriod - NanoSeconds (1.0));
     }
   else if (currSlot.m_dci->m_format == DciInfoElementTdma::DL)    // scheduled DL data slot
     {
@@ -576,7 +588,7 @@ MmWaveUePhy::StartVarTti ()
       varTtiPeriod = m_phyMacConfig->GetSymbolPeriod () * currSlot.m_dci->m_numSym;
 
       m_downlinkSpectrumPhy->AddExpectedTb (currSlot.m_dci->m_rnti, currSlot.m_dci->m_ndi, currSlot.m_dci->m_tbSize, currSlot.m_dci->m_mcs,
-                                            FromRBGBitmaskToRBAssignment (currSlot.m_dci->m_rbgBitmask),
+                                            FromRBGBitmaskToRBBitmask (currSlot.m_dci->m_rbgBitmask),
                                             currSlot.m_dci->m_harqProcess, currSlot.m_dci->m_rv, true,
                                             currSlot.m_dci->m_symStart, currSlot.m_dci->m_numSym);
       m_reportDlTbSize (GetDevice ()->GetObject <MmWaveUeNetDevice> ()->GetImsi (), currSlot.m_dci->m_tbSize);
@@ -584,13 +596,13 @@ MmWaveUePhy::StartVarTti ()
                     " RXing DL DATA frame for"
                     " symbols "  << (unsigned)currSlot.m_dci->m_symStart <<
                     "-" << (unsigned)(currSlot.m_dci->m_symStart + currSlot.m_dci->m_numSym - 1) <<
-                    " num of rbg assigned: " << FromRBGBitmaskToRBAssignment (currSlot.m_dci->m_rbgBitmask).size () <<
+                    " num of rbg assigned: " << currSlot.m_dci->m_rbgBitmask.Count () <<
                     "\t start " << Simulator::Now () <<
                     " end " << (Simulator::Now () + varTtiPeriod));
     }
   else if (currSlot.m_dci->m_format == DciInfoElementTdma::UL)   // scheduled UL data slot
     {
-      SetSubChannelsForTransmission (FromRBGBitmaskToRBAssignment (currSlot.m_dci->m_rbgBitmask));
+      m_downlinkSpectrumPhy->SetTxPowerSpectralDensity (CreateTxPowerSpectralDensityFromRbg (currSlot.m_dci->m_rbgBitmask));
       varTtiPeriod = m_phyMacConfig->GetSymbolPeriod () * currSlot.m_dci->m_numSym;
       std::list<Ptr<MmWaveControlMessage> > ctrlMsg = GetControlMessages ();
       Ptr<PacketBurst> pktBurst = GetPacketBurst (SfnSf (m_frameNum, m_subframeNum, m_slotNum, currSlot.m_dci->m_symStart));
@@ -612,17 +624,8 @@ MmWaveUePhy::StartVarTti ()
           NS_LOG_DEBUG ("Send an empty PDU .... ");
           // sometimes the UE will be scheduled when no data is queued
           // in this case, send an empty PDU
-          MmWaveMacPduTag tag (SfnSf (m_frameNum, m_subframeNum, m_slotNum, currSlot.m_dci->m_symStart));
-          Ptr<Packet> emptyPdu = Create <Packet> ();
-          MmWaveMacPduHeader header;
-          MacSubheader subheader (3, 0);    // lcid = 3, size = 0
-          header.AddSubheader (subheader);
-          emptyPdu->AddHeader (header);
-          emptyPdu->AddPacketTag (tag);
-          LteRadioBearerTag bearerTag (m_rnti, 3, 0);
-          emptyPdu->AddPacketTag (bearerTag);
-          pktBurst = CreateObject<PacketBurst> ();
-          pktBurst->AddPacket (emptyPdu);
+          pktBurst = CreateEmptyPduBurst (SfnSf (m_frameNum, m_subframeNum, m_slotNum, currSlot.m_dci->m_symStart),
+                                          m_rnti);
         }
       m_reportUlTbSize (GetDevice ()->GetObject <MmWaveUeNetDevice> ()->GetImsi (), currSlot.m_dci->m_tbSize);
 
@@ -633,7 +636,7 @@ MmWaveUePhy::StartVarTti ()
                          << "\t start " << Simulator::Now () <<
                     " end " << (Simulator::Now () + varTtiPeriod));
 
-      Simulator::Schedule (NanoSeconds (1.0), &MmWaveUePhy::SendDataChannels, this, pktBurst, ctrlMsg, varTtiPeriod - NanoSeconds (2.0), m_varTtiNum);
+      Simulator::Schedule (NanoSeconds (1.0), &MmWaveUePhy::SendDataChannels, this, pktBurst, std::move (ctrlMsg), varTtiPeriod - NanoSeconds (2.0), m_varTtiNum);
     }
 
   Simulator::Schedule (varTtiPeriod, &MmWaveUePhy::EndVarTti, this);
@@ -654,7 +657,7 @@ MmWaveUePhy::EndVarTti ()
       if (!SlotExists (retVal))
         {
           // prepare the following slot info
-          std::vector<uint8_t> rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), 1);
+          RbgBitmask rbgBitmask (m_phyMacConfig->GetBandwidthInRbg (), true);
           SlotAllocInfo slotAllocInfo = SlotAllocInfo (retVal);
           VarTtiAllocInfo dlCtrlSlot (VarTtiAllocInfo::DL,
                                       VarTtiAllocInfo::CTRL,
@@ -720,13 +723,13 @@ MmWaveUePhy::SendDataChannels (Ptr<PacketBurst> pb, std::list<Ptr<MmWaveControlM
         }
     }
 
-  m_downlinkSpectrumPhy->StartTxDataFrames (pb, ctrlMsg, duration, slotInd);
+  m_downlinkSpectrumPhy->StartTxDataFrames (pb, std::move (ctrlMsg), duration, slotInd);
 }
 
 void
 MmWaveUePhy::SendCtrlChannels (std::list<Ptr<MmWaveControlMessage> > ctrlMsg, Time prd)
 {
-  m_downlinkSpectrumPhy->StartTxDlControlFrames (ctrlMsg,prd);
+  m_downlinkSpectrumPhy->StartTxDlControlFrames (std::move (ctrlMsg), prd);
 }
 
 
@@ -746,11 +749,22 @@ MmWaveUePhy::CreateDlCqiFeedbackMessage (const SpectrumValue& sinr)
   dlcqi.m_rnti = m_rnti;
   dlcqi.m_cqiType = DlCqiInfo::WB;
 
-  std::vector<int> cqi;
-
   uint8_t mcs;
   dlcqi.m_wbCqi = m_amc->CreateCqiFeedbackWbTdma (newSinr, m_currNumSym, m_currTbs, mcs);
 
+  if (m_subbandCqi)
+    {
+      // One CQI for each RB; an RB without signal (CQI -1) is reported as
+      // RB_CQI_NOT_MEASURED, to tell it apart from a CQI of 0
+      std::vector<int> cqi = m_amc->CreateCqiFeedbacksTdma (newSinr, m_currNumSym, 1);
+      dlcqi.m_cqiType = DlCqiInfo::SB;
+      dlcqi.m_rbCqi.resize (cqi.size ());
+      for (uint32_t rb = 0; rb < cqi.size (); ++rb)
+        {
+          dlcqi.m_rbCqi[rb] = cqi[rb] < 0 ? DlCqiInfo::RB_CQI_NOT_MEASURED : static_cast<uint8_t> (cqi[rb]);
+        }
+    }
+
   msg->SetDlCqi (dlcqi);
   return msg;
 }
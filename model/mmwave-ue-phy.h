@@ -72,14 +72,14 @@ public:
 
   bool SendPacket (Ptr<Packet> packet);
 
-  virtual Ptr<SpectrumValue> CreateTxPowerSpectralDensity (const std::vector<int> &rbIndexVector) const override;
+  virtual Ptr<SpectrumValue> CreateTxPowerSpectralDensity (const RbgBitmask &rbBitmask) const override;
 
   void DoSetSubChannels ();
 
   void SetSubChannelsForReception (std::vector <int> mask);
   std::vector <int> GetSubChannelsForReception (void);
 
-  void SetSubChannelsForTransmission (std::vector <int> mask);
+  void SetSubChannelsForTransmission (const RbgBitmask &rbBitmask);
   std::vector <int> GetSubChannelsForTransmission (void);
 
   void DoSendControlMessage (Ptr<MmWaveControlMessage> msg);
@@ -88,7 +88,16 @@ public:
   Ptr<MmWaveSpectrumPhy> GetDlSpectrumPhy () const;
   Ptr<MmWaveSpectrumPhy> GetUlSpectrumPhy () const;
 
-  void ReceiveControlMessageList (std::list<Ptr<MmWaveControlMessage> > msgList);
+  void ReceiveControlMessageList (const std::list<Ptr<MmWaveControlMessage> > &msgList);
+
+  /**
+   * \brief Receive the DCI of a DL control frame, indexed by RNTI
+   * \param dciPerRnti the DCI of all the UEs of the cell
+   *
+   * Only the DCI addressed to this UE are looked up, and they are processed
+   * as in ReceiveControlMessageList().
+   */
+  void ReceiveDciPerRnti (const MmWaveDciPerRntiMap &dciPerRnti);
 
   void SlotIndication (uint16_t frameNum, uint8_t subframeNum, uint16_t slotNum);
   void StartVarTti ();
@@ -121,7 +130,7 @@ public:
 
   void SetPhyMacConfig (Ptr<MmWavePhyMacCommon> config);
 
-  virtual AntennaArrayModel::BeamId GetBeamId (uint8_t rnti) const override
+  virtual AntennaArrayModel::BeamId GetBeamId (uint16_t rnti) const override
   {
     NS_UNUSED (rnti);
     NS_FATAL_ERROR ("ERROR");
@@ -163,6 +172,7 @@ private:
 
   Time m_wbCqiPeriod;       /**< Wideband Periodic CQI: 2, 5, 10, 16, 20, 32, 40, 64, 80 or 160 ms */
   Time m_wbCqiLast;
+  bool m_subbandCqi {false}; //!< If true, report the CQI of each RB along with the wideband CQI
 
   VarTtiAllocInfo::TddMode m_prevSlotDir;
 
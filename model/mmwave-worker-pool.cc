@@ -0,0 +1,121 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "mmwave-worker-pool.h"
+#include <algorithm>
+
+namespace ns3 {
+
+MmWaveWorkerPool::~MmWaveWorkerPool ()
+{
+  Stop ();
+}
+
+void
+MmWaveWorkerPool::SetNumWorkers (uint32_t n)
+{
+  n = std::max<uint32_t> (n, 1);
+  if (n == GetNumWorkers ())
+    {
+      return;
+    }
+  Stop ();
+  m_stop = false;
+  for (uint32_t i = 1; i < n; ++i)
+    {
+      m_threads.emplace_back (&MmWaveWorkerPool::ThreadLoop, this, m_generation);
+    }
+}
+
+void
+MmWaveWorkerPool::ParallelFor (size_t n, const std::function<void (size_t)> &f)
+{
+  if (m_threads.empty () || n <= 1)
+    {
+      for (size_t i = 0; i < n; ++i)
+        {
+          f (i);
+        }
+      return;
+    }
+
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_f = &f;
+    m_n = n;
+    m_next = 0;
+    m_busy = static_cast<uint32_t> (m_threads.size ());
+    ++m_generation;
+  }
+  m_startCv.notify_all ();
+
+  RunItems ();
+
+  std::unique_lock<std::mutex> lock (m_mutex);
+  m_doneCv.wait (lock, [this] { return m_busy == 0; });
+  m_f = nullptr;
+}
+
+void
+MmWaveWorkerPool::RunItems ()
+{
+  for (size_t i = m_next++; i < m_n; i = m_next++)
+    {
+      (*m_f) (i);
+    }
+}
+
+void
+MmWaveWorkerPool::ThreadLoop (uint64_t seen)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      m_startCv.wait (lock, [this, seen] { return m_stop || m_generation != seen; });
+      if (m_stop)
+        {
+          return;
+        }
+      seen = m_generation;
+      lock.unlock ();
+
+      RunItems ();
+
+      lock.lock ();
+      if (--m_busy == 0)
+        {
+          m_doneCv.notify_one ();
+        }
+    }
+}
+
+void
+MmWaveWorkerPool::Stop ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_startCv.notify_all ();
+  for (auto & t : m_threads)
+    {
+      t.join ();
+    }
+  m_threads.clear ();
+}
+
+} // namespace ns3
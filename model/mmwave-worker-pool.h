@@ -0,0 +1,110 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief A fixed set of threads that run the iterations of a loop
+ *
+ * ParallelFor() runs f(0) ... f(n-1) and returns when all of them are done.
+ * The calling thread takes part in the loop, so a pool with one worker (the
+ * default) has no threads and runs the loop in the caller, in order.
+ *
+ * The iterations run in any order and in any thread: they must not touch the
+ * simulator, the logging, or any Ptr shared with other iterations (the
+ * reference counts are not atomic). The usual pattern is to prepare the work
+ * in the simulator thread, to run only the computation in ParallelFor(), and
+ * to use the results in the simulator thread once it returns.
+ */
+class MmWaveWorkerPool
+{
+public:
+  /**
+   * \brief Create a pool with one worker (the caller)
+   */
+  MmWaveWorkerPool () = default;
+
+  /**
+   * \brief Stop and join the threads
+   */
+  ~MmWaveWorkerPool ();
+
+  MmWaveWorkerPool (const MmWaveWorkerPool &) = delete;
+  MmWaveWorkerPool & operator= (const MmWaveWorkerPool &) = delete;
+
+  /**
+   * \brief Set the number of workers
+   * \param n number of workers, including the calling thread (0 is taken as 1)
+   *
+   * It must not be called while ParallelFor() is running.
+   */
+  void SetNumWorkers (uint32_t n);
+
+  /**
+   * \return the number of workers, including the calling thread
+   */
+  uint32_t GetNumWorkers () const
+  {
+    return static_cast<uint32_t> (m_threads.size ()) + 1;
+  }
+
+  /**
+   * \brief Run f(i) for each i in [0, n), and wait for all of them
+   * \param n number of iterations
+   * \param f the body of the loop
+   */
+  void ParallelFor (size_t n, const std::function<void (size_t)> &f);
+
+private:
+  /**
+   * \brief Take iterations of the current loop until there are no more
+   */
+  void RunItems ();
+
+  /**
+   * \brief The body of the threads
+   * \param seen the number of loops started before the thread
+   */
+  void ThreadLoop (uint64_t seen);
+
+  /**
+   * \brief Stop and join the threads
+   */
+  void Stop ();
+
+  std::vector<std::thread> m_threads;               //!< The workers other than the caller
+  std::mutex m_mutex;                               //!< Protects the fields below, up to m_busy
+  std::condition_variable m_startCv;                //!< Signals a new loop, or the stop
+  std::condition_variable m_doneCv;                 //!< Signals that a thread finished its part of the loop
+  uint64_t m_generation {0};                        //!< Number of loops started
+  bool m_stop {false};                              //!< True when the threads have to exit
+  uint32_t m_busy {0};                              //!< Threads still working on the current loop
+  const std::function<void (size_t)> *m_f {nullptr}; //!< Body of the current loop
+  size_t m_n {0};                                   //!< Iterations of the current loop
+  std::atomic<size_t> m_next {0};                   //!< Next iteration to take
+};
+
+} // namespace ns3
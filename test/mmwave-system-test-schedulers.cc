@@ -361,13 +361,15 @@ MmWaveSystemTestSchedulingTestSuite::MmWaveSystemTestSchedulingTestSuite ()
   std::list<uint32_t>    beams       = {1, 2};
   std::list<uint32_t>    numerologies = {0, 1, 2, 3, 4};
 
-  // Three QUICK test cases
+  // Four QUICK test cases
   AddTestCase (new MmWaveSystemTestScheduling ("DL, num 0 Tdma RR 1 2", 1, 2, 0, 20e6, true, false,
                                                "ns3::MmWaveMacSchedulerTdmaRR"), TestCase::QUICK);
   AddTestCase (new MmWaveSystemTestScheduling ("DL_UL, num 0 Tdma RR 1 2", 1, 2, 0, 20e6, true, true,
                                                "ns3::MmWaveMacSchedulerTdmaRR"), TestCase::QUICK);
   AddTestCase (new MmWaveSystemTestScheduling ("UL, num 0 Tdma RR 1 2", 1, 2, 0, 20e6, false, true,
                                                "ns3::MmWaveMacSchedulerTdmaRR"), TestCase::QUICK);
+  AddTestCase (new MmWaveSystemTestScheduling ("DL, num 0 Ofdma SubbandPF 4 1", 4, 1, 0, 20e6, true, false,
+                                               "ns3::MmWaveMacSchedulerOfdmaSubbandPF"), TestCase::QUICK);
 
   for (const auto & num : numerologies)
     {
@@ -0,0 +1,238 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/mmwave-helper.h>
+#include <ns3/mmwave-point-to-point-epc-helper.h>
+#include <ns3/mmwave-3gpp-channel.h>
+#include <map>
+
+/**
+ * \file mmwave-test-3gpp-bulk-update.cc
+ * \ingroup test
+ * \brief Unit-testing the bulk update of MmWave3gppChannel.
+ */
+namespace ns3 {
+
+/**
+ * \brief Run a scenario with the bulk update of the 3GPP channel, with a UE
+ * that moves, and check:
+ *
+ * - that each bulk update fires LinksUpdated with the number of channels of
+ *   the static UEs that it updated, and that from the second one on, it
+ *   updates all of them;
+ * - that the channels of the moving UE are left to their next transmission;
+ * - that the channels, the long term components and the beamforming vectors
+ *   are the same with one worker and with numWorkers workers.
+ */
+class MmWave3gppBulkUpdateTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppBulkUpdateTestCase
+   * \param numWorkers number of workers of the second run
+   */
+  MmWave3gppBulkUpdateTestCase (uint32_t numWorkers)
+    : TestCase ("Bulk update of the 3GPP channel, 1 and " + std::to_string (numWorkers) + " workers"),
+      m_numWorkers (numWorkers)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief The values of the channels of a run, by nodes of the link
+   */
+  typedef std::map<std::pair<uint32_t, uint32_t>, std::vector<std::complex<double> > > Channels;
+
+  /**
+   * \brief Run the scenario
+   * \param numWorkers number of workers of the channel
+   * \param channels the channels at the end of the run
+   * \param linksUpdated the number of links of each bulk update
+   */
+  void RunScenario (uint32_t numWorkers, Channels *channels, std::vector<uint32_t> *linksUpdated);
+
+  /**
+   * \brief Sink of LinksUpdated: check the channels updated
+   * \param numLinks the number of links updated
+   */
+  void LinksUpdated (uint32_t numLinks);
+
+  uint32_t m_numWorkers {0};            //!< Number of workers of the second run
+  Ptr<MmWave3gppChannel> m_channel;     //!< Channel of the current run
+  Ptr<NetDevice> m_movingUe;            //!< Device of the moving UE
+  std::vector<uint32_t> *m_linksUpdated {nullptr}; //!< Links of each bulk update of the current run
+};
+
+void
+MmWave3gppBulkUpdateTestCase::LinksUpdated (uint32_t numLinks)
+{
+  uint32_t staticChannels = 0;
+  uint32_t staticUpdated = 0;
+  m_channel->ForEachChannel ([this, &staticChannels, &staticUpdated] (const Ptr<NetDevice> &tx, const Ptr<NetDevice> &rx,
+                                                                     const Ptr<const Params3gpp> &params)
+    {
+      if (tx == m_movingUe || rx == m_movingUe)
+        {
+          NS_TEST_EXPECT_MSG_NE (params->m_generatedTime, Simulator::Now (),
+                                 "A channel of the moving UE was updated by the bulk update");
+          return;
+        }
+      ++staticChannels;
+      if (params->m_generatedTime == Simulator::Now () && params->m_channel.size () > 0)
+        {
+          ++staticUpdated;
+        }
+    });
+
+  NS_TEST_EXPECT_MSG_EQ (numLinks, staticUpdated, "Wrong number of links updated at " << Simulator::Now ().GetSeconds ());
+  if (! m_linksUpdated->empty ())
+    {
+      // All the static links were created before the first bulk update
+      NS_TEST_EXPECT_MSG_EQ (numLinks, staticChannels, "Not all the static links updated at "
+                             << Simulator::Now ().GetSeconds ());
+    }
+  m_linksUpdated->push_back (numLinks);
+}
+
+void
+MmWave3gppBulkUpdateTestCase::RunScenario (uint32_t numWorkers, Channels *channels, std::vector<uint32_t> *linksUpdated)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::MmWave3gppChannel::UpdatePeriod", TimeValue (MilliSeconds (10)));
+  Config::SetDefault ("ns3::MmWave3gppChannel::BulkUpdate", BooleanValue (true));
+  Config::SetDefault ("ns3::MmWave3gppChannel::NumWorkers", UintegerValue (numWorkers));
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue ("UMi-StreetCanyon"));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::Numerology", UintegerValue (2));
+
+  Ptr<MmWaveHelper> mmWaveHelper = CreateObject<MmWaveHelper> ();
+  mmWaveHelper->SetAttribute ("PathlossModel", StringValue ("ns3::MmWave3gppPropagationLossModel"));
+  mmWaveHelper->SetAttribute ("ChannelModel", StringValue ("ns3::MmWave3gppChannel"));
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  mmWaveHelper->SetEpcHelper (epcHelper);
+  mmWaveHelper->Initialize ();
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  NodeContainer movingUeNodes;
+  gNbNodes.Create (2);
+  ueNodes.Create (4);
+  movingUeNodes.Create (1);
+
+  Ptr<ListPositionAllocator> gNbPositions = CreateObject<ListPositionAllocator> ();
+  gNbPositions->Add (Vector (0.0, 0.0, 10.0));
+  gNbPositions->Add (Vector (100.0, 0.0, 10.0));
+  Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator> ();
+  uePositions->Add (Vector (20.0, 10.0, 1.5));
+  uePositions->Add (Vector (30.0, -15.0, 1.5));
+  uePositions->Add (Vector (80.0, 20.0, 1.5));
+  uePositions->Add (Vector (120.0, -10.0, 1.5));
+  uePositions->Add (Vector (50.0, 30.0, 1.5));
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (gNbPositions);
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator (uePositions);
+  mobility.Install (ueNodes);
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (movingUeNodes);
+  movingUeNodes.Get (0)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (10.0, 0.0, 0.0));
+  ueNodes.Add (movingUeNodes);
+
+  NetDeviceContainer gNbDevs = mmWaveHelper->InstallEnbDevice (gNbNodes);
+  NetDeviceContainer ueDevs = mmWaveHelper->InstallUeDevice (ueNodes);
+  m_movingUe = ueDevs.Get (ueDevs.GetN () - 1);
+  m_channel = mmWaveHelper->Get3gppChannel (0);
+  m_linksUpdated = linksUpdated;
+  m_channel->TraceConnectWithoutContext ("LinksUpdated", MakeCallback (&MmWave3gppBulkUpdateTestCase::LinksUpdated, this));
+
+  mmWaveHelper->AttachToClosestEnb (ueDevs, gNbDevs);
+
+  Simulator::Stop (MilliSeconds (45));
+  Simulator::Run ();
+
+  // The nodes are numbered from the first gNB, as the IDs of the runs differ
+  const uint32_t firstId = gNbNodes.Get (0)->GetId ();
+  m_channel->ForEachChannel ([channels, firstId] (const Ptr<NetDevice> &tx, const Ptr<NetDevice> &rx,
+                                                  const Ptr<const Params3gpp> &params)
+    {
+      std::vector<std::complex<double> > &values = (*channels)[std::make_pair (tx->GetNode ()->GetId () - firstId,
+                                                                                rx->GetNode ()->GetId () - firstId)];
+      for (const auto & u : params->m_channel)
+        {
+          for (const auto & s : u)
+            {
+              values.insert (values.end (), s.begin (), s.end ());
+            }
+        }
+      values.insert (values.end (), params->m_longTerm.begin (), params->m_longTerm.end ());
+      values.insert (values.end (), params->m_txW.begin (), params->m_txW.end ());
+      values.insert (values.end (), params->m_rxW.begin (), params->m_rxW.end ());
+      values.push_back (params->m_generatedTime.GetSeconds ());
+    });
+
+  m_channel = nullptr;
+  m_movingUe = nullptr;
+  Simulator::Destroy ();
+}
+
+void
+MmWave3gppBulkUpdateTestCase::DoRun ()
+{
+  Channels reference;
+  std::vector<uint32_t> referenceLinks;
+  RunScenario (1, &reference, &referenceLinks);
+  NS_TEST_ASSERT_MSG_EQ (referenceLinks.size (), 4u, "Wrong number of bulk updates in 45 ms");
+  NS_TEST_ASSERT_MSG_GT (referenceLinks.back (), 0u, "No link updated");
+
+  Channels channels;
+  std::vector<uint32_t> links;
+  RunScenario (m_numWorkers, &channels, &links);
+  NS_TEST_ASSERT_MSG_EQ ((links == referenceLinks), true, "Different links updated with " << m_numWorkers << " workers");
+  NS_TEST_ASSERT_MSG_EQ (channels.size (), reference.size (), "Different number of channels");
+  for (const auto & channel : reference)
+    {
+      auto it = channels.find (channel.first);
+      NS_TEST_ASSERT_MSG_EQ ((it != channels.end ()), true, "Missing channel");
+      NS_TEST_ASSERT_MSG_EQ ((it->second == channel.second), true, "Different channel between nodes "
+                             << channel.first.first << " and " << channel.first.second);
+    }
+}
+
+/**
+ * \brief The bulk update test suite
+ */
+class MmWave3gppBulkUpdateTestSuite : public TestSuite
+{
+public:
+  MmWave3gppBulkUpdateTestSuite () : TestSuite ("mmwave-test-3gpp-bulk-update", SYSTEM)
+  {
+    AddTestCase (new MmWave3gppBulkUpdateTestCase (1), QUICK);
+    AddTestCase (new MmWave3gppBulkUpdateTestCase (4), QUICK);
+  }
+};
+
+static MmWave3gppBulkUpdateTestSuite mmwave3gppBulkUpdateTestSuite; //!< 3GPP channel bulk update test suite
+
+} // namespace ns3
@@ -0,0 +1,276 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-3gpp-link-table.h>
+#include <ns3/simulator.h>
+#include "mmwave-test-random.h"
+#include "mmwave-test-ue-device.h"
+#include <map>
+
+/**
+ * \file mmwave-test-3gpp-link-table.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWave3gppLinkTable class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Compare a MmWave3gppLinkTable against a std::map of the links, with
+ * links used at random, nodes that move, and periods in which some nodes are
+ * idle
+ */
+class MmWave3gppLinkTableTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppLinkTableTestCase
+   * \param horizon idle horizon of the table
+   */
+  MmWave3gppLinkTableTestCase (Time horizon)
+    : TestCase ("MmWave3gppLinkTable with idle horizon " + std::to_string (horizon.GetSeconds ()) + " s"),
+      m_horizon (horizon)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Use a random link, and check the table against the reference
+   * \param step number of the step
+   */
+  void Step (uint32_t step);
+
+  Time m_horizon;                                      //!< Idle horizon
+  std::vector<Ptr<MobilityModel> > m_mob;              //!< Mobility of the nodes
+  std::vector<bool> m_isUe;                            //!< True if the node is a UE
+  MmWave3gppLinkTable m_table;                         //!< The table under test
+  std::map<std::pair<uint32_t, uint32_t>, double> m_reference; //!< (UE, gNB) -> value stored in the link
+  std::map<std::pair<uint32_t, uint32_t>, Time> m_linkUse;     //!< Last use of the links
+  std::map<uint32_t, Time> m_nodeUse;                  //!< Last use of the nodes
+  Time m_lastEviction;                                 //!< Last eviction of the reference
+  Ptr<UniformRandomVariable> m_random;                 //!< Random numbers of the steps
+  double m_counter {0.0};                              //!< Value stored in the next new link
+};
+
+void
+MmWave3gppLinkTableTestCase::Step (uint32_t step)
+{
+  const Time now = Simulator::Now ();
+  const uint32_t numNodes = static_cast<uint32_t> (m_mob.size ());
+  const uint32_t a = m_random->GetInteger (0, numNodes - 1);
+  const uint32_t b = m_random->GetInteger (0, numNodes - 1);
+  const bool move = m_random->GetInteger (0, 3) == 0;
+  // In the odd periods only the first half of the nodes is used
+  if (a == b || ((step / 500) % 2 == 1 && (a >= numNodes / 2 || b >= numNodes / 2)))
+    {
+      return;
+    }
+  if (move)
+    {
+      Vector pos = m_mob[a]->GetPosition ();
+      pos.x += 1.0;
+      m_mob[a]->SetPosition (pos);
+      NS_TEST_ASSERT_MSG_EQ (m_table.IsLinkCurrent (m_mob[a], m_mob[b]), false, "The link of a node that moved is current");
+    }
+
+  if (m_horizon > Seconds (0) && now - m_lastEviction >= m_horizon)
+    {
+      m_lastEviction = now;
+      for (auto it = m_linkUse.begin (); it != m_linkUse.end (); )
+        {
+          if (now - it->second > m_horizon)
+            {
+              m_reference.erase (it->first);
+              it = m_linkUse.erase (it);
+            }
+          else
+            {
+              ++it;
+            }
+        }
+      for (auto it = m_nodeUse.begin (); it != m_nodeUse.end (); )
+        {
+          it = now - it->second > m_horizon ? m_nodeUse.erase (it) : std::next (it);
+        }
+    }
+  m_nodeUse[a] = now;
+  m_nodeUse[b] = now;
+
+  MmWave3gppLinkTable::Link link = m_table.GetLink (m_mob[a], m_mob[b]);
+  if (m_isUe[a] == m_isUe[b])
+    {
+      NS_TEST_ASSERT_MSG_EQ ((link.m_state == nullptr), true, "Link between nodes with the same role");
+      return;
+    }
+  NS_TEST_ASSERT_MSG_EQ ((link.m_state != nullptr), true, "Missing UE-gNB link");
+
+  const uint32_t ue = m_isUe[a] ? a : b;
+  const uint32_t gnb = m_isUe[a] ? b : a;
+  NS_TEST_ASSERT_MSG_EQ ((link.m_ue->m_mobility == m_mob[ue]), true, "Wrong UE of the link");
+  NS_TEST_ASSERT_MSG_EQ ((link.m_gnb->m_mobility == m_mob[gnb]), true, "Wrong gNB of the link");
+
+  const auto key = std::make_pair (ue, gnb);
+  m_linkUse[key] = now;
+  auto it = m_reference.find (key);
+  if (it == m_reference.end ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (link.m_state->m_valid, false, "A new link is already valid");
+      link.m_state->m_valid = true;
+      link.m_state->m_shadowing = ++m_counter;
+      m_reference[key] = m_counter;
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (link.m_state->m_shadowing, it->second, "Wrong state of the link in step " << step);
+    }
+
+  const Vector ueP = m_mob[ue]->GetPosition ();
+  const Vector gnbP = m_mob[gnb]->GetPosition ();
+  const double dx = ueP.x - gnbP.x;
+  const double dy = ueP.y - gnbP.y;
+  NS_TEST_ASSERT_MSG_EQ_TOL (link.m_state->m_distance2D, std::sqrt (dx * dx + dy * dy), 1e-9, "Wrong 2D distance");
+  NS_TEST_ASSERT_MSG_EQ_TOL (link.m_state->m_distance3D, m_mob[a]->GetDistanceFrom (m_mob[b]), 1e-9, "Wrong 3D distance");
+  NS_TEST_ASSERT_MSG_EQ ((m_table.FindLink (m_mob[b], m_mob[a]) == link.m_state), true, "FindLink does not find the link");
+  NS_TEST_ASSERT_MSG_EQ (m_table.IsLinkCurrent (m_mob[b], m_mob[a]), true, "The link just used is not current");
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetNumLinks (), m_reference.size (), "Wrong number of links in step " << step);
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetNumNodes (), m_nodeUse.size (), "Wrong number of nodes in step " << step);
+}
+
+void
+MmWave3gppLinkTableTestCase::DoRun ()
+{
+  m_table.SetIdleHorizon (m_horizon);
+  m_random = CreateTestRandomVariable (9);
+  for (uint32_t i = 0; i < 12; ++i)
+    {
+      const bool isUe = i % 3 != 0;
+      m_mob.push_back (CreateTestNode (isUe, Vector (10.0 * i, 20.0 * i, isUe ? 1.5 : 10.0)));
+      m_isUe.push_back (isUe);
+    }
+
+  for (uint32_t step = 0; step < 3000; ++step)
+    {
+      Simulator::Schedule (MilliSeconds (10 * step), &MmWave3gppLinkTableTestCase::Step, this, step);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Use the links of two UEs and a gNB at given times, with an idle
+ * horizon of 1 s, and check the links that are evicted and the distances
+ * after a move
+ */
+class MmWave3gppLinkTableEvictionTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppLinkTableEvictionTestCase
+   */
+  MmWave3gppLinkTableEvictionTestCase ()
+    : TestCase ("MmWave3gppLinkTable eviction of the idle links")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Use the link of a UE
+   * \param ue index of the UE
+   * \param expectNew whether the link has to be new
+   * \param expectedLinks number of links in the table after the use
+   */
+  void Use (uint32_t ue, bool expectNew, uint32_t expectedLinks);
+
+  MmWave3gppLinkTable m_table;           //!< The table under test
+  Ptr<MobilityModel> m_gnb;              //!< Mobility of the gNB
+  std::vector<Ptr<MobilityModel> > m_ue; //!< Mobility of the UEs
+};
+
+void
+MmWave3gppLinkTableEvictionTestCase::Use (uint32_t ue, bool expectNew, uint32_t expectedLinks)
+{
+  MmWave3gppLinkTable::Link link = m_table.GetLink (m_ue[ue], m_gnb);
+  NS_TEST_ASSERT_MSG_EQ ((link.m_state != nullptr), true, "Missing link of UE " << ue);
+  NS_TEST_ASSERT_MSG_EQ (link.m_state->m_valid, ! expectNew, "Wrong validity of the link of UE " << ue
+                         << " at " << Simulator::Now ().GetSeconds ());
+  link.m_state->m_valid = true;
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetNumLinks (), expectedLinks, "Wrong number of links at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+MmWave3gppLinkTableEvictionTestCase::DoRun ()
+{
+  m_table.SetIdleHorizon (Seconds (1));
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      if (i == 0)
+        {
+          m_gnb = CreateTestNode (false, Vector (0.0, 0.0, 10.0));
+        }
+      else
+        {
+          m_ue.push_back (CreateTestNode (true, Vector (30.0 * i, 40.0 * i, 1.5)));
+        }
+    }
+
+  Simulator::Schedule (Seconds (0.0), &MmWave3gppLinkTableEvictionTestCase::Use, this, 0, true, 1);
+  Simulator::Schedule (Seconds (0.5), &MmWave3gppLinkTableEvictionTestCase::Use, this, 1, true, 2);
+  // The link of the first UE is idle for more than 1 s: it is evicted
+  Simulator::Schedule (Seconds (1.2), &MmWave3gppLinkTableEvictionTestCase::Use, this, 1, false, 1);
+  Simulator::Schedule (Seconds (1.3), &MmWave3gppLinkTableEvictionTestCase::Use, this, 0, true, 2);
+  Simulator::Stop (Seconds (1.4));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetNumNodes (), 3u, "Wrong number of nodes");
+  NS_TEST_ASSERT_MSG_EQ (m_table.IsLinkCurrent (m_ue[1], m_gnb), true, "The link of a static UE is not current");
+
+  // The second UE moves from (60, 80) to (30, 40): the distances change
+  m_ue[1]->SetPosition (Vector (30.0, 40.0, 1.5));
+  NS_TEST_ASSERT_MSG_EQ (m_table.IsLinkCurrent (m_ue[1], m_gnb), false, "The link of a UE that moved is current");
+  MmWave3gppLinkTable::Link link = m_table.GetLink (m_gnb, m_ue[1]);
+  NS_TEST_ASSERT_MSG_EQ (link.m_state->m_valid, true, "The link of a UE that moved is new");
+  NS_TEST_ASSERT_MSG_EQ_TOL (link.m_state->m_distance2D, 50.0, 1e-9, "Wrong 2D distance after the move");
+  NS_TEST_ASSERT_MSG_EQ_TOL (link.m_state->m_distance3D, std::sqrt (2500.0 + 8.5 * 8.5), 1e-9,
+                             "Wrong 3D distance after the move");
+  NS_TEST_ASSERT_MSG_EQ ((link.m_ue->m_mobility == m_ue[1]), true, "Wrong UE of the link");
+
+  m_gnb = nullptr;
+  m_ue.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief The MmWave3gppLinkTable test suite
+ */
+class MmWave3gppLinkTableTestSuite : public TestSuite
+{
+public:
+  MmWave3gppLinkTableTestSuite () : TestSuite ("mmwave-test-3gpp-link-table", UNIT)
+  {
+    AddTestCase (new MmWave3gppLinkTableEvictionTestCase (), QUICK);
+    AddTestCase (new MmWave3gppLinkTableTestCase (Seconds (0)), QUICK);
+    AddTestCase (new MmWave3gppLinkTableTestCase (Seconds (2)), QUICK);
+  }
+};
+
+static MmWave3gppLinkTableTestSuite mmwave3gppLinkTableTestSuite; //!< 3GPP link table test suite
+
+} // namespace ns3
@@ -0,0 +1,424 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-3gpp-params-table.h>
+#include "mmwave-test-random.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+/**
+ * \file mmwave-test-3gpp-params-table.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWave3gppParamsTableStore class.
+ */
+namespace ns3 {
+
+/**
+ * \param a a table
+ * \param b another table
+ * \return true if all the fields of the tables are the same
+ */
+static bool
+SameTable (const ParamsTable &a, const ParamsTable &b)
+{
+  bool same = a.m_numOfCluster == b.m_numOfCluster && a.m_raysPerCluster == b.m_raysPerCluster
+    && a.m_uLgDS == b.m_uLgDS && a.m_sigLgDS == b.m_sigLgDS && a.m_uLgASD == b.m_uLgASD
+    && a.m_sigLgASD == b.m_sigLgASD && a.m_uLgASA == b.m_uLgASA && a.m_sigLgASA == b.m_sigLgASA
+    && a.m_uLgZSA == b.m_uLgZSA && a.m_sigLgZSA == b.m_sigLgZSA && a.m_uLgZSD == b.m_uLgZSD
+    && a.m_sigLgZSD == b.m_sigLgZSD && a.m_offsetZOD == b.m_offsetZOD && a.m_cDS == b.m_cDS
+    && a.m_cASD == b.m_cASD && a.m_cASA == b.m_cASA && a.m_cZSA == b.m_cZSA && a.m_uK == b.m_uK
+    && a.m_sigK == b.m_sigK && a.m_rTau == b.m_rTau && a.m_shadowingStd == b.m_shadowingStd;
+  for (uint32_t row = 0; row < 7; ++row)
+    {
+      for (uint32_t column = 0; column < 7; ++column)
+        {
+          same = same && a.m_sqrtC[row][column] == b.m_sqrtC[row][column];
+        }
+    }
+  return same;
+}
+
+/**
+ * \brief The inputs of a table
+ */
+struct TableInputs
+{
+  bool m_los;          //!< LOS condition
+  bool m_o2i;          //!< O2I condition
+  double m_hBS;        //!< BS height
+  double m_hUT;        //!< UT height
+  double m_distance2D; //!< 2D distance
+};
+
+/**
+ * \param scenario the scenario
+ * \param num the number of inputs
+ * \param stream the stream of the random inputs
+ * \return random inputs of tables of the scenario, with repetitions
+ */
+static std::vector<TableInputs>
+RandomInputs (const std::string &scenario, uint32_t num, int64_t stream)
+{
+  Ptr<UniformRandomVariable> randomVariable = CreateTestRandomVariable (stream);
+  auto random = [randomVariable] (double max)
+    {
+      return randomVariable->GetValue (0.0, max);
+    };
+  const bool indoor = scenario.compare (0, 3, "InH") == 0;
+  std::vector<TableInputs> inputs;
+  for (uint32_t i = 0; i < num; ++i)
+    {
+      if (i > 0 && random (1.0) < 0.3)
+        {
+          // A link seen again, as at each update of a static link
+          inputs.push_back (inputs[randomVariable->GetInteger (0, static_cast<uint32_t> (inputs.size () - 1))]);
+          continue;
+        }
+      TableInputs in;
+      in.m_los = random (1.0) < 0.5;
+      in.m_o2i = ! indoor && random (1.0) < 0.3;
+      in.m_hBS = indoor ? 3.0 : 10.0 + random (25.0);
+      in.m_hUT = 1.5 + random (20.0);
+      in.m_distance2D = 1.0 + random (2000.0);
+      inputs.push_back (in);
+    }
+  return inputs;
+}
+
+/**
+ * \param scenario the scenario
+ * \param fcGHz the carrier frequency in GHz
+ * \param in the inputs of the table
+ * \param resolution the resolution of the heights and the distance, or 0
+ * \return the table computed without the store, with the heights and the
+ * distance rounded as the store does
+ */
+static ParamsTable
+ExpectedTable (const std::string &scenario, double fcGHz, const TableInputs &in, double resolution)
+{
+  if (resolution == 0.0)
+    {
+      return MmWave3gppParamsTableStore::Compute (scenario, fcGHz, in.m_los, in.m_o2i,
+                                                  in.m_hBS, in.m_hUT, in.m_distance2D);
+    }
+  return MmWave3gppParamsTableStore::Compute (scenario, fcGHz, in.m_los, in.m_o2i,
+                                              MmWave3gppParamsTableStore::Quantize (in.m_hBS, resolution),
+                                              MmWave3gppParamsTableStore::Quantize (in.m_hUT, resolution),
+                                              MmWave3gppParamsTableStore::Quantize (in.m_distance2D, resolution));
+}
+
+/**
+ * \brief Check that the tables from MmWave3gppParamsTableStore are the ones
+ * computed without it, for random links of a scenario, and that the store
+ * keeps one table per set of inputs that the table depends on, with the
+ * heights and the distance rounded to the resolution. Without a resolution,
+ * the tables that depend on the link are not stored.
+ */
+class MmWave3gppParamsTableTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppParamsTableTestCase
+   * \param scenario the scenario
+   * \param dependsOnLink true if the tables depend on the heights or the distance
+   * \param resolution the resolution of the heights and the distance, or 0
+   */
+  MmWave3gppParamsTableTestCase (const std::string &scenario, bool dependsOnLink, double resolution)
+    : TestCase ("ParamsTable store, scenario " + scenario + ", resolution " + std::to_string (resolution)),
+      m_scenario (scenario),
+      m_dependsOnLink (dependsOnLink),
+      m_resolution (resolution)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  std::string m_scenario;        //!< Scenario
+  bool m_dependsOnLink {false};  //!< True if the tables depend on the heights or the distance
+  double m_resolution {0.0};     //!< Resolution of the heights and the distance
+};
+
+void
+MmWave3gppParamsTableTestCase::DoRun ()
+{
+  MmWave3gppParamsTableStore::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (MmWave3gppParamsTableStore::GetSize (), 0u, "The store is not empty");
+
+  const std::vector<TableInputs> inputs = RandomInputs (m_scenario, 500, 3);
+  for (const double fcGHz : {3.5, 28.0})
+    {
+      for (const auto & in : inputs)
+        {
+          const ParamsTable expected = ExpectedTable (m_scenario, fcGHz, in, m_resolution);
+          // Once to fill the store, once from it
+          for (uint32_t i = 0; i < 2; ++i)
+            {
+              const ParamsTable table = MmWave3gppParamsTableStore::Get (m_scenario, fcGHz, in.m_los, in.m_o2i,
+                                                                         in.m_hBS, in.m_hUT, in.m_distance2D,
+                                                                         m_resolution);
+              NS_TEST_ASSERT_MSG_EQ (SameTable (table, expected), true,
+                                     "Wrong table at " << fcGHz << " GHz, LOS " << in.m_los << ", O2I " << in.m_o2i
+                                     << ", distance " << in.m_distance2D);
+            }
+          if (m_resolution > 0.0)
+            {
+              // The rounded distance is at most half the resolution away
+              // (one resolution below it)
+              NS_TEST_ASSERT_MSG_LT_OR_EQ (std::abs (MmWave3gppParamsTableStore::Quantize (in.m_distance2D, m_resolution)
+                                                     - in.m_distance2D),
+                                           std::max (m_resolution / 2, m_resolution - in.m_distance2D) + 1e-9,
+                                           "Wrong rounding of distance " << in.m_distance2D);
+            }
+        }
+    }
+
+  // One table per condition and frequency if the tables do not depend on
+  // the link (or are not stored without a resolution), at most one per
+  // distinct link and frequency otherwise
+  const uint32_t size = MmWave3gppParamsTableStore::GetSize ();
+  if (m_dependsOnLink && m_resolution > 0.0)
+    {
+      NS_TEST_ASSERT_MSG_GT (size, 8u, "Too few tables in the store");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (size, 2 * inputs.size (), "Too many tables in the store");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (size, 4u, "Too many tables in the store");
+    }
+
+  MmWave3gppParamsTableStore::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (MmWave3gppParamsTableStore::GetSize (), 0u, "The store was not cleared");
+}
+
+/**
+ * \brief Check some values of the tables from MmWave3gppParamsTableStore
+ * against the ones of 3GPP TR 38.901 Table 7.5-6
+ */
+class MmWave3gppParamsTableValuesTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppParamsTableValuesTestCase
+   */
+  MmWave3gppParamsTableValuesTestCase ()
+    : TestCase ("ParamsTable store, values of TR 38.901")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+MmWave3gppParamsTableValuesTestCase::DoRun ()
+{
+  MmWave3gppParamsTableStore::Clear ();
+  const double fcGHz = 28.0;
+
+  ParamsTable table = MmWave3gppParamsTableStore::Get ("RMa", fcGHz, true, false, 35.0, 1.5, 500.0);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_numOfCluster), 11u, "Wrong number of clusters, RMa LOS");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_raysPerCluster), 20u, "Wrong number of rays, RMa LOS");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table.m_uLgDS, -7.49, 1e-12, "Wrong lgDS, RMa LOS");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table.m_rTau, 3.8, 1e-12, "Wrong delay scaling, RMa LOS");
+
+  table = MmWave3gppParamsTableStore::Get ("UMa", fcGHz, true, false, 25.0, 1.5, 1000.0);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_numOfCluster), 12u, "Wrong number of clusters, UMa LOS");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table.m_uLgDS, -6.955 - 0.0963 * log10 (fcGHz), 1e-12, "Wrong lgDS, UMa LOS");
+  // -2.1 * 1000 / 1000 + 0.75 is below the floor of -0.5
+  NS_TEST_ASSERT_MSG_EQ_TOL (table.m_uLgZSD, -0.5, 1e-12, "Wrong lgZSD, UMa LOS");
+
+  table = MmWave3gppParamsTableStore::Get ("UMa", fcGHz, false, false, 25.0, 1.5, 100.0);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_numOfCluster), 20u, "Wrong number of clusters, UMa NLOS");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table.m_uLgZSD, -2.1 * 0.1 + 0.9, 1e-12, "Wrong lgZSD, UMa NLOS");
+
+  table = MmWave3gppParamsTableStore::Get ("UMa", fcGHz, false, true, 25.0, 1.5, 100.0);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_numOfCluster), 12u, "Wrong number of clusters, UMa O2I");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table.m_cDS, 11e-9, 1e-21, "Wrong cluster DS, UMa O2I");
+
+  table = MmWave3gppParamsTableStore::Get ("UMi-StreetCanyon", fcGHz, false, false, 10.0, 1.5, 100.0);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_numOfCluster), 19u, "Wrong number of clusters, UMi NLOS");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table.m_uLgDS, -0.24 * log10 (1 + fcGHz) - 6.83, 1e-12, "Wrong lgDS, UMi NLOS");
+
+  table = MmWave3gppParamsTableStore::Get ("InH-OfficeMixed", fcGHz, true, false, 3.0, 1.0, 10.0);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_numOfCluster), 8u, "Wrong number of clusters, InH LOS");
+  table = MmWave3gppParamsTableStore::Get ("InH-OfficeMixed", fcGHz, false, false, 3.0, 1.0, 10.0);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (table.m_numOfCluster), 10u, "Wrong number of clusters, InH NLOS");
+
+  MmWave3gppParamsTableStore::Clear ();
+}
+
+/**
+ * \brief Fill the store beyond MAX_SIZE tables, and check that the tables
+ * are removed one at a time, and that they are still the ones computed
+ * without the store
+ */
+class MmWave3gppParamsTableEvictionTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppParamsTableEvictionTestCase
+   */
+  MmWave3gppParamsTableEvictionTestCase ()
+    : TestCase ("ParamsTable store, removal of the tables beyond MAX_SIZE")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+MmWave3gppParamsTableEvictionTestCase::DoRun ()
+{
+  MmWave3gppParamsTableStore::Clear ();
+  const double fcGHz = 28.0;
+  const uint32_t extra = 100;
+  const double resolution = 0.01;
+  // A UMi table per distance: each one has its own key
+  for (uint32_t i = 0; i < MmWave3gppParamsTableStore::MAX_SIZE + extra; ++i)
+    {
+      const TableInputs in = {false, false, 10.0, 1.5, 10.0 + resolution * i};
+      const ParamsTable table = MmWave3gppParamsTableStore::Get ("UMi-StreetCanyon", fcGHz, in.m_los, in.m_o2i,
+                                                                 in.m_hBS, in.m_hUT, in.m_distance2D, resolution);
+      if (i >= MmWave3gppParamsTableStore::MAX_SIZE - extra)
+        {
+          const ParamsTable expected = ExpectedTable ("UMi-StreetCanyon", fcGHz, in, resolution);
+          NS_TEST_ASSERT_MSG_EQ (SameTable (table, expected), true, "Wrong table at distance " << in.m_distance2D);
+        }
+      NS_TEST_ASSERT_MSG_EQ (MmWave3gppParamsTableStore::GetSize (),
+                             std::min (i + 1, MmWave3gppParamsTableStore::MAX_SIZE),
+                             "Wrong number of tables after " << i + 1 << " links");
+    }
+
+  // A table taken from the store again is not added
+  MmWave3gppParamsTableStore::Get ("UMi-StreetCanyon", fcGHz, false, false, 10.0, 1.5,
+                                   10.0 + resolution * MmWave3gppParamsTableStore::MAX_SIZE, resolution);
+  NS_TEST_ASSERT_MSG_EQ (MmWave3gppParamsTableStore::GetSize (), MmWave3gppParamsTableStore::MAX_SIZE,
+                         "Wrong number of tables");
+
+  MmWave3gppParamsTableStore::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (MmWave3gppParamsTableStore::GetSize (), 0u, "The store was not cleared");
+}
+
+/**
+ * \brief Get the tables of random links of several scenarios from several
+ * threads at the same time, and check them against the ones computed
+ * without the store
+ */
+class MmWave3gppParamsTableThreadsTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppParamsTableThreadsTestCase
+   * \param numThreads number of threads
+   */
+  MmWave3gppParamsTableThreadsTestCase (uint32_t numThreads)
+    : TestCase ("ParamsTable store with " + std::to_string (numThreads) + " threads"),
+      m_numThreads (numThreads)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numThreads {0}; //!< Number of threads
+};
+
+void
+MmWave3gppParamsTableThreadsTestCase::DoRun ()
+{
+  const std::vector<std::string> scenarios = {"RMa", "UMa", "UMi-StreetCanyon", "InH-OfficeMixed"};
+  const double resolution = 0.5;
+  std::vector<std::vector<TableInputs> > inputs;
+  std::vector<std::vector<ParamsTable> > expected;
+  for (uint32_t s = 0; s < scenarios.size (); ++s)
+    {
+      inputs.push_back (RandomInputs (scenarios[s], 200, 17 + s));
+      expected.push_back (std::vector<ParamsTable> ());
+      for (const auto & in : inputs.back ())
+        {
+          expected.back ().push_back (ExpectedTable (scenarios[s], 28.0, in, resolution));
+        }
+    }
+
+  MmWave3gppParamsTableStore::Clear ();
+  std::atomic<uint32_t> errors (0);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < m_numThreads; ++t)
+    {
+      threads.push_back (std::thread ([&scenarios, &inputs, &expected, &errors, resolution, t] ()
+        {
+          for (uint32_t round = 0; round < 5; ++round)
+            {
+              // Each thread goes through the scenarios in a different order
+              for (uint32_t k = 0; k < scenarios.size (); ++k)
+                {
+                  const uint32_t s = (k + t) % scenarios.size ();
+                  for (uint32_t i = 0; i < inputs[s].size (); ++i)
+                    {
+                      const TableInputs &in = inputs[s][i];
+                      const ParamsTable table = MmWave3gppParamsTableStore::Get (scenarios[s], 28.0, in.m_los, in.m_o2i,
+                                                                                 in.m_hBS, in.m_hUT, in.m_distance2D,
+                                                                                 resolution);
+                      if (! SameTable (table, expected[s][i]))
+                        {
+                          ++errors;
+                        }
+                    }
+                }
+            }
+        }));
+    }
+  for (auto & thread : threads)
+    {
+      thread.join ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (errors.load (), 0u, "Wrong tables from the store");
+  MmWave3gppParamsTableStore::Clear ();
+}
+
+/**
+ * \brief The ParamsTable store test suite
+ */
+class MmWave3gppParamsTableTestSuite : public TestSuite
+{
+public:
+  MmWave3gppParamsTableTestSuite () : TestSuite ("mmwave-test-3gpp-params-table", UNIT)
+  {
+    AddTestCase (new MmWave3gppParamsTableValuesTestCase (), QUICK);
+    for (const double resolution : {0.0, 1.0})
+      {
+        AddTestCase (new MmWave3gppParamsTableTestCase ("RMa", true, resolution), QUICK);
+        AddTestCase (new MmWave3gppParamsTableTestCase ("UMa", true, resolution), QUICK);
+        AddTestCase (new MmWave3gppParamsTableTestCase ("UMi-StreetCanyon", true, resolution), QUICK);
+      }
+    AddTestCase (new MmWave3gppParamsTableTestCase ("InH-OfficeMixed", false, 0.0), QUICK);
+    AddTestCase (new MmWave3gppParamsTableTestCase ("InH-ShoppingMall", false, 0.0), QUICK);
+    AddTestCase (new MmWave3gppParamsTableEvictionTestCase (), QUICK);
+    AddTestCase (new MmWave3gppParamsTableThreadsTestCase (1), QUICK);
+    AddTestCase (new MmWave3gppParamsTableThreadsTestCase (4), QUICK);
+  }
+};
+
+static MmWave3gppParamsTableTestSuite mmwave3gppParamsTableTestSuite; //!< ParamsTable store test suite
+
+} // namespace ns3
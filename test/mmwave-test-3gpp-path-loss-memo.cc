@@ -0,0 +1,196 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-3gpp-propagation-loss-model.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/string.h>
+#include <ns3/uinteger.h>
+#include "mmwave-test-random.h"
+#include "mmwave-test-ue-device.h"
+#include <map>
+#include <set>
+
+/**
+ * \file mmwave-test-3gpp-path-loss-memo.cc
+ * \ingroup test
+ * \brief Unit-testing the path loss memo of MmWave3gppPropagationLossModel.
+ */
+namespace ns3 {
+
+/**
+ * \brief Compare the path loss of a MmWave3gppPropagationLossModel with the
+ * memo against one without it, while some of the UEs move, and check the
+ * hit and miss counters
+ */
+class MmWave3gppPathLossMemoTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWave3gppPathLossMemoTestCase
+   * \param scenario the 3GPP scenario
+   * \param gnbHeight height of the gNBs
+   * \param condition the channel condition ('l' or 'n')
+   */
+  MmWave3gppPathLossMemoTestCase (const std::string &scenario, double gnbHeight, const std::string &condition)
+    : TestCase ("Path loss memo in " + scenario + " with condition " + condition),
+      m_scenario (scenario),
+      m_gnbHeight (gnbHeight),
+      m_condition (condition)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Create a path loss model for the test
+   * \param memo true to enable the memo
+   * \return the model
+   */
+  Ptr<MmWave3gppPropagationLossModel> CreateModel (bool memo) const;
+
+  std::string m_scenario;  //!< Scenario
+  double m_gnbHeight {0};  //!< Height of the gNBs
+  std::string m_condition; //!< Channel condition
+};
+
+Ptr<MmWave3gppPropagationLossModel>
+MmWave3gppPathLossMemoTestCase::CreateModel (bool memo) const
+{
+  Ptr<MmWave3gppPropagationLossModel> model = CreateObject<MmWave3gppPropagationLossModel> ();
+  model->SetAttribute ("Scenario", StringValue (m_scenario));
+  model->SetAttribute ("ChannelCondition", StringValue (m_condition));
+  // The shadowing is random, and the two models use different streams
+  model->SetAttribute ("Shadowing", BooleanValue (false));
+  model->SetAttribute ("PathLossMemo", BooleanValue (memo));
+  return model;
+}
+
+void
+MmWave3gppPathLossMemoTestCase::DoRun ()
+{
+  std::vector<Ptr<MobilityModel> > gnbs;
+  std::vector<Ptr<MobilityModel> > ues;
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      const bool isUe = i >= 2;
+      Ptr<MobilityModel> mob = CreateTestNode (isUe, isUe ? Vector (15.0 + 7.0 * i, 10.0 * i, 1.5)
+                                                          : Vector (0.0, 60.0 * i, m_gnbHeight));
+      (isUe ? ues : gnbs).push_back (mob);
+    }
+
+  Ptr<MmWave3gppPropagationLossModel> withMemo = CreateModel (true);
+  Ptr<MmWave3gppPropagationLossModel> withoutMemo = CreateModel (false);
+
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (17);
+  std::map<std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> >, double> lastLoss;
+  uint64_t calls = 0;
+  for (uint32_t round = 0; round < 50; ++round)
+    {
+      // Only some UEs move, away from the gNBs
+      std::set<Ptr<MobilityModel> > moved;
+      for (const auto & ue : ues)
+        {
+          if (random->GetInteger (0, 3) == 0)
+            {
+              Vector pos = ue->GetPosition ();
+              pos.x += 0.5 + random->GetInteger (0, 4);
+              ue->SetPosition (pos);
+              moved.insert (ue);
+            }
+        }
+      for (const auto & ue : ues)
+        {
+          for (const auto & gnb : gnbs)
+            {
+              const double expected = withoutMemo->GetLoss (gnb, ue);
+              NS_TEST_ASSERT_MSG_EQ_TOL (withMemo->GetLoss (gnb, ue), expected, 1e-9, "Wrong DL loss in round " << round);
+              NS_TEST_ASSERT_MSG_EQ_TOL (withMemo->GetLoss (ue, gnb), expected, 1e-9, "Wrong UL loss in round " << round);
+              // The gNBs are all at x = 0, so the loss of a moved UE grows
+              auto last = lastLoss.find (std::make_pair (gnb, ue));
+              if (last != lastLoss.end () && moved.count (ue) > 0)
+                {
+                  NS_TEST_ASSERT_MSG_GT (expected, last->second, "The loss did not grow with the distance in round " << round);
+                }
+              lastLoss[std::make_pair (gnb, ue)] = expected;
+              calls += 2;
+            }
+        }
+    }
+
+  UintegerValue hits;
+  UintegerValue misses;
+  withMemo->GetAttribute ("PathLossMemoHits", hits);
+  withMemo->GetAttribute ("PathLossMemoMisses", misses);
+  NS_TEST_ASSERT_MSG_EQ (hits.Get () + misses.Get (), calls, "Wrong number of evaluations");
+  // At least the UL evaluation after each DL one is a hit
+  NS_TEST_ASSERT_MSG_GT (hits.Get (), calls / 2 - 1, "Too few hits");
+
+  // The attributes that change the path loss invalidate the memo, even if
+  // no node moves
+  const std::string otherScenario = m_scenario == "UMi-StreetCanyon" ? "InH-OfficeMixed" : "UMi-StreetCanyon";
+  const std::vector<std::pair<std::string, Ptr<AttributeValue> > > changes = {
+    std::make_pair ("OptionalNlos", Create<BooleanValue> (true)),
+    std::make_pair ("Scenario", Create<StringValue> (otherScenario)),
+    std::make_pair ("Frequency", Create<DoubleValue> (3.5e9))
+  };
+  for (const auto & change : changes)
+    {
+      withMemo->SetAttribute (change.first, *change.second);
+      withoutMemo->SetAttribute (change.first, *change.second);
+      withMemo->GetAttribute ("PathLossMemoMisses", misses);
+      const uint64_t missesBefore = misses.Get ();
+      for (const auto & ue : ues)
+        {
+          for (const auto & gnb : gnbs)
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL (withMemo->GetLoss (gnb, ue), withoutMemo->GetLoss (gnb, ue), 1e-9,
+                                         "Wrong loss after a change of " << change.first);
+            }
+        }
+      withMemo->GetAttribute ("PathLossMemoMisses", misses);
+      NS_TEST_ASSERT_MSG_EQ (misses.Get () - missesBefore, ues.size () * gnbs.size (),
+                             "The memo was used after a change of " << change.first);
+    }
+
+  withoutMemo->GetAttribute ("PathLossMemoHits", hits);
+  NS_TEST_ASSERT_MSG_EQ (hits.Get (), 0, "Hits without the memo");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief The path loss memo test suite
+ */
+class MmWave3gppPathLossMemoTestSuite : public TestSuite
+{
+public:
+  MmWave3gppPathLossMemoTestSuite () : TestSuite ("mmwave-test-3gpp-path-loss-memo", UNIT)
+  {
+    AddTestCase (new MmWave3gppPathLossMemoTestCase ("UMi-StreetCanyon", 10.0, "l"), QUICK);
+    AddTestCase (new MmWave3gppPathLossMemoTestCase ("UMi-StreetCanyon", 10.0, "n"), QUICK);
+    AddTestCase (new MmWave3gppPathLossMemoTestCase ("RMa", 35.0, "n"), QUICK);
+    AddTestCase (new MmWave3gppPathLossMemoTestCase ("InH-OfficeMixed", 3.0, "l"), QUICK);
+  }
+};
+
+static MmWave3gppPathLossMemoTestSuite mmwave3gppPathLossMemoTestSuite; //!< Path loss memo test suite
+
+} // namespace ns3
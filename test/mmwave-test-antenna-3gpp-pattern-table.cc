@@ -0,0 +1,253 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/double.h>
+#include <ns3/enum.h>
+#include <ns3/antenna-array-3gpp-model.h>
+#include <ns3/antenna-array-3gpp-pattern-table.h>
+#include "mmwave-test-random.h"
+#include <vector>
+
+/**
+ * \file mmwave-test-antenna-3gpp-pattern-table.cc
+ * \ingroup test
+ * \brief Unit-testing the radiation pattern table of AntennaArray3gppModel,
+ * and the batched radiation pattern and steering vectors of the antennas.
+ */
+namespace ns3 {
+
+/**
+ * \brief Random directions, with horizontal angles out of [-pi, pi) to
+ * check their wrapping
+ * \param num number of directions
+ * \param stream stream of the random directions
+ * \param vAngles the vertical angles, in radians
+ * \param hAngles the horizontal angles, in radians
+ */
+static void
+RandomDirections (uint32_t num, int64_t stream, std::vector<double> *vAngles, std::vector<double> *hAngles)
+{
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (stream);
+  vAngles->clear ();
+  hAngles->clear ();
+  for (uint32_t i = 0; i < num; ++i)
+    {
+      vAngles->push_back (random->GetValue (0, M_PI));
+      hAngles->push_back (random->GetValue (-2 * M_PI, 2 * M_PI));
+    }
+}
+
+/**
+ * \param hAngle a horizontal angle, in radians
+ * \return the angle in degrees, in [-180, 180)
+ */
+static double
+WrapDegrees (double hAngle)
+{
+  while (hAngle >= M_PI)
+    {
+      hAngle -= 2 * M_PI;
+    }
+  while (hAngle < -M_PI)
+    {
+      hAngle += 2 * M_PI;
+    }
+  return hAngle * 180 / M_PI;
+}
+
+/**
+ * \brief Check the radiation pattern of AntennaArray3gppModel, computed and
+ * interpolated in a table, against AntennaArray3gppModel::ComputeRadiationPattern,
+ * and the batched patterns against the ones of GetRadiationPattern
+ */
+class AntennaArray3gppPatternTableTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create AntennaArray3gppPatternTableTestCase
+   * \param isUe whether the antenna is of UE or gNB
+   * \param antennaMount the type of gNB antenna mount
+   * \param step the RadiationPatternStep of the antenna, in degrees
+   * \param maxError the RadiationPatternMaxError of the antenna
+   */
+  AntennaArray3gppPatternTableTestCase (bool isUe, AntennaArray3gppModel::GnbAntennaMount antennaMount,
+                                        double step, double maxError)
+    : TestCase (std::string ("Radiation pattern of ") + (isUe ? "UE" : (antennaMount == AntennaArray3gppModel::GnbWallMount
+                                                                        ? "gNB wall mount" : "gNB single sector"))
+                + ", step " + std::to_string (step) + ", maximum error " + std::to_string (maxError)),
+      m_isUe (isUe),
+      m_antennaMount (antennaMount),
+      m_step (step),
+      m_maxError (maxError)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  bool m_isUe {false};                                                                    //!< Whether the antenna is of UE or gNB
+  AntennaArray3gppModel::GnbAntennaMount m_antennaMount {AntennaArray3gppModel::GnbWallMount}; //!< Type of gNB antenna mount
+  double m_step {0.0};                                                                    //!< Step of the table, in degrees
+  double m_maxError {0.0};                                                                //!< Maximum error of the table
+};
+
+void
+AntennaArray3gppPatternTableTestCase::DoRun ()
+{
+  Ptr<AntennaArray3gppModel> antenna = CreateObject<AntennaArray3gppModel> ();
+  antenna->SetAttribute ("GnbAntennaMountType", EnumValue (m_antennaMount));
+  antenna->SetAttribute ("RadiationPatternStep", DoubleValue (m_step));
+  antenna->SetAttribute ("RadiationPatternMaxError", DoubleValue (m_maxError));
+  antenna->SetIsUe (m_isUe);
+
+  // The error allowed: none without a table, the one measured on the
+  // table otherwise (the same table as the one of the antenna)
+  double tolerance = 0.0;
+  if (m_step > 0)
+    {
+      const bool isUe = m_isUe;
+      const AntennaArray3gppModel::GnbAntennaMount antennaMount = m_antennaMount;
+      AntennaArray3gppPatternTable table ([isUe, antennaMount] (double vAngle, double hAngle)
+        {
+          return AntennaArray3gppModel::ComputeRadiationPattern (isUe, antennaMount, vAngle, hAngle);
+        }, m_step, m_maxError);
+      if (m_maxError > 0)
+        {
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (table.GetError (), m_maxError, "The table does not respect the maximum error");
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (table.GetStep (), m_step, 1e-9, "The table does not have the given step");
+        }
+      tolerance = table.GetError () * 1.01;
+    }
+
+  // The gain of the element is 5 dBi at the boresight; behind the UE and
+  // the wall mount antennas it is the front-back ratio (25 dB) lower
+  const double boresight = std::sqrt (std::pow (10, 0.5));
+  NS_TEST_ASSERT_MSG_EQ_TOL (antenna->GetRadiationPattern (M_PI / 2, 0), boresight, tolerance + 1e-12,
+                             "Wrong pattern at the boresight");
+  if (m_isUe || m_antennaMount == AntennaArray3gppModel::GnbWallMount)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (antenna->GetRadiationPattern (M_PI / 2, M_PI), 0.1, tolerance + 1e-12,
+                                 "Wrong pattern behind the antenna");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (antenna->GetRadiationPattern (M_PI / 2, M_PI), boresight, tolerance + 1e-12,
+                                 "The single sector pattern depends on the horizontal angle");
+    }
+
+  std::vector<double> vAngles;
+  std::vector<double> hAngles;
+  RandomDirections (20000, 7, &vAngles, &hAngles);
+
+  std::vector<double> patterns (vAngles.size ());
+  antenna->GetRadiationPatterns (vAngles.data (), hAngles.data (), vAngles.size (), patterns.data ());
+  for (uint32_t i = 0; i < vAngles.size (); ++i)
+    {
+      const double pattern = antenna->GetRadiationPattern (vAngles[i], hAngles[i]);
+      const double exact = AntennaArray3gppModel::ComputeRadiationPattern (m_isUe, m_antennaMount,
+                                                                           vAngles[i] * 180 / M_PI,
+                                                                           WrapDegrees (hAngles[i]));
+      NS_TEST_ASSERT_MSG_EQ (patterns[i], pattern, "The batched pattern is not the one of GetRadiationPattern");
+      NS_TEST_ASSERT_MSG_EQ_TOL (pattern, exact, tolerance, "Wrong pattern at " << vAngles[i] << ", " << hAngles[i]);
+    }
+}
+
+/**
+ * \brief Check the batched steering vectors of an antenna against the phase
+ * terms computed for each element and each direction
+ */
+class AntennaArraySteeringVectorsTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create AntennaArraySteeringVectorsTestCase
+   * \param orientation the orientation of the antenna
+   */
+  AntennaArraySteeringVectorsTestCase (AntennaArrayModel::AntennaOrientation orientation)
+    : TestCase ("Steering vectors, orientation " + std::to_string (orientation)),
+      m_orientation (orientation)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  AntennaArrayModel::AntennaOrientation m_orientation {AntennaArrayModel::X0}; //!< Orientation of the antenna
+};
+
+void
+AntennaArraySteeringVectorsTestCase::DoRun ()
+{
+  Ptr<AntennaArray3gppModel> antenna = CreateObject<AntennaArray3gppModel> ();
+  antenna->SetIsUe (true);
+  antenna->SetAntennaOrientation (m_orientation);
+  uint8_t antennaNum[2] = {4, 2};
+
+  std::vector<double> vAngles;
+  std::vector<double> hAngles;
+  RandomDirections (500, 11, &vAngles, &hAngles);
+
+  AntennaArrayBasicModel::complexVector_t steering;
+  antenna->GetSteeringVectors (vAngles.data (), hAngles.data (), vAngles.size (), antennaNum, &steering);
+  NS_TEST_ASSERT_MSG_EQ (steering.size (), 8 * vAngles.size (), "Wrong size of the steering vectors");
+
+  for (uint8_t u = 0; u < 8; ++u)
+    {
+      Vector loc = antenna->GetAntennaLocation (u, antennaNum);
+      for (uint32_t i = 0; i < vAngles.size (); ++i)
+        {
+          double phase = 2 * M_PI * (sin (vAngles[i]) * cos (hAngles[i]) * loc.x
+                                     + sin (vAngles[i]) * sin (hAngles[i]) * loc.y
+                                     + cos (vAngles[i]) * loc.z);
+          std::complex<double> expected = exp (std::complex<double> (0, phase));
+          NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (steering[u * vAngles.size () + i] - expected), 0.0, 1e-12,
+                                     "Wrong steering vector of element " << +u << " towards direction " << i);
+        }
+    }
+}
+
+/**
+ * \brief The radiation pattern table test suite
+ */
+class AntennaArray3gppPatternTableTestSuite : public TestSuite
+{
+public:
+  AntennaArray3gppPatternTableTestSuite () : TestSuite ("mmwave-test-antenna-3gpp-pattern-table", UNIT)
+  {
+    const AntennaArray3gppModel::GnbAntennaMount wall = AntennaArray3gppModel::GnbWallMount;
+    const AntennaArray3gppModel::GnbAntennaMount sector = AntennaArray3gppModel::GnbSingleSector;
+    for (const double step : {0.0, 1.0, 2.5})
+      {
+        AddTestCase (new AntennaArray3gppPatternTableTestCase (true, wall, step, 0.0), QUICK);
+        AddTestCase (new AntennaArray3gppPatternTableTestCase (false, wall, step, 0.0), QUICK);
+        AddTestCase (new AntennaArray3gppPatternTableTestCase (false, sector, step, 0.0), QUICK);
+      }
+    AddTestCase (new AntennaArray3gppPatternTableTestCase (true, wall, 4.0, 1e-3), QUICK);
+    AddTestCase (new AntennaArray3gppPatternTableTestCase (false, sector, 4.0, 1e-4), QUICK);
+    AddTestCase (new AntennaArraySteeringVectorsTestCase (AntennaArrayModel::X0), QUICK);
+    AddTestCase (new AntennaArraySteeringVectorsTestCase (AntennaArrayModel::Y0), QUICK);
+    AddTestCase (new AntennaArraySteeringVectorsTestCase (AntennaArrayModel::Z0), QUICK);
+  }
+};
+
+static AntennaArray3gppPatternTableTestSuite antennaArray3gppPatternTableTestSuite; //!< Radiation pattern table test suite
+
+} // namespace ns3
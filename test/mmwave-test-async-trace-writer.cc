@@ -0,0 +1,180 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-async-trace-writer.h>
+#include "mmwave-test-random.h"
+#include <limits>
+
+/**
+ * \file mmwave-test-async-trace-writer.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveAsyncTraceWriter class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Push records through a MmWaveAsyncTraceWriter with the BLOCK policy,
+ * and check that all of them run, in order, with Drain in the middle and Stop
+ * at the end
+ */
+class MmWaveAsyncTraceWriterOrderTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveAsyncTraceWriterOrderTestCase
+   * \param capacity capacity of the ring
+   * \param numRecords number of records to push
+   */
+  MmWaveAsyncTraceWriterOrderTestCase (uint32_t capacity, uint32_t numRecords)
+    : TestCase ("Async trace writer order with a ring of " + std::to_string (capacity)
+                + " and " + std::to_string (numRecords) + " records"),
+      m_capacity (capacity),
+      m_numRecords (numRecords)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_capacity {0};   //!< Capacity of the ring
+  uint32_t m_numRecords {0}; //!< Records to push
+};
+
+void
+MmWaveAsyncTraceWriterOrderTestCase::DoRun ()
+{
+  std::vector<uint32_t> written;
+  MmWaveAsyncTraceWriter writer;
+
+  // Not running: the records run in the caller
+  writer.Push ([&written] () { written.push_back (0); });
+  NS_TEST_ASSERT_MSG_EQ (written.size (), 1, "The record did not run in the caller");
+  written.clear ();
+
+  writer.Start (m_capacity, MmWaveAsyncTraceWriter::BLOCK);
+  NS_TEST_ASSERT_MSG_EQ (writer.IsRunning (), true, "The writer thread is not running");
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (3);
+  std::vector<uint32_t> pushed;
+  for (uint32_t i = 0; i < m_numRecords; ++i)
+    {
+      const uint32_t value = random->GetInteger (0, std::numeric_limits<uint32_t>::max () - 1);
+      pushed.push_back (value);
+      NS_TEST_ASSERT_MSG_EQ (writer.Push ([&written, value] () { written.push_back (value); }),
+                             true, "A record was dropped with the BLOCK policy");
+      if (i == m_numRecords / 2)
+        {
+          writer.Drain ();
+          NS_TEST_ASSERT_MSG_EQ (written.size (), i + 1, "Drain returned before the records ran");
+        }
+    }
+  writer.Stop ();
+  NS_TEST_ASSERT_MSG_EQ (writer.IsRunning (), false, "The writer thread is still running");
+  NS_TEST_ASSERT_MSG_EQ (writer.GetNumDropped (), 0, "Records dropped with the BLOCK policy");
+  NS_TEST_ASSERT_MSG_EQ (written.size (), m_numRecords, "Wrong number of records run");
+
+  for (uint32_t i = 0; i < written.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (written[i], pushed[i], "Record " << i << " out of order");
+    }
+}
+
+/**
+ * \brief Fill the ring of a MmWaveAsyncTraceWriter with the DROP policy,
+ * while the writer thread is held in the first record, and check that the
+ * records that do not fit are dropped and counted, and the others run in order
+ */
+class MmWaveAsyncTraceWriterDropTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveAsyncTraceWriterDropTestCase
+   * \param capacity capacity of the ring, a power of 2
+   * \param numRecords number of records to push, more than the capacity
+   */
+  MmWaveAsyncTraceWriterDropTestCase (uint32_t capacity, uint32_t numRecords)
+    : TestCase ("Async trace writer drops with a ring of " + std::to_string (capacity)
+                + " and " + std::to_string (numRecords) + " records"),
+      m_capacity (capacity),
+      m_numRecords (numRecords)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_capacity {0};   //!< Capacity of the ring
+  uint32_t m_numRecords {0}; //!< Records to push
+};
+
+void
+MmWaveAsyncTraceWriterDropTestCase::DoRun ()
+{
+  std::atomic<bool> gate {false};
+  std::vector<uint32_t> written;
+  MmWaveAsyncTraceWriter writer;
+  writer.Start (m_capacity, MmWaveAsyncTraceWriter::DROP);
+
+  // The first record holds its slot until the gate opens, so the ring is
+  // full after m_capacity records
+  writer.Push ([&gate, &written] ()
+               {
+                 while (! gate)
+                   {
+                     std::this_thread::yield ();
+                   }
+                 written.push_back (0);
+               });
+  uint32_t accepted = 1;
+  for (uint32_t i = 1; i < m_numRecords; ++i)
+    {
+      if (writer.Push ([&written, i] () { written.push_back (i); }))
+        {
+          ++accepted;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (accepted, m_capacity, "Wrong number of records accepted");
+  NS_TEST_ASSERT_MSG_EQ (writer.GetNumDropped (), m_numRecords - m_capacity, "Wrong number of records dropped");
+
+  gate = true;
+  writer.Stop ();
+  NS_TEST_ASSERT_MSG_EQ (written.size (), m_capacity, "Wrong number of records run");
+  for (uint32_t i = 0; i < written.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (written[i], i, "Record " << i << " out of order");
+    }
+}
+
+/**
+ * \brief The async trace writer test suite
+ */
+class MmWaveAsyncTraceWriterTestSuite : public TestSuite
+{
+public:
+  MmWaveAsyncTraceWriterTestSuite () : TestSuite ("mmwave-test-async-trace-writer", UNIT)
+  {
+    AddTestCase (new MmWaveAsyncTraceWriterOrderTestCase (1, 100), QUICK);
+    AddTestCase (new MmWaveAsyncTraceWriterOrderTestCase (5, 1000), QUICK);
+    AddTestCase (new MmWaveAsyncTraceWriterOrderTestCase (65536, 100000), QUICK);
+    AddTestCase (new MmWaveAsyncTraceWriterDropTestCase (1, 10), QUICK);
+    AddTestCase (new MmWaveAsyncTraceWriterDropTestCase (8, 100), QUICK);
+  }
+};
+
+static MmWaveAsyncTraceWriterTestSuite mmwaveAsyncTraceWriterTestSuite; //!< Async trace writer test suite
+
+} // namespace ns3
@@ -0,0 +1,257 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/mmwave-bearer-stats-calculator.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+/**
+ * \file mmwave-test-bearer-stats-epoch.cc
+ * \ingroup test
+ * \brief Unit-testing the epoch output of MmWaveBearerStatsCalculator.
+ */
+namespace ns3 {
+
+/**
+ * \brief Feed PDUs to a MmWaveBearerStatsCalculator with EpochOutput, and
+ * check:
+ *
+ * - that the PDUs before StartTime are ignored;
+ * - that the epochs without PDUs are skipped, and that the end of the epochs
+ *   is no more scheduled after an epoch without PDUs;
+ * - that the last epoch is written at Simulator::Destroy, when the
+ *   simulation stops before its end;
+ * - that each epoch has a row per (CellId, IMSI, LCID), with the right
+ *   counters and statistics, and as many columns as the header.
+ */
+class MmWaveBearerStatsEpochTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveBearerStatsEpochTestCase
+   * \param stop whether the simulation stops in the middle of the last epoch
+   */
+  MmWaveBearerStatsEpochTestCase (bool stop)
+    : TestCase (std::string ("Epoch output of the bearer statistics, ") +
+                (stop ? "stopped in the last epoch" : "run to the end")),
+      m_stop (stop)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief The values of a row of the output
+   */
+  typedef std::vector<double> Row;
+
+  /**
+   * \brief Read an output file
+   * \param fileName the name of the file
+   * \param header the header of the file
+   * \return the rows of the file
+   */
+  std::vector<Row> ReadRows (const std::string &fileName, std::string *header);
+
+  /**
+   * \brief Find the row of a bearer in an epoch
+   * \param rows the rows of a file
+   * \param start the start of the epoch, in s
+   * \param cellId the cell ID
+   * \param imsi the IMSI
+   * \param lcid the LCID
+   * \return the row, or nullptr if there is none
+   */
+  const Row * FindRow (const std::vector<Row> &rows, double start, uint16_t cellId,
+                       uint64_t imsi, uint8_t lcid) const;
+
+  bool m_stop {false}; //!< Whether the simulation stops in the middle of the last epoch
+};
+
+std::vector<MmWaveBearerStatsEpochTestCase::Row>
+MmWaveBearerStatsEpochTestCase::ReadRows (const std::string &fileName, std::string *header)
+{
+  std::vector<Row> rows;
+  std::ifstream file (fileName);
+  NS_TEST_EXPECT_MSG_EQ (file.is_open (), true, "Can't open " << fileName);
+  std::string line;
+  while (std::getline (file, line))
+    {
+      if (line.empty ())
+        {
+          continue;
+        }
+      if (line[0] == '%')
+        {
+          *header = line;
+          continue;
+        }
+      std::istringstream values (line);
+      Row row;
+      double value;
+      while (values >> value)
+        {
+          row.push_back (value);
+        }
+      rows.push_back (row);
+    }
+  return rows;
+}
+
+const MmWaveBearerStatsEpochTestCase::Row *
+MmWaveBearerStatsEpochTestCase::FindRow (const std::vector<Row> &rows, double start, uint16_t cellId,
+                                         uint64_t imsi, uint8_t lcid) const
+{
+  for (const auto & row : rows)
+    {
+      if (row.size () > 5 && std::abs (row[0] - start) < 1e-9 && row[2] == cellId
+          && row[3] == imsi && row[5] == lcid)
+        {
+          return &row;
+        }
+    }
+  return nullptr;
+}
+
+void
+MmWaveBearerStatsEpochTestCase::DoRun ()
+{
+  const std::string dlFileName = CreateTempDirFilename ("mmwave-test-bearer-stats-epoch-dl.txt");
+  const std::string ulFileName = CreateTempDirFilename ("mmwave-test-bearer-stats-epoch-ul.txt");
+
+  Ptr<MmWaveBearerStatsCalculator> stats = CreateObject<MmWaveBearerStatsCalculator> ();
+  stats->SetAttribute ("EpochOutput", BooleanValue (true));
+  stats->SetAttribute ("StartTime", TimeValue (Seconds (0.1)));
+  stats->SetAttribute ("EpochDuration", TimeValue (Seconds (0.1)));
+  stats->SetAttribute ("DlRlcOutputFilename", StringValue (dlFileName));
+  stats->SetAttribute ("UlRlcOutputFilename", StringValue (ulFileName));
+
+  // Before StartTime: ignored
+  Simulator::Schedule (Seconds (0.05), &MmWaveBearerStatsCalculator::DlTxPdu, stats, 1, 10, 1, 3, 1000);
+  // Epoch [0.1, 0.2): two bearers in DL, one in UL
+  Simulator::Schedule (Seconds (0.11), &MmWaveBearerStatsCalculator::DlTxPdu, stats, 1, 10, 1, 3, 100);
+  Simulator::Schedule (Seconds (0.12), &MmWaveBearerStatsCalculator::DlRxPdu, stats, 1, 10, 1, 3, 100, 1000000);
+  Simulator::Schedule (Seconds (0.13), &MmWaveBearerStatsCalculator::DlRxPdu, stats, 1, 10, 1, 3, 300, 3000000);
+  Simulator::Schedule (Seconds (0.14), &MmWaveBearerStatsCalculator::DlRxPdu, stats, 2, 11, 1, 4, 50, 2000000);
+  Simulator::Schedule (Seconds (0.15), &MmWaveBearerStatsCalculator::UlTxPdu, stats, 1, 10, 1, 3, 70);
+  // Epochs [0.2, 0.5) without PDUs, then epoch [0.5, 0.6)
+  Simulator::Schedule (Seconds (0.55), &MmWaveBearerStatsCalculator::DlTxPdu, stats, 1, 10, 1, 3, 20);
+  // Epoch [0.6, 0.7) without PDUs, then epoch [0.7, 0.8)
+  Simulator::Schedule (Seconds (0.75), &MmWaveBearerStatsCalculator::DlRxPdu, stats, 1, 10, 1, 3, 60, 4000000);
+
+  if (m_stop)
+    {
+      Simulator::Stop (Seconds (0.78));
+    }
+  Simulator::Run ();
+  if (! m_stop)
+    {
+      // The end of [0.7, 0.8) schedules one more end of epoch, without PDUs
+      NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (0.9), "The end of the epochs is still scheduled");
+    }
+  Simulator::Destroy ();
+
+  std::string dlHeader;
+  std::string ulHeader;
+  std::vector<Row> dlRows = ReadRows (dlFileName, &dlHeader);
+  std::vector<Row> ulRows = ReadRows (ulFileName, &ulHeader);
+
+  NS_TEST_ASSERT_MSG_EQ ((dlHeader.find ("p50") != std::string::npos), true, "No percentiles in the header");
+  std::istringstream headerColumns (dlHeader.substr (1));
+  uint32_t columns = 0;
+  std::string column;
+  while (headerColumns >> column)
+    {
+      ++columns;
+    }
+  NS_TEST_ASSERT_MSG_EQ (columns, 24u, "Wrong number of columns in the header");
+  NS_TEST_ASSERT_MSG_EQ (ulHeader, dlHeader, "Different UL and DL headers");
+
+  NS_TEST_ASSERT_MSG_EQ (dlRows.size (), 4u, "Wrong number of DL rows");
+  NS_TEST_ASSERT_MSG_EQ (ulRows.size (), 1u, "Wrong number of UL rows");
+  for (const auto & row : dlRows)
+    {
+      NS_TEST_ASSERT_MSG_EQ (row.size (), columns, "A row and the header have a different number of columns");
+      NS_TEST_EXPECT_MSG_EQ_TOL (row[1] - row[0], 0.1, 1e-9, "Wrong epoch duration");
+    }
+
+  const Row *row = FindRow (dlRows, 0.1, 1, 10, 3);
+  NS_TEST_ASSERT_MSG_NE ((row == nullptr), true, "No row of the first bearer in [0.1, 0.2)");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[4], 1, "Wrong RNTI");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[6], 1, "Wrong number of TX PDUs (is the PDU before StartTime counted?)");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[7], 100, "Wrong TX bytes");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[8], 2, "Wrong number of RX PDUs");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[9], 400, "Wrong RX bytes");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[10], 2e-3, 1e-9, "Wrong mean delay");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[12], 1e-3, 1e-9, "Wrong min delay");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[13], 3e-3, 1e-9, "Wrong max delay");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[17], 200, 1e-9, "Wrong mean PDU size");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[19], 100, 1e-9, "Wrong min PDU size");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[20], 300, 1e-9, "Wrong max PDU size");
+  // The percentiles are within the relative accuracy of the sketch (1 %)
+  NS_TEST_EXPECT_MSG_GT_OR_EQ ((*row)[14], 0.99e-3, "Wrong p50 of the delay");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ ((*row)[16], 3.03e-3, "Wrong p99 of the delay");
+
+  row = FindRow (dlRows, 0.1, 2, 11, 4);
+  NS_TEST_ASSERT_MSG_NE ((row == nullptr), true, "No row of the second bearer in [0.1, 0.2)");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[6], 0, "Wrong number of TX PDUs of the second bearer");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[8], 1, "Wrong number of RX PDUs of the second bearer");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[9], 50, "Wrong RX bytes of the second bearer");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[10], 2e-3, 1e-9, "Wrong mean delay of the second bearer");
+
+  row = FindRow (dlRows, 0.5, 1, 10, 3);
+  NS_TEST_ASSERT_MSG_NE ((row == nullptr), true, "No row in [0.5, 0.6): the empty epochs are not skipped");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[6], 1, "Wrong number of TX PDUs in [0.5, 0.6)");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[7], 20, "Wrong TX bytes in [0.5, 0.6)");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[8], 0, "Wrong number of RX PDUs in [0.5, 0.6)");
+
+  row = FindRow (dlRows, 0.7, 1, 10, 3);
+  NS_TEST_ASSERT_MSG_NE ((row == nullptr), true, "No row in [0.7, 0.8): the last epoch is not written");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[8], 1, "Wrong number of RX PDUs in [0.7, 0.8)");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[9], 60, "Wrong RX bytes in [0.7, 0.8)");
+  NS_TEST_EXPECT_MSG_EQ_TOL ((*row)[13], 4e-3, 1e-9, "Wrong max delay in [0.7, 0.8)");
+
+  row = FindRow (ulRows, 0.1, 1, 10, 3);
+  NS_TEST_ASSERT_MSG_NE ((row == nullptr), true, "No UL row in [0.1, 0.2)");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[6], 1, "Wrong number of UL TX PDUs");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[7], 70, "Wrong UL TX bytes");
+  NS_TEST_EXPECT_MSG_EQ ((*row)[8], 0, "Wrong number of UL RX PDUs");
+
+  stats->Dispose ();
+}
+
+/**
+ * \brief The bearer statistics epoch test suite
+ */
+class MmWaveBearerStatsEpochTestSuite : public TestSuite
+{
+public:
+  MmWaveBearerStatsEpochTestSuite () : TestSuite ("mmwave-test-bearer-stats-epoch", UNIT)
+  {
+    AddTestCase (new MmWaveBearerStatsEpochTestCase (false), QUICK);
+    AddTestCase (new MmWaveBearerStatsEpochTestCase (true), QUICK);
+  }
+};
+
+static MmWaveBearerStatsEpochTestSuite mmwaveBearerStatsEpochTestSuite; //!< Bearer statistics epoch test suite
+
+} // namespace ns3
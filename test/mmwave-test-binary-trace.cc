@@ -0,0 +1,155 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-binary-trace.h>
+#include "mmwave-test-random.h"
+#include <cstdio>
+#include <limits>
+
+/**
+ * \file mmwave-test-binary-trace.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveBinaryTraceWriter and MmWaveBinaryTraceReader classes.
+ */
+namespace ns3 {
+
+/**
+ * \brief Write rows of all the column types with MmWaveBinaryTraceWriter,
+ * with a flush in the middle, and check that MmWaveBinaryTraceReader reads
+ * them back, block after block
+ */
+class MmWaveBinaryTraceTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveBinaryTraceTestCase
+   * \param numRows number of rows to write
+   * \param rowsPerBlock rows per block of the writer
+   */
+  MmWaveBinaryTraceTestCase (uint32_t numRows, uint32_t rowsPerBlock)
+    : TestCase ("Binary trace with " + std::to_string (numRows) + " rows and "
+                + std::to_string (rowsPerBlock) + " rows per block"),
+      m_numRows (numRows),
+      m_rowsPerBlock (rowsPerBlock)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numRows {0};      //!< Rows to write
+  uint32_t m_rowsPerBlock {0}; //!< Rows per block
+};
+
+void
+MmWaveBinaryTraceTestCase::DoRun ()
+{
+  const std::vector<MmWaveBinaryTrace::Column> columns = {
+    {"u8", MmWaveBinaryTrace::UINT8}, {"u16", MmWaveBinaryTrace::UINT16},
+    {"u32", MmWaveBinaryTrace::UINT32}, {"u64", MmWaveBinaryTrace::UINT64},
+    {"d", MmWaveBinaryTrace::DOUBLE}};
+  const std::string fileName = CreateTempDirFilename ("mmwave-test-binary-trace.bin");
+
+  std::vector<std::vector<uint64_t> > reference (4);
+  std::vector<double> referenceDouble;
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (5);
+  {
+    MmWaveBinaryTraceWriter writer;
+    writer.Open (fileName, "Test", columns, m_rowsPerBlock);
+    for (uint32_t row = 0; row < m_numRows; ++row)
+      {
+        const uint32_t value = random->GetInteger (0, UINT32_MAX - 1);
+        uint64_t values[4] = {value % 256, value % 65536, value,
+                              (static_cast<uint64_t> (value) << 32) | row};
+        double valueDouble = random->GetValue (-1e9, 1e9);
+        if (row == 0)
+          {
+            // The largest value of each type must not be truncated
+            values[0] = UINT8_MAX;
+            values[1] = UINT16_MAX;
+            values[2] = UINT32_MAX;
+            values[3] = UINT64_MAX;
+            valueDouble = std::numeric_limits<double>::max ();
+          }
+        // Set the columns in reverse order: the order must not matter
+        writer.SetDouble (4, valueDouble);
+        for (uint32_t c = 4; c > 0; --c)
+          {
+            writer.SetUint (c - 1, values[c - 1]);
+            reference[c - 1].push_back (values[c - 1]);
+          }
+        referenceDouble.push_back (valueDouble);
+        writer.EndRow ();
+        if (row == m_numRows / 2)
+          {
+            writer.Flush ();
+          }
+      }
+    NS_TEST_ASSERT_MSG_EQ (writer.GetNumRows (), m_numRows, "Wrong number of rows written");
+  }
+
+  MmWaveBinaryTraceReader reader;
+  reader.Open (fileName);
+  NS_TEST_ASSERT_MSG_EQ (reader.GetKind (), "Test", "Wrong kind");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetColumns ().size (), columns.size (), "Wrong number of columns");
+  for (uint32_t c = 0; c < columns.size (); ++c)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.GetColumns ()[c].m_name, columns[c].m_name, "Wrong name of column " << c);
+      NS_TEST_ASSERT_MSG_EQ (reader.GetColumns ()[c].m_type, columns[c].m_type, "Wrong type of column " << c);
+      NS_TEST_ASSERT_MSG_EQ (reader.GetColumnIndex (columns[c].m_name), c, "Wrong index of column " << c);
+    }
+
+  uint32_t rows = 0;
+  while (reader.ReadBlock ())
+    {
+      NS_TEST_ASSERT_MSG_GT (reader.GetNumRows (), 0, "Empty block");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (reader.GetNumRows (), m_rowsPerBlock, "Block too large");
+      for (uint32_t row = 0; row < reader.GetNumRows (); ++row, ++rows)
+        {
+          for (uint32_t c = 0; c < 4; ++c)
+            {
+              NS_TEST_ASSERT_MSG_EQ (reader.GetUint (c, row), reference[c].at (rows),
+                                     "Wrong value of column " << c << " in row " << rows);
+            }
+          NS_TEST_ASSERT_MSG_EQ (reader.GetDouble (4, row), referenceDouble.at (rows),
+                                 "Wrong double in row " << rows);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (rows, m_numRows, "Wrong number of rows read");
+  std::remove (fileName.c_str ());
+}
+
+/**
+ * \brief The binary trace test suite
+ */
+class MmWaveBinaryTraceTestSuite : public TestSuite
+{
+public:
+  MmWaveBinaryTraceTestSuite () : TestSuite ("mmwave-test-binary-trace", UNIT)
+  {
+    AddTestCase (new MmWaveBinaryTraceTestCase (0, 16), QUICK);
+    AddTestCase (new MmWaveBinaryTraceTestCase (1, 16), QUICK);
+    AddTestCase (new MmWaveBinaryTraceTestCase (16, 16), QUICK);
+    AddTestCase (new MmWaveBinaryTraceTestCase (101, 7), QUICK);
+    AddTestCase (new MmWaveBinaryTraceTestCase (5000, 4096), QUICK);
+  }
+};
+
+static MmWaveBinaryTraceTestSuite mmwaveBinaryTraceTestSuite; //!< Binary trace test suite
+
+} // namespace ns3
@@ -0,0 +1,514 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/mmwave-helper.h>
+#include <ns3/mmwave-point-to-point-epc-helper.h>
+#include <ns3/mmwave-channel-snapshot.h>
+#include <ns3/mmwave-spectrum-value-helper.h>
+#include "mmwave-test-random.h"
+#include <cstdio>
+#include <limits>
+#include <map>
+
+/**
+ * \file mmwave-test-channel-snapshot.cc
+ * \ingroup test
+ * \brief Unit-testing the file format of MmWaveChannelSnapshot, and the
+ * restore of a scenario from it.
+ */
+namespace ns3 {
+
+/**
+ * \brief Fill a MmWaveChannelSnapshot with random records, save it, load it
+ * in another one, and check that all the saved fields are the same
+ */
+class MmWaveChannelSnapshotTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveChannelSnapshotTestCase
+   * \param numBwps number of bandwidth parts
+   * \param numRecords number of links, channels and antennas of each bandwidth part
+   */
+  MmWaveChannelSnapshotTestCase (uint32_t numBwps, uint32_t numRecords)
+    : TestCase ("Channel snapshot with " + std::to_string (numBwps) + " BWPs and "
+                + std::to_string (numRecords) + " records per list"),
+      m_numBwps (numBwps),
+      m_numRecords (numRecords)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numBwps {0};    //!< Bandwidth parts
+  uint32_t m_numRecords {0}; //!< Records per list
+};
+
+void
+MmWaveChannelSnapshotTestCase::DoRun ()
+{
+  const std::string fileName = CreateTempDirFilename ("mmwave-test-channel-snapshot.bin");
+
+  Ptr<UniformRandomVariable> randomVariable = CreateTestRandomVariable (7);
+  auto random = [randomVariable] ()
+    {
+      return randomVariable->GetInteger (0, std::numeric_limits<uint32_t>::max () - 1);
+    };
+  auto randomDouble = [randomVariable] ()
+    {
+      return randomVariable->GetValue (-524288.0, 524288.0);
+    };
+  auto randomVector = [&randomDouble] (uint32_t size)
+    {
+      doubleVector_t v (size);
+      for (auto & e : v)
+        {
+          e = randomDouble ();
+        }
+      return v;
+    };
+  auto randomComplex = [&randomDouble] (uint32_t size)
+    {
+      complexVector_t v (size);
+      for (auto & e : v)
+        {
+          e = std::complex<double> (randomDouble (), randomDouble ());
+        }
+      return v;
+    };
+  auto randomDevice = [&random] ()
+    {
+      MmWaveChannelSnapshot::DeviceId id;
+      id.m_node = random () % 1000;
+      id.m_device = random () % 4;
+      return id;
+    };
+
+  MmWaveChannelSnapshot saved;
+  saved.GetBwps ().resize (m_numBwps);
+  for (auto & bwp : saved.GetBwps ())
+    {
+      // The tables of a buildings model
+      bwp.m_linkTables.resize (3);
+      for (auto & table : bwp.m_linkTables)
+        {
+          for (uint32_t i = 0; i < m_numRecords; ++i)
+            {
+              MmWaveChannelSnapshot::LinkRecord link;
+              link.m_ueNode = random ();
+              link.m_gnbNode = random ();
+              link.m_state.m_condition = "lnis"[random () % 4];
+              link.m_state.m_shadowing = randomDouble ();
+              link.m_state.m_shadowingPosition = Vector (randomDouble (), randomDouble (), randomDouble ());
+              link.m_state.m_hE = randomDouble ();
+              link.m_state.m_carPenetrationLoss = randomDouble ();
+              link.m_state.m_shadowingStd = randomDouble ();
+              link.m_state.m_shadowingCorDistance = randomDouble ();
+              table.push_back (link);
+            }
+        }
+
+      for (uint32_t i = 0; i < m_numRecords; ++i)
+        {
+          MmWaveChannelSnapshot::ChannelRecord channel;
+          channel.m_tx = randomDevice ();
+          channel.m_rx = randomDevice ();
+          Ptr<Params3gpp> p = Create<Params3gpp> ();
+          const uint32_t numCluster = 1 + random () % 8;
+          p->m_txBeamId = std::make_pair (static_cast<uint8_t> (random ()), randomDouble ());
+          p->m_rxBeamId = std::make_pair (static_cast<uint8_t> (random ()), randomDouble ());
+          p->m_txW = randomComplex (16);
+          p->m_rxW = randomComplex (4);
+          // An empty channel matrix is the one of a link waiting for an update
+          p->m_channel.assign (i % 3 == 0 ? 0 : 4, complex2DVector_t (16));
+          for (auto & rx : p->m_channel)
+            {
+              for (auto & tx : rx)
+                {
+                  tx = randomComplex (numCluster);
+                }
+            }
+          p->m_delay = randomVector (numCluster);
+          p->m_angle = {randomVector (numCluster), randomVector (numCluster),
+                        randomVector (numCluster), randomVector (numCluster)};
+          p->m_longTerm = randomComplex (numCluster);
+          p->m_nonSelfBlocking = {randomVector (5), randomVector (5)};
+          p->m_preLocUT = Vector (randomDouble (), randomDouble (), randomDouble ());
+          p->m_locUT = Vector (randomDouble (), randomDouble (), randomDouble ());
+          p->m_norRvAngles = {randomVector (4), randomVector (4)};
+          p->m_generatedTime = NanoSeconds (random ());
+          p->m_DS = randomDouble ();
+          p->m_K = randomDouble ();
+          p->m_numCluster = static_cast<uint8_t> (numCluster);
+          p->m_clusterPhase = {randomVector (4), randomVector (4)};
+          p->m_losPhase = randomDouble ();
+          p->m_los = random () % 2 == 0;
+          p->m_o2i = random () % 2 == 0;
+          p->m_speed = Vector (randomDouble (), randomDouble (), 0.0);
+          p->m_dis2D = randomDouble ();
+          p->m_dis3D = randomDouble ();
+          channel.m_params = p;
+          bwp.m_channels.push_back (channel);
+        }
+
+      for (uint32_t i = 0; i < m_numRecords; ++i)
+        {
+          MmWaveChannelSnapshot::BeamformingRecord record;
+          record.m_device = randomDevice ();
+          record.m_omniTx = random () % 2 == 0;
+          record.m_current = std::make_pair (randomComplex (record.m_omniTx ? 0 : 16),
+                                             std::make_pair (static_cast<uint8_t> (random ()), randomDouble ()));
+          for (uint32_t j = 0; j < i % 4; ++j)
+            {
+              MmWaveChannelSnapshot::PeerBeam peer;
+              peer.m_peer = randomDevice ();
+              peer.m_beam = std::make_pair (randomComplex (16),
+                                            std::make_pair (static_cast<uint8_t> (random ()), randomDouble ()));
+              record.m_peers.push_back (peer);
+            }
+          bwp.m_beamforming.push_back (record);
+        }
+    }
+  saved.Save (fileName);
+
+  MmWaveChannelSnapshot loaded;
+  loaded.Load (fileName);
+  std::remove (fileName.c_str ());
+
+  NS_TEST_ASSERT_MSG_EQ (loaded.GetTime (), saved.GetTime (), "Wrong time");
+  NS_TEST_ASSERT_MSG_EQ (loaded.GetBwps ().size (), m_numBwps, "Wrong number of BWPs");
+  for (uint32_t b = 0; b < m_numBwps; ++b)
+    {
+      const MmWaveChannelSnapshot::BwpState &s = saved.GetBwps ()[b];
+      const MmWaveChannelSnapshot::BwpState &l = loaded.GetBwps ()[b];
+
+      NS_TEST_ASSERT_MSG_EQ (l.m_linkTables.size (), s.m_linkTables.size (), "Wrong number of link tables");
+      for (uint32_t t = 0; t < s.m_linkTables.size (); ++t)
+        {
+          NS_TEST_ASSERT_MSG_EQ (l.m_linkTables[t].size (), s.m_linkTables[t].size (), "Wrong number of links");
+          for (uint32_t i = 0; i < s.m_linkTables[t].size (); ++i)
+            {
+              const MmWaveChannelSnapshot::LinkRecord &sl = s.m_linkTables[t][i];
+              const MmWaveChannelSnapshot::LinkRecord &ll = l.m_linkTables[t][i];
+              NS_TEST_ASSERT_MSG_EQ (ll.m_ueNode, sl.m_ueNode, "Wrong UE of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_gnbNode, sl.m_gnbNode, "Wrong gNB of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_state.m_condition, sl.m_state.m_condition, "Wrong condition of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_state.m_shadowing, sl.m_state.m_shadowing, "Wrong shadowing of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_state.m_shadowingPosition, sl.m_state.m_shadowingPosition,
+                                     "Wrong shadowing position of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_state.m_hE, sl.m_state.m_hE, "Wrong hE of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_state.m_carPenetrationLoss, sl.m_state.m_carPenetrationLoss,
+                                     "Wrong car penetration loss of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_state.m_shadowingStd, sl.m_state.m_shadowingStd,
+                                     "Wrong shadowing std of link " << i);
+              NS_TEST_ASSERT_MSG_EQ (ll.m_state.m_shadowingCorDistance, sl.m_state.m_shadowingCorDistance,
+                                     "Wrong correlation distance of link " << i);
+            }
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (l.m_channels.size (), s.m_channels.size (), "Wrong number of channels");
+      for (uint32_t i = 0; i < s.m_channels.size (); ++i)
+        {
+          const MmWaveChannelSnapshot::ChannelRecord &sc = s.m_channels[i];
+          const MmWaveChannelSnapshot::ChannelRecord &lc = l.m_channels[i];
+          NS_TEST_ASSERT_MSG_EQ (lc.m_tx.m_node, sc.m_tx.m_node, "Wrong tx node of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lc.m_tx.m_device, sc.m_tx.m_device, "Wrong tx device of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lc.m_rx.m_node, sc.m_rx.m_node, "Wrong rx node of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lc.m_rx.m_device, sc.m_rx.m_device, "Wrong rx device of channel " << i);
+          const Params3gpp &sp = *sc.m_params;
+          const Params3gpp &lp = *lc.m_params;
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_txBeamId == sp.m_txBeamId), true, "Wrong tx beam of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_rxBeamId == sp.m_rxBeamId), true, "Wrong rx beam of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_txW == sp.m_txW), true, "Wrong tx weights of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_rxW == sp.m_rxW), true, "Wrong rx weights of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_channel == sp.m_channel), true, "Wrong matrix of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_delay == sp.m_delay), true, "Wrong delays of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_angle == sp.m_angle), true, "Wrong angles of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_longTerm == sp.m_longTerm), true, "Wrong long term of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_nonSelfBlocking == sp.m_nonSelfBlocking), true,
+                                 "Wrong blockage of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_preLocUT, sp.m_preLocUT, "Wrong previous UT location of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_locUT, sp.m_locUT, "Wrong UT location of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_norRvAngles == sp.m_norRvAngles), true,
+                                 "Wrong random angles of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_generatedTime, sp.m_generatedTime, "Wrong age of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_DS, sp.m_DS, "Wrong delay spread of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_K, sp.m_K, "Wrong K factor of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (lp.m_numCluster), static_cast<uint32_t> (sp.m_numCluster),
+                                 "Wrong number of clusters of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lp.m_clusterPhase == sp.m_clusterPhase), true,
+                                 "Wrong cluster phases of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_losPhase, sp.m_losPhase, "Wrong LOS phase of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_los, sp.m_los, "Wrong LOS of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_o2i, sp.m_o2i, "Wrong O2I of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_speed, sp.m_speed, "Wrong speed of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_dis2D, sp.m_dis2D, "Wrong 2D distance of channel " << i);
+          NS_TEST_ASSERT_MSG_EQ (lp.m_dis3D, sp.m_dis3D, "Wrong 3D distance of channel " << i);
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (l.m_beamforming.size (), s.m_beamforming.size (), "Wrong number of antennas");
+      for (uint32_t i = 0; i < s.m_beamforming.size (); ++i)
+        {
+          const MmWaveChannelSnapshot::BeamformingRecord &sb = s.m_beamforming[i];
+          const MmWaveChannelSnapshot::BeamformingRecord &lb = l.m_beamforming[i];
+          NS_TEST_ASSERT_MSG_EQ (lb.m_device.m_node, sb.m_device.m_node, "Wrong node of antenna " << i);
+          NS_TEST_ASSERT_MSG_EQ (lb.m_device.m_device, sb.m_device.m_device, "Wrong device of antenna " << i);
+          NS_TEST_ASSERT_MSG_EQ (lb.m_omniTx, sb.m_omniTx, "Wrong omni mode of antenna " << i);
+          NS_TEST_ASSERT_MSG_EQ ((lb.m_current == sb.m_current), true, "Wrong current beam of antenna " << i);
+          NS_TEST_ASSERT_MSG_EQ (lb.m_peers.size (), sb.m_peers.size (), "Wrong number of peers of antenna " << i);
+          for (uint32_t j = 0; j < sb.m_peers.size (); ++j)
+            {
+              NS_TEST_ASSERT_MSG_EQ (lb.m_peers[j].m_peer.m_node, sb.m_peers[j].m_peer.m_node,
+                                     "Wrong peer node of antenna " << i);
+              NS_TEST_ASSERT_MSG_EQ (lb.m_peers[j].m_peer.m_device, sb.m_peers[j].m_peer.m_device,
+                                     "Wrong peer device of antenna " << i);
+              NS_TEST_ASSERT_MSG_EQ ((lb.m_peers[j].m_beam == sb.m_peers[j].m_beam), true,
+                                     "Wrong peer beam of antenna " << i);
+            }
+        }
+    }
+}
+
+/**
+ * \brief Run a scenario, save a snapshot of its channels and record their
+ * state; then run the scenario again, with another run number, from the
+ * snapshot, and check that after AttachToClosestEnb the channel matrices,
+ * the long term components, the beamforming vectors of the antennas and the
+ * RX PSD of the links are the recorded ones
+ */
+class MmWaveChannelSnapshotRestoreTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveChannelSnapshotRestoreTestCase
+   */
+  MmWaveChannelSnapshotRestoreTestCase ()
+    : TestCase ("Restore of a scenario from a channel snapshot")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief The values of the state of a run, by description of the value
+   */
+  typedef std::map<std::string, std::vector<std::complex<double> > > State;
+
+  /**
+   * \brief Run the scenario
+   * \param fileName the snapshot file
+   * \param load true to start from the snapshot, false to save it
+   * \param state the state recorded after the save, or after the restore
+   */
+  void RunScenario (const std::string &fileName, bool load, State *state);
+
+  /**
+   * \brief Save the snapshot, and record the state
+   * \param fileName the snapshot file
+   * \param state the state
+   */
+  void SaveAndRecord (const std::string &fileName, State *state);
+
+  /**
+   * \brief Record the state of the channel, of the antennas and the RX PSD
+   * of the links with a channel matrix
+   * \param state the state
+   */
+  void Record (State *state) const;
+
+  Ptr<MmWaveHelper> m_helper; //!< Helper of the current run
+  NetDeviceContainer m_devs;  //!< gNB and UE devices of the current run
+};
+
+void
+MmWaveChannelSnapshotRestoreTestCase::SaveAndRecord (const std::string &fileName, State *state)
+{
+  m_helper->SaveChannelSnapshot (fileName);
+  Record (state);
+}
+
+void
+MmWaveChannelSnapshotRestoreTestCase::Record (State *state) const
+{
+  Ptr<MmWave3gppChannel> channel = m_helper->Get3gppChannel (0);
+  const Ptr<MmWavePhyMacCommon> config = channel->GetConfigurationParameters ();
+  const Ptr<const SpectrumValue> txPsd = MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (
+      config, 30.0, RbgBitmask (config->GetBandwidthInRbs (), true));
+
+  std::vector<std::pair<Ptr<NetDevice>, Ptr<NetDevice> > > links;
+  channel->ForEachChannel ([state, &links] (const Ptr<NetDevice> &tx, const Ptr<NetDevice> &rx,
+                                            const Ptr<const Params3gpp> &params)
+    {
+      const std::string link = std::to_string (tx->GetNode ()->GetId ()) + "-"
+        + std::to_string (rx->GetNode ()->GetId ());
+      std::vector<std::complex<double> > &values = (*state)["channel " + link];
+      for (const auto & u : params->m_channel)
+        {
+          for (const auto & s : u)
+            {
+              values.insert (values.end (), s.begin (), s.end ());
+            }
+        }
+      values.insert (values.end (), params->m_longTerm.begin (), params->m_longTerm.end ());
+      values.insert (values.end (), params->m_txW.begin (), params->m_txW.end ());
+      values.insert (values.end (), params->m_rxW.begin (), params->m_rxW.end ());
+      values.push_back ((Simulator::Now () - params->m_generatedTime).GetSeconds ());
+      if (params->m_channel.size () > 0)
+        {
+          links.push_back (std::make_pair (tx, rx));
+        }
+    });
+
+  for (const auto & link : links)
+    {
+      Ptr<SpectrumValue> rxPsd = channel->CalcRxPowerSpectralDensity (
+          txPsd, link.first->GetNode ()->GetObject<MobilityModel> (),
+          link.second->GetNode ()->GetObject<MobilityModel> ());
+      (*state)["psd " + std::to_string (link.first->GetNode ()->GetId ()) + "-"
+               + std::to_string (link.second->GetNode ()->GetId ())]
+        .assign (rxPsd->ConstValuesBegin (), rxPsd->ConstValuesEnd ());
+    }
+
+  for (uint32_t i = 0; i < m_devs.GetN (); ++i)
+    {
+      Ptr<NetDevice> dev = m_devs.Get (i);
+      Ptr<MmWaveUeNetDevice> ue = DynamicCast<MmWaveUeNetDevice> (dev);
+      Ptr<MmWaveSpectrumPhy> phy = ue != nullptr ? ue->GetPhy (0)->GetDlSpectrumPhy ()
+        : DynamicCast<MmWaveEnbNetDevice> (dev)->GetPhy (0)->GetDlSpectrumPhy ();
+      Ptr<AntennaArrayModel> antenna = DynamicCast<AntennaArrayModel> (phy->GetRxAntenna ());
+      const std::string node = std::to_string (dev->GetNode ()->GetId ());
+      const AntennaArrayModel::BeamformingVector current = antenna->GetCurrentBeamformingVector ();
+      std::vector<std::complex<double> > &values = (*state)["antenna " + node];
+      values = current.first;
+      values.push_back (current.second.first);
+      values.push_back (current.second.second);
+      values.push_back (antenna->IsOmniTx () ? 1.0 : 0.0);
+      for (const auto & peer : antenna->GetBeamformingStorage ())
+        {
+          (*state)["antenna " + node + " peer " + std::to_string (peer.first->GetNode ()->GetId ())] =
+            peer.second.first;
+        }
+    }
+}
+
+void
+MmWaveChannelSnapshotRestoreTestCase::RunScenario (const std::string &fileName, bool load, State *state)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (load ? 2 : 1);
+  Config::SetDefault ("ns3::MmWave3gppChannel::UpdatePeriod", TimeValue (MilliSeconds (100)));
+  Config::SetDefault ("ns3::MmWave3gppChannel::BulkUpdate", BooleanValue (false));
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue ("UMi-StreetCanyon"));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::Numerology", UintegerValue (2));
+
+  m_helper = CreateObject<MmWaveHelper> ();
+  m_helper->SetAttribute ("PathlossModel", StringValue ("ns3::MmWave3gppPropagationLossModel"));
+  m_helper->SetAttribute ("ChannelModel", StringValue ("ns3::MmWave3gppChannel"));
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  m_helper->SetEpcHelper (epcHelper);
+  m_helper->Initialize ();
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (2);
+  ueNodes.Create (3);
+
+  Ptr<ListPositionAllocator> gNbPositions = CreateObject<ListPositionAllocator> ();
+  gNbPositions->Add (Vector (0.0, 0.0, 10.0));
+  gNbPositions->Add (Vector (100.0, 0.0, 10.0));
+  Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator> ();
+  uePositions->Add (Vector (20.0, 10.0, 1.5));
+  uePositions->Add (Vector (30.0, -15.0, 1.5));
+  uePositions->Add (Vector (80.0, 20.0, 1.5));
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (gNbPositions);
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator (uePositions);
+  mobility.Install (ueNodes);
+
+  NetDeviceContainer gNbDevs = m_helper->InstallEnbDevice (gNbNodes);
+  NetDeviceContainer ueDevs = m_helper->InstallUeDevice (ueNodes);
+  m_devs = NetDeviceContainer (gNbDevs, ueDevs);
+
+  if (load)
+    {
+      m_helper->LoadChannelSnapshot (fileName);
+      m_helper->AttachToClosestEnb (ueDevs, gNbDevs);
+      Record (state);
+    }
+  else
+    {
+      m_helper->AttachToClosestEnb (ueDevs, gNbDevs);
+      Simulator::Schedule (MilliSeconds (30), &MmWaveChannelSnapshotRestoreTestCase::SaveAndRecord,
+                           this, fileName, state);
+      Simulator::Stop (MilliSeconds (31));
+      Simulator::Run ();
+    }
+
+  m_helper = nullptr;
+  m_devs = NetDeviceContainer ();
+  Simulator::Destroy ();
+}
+
+void
+MmWaveChannelSnapshotRestoreTestCase::DoRun ()
+{
+  const std::string fileName = CreateTempDirFilename ("mmwave-test-channel-snapshot-restore.bin");
+
+  State saved;
+  RunScenario (fileName, false, &saved);
+  State restored;
+  RunScenario (fileName, true, &restored);
+  std::remove (fileName.c_str ());
+
+  NS_TEST_ASSERT_MSG_GT (saved.size (), 0u, "Nothing recorded");
+  NS_TEST_ASSERT_MSG_EQ (restored.size (), saved.size (), "Different number of values after the restore");
+  for (const auto & value : saved)
+    {
+      auto it = restored.find (value.first);
+      NS_TEST_ASSERT_MSG_EQ ((it != restored.end ()), true, "Missing " << value.first << " after the restore");
+      NS_TEST_ASSERT_MSG_EQ ((it->second == value.second), true, "Different " << value.first << " after the restore");
+    }
+}
+
+/**
+ * \brief The channel snapshot test suite
+ */
+class MmWaveChannelSnapshotTestSuite : public TestSuite
+{
+public:
+  MmWaveChannelSnapshotTestSuite () : TestSuite ("mmwave-test-channel-snapshot", UNIT)
+  {
+    AddTestCase (new MmWaveChannelSnapshotTestCase (0, 0), QUICK);
+    AddTestCase (new MmWaveChannelSnapshotTestCase (1, 0), QUICK);
+    AddTestCase (new MmWaveChannelSnapshotTestCase (1, 5), QUICK);
+    AddTestCase (new MmWaveChannelSnapshotTestCase (2, 40), QUICK);
+    AddTestCase (new MmWaveChannelSnapshotRestoreTestCase (), QUICK);
+  }
+};
+
+static MmWaveChannelSnapshotTestSuite mmwaveChannelSnapshotTestSuite; //!< Channel snapshot test suite
+
+} // namespace ns3
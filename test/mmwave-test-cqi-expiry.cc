@@ -0,0 +1,175 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-mac-scheduler-cqi-management.h>
+#include <ns3/mmwave-amc.h>
+#include "mmwave-test-random.h"
+
+/**
+ * \file mmwave-test-cqi-expiry.cc
+ * \ingroup test
+ * \brief Unit-testing the expiration of the CQI in MmWaveMacSchedulerCQIManagement.
+ */
+namespace ns3 {
+
+/**
+ * \brief Compare the CQI expirations of the timing wheel against a per-UE
+ * countdown, decremented every slot
+ *
+ * As in the countdown, the UEs without a valid CQI (not reported yet, or
+ * expired) are reset to the starting MCS in every slot, even if they were
+ * given another MCS (as the scheduler does with a fixed MCS).
+ */
+class MmWaveCqiExpiryTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveCqiExpiryTestCase
+   * \param ueNum number of UE
+   * \param expirationTime validity of a CQI, in slots
+   */
+  MmWaveCqiExpiryTestCase (uint32_t ueNum, uint32_t expirationTime)
+    : TestCase ("CQI expiry with " + std::to_string (ueNum) + " UE and validity of " +
+                std::to_string (expirationTime) + " slots"),
+      m_ueNum (ueNum),
+      m_expirationTime (expirationTime)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_ueNum {0};          //!< Number of UE
+  uint32_t m_expirationTime {0}; //!< Validity of a CQI
+};
+
+void
+MmWaveCqiExpiryTestCase::DoRun ()
+{
+  const uint8_t startMcs = 2;
+  const uint8_t fixedMcs = 27;
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  Ptr<MmWaveAmc> amc = CreateObject<MmWaveAmc> (config);
+  MmWaveMacSchedulerCQIManagement cqiManagement;
+  cqiManagement.ConfigureCommonParameters (config, amc, startMcs, startMcs);
+
+  std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > ueMap;
+  std::vector<uint32_t> timer (m_ueNum + 2, 0);
+  std::vector<bool> valid (m_ueNum + 2, false);
+  for (uint16_t rnti = 1; rnti <= m_ueNum; ++rnti)
+    {
+      auto ue = std::make_shared<MmWaveMacSchedulerUeInfo> (rnti, AntennaArrayModel::BeamId (0, 0.0));
+      ue->m_dlMcs = fixedMcs;
+      ueMap.emplace (rnti, ue);
+      cqiManagement.AddUe (rnti);
+    }
+
+  DlCqiInfo info;
+  info.m_wbCqi = 15;
+  const uint8_t reportedMcs = static_cast<uint8_t> (amc->GetMcsFromCqi (15));
+
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (1);
+  const uint32_t slots = 5 * (m_expirationTime + 1) + 10;
+  uint32_t totalVisited = 0;
+  uint32_t totalReports = 0;
+  uint32_t totalExpired = 0;
+  for (uint32_t slot = 0; slot < slots; ++slot)
+    {
+      // The refresh of the slot, as in the reference model: a CQI is
+      // discarded when its timer is 0, otherwise the timer is decremented
+      uint32_t expectedExpired = 0;
+      uint32_t expectedNoCqi = 0;
+      for (uint16_t rnti = 1; rnti <= m_ueNum + 1; ++rnti)
+        {
+          if (ueMap.find (rnti) == ueMap.end ())
+            {
+              continue;
+            }
+          if (timer[rnti] == 0)
+            {
+              expectedExpired += valid[rnti] ? 1 : 0;
+              expectedNoCqi += valid[rnti] ? 0 : 1;
+              valid[rnti] = false;
+            }
+          else
+            {
+              --timer[rnti];
+            }
+        }
+
+      MmWaveMacSchedulerCQIManagement::RefreshCost cost = cqiManagement.RefreshDlCqiMaps (ueMap);
+      totalVisited += cost.m_visited;
+      totalExpired += cost.m_expired;
+      NS_TEST_ASSERT_MSG_EQ (cost.m_expired, expectedExpired, "Wrong number of expired CQI in slot " << slot);
+      NS_TEST_ASSERT_MSG_EQ (cost.m_noCqi, expectedNoCqi, "Wrong number of UE without CQI in slot " << slot);
+      for (const auto & ue : ueMap)
+        {
+          NS_TEST_ASSERT_MSG_EQ (+ue.second->m_dlMcs, valid[ue.first] ? +reportedMcs : +startMcs,
+                                 "Wrong MCS of UE " << ue.first << " in slot " << slot);
+        }
+
+      // Some UE reports a CQI in this slot
+      for (uint16_t rnti = 1; rnti <= m_ueNum + 1; ++rnti)
+        {
+          if (ueMap.find (rnti) != ueMap.end () && random->GetInteger (0, 3) == 0 && slot + m_expirationTime + 2 < slots)
+            {
+              info.m_rnti = rnti;
+              cqiManagement.DlWBCQIReported (info, ueMap.at (rnti), m_expirationTime);
+              timer[rnti] = m_expirationTime;
+              valid[rnti] = true;
+              ++totalReports;
+            }
+        }
+
+      // One UE leaves in the middle of the test, with its CQI still valid;
+      // another one arrives, and it is reset until it reports a CQI
+      if (slot == slots / 2 && m_ueNum > 1)
+        {
+          ueMap.erase (1);
+          auto ue = std::make_shared<MmWaveMacSchedulerUeInfo> (m_ueNum + 1, AntennaArrayModel::BeamId (0, 0.0));
+          ue->m_dlMcs = fixedMcs;
+          ueMap.emplace (m_ueNum + 1, ue);
+          cqiManagement.AddUe (m_ueNum + 1);
+        }
+    }
+
+  // Every report is visited once, and there is nothing else in the wheel
+  NS_TEST_ASSERT_MSG_EQ (totalVisited, totalReports, "Entries visited more than once, or not visited");
+  // The reports stop before the end, so some CQI expired
+  NS_TEST_ASSERT_MSG_GT (totalReports, 0u, "No CQI reported");
+  NS_TEST_ASSERT_MSG_GT (totalExpired, 0u, "No CQI expired");
+}
+
+/**
+ * \brief The CQI expiry test suite
+ */
+class MmWaveCqiExpiryTestSuite : public TestSuite
+{
+public:
+  MmWaveCqiExpiryTestSuite () : TestSuite ("mmwave-test-cqi-expiry", UNIT)
+  {
+    AddTestCase (new MmWaveCqiExpiryTestCase (1, 0), QUICK);
+    AddTestCase (new MmWaveCqiExpiryTestCase (1, 1), QUICK);
+    AddTestCase (new MmWaveCqiExpiryTestCase (10, 7), QUICK);
+    AddTestCase (new MmWaveCqiExpiryTestCase (100, 80), QUICK);
+  }
+};
+
+static MmWaveCqiExpiryTestSuite mmwaveCqiExpiryTestSuite; //!< CQI expiry test suite
+
+} // namespace ns3
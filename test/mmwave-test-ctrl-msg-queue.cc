@@ -0,0 +1,143 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-ctrl-msg-queue.h>
+#include "mmwave-test-random.h"
+#include <algorithm>
+
+/**
+ * \file mmwave-test-ctrl-msg-queue.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveCtrlMsgQueue class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Compare a MmWaveCtrlMsgQueue against a vector of lists, erased
+ * from the front and extended at the back as the PHY did before
+ */
+class MmWaveCtrlMsgQueueTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveCtrlMsgQueueTestCase
+   * \param depth initial depth of the queue
+   */
+  MmWaveCtrlMsgQueueTestCase (uint32_t depth)
+    : TestCase ("MmWaveCtrlMsgQueue with depth " + std::to_string (depth)),
+      m_depth (depth)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_depth {0}; //!< Initial depth
+};
+
+void
+MmWaveCtrlMsgQueueTestCase::DoRun ()
+{
+  typedef std::list<Ptr<MmWaveControlMessage> > MsgList;
+
+  MmWaveCtrlMsgQueue queue;
+  queue.SetDepth (m_depth);
+  std::vector<MsgList> reference (m_depth);
+
+  // A message for the current slot leaves at the next Pop, one from the MAC
+  // at the Pop of the last slot of the queue (the next one with depth 0)
+  MmWaveCtrlMsgQueue scripted;
+  scripted.SetDepth (m_depth);
+  Ptr<MmWaveControlMessage> delayed = Create<MmWaveBsrMessage> ();
+  Ptr<MmWaveControlMessage> current = Create<MmWaveMibMessage> ();
+  scripted.PushFront (current);
+  scripted.PushBack (delayed);
+  for (uint32_t slot = 0; slot < std::max (m_depth, 1u); ++slot)
+    {
+      MsgList msgs = scripted.Pop ();
+      MsgList expected;
+      if (slot == 0)
+        {
+          expected.push_back (current);
+        }
+      if (slot + 1 == std::max (m_depth, 1u))
+        {
+          expected.push_back (delayed);
+        }
+      NS_TEST_ASSERT_MSG_EQ ((msgs == expected), true, "Wrong scripted messages in slot " << slot);
+    }
+
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (7);
+  for (uint32_t slot = 0; slot < 100; ++slot)
+    {
+      // Some messages from the MAC, and sometimes one for the current slot
+      const uint32_t numMsg = random->GetInteger (0, 3);
+      for (uint32_t i = 0; i < numMsg; ++i)
+        {
+          Ptr<MmWaveControlMessage> msg = Create<MmWaveBsrMessage> ();
+          queue.PushBack (msg);
+          if (reference.empty ())
+            {
+              reference.push_back (MsgList ());
+            }
+          reference.back ().push_back (msg);
+        }
+      if (random->GetInteger (0, 4) == 0)
+        {
+          Ptr<MmWaveControlMessage> msg = Create<MmWaveMibMessage> ();
+          queue.PushFront (msg);
+          if (reference.empty ())
+            {
+              reference.push_back (MsgList ());
+            }
+          reference.front ().push_back (msg);
+        }
+
+      MsgList expected;
+      if (! reference.empty ())
+        {
+          expected = reference.front ();
+          reference.erase (reference.begin ());
+          reference.push_back (MsgList ());
+        }
+
+      MsgList msgs = queue.Pop ();
+      NS_TEST_ASSERT_MSG_EQ (queue.GetDepth (), reference.size (), "Wrong depth in slot " << slot);
+      NS_TEST_ASSERT_MSG_EQ (msgs.size (), expected.size (), "Wrong number of messages in slot " << slot);
+      NS_TEST_ASSERT_MSG_EQ ((msgs == expected), true, "Wrong messages in slot " << slot);
+    }
+}
+
+/**
+ * \brief The MmWaveCtrlMsgQueue test suite
+ */
+class MmWaveCtrlMsgQueueTestSuite : public TestSuite
+{
+public:
+  MmWaveCtrlMsgQueueTestSuite () : TestSuite ("mmwave-test-ctrl-msg-queue", UNIT)
+  {
+    AddTestCase (new MmWaveCtrlMsgQueueTestCase (0), QUICK);
+    AddTestCase (new MmWaveCtrlMsgQueueTestCase (1), QUICK);
+    AddTestCase (new MmWaveCtrlMsgQueueTestCase (2), QUICK);
+    AddTestCase (new MmWaveCtrlMsgQueueTestCase (5), QUICK);
+  }
+};
+
+static MmWaveCtrlMsgQueueTestSuite mmwaveCtrlMsgQueueTestSuite; //!< Control message queue test suite
+
+} // namespace ns3
@@ -0,0 +1,171 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-enb-grid-index.h>
+#include "mmwave-test-random.h"
+#include <cmath>
+#include <limits>
+
+/**
+ * \file mmwave-test-enb-grid-index.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveEnbGridIndex class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Index random gNB positions with a MmWaveEnbGridIndex, and check the
+ * closest one to random points against a linear scan that keeps the first of
+ * the closest (as MmWaveHelper::AttachToClosestEnb did)
+ */
+class MmWaveEnbGridIndexTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveEnbGridIndexTestCase
+   * \param numEnbs number of gNB positions
+   * \param side side of the square area of the gNBs, in m (0 to align them on the x axis)
+   * \param lattice if not 0, the positions are rounded to multiples of it, to have ties
+   * \param cellSize cell size of the index (0 for the automatic one)
+   */
+  MmWaveEnbGridIndexTestCase (uint32_t numEnbs, double side, double lattice, double cellSize)
+    : TestCase ("Grid index of " + std::to_string (numEnbs) + " gNBs over " + std::to_string (static_cast<uint32_t> (side))
+                + " m, lattice " + std::to_string (static_cast<uint32_t> (lattice)) + " m, cells of " + std::to_string (static_cast<uint32_t> (cellSize)) + " m"),
+      m_numEnbs (numEnbs),
+      m_side (side),
+      m_lattice (lattice),
+      m_cellSize (cellSize)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numEnbs {0};  //!< Number of gNBs
+  double m_side {0.0};     //!< Side of the area
+  double m_lattice {0.0};  //!< Rounding of the positions
+  double m_cellSize {0.0}; //!< Cell size of the index
+};
+
+void
+MmWaveEnbGridIndexTestCase::DoRun ()
+{
+  Ptr<UniformRandomVariable> randomVariable = CreateTestRandomVariable (11);
+  auto random = [randomVariable] (double max)
+    {
+      return randomVariable->GetValue (0, max);
+    };
+  auto round = [this] (double value)
+    {
+      return m_lattice > 0 ? m_lattice * std::floor (value / m_lattice) : value;
+    };
+
+  std::vector<Vector> enbs;
+  for (uint32_t i = 0; i < m_numEnbs; ++i)
+    {
+      const double x = round (random (m_side > 0 ? m_side : 1000.0));
+      const double y = m_side > 0 ? round (random (m_side)) : 0.0;
+      enbs.push_back (Vector (x, y, m_lattice > 0 ? 10.0 : 10.0 + random (20.0)));
+    }
+  MmWaveEnbGridIndex index (enbs, m_cellSize);
+  NS_TEST_ASSERT_MSG_EQ (index.GetN (), m_numEnbs, "Wrong number of positions");
+
+  // Points over an area larger than the one of the gNBs
+  const double extent = (m_side > 0 ? m_side : 1000.0) * 1.5;
+  for (uint32_t i = 0; i < 2000; ++i)
+    {
+      const Vector ue (round (random (extent) - extent / 6), round (random (extent) - extent / 6), 1.5);
+      double minDistance = std::numeric_limits<double>::infinity ();
+      uint32_t expected = 0;
+      for (uint32_t j = 0; j < enbs.size (); ++j)
+        {
+          const double distance = CalculateDistance (ue, enbs[j]);
+          if (distance < minDistance)
+            {
+              minDistance = distance;
+              expected = j;
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (index.GetClosest (ue), expected,
+                             "Wrong closest gNB to (" << ue.x << ", " << ue.y << ")");
+    }
+}
+
+/**
+ * \brief Check the closest gNB of some points next to three gNBs, on the
+ * boundaries of their cells and far away from them
+ */
+class MmWaveEnbGridIndexClosestTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveEnbGridIndexClosestTestCase
+   */
+  MmWaveEnbGridIndexClosestTestCase ()
+    : TestCase ("Closest gNB of given points")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+MmWaveEnbGridIndexClosestTestCase::DoRun ()
+{
+  const std::vector<Vector> enbs = {Vector (0.0, 0.0, 10.0), Vector (100.0, 0.0, 10.0), Vector (0.0, 100.0, 25.0)};
+  MmWaveEnbGridIndex index (enbs, 0.0);
+
+  NS_TEST_ASSERT_MSG_EQ (index.GetClosest (Vector (10.0, 10.0, 1.5)), 0u, "Wrong gNB next to the first one");
+  NS_TEST_ASSERT_MSG_EQ (index.GetClosest (Vector (90.0, 5.0, 1.5)), 1u, "Wrong gNB next to the second one");
+  NS_TEST_ASSERT_MSG_EQ (index.GetClosest (Vector (5.0, 90.0, 1.5)), 2u, "Wrong gNB next to the third one");
+  // At the same distance from the first two gNBs: the first one wins
+  NS_TEST_ASSERT_MSG_EQ (index.GetClosest (Vector (50.0, -20.0, 1.5)), 0u, "Tie not won by the first gNB");
+  // The height counts: at the same horizontal distance from the first and
+  // the third gNB, the first one is lower, so it is closer
+  NS_TEST_ASSERT_MSG_EQ (index.GetClosest (Vector (-30.0, 50.0, 1.5)), 0u, "Height of the gNB not considered");
+  // Far away from all the cells
+  NS_TEST_ASSERT_MSG_EQ (index.GetClosest (Vector (5000.0, -100.0, 1.5)), 1u, "Wrong gNB of a point far away");
+  NS_TEST_ASSERT_MSG_EQ (index.GetClosest (Vector (-200.0, 4000.0, 1.5)), 2u, "Wrong gNB of a point far away");
+}
+
+/**
+ * \brief The gNB grid index test suite
+ */
+class MmWaveEnbGridIndexTestSuite : public TestSuite
+{
+public:
+  MmWaveEnbGridIndexTestSuite () : TestSuite ("mmwave-test-enb-grid-index", UNIT)
+  {
+    AddTestCase (new MmWaveEnbGridIndexClosestTestCase (), QUICK);
+    AddTestCase (new MmWaveEnbGridIndexTestCase (1, 500.0, 0.0, 0.0), QUICK);
+    AddTestCase (new MmWaveEnbGridIndexTestCase (7, 500.0, 0.0, 0.0), QUICK);
+    AddTestCase (new MmWaveEnbGridIndexTestCase (300, 5000.0, 0.0, 0.0), QUICK);
+    AddTestCase (new MmWaveEnbGridIndexTestCase (300, 0.0, 0.0, 0.0), QUICK);
+    // Positions and points on a lattice, with many ties
+    AddTestCase (new MmWaveEnbGridIndexTestCase (300, 2000.0, 100.0, 0.0), QUICK);
+    AddTestCase (new MmWaveEnbGridIndexTestCase (300, 2000.0, 100.0, 100.0), QUICK);
+    // Cells much larger and much smaller than the spacing of the gNBs
+    AddTestCase (new MmWaveEnbGridIndexTestCase (300, 5000.0, 0.0, 3000.0), QUICK);
+    AddTestCase (new MmWaveEnbGridIndexTestCase (300, 5000.0, 0.0, 1.0), QUICK);
+  }
+};
+
+static MmWaveEnbGridIndexTestSuite mmwaveEnbGridIndexTestSuite; //!< gNB grid index test suite
+
+} // namespace ns3
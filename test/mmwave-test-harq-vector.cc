@@ -0,0 +1,164 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <ns3/test.h>
+#include <ns3/mmwave-mac-harq-vector.h>
+#include "mmwave-test-random.h"
+
+/**
+ * \file mmwave-test-harq-vector.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveMacHarqVector class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Insert and erase processes in a MmWaveMacHarqVector, checking the
+ * IDs and the active processes against a vector of flags
+ */
+class MmWaveMacHarqVectorTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveMacHarqVectorTestCase
+   * \param size number of HARQ processes
+   */
+  MmWaveMacHarqVectorTestCase (uint8_t size)
+    : TestCase ("MmWaveMacHarqVector with " + std::to_string (size) + " processes"),
+      m_size (size)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint8_t m_size {0}; //!< Number of processes
+};
+
+void
+MmWaveMacHarqVectorTestCase::DoRun ()
+{
+  MmWaveMacHarqVector harq;
+  harq.SetMaxSize (m_size);
+  const MmWaveMacHarqVector::iterator begin = harq.Begin ();
+  const MmWaveMacHarqVector::iterator last = harq.Find (m_size - 1);
+
+  std::vector<bool> active (m_size, false);
+  const HarqProcess element (true, HarqProcess::WAITING_FEEDBACK, 0,
+                             std::make_shared<DciInfoElementTdma> (1, DciInfoElementTdma::DL,
+                                                                   0, 1, 10, 100, 1, 0));
+
+  // Fill the vector: the IDs are given in order, then no insert is possible
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      uint8_t id = UINT8_MAX;
+      NS_TEST_ASSERT_MSG_EQ (harq.Insert (&id, element), true, "Insert failed with " << i << " processes");
+      NS_TEST_ASSERT_MSG_EQ (+id, i, "Wrong ID of the process " << i);
+    }
+  uint8_t fullId = 0;
+  NS_TEST_ASSERT_MSG_EQ (harq.CanInsert (), false, "Insert possible in a full vector");
+  NS_TEST_ASSERT_MSG_EQ (harq.Insert (&fullId, element), false, "Insert in a full vector");
+  NS_TEST_ASSERT_MSG_EQ (harq.Size (), m_size, "Wrong size of a full vector");
+
+  // The ID of an erased process is given again
+  const uint8_t erased = m_size / 2;
+  harq.Erase (erased);
+  NS_TEST_ASSERT_MSG_EQ (harq.Size (), m_size - 1u, "Wrong size after an erase");
+  NS_TEST_ASSERT_MSG_EQ (harq.Insert (&fullId, element), true, "Insert failed after an erase");
+  NS_TEST_ASSERT_MSG_EQ (+fullId, +erased, "ID of the erased process not given again");
+  for (uint8_t id = 0; id < m_size; ++id)
+    {
+      harq.Erase (id);
+    }
+  NS_TEST_ASSERT_MSG_EQ (harq.Size (), 0u, "Processes left after erasing all of them");
+
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (m_size);
+  for (uint32_t i = 0; i < 10000; ++i)
+    {
+      uint32_t activeNum = static_cast<uint32_t> (std::count (active.begin (), active.end (), true));
+
+      if (random->GetInteger (0, 1) == 0)
+        {
+          // Insert: the ID is the lowest inactive one
+          auto expected = std::find (active.begin (), active.end (), false);
+          uint8_t id = 0;
+          bool inserted = harq.Insert (&id, element);
+          NS_TEST_ASSERT_MSG_EQ (inserted, expected != active.end (), "Wrong insert result");
+          if (inserted)
+            {
+              NS_TEST_ASSERT_MSG_EQ (+id, expected - active.begin (), "Wrong ID");
+              NS_TEST_ASSERT_MSG_EQ (harq.Get (id).m_active, true, "Inserted process is not active");
+              active[id] = true;
+            }
+        }
+      else if (activeNum > 0)
+        {
+          // Erase a random active process
+          uint32_t n = random->GetInteger (0, activeNum - 1);
+          uint8_t id = 0;
+          while (! active[id] || n-- > 0)
+            {
+              ++id;
+            }
+          harq.Erase (id);
+          NS_TEST_ASSERT_MSG_EQ (harq.Get (id).m_active, false, "Erased process is active");
+          active[id] = false;
+        }
+
+      activeNum = static_cast<uint32_t> (std::count (active.begin (), active.end (), true));
+      NS_TEST_ASSERT_MSG_EQ (harq.Size (), activeNum, "Wrong size");
+      NS_TEST_ASSERT_MSG_EQ (harq.CanInsert (), activeNum < m_size, "Wrong CanInsert");
+
+      uint32_t visited = 0;
+      int32_t lastId = -1;
+      harq.ForEachActive ([&] (uint8_t id, HarqProcess &)
+                          {
+                            NS_TEST_EXPECT_MSG_EQ (active[id], true, "Inactive process " << +id << " visited");
+                            NS_TEST_EXPECT_MSG_GT (id, lastId, "Processes not visited in order");
+                            lastId = id;
+                            ++visited;
+                          });
+      NS_TEST_ASSERT_MSG_EQ (visited, activeNum, "Wrong number of active processes visited");
+    }
+
+  // The storage never moves
+  NS_TEST_ASSERT_MSG_EQ ((harq.Begin () == begin), true, "Begin iterator moved");
+  NS_TEST_ASSERT_MSG_EQ ((harq.Find (m_size - 1) == last), true, "Iterator moved");
+  NS_TEST_ASSERT_MSG_EQ (+last->first, m_size - 1, "Wrong ID in the iterator");
+  NS_TEST_ASSERT_MSG_EQ ((harq.Find (m_size) == harq.End ()), true, "Find of a non-existent ID");
+  NS_TEST_ASSERT_MSG_EQ (harq.Exist (m_size), false, "Non-existent ID exists");
+}
+
+/**
+ * \brief The MmWaveMacHarqVector test suite
+ */
+class MmWaveMacHarqVectorTestSuite : public TestSuite
+{
+public:
+  MmWaveMacHarqVectorTestSuite () : TestSuite ("mmwave-test-harq-vector", UNIT)
+  {
+    for (uint8_t size : {1, 16, 20, 64, 65, 255})
+      {
+        AddTestCase (new MmWaveMacHarqVectorTestCase (size), QUICK);
+      }
+  }
+};
+
+static MmWaveMacHarqVectorTestSuite mmwaveMacHarqVectorTestSuite; //!< MmWaveMacHarqVector test suite
+
+} // namespace ns3
@@ -0,0 +1,158 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-lc-dispatch-table.h>
+#include "mmwave-test-random.h"
+#include <map>
+
+/**
+ * \file mmwave-test-lc-dispatch-table.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveLcDispatchTable class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Compare a MmWaveLcDispatchTable against the nested std::map that
+ * the MAC used before, with UEs and LCs added and released at random
+ */
+class MmWaveLcDispatchTableTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveLcDispatchTableTestCase
+   * \param maxRnti highest RNTI used in the test
+   */
+  MmWaveLcDispatchTableTestCase (uint16_t maxRnti)
+    : TestCase ("MmWaveLcDispatchTable with RNTI up to " + std::to_string (maxRnti)),
+      m_maxRnti (maxRnti)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint16_t m_maxRnti {0}; //!< Highest RNTI
+};
+
+void
+MmWaveLcDispatchTableTestCase::DoRun ()
+{
+  MmWaveLcDispatchTable table;
+  std::map<uint16_t, std::map<uint8_t, uint8_t> > reference; // RNTI -> LCID -> QCI
+  uint32_t maxUes = 0;
+
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (3);
+  for (uint32_t op = 0; op < 5000; ++op)
+    {
+      const uint16_t rnti = static_cast<uint16_t> (random->GetInteger (1, m_maxRnti));
+      const uint8_t lcid = static_cast<uint8_t> (random->GetInteger (0, MmWaveLcDispatchTable::MAX_LCID - 1));
+      const uint8_t qci = static_cast<uint8_t> (random->GetInteger (1, 9));
+      switch (random->GetInteger (0, 3))
+        {
+        case 0:
+          NS_TEST_ASSERT_MSG_EQ (table.AddUe (rnti), reference.find (rnti) == reference.end (),
+                                 "Wrong result of AddUe for " << rnti);
+          reference[rnti];
+          break;
+        case 1:
+          if (random->GetInteger (0, 7) == 0)
+            {
+              table.RemoveUe (rnti);
+              reference.erase (rnti);
+            }
+          else if (reference.find (rnti) != reference.end ())
+            {
+              table.ReleaseLc (rnti, lcid);
+              reference[rnti].erase (lcid);
+            }
+          break;
+        default:
+          if (reference.find (rnti) != reference.end ())
+            {
+              bool created = false;
+              MmWaveLcDispatchTable::Entry &entry = table.AddLc (rnti, lcid, &created);
+              NS_TEST_ASSERT_MSG_EQ (created, reference[rnti].find (lcid) == reference[rnti].end (),
+                                     "Wrong result of AddLc for " << rnti << " " << +lcid);
+              NS_TEST_ASSERT_MSG_EQ (+entry.m_lcid, +lcid, "Wrong LCID in the entry");
+              if (created)
+                {
+                  entry.m_hasQos = true;
+                  entry.m_qci = qci;
+                  reference[rnti][lcid] = qci;
+                }
+            }
+          break;
+        }
+      maxUes = std::max (maxUes, static_cast<uint32_t> (reference.size ()));
+
+      // The table has exactly the UEs and LCs of the reference
+      std::vector<uint16_t> ues;
+      for (const auto & ue : reference)
+        {
+          ues.push_back (ue.first);
+        }
+      NS_TEST_ASSERT_MSG_EQ ((table.GetUes () == ues), true, "Wrong UEs after operation " << op);
+      for (uint16_t r = 0; r <= m_maxRnti + 1; ++r)
+        {
+          auto ueIt = reference.find (r);
+          NS_TEST_ASSERT_MSG_EQ (table.HasUe (r), ueIt != reference.end (), "Wrong presence of UE " << r);
+          for (uint8_t l = 0; l < MmWaveLcDispatchTable::MAX_LCID; ++l)
+            {
+              const MmWaveLcDispatchTable::Entry *entry = table.Find (r, l);
+              const bool expected = ueIt != reference.end () && ueIt->second.find (l) != ueIt->second.end ();
+              NS_TEST_ASSERT_MSG_EQ ((entry != nullptr), expected, "Wrong presence of LC " << r << " " << +l);
+              if (expected)
+                {
+                  NS_TEST_ASSERT_MSG_EQ (+entry->m_qci, +ueIt->second.at (l), "Wrong QCI of LC " << r << " " << +l);
+                }
+
+              // FindFirst returns the first LC not lower than l, as a map lower_bound
+              const MmWaveLcDispatchTable::Entry *first = table.FindFirst (r, l);
+              if (ueIt == reference.end () || ueIt->second.lower_bound (l) == ueIt->second.end ())
+                {
+                  NS_TEST_ASSERT_MSG_EQ ((first == nullptr), true, "FindFirst found a LC that does not exist");
+                }
+              else
+                {
+                  NS_TEST_ASSERT_MSG_EQ ((first != nullptr), true, "FindFirst did not find a LC");
+                  NS_TEST_ASSERT_MSG_EQ (+first->m_lcid, +ueIt->second.lower_bound (l)->first, "Wrong LC found by FindFirst");
+                }
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (maxUes, 0, "The test did not add any UE");
+}
+
+/**
+ * \brief The MmWaveLcDispatchTable test suite
+ */
+class MmWaveLcDispatchTableTestSuite : public TestSuite
+{
+public:
+  MmWaveLcDispatchTableTestSuite () : TestSuite ("mmwave-test-lc-dispatch-table", UNIT)
+  {
+    AddTestCase (new MmWaveLcDispatchTableTestCase (1), QUICK);
+    AddTestCase (new MmWaveLcDispatchTableTestCase (10), QUICK);
+    AddTestCase (new MmWaveLcDispatchTableTestCase (300), QUICK);
+  }
+};
+
+static MmWaveLcDispatchTableTestSuite mmwaveLcDispatchTableTestSuite; //!< LC dispatch table test suite
+
+} // namespace ns3
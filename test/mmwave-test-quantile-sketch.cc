@@ -0,0 +1,183 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-quantile-sketch.h>
+#include "mmwave-test-random.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * \file mmwave-test-quantile-sketch.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveQuantileSketch class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Add random values to a MmWaveQuantileSketch, and check its
+ * statistics and percentiles against the exact ones
+ */
+class MmWaveQuantileSketchTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveQuantileSketchTestCase
+   * \param numValues number of values
+   * \param decades the values are spread (log-uniformly) over this number of decades
+   * \param zeros one value out of this number is 0 (0 for none)
+   * \param maxBuckets maximum number of buckets of the sketch
+   */
+  MmWaveQuantileSketchTestCase (uint32_t numValues, uint32_t decades, uint32_t zeros, uint32_t maxBuckets)
+    : TestCase ("Quantile sketch with " + std::to_string (numValues) + " values over "
+                + std::to_string (decades) + " decades, zeros every " + std::to_string (zeros)
+                + ", and at most " + std::to_string (maxBuckets) + " buckets"),
+      m_numValues (numValues),
+      m_decades (decades),
+      m_zeros (zeros),
+      m_maxBuckets (maxBuckets)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numValues {0};  //!< Number of values
+  uint32_t m_decades {0};    //!< Decades of the values
+  uint32_t m_zeros {0};      //!< Period of the zeros
+  uint32_t m_maxBuckets {0}; //!< Maximum number of buckets
+};
+
+void
+MmWaveQuantileSketchTestCase::DoRun ()
+{
+  const double accuracy = 0.01;
+  MmWaveQuantileSketch sketch (accuracy, m_maxBuckets);
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetQuantile (0.5), 0.0, "Quantile of an empty sketch");
+
+  std::vector<double> values;
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (7);
+  double sum = 0.0;
+  for (uint32_t i = 0; i < m_numValues; ++i)
+    {
+      double value = std::pow (10.0, random->GetValue (0, m_decades));
+      if (m_zeros > 0 && i % m_zeros == 0)
+        {
+          value = 0.0;
+        }
+      values.push_back (value);
+      sum += value;
+      sketch.Add (value);
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (sketch.GetNumBuckets (), m_maxBuckets, "Too many buckets");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), m_numValues, "Wrong count");
+
+  std::sort (values.begin (), values.end ());
+  const double mean = sum / m_numValues;
+  double squares = 0.0;
+  for (double v : values)
+    {
+      squares += (v - mean) * (v - mean);
+    }
+  const double stddev = m_numValues > 1 ? std::sqrt (squares / (m_numValues - 1)) : 0.0;
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetMean (), mean, mean * 1e-9, "Wrong mean");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetStddev (), stddev, stddev * 1e-6 + 1e-12, "Wrong standard deviation");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMin (), values.front (), "Wrong minimum");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMax (), values.back (), "Wrong maximum");
+
+  // Without merged buckets, all the quantiles are within the accuracy; with
+  // them, only the high ones
+  const bool merged = std::log (values.back () / values[values.size () / 2])
+    / std::log ((1 + accuracy) / (1 - accuracy)) + 2 > m_maxBuckets;
+  for (double q : {0.0, 0.25, 0.5, 0.9, 0.95, 0.99, 1.0})
+    {
+      if (merged && q < 0.9)
+        {
+          continue;
+        }
+      const double exact = values[static_cast<size_t> (q * (m_numValues - 1))];
+      NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (q), exact, exact * accuracy * (1 + 1e-9),
+                                 "Wrong quantile " << q);
+    }
+
+  sketch.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 0, "Values left after Clear");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetNumBuckets (), 0, "Buckets left after Clear");
+}
+
+/**
+ * \brief Add the integers from 1 to 100 to a MmWaveQuantileSketch, and check
+ * its statistics and percentiles
+ */
+class MmWaveQuantileSketchIntegersTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveQuantileSketchIntegersTestCase
+   */
+  MmWaveQuantileSketchIntegersTestCase ()
+    : TestCase ("Quantile sketch of the integers from 1 to 100")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+MmWaveQuantileSketchIntegersTestCase::DoRun ()
+{
+  const double accuracy = 0.01;
+  MmWaveQuantileSketch sketch (accuracy, 1024);
+  // In decreasing order: the order of the values must not matter
+  for (uint32_t i = 100; i > 0; --i)
+    {
+      sketch.Add (i);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 100u, "Wrong count");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMin (), 1.0, "Wrong minimum");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMax (), 100.0, "Wrong maximum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetMean (), 50.5, 1e-9, "Wrong mean");
+  // Sample standard deviation of 1..100: sqrt (100 * 101 / 12)
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetStddev (), std::sqrt (100.0 * 101.0 / 12.0), 1e-6, "Wrong standard deviation");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.5), 50.0, 50.0 * accuracy, "Wrong median");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.95), 95.0, 95.0 * accuracy, "Wrong 95th percentile");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.99), 99.0, 99.0 * accuracy, "Wrong 99th percentile");
+}
+
+/**
+ * \brief The quantile sketch test suite
+ */
+class MmWaveQuantileSketchTestSuite : public TestSuite
+{
+public:
+  MmWaveQuantileSketchTestSuite () : TestSuite ("mmwave-test-quantile-sketch", UNIT)
+  {
+    AddTestCase (new MmWaveQuantileSketchIntegersTestCase (), QUICK);
+    AddTestCase (new MmWaveQuantileSketchTestCase (1, 3, 0, 1024), QUICK);
+    AddTestCase (new MmWaveQuantileSketchTestCase (1000, 3, 0, 1024), QUICK);
+    AddTestCase (new MmWaveQuantileSketchTestCase (100000, 6, 0, 1024), QUICK);
+    AddTestCase (new MmWaveQuantileSketchTestCase (10000, 4, 10, 1024), QUICK);
+    // Six decades need about 700 buckets: the lowest ones are merged
+    AddTestCase (new MmWaveQuantileSketchTestCase (100000, 6, 0, 128), QUICK);
+  }
+};
+
+static MmWaveQuantileSketchTestSuite mmwaveQuantileSketchTestSuite; //!< Quantile sketch test suite
+
+} // namespace ns3
@@ -0,0 +1,54 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <ns3/random-variable-stream.h>
+#include <ns3/rng-seed-manager.h>
+
+/**
+ * \file mmwave-test-random.h
+ * \ingroup test
+ * \brief Random values of the unit tests.
+ */
+namespace ns3 {
+
+/**
+ * \brief Create the random variable of a test
+ * \param stream the stream of the variable
+ * \return a UniformRandomVariable with seed 1, run 1 and the stream
+ *
+ * The stream of the variable is created with seed 1 and run 1, so the
+ * variable draws the same values in every execution of the test. The seed
+ * and the run of the test runner are restored before returning, so the
+ * other variables and the tests that run later keep them.
+ */
+inline Ptr<UniformRandomVariable>
+CreateTestRandomVariable (int64_t stream)
+{
+  const uint32_t seed = RngSeedManager::GetSeed ();
+  const uint64_t run = RngSeedManager::GetRun ();
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (stream);
+  RngSeedManager::SetSeed (seed);
+  RngSeedManager::SetRun (run);
+  return random;
+}
+
+} // namespace ns3
@@ -0,0 +1,142 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <algorithm>
+#include <ns3/test.h>
+#include <ns3/mmwave-rbg-bitmask.h>
+
+/**
+ * \file mmwave-test-rbg-bitmask.cc
+ * \ingroup test
+ * \brief Unit-testing the RbgBitmask class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Compare the RbgBitmask operations against a vector of bytes
+ */
+class RbgBitmaskTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create RbgBitmaskTestCase
+   * \param size number of bits of the bitmasks
+   */
+  RbgBitmaskTestCase (uint32_t size)
+    : TestCase ("RbgBitmask with " + std::to_string (size) + " bits"),
+      m_size (size)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_size {0}; //!< Number of bits
+};
+
+void
+RbgBitmaskTestCase::DoRun ()
+{
+  // A pattern with runs of different lengths, crossing the word boundaries
+  std::vector<uint8_t> a (m_size, 0);
+  std::vector<uint8_t> b (m_size, 0);
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      a[i] = (i % 7 < 3) ? 1 : 0;
+      b[i] = (i % 5 == 0) ? 1 : 0;
+    }
+
+  RbgBitmask maskA (a);
+  RbgBitmask maskB (b);
+  NS_TEST_ASSERT_MSG_EQ (maskA.Size (), m_size, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ ((maskA.ToVector () == a), true, "Wrong conversion from/to vector");
+  NS_TEST_ASSERT_MSG_EQ (maskA.Count (),
+                         static_cast<uint32_t> (std::count (a.begin (), a.end (), 1)),
+                         "Wrong count");
+
+  // OR and AND
+  bool intersects = false;
+  std::vector<uint8_t> orVector (m_size);
+  std::vector<uint8_t> andVector (m_size);
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      orVector[i] = a[i] | b[i];
+      andVector[i] = a[i] & b[i];
+      intersects |= andVector[i] != 0;
+    }
+  NS_TEST_ASSERT_MSG_EQ (((maskA | maskB).ToVector () == orVector), true, "Wrong OR");
+  NS_TEST_ASSERT_MSG_EQ (((maskA & maskB).ToVector () == andVector), true, "Wrong AND");
+  NS_TEST_ASSERT_MSG_EQ (maskA.Intersects (maskB), intersects, "Wrong intersection");
+
+  // Iteration over the bits and over the runs
+  std::vector<uint8_t> fromBits (m_size, 0);
+  maskA.ForEachSetBit ([&fromBits] (uint32_t i)
+                       {
+                         fromBits[i] = 1;
+                       });
+  NS_TEST_ASSERT_MSG_EQ ((fromBits == a), true, "Wrong iteration over the bits");
+
+  std::vector<uint8_t> fromRuns (m_size, 0);
+  uint32_t lastEnd = 0;
+  bool separated = true;
+  maskA.ForEachRun ([&fromRuns, &lastEnd, &separated] (uint32_t start, uint32_t end)
+                    {
+                      separated &= (lastEnd == 0 || start > lastEnd);
+                      std::fill (fromRuns.begin () + start, fromRuns.begin () + end, 1);
+                      lastEnd = end;
+                    });
+  NS_TEST_ASSERT_MSG_EQ ((fromRuns == a), true, "Wrong iteration over the runs");
+  NS_TEST_ASSERT_MSG_EQ (separated, true, "Two consecutive runs are adjacent");
+
+  // Expansion to RB
+  const uint32_t rbPerRbg = 4;
+  RbgBitmask rb = maskA.ExpandToRb (rbPerRbg, m_size * rbPerRbg + 1);
+  NS_TEST_ASSERT_MSG_EQ (rb.Size (), m_size * rbPerRbg + 1, "Wrong RB bitmask size");
+  NS_TEST_ASSERT_MSG_EQ (rb.Count (), maskA.Count () * rbPerRbg, "Wrong RB count");
+  for (uint32_t i = 0; i < rb.Size () - 1; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (rb.Test (i), a[i / rbPerRbg] == 1, "Wrong RB " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (rb.Test (rb.Size () - 1), false, "RB outside any RBG is set");
+
+  // Full and empty masks
+  RbgBitmask full (m_size, true);
+  NS_TEST_ASSERT_MSG_EQ (full.All (), true, "Full bitmask is not full");
+  NS_TEST_ASSERT_MSG_EQ (full.Count (), m_size, "Wrong count of the full bitmask");
+  full.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (full.None (), true, "Bitmask not empty after Reset");
+  NS_TEST_ASSERT_MSG_EQ (full.FindFirst (), m_size, "FindFirst on an empty bitmask");
+}
+
+/**
+ * \brief The RbgBitmask test suite
+ */
+class RbgBitmaskTestSuite : public TestSuite
+{
+public:
+  RbgBitmaskTestSuite () : TestSuite ("mmwave-test-rbg-bitmask", UNIT)
+  {
+    for (uint32_t size : {1, 17, 50, 64, 66, 68, 275, 555})
+      {
+        AddTestCase (new RbgBitmaskTestCase (size), QUICK);
+      }
+  }
+};
+
+static RbgBitmaskTestSuite rbgBitmaskTestSuite; //!< RbgBitmask test suite
+
+} // namespace ns3
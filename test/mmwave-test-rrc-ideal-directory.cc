@@ -0,0 +1,253 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/mmwave-helper.h>
+#include <ns3/mmwave-point-to-point-epc-helper.h>
+#include <ns3/mmwave-enb-net-device.h>
+#include <ns3/mmwave-ue-net-device.h>
+#include <ns3/mmwave-rrc-protocol-ideal.h>
+#include <ns3/lte-enb-rrc.h>
+#include <ns3/lte-ue-rrc.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+/**
+ * \file mmwave-test-rrc-ideal-directory.cc
+ * \ingroup test
+ * \brief Unit-testing the directory of the ideal RRC protocols.
+ */
+namespace ns3 {
+
+/**
+ * \brief Run a scenario with two gNBs and two UEs, hand the first UE over to
+ * the cell of the second one, and check:
+ *
+ * - that the system information reaches the UEs in their cell after the
+ *   attach, and in the target cell after the handover;
+ * - that the directory follows the UEs across the handover;
+ * - that the protocols leave the directory when they are disposed;
+ * - that the directory is cleared at Simulator::Destroy, even of the
+ *   protocols that are still alive.
+ */
+class MmWaveRrcIdealDirectoryTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveRrcIdealDirectoryTestCase
+   */
+  MmWaveRrcIdealDirectoryTestCase ()
+    : TestCase ("Directory of the ideal RRC protocols, at attach, handover and dispose")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Sink of Sib2Received of the UEs: record the cell of the SIB2
+   * \param imsi the IMSI of the UE
+   * \param cellId the cell of the UE
+   * \param rnti the RNTI of the UE
+   */
+  void Sib2Received (uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+  /**
+   * \brief Sink of HandoverEndOk of the UEs: record the end of the handover
+   * \param imsi the IMSI of the UE
+   * \param cellId the target cell
+   * \param rnti the RNTI of the UE in the target cell
+   */
+  void HandoverEndOk (uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+  /**
+   * \brief Hand the first UE over to the second cell
+   */
+  void StartHandover ();
+
+  NetDeviceContainer m_gNbDevs; //!< gNB devices
+  NetDeviceContainer m_ueDevs;  //!< UE devices
+  Time m_handoverEnd;           //!< End of the handover, zero if not ended
+  //! Cells of the SIB2 received by each IMSI before the end of the handover
+  std::map<uint64_t, std::set<uint16_t> > m_sibCellsBefore;
+  //! Cells of the SIB2 received by each IMSI after the end of the handover
+  std::map<uint64_t, std::set<uint16_t> > m_sibCellsAfter;
+};
+
+void
+MmWaveRrcIdealDirectoryTestCase::Sib2Received (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  if (m_handoverEnd.IsZero ())
+    {
+      m_sibCellsBefore[imsi].insert (cellId);
+    }
+  else
+    {
+      m_sibCellsAfter[imsi].insert (cellId);
+    }
+}
+
+void
+MmWaveRrcIdealDirectoryTestCase::HandoverEndOk (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  m_handoverEnd = Simulator::Now ();
+}
+
+void
+MmWaveRrcIdealDirectoryTestCase::StartHandover ()
+{
+  Ptr<MmWaveEnbNetDevice> source = DynamicCast<MmWaveEnbNetDevice> (m_gNbDevs.Get (0));
+  Ptr<MmWaveEnbNetDevice> target = DynamicCast<MmWaveEnbNetDevice> (m_gNbDevs.Get (1));
+  Ptr<LteUeRrc> ueRrc = DynamicCast<MmWaveUeNetDevice> (m_ueDevs.Get (0))->GetRrc ();
+  NS_TEST_ASSERT_MSG_EQ (ueRrc->GetCellId (), source->GetCellId (), "The first UE is not in the first cell");
+  source->GetRrc ()->SendHandoverRequest (ueRrc->GetRnti (), target->GetCellId ());
+}
+
+void
+MmWaveRrcIdealDirectoryTestCase::DoRun ()
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue ("UMi-StreetCanyon"));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::Numerology", UintegerValue (2));
+
+  Ptr<MmWaveHelper> mmWaveHelper = CreateObject<MmWaveHelper> ();
+  mmWaveHelper->SetAttribute ("PathlossModel", StringValue ("ns3::MmWave3gppPropagationLossModel"));
+  mmWaveHelper->SetAttribute ("ChannelModel", StringValue ("ns3::MmWave3gppChannel"));
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  mmWaveHelper->SetEpcHelper (epcHelper);
+  mmWaveHelper->Initialize ();
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (2);
+  ueNodes.Create (2);
+
+  Ptr<ListPositionAllocator> gNbPositions = CreateObject<ListPositionAllocator> ();
+  gNbPositions->Add (Vector (0.0, 0.0, 10.0));
+  gNbPositions->Add (Vector (100.0, 0.0, 10.0));
+  Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator> ();
+  uePositions->Add (Vector (45.0, 10.0, 1.5));
+  uePositions->Add (Vector (80.0, -10.0, 1.5));
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (gNbPositions);
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator (uePositions);
+  mobility.Install (ueNodes);
+
+  m_gNbDevs = mmWaveHelper->InstallEnbDevice (gNbNodes);
+  m_ueDevs = mmWaveHelper->InstallUeDevice (ueNodes);
+  epcHelper->AddX2Interface (gNbNodes.Get (0), gNbNodes.Get (1));
+
+  for (uint32_t i = 0; i < m_ueDevs.GetN (); ++i)
+    {
+      Ptr<LteUeRrc> ueRrc = DynamicCast<MmWaveUeNetDevice> (m_ueDevs.Get (i))->GetRrc ();
+      ueRrc->TraceConnectWithoutContext ("Sib2Received",
+                                         MakeCallback (&MmWaveRrcIdealDirectoryTestCase::Sib2Received, this));
+      ueRrc->TraceConnectWithoutContext ("HandoverEndOk",
+                                         MakeCallback (&MmWaveRrcIdealDirectoryTestCase::HandoverEndOk, this));
+    }
+
+  mmWaveHelper->AttachToClosestEnb (m_ueDevs, m_gNbDevs);
+
+  // A protocol that is not disposed by Simulator::Destroy
+  const uint16_t aliveCellId = 1000;
+  Ptr<MmWaveEnbRrcProtocolIdeal> aliveProtocol = CreateObject<MmWaveEnbRrcProtocolIdeal> ();
+  aliveProtocol->SetCellId (aliveCellId);
+  NS_TEST_ASSERT_MSG_EQ (MmWaveEnbRrcProtocolIdeal::GetDirectoryEnb (aliveCellId), aliveProtocol,
+                         "The protocol is not in the directory after SetCellId");
+
+  Simulator::Schedule (MilliSeconds (100), &MmWaveRrcIdealDirectoryTestCase::StartHandover, this);
+  Simulator::Stop (MilliSeconds (400));
+  Simulator::Run ();
+
+  Ptr<MmWaveEnbNetDevice> source = DynamicCast<MmWaveEnbNetDevice> (m_gNbDevs.Get (0));
+  Ptr<MmWaveEnbNetDevice> target = DynamicCast<MmWaveEnbNetDevice> (m_gNbDevs.Get (1));
+  Ptr<MmWaveUeNetDevice> movedUe = DynamicCast<MmWaveUeNetDevice> (m_ueDevs.Get (0));
+  Ptr<MmWaveUeNetDevice> staticUe = DynamicCast<MmWaveUeNetDevice> (m_ueDevs.Get (1));
+  const uint16_t sourceCellId = source->GetCellId ();
+  const uint16_t targetCellId = target->GetCellId ();
+  const uint64_t movedImsi = movedUe->GetImsi ();
+  const uint64_t staticImsi = staticUe->GetImsi ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_handoverEnd.IsZero (), false, "The handover did not end");
+  NS_TEST_EXPECT_MSG_EQ (movedUe->GetRrc ()->GetCellId (), targetCellId, "The UE is not in the target cell");
+
+  // The SIB2 after the attach
+  NS_TEST_EXPECT_MSG_EQ (m_sibCellsBefore[movedImsi].count (sourceCellId), 1u,
+                         "The moved UE did not get the SIB2 of its cell after the attach");
+  NS_TEST_EXPECT_MSG_EQ (m_sibCellsBefore[staticImsi].count (targetCellId), 1u,
+                         "The static UE did not get the SIB2 of its cell after the attach");
+  // The SIB2 after the handover
+  NS_TEST_EXPECT_MSG_EQ ((m_sibCellsAfter[movedImsi] == std::set<uint16_t> {targetCellId}), true,
+                         "The moved UE did not get the SIB2 of the target cell only after the handover");
+  NS_TEST_EXPECT_MSG_EQ ((m_sibCellsAfter[staticImsi] == std::set<uint16_t> {targetCellId}), true,
+                         "The static UE did not get the SIB2 of its cell only after the handover");
+
+  // The directory after the handover
+  NS_TEST_EXPECT_MSG_EQ (MmWaveEnbRrcProtocolIdeal::GetDirectoryUes (sourceCellId).empty (), true,
+                         "The moved UE is still in the source cell of the directory");
+  const std::vector<uint64_t> targetUes = MmWaveEnbRrcProtocolIdeal::GetDirectoryUes (targetCellId);
+  NS_TEST_EXPECT_MSG_EQ ((targetUes == std::vector<uint64_t> {std::min (movedImsi, staticImsi),
+                                                               std::max (movedImsi, staticImsi)}),
+                         true, "The UEs of the target cell in the directory are wrong");
+  NS_TEST_EXPECT_MSG_EQ (MmWaveEnbRrcProtocolIdeal::GetDirectoryEnb (sourceCellId),
+                         source->GetRrc ()->GetObject<MmWaveEnbRrcProtocolIdeal> (),
+                         "Wrong eNB of the source cell in the directory");
+
+  // The disposed protocols leave the directory
+  staticUe->Dispose ();
+  NS_TEST_EXPECT_MSG_EQ ((MmWaveEnbRrcProtocolIdeal::GetDirectoryUes (targetCellId) == std::vector<uint64_t> {movedImsi}),
+                         true, "The disposed UE is still in the directory");
+  source->Dispose ();
+  NS_TEST_EXPECT_MSG_EQ ((MmWaveEnbRrcProtocolIdeal::GetDirectoryEnb (sourceCellId) == nullptr), true,
+                         "The disposed eNB is still in the directory");
+
+  m_gNbDevs = NetDeviceContainer ();
+  m_ueDevs = NetDeviceContainer ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ ((MmWaveEnbRrcProtocolIdeal::GetDirectoryEnb (aliveCellId) == nullptr), true,
+                         "The directory is not cleared at Simulator::Destroy");
+  NS_TEST_EXPECT_MSG_EQ ((MmWaveEnbRrcProtocolIdeal::GetDirectoryEnb (targetCellId) == nullptr), true,
+                         "The target eNB is still in the directory after Simulator::Destroy");
+  NS_TEST_EXPECT_MSG_EQ (MmWaveEnbRrcProtocolIdeal::GetDirectoryUes (targetCellId).empty (), true,
+                         "The moved UE is still in the directory after Simulator::Destroy");
+}
+
+/**
+ * \brief The ideal RRC directory test suite
+ */
+class MmWaveRrcIdealDirectoryTestSuite : public TestSuite
+{
+public:
+  MmWaveRrcIdealDirectoryTestSuite () : TestSuite ("mmwave-test-rrc-ideal-directory", SYSTEM)
+  {
+    AddTestCase (new MmWaveRrcIdealDirectoryTestCase (), QUICK);
+  }
+};
+
+static MmWaveRrcIdealDirectoryTestSuite mmwaveRrcIdealDirectoryTestSuite; //!< Ideal RRC directory test suite
+
+} // namespace ns3
@@ -0,0 +1,149 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-slot-ring.h>
+#include <limits>
+
+/**
+ * \file mmwave-test-slot-ring.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveSlotRing class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Insert, find, expire and erase slots in a MmWaveSlotRing
+ */
+class MmWaveSlotRingTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveSlotRingTestCase
+   * \param slotsPerSubframe slots per subframe (depends on the numerology)
+   */
+  MmWaveSlotRingTestCase (uint32_t slotsPerSubframe)
+    : TestCase ("MmWaveSlotRing with " + std::to_string (slotsPerSubframe) + " slots per subframe"),
+      m_slotsPerSubframe (slotsPerSubframe)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_slotsPerSubframe {1}; //!< Slots per subframe
+};
+
+void
+MmWaveSlotRingTestCase::DoRun ()
+{
+  const uint32_t subframesPerFrame = 10;
+  const uint32_t lookahead = 6;
+  MmWaveSlotRing<uint32_t> ring;
+  ring.Configure (lookahead, m_slotsPerSubframe, subframesPerFrame);
+
+  NS_TEST_ASSERT_MSG_EQ (ring.GetCapacity (), 8, "Capacity is not the next power of two");
+  NS_TEST_ASSERT_MSG_EQ (ring.Size (), 0, "Ring is not empty after Configure");
+
+  // Walk over several frames, keeping always lookahead slots in the ring
+  SfnSf head (0, 0, 0, 0);
+  SfnSf tail (0, 0, 0, 0);
+  uint32_t value = 0;
+  for (uint32_t i = 0; i < lookahead; ++i)
+    {
+      ring.Insert (head, value++);
+      head.Add (1, m_slotsPerSubframe, subframesPerFrame);
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.Size (), lookahead, "Wrong number of elements");
+
+  uint32_t expected = 0;
+  for (uint32_t i = 0; i < 3 * subframesPerFrame * m_slotsPerSubframe; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ring.Contains (tail), true, "Slot " << tail << " not found");
+      NS_TEST_ASSERT_MSG_EQ (ring.Contains (head), false, "Slot " << head << " already there");
+      NS_TEST_ASSERT_MSG_EQ (ring.Extract (tail), expected++, "Wrong value for " << tail);
+      NS_TEST_ASSERT_MSG_EQ (ring.Erase (tail), false, "Slot " << tail << " erased twice");
+
+      ring.Insert (head, value++);
+      head.Add (1, m_slotsPerSubframe, subframesPerFrame);
+      tail.Add (1, m_slotsPerSubframe, subframesPerFrame);
+      NS_TEST_ASSERT_MSG_EQ (ring.Size (), lookahead, "Wrong number of elements");
+    }
+
+  // varTti is not part of the key
+  SfnSf withVarTti = tail;
+  withVarTti.m_varTtiNum = 5;
+  NS_TEST_ASSERT_MSG_EQ (*ring.Find (withVarTti), expected, "VarTti is considered in the key");
+
+  // An element not consumed in time is overwritten by the slot that takes its cell
+  SfnSf expired = tail;
+  SfnSf future = tail;
+  future.Add (ring.GetCapacity (), m_slotsPerSubframe, subframesPerFrame);
+  ring.Insert (future, 999);
+  NS_TEST_ASSERT_MSG_EQ (ring.Contains (expired), false, "Expired slot still present");
+  NS_TEST_ASSERT_MSG_EQ (ring.At (future), 999, "Wrong value for the future slot");
+  NS_TEST_ASSERT_MSG_EQ (ring.Size (), lookahead, "Expiration changed the number of elements");
+
+  // FindOrClaim returns the existing element, or claims the cell keeping
+  // the value of the previous slot
+  bool claimed = true;
+  NS_TEST_ASSERT_MSG_EQ (ring.FindOrClaim (future, &claimed), 999, "Wrong value for the future slot");
+  NS_TEST_ASSERT_MSG_EQ (claimed, false, "Existing element claimed");
+  SfnSf next = future;
+  next.Add (ring.GetCapacity (), m_slotsPerSubframe, subframesPerFrame);
+  NS_TEST_ASSERT_MSG_EQ (ring.FindOrClaim (next, &claimed), 999, "Value of the previous slot not kept");
+  NS_TEST_ASSERT_MSG_EQ (claimed, true, "Expired cell not claimed");
+  NS_TEST_ASSERT_MSG_EQ (ring.Contains (future), false, "Expired slot still present");
+  NS_TEST_ASSERT_MSG_EQ (ring.Contains (next), true, "Claimed slot not present");
+  NS_TEST_ASSERT_MSG_EQ (ring.Size (), lookahead, "Claiming changed the number of elements");
+
+  // The element of a slot before the wrap of the frame number is expired
+  // for the slot that takes its cell after the wrap
+  ring.Clear ();
+  SfnSf beforeWrap (std::numeric_limits<uint16_t>::max (), subframesPerFrame - 1, m_slotsPerSubframe - 1, 0);
+  ring.Insert (beforeWrap, 1000);
+  SfnSf afterWrap = beforeWrap;
+  afterWrap.Add (ring.GetCapacity (), m_slotsPerSubframe, subframesPerFrame);
+  NS_TEST_ASSERT_MSG_EQ (afterWrap.m_frameNum, 0, "The frame number did not wrap");
+  ring.Insert (afterWrap, 1001);
+  NS_TEST_ASSERT_MSG_EQ (ring.Contains (beforeWrap), false, "Slot before the wrap still present");
+  NS_TEST_ASSERT_MSG_EQ (ring.At (afterWrap), 1001, "Wrong value for the slot after the wrap");
+  NS_TEST_ASSERT_MSG_EQ (ring.Size (), 1, "Wrong number of elements after the wrap");
+
+  ring.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (ring.Size (), 0, "Ring is not empty after Clear");
+  NS_TEST_ASSERT_MSG_EQ (ring.Contains (future), false, "Slot present after Clear");
+}
+
+/**
+ * \brief The MmWaveSlotRing test suite
+ */
+class MmWaveSlotRingTestSuite : public TestSuite
+{
+public:
+  MmWaveSlotRingTestSuite () : TestSuite ("mmwave-test-slot-ring", UNIT)
+  {
+    for (uint32_t numerology = 0; numerology < 5; ++numerology)
+      {
+        AddTestCase (new MmWaveSlotRingTestCase (1 << numerology), QUICK);
+      }
+  }
+};
+
+static MmWaveSlotRingTestSuite mmwaveSlotRingTestSuite; //!< MmWaveSlotRing test suite
+
+} // namespace ns3
@@ -0,0 +1,353 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/mmwave-helper.h>
+#include <ns3/mmwave-point-to-point-epc-helper.h>
+#include <ns3/mmwave-spectrum-channel.h>
+#include <ns3/constant-spectrum-propagation-loss.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-model.h>
+#include <ns3/spectrum-value.h>
+#include <cmath>
+#include <vector>
+
+/**
+ * \file mmwave-test-spectrum-channel-workers.cc
+ * \ingroup test
+ * \brief Unit-testing the workers of MmWaveSpectrumChannel.
+ */
+namespace ns3 {
+
+/**
+ * \brief Run a scenario with one worker and with numWorkers workers in the
+ * spectrum channels, and check:
+ *
+ * - that the receivers get the same signals (time, receiver and PSD) in the
+ *   same order;
+ * - with a chain of spectrum propagation loss models (a constant loss added
+ *   after the 3GPP channel), that the whole chain is applied, with the same
+ *   signals whatever the number of workers.
+ */
+class MmWaveSpectrumChannelWorkersTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveSpectrumChannelWorkersTestCase
+   * \param numWorkers number of workers of the second run
+   */
+  MmWaveSpectrumChannelWorkersTestCase (uint32_t numWorkers)
+    : TestCase ("Signals of the spectrum channel, 1 and " + std::to_string (numWorkers) + " workers"),
+      m_numWorkers (numWorkers)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief A signal delivered to a receiver
+   */
+  struct Signal
+  {
+    int64_t m_time;               //!< The time of the delivery, in ns
+    uint32_t m_receiver;          //!< The node of the receiver, from the first gNB
+    std::vector<double> m_psd;    //!< The PSD of the signal
+
+    /**
+     * \brief Compare two signals
+     * \param o the other signal
+     * \return true if they are equal
+     */
+    bool operator== (const Signal &o) const
+    {
+      return m_time == o.m_time && m_receiver == o.m_receiver && m_psd == o.m_psd;
+    }
+  };
+
+  /**
+   * \brief Run the scenario
+   * \param numWorkers number of workers of the spectrum channels
+   * \param chainLossDb the loss of a constant spectrum model added after the
+   * 3GPP channel, or a negative value for no such model
+   * \param signals the signals delivered in the run
+   */
+  void RunScenario (uint32_t numWorkers, double chainLossDb, std::vector<Signal> *signals);
+
+  /**
+   * \brief Sink of RxSigParams: record the signal
+   * \param params the parameters of the signal
+   * \param receiver the receiver
+   */
+  void RxSignal (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+
+  uint32_t m_numWorkers {0};               //!< Number of workers of the second run
+  uint32_t m_firstId {0};                  //!< Node ID of the first gNB of the current run
+  std::vector<Signal> *m_signals {nullptr}; //!< Signals of the current run
+};
+
+void
+MmWaveSpectrumChannelWorkersTestCase::RxSignal (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+{
+  Signal signal;
+  signal.m_time = Simulator::Now ().GetNanoSeconds ();
+  signal.m_receiver = receiver->GetDevice ()->GetNode ()->GetId () - m_firstId;
+  signal.m_psd.assign (params->psd->ConstValuesBegin (), params->psd->ConstValuesEnd ());
+  m_signals->push_back (signal);
+}
+
+void
+MmWaveSpectrumChannelWorkersTestCase::RunScenario (uint32_t numWorkers, double chainLossDb,
+                                                   std::vector<Signal> *signals)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::MmWaveSpectrumChannel::NumWorkers", UintegerValue (numWorkers));
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue ("UMi-StreetCanyon"));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::Numerology", UintegerValue (2));
+
+  Ptr<MmWaveHelper> mmWaveHelper = CreateObject<MmWaveHelper> ();
+  mmWaveHelper->SetAttribute ("PathlossModel", StringValue ("ns3::MmWave3gppPropagationLossModel"));
+  mmWaveHelper->SetAttribute ("ChannelModel", StringValue ("ns3::MmWave3gppChannel"));
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  mmWaveHelper->SetEpcHelper (epcHelper);
+  mmWaveHelper->Initialize ();
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (2);
+  ueNodes.Create (4);
+
+  Ptr<ListPositionAllocator> gNbPositions = CreateObject<ListPositionAllocator> ();
+  gNbPositions->Add (Vector (0.0, 0.0, 10.0));
+  gNbPositions->Add (Vector (100.0, 0.0, 10.0));
+  Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator> ();
+  uePositions->Add (Vector (20.0, 10.0, 1.5));
+  uePositions->Add (Vector (30.0, -15.0, 1.5));
+  uePositions->Add (Vector (80.0, 20.0, 1.5));
+  uePositions->Add (Vector (120.0, -10.0, 1.5));
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (gNbPositions);
+  mobility.Install (gNbNodes);
+  mobility.SetPositionAllocator (uePositions);
+  mobility.Install (ueNodes);
+
+  NetDeviceContainer gNbDevs = mmWaveHelper->InstallEnbDevice (gNbNodes);
+  NetDeviceContainer ueDevs = mmWaveHelper->InstallUeDevice (ueNodes);
+
+  m_firstId = gNbNodes.Get (0)->GetId ();
+  m_signals = signals;
+  uint32_t channels = 0;
+  for (uint32_t i = 0; i < ChannelList::GetNChannels (); ++i)
+    {
+      Ptr<MmWaveSpectrumChannel> channel = DynamicCast<MmWaveSpectrumChannel> (ChannelList::GetChannel (i));
+      if (channel == nullptr)
+        {
+          continue;
+        }
+      ++channels;
+      NS_TEST_ASSERT_MSG_EQ (channel->GetNumWorkers (), numWorkers, "Wrong number of workers");
+      channel->TraceConnectWithoutContext ("RxSigParams",
+                                           MakeCallback (&MmWaveSpectrumChannelWorkersTestCase::RxSignal, this));
+      if (chainLossDb >= 0)
+        {
+          Ptr<ConstantSpectrumPropagationLossModel> loss = CreateObject<ConstantSpectrumPropagationLossModel> ();
+          loss->SetAttribute ("Loss", DoubleValue (chainLossDb));
+          channel->AddSpectrumPropagationLossModel (loss);
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (channels, 0u, "No MmWaveSpectrumChannel");
+
+  mmWaveHelper->AttachToClosestEnb (ueDevs, gNbDevs);
+
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+  m_signals = nullptr;
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::MmWaveSpectrumChannel::NumWorkers", UintegerValue (1));
+}
+
+void
+MmWaveSpectrumChannelWorkersTestCase::DoRun ()
+{
+  std::vector<Signal> reference;
+  RunScenario (1, -1, &reference);
+  NS_TEST_ASSERT_MSG_GT (reference.size (), 0u, "No signal delivered");
+
+  std::vector<Signal> signals;
+  RunScenario (m_numWorkers, -1, &signals);
+  NS_TEST_ASSERT_MSG_EQ (signals.size (), reference.size (), "Different number of signals with "
+                         << m_numWorkers << " workers");
+  for (size_t i = 0; i < reference.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((signals[i] == reference[i]), true, "Different signal " << i << " with "
+                             << m_numWorkers << " workers");
+    }
+
+  // With a chain, the constant loss applies on top of the 3GPP channel
+  const double chainLossDb = 10.0;
+  std::vector<Signal> chainReference;
+  RunScenario (1, chainLossDb, &chainReference);
+  std::vector<Signal> chainSignals;
+  RunScenario (m_numWorkers, chainLossDb, &chainSignals);
+  NS_TEST_ASSERT_MSG_EQ ((chainSignals == chainReference), true, "Different signals of the chain with "
+                         << m_numWorkers << " workers");
+
+  // The first signal is sent before any feedback of the receivers
+  NS_TEST_ASSERT_MSG_GT (chainReference.size (), 0u, "No signal delivered with the chain");
+  NS_TEST_ASSERT_MSG_EQ (chainReference[0].m_time, reference[0].m_time, "Different first signal with the chain");
+  NS_TEST_ASSERT_MSG_EQ (chainReference[0].m_receiver, reference[0].m_receiver, "Different first receiver with the chain");
+  NS_TEST_ASSERT_MSG_EQ (chainReference[0].m_psd.size (), reference[0].m_psd.size (), "Different PSD size with the chain");
+  const double factor = std::pow (10.0, -chainLossDb / 10.0);
+  for (size_t j = 0; j < reference[0].m_psd.size (); ++j)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (chainReference[0].m_psd[j], reference[0].m_psd[j] * factor,
+                                 reference[0].m_psd[j] * factor * 1e-9,
+                                 "The constant loss of the chain is not applied to band " << j);
+    }
+}
+
+/**
+ * \brief A SpectrumPhy that counts the signals it receives
+ */
+class MmWaveTestCountingPhy : public SpectrumPhy
+{
+public:
+  /**
+   * \brief Create MmWaveTestCountingPhy
+   * \param model the spectrum model of the receiver
+   */
+  MmWaveTestCountingPhy (Ptr<const SpectrumModel> model)
+    : m_model (model)
+  {
+  }
+
+  virtual void SetDevice (Ptr<NetDevice> d) override
+  {
+  }
+  virtual Ptr<NetDevice> GetDevice () const override
+  {
+    return nullptr;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m) override
+  {
+  }
+  virtual Ptr<MobilityModel> GetMobility () override
+  {
+    return nullptr;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c) override
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const override
+  {
+    return m_model;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna () override
+  {
+    return nullptr;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params) override
+  {
+    ++m_received;
+  }
+
+  Ptr<const SpectrumModel> m_model; //!< The spectrum model of the receiver
+  uint32_t m_received {0};          //!< Number of signals received
+};
+
+/**
+ * \brief Check that a receiver removed from MmWaveSpectrumChannel no longer
+ * gets the signals, and that the other receivers still get them
+ */
+class MmWaveSpectrumChannelRemoveRxTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveSpectrumChannelRemoveRxTestCase
+   */
+  MmWaveSpectrumChannelRemoveRxTestCase ()
+    : TestCase ("Signals of the spectrum channel after the removal of a receiver")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+MmWaveSpectrumChannelRemoveRxTestCase::DoRun ()
+{
+  Ptr<const SpectrumModel> model = Create<SpectrumModel> (std::vector<double> {28e9, 28.1e9});
+  Ptr<MmWaveSpectrumChannel> channel = CreateObject<MmWaveSpectrumChannel> ();
+  std::vector<Ptr<MmWaveTestCountingPhy> > phys;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      phys.push_back (CreateObject<MmWaveTestCountingPhy> (model));
+      channel->AddRx (phys.back ());
+    }
+
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->txPhy = phys[0];
+  params->psd = Create<SpectrumValue> (model);
+  channel->StartTx (params);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (phys[0]->m_received, 0u, "The transmitter received its signal");
+  NS_TEST_ASSERT_MSG_EQ (phys[1]->m_received, 1u, "Signal not received");
+  NS_TEST_ASSERT_MSG_EQ (phys[2]->m_received, 1u, "Signal not received");
+
+  channel->RemoveRx (phys[2]);
+  channel->StartTx (params);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (phys[1]->m_received, 2u, "Signal not received after the removal of another receiver");
+  NS_TEST_ASSERT_MSG_EQ (phys[2]->m_received, 1u, "Signal received after the removal");
+
+  // Removing it again, or adding it back, keeps one entry per receiver
+  channel->RemoveRx (phys[2]);
+  channel->AddRx (phys[2]);
+  channel->AddRx (phys[2]);
+  channel->StartTx (params);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (phys[2]->m_received, 2u, "Signal not received once after adding the receiver back");
+
+  channel->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief The spectrum channel workers test suite
+ */
+class MmWaveSpectrumChannelWorkersTestSuite : public TestSuite
+{
+public:
+  MmWaveSpectrumChannelWorkersTestSuite () : TestSuite ("mmwave-test-spectrum-channel-workers", SYSTEM)
+  {
+    AddTestCase (new MmWaveSpectrumChannelWorkersTestCase (2), QUICK);
+    AddTestCase (new MmWaveSpectrumChannelWorkersTestCase (4), QUICK);
+    AddTestCase (new MmWaveSpectrumChannelRemoveRxTestCase (), QUICK);
+  }
+};
+
+static MmWaveSpectrumChannelWorkersTestSuite mmwaveSpectrumChannelWorkersTestSuite; //!< Spectrum channel workers test suite
+
+} // namespace ns3
@@ -0,0 +1,282 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-mac-scheduler-ofdma-subband-pf.h>
+#include <ns3/mmwave-mac-scheduler-cqi-management.h>
+#include <ns3/mmwave-amc.h>
+#include "mmwave-test-random.h"
+
+/**
+ * \file mmwave-test-subband-pf.cc
+ * \ingroup test
+ * \brief Unit-testing the building blocks of the sub-band PF scheduler.
+ */
+namespace ns3 {
+
+/**
+ * \brief Assign all the RBG of a MmWavePfRbgMetricMatrix, checking the
+ * result of ArgMax against an exhaustive search
+ */
+class MmWavePfRbgMetricMatrixTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWavePfRbgMetricMatrixTestCase
+   * \param numRbg number of RBG
+   * \param numUe number of UE
+   */
+  MmWavePfRbgMetricMatrixTestCase (uint32_t numRbg, uint32_t numUe)
+    : TestCase ("MmWavePfRbgMetricMatrix with " + std::to_string (numRbg) +
+                " RBG and " + std::to_string (numUe) + " UE"),
+      m_numRbg (numRbg),
+      m_numUe (numUe)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numRbg {0}; //!< Number of RBG
+  uint32_t m_numUe {0};  //!< Number of UE
+};
+
+void
+MmWavePfRbgMetricMatrixTestCase::DoRun ()
+{
+  MmWavePfRbgMetricMatrix matrix;
+  matrix.Resize (m_numRbg, m_numUe);
+  NS_TEST_ASSERT_MSG_EQ (matrix.GetNumRbg (), m_numRbg, "Wrong number of RBG");
+  NS_TEST_ASSERT_MSG_EQ (matrix.GetNumUe (), m_numUe, "Wrong number of UE");
+
+  // Random values, with a lot of ties
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (12345);
+  for (uint32_t rbg = 0; rbg < m_numRbg; ++rbg)
+    {
+      for (uint32_t ue = 0; ue < m_numUe; ++ue)
+        {
+          matrix.At (rbg, ue) = 1.0 + random->GetInteger (0, 28);
+        }
+    }
+
+  std::vector<double> weights (m_numUe);
+  for (uint32_t ue = 0; ue < m_numUe; ++ue)
+    {
+      weights[ue] = 1.0 / (1.0 + ue % 13);
+    }
+
+  std::vector<uint32_t> assignedRbg (m_numUe, 0);
+  for (uint32_t rbg = 0; rbg < m_numRbg; ++rbg)
+    {
+      double best = 0.0;
+      uint32_t expected = m_numUe;
+      for (uint32_t ue = 0; ue < m_numUe; ++ue)
+        {
+          if (matrix.At (rbg, ue) * weights[ue] > best)
+            {
+              best = matrix.At (rbg, ue) * weights[ue];
+              expected = ue;
+            }
+        }
+
+      const uint32_t winner = matrix.ArgMax (rbg, weights);
+      NS_TEST_ASSERT_MSG_EQ (winner, expected, "Wrong winner in RBG " << rbg);
+      if (winner == m_numUe)
+        {
+          continue;
+        }
+
+      // As in the scheduler, only the weight of the winner changes; a UE
+      // with three RBG is full, and it is excluded
+      ++assignedRbg[winner];
+      weights[winner] = assignedRbg[winner] >= 3 ? 0.0 : weights[winner] / 2.0;
+    }
+
+  // With all the weights to 0, there is no winner
+  std::fill (weights.begin (), weights.end (), 0.0);
+  NS_TEST_ASSERT_MSG_EQ (matrix.ArgMax (0, weights), m_numUe, "Winner without weights");
+}
+
+/**
+ * \brief Check the per-RBG MCS calculated from a sub-band CQI
+ */
+class MmWaveSubbandCqiTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveSubbandCqiTestCase
+   */
+  MmWaveSubbandCqiTestCase ()
+    : TestCase ("Per-RBG MCS from a sub-band CQI")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+MmWaveSubbandCqiTestCase::DoRun ()
+{
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  Ptr<MmWaveAmc> amc = CreateObject<MmWaveAmc> (config);
+  MmWaveMacSchedulerCQIManagement cqiManagement;
+  cqiManagement.ConfigureCommonParameters (config, amc, 0, 0);
+
+  const uint32_t rbPerRbg = config->GetNumRbPerRbg ();
+  const uint32_t rbgNum = config->GetBandwidthInRbg ();
+  NS_TEST_ASSERT_MSG_GT (rbgNum, 3, "The test needs at least four RBG");
+
+  // RBG 0 with the best CQI, RBG 1 with one bad RB, RBG 2 with one RB not
+  // measured, RBG 3 with one RB with CQI 0, the others with CQI 7
+  DlCqiInfo info;
+  info.m_rnti = 1;
+  info.m_cqiType = DlCqiInfo::SB;
+  info.m_wbCqi = 10;
+  info.m_rbCqi.resize (rbgNum * rbPerRbg, 7);
+  std::fill (info.m_rbCqi.begin (), info.m_rbCqi.begin () + rbPerRbg, 15);
+  info.m_rbCqi[rbPerRbg] = 3;
+  info.m_rbCqi[2 * rbPerRbg + rbPerRbg - 1] = DlCqiInfo::RB_CQI_NOT_MEASURED;
+  info.m_rbCqi[3 * rbPerRbg] = 0;
+
+  auto ue = std::make_shared<MmWaveMacSchedulerUeInfo> (1, AntennaArrayModel::BeamId (0, 0.0));
+  cqiManagement.DlSBCQIReported (info, ue, 1);
+
+  const uint8_t wbMcs = static_cast<uint8_t> (amc->GetMcsFromCqi (10));
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlCqi.m_cqiType, MmWaveMacSchedulerUeInfo::CqiInfo::SB, "Wrong CQI type");
+  NS_TEST_ASSERT_MSG_EQ (+ue->m_dlMcs, +wbMcs, "Wrong WB MCS");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlRbgMcs.size (), rbgNum, "Wrong number of RBG MCS");
+  NS_TEST_ASSERT_MSG_EQ (+ue->m_dlRbgMcs[0], amc->GetMcsFromCqi (15), "Wrong MCS for RBG 0");
+  NS_TEST_ASSERT_MSG_EQ (+ue->m_dlRbgMcs[1], amc->GetMcsFromCqi (3), "Wrong MCS for RBG 1");
+  NS_TEST_ASSERT_MSG_EQ (+ue->m_dlRbgMcs[2], +wbMcs, "Not measured RBG without the WB MCS");
+  NS_TEST_ASSERT_MSG_EQ (+ue->m_dlRbgMcs[3], amc->GetMcsFromCqi (0), "A CQI of 0 taken as not measured");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlCqi.m_rbCqi[3 * rbPerRbg], 0, "Wrong CQI of a RB with CQI 0");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlCqi.m_rbCqi[2 * rbPerRbg + rbPerRbg - 1], -1, "Wrong CQI of a RB not measured");
+  for (uint32_t rbg = 4; rbg < rbgNum; ++rbg)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+ue->m_dlRbgMcs[rbg], amc->GetMcsFromCqi (7), "Wrong MCS for RBG " << rbg);
+    }
+
+  // After the expiration, the UE goes back to the WB behaviour
+  std::unordered_map<uint16_t, std::shared_ptr<MmWaveMacSchedulerUeInfo> > ueMap;
+  ueMap.emplace (1, ue);
+  cqiManagement.RefreshDlCqiMaps (ueMap);
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlRbgMcs.size (), rbgNum, "SB CQI expired too early");
+  cqiManagement.RefreshDlCqiMaps (ueMap);
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlRbgMcs.empty (), true, "Per-RBG MCS not cleared at expiration");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_dlCqi.m_cqiType, MmWaveMacSchedulerUeInfo::CqiInfo::WB, "CQI type not reset");
+}
+
+/**
+ * \brief MmWaveMacSchedulerOfdmaSubbandPF with the DL methods exposed to the test
+ */
+class MmWaveSubbandPfTestScheduler : public MmWaveMacSchedulerOfdmaSubbandPF
+{
+public:
+  using MmWaveMacSchedulerOfdmaSubbandPF::CreateUeRepresentation;
+  using MmWaveMacSchedulerOfdmaSubbandPF::AssignDLRBG;
+  using MmWaveMacSchedulerOfdmaSubbandPF::CreateDlDci;
+};
+
+/**
+ * \brief Schedule a UE with a sub-band CQI, and then without, and check
+ * that the DCI has the lowest MCS of its RBG only in the first slot, while
+ * the MCS of the UE stays the wideband one
+ */
+class MmWaveSubbandPfMcsTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveSubbandPfMcsTestCase
+   */
+  MmWaveSubbandPfMcsTestCase ()
+    : TestCase ("MCS of the DCI of the sub-band PF scheduler")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+MmWaveSubbandPfMcsTestCase::DoRun ()
+{
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  Ptr<MmWaveAmc> amc = CreateObject<MmWaveAmc> (config);
+  Ptr<MmWaveSubbandPfTestScheduler> scheduler = CreateObject<MmWaveSubbandPfTestScheduler> ();
+  scheduler->ConfigureCommonParameters (config);
+
+  const uint32_t rbgNum = config->GetBandwidthInRbg ();
+  const uint32_t sym = 12;
+  NS_TEST_ASSERT_MSG_GT (rbgNum, 1, "The test needs at least two RBG");
+
+  MmWaveMacCschedSapProvider::CschedUeConfigReqParameters params;
+  params.m_rnti = 1;
+  auto ue = scheduler->CreateUeRepresentation (params);
+  const uint8_t wbMcs = 20;
+  const uint8_t worstMcs = 3;
+  ue->m_dlMcs = wbMcs;
+  ue->m_dlRbgMcs.assign (rbgNum, wbMcs);
+  ue->m_dlRbgMcs[1] = worstMcs;
+
+  // A buffer that the whole band does not cover: the UE gets all the RBG
+  MmWaveMacSchedulerNs3::ActiveUeMap activeDl;
+  activeDl[ue->m_beamId].emplace_back (ue, UINT32_MAX / 2);
+
+  for (const bool subband : {true, false})
+    {
+      if (! subband)
+        {
+          // As at the expiration of the sub-band CQI
+          ue->m_dlRbgMcs.clear ();
+        }
+      ue->ResetDlSchedInfo ();
+
+      scheduler->AssignDLRBG (sym, activeDl);
+      NS_TEST_ASSERT_MSG_EQ (ue->m_dlRbgBitmask.Count (), rbgNum, "The UE did not get all the RBG");
+      NS_TEST_ASSERT_MSG_EQ (+ue->m_dlMcs, +wbMcs, "The MCS of the UE changed");
+
+      const uint8_t expectedMcs = subband ? worstMcs : wbMcs;
+      MmWaveMacSchedulerNs3::PointInFTPlane spoint (0, 0);
+      auto dci = scheduler->CreateDlDci (&spoint, ue, sym);
+      NS_TEST_ASSERT_MSG_EQ ((dci != nullptr), true, "No DCI");
+      NS_TEST_ASSERT_MSG_EQ (+dci->m_mcs, +expectedMcs, "Wrong MCS of the DCI, sub-band " << subband);
+      NS_TEST_ASSERT_MSG_EQ (dci->m_tbSize, amc->GetTbSizeFromMcsSymbols (expectedMcs, rbgNum * sym * config->GetNumRbPerRbg ()) / 8,
+                             "Wrong TBS of the DCI, sub-band " << subband);
+      NS_TEST_ASSERT_MSG_EQ ((dci->m_rbgBitmask == ue->m_dlRbgBitmask), true, "Wrong RBG of the DCI");
+    }
+}
+
+/**
+ * \brief The sub-band PF test suite
+ */
+class MmWaveSubbandPfTestSuite : public TestSuite
+{
+public:
+  MmWaveSubbandPfTestSuite () : TestSuite ("mmwave-test-subband-pf", UNIT)
+  {
+    AddTestCase (new MmWavePfRbgMetricMatrixTestCase (1, 1), QUICK);
+    AddTestCase (new MmWavePfRbgMetricMatrixTestCase (17, 5), QUICK);
+    AddTestCase (new MmWavePfRbgMetricMatrixTestCase (275, 200), QUICK);
+    AddTestCase (new MmWaveSubbandCqiTestCase (), QUICK);
+    AddTestCase (new MmWaveSubbandPfMcsTestCase (), QUICK);
+  }
+};
+
+static MmWaveSubbandPfTestSuite mmwaveSubbandPfTestSuite; //!< Sub-band PF test suite
+
+} // namespace ns3
@@ -0,0 +1,317 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/applications-module.h>
+#include <ns3/point-to-point-helper.h>
+#include <ns3/mmwave-helper.h>
+#include <ns3/mmwave-point-to-point-epc-helper.h>
+#include <ns3/mmwave-bearer-stats-calculator.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/**
+ * \file mmwave-test-trace-binding.cc
+ * \ingroup test
+ * \brief Unit-testing the direct binding of the trace sinks of MmWaveHelper.
+ */
+namespace ns3 {
+
+/**
+ * \brief Run a scenario with DL and UL traffic, where the same sinks are
+ * connected with Config::Connect and with the direct binding of
+ * MmWaveHelper, and check:
+ *
+ * - that the PHY sinks get the same contexts, the same number of times, with
+ *   both bindings, also for the devices installed after the binding;
+ * - that the RLC statistics, whose traces are bound by
+ *   MmWaveBearerStatsConnector at the RRC events, count as many PDUs of the
+ *   data radio bearers as a sink connected with Config::Connect.
+ */
+class MmWaveTraceBindingTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveTraceBindingTestCase
+   */
+  MmWaveTraceBindingTestCase ()
+    : TestCase ("Direct binding of the trace sinks, against Config::Connect")
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Calls of a sink, by context
+   */
+  typedef std::map<std::string, uint32_t> Calls;
+
+  /**
+   * \brief Sink of the RX packet traces, bound directly
+   * \param context the context
+   * \param params the parameters of the packet
+   */
+  void DirectRx (std::string context, RxPacketTraceParams params);
+  /**
+   * \brief Sink of the RX packet traces, connected with Config::Connect
+   * \param context the context
+   * \param params the parameters of the packet
+   */
+  void ConfigRx (std::string context, RxPacketTraceParams params);
+  /**
+   * \brief Sink of the DL TB size trace, bound directly
+   * \param context the context
+   * \param imsi the IMSI
+   * \param tbSize the TB size
+   */
+  void DirectTbSize (std::string context, uint64_t imsi, uint64_t tbSize);
+  /**
+   * \brief Sink of the DL TB size trace, connected with Config::Connect
+   * \param context the context
+   * \param imsi the IMSI
+   * \param tbSize the TB size
+   */
+  void ConfigTbSize (std::string context, uint64_t imsi, uint64_t tbSize);
+  /**
+   * \brief Sink of the RxPDU trace of the RLC of the UE data radio bearers,
+   * connected with Config::Connect
+   * \param context the context
+   * \param rnti the RNTI
+   * \param lcid the LCID
+   * \param size the size of the PDU
+   * \param delay the delay of the PDU
+   */
+  void ConfigRlcRx (std::string context, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delay);
+  /**
+   * \brief Connect ConfigRlcRx to the RLC of the UE data radio bearers
+   */
+  void ConnectRlcTraces ();
+
+  Calls m_directCalls; //!< Calls of the sinks bound directly
+  Calls m_configCalls; //!< Calls of the sinks connected with Config::Connect
+  std::map<uint16_t, uint32_t> m_rlcRxByRnti; //!< RLC PDUs received by the UEs, by RNTI
+};
+
+void
+MmWaveTraceBindingTestCase::DirectRx (std::string context, RxPacketTraceParams params)
+{
+  ++m_directCalls[context];
+}
+
+void
+MmWaveTraceBindingTestCase::ConfigRx (std::string context, RxPacketTraceParams params)
+{
+  ++m_configCalls[context];
+}
+
+void
+MmWaveTraceBindingTestCase::DirectTbSize (std::string context, uint64_t imsi, uint64_t tbSize)
+{
+  ++m_directCalls[context];
+}
+
+void
+MmWaveTraceBindingTestCase::ConfigTbSize (std::string context, uint64_t imsi, uint64_t tbSize)
+{
+  ++m_configCalls[context];
+}
+
+void
+MmWaveTraceBindingTestCase::ConfigRlcRx (std::string context, uint16_t rnti, uint8_t lcid, uint32_t size, uint64_t delay)
+{
+  ++m_rlcRxByRnti[rnti];
+}
+
+void
+MmWaveTraceBindingTestCase::ConnectRlcTraces ()
+{
+  Config::Connect ("/NodeList/*/DeviceList/*/LteUeRrc/DataRadioBearerMap/*/LteRlc/RxPDU",
+                   MakeCallback (&MmWaveTraceBindingTestCase::ConfigRlcRx, this));
+}
+
+void
+MmWaveTraceBindingTestCase::DoRun ()
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue ("UMi-StreetCanyon"));
+  Config::SetDefault ("ns3::MmWavePhyMacCommon::Numerology", UintegerValue (2));
+
+  Ptr<MmWaveHelper> mmWaveHelper = CreateObject<MmWaveHelper> ();
+  mmWaveHelper->SetAttribute ("PathlossModel", StringValue ("ns3::MmWave3gppPropagationLossModel"));
+  mmWaveHelper->SetAttribute ("ChannelModel", StringValue ("ns3::MmWave3gppChannel"));
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  mmWaveHelper->SetEpcHelper (epcHelper);
+  mmWaveHelper->Initialize ();
+
+  NodeContainer gNbNodes;
+  NodeContainer ueNodes;
+  gNbNodes.Create (1);
+  ueNodes.Create (2);
+
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector (0.0, 0.0, 10.0));
+  positions->Add (Vector (20.0, 10.0, 1.5));
+  positions->Add (Vector (-15.0, 25.0, 1.5));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (gNbNodes);
+  mobility.Install (ueNodes);
+
+  // The gNB is installed before the binding, the UEs after it
+  NetDeviceContainer gNbDevs = mmWaveHelper->InstallEnbDevice (gNbNodes);
+  mmWaveHelper->ConnectUePhyTrace ("RxPacketTraceUe", true,
+                                   MakeCallback (&MmWaveTraceBindingTestCase::DirectRx, this));
+  mmWaveHelper->ConnectUePhyTrace ("ReportDownlinkTbSize", false,
+                                   MakeCallback (&MmWaveTraceBindingTestCase::DirectTbSize, this));
+  mmWaveHelper->ConnectEnbPhyTrace ("RxPacketTraceEnb",
+                                    MakeCallback (&MmWaveTraceBindingTestCase::DirectRx, this));
+  mmWaveHelper->EnableRlcTraces ();
+  Ptr<MmWaveBearerStatsCalculator> rlcStats = mmWaveHelper->GetRlcStats ();
+  const std::string dlFileName = CreateTempDirFilename ("mmwave-test-trace-binding-dl.txt");
+  rlcStats->SetAttribute ("EpochOutput", BooleanValue (true));
+  rlcStats->SetAttribute ("EpochDuration", TimeValue (Seconds (10)));
+  rlcStats->SetAttribute ("DlRlcOutputFilename", StringValue (dlFileName));
+  rlcStats->SetAttribute ("UlRlcOutputFilename",
+                          StringValue (CreateTempDirFilename ("mmwave-test-trace-binding-ul.txt")));
+  NetDeviceContainer ueDevs = mmWaveHelper->InstallUeDevice (ueNodes);
+
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+                   MakeCallback (&MmWaveTraceBindingTestCase::ConfigRx, this));
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/ReportDownlinkTbSize",
+                   MakeCallback (&MmWaveTraceBindingTestCase::ConfigTbSize, this));
+  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/RxPacketTraceEnb",
+                   MakeCallback (&MmWaveTraceBindingTestCase::ConfigRx, this));
+
+  // The remote host and the DL and UL traffic
+  Ptr<Node> pgw = epcHelper->GetPgwNode ();
+  NodeContainer remoteHostContainer;
+  remoteHostContainer.Create (1);
+  Ptr<Node> remoteHost = remoteHostContainer.Get (0);
+  InternetStackHelper internet;
+  internet.Install (remoteHostContainer);
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (2500));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  NetDeviceContainer internetDevices = p2ph.Install (pgw, remoteHost);
+  Ipv4AddressHelper ipv4h;
+  ipv4h.SetBase ("1.0.0.0", "255.0.0.0");
+  Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign (internetDevices);
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> remoteHostStaticRouting = ipv4RoutingHelper.GetStaticRouting (remoteHost->GetObject<Ipv4> ());
+  remoteHostStaticRouting->AddNetworkRouteTo (Ipv4Address ("7.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+  internet.Install (ueNodes);
+  Ipv4InterfaceContainer ueIpIfaces = epcHelper->AssignUeIpv4Address (ueDevs);
+
+  const uint16_t dlPort = 1234;
+  const uint16_t ulPort = 2000;
+  ApplicationContainer apps;
+  UdpServerHelper ulServer (ulPort);
+  apps.Add (ulServer.Install (remoteHost));
+  for (uint32_t i = 0; i < ueNodes.GetN (); ++i)
+    {
+      Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueNodes.Get (i)->GetObject<Ipv4> ());
+      ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1);
+
+      UdpServerHelper dlServer (dlPort);
+      apps.Add (dlServer.Install (ueNodes.Get (i)));
+      UdpClientHelper dlClient (ueIpIfaces.GetAddress (i), dlPort);
+      dlClient.SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+      dlClient.SetAttribute ("MaxPackets", UintegerValue (1000));
+      apps.Add (dlClient.Install (remoteHost));
+      UdpClientHelper ulClient (internetIpIfaces.GetAddress (1), ulPort);
+      ulClient.SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+      ulClient.SetAttribute ("MaxPackets", UintegerValue (1000));
+      apps.Add (ulClient.Install (ueNodes.Get (i)));
+    }
+  apps.Start (MilliSeconds (400));
+  apps.Stop (MilliSeconds (800));
+
+  mmWaveHelper->AttachToClosestEnb (ueDevs, gNbDevs);
+
+  // The data radio bearers exist after the attach, and before the traffic
+  Simulator::Schedule (MilliSeconds (300), &MmWaveTraceBindingTestCase::ConnectRlcTraces, this);
+
+  Simulator::Stop (MilliSeconds (900));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_configCalls.empty (), false, "No PHY trace fired");
+  NS_TEST_EXPECT_MSG_EQ (m_directCalls.size (), m_configCalls.size (), "Different contexts of the PHY traces");
+  for (const auto & calls : m_configCalls)
+    {
+      auto it = m_directCalls.find (calls.first);
+      NS_TEST_ASSERT_MSG_EQ ((it != m_directCalls.end ()), true, "No direct call with context " << calls.first);
+      NS_TEST_EXPECT_MSG_EQ (it->second, calls.second, "Different number of calls with context " << calls.first);
+    }
+  bool enbRx = false;
+  for (const auto & calls : m_directCalls)
+    {
+      enbRx |= calls.first.find ("RxPacketTraceEnb") != std::string::npos;
+    }
+  NS_TEST_EXPECT_MSG_EQ (enbRx, true, "No call of the eNB PHY trace");
+
+  // The rows of the DL RLC statistics: RNTI, LCID and PDUs received by the UE
+  std::map<uint16_t, uint32_t> statsRxByRnti;
+  std::ifstream dlFile (dlFileName);
+  NS_TEST_ASSERT_MSG_EQ (dlFile.is_open (), true, "Can't open " << dlFileName);
+  std::string line;
+  while (std::getline (dlFile, line))
+    {
+      if (line.empty () || line[0] == '%')
+        {
+          continue;
+        }
+      std::istringstream values (line);
+      double start, end;
+      uint32_t cellId, rnti, lcid, txPdus, txBytes, rxPdus;
+      uint64_t imsi;
+      values >> start >> end >> cellId >> imsi >> rnti >> lcid >> txPdus >> txBytes >> rxPdus;
+      // The data radio bearers have the LCIDs from 3 on
+      if (lcid >= 3)
+        {
+          statsRxByRnti[static_cast<uint16_t> (rnti)] += rxPdus;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_rlcRxByRnti.size (), ueDevs.GetN (), "Not all the UEs received RLC PDUs");
+  NS_TEST_EXPECT_MSG_EQ ((statsRxByRnti == m_rlcRxByRnti), true,
+                         "The RLC statistics and Config::Connect count different PDUs");
+}
+
+/**
+ * \brief The trace binding test suite
+ */
+class MmWaveTraceBindingTestSuite : public TestSuite
+{
+public:
+  MmWaveTraceBindingTestSuite () : TestSuite ("mmwave-test-trace-binding", SYSTEM)
+  {
+    AddTestCase (new MmWaveTraceBindingTestCase (), QUICK);
+  }
+};
+
+static MmWaveTraceBindingTestSuite mmwaveTraceBindingTestSuite; //!< Trace binding test suite
+
+} // namespace ns3
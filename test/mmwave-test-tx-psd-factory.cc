@@ -0,0 +1,132 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-spectrum-value-helper.h>
+#include "mmwave-test-random.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * \file mmwave-test-tx-psd-factory.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveTxPsdFactory class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Check if two PSD have the same values
+ * \param a first PSD
+ * \param b second PSD
+ * \return true if the values are the same
+ */
+static bool
+SamePsd (const SpectrumValue &a, const SpectrumValue &b)
+{
+  return a.GetValuesN () == b.GetValuesN ()
+         && std::equal (a.ConstValuesBegin (), a.ConstValuesEnd (), b.ConstValuesBegin ());
+}
+
+/**
+ * \brief Compare the PSD of MmWaveTxPsdFactory against the ones of
+ * MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity, and check that
+ * a value is reused only when nobody else references it
+ */
+class MmWaveTxPsdFactoryTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveTxPsdFactoryTestCase
+   * \param rbPerRbg number of RB per RBG
+   */
+  MmWaveTxPsdFactoryTestCase (uint32_t rbPerRbg)
+    : TestCase ("MmWaveTxPsdFactory with " + std::to_string (rbPerRbg) + " RB per RBG"),
+      m_rbPerRbg (rbPerRbg)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_rbPerRbg {0}; //!< Number of RB per RBG
+};
+
+void
+MmWaveTxPsdFactoryTestCase::DoRun ()
+{
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  config->SetNumRbPerRbg (m_rbPerRbg);
+  const uint32_t numRb = config->GetBandwidthInRbs ();
+  const uint32_t numRbg = config->GetBandwidthInRbg ();
+
+  MmWaveTxPsdFactory factory;
+  Ptr<UniformRandomVariable> random = CreateTestRandomVariable (11);
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      // The TX power changes every 10 PSD
+      const double powerTx = 20.0 + (i / 10) * 3.0;
+
+      RbgBitmask rbg (numRbg);
+      for (uint32_t j = 0; j < numRbg; ++j)
+        {
+          if (random->GetInteger (0, 2) != 0)
+            {
+              rbg.Set (j);
+            }
+        }
+      const RbgBitmask rb = rbg.ExpandToRb (m_rbPerRbg, numRb);
+
+      Ptr<SpectrumValue> expected = MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (config, powerTx, rb);
+      Ptr<SpectrumValue> fromRb = factory.Create (config, powerTx, rb);
+      NS_TEST_ASSERT_MSG_EQ (SamePsd (*fromRb, *expected), true, "Wrong PSD from the RB bitmask " << i);
+      Ptr<SpectrumValue> fromRbg = factory.Create (config, powerTx, rbg, m_rbPerRbg);
+      NS_TEST_ASSERT_MSG_EQ ((fromRbg != fromRb), true, "Value in use returned again");
+      NS_TEST_ASSERT_MSG_EQ (SamePsd (*fromRbg, *expected), true, "Wrong PSD from the RBG bitmask " << i);
+      NS_TEST_ASSERT_MSG_EQ (SamePsd (*fromRb, *expected), true, "Value in use modified " << i);
+
+      // The power is spread over the whole band, on the active RB only
+      const double density = std::pow (10.0, (powerTx - 30.0) / 10.0) / config->GetBandwidth ();
+      for (uint32_t j = 0; j < numRb; ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL ((*fromRbg)[j], rb.Test (j) ? density : 0.0, density * 1e-12,
+                                     "Wrong density of RB " << j << " in PSD " << i);
+        }
+
+      // Once released, a value is reused
+      SpectrumValue *released = PeekPointer (fromRb);
+      fromRb = nullptr;
+      Ptr<SpectrumValue> reused = factory.Create (config, powerTx, RbgBitmask (numRb, true));
+      NS_TEST_ASSERT_MSG_EQ ((PeekPointer (reused) == released), true, "Value not reused " << i);
+    }
+}
+
+/**
+ * \brief The MmWaveTxPsdFactory test suite
+ */
+class MmWaveTxPsdFactoryTestSuite : public TestSuite
+{
+public:
+  MmWaveTxPsdFactoryTestSuite () : TestSuite ("mmwave-test-tx-psd-factory", UNIT)
+  {
+    AddTestCase (new MmWaveTxPsdFactoryTestCase (1), QUICK);
+    AddTestCase (new MmWaveTxPsdFactoryTestCase (4), QUICK);
+  }
+};
+
+static MmWaveTxPsdFactoryTestSuite mmwaveTxPsdFactoryTestSuite; //!< TX PSD factory test suite
+
+} // namespace ns3
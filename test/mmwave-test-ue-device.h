@@ -0,0 +1,75 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#pragma once
+
+#include <ns3/mmwave-ue-net-device.h>
+#include <ns3/simple-net-device.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/node.h>
+
+/**
+ * \file mmwave-test-ue-device.h
+ * \ingroup test
+ * \brief Nodes of the unit tests of the 3GPP propagation loss models.
+ */
+namespace ns3 {
+
+/**
+ * \brief A UE device that can be created without RRC and NAS: the link
+ * table and the path loss models only look at the type of the device
+ */
+class MmWaveTestUeDevice : public MmWaveUeNetDevice
+{
+public:
+  virtual void DoDispose (void) override
+  {
+    MmWaveNetDevice::DoDispose ();
+  }
+
+protected:
+  virtual void DoInitialize (void) override
+  {
+  }
+};
+
+/**
+ * \brief Create a node with a device and a constant position
+ * \param isUe true for a UE (a MmWaveTestUeDevice), false for a gNB (any
+ * other device)
+ * \param position the position of the node
+ * \return the mobility model of the node
+ */
+inline Ptr<MobilityModel>
+CreateTestNode (bool isUe, const Vector &position)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  if (isUe)
+    {
+      node->AddDevice (CreateObject<MmWaveTestUeDevice> ());
+    }
+  else
+    {
+      node->AddDevice (CreateObject<SimpleNetDevice> ());
+    }
+  Ptr<MobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+  mob->SetPosition (position);
+  node->AggregateObject (mob);
+  return mob;
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2019 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/test.h>
+#include <ns3/mmwave-worker-pool.h>
+#include <atomic>
+
+/**
+ * \file mmwave-test-worker-pool.cc
+ * \ingroup test
+ * \brief Unit-testing the MmWaveWorkerPool class.
+ */
+namespace ns3 {
+
+/**
+ * \brief Check that MmWaveWorkerPool::ParallelFor runs each iteration
+ * exactly once, for loops of different lengths and after a resize
+ */
+class MmWaveWorkerPoolTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Create MmWaveWorkerPoolTestCase
+   * \param numWorkers number of workers of the pool
+   */
+  MmWaveWorkerPoolTestCase (uint32_t numWorkers)
+    : TestCase ("MmWaveWorkerPool with " + std::to_string (numWorkers) + " workers"),
+      m_numWorkers (numWorkers)
+  {
+  }
+
+private:
+  virtual void DoRun (void) override;
+
+  uint32_t m_numWorkers {0}; //!< Number of workers
+};
+
+void
+MmWaveWorkerPoolTestCase::DoRun ()
+{
+  MmWaveWorkerPool pool;
+  pool.SetNumWorkers (m_numWorkers);
+  NS_TEST_ASSERT_MSG_EQ (pool.GetNumWorkers (), std::max (m_numWorkers, 1u), "Wrong number of workers");
+
+  for (uint32_t round = 0; round < 2; ++round)
+    {
+      for (size_t n = 0; n < 200; n += 1 + n / 4)
+        {
+          std::vector<std::atomic<uint32_t> > count (n);
+          for (auto & c : count)
+            {
+              c = 0;
+            }
+          pool.ParallelFor (n, [&count] (size_t i)
+            {
+              ++count[i];
+            });
+          for (size_t i = 0; i < n; ++i)
+            {
+              NS_TEST_ASSERT_MSG_EQ (count[i].load (), 1, "Iteration " << i << " of " << n << " run a wrong number of times");
+            }
+        }
+
+      // The same checks after a resize
+      pool.SetNumWorkers (m_numWorkers + 1);
+    }
+}
+
+/**
+ * \brief The MmWaveWorkerPool test suite
+ */
+class MmWaveWorkerPoolTestSuite : public TestSuite
+{
+public:
+  MmWaveWorkerPoolTestSuite () : TestSuite ("mmwave-test-worker-pool", UNIT)
+  {
+    AddTestCase (new MmWaveWorkerPoolTestCase (0), QUICK);
+    AddTestCase (new MmWaveWorkerPoolTestCase (1), QUICK);
+    AddTestCase (new MmWaveWorkerPoolTestCase (2), QUICK);
+    AddTestCase (new MmWaveWorkerPoolTestCase (8), QUICK);
+  }
+};
+
+static MmWaveWorkerPoolTestSuite mmwaveWorkerPoolTestSuite; //!< Worker pool test suite
+
+} // namespace ns3
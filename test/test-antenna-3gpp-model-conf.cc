@@ -83,7 +83,8 @@ public:
 
 
   TestAntenna3gppModelConf (const std::string & name, DirectionGnbUeXYAngle conf, TypeId gNbAntennaArrayModelType,
-                            TypeId ueAntennaArrayModelType, uint8_t ueNoOfAntennas, std::string losCondition);
+                            TypeId ueAntennaArrayModelType, uint8_t ueNoOfAntennas, std::string losCondition,
+                            double patternStep = 0.0);
   virtual ~TestAntenna3gppModelConf ();
   void UeReception (RxPacketTraceParams params);
 
@@ -97,6 +98,7 @@ private:
 
   uint8_t m_ueNoOfAntennas;
   std::string m_losCondition;
+  double m_patternStep; ///< step of the radiation pattern table of AntennaArray3gppModel, 0 to compute the pattern
   Ptr<MinMaxAvgTotalCalculator<double> > m_sinrCell1;
   Ptr<MinMaxAvgTotalCalculator<double> > m_sinrCell2;
   Ptr<MinMaxAvgTotalCalculator<double> > m_mcsCell1;
@@ -135,7 +137,8 @@ TestAntenna3gppModelConf::UeReception (RxPacketTraceParams params)
 }
 
 TestAntenna3gppModelConf::TestAntenna3gppModelConf (const std::string & name, DirectionGnbUeXYAngle conf, TypeId gnbAntennaModelType,
-                                                    TypeId ueAntennaModelType, uint8_t ueNoOfAntennas, std::string losCondition)
+                                                    TypeId ueAntennaModelType, uint8_t ueNoOfAntennas, std::string losCondition,
+                                                    double patternStep)
 : TestCase (name)
 {
   m_name = name;
@@ -144,6 +147,7 @@ TestAntenna3gppModelConf::TestAntenna3gppModelConf (const std::string & name, Di
   m_ueAntennaArrayModelType = ueAntennaModelType;
   m_ueNoOfAntennas = ueNoOfAntennas;
   m_losCondition = losCondition;
+  m_patternStep = patternStep;
   m_sinrCell1 = Create<MinMaxAvgTotalCalculator<double> >();
   m_sinrCell2 = Create<MinMaxAvgTotalCalculator<double> >();
   m_mcsCell1 = Create<MinMaxAvgTotalCalculator<double> >();
@@ -189,6 +193,9 @@ TestAntenna3gppModelConf::DoRun (void)
     Config::SetDefault("ns3::MmWaveHelper::GnbAntennaArrayModelType", TypeIdValue(m_gnbAntennaArrayModelType));
     Config::SetDefault("ns3::MmWaveHelper::UeAntennaArrayModelType", TypeIdValue(m_ueAntennaArrayModelType));
 
+    // compute the radiation pattern, or interpolate it in a table
+    Config::SetDefault ("ns3::AntennaArray3gppModel::RadiationPatternStep", DoubleValue (m_patternStep));
+
     // set LOS,NLOS condition
     Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::ChannelCondition", StringValue(m_losCondition));
 
@@ -432,6 +439,13 @@ Antenna3gppModelConfTestSuite::Antenna3gppModelConfTestSuite ()
                       ss <<" , UE antenna model type:"<<aaUe.GetName();
 
                       AddTestCase (new TestAntenna3gppModelConf (ss.str(), c, aaGnb, aaUe, n, losCondition), TestDuration::QUICK);
+
+                      // the same configuration, with the radiation pattern interpolated in a table
+                      if (aaGnb == AntennaArray3gppModel::GetTypeId () && aaUe == AntennaArray3gppModel::GetTypeId ())
+                        {
+                          ss << " , radiation pattern table step: 1";
+                          AddTestCase (new TestAntenna3gppModelConf (ss.str(), c, aaGnb, aaUe, n, losCondition, 1.0), TestDuration::QUICK);
+                        }
                     }
                 }
             }